@@ -0,0 +1,130 @@
+/**
+ * @file ir_bang_olufsen.c
+ * @brief Bang & Olufsen (Beo4) Protocol Decoder Implementation
+ *
+ * Based on Arduino-IRremote library, MIT License
+ */
+
+#include "ir_bang_olufsen.h"
+#include "ir_biphase.h"
+#include "esp_log.h"
+
+static const char *TAG = "IR_BEO";
+
+esp_err_t ir_decode_bang_olufsen(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code) {
+    // Minimum: START + 8 data + STOP pulses
+    if (!symbols || !code || num_symbols < BEO_MIN_BITS + 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t idx = 0;
+    bool in_data = false;
+    uint8_t zero_prefix = 0;
+    uint8_t prev_bit = 0;
+    uint8_t num_bits = 0;
+    uint32_t value = 0;
+
+    for (; idx < num_symbols; idx++) {
+        uint16_t mark = symbols[idx].duration0;
+        uint16_t space = symbols[idx].duration1;
+
+        if (mark + BEO_MARK_TOLERANCE < BEO_IR_MARK || mark > BEO_IR_MARK + BEO_MARK_TOLERANCE) {
+            return ESP_FAIL;
+        }
+
+        // Final mark: no following space (end marker) or a long idle gap
+        if (space == 0 || space > BEO_UNIT * (BEO_PULSE_START + 1)) {
+            break;
+        }
+
+        uint16_t units = ir_biphase_quantize(mark + space, BEO_UNIT, BEO_UNIT_TOLERANCE);
+
+        if (!in_data) {
+            if (units == BEO_PULSE_ZERO && zero_prefix < 2) {
+                zero_prefix++;          // Optional "0 0" prefix
+            } else if (units == BEO_PULSE_START) {
+                in_data = true;
+                prev_bit = 0;
+            } else {
+                return ESP_FAIL;
+            }
+            continue;
+        }
+
+        uint8_t bit;
+        if (units == BEO_PULSE_ZERO) {
+            bit = 0;
+        } else if (units == BEO_PULSE_ONE) {
+            bit = 1;
+        } else if (units == BEO_PULSE_SAME) {
+            bit = prev_bit;
+        } else if (units == BEO_PULSE_STOP) {
+            break;
+        } else {
+            return ESP_FAIL;
+        }
+
+        if (num_bits >= BEO_MAX_BITS) {
+            return ESP_FAIL;
+        }
+        value = (value << 1) | bit;
+        prev_bit = bit;
+        num_bits++;
+    }
+
+    if (!in_data || num_bits < BEO_MIN_BITS) {
+        return ESP_FAIL;
+    }
+
+    code->protocol = IR_PROTOCOL_BANG_OLUFSEN;
+    code->bits = num_bits;
+    code->data = value;
+    code->address = (num_bits > 8) ? (uint16_t)(value >> 8) : 0;
+    code->command = value & 0xFF;
+    code->flags = IR_FLAG_MSB_FIRST;
+
+    ESP_LOGI(TAG, "Decoded B&O: Addr=0x%02X, Cmd=0x%02X (%d bits)",
+             code->address, code->command, num_bits);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Append one pulse: the fixed mark, then @p space_us of space
+ */
+static bool beo_push(rmt_symbol_word_t *symbols, size_t *count, size_t max_symbols,
+                     uint16_t space_us) {
+    if (*count >= max_symbols) {
+        return false;
+    }
+    symbols[(*count)++] = (rmt_symbol_word_t) {
+        .level0 = 1, .duration0 = BEO_IR_MARK,
+        .level1 = 0, .duration1 = space_us,
+    };
+    return true;
+}
+
+size_t ir_bang_olufsen_build_symbols(const ir_code_t *code, rmt_symbol_word_t *symbols,
+                                     size_t max_symbols) {
+    if (!code || !symbols || code->bits < BEO_MIN_BITS || code->bits > BEO_MAX_BITS) {
+        return 0;
+    }
+
+    size_t count = 0;
+    bool ok = beo_push(symbols, &count, max_symbols, BEO_UNIT * BEO_PULSE_ZERO - BEO_IR_MARK) &&
+              beo_push(symbols, &count, max_symbols, BEO_UNIT * BEO_PULSE_ZERO - BEO_IR_MARK) &&
+              beo_push(symbols, &count, max_symbols, BEO_UNIT * BEO_PULSE_START - BEO_IR_MARK);
+
+    uint8_t prev_bit = 0;
+    for (int i = code->bits - 1; ok && i >= 0; i--) {
+        uint8_t bit = (code->data >> i) & 1;
+        uint8_t units = (bit == prev_bit) ? BEO_PULSE_SAME : (bit ? BEO_PULSE_ONE : BEO_PULSE_ZERO);
+        ok = beo_push(symbols, &count, max_symbols, BEO_UNIT * units - BEO_IR_MARK);
+        prev_bit = bit;
+    }
+
+    // Stop, then the final mark; its space is the idle gap
+    ok = ok && beo_push(symbols, &count, max_symbols, BEO_UNIT * BEO_PULSE_STOP - BEO_IR_MARK) &&
+         beo_push(symbols, &count, max_symbols, BEO_UNIT * (BEO_PULSE_START + 2));
+    return ok ? count : 0;
+}
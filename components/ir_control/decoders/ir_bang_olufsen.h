@@ -0,0 +1,84 @@
+/**
+ * @file ir_bang_olufsen.h
+ * @brief Bang & Olufsen (Beo4) Protocol Decoder
+ *
+ * B&O remotes use a 455kHz carrier (needs a 455kHz receiver such as the
+ * TSOP7000, or the carrier-measurement photodiode) and a pulse-position
+ * code measured in whole units of T = 3125us:
+ * - Every pulse is a short ~200us mark; the information is in the time
+ *   from one mark to the next (1T..5T)
+ * - 1T = "0", 3T = "1", 2T = "same as previous bit"
+ * - 5T = start, 4T = trailer (stop)
+ *
+ * Frame: 0 0 START <8 address bits> <8 command bits> STOP final-mark
+ *
+ * Pulse periods are quantized to whole units with the shared bi-phase
+ * engine quantizer (ir_biphase_quantize), same as RC5/RC6 half-bits.
+ *
+ * Transmit only by default: the 5T start gap (15.6ms) exceeds the RMT
+ * idle threshold (IR_RX_IDLE_NS, 10ms in ir_control.c), which ends the
+ * capture before the data bits, and a 455kHz frame needs a special
+ * receiver anyway. ir_control.c only runs the decoder when IR_RX_IDLE_NS
+ * is raised above BEO_START_GAP_NS. The leading "0 0" pulses are optional
+ * for the decoder.
+ *
+ * Reference: Arduino-IRremote/src/ir_BangOlufsen.hpp
+ * Based on Arduino-IRremote library, MIT License
+ */
+
+#ifndef IR_BANG_OLUFSEN_H
+#define IR_BANG_OLUFSEN_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/rmt_rx.h"
+#include "ir_control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BEO_UNIT                  3125    // T in microseconds
+#define BEO_IR_MARK               200     // Mark length
+#define BEO_MARK_TOLERANCE        150     // Receivers stretch short marks noticeably
+#define BEO_UNIT_TOLERANCE        (BEO_UNIT / 4)
+
+#define BEO_PULSE_ZERO            1       // Pulse periods in units of T
+#define BEO_PULSE_SAME            2
+#define BEO_PULSE_ONE             3
+#define BEO_PULSE_STOP            4
+#define BEO_PULSE_START           5
+
+#define BEO_START_GAP_NS          (BEO_UNIT * BEO_PULSE_START * 1000LL)
+
+#define BEO_BITS                  16      // 8 address + 8 command
+#define BEO_MIN_BITS              8
+#define BEO_MAX_BITS              32
+
+/**
+ * @brief Decode Bang & Olufsen (Beo4) IR protocol
+ *
+ * @param symbols RMT symbol array
+ * @param num_symbols Number of symbols
+ * @param code Output IR code structure
+ * @return ESP_OK on success, ESP_FAIL on decode failure, ESP_ERR_INVALID_ARG on invalid input
+ */
+esp_err_t ir_decode_bang_olufsen(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code);
+
+/**
+ * @brief Build RMT TX symbols for a B&O code (data as ir_decode_bang_olufsen() fills it)
+ *
+ * "0 0" prefix, start, the bits MSB first (a bit equal to the previous one
+ * is sent as the 2T "same" pulse), stop and the final mark.
+ *
+ * @return Number of symbols written, 0 if the bit count is out of range
+ *         or @p symbols is too small
+ */
+size_t ir_bang_olufsen_build_symbols(const ir_code_t *code, rmt_symbol_word_t *symbols,
+                                     size_t max_symbols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_BANG_OLUFSEN_H
@@ -0,0 +1,258 @@
+/**
+ * @file ir_biphase.c
+ * @brief Generic Bi-phase (Manchester) Decoder Engine Implementation
+ *
+ * MIT License
+ */
+
+#include "ir_biphase.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "IR_BIPHASE";
+
+uint16_t ir_biphase_quantize(uint32_t duration_us, uint16_t unit_us, uint16_t tolerance_us) {
+    if (unit_us == 0) {
+        return 0;
+    }
+
+    uint32_t units = (duration_us + unit_us / 2) / unit_us;
+    if (units == 0) {
+        units = 1;  // Short run - still checked against tolerance below
+    }
+
+    uint32_t expected = units * unit_us;
+    uint32_t error = duration_us > expected ? duration_us - expected : expected - duration_us;
+    if (error > tolerance_us || units > UINT16_MAX) {
+        return 0;
+    }
+
+    return (uint16_t)units;
+}
+
+/**
+ * @brief Append a run of @p units of @p level to the timeline
+ */
+static esp_err_t timeline_append(ir_biphase_decoder_t *dec, uint8_t level, uint16_t units) {
+    if (dec->length + units > IR_BIPHASE_MAX_UNITS) {
+        return ESP_FAIL;
+    }
+
+    memset(&dec->timeline[dec->length], level, units);
+    dec->length += units;
+    if (level) {
+        dec->last_mark = dec->length - 1;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ir_biphase_begin(ir_biphase_decoder_t *dec, const ir_biphase_config_t *config,
+                           const rmt_symbol_word_t *symbols, size_t num_symbols) {
+    if (!dec || !config || !symbols || num_symbols == 0 || config->unit_us == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(dec, 0, sizeof(*dec));
+    dec->config = config;
+
+    uint8_t tol_percent = config->tolerance_percent ? config->tolerance_percent
+                                                    : IR_BIPHASE_TOLERANCE_PERCENT;
+    uint16_t tolerance_us = (uint16_t)(((uint32_t)config->unit_us * tol_percent) / 100);
+
+    if (config->implicit_leading_space) {
+        timeline_append(dec, 0, 1);
+    }
+
+    // Walk every half-symbol, merging runs of equal level
+    uint8_t run_level = 0;
+    uint32_t run_us = 0;
+    bool started = false;
+    bool ended = false;
+
+    for (size_t i = 0; i < num_symbols && !ended; i++) {
+        uint16_t dur[2] = { symbols[i].duration0, symbols[i].duration1 };
+        uint8_t lvl[2] = { symbols[i].level0, symbols[i].level1 };
+
+        for (int h = 0; h < 2; h++) {
+            if (dur[h] == 0) {
+                ended = true;  // RMT end marker
+                break;
+            }
+            if (!started) {
+                if (lvl[h] == 0) {
+                    continue;  // Skip leading idle
+                }
+                started = true;
+                run_level = 1;
+                run_us = dur[h];
+                continue;
+            }
+            if (lvl[h] == run_level) {
+                run_us += dur[h];
+                continue;
+            }
+
+            // Level changed - flush the finished run
+            if (run_level == 0 && run_us > (uint32_t)config->unit_us * IR_BIPHASE_MAX_RUN_UNITS) {
+                ended = true;  // Inter-frame gap
+                run_us = 0;
+                break;
+            }
+            uint16_t units = ir_biphase_quantize(run_us, config->unit_us, tolerance_us);
+            if (units == 0 || timeline_append(dec, run_level, units) != ESP_OK) {
+                ESP_LOGV(TAG, "Run of %lu us does not fit unit %u", run_us, config->unit_us);
+                return ESP_FAIL;
+            }
+            run_level = lvl[h];
+            run_us = dur[h];
+        }
+    }
+
+    // Flush the final run; a trailing space is the idle gap and is dropped
+    if (started && run_level == 1 && run_us > 0) {
+        uint16_t units = ir_biphase_quantize(run_us, config->unit_us, tolerance_us);
+        if (units == 0 || timeline_append(dec, 1, units) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+
+    if (!started || dec->length == 0) {
+        return ESP_FAIL;
+    }
+
+    // Leader: N units of mark followed by M units of space
+    if (config->leader_mark_units > 0) {
+        uint16_t leader = config->leader_mark_units + config->leader_space_units;
+        if (dec->length < leader) {
+            return ESP_FAIL;
+        }
+        for (uint16_t i = 0; i < leader; i++) {
+            uint8_t expected = (i < config->leader_mark_units) ? 1 : 0;
+            if (dec->timeline[i] != expected) {
+                return ESP_FAIL;
+            }
+        }
+        dec->pos = leader;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Level at a timeline index (beyond the capture = idle space)
+ */
+static inline uint8_t level_at(const ir_biphase_decoder_t *dec, uint16_t index) {
+    return index < dec->length ? dec->timeline[index] : 0;
+}
+
+esp_err_t ir_biphase_read_bits(ir_biphase_decoder_t *dec, uint8_t count,
+                               bool double_length, uint32_t *value) {
+    if (!dec || !value || count == 0 || count > 32) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t half = double_length ? 2 : 1;
+    uint32_t result = 0;
+
+    for (uint8_t b = 0; b < count; b++) {
+        if (dec->pos >= dec->length) {
+            return ESP_FAIL;  // Frame ended early
+        }
+
+        uint8_t first = level_at(dec, dec->pos);
+        uint8_t second = level_at(dec, dec->pos + half);
+
+        // Each half must be one constant level, with a transition mid-bit
+        for (uint16_t i = 1; i < half; i++) {
+            if (level_at(dec, dec->pos + i) != first ||
+                level_at(dec, dec->pos + half + i) != second) {
+                return ESP_FAIL;
+            }
+        }
+        if (first == second) {
+            return ESP_FAIL;
+        }
+
+        uint8_t bit = (first == 1) ? dec->config->one_is_mark_first
+                                   : !dec->config->one_is_mark_first;
+        result = (result << 1) | bit;
+        dec->pos += 2 * half;
+    }
+
+    *value = result;
+    return ESP_OK;
+}
+
+uint8_t ir_biphase_remaining_bits(const ir_biphase_decoder_t *dec) {
+    if (!dec || dec->pos > dec->last_mark) {
+        return 0;
+    }
+
+    // A final "mark->space" bit ends on a mark at its first half
+    uint16_t units = dec->last_mark - dec->pos + 1;
+    return (uint8_t)((units + 1) / 2);
+}
+
+bool ir_biphase_at_end(const ir_biphase_decoder_t *dec) {
+    return dec && (dec->length == 0 || dec->pos > dec->last_mark);
+}
+
+size_t ir_biphase_build_symbols(const ir_biphase_config_t *config, uint64_t value,
+                                uint8_t num_bits, int8_t double_bit,
+                                rmt_symbol_word_t *symbols, size_t max_symbols) {
+    if (!config || !symbols || num_bits == 0 || num_bits > 64 ||
+        config->leader_mark_units + config->leader_space_units > IR_BIPHASE_MAX_UNITS) {
+        return 0;
+    }
+
+    // Same timeline the decoder expands a capture into
+    uint8_t timeline[IR_BIPHASE_MAX_UNITS];
+    uint16_t length = 0;
+    memset(timeline, 1, config->leader_mark_units);
+    length += config->leader_mark_units;
+    memset(&timeline[length], 0, config->leader_space_units);
+    length += config->leader_space_units;
+
+    for (uint8_t i = 0; i < num_bits; i++) {
+        uint8_t width = (i == double_bit) ? 2 : 1;
+        if (length + 2 * width > IR_BIPHASE_MAX_UNITS) {
+            return 0;
+        }
+        uint8_t one = (value >> (num_bits - 1 - i)) & 1;
+        uint8_t first = (one != 0) == config->one_is_mark_first;
+        memset(&timeline[length], first, width);
+        length += width;
+        memset(&timeline[length], !first, width);
+        length += width;
+    }
+
+    // One symbol per mark run and the space after it
+    size_t count = 0;
+    uint16_t i = 0;
+    while (i < length && timeline[i] == 0) {
+        i++;
+    }
+    while (i < length) {
+        uint16_t mark = 0;
+        uint16_t space = 0;
+        while (i < length && timeline[i] == 1) {
+            mark++;
+            i++;
+        }
+        while (i < length && timeline[i] == 0) {
+            space++;
+            i++;
+        }
+        if (i == length) {
+            space = IR_BIPHASE_MAX_RUN_UNITS + 1;   // Trailing half-bit merges into the gap
+        }
+        if (count == max_symbols) {
+            return 0;
+        }
+        symbols[count++] = (rmt_symbol_word_t) {
+            .level0 = 1, .duration0 = mark * config->unit_us,
+            .level1 = 0, .duration1 = space * config->unit_us,
+        };
+    }
+    return count;
+}
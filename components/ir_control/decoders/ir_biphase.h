@@ -0,0 +1,144 @@
+/**
+ * @file ir_biphase.h
+ * @brief Generic Bi-phase (Manchester) Decoder Engine
+ *
+ * Shared edge-driven engine for bi-phase protocols (RC5, RC6, and the
+ * unit-quantized B&O frame).
+ *
+ * Why a timeline instead of one-symbol-per-bit:
+ * - The RMT peripheral reports runs of equal level, not bits
+ * - Two adjacent half-bits of the same level (e.g. "1" followed by "0")
+ *   arrive merged as ONE 2-unit mark or space
+ * - The RC6 trailer (toggle) bit is double length, so merges of 1+2 and
+ *   2+1 units occur around it
+ *
+ * The engine therefore quantizes every mark/space run into whole
+ * half-bit units and expands the capture into a flat timeline with one
+ * entry per unit (1 = mark, 0 = space). Bits are then read from that
+ * timeline with a cursor, so merged halves decode naturally.
+ *
+ * Typical use:
+ *   ir_biphase_decoder_t dec;
+ *   if (ir_biphase_begin(&dec, &cfg, symbols, num_symbols) != ESP_OK) return ESP_FAIL;
+ *   ir_biphase_read_bits(&dec, 3, false, &mode);
+ *   ir_biphase_read_bits(&dec, 1, true, &toggle);   // double-length bit
+ *
+ * Reference: https://www.sbprojects.net/knowledge/ir/rc6.php
+ *
+ * MIT License
+ */
+
+#ifndef IR_BIPHASE_H
+#define IR_BIPHASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/rmt_rx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Engine limits
+#define IR_BIPHASE_MAX_UNITS        128   // Timeline length (RC6-6-32 needs 84)
+#define IR_BIPHASE_MAX_RUN_UNITS    8     // Longer space = end of frame
+#define IR_BIPHASE_TOLERANCE_PERCENT 40   // Per-run error allowed, % of one unit
+
+/**
+ * @brief Bi-phase protocol description
+ */
+typedef struct {
+    uint16_t unit_us;               // Half-bit duration (RC5: 889, RC6: 444)
+    uint8_t tolerance_percent;      // 0 = IR_BIPHASE_TOLERANCE_PERCENT
+    uint8_t leader_mark_units;      // Leader mark length in units (0 = no leader)
+    uint8_t leader_space_units;     // Leader space length in units
+    bool one_is_mark_first;         // RC6: "1" = mark->space, RC5: "1" = space->mark
+    bool implicit_leading_space;    // First half-bit is idle and not captured (RC5)
+} ir_biphase_config_t;
+
+/**
+ * @brief Decoder state (timeline + cursor)
+ */
+typedef struct {
+    const ir_biphase_config_t *config;
+    uint8_t timeline[IR_BIPHASE_MAX_UNITS];  // 1 = mark, 0 = space, per unit
+    uint16_t length;                         // Units in timeline
+    uint16_t pos;                            // Cursor (unit index)
+    uint16_t last_mark;                      // Index of last mark unit
+} ir_biphase_decoder_t;
+
+/**
+ * @brief Quantize a duration to a whole number of units
+ *
+ * @param duration_us Measured duration
+ * @param unit_us Unit length
+ * @param tolerance_us Allowed absolute error from n * unit
+ * @return Number of units (>= 1), or 0 if the duration is not close to a multiple
+ */
+uint16_t ir_biphase_quantize(uint32_t duration_us, uint16_t unit_us, uint16_t tolerance_us);
+
+/**
+ * @brief Expand RMT symbols into a unit timeline and consume the leader
+ *
+ * Leading spaces are skipped. Expansion stops at the first space longer
+ * than IR_BIPHASE_MAX_RUN_UNITS (inter-frame gap) or at the RMT end marker.
+ *
+ * @param dec Decoder state to initialize
+ * @param config Protocol description (must outlive @p dec)
+ * @param symbols RMT symbols (level 1 = mark)
+ * @param num_symbols Number of symbols
+ * @return ESP_OK if the capture is a valid bi-phase timeline with matching leader
+ */
+esp_err_t ir_biphase_begin(ir_biphase_decoder_t *dec, const ir_biphase_config_t *config,
+                           const rmt_symbol_word_t *symbols, size_t num_symbols);
+
+/**
+ * @brief Read bits (MSB first) at the cursor
+ *
+ * A missing tail (final half-bit merged into the idle gap) reads as space.
+ *
+ * @param dec Decoder state
+ * @param count Number of bits to read (1-32)
+ * @param double_length true for double-length bits (RC6 trailer)
+ * @param value Output value
+ * @return ESP_OK, or ESP_FAIL if a bit has no mid-bit transition
+ */
+esp_err_t ir_biphase_read_bits(ir_biphase_decoder_t *dec, uint8_t count,
+                               bool double_length, uint32_t *value);
+
+/**
+ * @brief Number of normal-length bits left before the end of the frame
+ */
+uint8_t ir_biphase_remaining_bits(const ir_biphase_decoder_t *dec);
+
+/**
+ * @brief Check that no mark remains after the cursor
+ */
+bool ir_biphase_at_end(const ir_biphase_decoder_t *dec);
+
+/**
+ * @brief Build RMT TX symbols for a bi-phase frame (inverse of the decoder)
+ *
+ * Leader, then the bits MSB first. Equal half-bits are merged into one
+ * run, a leading space (RC5 start bit) is left to the idle line, and the
+ * frame ends with a space longer than IR_BIPHASE_MAX_RUN_UNITS.
+ *
+ * @param config Protocol description
+ * @param value Bits to send, the first one in bit @p num_bits - 1
+ * @param num_bits Number of bits (1-64)
+ * @param double_bit Index (from the first bit sent) of the double-length bit, -1 for none
+ * @param symbols Output buffer (level 1 = mark)
+ * @param max_symbols Capacity of @p symbols
+ * @return Number of symbols written, 0 if @p symbols is too small
+ */
+size_t ir_biphase_build_symbols(const ir_biphase_config_t *config, uint64_t value,
+                                uint8_t num_bits, int8_t double_bit,
+                                rmt_symbol_word_t *symbols, size_t max_symbols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_BIPHASE_H
@@ -7,29 +7,12 @@
 
 #include "ir_carrier.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
 static const char *TAG = "IR_CARRIER";
 
-/**
- * @brief Calculate Carrier AC checksum
- *
- * Carrier uses a nibble-based checksum algorithm
- */
-static uint8_t carrier_checksum(const uint8_t *data, uint8_t len) {
-    uint16_t sum = 0;
-
-    // Sum all nibbles (4-bit values)
-    for (uint8_t i = 0; i < len; i++) {
-        sum += (data[i] & 0x0F);       // Lower nibble
-        sum += ((data[i] >> 4) & 0x0F); // Upper nibble
-    }
-
-    // Return lower nibble of sum
-    return sum & 0x0F;
-}
-
 esp_err_t ir_decode_carrier(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code) {
     if (!symbols || !code || num_symbols < CARRIER_BITS + 1) {
         return ESP_ERR_INVALID_ARG;
@@ -66,7 +49,7 @@ esp_err_t ir_decode_carrier(const rmt_symbol_word_t *symbols, size_t num_symbols
     }
 
     // Validate checksum (typically last nibble)
-    uint8_t calculated_checksum = carrier_checksum(data, CARRIER_BYTES - 1);
+    uint8_t calculated_checksum = ir_checksum_nibble_sum(data, CARRIER_BYTES - 1);
     uint8_t received_checksum = data[CARRIER_BYTES - 1] & 0x0F;
     bool checksum_ok = (calculated_checksum == received_checksum);
 
@@ -83,7 +66,13 @@ esp_err_t ir_decode_carrier(const rmt_symbol_word_t *symbols, size_t num_symbols
     code->command = data[1];  // Second byte typically has mode/temp
     code->flags = 0;
 
-    // Store first 4 bytes in data field
+    // Whole frame as payload (out of line when longer than 16 bytes)
+    esp_err_t err = ir_code_set_payload(code, data, CARRIER_BYTES);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // First 4 bytes as the legacy 32-bit view
     code->data = (uint32_t)data[0] |
                  ((uint32_t)data[1] << 8) |
                  ((uint32_t)data[2] << 16) |
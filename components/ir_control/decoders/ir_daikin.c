@@ -5,22 +5,12 @@
 
 #include "ir_daikin.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
 static const char *TAG = "IR_DAIKIN";
 
-/**
- * @brief Calculate Daikin checksum for a frame
- */
-static uint8_t daikin_checksum(const uint8_t *data, uint8_t len) {
-    uint8_t sum = 0;
-    for (uint8_t i = 0; i < len; i++) {
-        sum += data[i];
-    }
-    return sum & 0xFF;
-}
-
 /**
  * @brief Decode a single Daikin frame
  */
@@ -60,7 +50,8 @@ static esp_err_t decode_daikin_frame(const rmt_symbol_word_t *symbols, size_t *i
 }
 
 esp_err_t ir_decode_daikin(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code) {
-    if (!symbols || !code || num_symbols < 250) {  // Minimum symbols for 2-frame Daikin
+    // Two headers, every data bit and the stop bit carrying the gap (220 sent)
+    if (!symbols || !code || num_symbols < DAIKIN_TOTAL_BITS + 3) {
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -74,7 +65,7 @@ esp_err_t ir_decode_daikin(const rmt_symbol_word_t *symbols, size_t num_symbols,
     }
 
     // Validate Frame 1 checksum
-    uint8_t checksum1 = daikin_checksum(frame1, DAIKIN_FRAME1_BYTES - 1);
+    uint8_t checksum1 = ir_checksum_byte_sum(frame1, DAIKIN_FRAME1_BYTES - 1);
     if (checksum1 != frame1[DAIKIN_FRAME1_BYTES - 1]) {
         ESP_LOGW(TAG, "Frame 1 checksum failed");
     }
@@ -90,7 +81,7 @@ esp_err_t ir_decode_daikin(const rmt_symbol_word_t *symbols, size_t num_symbols,
     }
 
     // Validate Frame 2 checksum
-    uint8_t checksum2 = daikin_checksum(frame2, DAIKIN_FRAME2_BYTES - 1);
+    uint8_t checksum2 = ir_checksum_byte_sum(frame2, DAIKIN_FRAME2_BYTES - 1);
     if (checksum2 != frame2[DAIKIN_FRAME2_BYTES - 1]) {
         ESP_LOGW(TAG, "Frame 2 checksum failed");
     }
@@ -102,11 +93,20 @@ esp_err_t ir_decode_daikin(const rmt_symbol_word_t *symbols, size_t num_symbols,
     code->command = frame2[5];  // Mode/temp byte
     code->flags = 0;
 
-    // Store first 4 bytes of frame2 in data field
-    code->data = (uint32_t)frame2[0] |
-                 ((uint32_t)frame2[1] << 8) |
-                 ((uint32_t)frame2[2] << 16) |
-                 ((uint32_t)frame2[3] << 24);
+    // Both frames back to back as payload
+    uint8_t payload[DAIKIN_TOTAL_BYTES];
+    memcpy(payload, frame1, DAIKIN_FRAME1_BYTES);
+    memcpy(payload + DAIKIN_FRAME1_BYTES, frame2, DAIKIN_FRAME2_BYTES);
+    esp_err_t err = ir_code_set_payload(code, payload, sizeof(payload));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // First 4 payload bytes (frame1) as the legacy 32-bit view, as the encoder sets it
+    code->data = (uint32_t)payload[0] |
+                 ((uint32_t)payload[1] << 8) |
+                 ((uint32_t)payload[2] << 16) |
+                 ((uint32_t)payload[3] << 24);
 
     ESP_LOGI(TAG, "Decoded Daikin AC: Mode=0x%02X, Frame1_CS=%s, Frame2_CS=%s",
              frame2[5],
@@ -11,6 +11,7 @@
 
 #include "ir_distance_width.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
@@ -19,11 +20,15 @@ static const char *TAG = "IR_DW";
 /**
  * @brief Aggregate histogram counts into short and long duration bins
  *
- * Analyzes histogram array and groups consecutive counts (allowing 1-gap)
- * into average duration bins. Returns short and long bin indexes.
+ * Analyzes histogram array and groups consecutive counts into average
+ * duration bins. Returns short and long bin indexes.
  *
  * This is the core algorithm from Arduino-IRremote that allows robust
- * decoding despite manufacturing variations in remote controls.
+ * decoding despite manufacturing variations in remote controls. The run
+ * of empty bins that still joins a group grows with the duration (one
+ * bin, plus one per 16): receiver jitter is proportional, and a long
+ * space that occurs only a few times (LG2 sends four or five ones) leaves
+ * holes of two or three bins at 1.7ms.
  *
  * @param array Histogram array (modified in-place)
  * @param max_index Maximum index to scan
@@ -32,30 +37,30 @@ static const char *TAG = "IR_DW";
  * @return true if successfully aggregated (max 2 bins found)
  *         false if more than 2 distinct durations found
  */
-static bool aggregate_array_counts(uint8_t *array, uint8_t max_index,
+static bool aggregate_array_counts(uint16_t *array, uint8_t max_index,
                                     uint8_t *short_index, uint8_t *long_index) {
-    uint8_t sum = 0;
-    uint16_t weighted_sum = 0;
+    uint16_t sum = 0;
+    uint32_t weighted_sum = 0;
     uint8_t gap_count = 0;
 
     *short_index = 0;
     *long_index = 0;
 
     for (uint_fast8_t i = 0; i <= max_index; i++) {
-        uint8_t current_count = array[i];
+        uint16_t current_count = array[i];
 
         if (current_count != 0) {
             // Add to sum and clear array entry
             sum += current_count;
-            weighted_sum += (current_count * i);
+            weighted_sum += ((uint32_t)current_count * i);
             array[i] = 0;
             gap_count = 0;
         } else {
             gap_count++;
         }
 
-        // Aggregate when we have a sum AND (reached end OR gap > 1)
-        if (sum != 0 && (i == max_index || gap_count > 1)) {
+        // Aggregate when we have a sum AND (reached end OR the gap is too wide)
+        if (sum != 0 && (i == max_index || gap_count > 1 + i / 16)) {
             // Calculate weighted average with rounding
             uint8_t aggregate_index = (weighted_sum + (sum / 2)) / sum;
             array[aggregate_index] = sum;  // Store for reference
@@ -82,119 +87,271 @@ static bool aggregate_array_counts(uint8_t *array, uint8_t max_index,
 }
 
 /**
- * @brief Decode bits from RMT symbols using pulse distance or width encoding
+ * @brief Add a duration to a 50us-bin histogram
  *
- * @param symbols RMT symbol array
- * @param start_index Symbol index to start decoding (skip header)
- * @param num_bits Number of bits to decode
- * @param long_duration_us Threshold for "1" bit (marks for pulse width, spaces for pulse distance)
- * @param is_pulse_width true for pulse width, false for pulse distance
- * @param is_msb_first true for MSB first, false for LSB first
- * @param decoded_data Output: decoded data value
- * @return ESP_OK on success, ESP_FAIL on error
+ * @return false if the duration is beyond the histogram range
  */
-static esp_err_t decode_bits(const rmt_symbol_word_t *symbols,
-                              size_t start_index,
-                              uint8_t num_bits,
-                              uint16_t long_duration_us,
-                              bool is_pulse_width,
-                              bool is_msb_first,
-                              uint32_t *decoded_data) {
-    uint32_t data = 0;
-
-    for (uint_fast8_t bit = 0; bit < num_bits; bit++) {
-        size_t symbol_index = start_index + bit;
-        const rmt_symbol_word_t *sym = &symbols[symbol_index];
-
-        bool bit_value;
-
-        if (is_pulse_width) {
-            // Pulse WIDTH: bit determined by mark duration
-            uint16_t mark_us = ir_get_mark_us(sym);
-            bit_value = (mark_us >= long_duration_us);
-        } else {
-            // Pulse DISTANCE: bit determined by space duration
-            uint16_t space_us = ir_get_space_us(sym);
-            bit_value = (space_us >= long_duration_us);
+static bool histogram_add(uint16_t *histogram, uint8_t *max_index, uint16_t duration_us) {
+    uint16_t bin_index = duration_us / IR_DW_DURATION_BIN_SIZE_US;
+
+    if (bin_index >= IR_DW_DURATION_ARRAY_SIZE) {
+        return false;
+    }
+    histogram[bin_index]++;
+    if (bin_index > *max_index) {
+        *max_index = (uint8_t)bin_index;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * FRAME SPLITTING
+ * ============================================================================ */
+
+/**
+ * @brief Symbol span of one frame
+ *
+ * @p first may be a header; @p last carries the stop mark (pulse distance)
+ * or the final data bit (pulse width), and its space is the gap/idle.
+ */
+typedef struct {
+    size_t first;
+    size_t last;
+} frame_span_t;
+
+/**
+ * @brief Split a capture into frames at long spaces
+ *
+ * Runts (repeat codes, noise bursts) of IR_DW_MIN_BITS symbols or fewer
+ * are dropped.
+ *
+ * @return Number of frames, 0 if none or more than IR_DW_MAX_FRAMES
+ */
+static uint8_t split_frames(const rmt_symbol_word_t *symbols, size_t num_symbols,
+                            frame_span_t *spans, uint16_t *gap_us) {
+    uint8_t count = 0;
+    size_t first = 0;
+
+    *gap_us = 0;
+
+    for (size_t i = 0; i < num_symbols; i++) {
+        uint16_t space_us = ir_get_space_us(&symbols[i]);
+        bool end_marker = (space_us == 0);
+
+        if (i + 1 < num_symbols && !end_marker && space_us < IR_DW_MIN_FRAME_GAP_US) {
+            continue;
         }
 
-        // Pack bit into data word
-        if (is_msb_first) {
-            data = (data << 1) | (bit_value ? 1 : 0);
-        } else {
-            // LSB first
-            if (bit_value) {
-                data |= (1UL << bit);
+        if (i + 1 - first > IR_DW_MIN_BITS) {
+            if (count == IR_DW_MAX_FRAMES) {
+                ESP_LOGD(TAG, "More than %d frames in capture", IR_DW_MAX_FRAMES);
+                return 0;
+            }
+            if (count > 0 && *gap_us == 0) {
+                *gap_us = ir_get_space_us(&symbols[spans[count - 1].last]);
             }
+            spans[count].first = first;
+            spans[count].last = i;
+            count++;
+        }
+
+        first = i + 1;
+        if (end_marker) {
+            break;  // RMT end marker - nothing valid follows
         }
     }
 
-    *decoded_data = data;
-    return ESP_OK;
+    return count;
 }
 
-esp_err_t ir_decode_distance_width(const rmt_symbol_word_t *symbols,
-                                    size_t num_symbols,
-                                    ir_code_t *code) {
-    if (symbols == NULL || code == NULL) {
+/**
+ * @brief Check whether a frame starts with a header symbol
+ *
+ * A header mark or space is well above every data duration of its frame.
+ */
+static bool frame_has_header(const rmt_symbol_word_t *symbols, const frame_span_t *span) {
+    uint16_t max_mark_us = 0;
+    uint16_t max_space_us = 0;
+
+    for (size_t i = span->first + 1; i <= span->last; i++) {
+        uint16_t mark_us = ir_get_mark_us(&symbols[i]);
+        uint16_t space_us = ir_get_space_us(&symbols[i]);
+        if (mark_us > max_mark_us) {
+            max_mark_us = mark_us;
+        }
+        if (i < span->last && space_us > max_space_us) {
+            max_space_us = space_us;   // The last space is the gap
+        }
+    }
+
+    const rmt_symbol_word_t *head = &symbols[span->first];
+    return ir_get_mark_us(head) > max_mark_us * 3 / 2 + IR_DW_DURATION_BIN_SIZE_US ||
+           ir_get_space_us(head) > max_space_us * 3 / 2 + IR_DW_DURATION_BIN_SIZE_US;
+}
+
+/* ============================================================================
+ * BIT ORDER HEURISTICS
+ * ============================================================================ */
+
+static uint8_t reverse_bits(uint8_t value) {
+    value = (uint8_t)((value & 0xF0) >> 4 | (value & 0x0F) << 4);
+    value = (uint8_t)((value & 0xCC) >> 2 | (value & 0x33) << 2);
+    value = (uint8_t)((value & 0xAA) >> 1 | (value & 0x55) << 1);
+    return value;
+}
+
+/**
+ * @brief Score how plausible the trailing byte is as a checksum
+ *
+ * XOR and inverted-byte checks are bit-order invariant, so only the sum
+ * style checksums used by AC remotes (Mitsubishi, Daikin, Hitachi: byte sum;
+ * Fujitsu: two's complement; Gree/Kelvinator: nibble sum) can tell the
+ * orders apart. Frames already protected by inverted byte pairs (NEC
+ * style) are not scored, and the weak 4-bit nibble check is only trusted
+ * on AC-length frames.
+ *
+ * @param bytes Frame bytes (packed LSB first)
+ * @param len Number of bytes (checksum is the last one)
+ * @param msb_first Interpret @p bytes as MSB first
+ * @return 2 for a byte checksum match, 1 for a nibble match, 0 otherwise
+ */
+static int checksum_score(const uint8_t *bytes, uint8_t len, bool msb_first) {
+    if (len < 3) {
+        return 0;
+    }
+    if (len == 4 && ir_checksum_inverted_pairs(bytes, len)) {
+        return 0;
+    }
+
+    uint8_t sum = 0;
+    uint8_t nibble_sum = 0;
+    for (uint8_t i = 0; i < len - 1; i++) {
+        uint8_t b = msb_first ? reverse_bits(bytes[i]) : bytes[i];
+        sum += b;
+        nibble_sum += (b >> 4) + (b & 0x0F);
+    }
+
+    uint8_t check = msb_first ? reverse_bits(bytes[len - 1]) : bytes[len - 1];
+    if (check == sum || (uint8_t)(check + sum) == 0) {
+        return 2;
+    }
+    nibble_sum &= 0x0F;
+    if (len > 4 && ((check & 0x0F) == nibble_sum || (check >> 4) == nibble_sum)) {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Pick MSB first when its checksums match better than LSB first
+ *
+ * Only byte-aligned frames are scored. Ties keep LSB first, the order used
+ * by NEC and nearly every AC protocol in the table.
+ */
+static bool prefer_msb_first(const ir_dw_frame_t *frame) {
+    int lsb_score = 0;
+    int msb_score = 0;
+    uint8_t offset = 0;
+
+    for (uint8_t f = 0; f < frame->num_frames; f++) {
+        uint8_t len = (frame->frame_bits[f] + 7) / 8;
+        if (frame->frame_bits[f] % 8 == 0) {
+            lsb_score += checksum_score(&frame->bytes[offset], len, false);
+            msb_score += checksum_score(&frame->bytes[offset], len, true);
+        }
+        offset += len;
+    }
+
+    ESP_LOGD(TAG, "Checksum score: LSB=%d MSB=%d", lsb_score, msb_score);
+    return msb_score > lsb_score;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+static uint8_t frame_byte_offset(const ir_dw_frame_t *frame, uint8_t frame_index) {
+    uint8_t offset = 0;
+    for (uint8_t f = 0; f < frame_index && f < frame->num_frames; f++) {
+        offset += (frame->frame_bits[f] + 7) / 8;
+    }
+    return offset;
+}
+
+bool ir_dw_get_bit(const ir_dw_frame_t *frame, uint8_t frame_index, uint16_t index) {
+    if (frame == NULL || frame_index >= frame->num_frames ||
+        index >= frame->frame_bits[frame_index]) {
+        return false;
+    }
+
+    uint8_t byte = frame->bytes[frame_byte_offset(frame, frame_index) + index / 8];
+    uint8_t shift = frame->msb_first ? 7 - (index % 8) : (index % 8);
+    return (byte >> shift) & 1;
+}
+
+void ir_dw_set_lsb_first(ir_dw_frame_t *frame) {
+    if (frame == NULL || !frame->msb_first) {
+        return;
+    }
+    for (uint8_t i = 0; i < frame->num_bytes; i++) {
+        frame->bytes[i] = reverse_bits(frame->bytes[i]);
+    }
+    frame->msb_first = false;
+}
+
+esp_err_t ir_dw_decode(const rmt_symbol_word_t *symbols, size_t num_symbols,
+                       ir_dw_frame_t *frame) {
+    if (symbols == NULL || frame == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Require at least 7 data bits + header (2 symbols) + stop bit (1 symbol) = 18+ symbols minimum
-    // Each bit = mark + space = 1 RMT symbol
-    size_t min_symbols = (2 * IR_DW_MIN_BITS) + 4;
+    // Header + IR_DW_MIN_BITS data bits + stop bit (one symbol each)
+    size_t min_symbols = IR_DW_MIN_BITS + 2;
     if (num_symbols < min_symbols) {
         ESP_LOGD(TAG, "Too few symbols: %zu < %zu", num_symbols, min_symbols);
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Initialize histogram arrays for mark and space durations
-    uint8_t mark_histogram[IR_DW_DURATION_ARRAY_SIZE] = {0};
-    uint8_t space_histogram[IR_DW_DURATION_ARRAY_SIZE] = {0};
-
-    uint8_t mark_max_index = 0;
-    uint8_t space_max_index = 0;
+    frame_span_t spans[IR_DW_MAX_FRAMES];
+    uint16_t gap_us = 0;
+    uint8_t num_frames = split_frames(symbols, num_symbols, spans, &gap_us);
+    if (num_frames == 0) {
+        return ESP_FAIL;
+    }
 
     /*
      * STEP 1: Build histograms of mark and space durations
-     * Skip header (symbols 0-1) and stop bit (last symbol)
+     * Per frame, skip the header symbol (if any) and the trailing gap space.
+     * The last mark is kept: it is either the stop bit (same as a bit mark)
+     * or the final pulse-width data bit.
      */
 
-    // Count MARK durations (level0) - skip header and stop bit
-    for (size_t i = 1; i < num_symbols - 1; i++) {
-        uint16_t mark_us = symbols[i].duration0;
-
-        // Convert to bin index (50us bins)
-        uint8_t bin_index = mark_us / IR_DW_DURATION_BIN_SIZE_US;
-
-        if (bin_index < IR_DW_DURATION_ARRAY_SIZE) {
-            mark_histogram[bin_index]++;
-            if (bin_index > mark_max_index) {
-                mark_max_index = bin_index;
-            }
-        } else {
-            ESP_LOGD(TAG, "Mark %u us exceeds max %u us at symbol %zu",
-                     mark_us, IR_DW_DURATION_ARRAY_SIZE * IR_DW_DURATION_BIN_SIZE_US, i);
-            return ESP_FAIL;
+    uint8_t header_mask = 0;
+    for (uint8_t f = 0; f < num_frames; f++) {
+        if (frame_has_header(symbols, &spans[f])) {
+            header_mask |= (uint8_t)(1U << f);
         }
     }
 
-    // Count SPACE durations (level1) - skip header and stop bit
-    for (size_t i = 1; i < num_symbols - 1; i++) {
-        uint16_t space_us = symbols[i].duration1;
+    uint16_t mark_histogram[IR_DW_DURATION_ARRAY_SIZE] = {0};
+    uint16_t space_histogram[IR_DW_DURATION_ARRAY_SIZE] = {0};
+    uint8_t mark_max_index = 0;
+    uint8_t space_max_index = 0;
 
-        // Convert to bin index
-        uint8_t bin_index = space_us / IR_DW_DURATION_BIN_SIZE_US;
+    for (uint8_t f = 0; f < num_frames; f++) {
+        size_t data_first = spans[f].first + ((header_mask & (1U << f)) ? 1 : 0);
+        for (size_t i = data_first; i <= spans[f].last; i++) {
+            uint16_t mark_us = ir_get_mark_us(&symbols[i]);
+            uint16_t space_us = ir_get_space_us(&symbols[i]);
 
-        if (bin_index < IR_DW_DURATION_ARRAY_SIZE) {
-            space_histogram[bin_index]++;
-            if (bin_index > space_max_index) {
-                space_max_index = bin_index;
+            if (!histogram_add(mark_histogram, &mark_max_index, mark_us)) {
+                ESP_LOGD(TAG, "Mark %u us exceeds max at symbol %zu", mark_us, i);
+                return ESP_FAIL;
+            }
+            if (i < spans[f].last && !histogram_add(space_histogram, &space_max_index, space_us)) {
+                ESP_LOGD(TAG, "Space %u us exceeds max at symbol %zu", space_us, i);
+                return ESP_FAIL;
             }
-        } else {
-            ESP_LOGD(TAG, "Space %u us exceeds max %u us at symbol %zu",
-                     space_us, IR_DW_DURATION_ARRAY_SIZE * IR_DW_DURATION_BIN_SIZE_US, i);
-            return ESP_FAIL;
         }
     }
 
@@ -220,8 +377,8 @@ esp_err_t ir_decode_distance_width(const rmt_symbol_word_t *symbols,
     uint16_t space_short_us = space_short_idx * IR_DW_DURATION_BIN_SIZE_US;
     uint16_t space_long_us = space_long_idx * IR_DW_DURATION_BIN_SIZE_US;
 
-    ESP_LOGI(TAG, "Timing: mark=%u/%uus, space=%u/%uus",
-             mark_short_us, mark_long_us, space_short_us, space_long_us);
+    ESP_LOGI(TAG, "Timing: mark=%u/%uus, space=%u/%uus, %u frame(s)",
+             mark_short_us, mark_long_us, space_short_us, space_long_us, num_frames);
 
     /*
      * STEP 3: Classify protocol type
@@ -237,73 +394,332 @@ esp_err_t ir_decode_distance_width(const rmt_symbol_word_t *symbols,
         return ESP_FAIL;
     }
 
-    bool is_pulse_width = (mark_long_idx != 0 && space_short_idx == space_long_idx);
-    bool is_pulse_distance = (mark_short_idx == mark_long_idx && space_long_idx != 0);
-
-    // PULSE_DISTANCE_WIDTH can be decoded as pulse distance
-    if (!is_pulse_width && !is_pulse_distance && space_long_idx != 0) {
-        is_pulse_distance = true;  // Decode as pulse distance
+    bool is_pulse_width = (mark_long_idx != 0 && space_long_idx == 0);
+    if (!is_pulse_width && mark_long_idx != 0) {
+        // PULSE_DISTANCE_WIDTH can be decoded as pulse distance
         ESP_LOGD(TAG, "PULSE_DISTANCE_WIDTH detected, decoding as pulse distance");
     }
 
+    // Threshold for "1" bit: midpoint between short and long
+    uint16_t long_threshold_us = is_pulse_width ? (mark_short_us + mark_long_us) / 2
+                                                : (space_short_us + space_long_us) / 2;
+
+    /*
+     * STEP 4: Decode the bits of every frame into the byte array
+     *
+     * Frame layout (one RMT symbol = mark + space):
+     *   [header] data... stop+gap      (pulse distance)
+     *   [header] data... lastbit+gap   (pulse width, no stop bit)
+     */
+
+    memset(frame, 0, sizeof(*frame));
+    frame->pulse_width = is_pulse_width;
+    frame->num_frames = num_frames;
+    frame->timing.frame_gap_us = (num_frames > 1) ? gap_us : 0;
+
+    uint32_t sum[2][2] = {{0}};     // [bit value][0 = mark, 1 = space]
+    uint16_t cnt[2][2] = {{0}};
+    uint32_t header_mark_sum = 0, header_space_sum = 0, stop_sum = 0;
+    uint8_t header_count = 0;
+    uint16_t byte_offset = 0;
+
+    for (uint8_t f = 0; f < num_frames; f++) {
+        const rmt_symbol_word_t *head = &symbols[spans[f].first];
+        bool has_header = (header_mask & (1U << f)) != 0;
+
+        size_t data_first = spans[f].first + (has_header ? 1 : 0);
+        size_t data_last = is_pulse_width ? spans[f].last : spans[f].last - 1;
+        if (data_last < data_first || data_last - data_first + 1 < IR_DW_MIN_BITS) {
+            ESP_LOGD(TAG, "Frame %u too short", f);
+            return ESP_FAIL;
+        }
+
+        uint16_t num_bits = data_last - data_first + 1;
+        uint16_t num_bytes = (num_bits + 7) / 8;
+        if (byte_offset + num_bytes > IR_DW_MAX_BYTES) {
+            ESP_LOGD(TAG, "Payload exceeds %d bytes", IR_DW_MAX_BYTES);
+            return ESP_FAIL;
+        }
+
+        for (uint16_t bit = 0; bit < num_bits; bit++) {
+            const rmt_symbol_word_t *sym = &symbols[data_first + bit];
+            uint16_t mark_us = ir_get_mark_us(sym);
+            uint16_t space_us = ir_get_space_us(sym);
+            uint8_t value = is_pulse_width ? (mark_us >= long_threshold_us)
+                                           : (space_us >= long_threshold_us);
+
+            // Packed LSB first; bytes are reversed below if MSB first wins
+            if (value) {
+                frame->bytes[byte_offset + bit / 8] |= (uint8_t)(1U << (bit % 8));
+            }
+
+            sum[value][0] += mark_us;
+            cnt[value][0]++;
+            if (!is_pulse_width || bit + 1 < num_bits) {
+                sum[value][1] += space_us;  // Final pulse-width space is the gap
+                cnt[value][1]++;
+            }
+        }
+
+        if (has_header) {
+            header_mark_sum += ir_get_mark_us(head);
+            header_space_sum += ir_get_space_us(head);
+            header_count++;
+            frame->header_mask |= (uint8_t)(1U << f);
+        }
+        if (!is_pulse_width) {
+            stop_sum += ir_get_mark_us(&symbols[spans[f].last]);
+        }
+
+        frame->frame_bits[f] = num_bits;
+        frame->total_bits += num_bits;
+        byte_offset += num_bytes;
+    }
+    frame->num_bytes = (uint8_t)byte_offset;
+
+    // Average the measured durations so the frame can be re-transmitted
+    ir_dw_timing_t *t = &frame->timing;
+    if (header_count > 0) {
+        t->header_mark_us = header_mark_sum / header_count;
+        t->header_space_us = header_space_sum / header_count;
+    }
+    t->zero_mark_us = cnt[0][0] ? sum[0][0] / cnt[0][0] : mark_short_us;
+    t->one_mark_us = cnt[1][0] ? sum[1][0] / cnt[1][0]
+                               : (is_pulse_width ? mark_long_us : mark_short_us);
+    t->zero_space_us = cnt[0][1] ? sum[0][1] / cnt[0][1] : space_short_us;
+    t->one_space_us = cnt[1][1] ? sum[1][1] / cnt[1][1]
+                                : (is_pulse_width ? space_short_us : space_long_us);
+    t->stop_mark_us = is_pulse_width ? 0 : stop_sum / num_frames;
+
     /*
-     * STEP 4: Decode bits
+     * STEP 5: Bit order
      */
 
-    // Calculate number of data bits (exclude header symbol and stop bit)
-    uint8_t num_bits = (num_symbols / 1) - 2;  // Each symbol is mark+space
-    if (space_long_idx > 0) {
-        num_bits--;  // Pulse distance has mandatory stop bit
+    frame->msb_first = prefer_msb_first(frame);
+    if (frame->msb_first) {
+        for (uint8_t i = 0; i < frame->num_bytes; i++) {
+            frame->bytes[i] = reverse_bits(frame->bytes[i]);
+        }
     }
 
-    if (num_bits == 0 || num_bits > 64) {
-        ESP_LOGD(TAG, "Invalid bit count: %u", num_bits);
-        return ESP_FAIL;
+    return ESP_OK;
+}
+
+/**
+ * @brief Append one symbol, spreading long spaces over idle symbols
+ */
+static bool emit_symbol(rmt_symbol_word_t *symbols, size_t *count, size_t max_symbols,
+                        uint16_t mark_us, uint32_t space_us) {
+    const uint16_t max_duration = 0x7FFF;  // 15-bit RMT duration field
+
+    if (*count >= max_symbols) {
+        return false;
+    }
+
+    uint16_t first_space = space_us > max_duration ? max_duration : (uint16_t)space_us;
+    symbols[(*count)++] = (rmt_symbol_word_t) {
+        .level0 = 1, .duration0 = mark_us,
+        .level1 = 0, .duration1 = first_space,
+    };
+    space_us -= first_space;
+
+    while (space_us > 0) {
+        if (*count >= max_symbols) {
+            return false;
+        }
+        uint16_t d0 = space_us > max_duration ? max_duration : (uint16_t)space_us;
+        space_us -= d0;
+        uint16_t d1 = space_us > max_duration ? max_duration : (uint16_t)space_us;
+        space_us -= d1;
+        symbols[(*count)++] = (rmt_symbol_word_t) {
+            .level0 = 0, .duration0 = d0,
+            .level1 = 0, .duration1 = d1 ? d1 : 1,
+        };
     }
+    return true;
+}
 
-    // Determine threshold for "1" bit
-    uint16_t long_threshold_us;
-    if (is_pulse_width) {
-        // Pulse width: use midpoint between short and long marks
-        long_threshold_us = (mark_short_us + mark_long_us) / 2;
-    } else {
-        // Pulse distance: use midpoint between short and long spaces
-        long_threshold_us = (space_short_us + space_long_us) / 2;
+size_t ir_dw_build_symbols(const ir_dw_frame_t *frame, rmt_symbol_word_t *symbols,
+                           size_t max_symbols) {
+    if (frame == NULL || symbols == NULL || frame->num_frames == 0) {
+        return 0;
     }
 
-    uint32_t decoded_data = 0;
-    esp_err_t ret = decode_bits(symbols,
-                                 1,  // Start after header symbol
-                                 num_bits,
-                                 long_threshold_us,
-                                 is_pulse_width,
-                                 false,  // LSB first by default (can make configurable)
-                                 &decoded_data);
+    const ir_dw_timing_t *t = &frame->timing;
+    size_t count = 0;
 
+    for (uint8_t f = 0; f < frame->num_frames; f++) {
+        bool last_frame = (f + 1 == frame->num_frames);
+        uint32_t gap_us = last_frame ? t->zero_space_us : t->frame_gap_us;
+
+        if ((frame->header_mask & (1U << f)) &&
+            !emit_symbol(symbols, &count, max_symbols, t->header_mark_us, t->header_space_us)) {
+            return 0;
+        }
+
+        for (uint16_t bit = 0; bit < frame->frame_bits[f]; bit++) {
+            bool value = ir_dw_get_bit(frame, f, bit);
+            uint16_t mark_us = value ? t->one_mark_us : t->zero_mark_us;
+            uint32_t space_us = value ? t->one_space_us : t->zero_space_us;
+
+            if (frame->pulse_width && bit + 1 == frame->frame_bits[f]) {
+                space_us = gap_us;  // No stop bit - last bit carries the gap
+            }
+            if (!emit_symbol(symbols, &count, max_symbols, mark_us, space_us)) {
+                return 0;
+            }
+        }
+
+        if (!frame->pulse_width &&
+            !emit_symbol(symbols, &count, max_symbols, t->stop_mark_us, gap_us)) {
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+static inline void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static inline uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+size_t ir_dw_pack(const ir_dw_frame_t *frame, uint8_t *out, size_t out_size) {
+    if (frame == NULL || out == NULL || frame->num_frames == 0 ||
+        frame->num_frames > IR_DW_MAX_FRAMES || frame->num_bytes > IR_DW_MAX_BYTES) {
+        return 0;
+    }
+
+    size_t len = sizeof(ir_dw_timing_t) + 3 + 2 * frame->num_frames + frame->num_bytes;
+    if (len > out_size) {
+        return 0;
+    }
+
+    const ir_dw_timing_t *t = &frame->timing;
+    const uint16_t timing[] = {
+        t->header_mark_us, t->header_space_us, t->zero_mark_us, t->zero_space_us,
+        t->one_mark_us, t->one_space_us, t->stop_mark_us, t->frame_gap_us,
+    };
+
+    uint8_t *p = out;
+    for (size_t i = 0; i < sizeof(timing) / sizeof(timing[0]); i++, p += 2) {
+        put_u16(p, timing[i]);
+    }
+    *p++ = (frame->pulse_width ? 0x01 : 0) | (frame->msb_first ? 0x02 : 0);
+    *p++ = frame->num_frames;
+    *p++ = frame->header_mask;
+    for (uint8_t f = 0; f < frame->num_frames; f++, p += 2) {
+        put_u16(p, frame->frame_bits[f]);
+    }
+    memcpy(p, frame->bytes, frame->num_bytes);
+
+    return len;
+}
+
+esp_err_t ir_dw_unpack(const uint8_t *in, size_t len, ir_dw_frame_t *frame) {
+    if (in == NULL || frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < sizeof(ir_dw_timing_t) + 3) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memset(frame, 0, sizeof(*frame));
+    const uint8_t *p = in;
+
+    ir_dw_timing_t *t = &frame->timing;
+    uint16_t *timing[] = {
+        &t->header_mark_us, &t->header_space_us, &t->zero_mark_us, &t->zero_space_us,
+        &t->one_mark_us, &t->one_space_us, &t->stop_mark_us, &t->frame_gap_us,
+    };
+    for (size_t i = 0; i < sizeof(timing) / sizeof(timing[0]); i++, p += 2) {
+        *timing[i] = get_u16(p);
+    }
+
+    frame->pulse_width = (*p & 0x01) != 0;
+    frame->msb_first = (*p++ & 0x02) != 0;
+    frame->num_frames = *p++;
+    frame->header_mask = *p++;
+
+    if (frame->num_frames == 0 || frame->num_frames > IR_DW_MAX_FRAMES ||
+        (size_t)(p - in) + 2 * frame->num_frames > len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t num_bytes = 0;
+    for (uint8_t f = 0; f < frame->num_frames; f++, p += 2) {
+        frame->frame_bits[f] = get_u16(p);
+        frame->total_bits += frame->frame_bits[f];
+        num_bytes += (frame->frame_bits[f] + 7) / 8;
+    }
+
+    if (num_bytes > IR_DW_MAX_BYTES || (size_t)(p - in) + num_bytes != len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    frame->num_bytes = (uint8_t)num_bytes;
+    memcpy(frame->bytes, p, num_bytes);
+
+    return ESP_OK;
+}
+
+esp_err_t ir_decode_distance_width(const rmt_symbol_word_t *symbols,
+                                    size_t num_symbols,
+                                    ir_code_t *code) {
+    if (symbols == NULL || code == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ir_dw_frame_t frame;
+    esp_err_t ret = ir_dw_decode(symbols, num_symbols, &frame);
     if (ret != ESP_OK) {
         return ret;
     }
 
+    // Legacy 32-bit view: leading bits of the first frame, in transmission order
+    uint16_t legacy_bits = frame.frame_bits[0] > 32 ? 32 : frame.frame_bits[0];
+    uint32_t decoded_data = 0;
+    for (uint16_t bit = 0; bit < legacy_bits; bit++) {
+        uint32_t value = ir_dw_get_bit(&frame, 0, bit);
+        if (frame.msb_first) {
+            decoded_data = (decoded_data << 1) | value;
+        } else {
+            decoded_data |= value << bit;
+        }
+    }
+
     /*
-     * STEP 5: Fill result structure
+     * Fill result structure
      */
 
-    code->protocol = is_pulse_width ? IR_PROTOCOL_PULSE_WIDTH : IR_PROTOCOL_PULSE_DISTANCE;
+    code->protocol = frame.pulse_width ? IR_PROTOCOL_PULSE_WIDTH : IR_PROTOCOL_PULSE_DISTANCE;
     code->data = decoded_data;
-    code->bits = num_bits;
+    code->bits = frame.total_bits;
     code->address = 0;  // Cannot extract without protocol knowledge
     code->command = 0;  // Cannot extract without protocol knowledge
-    code->flags = 0;    // LSB first by default
+    code->flags = frame.msb_first ? IR_FLAG_MSB_FIRST : 0;
+
+    // Full timing + bytes so the code can be saved and re-sent exactly
+    uint8_t packed[IR_DW_PACKED_MAX_SIZE];
+    size_t packed_len = ir_dw_pack(&frame, packed, sizeof(packed));
+    ret = ir_code_set_payload(code, packed, packed_len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
-    ESP_LOGI(TAG, "Decoded %s: %u bits, data=0x%08lX",
-             is_pulse_width ? "PULSE_WIDTH" : "PULSE_DISTANCE",
-             num_bits, decoded_data);
+    ESP_LOGI(TAG, "Decoded %s: %u bits in %u frame(s), %s first, data=0x%08lX",
+             frame.pulse_width ? "PULSE_WIDTH" : "PULSE_DISTANCE",
+             frame.total_bits, frame.num_frames, frame.msb_first ? "MSB" : "LSB",
+             decoded_data);
 
-    ESP_LOGI(TAG, "Timing info: header=%u/%uus, 0=%u/%uus, 1=%u/%uus",
-             (unsigned int)symbols[0].duration0, (unsigned int)symbols[0].duration1,
-             mark_short_us, space_short_us,
-             is_pulse_width ? mark_long_us : mark_short_us,
-             is_pulse_width ? space_short_us : space_long_us);
+    ESP_LOGI(TAG, "Timing info: header=%u/%uus, 0=%u/%uus, 1=%u/%uus, gap=%uus",
+             frame.timing.header_mark_us, frame.timing.header_space_us,
+             frame.timing.zero_mark_us, frame.timing.zero_space_us,
+             frame.timing.one_mark_us, frame.timing.one_space_us,
+             frame.timing.frame_gap_us);
 
     return ESP_OK;
 }
@@ -11,6 +11,11 @@
  * 3. Classify as pulse distance, pulse width, or combined
  * 4. Decode bits based on discovered timing
  *
+ * Captures are first split into frames at long spaces so multi-frame AC
+ * remotes (Mitsubishi, Panasonic, Daikin...) decode as one byte array.
+ * Bit order is not encoded on the wire; it is chosen by checking which
+ * order makes the trailing byte of each frame a valid checksum.
+ *
  * Based on Arduino-IRremote library ir_DistanceWidthProtocol.hpp
  * https://github.com/Arduino-IRremote/Arduino-IRremote
  *
@@ -55,11 +60,126 @@ extern "C" {
  */
 #define IR_DW_MAX_REPEAT_GAP_US       100000  // 100ms
 
+/**
+ * @brief Frame splitting and payload limits
+ *
+ * A space longer than IR_DW_MIN_FRAME_GAP_US ends a frame. It is above
+ * every header space in the protocol table (NEC/Samsung 4.5ms). The
+ * receiver already ends a capture at its 10ms idle threshold, so only
+ * frames sent 6-10ms apart (multi-part AC frames) reach this split;
+ * repeats further apart arrive as captures of their own.
+ *
+ * IR_DW_MAX_BYTES covers the longest AC frames (Daikin 312 bits = 39
+ * bytes); frames are stored back to back, each starting on a byte boundary.
+ */
+#define IR_DW_MIN_FRAME_GAP_US        6000
+#define IR_DW_MAX_FRAMES              4
+#define IR_DW_MAX_BYTES               40
+
+/**
+ * @brief Timing recovered from a capture (enough to re-transmit it)
+ */
+typedef struct {
+    uint16_t header_mark_us;    // 0 = frames have no header
+    uint16_t header_space_us;
+    uint16_t zero_mark_us;
+    uint16_t zero_space_us;
+    uint16_t one_mark_us;
+    uint16_t one_space_us;
+    uint16_t stop_mark_us;      // 0 = no stop bit (pulse width)
+    uint16_t frame_gap_us;      // Space between frames (0 = single frame)
+} ir_dw_timing_t;
+
+/**
+ * @brief Decoded pulse distance/width capture
+ */
+typedef struct {
+    ir_dw_timing_t timing;
+    bool pulse_width;                           // true = mark encodes the bit
+    bool msb_first;                             // Chosen by checksum heuristics
+    uint8_t num_frames;
+    uint8_t header_mask;                        // Bit n set = frame n starts with header
+    uint16_t frame_bits[IR_DW_MAX_FRAMES];      // Data bits per frame
+    uint16_t total_bits;
+    uint8_t num_bytes;                          // Used bytes in @p bytes
+    uint8_t bytes[IR_DW_MAX_BYTES];
+} ir_dw_frame_t;
+
+/**
+ * @brief Decode a capture into timing + byte array
+ *
+ * @param symbols RMT symbols (level 1 = mark)
+ * @param num_symbols Number of symbols
+ * @param frame Output frame
+ * @return ESP_OK if every frame decoded with the same two-bin timing
+ *         ESP_ERR_INVALID_ARG if too few symbols
+ *         ESP_FAIL if the capture is not pulse distance/width or too long
+ */
+esp_err_t ir_dw_decode(const rmt_symbol_word_t *symbols, size_t num_symbols,
+                       ir_dw_frame_t *frame);
+
+/**
+ * @brief Rebuild RMT TX symbols from a decoded frame
+ *
+ * Gaps longer than one RMT duration field are split over idle symbols.
+ *
+ * @param frame Decoded frame
+ * @param symbols Output buffer (level 1 = mark)
+ * @param max_symbols Capacity of @p symbols
+ * @return Number of symbols written, 0 if @p symbols is too small
+ */
+size_t ir_dw_build_symbols(const ir_dw_frame_t *frame, rmt_symbol_word_t *symbols,
+                           size_t max_symbols);
+
+/**
+ * @brief Get bit @p index of a decoded frame in transmission order
+ */
+bool ir_dw_get_bit(const ir_dw_frame_t *frame, uint8_t frame_index, uint16_t index);
+
+/**
+ * @brief Re-pack the bytes LSB first, undoing the bit order guess
+ *
+ * For callers that know the protocol family: every AC frame map is LSB
+ * first, and an XOR-checked frame can match a sum checksum MSB first by
+ * chance. Bits in transmission order do not change.
+ */
+void ir_dw_set_lsb_first(ir_dw_frame_t *frame);
+
+/**
+ * @brief Longest packed frame: timing + 3 flag bytes + bit counts + bytes
+ */
+#define IR_DW_PACKED_MAX_SIZE   (sizeof(ir_dw_timing_t) + 3 + 2 * IR_DW_MAX_FRAMES + IR_DW_MAX_BYTES)
+
+/**
+ * @brief Pack a decoded frame into a compact byte record
+ *
+ * This is the payload stored with PULSE_DISTANCE/PULSE_WIDTH codes, so a
+ * learned unknown protocol can be saved and re-transmitted exactly.
+ * Layout (little-endian): 8 timing words, flags (bit 0 pulse width,
+ * bit 1 MSB first), num_frames, header_mask, frame_bits[num_frames], bytes.
+ *
+ * @param frame Decoded frame
+ * @param out Output buffer (IR_DW_PACKED_MAX_SIZE is always enough)
+ * @param out_size Capacity of @p out
+ * @return Packed length, 0 if @p out is too small
+ */
+size_t ir_dw_pack(const ir_dw_frame_t *frame, uint8_t *out, size_t out_size);
+
+/**
+ * @brief Unpack a record written by ir_dw_pack()
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the record is truncated or inconsistent
+ */
+esp_err_t ir_dw_unpack(const uint8_t *in, size_t len, ir_dw_frame_t *frame);
+
 /**
  * @brief Decode pulse distance or pulse width protocol from RMT symbols
  *
  * This universal decoder analyzes the timing characteristics of an IR signal
  * and attempts to decode it without prior knowledge of the specific protocol.
+ * Wraps ir_dw_decode(): @p code gets the total bit count, the first 32
+ * bits in transmission order in @c data, and the ir_dw_pack() record as
+ * its out-of-line payload.
  *
  * @param symbols Pointer to RMT symbol array
  * @param num_symbols Number of symbols in array
@@ -5,23 +5,12 @@
 
 #include "ir_fujitsu.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
 static const char *TAG = "IR_FUJITSU";
 
-/**
- * @brief Calculate Fujitsu checksum
- */
-static uint8_t fujitsu_checksum(const uint8_t *data, uint8_t len) {
-    uint8_t sum = 0;
-    // Sum all bytes except last (checksum byte)
-    for (uint8_t i = 0; i < len - 1; i++) {
-        sum += data[i];
-    }
-    return (0x100 - sum) & 0xFF;  // Two's complement
-}
-
 esp_err_t ir_decode_fujitsu(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code) {
     if (!symbols || !code || num_symbols < FUJITSU_MIN_BITS + 1) {
         return ESP_ERR_INVALID_ARG;
@@ -48,6 +37,11 @@ esp_err_t ir_decode_fujitsu(const rmt_symbol_word_t *symbols, size_t num_symbols
         num_bytes = FUJITSU_MAX_BYTES;
     }
 
+    // Longer frames (Mitsubishi, Hitachi) would only be truncated
+    if (!ir_frame_ends_at(symbols, num_symbols, 1 + num_bytes * 8, FUJITSU_HEADER_SPACE)) {
+        return ESP_FAIL;
+    }
+
     // Decode data
     uint8_t data[FUJITSU_MAX_BYTES] = {0};
 
@@ -77,7 +71,8 @@ esp_err_t ir_decode_fujitsu(const rmt_symbol_word_t *symbols, size_t num_symbols
     }
 
     // Validate checksum
-    uint8_t calculated_checksum = fujitsu_checksum(data, num_bytes);
+    // Two's complement of the byte sum of all bytes but the checksum
+    uint8_t calculated_checksum = (uint8_t)-ir_checksum_byte_sum(data, num_bytes - 1);
     uint8_t received_checksum = data[num_bytes - 1];
     bool checksum_ok = (calculated_checksum == received_checksum);
 
@@ -94,7 +89,13 @@ esp_err_t ir_decode_fujitsu(const rmt_symbol_word_t *symbols, size_t num_symbols
     code->command = data[5 < num_bytes ? 5 : 0];  // Command/mode byte
     code->flags = 0;
 
-    // Store first 4 bytes in data field
+    // Whole frame as payload (out of line when longer than 16 bytes)
+    esp_err_t err = ir_code_set_payload(code, data, num_bytes);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // First 4 bytes as the legacy 32-bit view
     code->data = (uint32_t)data[0] |
                  ((uint32_t)data[1] << 8) |
                  ((uint32_t)data[2] << 16) |
@@ -5,6 +5,7 @@
 
 #include "ir_haier.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
@@ -46,10 +47,7 @@ esp_err_t ir_decode_haier(const rmt_symbol_word_t *symbols, size_t num_symbols,
     }
 
     // Validate checksum (XOR of all bytes except last)
-    uint8_t checksum = 0;
-    for (uint8_t i = 0; i < HAIER_BYTES - 1; i++) {
-        checksum ^= data[i];
-    }
+    uint8_t checksum = ir_checksum_xor(data, HAIER_BYTES - 1);
 
     bool checksum_ok = (checksum == data[HAIER_BYTES - 1]);
     if (!checksum_ok) {
@@ -64,7 +62,13 @@ esp_err_t ir_decode_haier(const rmt_symbol_word_t *symbols, size_t num_symbols,
     code->command = data[9];  // Command byte
     code->flags = 0;
 
-    // Store first 4 bytes in data field
+    // Whole frame as payload (out of line when longer than 16 bytes)
+    esp_err_t err = ir_code_set_payload(code, data, HAIER_BYTES);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // First 4 bytes as the legacy 32-bit view
     code->data = (uint32_t)data[0] |
                  ((uint32_t)data[1] << 8) |
                  ((uint32_t)data[2] << 16) |
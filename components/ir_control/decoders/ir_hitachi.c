@@ -7,27 +7,12 @@
 
 #include "ir_hitachi.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
 static const char *TAG = "IR_HITACHI";
 
-/**
- * @brief Calculate Hitachi AC checksum
- *
- * Hitachi uses byte sum modulo 256
- */
-static uint8_t hitachi_checksum(const uint8_t *data, uint8_t len) {
-    uint16_t sum = 0;
-
-    // Sum all bytes except last (checksum byte)
-    for (uint8_t i = 0; i < len - 1; i++) {
-        sum += data[i];
-    }
-
-    return sum & 0xFF;  // Modulo 256
-}
-
 esp_err_t ir_decode_hitachi(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code) {
     if (!symbols || !code || num_symbols < HITACHI_MIN_BITS + 1) {
         return ESP_ERR_INVALID_ARG;
@@ -82,7 +67,8 @@ esp_err_t ir_decode_hitachi(const rmt_symbol_word_t *symbols, size_t num_symbols
     }
 
     // Validate checksum
-    uint8_t calculated_checksum = hitachi_checksum(data, num_bytes);
+    // Byte sum modulo 256 of all bytes but the checksum
+    uint8_t calculated_checksum = ir_checksum_byte_sum(data, num_bytes - 1);
     uint8_t received_checksum = data[num_bytes - 1];
     bool checksum_ok = (calculated_checksum == received_checksum);
 
@@ -99,7 +85,13 @@ esp_err_t ir_decode_hitachi(const rmt_symbol_word_t *symbols, size_t num_symbols
     code->command = data[11 < num_bytes ? 11 : 1];  // Mode/temp byte
     code->flags = 0;
 
-    // Store first 4 bytes in data field
+    // Whole frame as payload (out of line when longer than 16 bytes)
+    esp_err_t err = ir_code_set_payload(code, data, num_bytes);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // First 4 bytes as the legacy 32-bit view
     code->data = (uint32_t)data[0] |
                  ((uint32_t)data[1] << 8) |
                  ((uint32_t)data[2] << 16) |
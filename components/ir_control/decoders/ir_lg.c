@@ -8,6 +8,7 @@
 
 #include "ir_lg.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 
 static const char *TAG = "IR_LG";
@@ -55,15 +56,9 @@ esp_err_t ir_decode_lg(const rmt_symbol_word_t *symbols,
     uint16_t command = (decoded_data >> 8) & 0xFFFF;
     uint8_t checksum_received = (decoded_data >> 24) & 0x0F;
 
-    // Validate checksum (sum of nibbles)
-    uint8_t checksum_calc = 0;
-    checksum_calc += (address & 0x0F);
-    checksum_calc += (address >> 4);
-    checksum_calc += (command & 0x0F);
-    checksum_calc += ((command >> 4) & 0x0F);
-    checksum_calc += ((command >> 8) & 0x0F);
-    checksum_calc += ((command >> 12) & 0x0F);
-    checksum_calc &= 0x0F;
+    // Validate checksum (sum of nibbles of the low 24 bits)
+    const uint8_t fields[3] = { address, (uint8_t)command, (uint8_t)(command >> 8) };
+    uint8_t checksum_calc = ir_checksum_nibble_sum(fields, sizeof(fields));
 
     code->protocol = IR_PROTOCOL_LG;
     code->data = decoded_data;
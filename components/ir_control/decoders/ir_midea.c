@@ -5,6 +5,7 @@
 
 #include "ir_midea.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
@@ -46,13 +47,10 @@ esp_err_t ir_decode_midea(const rmt_symbol_word_t *symbols, size_t num_symbols,
     }
 
     // Validate inverted bytes (bytes 3-5 should be inverse of bytes 0-2)
-    bool validation_ok = true;
-    for (uint8_t i = 0; i < 3; i++) {
-        if (data[i] != (uint8_t)~data[i + 3]) {
-            ESP_LOGW(TAG, "Byte %d: data=0x%02X, inverted=0x%02X (expected 0x%02X)",
-                     i, data[i], data[i + 3], (uint8_t)~data[i]);
-            validation_ok = false;
-        }
+    bool validation_ok = ir_checksum_inverted_halves(data, MIDEA_BYTES);
+    if (!validation_ok) {
+        ESP_LOGW(TAG, "Inverted bytes mismatch: %02X %02X %02X / %02X %02X %02X",
+                 data[0], data[1], data[2], data[3], data[4], data[5]);
     }
 
     // Fill code structure
@@ -62,10 +60,11 @@ esp_err_t ir_decode_midea(const rmt_symbol_word_t *symbols, size_t num_symbols,
     code->command = data[1];  // Second byte is command/temp
     code->flags = 0;
 
-    // Store first 3 bytes (actual data, not inverted) in data field
-    code->data = (uint32_t)data[0] |
-                 ((uint32_t)data[1] << 8) |
-                 ((uint32_t)data[2] << 16);
+    // Whole frame inline (data = first 4 bytes)
+    esp_err_t err = ir_code_set_payload(code, data, MIDEA_BYTES);
+    if (err != ESP_OK) {
+        return err;
+    }
 
     ESP_LOGI(TAG, "Decoded Midea AC: Addr=0x%02X, Cmd=0x%02X, Validation=%s",
              data[0], data[1], validation_ok ? "OK" : "FAIL");
@@ -5,6 +5,7 @@
 
 #include "ir_mitsubishi.h"
 #include "ir_timing.h"
+#include "ir_checksum.h"
 #include "esp_log.h"
 #include <string.h>
 
@@ -21,6 +22,11 @@ esp_err_t ir_decode_mitsubishi(const rmt_symbol_word_t *symbols, size_t num_symb
         return ESP_FAIL;
     }
 
+    // Hitachi frames start with the same timing and run longer
+    if (!ir_frame_ends_at(symbols, num_symbols, MITSUBISHI_BITS + 1, MITSUBISHI_HEADER_SPACE)) {
+        return ESP_FAIL;
+    }
+
     // Decode 152 bits (19 bytes)
     uint8_t data[MITSUBISHI_BYTES] = {0};
 
@@ -46,10 +52,7 @@ esp_err_t ir_decode_mitsubishi(const rmt_symbol_word_t *symbols, size_t num_symb
     }
 
     // Validate checksum (byte sum of first 18 bytes)
-    uint8_t checksum = 0;
-    for (uint_fast8_t i = 0; i < MITSUBISHI_BYTES - 1; i++) {
-        checksum += data[i];
-    }
+    uint8_t checksum = ir_checksum_byte_sum(data, MITSUBISHI_BYTES - 1);
 
     if (checksum != data[MITSUBISHI_BYTES - 1]) {
         ESP_LOGW(TAG, "Checksum failed: expected 0x%02X, got 0x%02X",
@@ -64,7 +67,13 @@ esp_err_t ir_decode_mitsubishi(const rmt_symbol_word_t *symbols, size_t num_symb
     code->command = data[5];  // Command byte (mode/temp)
     code->flags = 0;
 
-    // Store full data in data field (first 4 bytes for compatibility)
+    // Whole frame as payload (out of line when longer than 16 bytes)
+    esp_err_t err = ir_code_set_payload(code, data, MITSUBISHI_BYTES);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // First 4 bytes as the legacy 32-bit view
     code->data = (uint32_t)data[0] |
                  ((uint32_t)data[1] << 8) |
                  ((uint32_t)data[2] << 16) |
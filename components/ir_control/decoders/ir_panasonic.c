@@ -17,6 +17,11 @@ esp_err_t ir_decode_panasonic(const rmt_symbol_word_t *symbols, size_t num_symbo
         return ESP_FAIL;
     }
 
+    // Daikin, Mitsubishi and Hitachi frames start with the same timing
+    if (!ir_frame_ends_at(symbols, num_symbols, PANASONIC_BITS + 1, PANASONIC_HEADER_SPACE)) {
+        return ESP_FAIL;
+    }
+
     uint64_t decoded_data = 0;
     for (uint_fast8_t i = 0; i < PANASONIC_BITS; i++) {
         const rmt_symbol_word_t *sym = &symbols[i + 1];
@@ -30,12 +35,21 @@ esp_err_t ir_decode_panasonic(const rmt_symbol_word_t *symbols, size_t num_symbo
     }
 
     code->protocol = IR_PROTOCOL_PANASONIC;
-    code->data = (uint32_t)(decoded_data & 0xFFFFFFFF);
     code->bits = PANASONIC_BITS;
     code->address = (decoded_data >> 32) & 0xFFFF;
     code->command = decoded_data & 0xFFFF;
     code->flags = 0;
 
+    // All 6 bytes inline, LSB first (also sets data to the low 32 bits)
+    uint8_t payload[PANASONIC_BITS / 8];
+    for (uint_fast8_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(decoded_data >> (8 * i));
+    }
+    esp_err_t err = ir_code_set_payload(code, payload, sizeof(payload));
+    if (err != ESP_OK) {
+        return err;
+    }
+
     ESP_LOGI(TAG, "Decoded Panasonic: 48-bit data");
     return ESP_OK;
 }
@@ -3,79 +3,56 @@
  * @brief Philips RC5 Protocol Decoder Implementation
  *
  * RC5 uses bi-phase (Manchester) encoding where each bit is represented by a transition:
- * - "0": Space-to-Mark transition (low to high)
- * - "1": Mark-to-Space transition (high to low)
+ * - "0": Mark-to-Space transition (high to low)
+ * - "1": Space-to-Mark transition (low to high)
+ *
+ * The first half of the first start bit is a space and therefore never
+ * captured; the bi-phase engine re-inserts it (implicit_leading_space).
  */
 
 #include "ir_rc5.h"
-#include "ir_timing.h"
+#include "ir_biphase.h"
 #include "esp_log.h"
 #include <string.h>
 
 static const char *TAG = "IR_RC5";
 
-/**
- * @brief Decode bi-phase (Manchester) encoded bit from RC5 symbol
- *
- * RC5 bi-phase encoding:
- * - Each bit period is 1778us (2 * 889us)
- * - "1": Mark(889us) then Space(889us)
- * - "0": Space(889us) then Mark(889us)
- */
-static esp_err_t decode_rc5_bit(const rmt_symbol_word_t *symbols, size_t *idx,
-                                 size_t num_symbols, uint8_t *bit_value) {
-    if (*idx >= num_symbols) {
-        return ESP_FAIL;
-    }
-
-    const rmt_symbol_word_t *sym = &symbols[*idx];
-    uint16_t duration0 = sym->duration0;
-    uint16_t duration1 = sym->duration1;
-
-    // Check for Manchester encoding (both durations should be ~889us)
-    if (ir_timing_matches_percent(duration0, RC5_UNIT, 25) &&
-        ir_timing_matches_percent(duration1, RC5_UNIT, 25)) {
-
-        // Bit value depends on which comes first (mark or space)
-        // Note: IR receiver inverts, so we check level0
-        if (sym->level0 == 0) {
-            // Space then Mark = "0"
-            *bit_value = 0;
-        } else {
-            // Mark then Space = "1"
-            *bit_value = 1;
-        }
+// Minimum RMT symbols for 14 bi-phase bits (every half-bit merged with a neighbour)
+#define RC5_MIN_SYMBOLS           7
 
-        (*idx)++;
-        return ESP_OK;
-    }
-
-    return ESP_FAIL;
-}
+static const ir_biphase_config_t rc5_biphase = {
+    .unit_us = RC5_UNIT,
+    .tolerance_percent = 0,         // Engine default
+    .leader_mark_units = 0,         // No leader
+    .leader_space_units = 0,
+    .one_is_mark_first = false,     // "1" = space -> mark
+    .implicit_leading_space = true,
+};
 
 esp_err_t ir_decode_rc5(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code) {
-    if (!symbols || !code || num_symbols < RC5_BITS) {
+    if (!symbols || !code || num_symbols < RC5_MIN_SYMBOLS) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    size_t idx = 0;
-    uint16_t decoded_value = 0;
-
-    // Decode 14 bits (start bits + toggle + address + command)
-    for (uint8_t i = 0; i < RC5_BITS; i++) {
-        uint8_t bit_value = 0;
+    ir_biphase_decoder_t dec;
+    if (ir_biphase_begin(&dec, &rc5_biphase, symbols, num_symbols) != ESP_OK) {
+        return ESP_FAIL;
+    }
 
-        if (decode_rc5_bit(symbols, &idx, num_symbols, &bit_value) != ESP_OK) {
-            return ESP_FAIL;
-        }
+    // Decode 14 bits (start bits + toggle + address + command), MSB first
+    uint32_t decoded_value = 0;
+    if (ir_biphase_read_bits(&dec, RC5_BITS, false, &decoded_value) != ESP_OK) {
+        return ESP_FAIL;
+    }
 
-        // Build value MSB first
-        decoded_value = (decoded_value << 1) | bit_value;
+    // Reject longer bi-phase frames (e.g. RC6 or RC-MM)
+    if (!ir_biphase_at_end(&dec)) {
+        return ESP_FAIL;
     }
 
     // Extract fields from 14-bit value
     // Format: SS T AAAAA CCCCCC
-    // SS = Start bits (should be 11)
+    // SS = Start bits (S1 always 1, S2 = inverted command bit 6 for RC5X)
     // T = Toggle bit
     // A = Address (5 bits)
     // C = Command (6 bits)
@@ -85,10 +62,12 @@ esp_err_t ir_decode_rc5(const rmt_symbol_word_t *symbols, size_t num_symbols, ir
     uint8_t address = (decoded_value >> 6) & 0x1F;
     uint8_t command = decoded_value & 0x3F;
 
-    // Validate start bits (should be 0b11 for standard RC5)
-    if (start_bits != 0x03) {
-        ESP_LOGD(TAG, "Invalid start bits: 0x%X (expected 0x3)", start_bits);
-        // Continue anyway - might be extended RC5
+    if ((start_bits & 0x02) == 0) {
+        ESP_LOGD(TAG, "Invalid start bit S1");
+        return ESP_FAIL;
+    }
+    if ((start_bits & 0x01) == 0) {
+        command |= 0x40;  // RC5X extended command
     }
 
     // Fill code structure
@@ -104,3 +83,11 @@ esp_err_t ir_decode_rc5(const rmt_symbol_word_t *symbols, size_t num_symbols, ir
 
     return ESP_OK;
 }
+
+size_t ir_rc5_build_symbols(const ir_code_t *code, rmt_symbol_word_t *symbols, size_t max_symbols) {
+    if (!code || code->bits != RC5_BITS) {
+        return 0;
+    }
+    return ir_biphase_build_symbols(&rc5_biphase, code->data & ((1u << RC5_BITS) - 1), RC5_BITS,
+                                    -1, symbols, max_symbols);
+}
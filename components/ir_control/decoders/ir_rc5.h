@@ -11,17 +11,20 @@
  * - Based on Arduino-IRremote library, MIT License
  *
  * Protocol Structure:
- * - Start bits: 2 bits (always 1,1 except for extended RC5)
+ * - Start bits: 2 bits (1,1 - RC5X uses the second one as inverted command bit 6)
  * - Toggle bit: 1 bit (inverts each button press)
  * - Address: 5 bits (device type)
  * - Command: 6 bits (button/function)
  * - Total: 14 bits
- * - Bi-phase encoding: Each bit is half mark + half space (or vice versa)
+ * - Bi-phase encoding: "1" = space then mark, "0" = mark then space
  *
  * Timing:
- * - Bit period: 1778us (889us mark + 889us space for "1")
+ * - Bit period: 1778us (2 x 889us half-bits)
  * - Carrier: 36kHz
  *
+ * Decoding is done by the shared bi-phase engine (ir_biphase.h), which
+ * handles half-bits merged by the RMT peripheral.
+ *
  * Reference: https://github.com/Arduino-IRremote/Arduino-IRremote
  */
 
@@ -46,9 +49,10 @@ extern "C" {
 #define RC5_BITS                  14      // Total bits including start + toggle
 
 /**
- * @brief Decode Philips RC5 IR protocol
+ * @brief Decode Philips RC5 / RC5X IR protocol
  *
- * Handles bi-phase (Manchester) encoding with toggle bit detection
+ * Handles bi-phase (Manchester) encoding with toggle bit detection.
+ * RC5X (second start bit = 0) yields a 7-bit command.
  *
  * @param symbols RMT symbol array
  * @param num_symbols Number of symbols
@@ -57,6 +61,14 @@ extern "C" {
  */
 esp_err_t ir_decode_rc5(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code);
 
+/**
+ * @brief Build RMT TX symbols for an RC5 code (data as ir_decode_rc5() fills it)
+ *
+ * @return Number of symbols written, 0 if the code is not a 14-bit RC5 frame
+ *         or @p symbols is too small
+ */
+size_t ir_rc5_build_symbols(const ir_code_t *code, rmt_symbol_word_t *symbols, size_t max_symbols);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,123 +5,147 @@
  * RC6 uses bi-phase encoding similar to RC5 but with important differences:
  * - Has a leader pulse
  * - Has a "trailer bit" (toggle bit) with DOUBLE length
- * - More complex timing
+ * - Opposite bit polarity to RC5 ("1" = mark then space)
+ * - Payload length depends on mode (16/20/24/32 bits)
  */
 
 #include "ir_rc6.h"
-#include "ir_timing.h"
+#include "ir_biphase.h"
 #include "esp_log.h"
 #include <string.h>
 
 static const char *TAG = "IR_RC6";
 
-/**
- * @brief Decode standard RC6 bi-phase bit (444us periods)
- */
-static esp_err_t decode_rc6_bit(const rmt_symbol_word_t *symbols, size_t *idx,
-                                 size_t num_symbols, uint8_t *bit_value, bool is_trailer) {
-    if (*idx >= num_symbols) {
-        return ESP_FAIL;
-    }
-
-    const rmt_symbol_word_t *sym = &symbols[*idx];
-    uint16_t duration0 = sym->duration0;
-    uint16_t duration1 = sym->duration1;
+// Minimum RMT symbols: leader + 1 start + 3 mode + trailer + 16 payload, maximally merged
+#define RC6_MIN_SYMBOLS           10
 
-    // Trailer bit is double length (889us each half instead of 444us)
-    uint16_t expected_duration = is_trailer ? (RC6_UNIT * 2) : RC6_UNIT;
+static const ir_biphase_config_t rc6_biphase = {
+    .unit_us = RC6_UNIT,
+    .tolerance_percent = 0,         // Engine default
+    .leader_mark_units = RC6_LEADER_MARK_UNITS,
+    .leader_space_units = RC6_LEADER_SPACE_UNITS,
+    .one_is_mark_first = true,      // "1" = mark -> space
+    .implicit_leading_space = false,
+};
 
-    if (ir_timing_matches_percent(duration0, expected_duration, 30) &&
-        ir_timing_matches_percent(duration1, expected_duration, 30)) {
-
-        // Bit value depends on transition direction
-        if (sym->level0 == 0) {
-            *bit_value = 0;  // Space-to-Mark = "0"
-        } else {
-            *bit_value = 1;  // Mark-to-Space = "1"
-        }
-
-        (*idx)++;
-        return ESP_OK;
+/**
+ * @brief Check payload length is one of the known RC6 variants
+ */
+static bool rc6_payload_valid(uint8_t mode, uint8_t payload_bits) {
+    if (mode == 0) {
+        return payload_bits == 16;
     }
-
-    return ESP_FAIL;
+    return payload_bits == 16 || payload_bits == 20 ||
+           payload_bits == 24 || payload_bits == 32;
 }
 
 esp_err_t ir_decode_rc6(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code) {
-    if (!symbols || !code || num_symbols < 20) {
+    if (!symbols || !code || num_symbols < RC6_MIN_SYMBOLS) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    size_t idx = 0;
-
-    // Check leader (long mark + space)
-    if (!ir_match_mark(&symbols[idx], RC6_HEADER_MARK, 0) ||
-        !ir_match_space(&symbols[idx], RC6_HEADER_SPACE, 0)) {
+    ir_biphase_decoder_t dec;
+    if (ir_biphase_begin(&dec, &rc6_biphase, symbols, num_symbols) != ESP_OK) {
         return ESP_FAIL;
     }
-    idx++;
 
     // Decode start bit (should be 1)
-    uint8_t start_bit = 0;
-    if (decode_rc6_bit(symbols, &idx, num_symbols, &start_bit, false) != ESP_OK) {
+    uint32_t start_bit = 0;
+    if (ir_biphase_read_bits(&dec, 1, false, &start_bit) != ESP_OK || start_bit != 1) {
+        ESP_LOGD(TAG, "Invalid start bit");
         return ESP_FAIL;
     }
 
-    if (start_bit != 1) {
-        ESP_LOGD(TAG, "Invalid start bit: %d", start_bit);
+    // Decode mode (3 bits)
+    uint32_t mode = 0;
+    if (ir_biphase_read_bits(&dec, RC6_MODE_BITS, false, &mode) != ESP_OK) {
         return ESP_FAIL;
     }
 
-    // Decode mode (3 bits)
-    uint8_t mode = 0;
-    for (uint8_t i = 0; i < 3; i++) {
-        uint8_t bit = 0;
-        if (decode_rc6_bit(symbols, &idx, num_symbols, &bit, false) != ESP_OK) {
-            return ESP_FAIL;
-        }
-        mode = (mode << 1) | bit;
+    // Decode trailer bit (toggle bit - DOUBLE LENGTH!)
+    uint32_t toggle_bit = 0;
+    if (ir_biphase_read_bits(&dec, 1, true, &toggle_bit) != ESP_OK) {
+        return ESP_FAIL;
     }
 
-    // Decode trailer bit (toggle bit - DOUBLE LENGTH!)
-    uint8_t toggle_bit = 0;
-    if (decode_rc6_bit(symbols, &idx, num_symbols, &toggle_bit, true) != ESP_OK) {
+    // Payload length is whatever remains in the frame
+    uint8_t payload_bits = ir_biphase_remaining_bits(&dec);
+    if (!rc6_payload_valid((uint8_t)mode, payload_bits)) {
+        ESP_LOGD(TAG, "Unsupported payload: mode %lu, %d bits", mode, payload_bits);
         return ESP_FAIL;
     }
 
-    // Decode address (8 bits for mode 0)
-    uint8_t address = 0;
-    for (uint8_t i = 0; i < 8; i++) {
-        uint8_t bit = 0;
-        if (decode_rc6_bit(symbols, &idx, num_symbols, &bit, false) != ESP_OK) {
-            return ESP_FAIL;
-        }
-        address = (address << 1) | bit;
+    uint32_t payload = 0;
+    if (ir_biphase_read_bits(&dec, payload_bits, false, &payload) != ESP_OK ||
+        !ir_biphase_at_end(&dec)) {
+        return ESP_FAIL;
     }
 
-    // Decode command (8 bits for mode 0)
-    uint8_t command = 0;
-    for (uint8_t i = 0; i < 8; i++) {
-        uint8_t bit = 0;
-        if (decode_rc6_bit(symbols, &idx, num_symbols, &bit, false) != ESP_OK) {
-            return ESP_FAIL;
-        }
-        command = (command << 1) | bit;
+    uint16_t address = (uint16_t)(payload >> 8);
+    uint16_t command = payload & 0xFF;
+    uint32_t trailer = toggle_bit;
+
+    // RC6-6-32 (MCE) carries its toggle in payload bit 15, not the trailer
+    if (payload_bits == 32 && (payload >> 16) == RC6_MCE_CUSTOMER) {
+        toggle_bit = (payload & RC6_MCE_TOGGLE_MASK) ? 1 : 0;
+        address &= ~(RC6_MCE_TOGGLE_MASK >> 8);
     }
 
     // Fill code structure
     code->protocol = IR_PROTOCOL_RC6;
-    code->bits = 20;  // Mode 0: 1 start + 3 mode + 1 toggle + 8 addr + 8 cmd
     code->address = address;
     code->command = command;
-    code->data = ((uint32_t)mode << 17) |
-                 ((uint32_t)toggle_bit << 16) |
-                 ((uint32_t)address << 8) |
-                 command;
+    code->bits = RC6_MODE_BITS + 1 + payload_bits;
     code->flags = toggle_bit ? IR_FLAG_TOGGLE_BIT : 0;
+    if (payload_bits < 32) {
+        code->data = (mode << (payload_bits + 1)) |
+                     (trailer << payload_bits) |
+                     payload;
+    } else {
+        // Same layout, one byte wider: data stays the payload
+        uint8_t bytes[5] = {
+            payload & 0xFF, (payload >> 8) & 0xFF, (payload >> 16) & 0xFF, payload >> 24,
+            (uint8_t)((mode << 1) | trailer),
+        };
+        esp_err_t err = ir_code_set_payload(code, bytes, sizeof(bytes));
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
 
-    ESP_LOGI(TAG, "Decoded RC6: Mode=%d, Addr=0x%02X, Cmd=0x%02X, Toggle=%d",
-             mode, address, command, toggle_bit);
+    ESP_LOGI(TAG, "Decoded RC6-%lu-%d: Addr=0x%04X, Cmd=0x%02X, Toggle=%lu",
+             mode, payload_bits, address, command, toggle_bit);
 
     return ESP_OK;
 }
+
+size_t ir_rc6_build_symbols(const ir_code_t *code, rmt_symbol_word_t *symbols, size_t max_symbols) {
+    if (!code) {
+        return 0;
+    }
+
+    size_t len;
+    const uint8_t *bytes = ir_code_get_payload(code, &len);
+    uint64_t value = 0;
+    for (size_t i = 0; bytes && i < len && i < sizeof(value); i++) {
+        value |= (uint64_t)bytes[i] << (8 * i);
+    }
+
+    uint8_t bits = (uint8_t)code->bits;
+    if (bits == 32) {
+        // Decoded before the mode was kept: MCE frames, mode 6
+        value = (6ULL << 33) | ((uint64_t)((code->flags & IR_FLAG_TOGGLE_BIT) ? 1 : 0) << 32) |
+                (value & 0xFFFFFFFFULL);
+        bits = RC6_MODE_BITS + 1 + 32;
+    }
+
+    uint8_t payload_bits = bits > RC6_MODE_BITS + 1 ? bits - RC6_MODE_BITS - 1 : 0;
+    value &= (1ULL << bits) - 1;
+    if (!rc6_payload_valid((uint8_t)(value >> (payload_bits + 1)), payload_bits)) {
+        return 0;
+    }
+
+    // Start bit, mode, trailer (double length), payload
+    return ir_biphase_build_symbols(&rc6_biphase, value | (1ULL << bits), bits + 1,
+                                    1 + RC6_MODE_BITS, symbols, max_symbols);
+}
@@ -10,23 +10,33 @@
  * - 36kHz carrier
  * - Based on Arduino-IRremote library, MIT License
  *
- * Protocol Structure (Mode 0 - most common):
- * - Leader: Long mark + space
+ * Protocol Structure:
+ * - Leader: 6T mark + 2T space
  * - Start bit: 1 bit (always 1)
- * - Mode: 3 bits (000 for mode 0)
- * - Toggle bit: 1 bit (double-length trailer bit)
- * - Address: 8 bits
- * - Command: 8 bits
- * - Total: 21 bits (including leader and mode)
+ * - Mode: 3 bits (0 = consumer, 6 = OEM/MCE)
+ * - Trailer (toggle) bit: 1 bit, double length
+ * - Payload: 16 bits for mode 0 (8 address + 8 command),
+ *            20/24/32 bits for other modes (RC6-6-20 Sky, RC6-6-24, RC6-6-32 MCE)
  *
  * Timing:
- * - Base unit: 444us
- * - Leader mark: 2666us (6 * 444us)
- * - Leader space: 889us (2 * 444us)
- * - Bit period: 889us (2 * 444us)
- * - Trailer bit: 1778us (4 * 444us) - double length!
+ * - Base unit (T): 444us
+ * - Leader mark: 2666us (6T)
+ * - Leader space: 889us (2T)
+ * - Bit period: 889us (2T), "1" = mark then space, "0" = space then mark
+ * - Trailer bit: 1778us (4T) - double length!
  * - Carrier: 36kHz
  *
+ * Decoding is done by the shared bi-phase engine (ir_biphase.h), so bits
+ * whose halves were merged by the RMT peripheral decode correctly.
+ *
+ * Data layout in ir_code_t:
+ * - Value = mode << (n + 1) | trailer << n | payload, bits = n + 4, for an
+ *   n-bit payload (mode 0: mode << 17 | trailer << 16 | addr << 8 | cmd, bits = 20)
+ * - Up to 24-bit payloads the value is data; the 36 bits of a 32-bit payload
+ *   are payload[0..4], little-endian, so data is still the payload
+ * - address = payload >> 8, command = payload & 0xFF
+ * - MCE (RC6-6-32, customer 0x800F) reports payload bit 15 as IR_FLAG_TOGGLE_BIT
+ *
  * Reference: https://github.com/Arduino-IRremote/Arduino-IRremote
  */
 
@@ -49,12 +59,18 @@ extern "C" {
 #define RC6_BIT_MARK              (RC6_UNIT * 1)   // 444us
 #define RC6_BIT_SPACE             (RC6_UNIT * 1)   // 444us
 #define RC6_TOGGLE_MARK           (RC6_UNIT * 2)   // 889us (double length)
-#define RC6_BITS                  21      // Approximate (variable with mode)
+#define RC6_BITS                  20      // Mode 0: 3 mode + 1 toggle + 16 payload
+#define RC6_LEADER_MARK_UNITS     6
+#define RC6_LEADER_SPACE_UNITS    2
+#define RC6_MODE_BITS             3
+#define RC6_MCE_CUSTOMER          0x800F  // RC6-6-32 Microsoft MCE customer code
+#define RC6_MCE_TOGGLE_MASK       0x8000  // MCE keeps its toggle inside the payload
 
 /**
  * @brief Decode Philips RC6 IR protocol
  *
- * Handles bi-phase encoding with special trailer bit and mode detection
+ * Handles bi-phase encoding with special trailer bit, modes 0-6 and
+ * 16/20/24/32-bit payloads
  *
  * @param symbols RMT symbol array
  * @param num_symbols Number of symbols
@@ -63,6 +79,17 @@ extern "C" {
  */
 esp_err_t ir_decode_rc6(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code);
 
+/**
+ * @brief Build RMT TX symbols for an RC6 code (value as ir_decode_rc6() stores it)
+ *
+ * Codes with bits = 32 (payload only, stored before the mode was kept)
+ * are sent as mode 6.
+ *
+ * @return Number of symbols written, 0 if the code is not a known RC6 variant
+ *         or @p symbols is too small
+ */
+size_t ir_rc6_build_symbols(const ir_code_t *code, rmt_symbol_word_t *symbols, size_t max_symbols);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,12 +30,21 @@ esp_err_t ir_decode_samsung48(const rmt_symbol_word_t *symbols, size_t num_symbo
     }
 
     code->protocol = IR_PROTOCOL_SAMSUNG48;
-    code->data = (uint32_t)(decoded_data & 0xFFFFFFFF);
     code->bits = SAMSUNG48_BITS;
     code->address = (decoded_data >> 32) & 0xFFFF;
     code->command = decoded_data & 0xFFFF;
     code->flags = 0;
 
+    // All 6 bytes inline, LSB first (also sets data to the low 32 bits)
+    uint8_t payload[SAMSUNG48_BITS / 8];
+    for (uint_fast8_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(decoded_data >> (8 * i));
+    }
+    esp_err_t err = ir_code_set_payload(code, payload, sizeof(payload));
+    if (err != ESP_OK) {
+        return err;
+    }
+
     ESP_LOGI(TAG, "Decoded Samsung48");
     return ESP_OK;
 }
@@ -115,8 +115,6 @@ esp_err_t ir_decode_sony(const rmt_symbol_word_t *symbols,
     code->command = command;
     code->address = address;
     code->flags = 0;  // LSB first by default
-    code->raw_data = NULL;
-    code->raw_length = 0;
 
     ESP_LOGI(TAG, "Decoded Sony-%u: Command=0x%02X, Address=0x%04X, Data=0x%08lX",
              num_bits, command, address, decoded_data);
@@ -17,6 +17,11 @@ esp_err_t ir_decode_whynter(const rmt_symbol_word_t *symbols, size_t num_symbols
         return ESP_FAIL;
     }
 
+    // Haier frames start with a similar header and run 104 bits
+    if (!ir_frame_ends_at(symbols, num_symbols, WHYNTER_BITS + 1, WHYNTER_HEADER_SPACE)) {
+        return ESP_FAIL;
+    }
+
     uint32_t decoded_data = 0;
     for (int i = WHYNTER_BITS - 1; i >= 0; i--) {  // MSB first
         const rmt_symbol_word_t *sym = &symbols[WHYNTER_BITS - i];
@@ -13,7 +13,9 @@
  * Architecture:
  * 1. Maintain local AC state in firmware
  * 2. When RainMaker parameter changes, update state
- * 3. Regenerate complete IR frame from state using protocol encoder
+ * 3. Regenerate complete IR frame from state using the protocol frame map
+ *    (the last frame is cached, so only the bytes of changed fields are
+ *    rewritten along with the checksum and their RMT symbols)
  * 4. Transmit full state frame
  *
  * This matches how real AC remotes work and enables proper state synchronization.
@@ -131,6 +133,44 @@ typedef struct {
 #define AC_TEMP_MAX         30      // Maximum temperature (°C)
 #define AC_TEMP_DEFAULT     24      // Default temperature (°C)
 
+/**
+ * @brief Settle window for coalescing setter changes
+ *
+ * Setters only update the state; the IR frame and NVS write follow once no
+ * further change arrives for this long. A RainMaker scene setting power,
+ * mode, temperature, fan and swing then sends one frame (one AC beep) and
+ * one flash commit instead of five.
+ */
+#define IR_AC_COMMIT_SETTLE_MS  300
+
+/**
+ * @brief Retries of a commit that failed to transmit or save
+ *
+ * Each retry waits another settle window. After the last one the changes
+ * stay pending and go out with the next setter's commit.
+ */
+#define IR_AC_COMMIT_RETRIES    3
+
+/**
+ * @brief Most AC units one node drives
+ */
+#define IR_AC_MAX_UNITS         4
+
+/**
+ * @brief Silence kept on an emitter between two AC frames
+ *
+ * Units bound to the same IR LED send their frames one at a time with this
+ * gap between them, so no AC reads the end of one frame and the start of
+ * the next as a single frame. Units on different emitters do not wait for
+ * each other.
+ */
+#define IR_AC_UNIT_GAP_MS       100
+
+/**
+ * @brief Handle of one AC unit
+ */
+typedef struct ir_ac_unit *ir_ac_handle_t;
+
 /* ============================================================================
  * AC STATE MANAGEMENT FUNCTIONS
  * ============================================================================ */
@@ -138,26 +178,90 @@ typedef struct {
 /**
  * @brief Initialize AC state management system
  *
- * Must be called after ir_control_init().
+ * Must be called after ir_control_init(). Same as
+ * ir_ac_state_init_units(1).
  *
  * @return ESP_OK on success
  */
 esp_err_t ir_ac_state_init(void);
 
+/**
+ * @brief Initialize AC state management for several AC units
+ *
+ * Each unit gets its own state, protocol, settle timer, frame cache and
+ * NVS key (unit 0 keeps the single-unit key, so existing state carries
+ * over). The functions without a unit argument act on unit 0.
+ *
+ * @param count Number of units (1 to IR_AC_MAX_UNITS)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if @p count is out of
+ *         range, ESP_ERR_NO_MEM
+ */
+esp_err_t ir_ac_state_init_units(uint8_t count);
+
+/**
+ * @brief Number of AC units set up at init (0 before init)
+ */
+uint8_t ir_ac_get_num_units(void);
+
+/**
+ * @brief Get the handle of an AC unit
+ *
+ * @param index Unit index (0 to ir_ac_get_num_units() - 1)
+ * @return Handle, or NULL if @p index is out of range
+ */
+ir_ac_handle_t ir_ac_get_unit(uint8_t index);
+
+/**
+ * @brief Index of an AC unit
+ */
+uint8_t ir_ac_unit_get_index(ir_ac_handle_t unit);
+
+/**
+ * @brief Bind an AC unit to an IR emitter
+ *
+ * Units start on IR_TX_EMITTER_DEFAULT. The binding is wiring, not state,
+ * and is not saved; set it at startup after ir_tx_add_emitter(). The
+ * first unit bound to an emitter starts that emitter's commit task.
+ *
+ * @param unit Unit handle
+ * @param emitter Emitter index (below ir_tx_get_num_emitters())
+ * @return ESP_OK, ESP_ERR_INVALID_STATE for a bad handle,
+ *         ESP_ERR_INVALID_ARG for an emitter that does not exist,
+ *         ESP_ERR_NO_MEM if the commit task cannot be started
+ */
+esp_err_t ir_ac_unit_set_emitter(ir_ac_handle_t unit, uint8_t emitter);
+
+/**
+ * @brief Emitter an AC unit transmits on
+ */
+uint8_t ir_ac_unit_get_emitter(ir_ac_handle_t unit);
+
 /**
  * @brief Get current AC state
  *
  * Returns pointer to the internal AC state structure.
- * Do not modify directly; use setter functions.
+ * Do not modify directly; use setter functions. Commits, the remote sync
+ * and scenes rewrite it from other tasks, so a reader can see a state
+ * half updated: use ir_ac_copy_state() for a consistent snapshot.
  *
- * @return Pointer to current AC state (read-only)
+ * @return Pointer to current AC state (read-only), NULL before init
  */
 const ac_state_t* ir_ac_state_get(void);
 
+/**
+ * @brief Copy the current AC state under the unit lock
+ *
+ * @param out Receives the state
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before init, ESP_ERR_INVALID_ARG if @p out is NULL
+ */
+esp_err_t ir_ac_copy_state(ac_state_t *out);
+
 /**
  * @brief Set AC power state
  *
- * Updates AC power and triggers IR transmission.
+ * Updates AC power. The change is transmitted and saved by the next
+ * commit, IR_AC_COMMIT_SETTLE_MS after the last setter call (same for
+ * all individual setters below).
  *
  * @param power true = on, false = off
  * @return ESP_OK on success
@@ -199,14 +303,31 @@ esp_err_t ir_ac_set_swing(ac_swing_t swing);
 /**
  * @brief Set multiple AC parameters atomically
  *
- * Updates multiple state fields and transmits once.
- * More efficient than calling individual setters.
+ * Updates multiple state fields and commits immediately (one transmission,
+ * one NVS write), including any setter changes still pending.
  *
  * @param state New AC state (will be validated and applied)
- * @return ESP_OK on success
+ * @return ESP_OK on success, or the transmission error
  */
 esp_err_t ir_ac_set_state(const ac_state_t *state);
 
+/**
+ * @brief Commit pending setter changes now
+ *
+ * Transmits the current state and saves it to NVS if any field changed
+ * since the last commit, without waiting for the settle window. The AC
+ * commit task calls it when the settle timer expires; call it directly
+ * before anything that must see the AC in its final state. Blocks while
+ * the frame goes out and the state is saved.
+ *
+ * A failed transmit or save keeps the changes pending and is retried
+ * after another settle window, up to IR_AC_COMMIT_RETRIES times.
+ *
+ * @return ESP_OK if nothing was pending or the commit succeeded,
+ *         otherwise the transmission or save error
+ */
+esp_err_t ir_ac_commit(void);
+
 /**
  * @brief Set AC protocol (for encoding)
  *
@@ -219,6 +340,52 @@ esp_err_t ir_ac_set_state(const ac_state_t *state);
  */
 esp_err_t ir_ac_set_protocol(ir_protocol_t protocol, uint8_t variant);
 
+/* ============================================================================
+ * PER-UNIT CONTROL
+ * ============================================================================ */
+
+/*
+ * Each function behaves like the one without "unit_" in its name, on the
+ * given unit. Invalid or NULL handles return ESP_ERR_INVALID_STATE (NULL
+ * and false for the getters).
+ */
+
+const ac_state_t* ir_ac_unit_get_state(ir_ac_handle_t unit);
+esp_err_t ir_ac_unit_copy_state(ir_ac_handle_t unit, ac_state_t *out);
+bool ir_ac_unit_is_configured(ir_ac_handle_t unit);
+esp_err_t ir_ac_unit_set_power(ir_ac_handle_t unit, bool power);
+esp_err_t ir_ac_unit_set_mode(ir_ac_handle_t unit, ac_mode_t mode);
+esp_err_t ir_ac_unit_set_temperature(ir_ac_handle_t unit, uint8_t temperature);
+esp_err_t ir_ac_unit_set_fan_speed(ir_ac_handle_t unit, ac_fan_speed_t fan_speed);
+esp_err_t ir_ac_unit_set_swing(ir_ac_handle_t unit, ac_swing_t swing);
+esp_err_t ir_ac_unit_set_state(ir_ac_handle_t unit, const ac_state_t *state);
+esp_err_t ir_ac_unit_commit(ir_ac_handle_t unit);
+esp_err_t ir_ac_unit_set_protocol(ir_ac_handle_t unit, ir_protocol_t protocol, uint8_t variant);
+esp_err_t ir_ac_unit_transmit_state(ir_ac_handle_t unit);
+esp_err_t ir_ac_unit_learn_protocol(ir_ac_handle_t unit, uint32_t timeout_ms);
+esp_err_t ir_ac_unit_save_state(ir_ac_handle_t unit);
+esp_err_t ir_ac_unit_load_state(ir_ac_handle_t unit);
+esp_err_t ir_ac_unit_clear_state(ir_ac_handle_t unit);
+
+/**
+ * @brief Send a pre-rendered frame for a unit without waiting for it
+ *
+ * For frames encoded ahead of time (scene playback): the frame takes the
+ * unit's emitter in turn with its commits and keeps IR_AC_UNIT_GAP_MS
+ * from other AC frames on that emitter. The unit state is not changed;
+ * follow up with ir_ac_unit_adopt_state().
+ *
+ * @param unit Unit the frame is for
+ * @param code Carrier source of the frame
+ * @param symbols rmt_symbol_word_t array, copied
+ * @param num_symbols Number of symbols
+ * @param airtime_us Length of the frame on air
+ * @return ESP_OK once queued, ESP_ERR_INVALID_STATE, or the
+ *         ir_transmit_symbols_async() error
+ */
+esp_err_t ir_ac_unit_send_symbols(ir_ac_handle_t unit, const ir_code_t *code,
+                                  const void *symbols, size_t num_symbols, uint32_t airtime_us);
+
 /* ============================================================================
  * AC PROTOCOL ENCODING
  * ============================================================================ */
@@ -235,7 +402,7 @@ esp_err_t ir_ac_set_protocol(ir_protocol_t protocol, uint8_t variant);
  * - Output: 312-bit Daikin IR frame with all state fields encoded
  *
  * @param state AC state to encode
- * @param code Output IR code buffer
+ * @param code Output IR code buffer (payload bytes; release with ir_code_free())
  * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if protocol not implemented
  */
 esp_err_t ir_ac_encode_state(const ac_state_t *state, ir_code_t *code);
@@ -243,20 +410,55 @@ esp_err_t ir_ac_encode_state(const ac_state_t *state, ir_code_t *code);
 /**
  * @brief Decode IR code to AC state
  *
- * Reverse operation: Decodes a captured IR frame into AC state.
- * Used during learning to extract initial state from user's AC remote.
+ * Reverse operation: Decodes a captured IR frame into AC state using the
+ * same frame map as the encoder. Fields the protocol does not carry keep
+ * their defaults. Universal decoder (PULSE_DISTANCE) captures are first
+ * identified with ir_ac_identify_protocol().
  *
  * @param code IR code to decode
  * @param state Output AC state buffer
- * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if not an AC protocol
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if not an AC protocol,
+ *         ESP_ERR_INVALID_SIZE if the frame is too short,
+ *         ESP_ERR_INVALID_CRC if the frame checksum does not match
  */
 esp_err_t ir_ac_decode_state(const ir_code_t *code, ac_state_t *state);
 
+/**
+ * @brief Decode a captured frame as a given AC protocol
+ *
+ * Like ir_ac_decode_state() but with the protocol known in advance (the
+ * learned one), so PULSE_DISTANCE captures from the universal decoder are
+ * decoded without identification. Integer only and quiet on failure, so
+ * it is cheap enough for the receive path.
+ *
+ * Decoding is exact: for every valid state s of a protocol,
+ * decoding the encoded frame of s gives ir_ac_normalize_state(s).
+ *
+ * @param code Captured code (protocol decoder payload or universal decoder record)
+ * @param protocol AC protocol to decode as
+ * @param state Output AC state
+ * @return Same as ir_ac_decode_state()
+ */
+esp_err_t ir_ac_decode_frame(const ir_code_t *code, ir_protocol_t protocol, ac_state_t *state);
+
+/**
+ * @brief Reduce a state to what its protocol can carry
+ *
+ * Fan speeds, swing modes and temperatures the protocol cannot express
+ * become the values its frame actually sends; fields the frame does not
+ * carry are left alone. Two states that transmit the same frame normalize
+ * to the same values.
+ *
+ * @param state In/out AC state (protocol selects the frame map)
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if the protocol has no frame map
+ */
+esp_err_t ir_ac_normalize_state(ac_state_t *state);
+
 /**
  * @brief Transmit current AC state
  *
  * Encodes current state and transmits IR frame.
- * This is called automatically by setter functions.
+ * This is called by ir_ac_commit(); it does not save to NVS.
  *
  * @return ESP_OK on success
  */
@@ -286,6 +488,42 @@ esp_err_t ir_ac_transmit_state(void);
  */
 esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms);
 
+/**
+ * @brief Protocols ranked by ir_ac_identify_protocol()
+ */
+#define IR_AC_IDENTIFY_MAX_MATCHES      10
+
+/**
+ * @brief Lowest confidence learning accepts as an identification
+ */
+#define IR_AC_IDENTIFY_MIN_CONFIDENCE   70
+
+/**
+ * @brief One candidate of an AC protocol identification
+ */
+typedef struct {
+    ir_protocol_t protocol;
+    uint8_t confidence;         // 0-100
+} ir_ac_match_t;
+
+/**
+ * @brief Rank AC protocols against a single captured frame
+ *
+ * Builds a fingerprint of the capture (header and bit-cell timing, frame
+ * count, inter-frame gap, state frame length, checksum validity and the
+ * constant signature bits of each protocol's frame map) and scores it
+ * against every AC protocol in one pass. Works on frames named by a
+ * protocol decoder as well as on PULSE_DISTANCE captures from the
+ * universal decoder, so 48-bit Midea, Samsung48 and Panasonic frames are
+ * told apart by content instead of by length.
+ *
+ * @param code Captured code
+ * @param matches Output, best first
+ * @param max_matches Capacity of @p matches
+ * @return Number of candidates written (0 if @p code carries no frame data)
+ */
+size_t ir_ac_identify_protocol(const ir_code_t *code, ir_ac_match_t *matches, size_t max_matches);
+
 /**
  * @brief Check if AC protocol is configured
  *
@@ -293,6 +531,59 @@ esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms);
  */
 bool ir_ac_is_configured(void);
 
+/* ============================================================================
+ * REMOTE SYNC
+ * ============================================================================ */
+
+/**
+ * @brief Called when a frame from the physical remote changed the AC state
+ *
+ * Runs on the commit task of the unit's emitter, never on the IR receive
+ * task, with the state already updated (and saved after
+ * IR_AC_COMMIT_SETTLE_MS); compare @p state to @p previous to find the
+ * fields that changed. Changes that arrive before the task gets to the
+ * unit are reported in one call, from the state before the first of them.
+ *
+ * @param unit Unit whose state changed
+ * @param state Current state
+ * @param previous State before the first unreported change
+ * @param arg User argument from ir_ac_register_sync_cb()
+ */
+typedef void (*ir_ac_sync_cb_t)(ir_ac_handle_t unit, const ac_state_t *state, const ac_state_t *previous, void *arg);
+
+/**
+ * @brief Register the remote sync callback
+ *
+ * While an AC unit is configured and the receiver is not learning, frames
+ * of its protocol are recognized from their header timing ahead of the
+ * decoder chain, decoded into the unit's state and reported through this
+ * callback when anything changed. The frame is not transmitted
+ * again, since the AC already received it. A frame that arrives while a
+ * commit holds the unit for longer than a few ms is dropped. Multi-frame protocols whose
+ * frame gap outlasts the receiver idle timeout (Daikin) are collected
+ * across captures and reported after their last frame.
+ *
+ * @param cb Callback, NULL to unregister
+ * @param arg User argument
+ * @return ESP_OK
+ */
+esp_err_t ir_ac_register_sync_cb(ir_ac_sync_cb_t cb, void *arg);
+
+/**
+ * @brief Adopt a state the AC received from another sender
+ *
+ * For frames that went out without the unit (scene playback): the state
+ * is taken over like a frame from the physical remote, saved without
+ * transmitting and reported through the sync callback if it changed.
+ * Pending setter changes are dropped.
+ *
+ * @param unit Unit the frame was meant for
+ * @param state State the frame carried (power, mode, temperature, fan and
+ *              swing are taken; the rest of the unit state is kept)
+ * @return ESP_OK, ESP_ERR_INVALID_STATE, or the validation error
+ */
+esp_err_t ir_ac_unit_adopt_state(ir_ac_handle_t unit, const ac_state_t *state);
+
 /* ============================================================================
  * NVS STORAGE
  * ============================================================================ */
@@ -301,7 +592,9 @@ bool ir_ac_is_configured(void);
  * @brief Save AC state to NVS
  *
  * Persists current AC state and protocol configuration.
- * Called automatically when state changes.
+ * Called automatically when state changes. With an ir_log partition the
+ * state is appended to that ring log instead (one flash program per
+ * save); state left in NVS by older firmware is moved there at init.
  *
  * @return ESP_OK on success
  */
@@ -239,6 +239,20 @@ esp_err_t ir_action_cancel_learning(void);
  */
 esp_err_t ir_action_execute(ir_device_type_t device, ir_action_t action);
 
+/**
+ * @brief Start a learned action without waiting for the frame to finish
+ *
+ * Like ir_action_execute(), but returns as soon as the frame is queued on
+ * the device's emitter. Actions of devices on different emitters started
+ * back to back go out at the same time; wait with ir_tx_wait_all_done().
+ * Devices bound to IR_TX_EMITTER_ALL broadcast and return when done.
+ *
+ * @param device Device type
+ * @param action Logical action to execute
+ * @return ESP_OK once queued, ESP_ERR_NOT_FOUND if action not learned
+ */
+esp_err_t ir_action_execute_async(ir_device_type_t device, ir_action_t action);
+
 /**
  * @brief Execute action with long-press (auto-repeat)
  *
@@ -279,11 +293,12 @@ esp_err_t ir_action_save(ir_device_type_t device, ir_action_t action, const ir_c
 /**
  * @brief Load action mapping from NVS
  *
- * Retrieves the stored IR code for a device+action.
+ * Retrieves the stored IR code for a device+action. Mappings saved by
+ * older firmware are migrated to the current record format.
  *
  * @param device Device type
  * @param action Logical action
- * @param code Output buffer for IR code
+ * @param code Output buffer for IR code (release with ir_code_free())
  * @return ESP_OK on success, ESP_ERR_NOT_FOUND if not learned
  */
 esp_err_t ir_action_load(ir_device_type_t device, ir_action_t action, ir_code_t *code);
@@ -312,6 +327,33 @@ esp_err_t ir_action_clear_device(ir_device_type_t device);
  */
 esp_err_t ir_action_clear_all(void);
 
+/* ============================================================================
+ * EMITTER BINDING
+ * ============================================================================ */
+
+/**
+ * @brief Bind a device to an IR emitter
+ *
+ * Actions of @p device are sent on @p emitter (see ir_tx_add_emitter()).
+ * IR_TX_EMITTER_ALL sends every action from all emitters at once (see
+ * ir_transmit_broadcast()), for devices that must be reached from several
+ * angles. The binding is saved to NVS. A binding to an emitter that is not
+ * fitted at run time falls back to IR_TX_EMITTER_DEFAULT.
+ *
+ * @param device Device type
+ * @param emitter Emitter index (0 to IR_TX_MAX_EMITTERS - 1) or IR_TX_EMITTER_ALL
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if out of range
+ */
+esp_err_t ir_action_set_emitter(ir_device_type_t device, uint8_t emitter);
+
+/**
+ * @brief Get the emitter a device is bound to
+ *
+ * @param device Device type
+ * @return Emitter index (IR_TX_EMITTER_DEFAULT unless bound)
+ */
+uint8_t ir_action_get_emitter(ir_device_type_t device);
+
 /* ============================================================================
  * UTILITY FUNCTIONS
  * ============================================================================ */
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -25,6 +26,30 @@ extern "C" {
 #define IR_RMT_TX_CHANNEL   0       // RMT channel for TX
 #define IR_RMT_RX_CHANNEL   1       // RMT channel for RX
 
+/* Additional IR LEDs can be attached with ir_tx_add_emitter(); each gets
+ * its own RMT TX channel so different emitters transmit concurrently.
+ * Emitter 0 is always IR_TX_GPIO. */
+#define IR_TX_MAX_EMITTERS      4       // ESP32-S3 has 4 RMT TX channels
+#define IR_TX_EMITTER_DEFAULT   0
+#define IR_TX_EMITTER_ALL       0xFF    // Every emitter, see ir_transmit_broadcast()
+#define IR_TX_TIMEOUT_MS        1000    // Longest wait for a busy emitter
+
+/* Optional carrier measurement input: a non-demodulating photodiode
+ * (e.g. TSMP58000, active-LOW) sampled at high resolution while learning.
+ * Set to -1 when not fitted; builds may also pass -DIR_CARRIER_RX_GPIO=<pin>
+ * to idf.py (CI builds the photodiode path that way). */
+#ifndef IR_CARRIER_RX_GPIO
+#define IR_CARRIER_RX_GPIO  -1
+#endif
+
+/* Optional diversity receivers: extra demodulating receivers (same type
+ * as IR_RX_GPIO) mounted elsewhere. Their captures of a frame are merged
+ * edge by edge with the main receiver's before decoding, so a pulse one
+ * receiver drops is recovered from another. Set to -1 when not fitted. */
+#define IR_RX2_GPIO         -1
+#define IR_RX3_GPIO         -1
+#define IR_RX_DIVERSITY_WINDOW_MS  20  // Wait for the other receivers' captures
+
 /* IR Timing Configuration */
 #define IR_MAX_CODE_LENGTH  256     // Maximum IR code length (raw pulses)
 #define IR_CARRIER_FREQ_HZ  38000   // Standard IR carrier frequency
@@ -86,31 +111,52 @@ typedef enum {
     IR_PROTOCOL_RAW             // Raw timing data (fallback for unknown protocols)
 } ir_protocol_t;
 
+/**
+ * @brief Inline payload capacity of ir_code_t (bytes)
+ *
+ * Codes up to 128 bits (NEC, Samsung48, Panasonic, Midea, Haier, Carrier)
+ * keep their full payload inside the struct. Longer AC frames and the
+ * universal decoder's timing+bytes record live out of line.
+ */
+#define IR_CODE_INLINE_BYTES    16
+
 /**
  * @brief IR Code Structure
  *
- * Contains protocol-specific data and raw timing information
- * Extended to support all protocols while maintaining backward compatibility
+ * 16-byte header of hot metadata followed by a 16-byte payload union.
+ * Which union member is valid depends on the protocol:
+ * - RAW: raw_data/raw_length (RMT symbols, heap or learned-code arena)
+ * - PULSE_DISTANCE/PULSE_WIDTH, or bits > 128: payload_ext/payload_len
+ *   (data still holds the first 32 bits for logging and matching)
+ * - Everything else: payload[] inline, little-endian, data == payload[0..3]
+ *
+ * Use ir_code_get_payload()/ir_code_set_payload() rather than touching the
+ * union directly, and release codes with ir_code_free().
  */
 typedef struct {
-    // Original fields (backward compatible - do not reorder!)
-    ir_protocol_t protocol;     // Protocol type
-    uint32_t data;              // NEC/Samsung: 32-bit command+address (legacy field, still used)
-    uint16_t bits;              // Number of bits (typically 32, can be 12-56)
-    uint16_t *raw_data;         // RAW protocol: pulse/space timing array
-    uint16_t raw_length;        // RAW protocol: number of timing elements
-
-    // Extended fields (new - added for multi-protocol support)
+    uint8_t protocol;           // Protocol type (ir_protocol_t)
+    uint8_t flags;              // Status flags (repeat, toggle, parity, etc.)
+    uint16_t bits;              // Number of payload bits (12-344)
     uint16_t address;           // Device/manufacturer address field
     uint16_t command;           // Command/button code field
-    uint8_t flags;              // Status flags (repeat, toggle, parity, etc.)
-
-    // Commercial-grade metadata (v2.3.0+)
     uint32_t carrier_freq_hz;   // Carrier frequency (36000, 38000, 40000, 455000)
     uint8_t duty_cycle_percent; // Carrier duty cycle (typically 33%)
-    uint8_t repeat_count;       // Number of frames verified during learning
+    uint8_t validation_status;  // Multi-frame verification status (low bits = frames matched)
     uint16_t repeat_period_ms;  // Time between repeat frames for long-press
-    uint8_t validation_status;  // Multi-frame verification status
+
+    union {
+        uint32_t data;                              // First 32 payload bits (legacy view)
+        uint8_t payload[IR_CODE_INLINE_BYTES];      // Inline payload, transmission order
+        struct {
+            uint32_t data_head;                     // Aliases data
+            union {
+                uint8_t *payload_ext;               // Out-of-line payload
+                uint16_t *raw_data;                 // RAW: rmt_symbol_word_t array
+            };
+            uint16_t raw_length;                    // RAW: number of symbols
+            uint16_t payload_len;                   // Out-of-line payload length (bytes)
+        };
+    };
 } ir_code_t;
 
 /**
@@ -260,11 +306,66 @@ bool ir_is_learning(void);
  * synchronous learning (e.g., AC protocol auto-detection).
  *
  * @param timeout_ms Learning timeout in milliseconds
- * @param code Output buffer for captured IR code (must be pre-allocated)
+ * @param code Output buffer for captured IR code (must be pre-allocated;
+ *             release with ir_code_free())
  * @return ESP_OK on success, ESP_ERR_TIMEOUT on timeout, ESP_FAIL on other errors
  */
 esp_err_t ir_learn_code(uint32_t timeout_ms, ir_code_t *code);
 
+/* ============================================================================
+ * CODE PAYLOAD
+ * ============================================================================ */
+
+/**
+ * @brief Get the payload bytes of a decoded code
+ *
+ * Bits are in transmission order: bit n is (payload[n / 8] >> (n % 8)) & 1
+ * for LSB-first protocols, and the value is little-endian for MSB-first ones.
+ *
+ * @param code IR code
+ * @param len Output payload length in bytes
+ * @return Pointer to the payload, or NULL for RAW codes / no payload
+ */
+const uint8_t *ir_code_get_payload(const ir_code_t *code, size_t *len);
+
+/**
+ * @brief Store a payload in a code
+ *
+ * @c protocol and @c bits must be set first; they decide whether the payload
+ * goes inline or to the heap. An inline payload also updates @c data.
+ *
+ * @param code IR code (previous heap payload is released)
+ * @param bytes Payload bytes
+ * @param len Payload length in bytes
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if an inline payload is too long,
+ *         ESP_ERR_NO_MEM if allocation fails
+ */
+esp_err_t ir_code_set_payload(ir_code_t *code, const uint8_t *bytes, size_t len);
+
+/**
+ * @brief Turn a code into a RAW code holding a heap copy of @p symbols
+ *
+ * @param code IR code (previous heap data is released)
+ * @param symbols rmt_symbol_word_t array
+ * @param num_symbols Number of symbols
+ * @return ESP_OK, ESP_ERR_NO_MEM if allocation fails
+ */
+esp_err_t ir_code_set_raw(ir_code_t *code, const void *symbols, size_t num_symbols);
+
+/**
+ * @brief Deep-copy a code (out-of-line data is duplicated on the heap)
+ *
+ * @param dst Destination (treated as uninitialized)
+ * @param src Source code
+ * @return ESP_OK, ESP_ERR_NO_MEM if allocation fails
+ */
+esp_err_t ir_code_copy(ir_code_t *dst, const ir_code_t *src);
+
+/**
+ * @brief Release heap data owned by a code and zero it
+ */
+void ir_code_free(ir_code_t *code);
+
 /* ============================================================================
  * TRANSMISSION
  * ============================================================================ */
@@ -272,13 +373,153 @@ esp_err_t ir_learn_code(uint32_t timeout_ms, ir_code_t *code);
 /**
  * @brief Transmit an IR code
  *
- * Transmits IR code using appropriate encoder (NEC/Samsung/RAW)
+ * Transmits IR code using appropriate encoder: NEC/Samsung encoders,
+ * RAW symbols as captured, or symbols rebuilt from the payload using the
+ * protocol timing table (universal decoder codes replay their own timing).
+ * Sends on IR_TX_EMITTER_DEFAULT and returns when the frame is out.
  *
  * @param code Pointer to IR code structure
  * @return ESP_OK on success, ESP_ERR_INVALID_ARG if code is NULL
  */
 esp_err_t ir_transmit(ir_code_t *code);
 
+/**
+ * @brief Transmit a pre-built symbol buffer
+ *
+ * For callers that keep their own symbols between transmissions (the AC
+ * frame cache). The carrier is taken from @p code as in ir_transmit();
+ * its payload is ignored.
+ *
+ * @param code Code supplying protocol, bits and carrier
+ * @param symbols rmt_symbol_word_t array (level 1 = mark)
+ * @param num_symbols Number of symbols
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if a pointer is NULL or
+ *         @p num_symbols is 0
+ */
+esp_err_t ir_transmit_symbols(const ir_code_t *code, const void *symbols, size_t num_symbols);
+
+/**
+ * @brief IR emitter configuration
+ */
+typedef struct {
+    int gpio_num;               // GPIO driving the IR LED
+    uint32_t carrier_hz;        // Carrier for codes without one (0 = IR_CARRIER_FREQ_HZ)
+} ir_tx_emitter_config_t;
+
+/**
+ * @brief Attach an additional IR emitter
+ *
+ * Allocates an RMT TX channel with its own encoders for the LED on
+ * @p config->gpio_num. Call after ir_control_init(); emitter 0 is created
+ * there on IR_TX_GPIO.
+ *
+ * @param config Emitter configuration
+ * @param emitter Output: index to pass to ir_transmit_on() (may be NULL)
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if all emitters are in use,
+ *         or the RMT driver error if no channel is free
+ */
+esp_err_t ir_tx_add_emitter(const ir_tx_emitter_config_t *config, uint8_t *emitter);
+
+/**
+ * @brief Number of emitters available for transmission
+ */
+uint8_t ir_tx_get_num_emitters(void);
+
+/**
+ * @brief Transmit an IR code on a specific emitter
+ *
+ * Same as ir_transmit() on emitter @p emitter. Transmissions on one emitter
+ * are serialized; different emitters run in parallel.
+ *
+ * @param emitter Emitter index
+ * @param code Pointer to IR code structure
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad emitter or code,
+ *         ESP_ERR_TIMEOUT if the emitter stayed busy
+ */
+esp_err_t ir_transmit_on(uint8_t emitter, const ir_code_t *code);
+
+/**
+ * @brief Transmit a pre-built symbol buffer on a specific emitter
+ *
+ * Same as ir_transmit_symbols() on emitter @p emitter.
+ */
+esp_err_t ir_transmit_symbols_on(uint8_t emitter, const ir_code_t *code,
+                                 const void *symbols, size_t num_symbols);
+
+/**
+ * @brief Start transmitting an IR code without waiting for it to finish
+ *
+ * Waits only until @p emitter is free, queues the frame and returns. The
+ * code is copied, so the caller may free it immediately. Starting frames
+ * on several emitters back to back sends them at the same time; use
+ * ir_tx_wait_done() or ir_tx_wait_all_done() to wait for completion.
+ *
+ * @param emitter Emitter index
+ * @param code Pointer to IR code structure
+ * @return ESP_OK once queued, ESP_ERR_INVALID_ARG for a bad emitter or code,
+ *         ESP_ERR_TIMEOUT if the emitter stayed busy
+ */
+esp_err_t ir_transmit_async(uint8_t emitter, const ir_code_t *code);
+
+/**
+ * @brief Start transmitting a pre-built symbol buffer without waiting
+ *
+ * Same as ir_transmit_symbols_on(), returning as soon as the frame is
+ * queued like ir_transmit_async(). The symbols are copied.
+ */
+esp_err_t ir_transmit_symbols_async(uint8_t emitter, const ir_code_t *code,
+                                    const void *symbols, size_t num_symbols);
+
+/**
+ * @brief Render a code into the symbols ir_transmit() would send
+ *
+ * RAW codes are copied, NEC/Apple/Samsung codes expanded the way their
+ * encoders emit them, and other codes rebuilt from the protocol table
+ * (NEC timing for protocols without one, as ir_transmit() does). Lets
+ * callers do the encoding ahead of time and send with
+ * ir_transmit_symbols_on().
+ *
+ * @param code Code to render
+ * @param symbols Output: rmt_symbol_word_t array (caller frees)
+ * @param num_symbols Output: number of symbols
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE for a RAW
+ *         code without symbols, ESP_ERR_NO_MEM
+ */
+esp_err_t ir_render_code(const ir_code_t *code, void **symbols, size_t *num_symbols);
+
+/**
+ * @brief Wait until an emitter has finished its current frame
+ *
+ * @param emitter Emitter index
+ * @param timeout_ms Maximum wait
+ * @return ESP_OK when idle, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t ir_tx_wait_done(uint8_t emitter, uint32_t timeout_ms);
+
+/**
+ * @brief Wait until every emitter has finished its current frame
+ *
+ * @param timeout_ms Maximum wait per emitter
+ * @return ESP_OK when all are idle, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t ir_tx_wait_all_done(uint32_t timeout_ms);
+
+/**
+ * @brief Transmit one code from several emitters at the same time
+ *
+ * The frame is encoded once and the shared symbol buffer is queued on
+ * every emitter in @p emitter_mask; an RMT sync manager starts the
+ * channels together so the LEDs emit phase-aligned copies instead of
+ * back-to-back repeats. Returns when all copies are out.
+ *
+ * @param emitter_mask Bit per emitter index (bit 0 = IR_TX_EMITTER_DEFAULT)
+ * @param code Pointer to IR code structure
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an empty mask or a
+ *         bit beyond ir_tx_get_num_emitters(), ESP_ERR_TIMEOUT if an
+ *         emitter stayed busy or the frame did not complete
+ */
+esp_err_t ir_transmit_broadcast(uint32_t emitter_mask, const ir_code_t *code);
+
 /**
  * @brief Transmit learned code for a button
  *
@@ -303,6 +544,9 @@ esp_err_t ir_save_code(ir_button_t button, ir_code_t *code);
 /**
  * @brief Load a learned IR code from NVS
  *
+ * Records saved by older firmware are migrated and re-saved. The caller
+ * owns the result and releases it with ir_code_free().
+ *
  * @param button Button identifier
  * @param code Pointer to store loaded code
  * @return ESP_OK on success, ESP_ERR_NOT_FOUND if not saved
@@ -352,6 +596,36 @@ esp_err_t ir_clear_all_codes(void);
  */
 bool ir_is_learned(ir_button_t button);
 
+/**
+ * @brief Learned-code access counters
+ *
+ * Transmits and ir_is_learned() read without a lock. The codes lock is
+ * only taken by writers (learning, load, save, clear) and by transmits of
+ * buttons the code table could not hold.
+ */
+typedef struct {
+    uint32_t lock_free_reads;   // Code table transmits and ir_is_learned() calls
+    uint32_t table_misses;      // Transmits of codes not resident in the table
+    uint32_t locks;             // Codes lock acquisitions
+    uint32_t lock_contended;    // Acquisitions that found the lock taken
+    uint32_t lock_wait_us_max;  // Longest wait for the lock
+    uint32_t grace_waits;       // Code table reclaims put off by active readers or frames
+    uint32_t grace_wait_us_max; // Longest time a replaced code's span waited for reuse
+} ir_code_access_stats_t;
+
+/**
+ * @brief Get learned-code access counters
+ *
+ * @param stats Output statistics
+ * @return ESP_OK, ESP_ERR_INVALID_ARG
+ */
+esp_err_t ir_get_code_access_stats(ir_code_access_stats_t *stats);
+
+/**
+ * @brief Reset learned-code access counters
+ */
+void ir_reset_code_access_stats(void);
+
 /**
  * @brief Get button name string
  *
@@ -380,6 +654,54 @@ const char* ir_get_protocol_name(ir_protocol_t protocol);
  */
 esp_err_t ir_register_callbacks(const ir_callbacks_t *callbacks);
 
+/**
+ * @brief Receive hook, run on every frame outside learning mode
+ *
+ * Sees the frame after noise filtering and gap trimming, before any
+ * protocol decoder. Returning true consumes the frame: the decoder chain
+ * and the receive callback are skipped.
+ *
+ * @param symbols Received rmt_symbol_word_t array
+ * @param num_symbols Number of symbols
+ * @param arg User argument from ir_register_rx_hook()
+ * @return true if the frame was handled
+ */
+typedef bool (*ir_rx_hook_t)(const void *symbols, size_t num_symbols, void *arg);
+
+/**
+ * @brief Register the receive hook (one at a time)
+ *
+ * @param hook Hook, NULL to remove it
+ * @param arg User argument passed to the hook
+ * @return ESP_OK
+ */
+esp_err_t ir_register_rx_hook(ir_rx_hook_t hook, void *arg);
+
+/**
+ * @brief Diversity receiver statistics (IR_RX2_GPIO / IR_RX3_GPIO)
+ */
+typedef struct {
+    uint32_t frames;            // Frames captured by at least one receiver
+    uint32_t combined;          // Frames merged from two or more captures
+    uint32_t repaired;          // Frames where pulses were filled in from another receiver
+    uint32_t rejected;          // Frames where a pulse most receivers missed was dropped
+    uint32_t primary_missed;    // Frames IR_RX_GPIO did not capture at all
+    uint32_t rescued;           // Repaired or primary-missed frames that decoded
+} ir_rx_diversity_stats_t;
+
+/**
+ * @brief Get diversity receiver statistics
+ *
+ * @param stats Output statistics
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if no diversity receiver is running
+ */
+esp_err_t ir_rx_get_diversity_stats(ir_rx_diversity_stats_t *stats);
+
+/**
+ * @brief Reset diversity receiver statistics
+ */
+void ir_rx_reset_diversity_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
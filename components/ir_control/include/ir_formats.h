@@ -0,0 +1,209 @@
+/**
+ * @file ir_formats.h
+ * @brief Streaming Pronto Hex, LIRC and IRDB CSV parsers and writers
+ *
+ * Converts between ir_code_t / packed RMT symbols and the text formats
+ * other IR tools use:
+ * - Pronto Hex: one learned (0000) code per line, optionally prefixed
+ *   with "name:". The once sequence is used, or the repeat sequence if
+ *   there is none.
+ * - LIRC lircd.conf: SPACE_ENC remotes ("begin codes") and RAW_CODES
+ *   remotes ("begin raw_codes"). 32-bit SPACE_ENC codes with NEC timing
+ *   become NEC codes; everything else becomes RAW symbols.
+ * - IRDB CSV: functionname,protocol,device,subdevice,function rows for
+ *   the NEC, NECx/Samsung32, Sony, RC5, RC6, JVC and Denon/Sharp
+ *   protocols.
+ *
+ * Text is pulled through a read callback and pushed through a write
+ * callback in small chunks, so files of any size are handled in constant
+ * memory (about 2.5 KB per parser, allocated once) whether they live on
+ * SPIFFS or in a RAM blob. Unsupported codes are counted and skipped.
+ *
+ * Plain C with no ESP-IDF dependencies beyond esp_err_t, so it can be
+ * built and exercised on the host.
+ *
+ * MIT License
+ */
+
+#ifndef IR_FORMATS_H
+#define IR_FORMATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ir_control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IR_FORMAT_NAME_LEN          32      // Remote and button names, including terminator
+#define IR_FORMAT_MAX_SYMBOLS       512     // Longest RAW frame (mark/space pairs)
+#define IR_FORMAT_DEFAULT_GAP_US    30000   // Lead-out written after the last mark (fits a symbol)
+
+/* Packed RMT symbol (rmt_symbol_word_t layout): mark at level 1, then space */
+#define IR_FORMAT_SYMBOL(mark_us, space_us) \
+    ((uint32_t)((mark_us) & 0x7FFF) | (1u << 15) | ((uint32_t)((space_us) & 0x7FFF) << 16))
+#define IR_FORMAT_SYMBOL_MARK(sym)      ((sym) & 0x7FFF)
+#define IR_FORMAT_SYMBOL_SPACE(sym)     (((sym) >> 16) & 0x7FFF)
+
+/**
+ * @brief Text formats
+ */
+typedef enum {
+    IR_FORMAT_PRONTO = 0,
+    IR_FORMAT_LIRC,
+    IR_FORMAT_IRDB_CSV,
+    IR_FORMAT_MAX
+} ir_format_t;
+
+/**
+ * @brief Fill @p buf with up to @p len bytes
+ *
+ * @return Bytes read, 0 at the end of the input
+ */
+typedef size_t (*ir_format_read_fn)(void *ctx, char *buf, size_t len);
+
+/**
+ * @brief Consume @p len bytes of output
+ */
+typedef esp_err_t (*ir_format_write_fn)(void *ctx, const char *buf, size_t len);
+
+/**
+ * @brief One parsed code
+ *
+ * RAW codes point into the parser's symbol buffer: copy the code
+ * (ir_code_copy()) or store it before the callback returns.
+ */
+typedef struct {
+    const char *remote;         // LIRC remote name ("" otherwise)
+    const char *name;           // Button / function name
+    int device;                 // IRDB CSV fields (-1 elsewhere)
+    int subdevice;
+    int function;
+    ir_code_t code;
+} ir_format_entry_t;
+
+/**
+ * @brief Called for each parsed code
+ *
+ * @return ESP_OK to continue; anything else stops parsing and is returned
+ */
+typedef esp_err_t (*ir_format_entry_cb_t)(const ir_format_entry_t *entry, void *arg);
+
+/**
+ * @brief Parse totals
+ */
+typedef struct {
+    uint32_t parsed;            // Entries passed to the callback
+    uint32_t skipped;           // Unsupported or malformed entries
+    uint32_t lines;             // Input lines read
+} ir_format_stats_t;
+
+/**
+ * @brief Streaming writer state (caller allocated)
+ */
+typedef struct {
+    ir_format_t format;
+    ir_format_write_fn write;
+    void *ctx;
+    char remote[IR_FORMAT_NAME_LEN];
+    bool header_written;        // LIRC header waits for the first code's carrier
+    uint32_t written;           // Codes written
+    esp_err_t err;              // First write error (sticky)
+} ir_format_writer_t;
+
+/**
+ * @brief RAM source for ir_format_parse()
+ */
+typedef struct {
+    const char *data;
+    size_t len;
+    size_t pos;
+} ir_format_mem_t;
+
+/**
+ * @brief Parse a text source, calling @p cb for each code
+ *
+ * @param format Input format
+ * @param read Read callback (see ir_format_read_file() and ir_format_read_mem())
+ * @param read_ctx Read callback context
+ * @param cb Entry callback
+ * @param arg Entry callback argument
+ * @param stats Output totals (may be NULL)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or the callback's error
+ */
+esp_err_t ir_format_parse(ir_format_t format, ir_format_read_fn read, void *read_ctx,
+                          ir_format_entry_cb_t cb, void *arg, ir_format_stats_t *stats);
+
+/**
+ * @brief Read callback over a stdio FILE (ctx = FILE *)
+ */
+size_t ir_format_read_file(void *ctx, char *buf, size_t len);
+
+/**
+ * @brief Read callback over a RAM blob (ctx = ir_format_mem_t *)
+ */
+size_t ir_format_read_mem(void *ctx, char *buf, size_t len);
+
+/**
+ * @brief Write callback into a stdio FILE (ctx = FILE *)
+ */
+esp_err_t ir_format_write_file(void *ctx, const char *buf, size_t len);
+
+/**
+ * @brief Start writing
+ *
+ * Writes the CSV header at once; the LIRC header follows with the first code.
+ *
+ * @param writer Writer state
+ * @param format Output format
+ * @param remote Remote name (LIRC), may be NULL
+ * @param write Write callback
+ * @param ctx Write callback context
+ * @return ESP_OK or the write callback's error
+ */
+esp_err_t ir_format_writer_begin(ir_format_writer_t *writer, ir_format_t format, const char *remote,
+                                 ir_format_write_fn write, void *ctx);
+
+/**
+ * @brief Write one code
+ *
+ * CSV takes protocol codes of the supported protocols; Pronto and LIRC
+ * take RAW codes (use ir_format_write_symbols() for others).
+ *
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if the code cannot be expressed,
+ *         or the write callback's error
+ */
+esp_err_t ir_format_write_code(ir_format_writer_t *writer, const char *name, const ir_code_t *code);
+
+/**
+ * @brief Write one frame of packed symbols (Pronto and LIRC)
+ *
+ * @param writer Writer state
+ * @param name Button name
+ * @param carrier_hz Carrier frequency (0 = 38 kHz)
+ * @param symbols Packed symbols
+ * @param num_symbols Number of symbols
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED for CSV, or the write callback's error
+ */
+esp_err_t ir_format_write_symbols(ir_format_writer_t *writer, const char *name, uint32_t carrier_hz,
+                                  const uint32_t *symbols, size_t num_symbols);
+
+/**
+ * @brief Finish writing (closes the LIRC remote)
+ *
+ * @return ESP_OK or the first write error
+ */
+esp_err_t ir_format_writer_end(ir_format_writer_t *writer);
+
+/**
+ * @brief Format name ("pronto", "lirc", "csv")
+ */
+const char *ir_format_get_name(ir_format_t format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_FORMATS_H
@@ -0,0 +1,164 @@
+/**
+ * @file ir_library.h
+ * @brief Large IR code library on the SPIFFS "storage" partition
+ *
+ * Holds thousands of codes of known remotes, keyed by
+ * brand → device type → code set → function, so a remote can be set up
+ * from the library instead of learning it button by button.
+ *
+ * On flash (mounted at IR_LIBRARY_BASE_PATH):
+ * - irlib.dat: append-only packed records, each a header carrying its
+ *   own key and CRC followed by the serialized code (ir_code_serialize()
+ *   record, then the symbols for RAW codes). The index can be rebuilt
+ *   from this file alone.
+ * - irlib.idx: fixed-size index entries sorted by key, pointing into
+ *   irlib.dat. Lookups binary-search it, one entry read per step.
+ * - irlib.tail: entries added since the last merge, in arrival order.
+ *   They are also kept sorted in a fixed RAM buffer and merged into the
+ *   index once IR_LIBRARY_TAIL_MAX accumulate or on ir_library_flush().
+ *
+ * A lookup costs O(log n) index reads plus one record read, and RAM use
+ * does not grow with the library. Brands are compared case-insensitively.
+ *
+ * Only 8 MB and 16 MB partition tables have a storage partition; on
+ * 4 MB boards ir_library_init() returns ESP_ERR_NOT_FOUND.
+ *
+ * Copyright (c) 2025
+ */
+
+#ifndef IR_LIBRARY_H
+#define IR_LIBRARY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "ir_control.h"
+#include "ir_action.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef IR_LIBRARY_BASE_PATH
+#define IR_LIBRARY_BASE_PATH        "/storage"   // Host tests use a scratch directory
+#endif
+#define IR_LIBRARY_PARTITION        "storage"
+#define IR_LIBRARY_BRAND_LEN        16      // Including the terminator
+#define IR_LIBRARY_TAIL_MAX         64      // Unmerged additions held in RAM
+
+/**
+ * @brief Key and metadata of one library code
+ */
+typedef struct {
+    char brand[IR_LIBRARY_BRAND_LEN];   // Lower case, NUL padded
+    uint8_t device;                     // ir_device_type_t
+    uint8_t action;                     // ir_action_t
+    uint16_t codeset;                   // Remote model within brand and device
+    uint16_t popularity;                // How common the code set is (higher first)
+} ir_library_entry_t;
+
+/**
+ * @brief Called for each entry by ir_library_foreach()
+ *
+ * @return true to continue, false to stop
+ */
+typedef bool (*ir_library_visit_cb_t)(const ir_library_entry_t *entry, void *arg);
+
+/**
+ * @brief Mount the storage partition and open the library
+ *
+ * Creates empty library files on first use, finishes an interrupted
+ * merge and rebuilds a missing or damaged index from irlib.dat.
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if there is no storage partition,
+ *         ESP_FAIL if it cannot be mounted
+ */
+esp_err_t ir_library_init(void);
+
+/**
+ * @brief Close the library files and forget pending state
+ *
+ * The partition stays mounted. Additions not merged yet are kept in
+ * irlib.tail and picked up by the next ir_library_init().
+ */
+void ir_library_deinit(void);
+
+/**
+ * @brief Add a code (replaces the code under the same key)
+ *
+ * The record is appended at once; the index catches up at the next
+ * merge. Call ir_library_flush() after a bulk import.
+ *
+ * @param entry Key and popularity (brand is normalized)
+ * @param code Code to store
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE before
+ *         init, ESP_FAIL on a file error
+ */
+esp_err_t ir_library_add(const ir_library_entry_t *entry, const ir_code_t *code);
+
+/**
+ * @brief Merge pending additions into the sorted index
+ *
+ * @return ESP_OK, ESP_FAIL on a file error (the additions stay pending)
+ */
+esp_err_t ir_library_flush(void);
+
+/**
+ * @brief Look up one code
+ *
+ * @param brand Brand name (any case)
+ * @param device Device type
+ * @param codeset Code set
+ * @param action Function
+ * @param code Output code (release with ir_code_free())
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, ESP_ERR_INVALID_CRC for a damaged
+ *         record, ESP_ERR_INVALID_STATE before init
+ */
+esp_err_t ir_library_lookup(const char *brand, ir_device_type_t device, uint16_t codeset,
+                            ir_action_t action, ir_code_t *code);
+
+/**
+ * @brief Load the code of an entry passed to an ir_library_foreach() callback
+ */
+esp_err_t ir_library_load(const ir_library_entry_t *entry, ir_code_t *code);
+
+/**
+ * @brief Visit entries in key order
+ *
+ * Starts with a binary search, so only the matching range is read.
+ * The library is locked while visiting: the callback may call
+ * ir_library_load() but not add or flush.
+ *
+ * @param brand Brand to visit (NULL = all brands)
+ * @param device Device type within @p brand (IR_DEVICE_NONE = all)
+ * @param cb Callback
+ * @param arg Callback argument
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before init
+ */
+esp_err_t ir_library_foreach(const char *brand, ir_device_type_t device,
+                             ir_library_visit_cb_t cb, void *arg);
+
+/**
+ * @brief Copy every function of a library remote into action storage
+ *
+ * @param brand Brand name
+ * @param device Device type in the library
+ * @param codeset Code set
+ * @param target Device whose actions receive the codes
+ * @param imported Output: number of actions written (may be NULL)
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the remote is not in the library
+ */
+esp_err_t ir_library_import_remote(const char *brand, ir_device_type_t device, uint16_t codeset,
+                                   ir_device_type_t target, size_t *imported);
+
+/**
+ * @brief Number of codes in the library (including pending additions)
+ */
+size_t ir_library_get_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_LIBRARY_H
@@ -0,0 +1,135 @@
+/**
+ * @file ir_scan.h
+ * @brief "Find my device" code scan over the IR code library
+ *
+ * Sends one function (normally Power) of every code set the library has
+ * for a brand and device type, most popular code sets first, until the
+ * user sees the device react and confirms. Frames are rendered while the
+ * previous one is on the air and started back to back at the shortest
+ * spacing the protocol allows, so a couple of hundred code sets take
+ * seconds.
+ *
+ * The user confirms some time after the right frame went out, so a
+ * confirmation yields the code sets sent within IR_SCAN_REACTION_MS
+ * before it (the suspects). Each can be re-sent with ir_scan_try() to
+ * find the one that works, then imported with ir_library_import_remote().
+ *
+ * Copyright (c) 2025
+ */
+
+#ifndef IR_SCAN_H
+#define IR_SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "ir_action.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IR_SCAN_MAX_CANDIDATES      256     // Code sets scanned per run
+#define IR_SCAN_MAX_SUSPECTS        16      // Code sets reported on confirm
+#define IR_SCAN_REACTION_MS         1500    // Frames this long before confirm are suspects
+#define IR_SCAN_MIN_GAP_MS          20      // Gap after a frame when the protocol has no period
+
+/**
+ * @brief Scan state
+ */
+typedef enum {
+    IR_SCAN_IDLE = 0,       // Never started or stopped
+    IR_SCAN_RUNNING,        // Sending candidates
+    IR_SCAN_CONFIRMED,      // User confirmed; suspects are valid
+    IR_SCAN_EXHAUSTED,      // Every candidate sent without confirmation
+} ir_scan_state_t;
+
+/**
+ * @brief Called from the scan task when a scan ends (any reason)
+ */
+typedef void (*ir_scan_done_cb_t)(ir_scan_state_t state, void *arg);
+
+/**
+ * @brief Scan parameters
+ */
+typedef struct {
+    const char *brand;              // Library brand (copied)
+    ir_device_type_t device;        // Library device type
+    ir_action_t action;             // Function to send (IR_ACTION_NONE = Power)
+    uint8_t emitter;                // Emitter index
+    uint16_t gap_ms;                // Gap after each frame (0 = protocol minimum)
+    ir_scan_done_cb_t done_cb;      // Optional
+    void *done_arg;
+} ir_scan_config_t;
+
+/**
+ * @brief Scan progress
+ */
+typedef struct {
+    ir_scan_state_t state;
+    uint16_t total;                 // Candidates in this run
+    uint16_t sent;                  // Candidates sent so far
+    uint16_t current;               // Code set sent last
+    uint8_t num_suspects;
+    uint16_t suspects[IR_SCAN_MAX_SUSPECTS];    // Code sets, most recent first
+} ir_scan_status_t;
+
+/**
+ * @brief Initialize the scanner
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM
+ */
+esp_err_t ir_scan_init(void);
+
+/**
+ * @brief Start scanning (replaces a finished scan)
+ *
+ * @param config Scan parameters
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the library has no candidates,
+ *         ESP_ERR_INVALID_STATE while a scan runs or without a library,
+ *         ESP_ERR_INVALID_ARG
+ */
+esp_err_t ir_scan_start(const ir_scan_config_t *config);
+
+/**
+ * @brief Confirm that the device reacted; stops the scan
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if no scan is running
+ */
+esp_err_t ir_scan_confirm(void);
+
+/**
+ * @brief Stop the scan without a result
+ */
+esp_err_t ir_scan_stop(void);
+
+/**
+ * @brief Send the scanned function of one code set
+ *
+ * Used to narrow the suspects down after a confirmation.
+ *
+ * @param codeset Code set of the last scan
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, ESP_ERR_INVALID_STATE while running
+ *         or before the first scan
+ */
+esp_err_t ir_scan_try(uint16_t codeset);
+
+/**
+ * @brief Get scan progress and, once confirmed, the suspects
+ */
+esp_err_t ir_scan_get_status(ir_scan_status_t *status);
+
+/**
+ * @brief Brand and device type of the last scan (for importing the result)
+ *
+ * @param brand Output buffer (IR_LIBRARY_BRAND_LEN bytes)
+ * @param device Output device type
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before the first scan
+ */
+esp_err_t ir_scan_get_target(char *brand, ir_device_type_t *device);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_SCAN_H
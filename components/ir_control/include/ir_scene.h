@@ -0,0 +1,153 @@
+/**
+ * @file ir_scene.h
+ * @brief Multi-device IR scenes with pre-rendered timelines
+ *
+ * A scene is a list of steps, each either a learned action of a device
+ * ("TV Power") or a full AC unit state, followed by a pause. When a scene
+ * is saved (and at boot) it is compiled once: every code is loaded from
+ * NVS, encoded and rendered to RMT symbols, the emitter is resolved and
+ * each frame gets its start offset on the scene's timeline. Playing a
+ * scene then only queues the ready frames at their offsets from a
+ * dedicated task, with microsecond timing and no NVS access or encoding
+ * between frames.
+ *
+ * Scenes are stored as compact blobs in the "ir_scenes" namespace of the
+ * ir_storage partition (10 bytes per step).
+ *
+ * Copyright (c) 2025
+ */
+
+#ifndef IR_SCENE_H
+#define IR_SCENE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "ir_action.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IR_SCENE_MAX            8       // Stored scenes
+#define IR_SCENE_MAX_STEPS      16      // Steps per scene
+#define IR_SCENE_NAME_LEN       24      // Including the terminator
+
+/**
+ * @brief Kind of scene step
+ */
+typedef enum {
+    IR_SCENE_STEP_ACTION = 0,   // Learned action of a device
+    IR_SCENE_STEP_AC,           // AC unit state
+} ir_scene_step_type_t;
+
+/**
+ * @brief One scene step, as stored
+ *
+ * The pause runs from the end of this step's frame to the start of the
+ * next one, so it is the quiet time the next device sees.
+ */
+typedef struct {
+    uint8_t type;               // ir_scene_step_type_t
+    uint8_t target;             // ACTION: ir_device_type_t; AC: unit index
+    uint8_t action;             // ACTION: ir_action_t
+    uint8_t power;              // AC: 0 = off, 1 = on
+    uint8_t mode;               // AC: ac_mode_t
+    uint8_t temperature;        // AC: °C
+    uint8_t fan_speed;          // AC: ac_fan_speed_t
+    uint8_t swing;              // AC: ac_swing_t
+    uint16_t delay_ms;          // Pause after this step's frame
+} ir_scene_step_t;
+
+/**
+ * @brief Load stored scenes, compile them and start the playback task
+ *
+ * Call after ir_action_init() and ir_ac_state_init_units(). A stored
+ * scene that no longer compiles (action forgotten, AC unconfigured) is
+ * kept but cannot play until ir_scene_refresh() compiles it.
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t ir_scene_init(void);
+
+/**
+ * @brief Compile and store a scene
+ *
+ * Replaces a scene of the same name. Nothing is stored if a step does
+ * not compile.
+ *
+ * @param name Scene name (at most IR_SCENE_NAME_LEN - 1 characters)
+ * @param steps Steps in playback order
+ * @param num_steps Number of steps (1 to IR_SCENE_MAX_STEPS)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_FOUND if an action is
+ *         not learned, ESP_ERR_INVALID_STATE if an AC unit is not
+ *         configured, ESP_ERR_NO_MEM if all scene slots are used
+ */
+esp_err_t ir_scene_save(const char *name, const ir_scene_step_t *steps, size_t num_steps);
+
+/**
+ * @brief Delete a scene
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND
+ */
+esp_err_t ir_scene_delete(const char *name);
+
+/**
+ * @brief Queue a scene for playback
+ *
+ * Returns once the scene is queued; scenes play one after another. An
+ * AC step sends its five fields over the unit's state at play time
+ * (turbo, quiet and the other flags are not part of the step), and the
+ * units take over that state (and report it through the sync callback)
+ * after the last frame.
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, ESP_ERR_INVALID_STATE if the scene
+ *         did not compile, ESP_ERR_TIMEOUT if the playback queue is full
+ */
+esp_err_t ir_scene_play(const char *name);
+
+/**
+ * @brief Recompile every scene
+ *
+ * Call after anything a compiled frame depends on changed, such as an
+ * AC protocol. Saved, cleared and imported actions and emitter bindings
+ * refresh the scenes using them on their own (ir_scene_refresh_action()).
+ *
+ * @return ESP_OK if all scenes compiled, otherwise the first error
+ */
+esp_err_t ir_scene_refresh(void);
+
+/**
+ * @brief Recompile the scenes that play one action of a device
+ *
+ * Called by ir_action after an action record or emitter binding changed.
+ * Must not be called with the ir_action lock held: compiling loads
+ * actions.
+ *
+ * @param device Device of the action
+ * @param action Action, IR_ACTION_NONE for every action of @p device
+ * @return ESP_OK if those scenes compiled, ESP_ERR_INVALID_STATE before
+ *         ir_scene_init(), otherwise the first error
+ */
+esp_err_t ir_scene_refresh_action(ir_device_type_t device, ir_action_t action);
+
+/**
+ * @brief Number of stored scenes
+ */
+size_t ir_scene_get_count(void);
+
+/**
+ * @brief Name of a stored scene
+ *
+ * @param index Scene index (0 to ir_scene_get_count() - 1)
+ * @param name Output buffer
+ * @param len Size of @p name
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if @p index is out of range
+ */
+esp_err_t ir_scene_get_name(size_t index, char *name, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_SCENE_H
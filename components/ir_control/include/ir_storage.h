@@ -0,0 +1,221 @@
+/**
+ * @file ir_storage.h
+ * @brief Key/value storage shared by ir_control, ir_action, ir_ac_state and ir_scene
+ *
+ * Each module opens its namespace once with ir_storage_open() and reads
+ * and writes blobs through the returned handle. The namespace is served
+ * by a backend: NVS on the ir_storage partition by default, or an
+ * in-memory store (ir_storage_init_with()) so the storage path can run
+ * and be benchmarked on the host. ir_storage_mount() picks another
+ * backend (such as the ir_log ring for high-churn state) or a byte quota
+ * for one namespace.
+ *
+ * On top of the backend the layer keeps:
+ * - one cached backend handle per namespace, opened on first use;
+ * - an LRU cache of small values (IR_STORAGE_CACHE_VALUE_MAX bytes),
+ *   including keys known to be missing;
+ * - quota accounting for namespaces mounted with a quota;
+ * - per-namespace counters (ir_storage_get_stats()).
+ *
+ * Writes go straight to the backend; ir_storage_commit() makes them
+ * durable. Between ir_storage_begin_batch() and ir_storage_end_batch()
+ * commits are only recorded, so a bulk operation (restoring a backup,
+ * importing a remote) does one commit per namespace instead of one per
+ * code. Batches nest; the outermost end commits. A batch is global:
+ * writes from other tasks while it is open are committed with it.
+ *
+ * Copyright (c) 2025
+ */
+
+#ifndef IR_STORAGE_H
+#define IR_STORAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IR_STORAGE_PARTITION        "ir_storage"
+#define IR_STORAGE_KEY_MAX          16      // Including the terminator (NVS limit)
+#define IR_STORAGE_MAX_NAMESPACES   8
+#define IR_STORAGE_MAX_BACKENDS     4
+#define IR_STORAGE_CACHE_ENTRIES    16
+#define IR_STORAGE_CACHE_VALUE_MAX  64      // Larger values are read from the backend
+
+/* Ring log backend (ir_storage_backend_log) */
+#define IR_STORAGE_LOG_PARTITION        "ir_log"
+#define IR_STORAGE_LOG_MAX_NAMESPACES   4
+#define IR_STORAGE_LOG_MAX_KEYS         32
+#define IR_STORAGE_LOG_VALUE_MAX        128
+
+/**
+ * @brief Storage backend
+ *
+ * Calls are serialized by the storage layer. get() with a NULL buf
+ * returns the value size in *len. Missing keys are ESP_ERR_NOT_FOUND and
+ * a too small buffer is ESP_ERR_INVALID_SIZE, whatever the medium
+ * reports.
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(void);                                    // Once, before the first open
+    esp_err_t (*open)(const char *namespace_name, void **ctx);
+    void (*close)(void *ctx);
+    esp_err_t (*get)(void *ctx, const char *key, void *buf, size_t *len);
+    esp_err_t (*set)(void *ctx, const char *key, const void *data, size_t len);
+    esp_err_t (*erase)(void *ctx, const char *key);
+    esp_err_t (*erase_all)(void *ctx);
+    esp_err_t (*commit)(void *ctx);
+    esp_err_t (*used)(void *ctx, size_t *bytes);                // Optional; needed for quotas
+} ir_storage_backend_t;
+
+/** @brief NVS on the ir_storage partition */
+extern const ir_storage_backend_t ir_storage_backend_nvs;
+
+/**
+ * @brief Append-only ring log on the ir_log partition
+ *
+ * For small values rewritten often: each set is one flash program, with
+ * no commit and no NVS hashing. Holds up to IR_STORAGE_LOG_MAX_KEYS keys
+ * of IR_STORAGE_LOG_VALUE_MAX bytes. Init fails with ESP_ERR_NOT_FOUND
+ * when the partition table has no ir_log partition; ir_storage_open()
+ * then returns that without logging, and the caller reports its fallback.
+ */
+extern const ir_storage_backend_t ir_storage_backend_log;
+
+/** @brief Heap-backed store; contents survive ir_storage_deinit() until ir_storage_mem_reset() */
+extern const ir_storage_backend_t ir_storage_backend_mem;
+
+/**
+ * @brief Open namespace
+ */
+typedef struct ir_storage_ns *ir_storage_ns_t;
+
+/**
+ * @brief Per-namespace counters
+ */
+typedef struct {
+    uint32_t reads;                 // ir_storage_get() calls
+    uint32_t cache_hits;            // Reads answered without the backend
+    uint32_t writes;
+    uint32_t erases;
+    uint32_t commits;               // Backend commits
+    uint32_t deferred_commits;      // Commits merged into a batch
+    size_t used_bytes;              // Value bytes (namespaces with a quota only)
+    size_t quota_bytes;             // 0 = unlimited
+} ir_storage_stats_t;
+
+/**
+ * @brief Initialize storage with NVS as the default backend
+ *
+ * Initializes the ir_storage partition, erasing it if its format is
+ * outdated. Called by ir_control_init(), ir_action_init() and
+ * ir_ac_state_init(); later calls return ESP_OK.
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM, or the partition init error
+ */
+esp_err_t ir_storage_init(void);
+
+/**
+ * @brief Initialize storage with another default backend (host tests)
+ */
+esp_err_t ir_storage_init_with(const ir_storage_backend_t *backend);
+
+/**
+ * @brief Close every namespace and forget mounts, caches and counters
+ *
+ * Pending batch commits are made first.
+ */
+void ir_storage_deinit(void);
+
+/**
+ * @brief Serve a namespace from a given backend and/or with a quota
+ *
+ * Must be called before the namespace is first opened.
+ *
+ * @param namespace_name Namespace
+ * @param backend Backend, or NULL for the default one
+ * @param quota_bytes Maximum value bytes, 0 for unlimited
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if already open, ESP_ERR_NO_MEM when the table is full
+ */
+esp_err_t ir_storage_mount(const char *namespace_name, const ir_storage_backend_t *backend,
+                           size_t quota_bytes);
+
+/**
+ * @brief Open a namespace (the handle stays valid until ir_storage_deinit())
+ *
+ * Opening the same namespace again returns the same handle.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before init, or the backend error
+ */
+esp_err_t ir_storage_open(const char *namespace_name, ir_storage_ns_t *ns);
+
+/**
+ * @brief Read a value
+ *
+ * @param buf Output buffer, or NULL to query the size
+ * @param len In: buffer size; out: value size
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, ESP_ERR_INVALID_SIZE if buf is too small
+ */
+esp_err_t ir_storage_get(ir_storage_ns_t ns, const char *key, void *buf, size_t *len);
+
+/**
+ * @brief Write a value (durable after ir_storage_commit())
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM when over the namespace quota, or the backend error
+ */
+esp_err_t ir_storage_set(ir_storage_ns_t ns, const char *key, const void *data, size_t len);
+
+/**
+ * @brief Erase a value
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, or the backend error
+ */
+esp_err_t ir_storage_erase(ir_storage_ns_t ns, const char *key);
+
+/**
+ * @brief Erase every value of a namespace
+ */
+esp_err_t ir_storage_erase_all(ir_storage_ns_t ns);
+
+/**
+ * @brief Commit a namespace now, or at the end of the current batch
+ */
+esp_err_t ir_storage_commit(ir_storage_ns_t ns);
+
+/**
+ * @brief Start (or nest) a batch
+ */
+void ir_storage_begin_batch(void);
+
+/**
+ * @brief End a batch; the outermost end commits the namespaces written during it
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE without a batch, or the first commit error
+ */
+esp_err_t ir_storage_end_batch(void);
+
+/**
+ * @brief Whether a batch is open
+ */
+bool ir_storage_in_batch(void);
+
+/**
+ * @brief Read a namespace's counters
+ */
+esp_err_t ir_storage_get_stats(ir_storage_ns_t ns, ir_storage_stats_t *stats);
+
+/**
+ * @brief Drop all data held by the memory backend (call after ir_storage_deinit())
+ */
+void ir_storage_mem_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_STORAGE_H
@@ -0,0 +1,102 @@
+/**
+ * @file ir_transfer.h
+ * @brief Import and export of learned codes as Pronto Hex, LIRC or IRDB CSV
+ *
+ * Bridges the ir_formats.h parsers and writers to ir_action storage.
+ * Imported button names are mapped to actions by name ("KEY_VOLUMEUP",
+ * "Vol+", "VolumeUp" and "volume_up" all map to IR_ACTION_VOL_UP);
+ * unrecognized names are counted and skipped. An import is saved in one
+ * NVS commit (ir_storage_begin_batch()).
+ *
+ * Sources and sinks are streamed, so a file on SPIFFS or a blob received
+ * over RainMaker is converted without holding the whole text in RAM.
+ *
+ * Copyright (c) 2025
+ */
+
+#ifndef IR_TRANSFER_H
+#define IR_TRANSFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "ir_action.h"
+#include "ir_formats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Import / export totals
+ */
+typedef struct {
+    ir_format_stats_t format;   // Parser totals (import only)
+    uint16_t saved;             // Codes saved or written
+    uint16_t unmatched;         // Names without an action (import)
+    uint16_t unsupported;       // Codes the format cannot express (export)
+} ir_transfer_stats_t;
+
+/**
+ * @brief Map a button name to an action
+ *
+ * @return The action, or IR_ACTION_NONE if the name is not recognized
+ */
+ir_action_t ir_transfer_match_action(const char *name);
+
+/**
+ * @brief Import codes from a stream and save them for a device
+ *
+ * @param format Input format
+ * @param read Read callback
+ * @param ctx Read callback context
+ * @param device Device the codes belong to
+ * @param stats Output totals (may be NULL)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or a storage error
+ */
+esp_err_t ir_transfer_import(ir_format_t format, ir_format_read_fn read, void *ctx,
+                             ir_device_type_t device, ir_transfer_stats_t *stats);
+
+/**
+ * @brief Import codes from a file (e.g. on SPIFFS)
+ *
+ * @return As ir_transfer_import(), ESP_ERR_NOT_FOUND if the file cannot be opened
+ */
+esp_err_t ir_transfer_import_file(ir_format_t format, const char *path,
+                                  ir_device_type_t device, ir_transfer_stats_t *stats);
+
+/**
+ * @brief Import codes from a RAM blob (e.g. a RainMaker parameter)
+ */
+esp_err_t ir_transfer_import_blob(ir_format_t format, const char *data, size_t len,
+                                  ir_device_type_t device, ir_transfer_stats_t *stats);
+
+/**
+ * @brief Export every learned code of a device
+ *
+ * Pronto and LIRC get the rendered timing of protocol codes; CSV skips
+ * codes that have no IRDB form.
+ *
+ * @param format Output format
+ * @param device Device to export
+ * @param write Write callback
+ * @param ctx Write callback context
+ * @param stats Output totals (may be NULL)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or the write callback's error
+ */
+esp_err_t ir_transfer_export(ir_format_t format, ir_device_type_t device,
+                             ir_format_write_fn write, void *ctx, ir_transfer_stats_t *stats);
+
+/**
+ * @brief Export every learned code of a device to a file
+ *
+ * @return As ir_transfer_export(), ESP_FAIL if the file cannot be created
+ */
+esp_err_t ir_transfer_export_file(ir_format_t format, ir_device_type_t device, const char *path,
+                                  ir_transfer_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_TRANSFER_H
@@ -1,1057 +1,601 @@
 /**
  * @file ir_ac_encoders.c
- * @brief AC Protocol State Encoders - Full Implementation
+ * @brief AC Protocol State Encoders - Frame Maps
  *
- * This file contains protocol-specific state encoders for all supported AC protocols.
- * Each encoder takes an ac_state_t structure and generates a complete IR frame.
- *
- * Implementation Status: v3.1 - ALL ENCODERS IMPLEMENTED
+ * Each supported AC protocol is described here as a frame map: the
+ * constant template bytes, where every state field lives (byte, bit
+ * offset, width, value table), the checksum, carrier and frame structure.
+ * ir_ac_frame.c encodes any state from that description, decodes learned
+ * frames back into a state and keeps a template cache so state changes
+ * only rewrite the affected bytes.
  *
  * Supported Protocols:
  * - Carrier/Voltas (128-bit) - India #1 AC brand
- * - Daikin (312-bit multi-frame)
- * - Hitachi (264/344-bit variable)
+ * - Daikin (64-bit leader + 152-bit state frame)
+ * - Hitachi (264-bit)
  * - Mitsubishi (152-bit)
  * - Midea (48-bit) - Used by many brands
  * - Haier (104-bit)
  * - Samsung48 (48-bit)
  * - Panasonic/Kaseikyo (48-bit)
- * - Fujitsu (variable length)
+ * - Fujitsu (128-bit)
  * - LG2 (28-bit)
  *
  * Copyright (c) 2025
  */
 
 #include "ir_ac_state.h"
+#include "ir_ac_frame.h"
 #include "ir_control.h"
-#include "ir_protocols.h"
-#include "esp_log.h"
-#include <string.h>
-#include <stdlib.h>
-
-static const char *TAG = "ir_ac_encoders";
+#include "ir_daikin.h"
+#include <stddef.h>
 
 /* ============================================================================
- * HELPER FUNCTIONS
+ * SHARED VALUE TABLES
  * ============================================================================ */
 
-/**
- * @brief Convert byte array to RMT symbols (LSB first)
- *
- * @param data Byte array to encode
- * @param num_bytes Number of bytes
- * @param code Output IR code structure
- * @param mark_us Mark duration in microseconds
- * @param one_space_us Space duration for '1' bit
- * @param zero_space_us Space duration for '0' bit
- * @return ESP_OK on success
- */
-static esp_err_t encode_bytes_to_code_lsb(const uint8_t *data, size_t num_bytes,
-                                           ir_code_t *code,
-                                           uint16_t mark_us, uint16_t one_space_us,
-                                           uint16_t zero_space_us)
-{
-    /* Allocate raw data for symbols (mark + space per bit) */
-    size_t num_bits = num_bytes * 8;
-    code->raw_length = num_bits * 2; // Each bit is mark+space
-    code->raw_data = (uint16_t*)malloc(code->raw_length * sizeof(uint16_t));
-
-    if (!code->raw_data) {
-        ESP_LOGE(TAG, "Failed to allocate memory for raw data");
-        return ESP_ERR_NO_MEM;
-    }
+#define FIELD_TABLE(id, byte, shift, width, table) \
+    { (id), (byte), (shift), (width), (table), sizeof(table) }
+#define FIELD_FLAG(id, byte, shift) \
+    { (id), (byte), (shift), 1, NULL, 0 }
+#define FRAME_FIELDS(fields) (fields), (uint8_t)(sizeof(fields) / sizeof((fields)[0]))
 
-    size_t idx = 0;
-    for (size_t byte_idx = 0; byte_idx < num_bytes; byte_idx++) {
-        uint8_t byte = data[byte_idx];
+/* Temperature stored as °C - 16 (16-30°C) */
+static const uint8_t temp_minus_16[AC_FRAME_TEMP_STEPS] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14
+};
 
-        /* LSB first encoding */
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            code->raw_data[idx++] = mark_us; // Mark
+/* 0=Auto, 1=Low, 2=Medium, 3=High (Quiet/Turbo fall back to Auto) */
+static const uint8_t fan_auto_low_med_high[AC_FAN_MAX] = {
+    [AC_FAN_AUTO] = 0, [AC_FAN_LOW] = 1, [AC_FAN_MEDIUM] = 2, [AC_FAN_HIGH] = 3,
+};
 
-            if (byte & (1 << bit)) {
-                code->raw_data[idx++] = one_space_us; // '1' bit
-            } else {
-                code->raw_data[idx++] = zero_space_us; // '0' bit
-            }
-        }
-    }
+/* Any swing mode turns the louver on */
+static const uint8_t swing_on[AC_SWING_MAX] = {
+    [AC_SWING_OFF] = 0, [AC_SWING_VERTICAL] = 1, [AC_SWING_HORIZONTAL] = 1,
+    [AC_SWING_BOTH] = 1, [AC_SWING_AUTO] = 1,
+};
 
-    code->bits = num_bits;
-    return ESP_OK;
-}
+/* ============================================================================
+ * CARRIER/VOLTAS AC PROTOCOL
+ * ============================================================================ */
 
-/**
- * @brief Calculate nibble checksum (Carrier/Voltas style)
+/*
+ * Carrier/Voltas AC Protocol (128 bits = 16 bytes)
+ * Used by: Voltas (#1 AC in India), Blue Star, Lloyd
+ * Carrier: 38kHz, LSB first
+ *
+ * Byte 0-1: Header (0xB2 0x4D)
+ * Byte 2:   Command type (0x00 = state command)
+ * Byte 3:   Bit 0 power, bits 1-3 mode (0=Auto, 1=Cool, 2=Dry, 3=Fan, 4=Heat)
+ * Byte 4:   Temperature - 16
+ * Byte 5:   Fan (0=Auto, 1=Low, 2=Medium, 3=High)
+ * Byte 6:   Bit 0 vertical swing
+ * Byte 7-9: Turbo, sleep, econo
+ * Byte 15:  Nibble sum of bytes 0-14
  */
-static uint8_t calculate_nibble_checksum(const uint8_t *data, size_t len)
-{
-    uint16_t sum = 0;
-    for (size_t i = 0; i < len; i++) {
-        sum += (data[i] & 0x0F);        // Lower nibble
-        sum += ((data[i] >> 4) & 0x0F); // Upper nibble
-    }
-    return (uint8_t)(sum & 0x0F);
-}
+static const uint8_t carrier_template[16] = { 0xB2, 0x4D };
+
+static const uint8_t carrier_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 1, [AC_MODE_AUTO] = 0, [AC_MODE_COOL] = 1,
+    [AC_MODE_HEAT] = 4, [AC_MODE_DRY] = 2, [AC_MODE_FAN] = 3,
+};
+
+static const uint8_t carrier_swing[AC_SWING_MAX] = {
+    [AC_SWING_VERTICAL] = 1, [AC_SWING_BOTH] = 1,
+};
+
+static const ac_field_t carrier_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, 3, 0),
+    FIELD_TABLE(AC_FIELD_MODE, 3, 1, 3, carrier_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 4, 0, 8, temp_minus_16),
+    FIELD_TABLE(AC_FIELD_FAN, 5, 0, 8, fan_auto_low_med_high),
+    FIELD_TABLE(AC_FIELD_SWING, 6, 0, 1, carrier_swing),
+    FIELD_FLAG(AC_FIELD_TURBO, 7, 0),
+    FIELD_FLAG(AC_FIELD_SLEEP, 8, 0),
+    FIELD_FLAG(AC_FIELD_ECONO, 9, 0),
+};
+
+static const ac_frame_map_t carrier_map = {
+    .protocol = IR_PROTOCOL_CARRIER,
+    .name = "Carrier/Voltas",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(carrier_template),
+    .template_bytes = carrier_template,
+    .fields = FRAME_FIELDS(carrier_fields),
+    .checksum = AC_CHECKSUM_NIBBLE_SUM,
+    .checksum_start = 0, .checksum_end = 15, .checksum_byte = 15,
+};
 
-/**
- * @brief Calculate byte sum checksum
- */
-static uint8_t calculate_byte_sum(const uint8_t *data, size_t len)
-{
-    uint16_t sum = 0;
-    for (size_t i = 0; i < len; i++) {
-        sum += data[i];
-    }
-    return (uint8_t)(sum & 0xFF);
-}
+/* ============================================================================
+ * DAIKIN AC PROTOCOL
+ * ============================================================================ */
 
-/**
- * @brief Reverse bits in a byte (for MSB-first protocols)
+/*
+ * Daikin AC Protocol (64-bit leader + 152-bit state frame = 27 bytes)
+ * Carrier: 38kHz, frames separated by a 29ms gap
+ *
+ * Leader (bytes 0-7): constant 0x11 0xDA 0x27 0xF0 0x00 0x00 0x00 0x02,
+ * the last byte being the sum of the first seven.
+ *
+ * State frame, offsets from byte 8:
+ * Byte 0-4: Header (0x11 0xDA 0x27 0x00 0xC5)
+ * Byte 5:   Bit 0 power, bits 4-6 mode (0=Fan, 2=Dry, 3=Cool, 4=Heat, 7=Auto)
+ * Byte 6:   Temperature * 2
+ * Byte 8:   Bits 4-7 fan (3=Auto, 4=Low, 5=Medium, 6=High, 7=Turbo)
+ * Byte 9:   0xF0 = swing off, 0xF1 = vertical swing
+ * Byte 13:  Bit 0 turbo, bit 1 quiet, bit 2 econo
+ * Byte 18:  Byte sum of bytes 0-17
  */
-static uint8_t __attribute__((unused)) reverse_bits(uint8_t byte)
-{
-    uint8_t result = 0;
-    for (int i = 0; i < 8; i++) {
-        result <<= 1;
-        result |= (byte & 1);
-        byte >>= 1;
-    }
-    return result;
-}
+#define DAIKIN_STATE(n)     (DAIKIN_FRAME1_BYTES + (n))
+
+static const uint8_t daikin_template[DAIKIN_TOTAL_BYTES] = {
+    0x11, 0xDA, 0x27, 0xF0, 0x00, 0x00, 0x00, 0x02,
+    0x11, 0xDA, 0x27, 0x00, 0xC5, 0x00, 0x00, 0x00, 0x00, 0xF0
+};
+
+static const uint8_t daikin_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 3, [AC_MODE_AUTO] = 7, [AC_MODE_COOL] = 3,
+    [AC_MODE_HEAT] = 4, [AC_MODE_DRY] = 2, [AC_MODE_FAN] = 0,
+};
+
+static const uint8_t daikin_temps[AC_FRAME_TEMP_STEPS] = {
+    32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60
+};
+
+static const uint8_t daikin_fans[AC_FAN_MAX] = {
+    [AC_FAN_AUTO] = 3, [AC_FAN_LOW] = 4, [AC_FAN_MEDIUM] = 5,
+    [AC_FAN_HIGH] = 6, [AC_FAN_QUIET] = 3, [AC_FAN_TURBO] = 7,
+};
+
+static const ac_field_t daikin_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, DAIKIN_STATE(5), 0),
+    FIELD_TABLE(AC_FIELD_MODE, DAIKIN_STATE(5), 4, 3, daikin_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, DAIKIN_STATE(6), 0, 8, daikin_temps),
+    FIELD_TABLE(AC_FIELD_FAN, DAIKIN_STATE(8), 4, 4, daikin_fans),
+    FIELD_TABLE(AC_FIELD_SWING, DAIKIN_STATE(9), 0, 1, swing_on),
+    FIELD_FLAG(AC_FIELD_TURBO, DAIKIN_STATE(13), 0),
+    FIELD_FLAG(AC_FIELD_QUIET, DAIKIN_STATE(13), 1),
+    FIELD_FLAG(AC_FIELD_ECONO, DAIKIN_STATE(13), 2),
+};
+
+static const ac_frame_map_t daikin_map = {
+    .protocol = IR_PROTOCOL_DAIKIN,
+    .name = "Daikin",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(daikin_template),
+    .num_frames = 2,
+    .frame_bytes = { DAIKIN_FRAME1_BYTES, DAIKIN_FRAME2_BYTES },
+    .frame_gap_us = DAIKIN_GAP,
+    .template_bytes = daikin_template,
+    .fields = FRAME_FIELDS(daikin_fields),
+    .checksum = AC_CHECKSUM_BYTE_SUM,
+    .checksum_start = DAIKIN_STATE(0), .checksum_end = DAIKIN_STATE(18),
+    .checksum_byte = DAIKIN_STATE(18),
+};
 
 /* ============================================================================
- * CARRIER/VOLTAS AC PROTOCOL ENCODER
+ * HITACHI AC PROTOCOL
  * ============================================================================ */
 
-esp_err_t ir_ac_encode_carrier(const ac_state_t *state, ir_code_t *code)
-{
-    /*
-     * Carrier/Voltas AC Protocol (128 bits = 16 bytes)
-     * Used by: Voltas (#1 AC in India), Blue Star, Lloyd
-     * Carrier: 38kHz
-     * Format: LSB first
-     * Checksum: Nibble sum of bytes 0-14 stored in lower nibble of byte 15
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Carrier/Voltas AC state");
-
-    uint8_t data[16] = {0};
-
-    /* Byte 0-1: Header */
-    data[0] = 0xB2;
-    data[1] = 0x4D;
+/*
+ * Hitachi AC Protocol (264 bits = 33 bytes; the 344-bit variant is not sent)
+ * Carrier: 38kHz
+ *
+ * Byte 0-8: Header (0x01 0x10 0x00 0x40 0xBF 0xFF 0x00 0xCC 0x33)
+ * Byte 9:   Power
+ * Byte 10:  Mode (2=Dry, 3=Cool, 4=Heat, 5=Fan, 6=Auto)
+ * Byte 11:  Temperature - 16
+ * Byte 13:  Fan (1=Auto, 2=Low, 3=Medium, 4=High)
+ * Byte 14:  Swing
+ * Byte 32:  Byte sum of bytes 0-31
+ */
+static const uint8_t hitachi_template[33] = {
+    0x01, 0x10, 0x00, 0x40, 0xBF, 0xFF, 0x00, 0xCC, 0x33
+};
+
+static const uint8_t hitachi_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 3, [AC_MODE_AUTO] = 6, [AC_MODE_COOL] = 3,
+    [AC_MODE_HEAT] = 4, [AC_MODE_DRY] = 2, [AC_MODE_FAN] = 5,
+};
+
+static const uint8_t hitachi_fans[AC_FAN_MAX] = {
+    [AC_FAN_AUTO] = 1, [AC_FAN_LOW] = 2, [AC_FAN_MEDIUM] = 3,
+    [AC_FAN_HIGH] = 4, [AC_FAN_QUIET] = 1, [AC_FAN_TURBO] = 1,
+};
+
+static const ac_field_t hitachi_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, 9, 0),
+    FIELD_TABLE(AC_FIELD_MODE, 10, 0, 8, hitachi_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 11, 0, 8, temp_minus_16),
+    FIELD_TABLE(AC_FIELD_FAN, 13, 0, 8, hitachi_fans),
+    FIELD_TABLE(AC_FIELD_SWING, 14, 0, 1, swing_on),
+};
+
+static const ac_frame_map_t hitachi_map = {
+    .protocol = IR_PROTOCOL_HITACHI,
+    .name = "Hitachi",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(hitachi_template),
+    .template_bytes = hitachi_template,
+    .fields = FRAME_FIELDS(hitachi_fields),
+    .checksum = AC_CHECKSUM_BYTE_SUM,
+    .checksum_start = 0, .checksum_end = 32, .checksum_byte = 32,
+};
 
-    /* Byte 2: Command type (0x00 = state command) */
-    data[2] = 0x00;
+/* ============================================================================
+ * MITSUBISHI AC PROTOCOL
+ * ============================================================================ */
 
-    /* Byte 3: Power and Mode
-     * Bit 0: Power (1 = ON, 0 = OFF)
-     * Bits 1-3: Mode (0=Auto, 1=Cool, 2=Dry, 3=Fan, 4=Heat)
-     */
-    data[3] = 0;
-    if (state->power) {
-        data[3] |= 0x01;
-    }
+/*
+ * Mitsubishi AC Protocol (152 bits = 19 bytes)
+ * Carrier: 38kHz
+ *
+ * Byte 0-4: Header (0x23 0xCB 0x26 0x01 0x00)
+ * Byte 5:   Bit 5 power
+ * Byte 6:   Mode (0x18=Auto, 0x08=Cool, 0x10=Dry, 0x20=Heat, 0x38=Fan)
+ * Byte 7:   31 - temperature
+ * Byte 9:   Fan (0=Auto, 1=Low, 2=Medium, 3=High)
+ * Byte 10:  Bit 6 swing
+ * Byte 18:  Byte sum of bytes 0-17
+ */
+static const uint8_t mitsubishi_template[19] = { 0x23, 0xCB, 0x26, 0x01, 0x00 };
+
+static const uint8_t mitsubishi_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 0x08, [AC_MODE_AUTO] = 0x18, [AC_MODE_COOL] = 0x08,
+    [AC_MODE_HEAT] = 0x20, [AC_MODE_DRY] = 0x10, [AC_MODE_FAN] = 0x38,
+};
+
+static const uint8_t mitsubishi_temps[AC_FRAME_TEMP_STEPS] = {
+    15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
+};
+
+static const ac_field_t mitsubishi_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, 5, 5),
+    FIELD_TABLE(AC_FIELD_MODE, 6, 0, 8, mitsubishi_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 7, 0, 8, mitsubishi_temps),
+    FIELD_TABLE(AC_FIELD_FAN, 9, 0, 8, fan_auto_low_med_high),
+    FIELD_TABLE(AC_FIELD_SWING, 10, 6, 1, swing_on),
+};
+
+static const ac_frame_map_t mitsubishi_map = {
+    .protocol = IR_PROTOCOL_MITSUBISHI,
+    .name = "Mitsubishi",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(mitsubishi_template),
+    .template_bytes = mitsubishi_template,
+    .fields = FRAME_FIELDS(mitsubishi_fields),
+    .checksum = AC_CHECKSUM_BYTE_SUM,
+    .checksum_start = 0, .checksum_end = 18, .checksum_byte = 18,
+};
 
-    uint8_t mode_bits = 0;
-    switch (state->mode) {
-        case AC_MODE_AUTO: mode_bits = 0; break;
-        case AC_MODE_COOL: mode_bits = 1; break;
-        case AC_MODE_DRY:  mode_bits = 2; break;
-        case AC_MODE_FAN:  mode_bits = 3; break;
-        case AC_MODE_HEAT: mode_bits = 4; break;
-        default: mode_bits = 1; break;
-    }
-    data[3] |= (mode_bits << 1);
-
-    /* Byte 4: Temperature (16-30°C, offset by 16) */
-    uint8_t temp = state->temperature;
-    if (temp < 16) temp = 16;
-    if (temp > 30) temp = 30;
-    data[4] = temp - 16;
-
-    /* Byte 5: Fan Speed
-     * 0=Auto, 1=Low, 2=Medium, 3=High
-     */
-    uint8_t fan_bits = 0;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 0; break;
-        case AC_FAN_LOW:    fan_bits = 1; break;
-        case AC_FAN_MEDIUM: fan_bits = 2; break;
-        case AC_FAN_HIGH:   fan_bits = 3; break;
-        default: fan_bits = 0; break;
-    }
-    data[5] = fan_bits;
-
-    /* Byte 6: Swing
-     * Bit 0: Vertical swing (1 = ON)
-     */
-    data[6] = 0;
-    if (state->swing == AC_SWING_VERTICAL || state->swing == AC_SWING_BOTH) {
-        data[6] |= 0x01;
-    }
+/* ============================================================================
+ * MIDEA AC PROTOCOL (48-bit)
+ * ============================================================================ */
 
-    /* Byte 7: Turbo mode */
-    data[7] = state->turbo ? 0x01 : 0x00;
-
-    /* Byte 8-14: Reserved/extended features */
-    data[8] = state->sleep ? 0x01 : 0x00;
-    data[9] = state->econo ? 0x01 : 0x00;
-    data[10] = 0x00; // Reserved
-    data[11] = 0x00;
-    data[12] = 0x00;
-    data[13] = 0x00;
-    data[14] = 0x00;
-
-    /* Byte 15: Checksum (nibble sum of bytes 0-14) */
-    data[15] = calculate_nibble_checksum(data, 15);
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_CARRIER;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols (NEC-like timing) */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 16, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
-    }
+/*
+ * Midea AC Protocol (48 bits = 6 bytes)
+ * Used by: Midea, Electrolux, Qlima, and many brands
+ * Carrier: 38kHz
+ *
+ * Byte 0-1: Header (0xB2 0x4D)
+ * Byte 2:   Bit 5 power, bits 0-2 mode (0=Auto, 1=Cool, 2=Dry, 3=Heat, 4=Fan)
+ * Byte 3:   Bits 0-3 temperature - 17 (17-30°C), bits 4-7 fan
+ * Byte 4:   Bit 0 swing, bit 1 turbo, bit 2 sleep
+ * Byte 5:   XOR of bytes 0-4
+ */
+static const uint8_t midea_template[6] = { 0xB2, 0x4D };
+
+static const uint8_t midea_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 1, [AC_MODE_AUTO] = 0, [AC_MODE_COOL] = 1,
+    [AC_MODE_HEAT] = 3, [AC_MODE_DRY] = 2, [AC_MODE_FAN] = 4,
+};
+
+static const uint8_t midea_temps[AC_FRAME_TEMP_STEPS] = {
+    0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13
+};
+
+static const ac_field_t midea_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, 2, 5),
+    FIELD_TABLE(AC_FIELD_MODE, 2, 0, 3, midea_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 3, 0, 4, midea_temps),
+    FIELD_TABLE(AC_FIELD_FAN, 3, 4, 4, fan_auto_low_med_high),
+    FIELD_TABLE(AC_FIELD_SWING, 4, 0, 1, swing_on),
+    FIELD_FLAG(AC_FIELD_TURBO, 4, 1),
+    FIELD_FLAG(AC_FIELD_SLEEP, 4, 2),
+};
+
+static const ac_frame_map_t midea_map = {
+    .protocol = IR_PROTOCOL_MIDEA,
+    .name = "Midea",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(midea_template),
+    .template_bytes = midea_template,
+    .fields = FRAME_FIELDS(midea_fields),
+    .checksum = AC_CHECKSUM_XOR,
+    .checksum_start = 0, .checksum_end = 5, .checksum_byte = 5,
+};
 
-    ESP_LOGI(TAG, "Carrier/Voltas: Power=%s, Mode=%d, Temp=%d°C, Fan=%d",
-             state->power ? "ON" : "OFF", state->mode, state->temperature, state->fan_speed);
+/* ============================================================================
+ * HAIER AC PROTOCOL
+ * ============================================================================ */
 
-    return ESP_OK;
-}
+/*
+ * Haier AC Protocol (104 bits = 13 bytes)
+ * Carrier: 38kHz
+ *
+ * Byte 0-1: Header (0xA5 0xA5)
+ * Byte 2:   Power
+ * Byte 3:   Mode (0=Auto, 1=Cool, 2=Dry, 3=Heat, 4=Fan)
+ * Byte 4:   Temperature - 16
+ * Byte 5:   Fan (0=Auto, 1=Low, 2=Medium, 3=High)
+ * Byte 6:   Swing
+ * Byte 12:  Byte sum of bytes 0-11
+ */
+static const uint8_t haier_template[13] = { 0xA5, 0xA5 };
+
+static const uint8_t haier_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 1, [AC_MODE_AUTO] = 0, [AC_MODE_COOL] = 1,
+    [AC_MODE_HEAT] = 3, [AC_MODE_DRY] = 2, [AC_MODE_FAN] = 4,
+};
+
+static const ac_field_t haier_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, 2, 0),
+    FIELD_TABLE(AC_FIELD_MODE, 3, 0, 8, haier_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 4, 0, 8, temp_minus_16),
+    FIELD_TABLE(AC_FIELD_FAN, 5, 0, 8, fan_auto_low_med_high),
+    FIELD_TABLE(AC_FIELD_SWING, 6, 0, 1, swing_on),
+};
+
+static const ac_frame_map_t haier_map = {
+    .protocol = IR_PROTOCOL_HAIER,
+    .name = "Haier",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(haier_template),
+    .template_bytes = haier_template,
+    .fields = FRAME_FIELDS(haier_fields),
+    .checksum = AC_CHECKSUM_BYTE_SUM,
+    .checksum_start = 0, .checksum_end = 12, .checksum_byte = 12,
+};
 
 /* ============================================================================
- * DAIKIN AC PROTOCOL ENCODER
+ * SAMSUNG48 AC PROTOCOL
  * ============================================================================ */
 
-esp_err_t ir_ac_encode_daikin(const ac_state_t *state, ir_code_t *code)
-{
-    /*
-     * Daikin AC Protocol (Multi-frame, 312 bits total)
-     * Frame 1: 64 bits (header frame)
-     * Frame 2: 64 bits (basic frame)
-     * Frame 3: 152 bits (state frame)
-     * Gap between frames: 29ms
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
+/*
+ * Samsung48 AC Protocol (48 bits = 6 bytes)
+ * Carrier: 38kHz
+ *
+ * Byte 0-1: Header (0x04 0x70)
+ * Byte 2:   Bits 0-2 mode (0=Auto, 1=Cool, 2=Dry, 3=Fan, 4=Heat), bit 3 power
+ * Byte 3:   Temperature - 16
+ * Byte 4:   Fan (0=Auto, 1=Low, 2=Medium, 3=High)
+ * Byte 5:   XOR of bytes 0-4
+ */
+static const uint8_t samsung48_template[6] = { 0x04, 0x70 };
+
+static const uint8_t samsung48_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 1, [AC_MODE_AUTO] = 0, [AC_MODE_COOL] = 1,
+    [AC_MODE_HEAT] = 4, [AC_MODE_DRY] = 2, [AC_MODE_FAN] = 3,
+};
+
+static const ac_field_t samsung48_fields[] = {
+    FIELD_TABLE(AC_FIELD_MODE, 2, 0, 3, samsung48_modes),
+    FIELD_FLAG(AC_FIELD_POWER, 2, 3),
+    FIELD_TABLE(AC_FIELD_TEMP, 3, 0, 8, temp_minus_16),
+    FIELD_TABLE(AC_FIELD_FAN, 4, 0, 8, fan_auto_low_med_high),
+};
+
+static const ac_frame_map_t samsung48_map = {
+    .protocol = IR_PROTOCOL_SAMSUNG48,
+    .name = "Samsung48",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(samsung48_template),
+    .template_bytes = samsung48_template,
+    .fields = FRAME_FIELDS(samsung48_fields),
+    .checksum = AC_CHECKSUM_XOR,
+    .checksum_start = 0, .checksum_end = 5, .checksum_byte = 5,
+};
 
-    ESP_LOGI(TAG, "Encoding Daikin AC state (multi-frame)");
-
-    /* For simplicity, we'll encode the main state frame (Frame 3)
-     * Full multi-frame implementation would require multiple transmissions */
-
-    uint8_t data[19] = {0};
-
-    /* Header */
-    data[0] = 0x11;
-    data[1] = 0xDA;
-    data[2] = 0x27;
-    data[3] = 0x00;
-    data[4] = 0xC5;
-
-    /* Byte 5: Power and Mode
-     * Bit 0: Power
-     * Bits 4-6: Mode (0=Fan, 2=Dry, 3=Cool, 4=Heat, 7=Auto)
-     */
-    data[5] = state->power ? 0x01 : 0x00;
-
-    uint8_t mode_bits = 3; // Default Cool
-    switch (state->mode) {
-        case AC_MODE_FAN:  mode_bits = 0; break;
-        case AC_MODE_DRY:  mode_bits = 2; break;
-        case AC_MODE_COOL: mode_bits = 3; break;
-        case AC_MODE_HEAT: mode_bits = 4; break;
-        case AC_MODE_AUTO: mode_bits = 7; break;
-        default: mode_bits = 3; break;
-    }
-    data[5] |= (mode_bits << 4);
-
-    /* Byte 6: Temperature (10-32°C, encoded as (temp * 2)) */
-    uint8_t temp = state->temperature;
-    if (temp < 10) temp = 10;
-    if (temp > 32) temp = 32;
-    data[6] = temp * 2;
-
-    /* Byte 8: Fan Speed
-     * 3=Auto, 4=Low, 5=Medium, 6=High, 7=Turbo
-     */
-    uint8_t fan_bits = 3; // Auto
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 3; break;
-        case AC_FAN_LOW:    fan_bits = 4; break;
-        case AC_FAN_MEDIUM: fan_bits = 5; break;
-        case AC_FAN_HIGH:   fan_bits = 6; break;
-        case AC_FAN_TURBO:  fan_bits = 7; break;
-        default: fan_bits = 3; break;
-    }
-    data[8] = (fan_bits << 4);
-
-    /* Byte 9: Swing
-     * 0xF0 = OFF, 0xF1 = Vertical
-     */
-    data[9] = (state->swing != AC_SWING_OFF) ? 0xF1 : 0xF0;
-
-    /* Byte 13: Advanced features */
-    data[13] = 0;
-    if (state->turbo) data[13] |= 0x01;
-    if (state->quiet) data[13] |= 0x02;
-    if (state->econo) data[13] |= 0x04;
-
-    /* Bytes 7, 10-17: Other state fields */
-    data[7] = 0x00;
-    for (int i = 10; i < 18; i++) {
-        data[i] = 0x00;
-    }
+/* ============================================================================
+ * PANASONIC/KASEIKYO AC PROTOCOL
+ * ============================================================================ */
 
-    /* Byte 18: Checksum (byte sum of bytes 0-17) */
-    data[18] = calculate_byte_sum(data, 18);
+/*
+ * Panasonic/Kaseikyo AC Protocol (48 bits = 6 bytes)
+ * Carrier: 38kHz
+ *
+ * Byte 0-1: Header (0x02 0x20)
+ * Byte 2:   Bit 0 power, bits 4-6 mode (0=Auto, 1=Dry, 2=Cool, 3=Heat, 4=Fan)
+ * Byte 3:   Temperature - 16
+ * Byte 4:   Fan (0=Auto, 1=Low, 2=Medium, 3=High)
+ * Byte 5:   XOR of bytes 0-4
+ */
+static const uint8_t panasonic_template[6] = { 0x02, 0x20 };
+
+static const uint8_t panasonic_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 2, [AC_MODE_AUTO] = 0, [AC_MODE_COOL] = 2,
+    [AC_MODE_HEAT] = 3, [AC_MODE_DRY] = 1, [AC_MODE_FAN] = 4,
+};
+
+static const ac_field_t panasonic_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, 2, 0),
+    FIELD_TABLE(AC_FIELD_MODE, 2, 4, 3, panasonic_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 3, 0, 8, temp_minus_16),
+    FIELD_TABLE(AC_FIELD_FAN, 4, 0, 8, fan_auto_low_med_high),
+};
+
+static const ac_frame_map_t panasonic_map = {
+    .protocol = IR_PROTOCOL_PANASONIC,
+    .name = "Panasonic",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(panasonic_template),
+    .template_bytes = panasonic_template,
+    .fields = FRAME_FIELDS(panasonic_fields),
+    .checksum = AC_CHECKSUM_XOR,
+    .checksum_start = 0, .checksum_end = 5, .checksum_byte = 5,
+};
 
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_DAIKIN;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
+/* ============================================================================
+ * FUJITSU AC PROTOCOL
+ * ============================================================================ */
 
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 19, code, 428, 1280, 428);
-    if (err != ESP_OK) {
-        return err;
-    }
+/*
+ * Fujitsu AC Protocol (128 bits = 16 bytes)
+ * Carrier: 38kHz
+ *
+ * Byte 0-4: Header (0x14 0x63 0x00 0x10 0x10)
+ * Byte 5:   Bit 1 power
+ * Byte 6:   Mode (0=Auto, 1=Cool, 2=Dry, 3=Fan, 4=Heat)
+ * Byte 7:   Temperature - 16
+ * Byte 8:   Fan (0=Auto, 1=Low, 2=Medium, 3=High)
+ * Byte 9:   Swing
+ * Byte 15:  Byte sum of bytes 0-14
+ */
+static const uint8_t fujitsu_template[16] = { 0x14, 0x63, 0x00, 0x10, 0x10 };
+
+static const uint8_t fujitsu_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 1, [AC_MODE_AUTO] = 0, [AC_MODE_COOL] = 1,
+    [AC_MODE_HEAT] = 4, [AC_MODE_DRY] = 2, [AC_MODE_FAN] = 3,
+};
+
+static const ac_field_t fujitsu_fields[] = {
+    FIELD_FLAG(AC_FIELD_POWER, 5, 1),
+    FIELD_TABLE(AC_FIELD_MODE, 6, 0, 8, fujitsu_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 7, 0, 8, temp_minus_16),
+    FIELD_TABLE(AC_FIELD_FAN, 8, 0, 8, fan_auto_low_med_high),
+    FIELD_TABLE(AC_FIELD_SWING, 9, 0, 1, swing_on),
+};
+
+static const ac_frame_map_t fujitsu_map = {
+    .protocol = IR_PROTOCOL_FUJITSU,
+    .name = "Fujitsu",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(fujitsu_template),
+    .template_bytes = fujitsu_template,
+    .fields = FRAME_FIELDS(fujitsu_fields),
+    .checksum = AC_CHECKSUM_BYTE_SUM,
+    .checksum_start = 0, .checksum_end = 15, .checksum_byte = 15,
+};
 
-    ESP_LOGI(TAG, "Daikin: Power=%s, Mode=%d, Temp=%d°C, Fan=%d",
-             state->power ? "ON" : "OFF", state->mode, state->temperature, state->fan_speed);
+/* ============================================================================
+ * LG2 AC PROTOCOL
+ * ============================================================================ */
 
-    return ESP_OK;
-}
+/*
+ * LG2 AC Protocol (28 bits, sent from a 4-byte image)
+ * Carrier: 38kHz
+ *
+ * Bits 0-3:   Header (0x8)
+ * Bits 4-7:   Mode (0=Cool, 1=Dry, 2=Fan, 4=Auto, 5=Heat)
+ * Bits 8-11:  Temperature - 15 (18-30°C)
+ * Bits 12-13: Fan (0=Low, 1=Medium, 2=High, 3=Auto)
+ * Bit 14:     Power
+ * Bits 24-27: Sum of the nibbles of bits 0-23
+ */
+static const uint8_t lg2_template[4] = { 0x08 };
+
+static const uint8_t lg2_modes[AC_MODE_MAX] = {
+    [AC_MODE_OFF] = 0, [AC_MODE_AUTO] = 4, [AC_MODE_COOL] = 0,
+    [AC_MODE_HEAT] = 5, [AC_MODE_DRY] = 1, [AC_MODE_FAN] = 2,
+};
+
+static const uint8_t lg2_temps[AC_FRAME_TEMP_STEPS] = {
+    3, 3, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+static const uint8_t lg2_fans[AC_FAN_MAX] = {
+    [AC_FAN_AUTO] = 3, [AC_FAN_LOW] = 0, [AC_FAN_MEDIUM] = 1,
+    [AC_FAN_HIGH] = 2, [AC_FAN_QUIET] = 3, [AC_FAN_TURBO] = 3,
+};
+
+static const ac_field_t lg2_fields[] = {
+    FIELD_TABLE(AC_FIELD_MODE, 0, 4, 4, lg2_modes),
+    FIELD_TABLE(AC_FIELD_TEMP, 1, 0, 4, lg2_temps),
+    FIELD_TABLE(AC_FIELD_FAN, 1, 4, 2, lg2_fans),
+    FIELD_FLAG(AC_FIELD_POWER, 1, 6),
+};
+
+static const ac_frame_map_t lg2_map = {
+    .protocol = IR_PROTOCOL_LG2,
+    .name = "LG2",
+    .carrier_hz = 38000,
+    .num_bytes = sizeof(lg2_template),
+    .bits = 28,
+    .template_bytes = lg2_template,
+    .fields = FRAME_FIELDS(lg2_fields),
+    .checksum = AC_CHECKSUM_NIBBLE_SUM,
+    .checksum_start = 0, .checksum_end = 3, .checksum_byte = 3,
+};
 
 /* ============================================================================
- * HITACHI AC PROTOCOL ENCODER
+ * MAP LOOKUP AND PROTOCOL ENCODERS
  * ============================================================================ */
 
-esp_err_t ir_ac_encode_hitachi(const ac_state_t *state, ir_code_t *code)
+const ac_frame_map_t *ir_ac_frame_get_map(ir_protocol_t protocol)
 {
-    /*
-     * Hitachi AC Protocol (264 bits = 33 bytes or 344 bits = 43 bytes)
-     * We'll use 33 bytes variant (most common)
-     * Checksum: Byte sum
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Hitachi AC state");
-
-    uint8_t data[33] = {0};
-
-    /* Header */
-    data[0] = 0x01;
-    data[1] = 0x10;
-    data[2] = 0x00;
-    data[3] = 0x40;
-    data[4] = 0xBF;
-    data[5] = 0xFF;
-    data[6] = 0x00;
-    data[7] = 0xCC;
-    data[8] = 0x33;
-
-    /* Byte 9: Power */
-    data[9] = state->power ? 0x01 : 0x00;
-
-    /* Byte 10: Mode
-     * 2=Dry, 3=Cool, 4=Heat, 5=Fan, 6=Auto
-     */
-    uint8_t mode_bits = 3;
-    switch (state->mode) {
-        case AC_MODE_DRY:  mode_bits = 2; break;
-        case AC_MODE_COOL: mode_bits = 3; break;
-        case AC_MODE_HEAT: mode_bits = 4; break;
-        case AC_MODE_FAN:  mode_bits = 5; break;
-        case AC_MODE_AUTO: mode_bits = 6; break;
-        default: mode_bits = 3; break;
-    }
-    data[10] = mode_bits;
-
-    /* Byte 11: Temperature (16-32°C, offset by 16) */
-    uint8_t temp = state->temperature;
-    if (temp < 16) temp = 16;
-    if (temp > 32) temp = 32;
-    data[11] = temp - 16;
-
-    /* Byte 13: Fan Speed
-     * 1=Auto, 2=Low, 3=Medium, 4=High
-     */
-    uint8_t fan_bits = 1;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 1; break;
-        case AC_FAN_LOW:    fan_bits = 2; break;
-        case AC_FAN_MEDIUM: fan_bits = 3; break;
-        case AC_FAN_HIGH:   fan_bits = 4; break;
-        default: fan_bits = 1; break;
-    }
-    data[13] = fan_bits;
-
-    /* Byte 14: Swing */
-    data[14] = (state->swing != AC_SWING_OFF) ? 0x01 : 0x00;
-
-    /* Bytes 12, 15-31: Other fields */
-    data[12] = 0x00;
-    for (int i = 15; i < 32; i++) {
-        data[i] = 0x00;
-    }
-
-    /* Byte 32: Checksum (byte sum of bytes 0-31) */
-    data[32] = calculate_byte_sum(data, 32);
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_HITACHI;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 33, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
+    switch (protocol) {
+        case IR_PROTOCOL_CARRIER:    return &carrier_map;
+        case IR_PROTOCOL_DAIKIN:     return &daikin_map;
+        case IR_PROTOCOL_HITACHI:    return &hitachi_map;
+        case IR_PROTOCOL_MITSUBISHI: return &mitsubishi_map;
+        case IR_PROTOCOL_MIDEA:      return &midea_map;
+        case IR_PROTOCOL_HAIER:      return &haier_map;
+        case IR_PROTOCOL_SAMSUNG48:  return &samsung48_map;
+        case IR_PROTOCOL_PANASONIC:
+        case IR_PROTOCOL_KASEIKYO:   return &panasonic_map;
+        case IR_PROTOCOL_FUJITSU:    return &fujitsu_map;
+        case IR_PROTOCOL_LG2:        return &lg2_map;
+        default:                     return NULL;
     }
+}
 
-    ESP_LOGI(TAG, "Hitachi: Power=%s, Mode=%d, Temp=%d°C, Fan=%d",
-             state->power ? "ON" : "OFF", state->mode, state->temperature, state->fan_speed);
+esp_err_t ir_ac_encode_carrier(const ac_state_t *state, ir_code_t *code)
+{
+    return ir_ac_frame_encode(&carrier_map, state, code);
+}
 
-    return ESP_OK;
+esp_err_t ir_ac_encode_daikin(const ac_state_t *state, ir_code_t *code)
+{
+    return ir_ac_frame_encode(&daikin_map, state, code);
 }
 
-/* ============================================================================
- * MITSUBISHI AC PROTOCOL ENCODER
- * ============================================================================ */
+esp_err_t ir_ac_encode_hitachi(const ac_state_t *state, ir_code_t *code)
+{
+    return ir_ac_frame_encode(&hitachi_map, state, code);
+}
 
 esp_err_t ir_ac_encode_mitsubishi(const ac_state_t *state, ir_code_t *code)
 {
-    /*
-     * Mitsubishi AC Protocol (152 bits = 19 bytes)
-     * Checksum: Byte sum
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Mitsubishi AC state");
-
-    uint8_t data[19] = {0};
-
-    /* Header */
-    data[0] = 0x23;
-    data[1] = 0xCB;
-    data[2] = 0x26;
-    data[3] = 0x01;
-    data[4] = 0x00;
-
-    /* Byte 5: Power */
-    data[5] = state->power ? 0x20 : 0x00;
-
-    /* Byte 6: Mode
-     * 0x18=Auto, 0x08=Cool, 0x10=Dry, 0x20=Heat, 0x38=Fan
-     */
-    uint8_t mode_bits = 0x08;
-    switch (state->mode) {
-        case AC_MODE_AUTO: mode_bits = 0x18; break;
-        case AC_MODE_COOL: mode_bits = 0x08; break;
-        case AC_MODE_DRY:  mode_bits = 0x10; break;
-        case AC_MODE_HEAT: mode_bits = 0x20; break;
-        case AC_MODE_FAN:  mode_bits = 0x38; break;
-        default: mode_bits = 0x08; break;
-    }
-    data[6] = mode_bits;
-
-    /* Byte 7: Temperature (16-31°C, encoded as (31 - temp)) */
-    uint8_t temp = state->temperature;
-    if (temp < 16) temp = 16;
-    if (temp > 31) temp = 31;
-    data[7] = 31 - temp;
-
-    /* Byte 9: Fan Speed
-     * 0=Auto, 1=Low, 2=Medium, 3=High
-     */
-    uint8_t fan_bits = 0;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 0; break;
-        case AC_FAN_LOW:    fan_bits = 1; break;
-        case AC_FAN_MEDIUM: fan_bits = 2; break;
-        case AC_FAN_HIGH:   fan_bits = 3; break;
-        default: fan_bits = 0; break;
-    }
-    data[9] = fan_bits;
-
-    /* Byte 10: Swing */
-    data[10] = (state->swing != AC_SWING_OFF) ? 0x40 : 0x00;
-
-    /* Bytes 8, 11-17: Other fields */
-    data[8] = 0x00;
-    for (int i = 11; i < 18; i++) {
-        data[i] = 0x00;
-    }
-
-    /* Byte 18: Checksum (byte sum of bytes 0-17) */
-    data[18] = calculate_byte_sum(data, 18);
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_MITSUBISHI;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 19, code, 430, 1250, 430);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    ESP_LOGI(TAG, "Mitsubishi: Power=%s, Mode=%d, Temp=%d°C, Fan=%d",
-             state->power ? "ON" : "OFF", state->mode, state->temperature, state->fan_speed);
-
-    // Log hex bytes for verification
-    ESP_LOGI(TAG, "Mitsubishi Frame: %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X",
-             data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7], data[8],
-             data[9], data[10], data[11], data[12], data[13], data[14], data[15], data[16], data[17], data[18]);
-
-    return ESP_OK;
+    return ir_ac_frame_encode(&mitsubishi_map, state, code);
 }
 
-/* ============================================================================
- * MIDEA AC PROTOCOL ENCODER (48-bit)
- * ============================================================================ */
-
 esp_err_t ir_ac_encode_midea(const ac_state_t *state, ir_code_t *code)
 {
-    /*
-     * Midea AC Protocol (48 bits = 6 bytes)
-     * Used by: Midea, Electrolux, Qlima, and many brands
-     * Checksum: XOR of bytes
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Midea AC state");
-
-    uint8_t data[6] = {0};
-
-    /* Byte 0-1: Header */
-    data[0] = 0xB2;
-    data[1] = 0x4D;
-
-    /* Byte 2: Power and Mode
-     * Bit 5: Power
-     * Bits 0-2: Mode (0=Auto, 1=Cool, 2=Dry, 3=Heat, 4=Fan)
-     */
-    data[2] = 0;
-    if (state->power) {
-        data[2] |= 0x20;
-    }
-
-    uint8_t mode_bits = 1;
-    switch (state->mode) {
-        case AC_MODE_AUTO: mode_bits = 0; break;
-        case AC_MODE_COOL: mode_bits = 1; break;
-        case AC_MODE_DRY:  mode_bits = 2; break;
-        case AC_MODE_HEAT: mode_bits = 3; break;
-        case AC_MODE_FAN:  mode_bits = 4; break;
-        default: mode_bits = 1; break;
-    }
-    data[2] |= mode_bits;
-
-    /* Byte 3: Temperature (17-30°C, offset by 17) */
-    uint8_t temp = state->temperature;
-    if (temp < 17) temp = 17;
-    if (temp > 30) temp = 30;
-    data[3] = (temp - 17) & 0x0F;
-
-    /* Byte 3 upper nibble: Fan Speed (0=Auto, 1=Low, 2=Med, 3=High) */
-    uint8_t fan_bits = 0;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 0; break;
-        case AC_FAN_LOW:    fan_bits = 1; break;
-        case AC_FAN_MEDIUM: fan_bits = 2; break;
-        case AC_FAN_HIGH:   fan_bits = 3; break;
-        default: fan_bits = 0; break;
-    }
-    data[3] |= (fan_bits << 4);
-
-    /* Byte 4: Swing and extras */
-    data[4] = (state->swing != AC_SWING_OFF) ? 0x01 : 0x00;
-    if (state->turbo) data[4] |= 0x02;
-    if (state->sleep) data[4] |= 0x04;
-
-    /* Byte 5: Checksum (XOR of bytes 0-4) */
-    data[5] = 0;
-    for (int i = 0; i < 5; i++) {
-        data[5] ^= data[i];
-    }
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_MIDEA;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 6, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    ESP_LOGI(TAG, "Midea: Power=%s, Mode=%d, Temp=%d°C, Fan=%d",
-             state->power ? "ON" : "OFF", state->mode, state->temperature, state->fan_speed);
-
-    return ESP_OK;
+    return ir_ac_frame_encode(&midea_map, state, code);
 }
 
-/* ============================================================================
- * HAIER AC PROTOCOL ENCODER
- * ============================================================================ */
-
 esp_err_t ir_ac_encode_haier(const ac_state_t *state, ir_code_t *code)
 {
-    /*
-     * Haier AC Protocol (104 bits = 13 bytes)
-     * Checksum: Byte sum
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Haier AC state");
-
-    uint8_t data[13] = {0};
-
-    /* Header */
-    data[0] = 0xA5;
-    data[1] = 0xA5;
-
-    /* Byte 2: Power */
-    data[2] = state->power ? 0x01 : 0x00;
-
-    /* Byte 3: Mode (0=Auto, 1=Cool, 2=Dry, 3=Heat, 4=Fan) */
-    uint8_t mode_bits = 1;
-    switch (state->mode) {
-        case AC_MODE_AUTO: mode_bits = 0; break;
-        case AC_MODE_COOL: mode_bits = 1; break;
-        case AC_MODE_DRY:  mode_bits = 2; break;
-        case AC_MODE_HEAT: mode_bits = 3; break;
-        case AC_MODE_FAN:  mode_bits = 4; break;
-        default: mode_bits = 1; break;
-    }
-    data[3] = mode_bits;
-
-    /* Byte 4: Temperature (16-30°C, offset by 16) */
-    uint8_t temp = state->temperature;
-    if (temp < 16) temp = 16;
-    if (temp > 30) temp = 30;
-    data[4] = temp - 16;
-
-    /* Byte 5: Fan Speed (0=Auto, 1=Low, 2=Med, 3=High) */
-    uint8_t fan_bits = 0;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 0; break;
-        case AC_FAN_LOW:    fan_bits = 1; break;
-        case AC_FAN_MEDIUM: fan_bits = 2; break;
-        case AC_FAN_HIGH:   fan_bits = 3; break;
-        default: fan_bits = 0; break;
-    }
-    data[5] = fan_bits;
-
-    /* Byte 6: Swing */
-    data[6] = (state->swing != AC_SWING_OFF) ? 0x01 : 0x00;
-
-    /* Bytes 7-11: Other fields */
-    for (int i = 7; i < 12; i++) {
-        data[i] = 0x00;
-    }
-
-    /* Byte 12: Checksum (byte sum of bytes 0-11) */
-    data[12] = calculate_byte_sum(data, 12);
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_HAIER;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 13, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    ESP_LOGI(TAG, "Haier: Power=%s, Mode=%d, Temp=%d°C, Fan=%d",
-             state->power ? "ON" : "OFF", state->mode, state->temperature, state->fan_speed);
-
-    return ESP_OK;
+    return ir_ac_frame_encode(&haier_map, state, code);
 }
 
-/* ============================================================================
- * SAMSUNG48 AC PROTOCOL ENCODER
- * ============================================================================ */
-
 esp_err_t ir_ac_encode_samsung48(const ac_state_t *state, ir_code_t *code)
 {
-    /*
-     * Samsung48 AC Protocol (48 bits = 6 bytes)
-     * Checksum: XOR
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Samsung48 AC state");
-
-    uint8_t data[6] = {0};
-
-    /* Header */
-    data[0] = 0x04;
-    data[1] = 0x70;
-
-    /* Byte 2: Mode and Power
-     * Bits 0-2: Mode, Bit 3: Power
-     */
-    uint8_t mode_bits = 1;
-    switch (state->mode) {
-        case AC_MODE_AUTO: mode_bits = 0; break;
-        case AC_MODE_COOL: mode_bits = 1; break;
-        case AC_MODE_DRY:  mode_bits = 2; break;
-        case AC_MODE_FAN:  mode_bits = 3; break;
-        case AC_MODE_HEAT: mode_bits = 4; break;
-        default: mode_bits = 1; break;
-    }
-    data[2] = mode_bits;
-    if (state->power) {
-        data[2] |= 0x08;
-    }
-
-    /* Byte 3: Temperature (16-30°C, offset by 16) */
-    uint8_t temp = state->temperature;
-    if (temp < 16) temp = 16;
-    if (temp > 30) temp = 30;
-    data[3] = temp - 16;
-
-    /* Byte 4: Fan Speed */
-    uint8_t fan_bits = 0;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 0; break;
-        case AC_FAN_LOW:    fan_bits = 1; break;
-        case AC_FAN_MEDIUM: fan_bits = 2; break;
-        case AC_FAN_HIGH:   fan_bits = 3; break;
-        default: fan_bits = 0; break;
-    }
-    data[4] = fan_bits;
-
-    /* Byte 5: Checksum (XOR of bytes 0-4) */
-    data[5] = 0;
-    for (int i = 0; i < 5; i++) {
-        data[5] ^= data[i];
-    }
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_SAMSUNG48;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 6, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    ESP_LOGI(TAG, "Samsung48: Power=%s, Mode=%d, Temp=%d°C",
-             state->power ? "ON" : "OFF", state->mode, state->temperature);
-
-    return ESP_OK;
+    return ir_ac_frame_encode(&samsung48_map, state, code);
 }
 
-/* ============================================================================
- * PANASONIC/KASEIKYO AC PROTOCOL ENCODER
- * ============================================================================ */
-
 esp_err_t ir_ac_encode_panasonic(const ac_state_t *state, ir_code_t *code)
 {
-    /*
-     * Panasonic/Kaseikyo AC Protocol (48 bits = 6 bytes)
-     * Checksum: XOR
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Panasonic AC state");
-
-    uint8_t data[6] = {0};
-
-    /* Header */
-    data[0] = 0x02;
-    data[1] = 0x20;
-
-    /* Byte 2: Power and Mode */
-    data[2] = state->power ? 0x01 : 0x00;
-
-    uint8_t mode_bits = 2;
-    switch (state->mode) {
-        case AC_MODE_AUTO: mode_bits = 0; break;
-        case AC_MODE_DRY:  mode_bits = 1; break;
-        case AC_MODE_COOL: mode_bits = 2; break;
-        case AC_MODE_HEAT: mode_bits = 3; break;
-        case AC_MODE_FAN:  mode_bits = 4; break;
-        default: mode_bits = 2; break;
-    }
-    data[2] |= (mode_bits << 4);
-
-    /* Byte 3: Temperature (16-30°C, offset by 16) */
-    uint8_t temp = state->temperature;
-    if (temp < 16) temp = 16;
-    if (temp > 30) temp = 30;
-    data[3] = temp - 16;
-
-    /* Byte 4: Fan Speed */
-    uint8_t fan_bits = 0;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 0; break;
-        case AC_FAN_LOW:    fan_bits = 1; break;
-        case AC_FAN_MEDIUM: fan_bits = 2; break;
-        case AC_FAN_HIGH:   fan_bits = 3; break;
-        default: fan_bits = 0; break;
-    }
-    data[4] = fan_bits;
-
-    /* Byte 5: Checksum (XOR) */
-    data[5] = 0;
-    for (int i = 0; i < 5; i++) {
-        data[5] ^= data[i];
-    }
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_PANASONIC;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 6, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    ESP_LOGI(TAG, "Panasonic: Power=%s, Mode=%d, Temp=%d°C",
-             state->power ? "ON" : "OFF", state->mode, state->temperature);
-
-    return ESP_OK;
+    return ir_ac_frame_encode(&panasonic_map, state, code);
 }
 
-/* ============================================================================
- * FUJITSU AC PROTOCOL ENCODER
- * ============================================================================ */
-
 esp_err_t ir_ac_encode_fujitsu(const ac_state_t *state, ir_code_t *code)
 {
-    /*
-     * Fujitsu AC Protocol (Variable length, typically 128 bits = 16 bytes)
-     * Checksum: Byte sum
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding Fujitsu AC state");
-
-    uint8_t data[16] = {0};
-
-    /* Header */
-    data[0] = 0x14;
-    data[1] = 0x63;
-    data[2] = 0x00;
-    data[3] = 0x10;
-    data[4] = 0x10;
-
-    /* Byte 5: Power */
-    data[5] = state->power ? 0x02 : 0x00;
-
-    /* Byte 6: Mode */
-    uint8_t mode_bits = 1;
-    switch (state->mode) {
-        case AC_MODE_AUTO: mode_bits = 0; break;
-        case AC_MODE_COOL: mode_bits = 1; break;
-        case AC_MODE_DRY:  mode_bits = 2; break;
-        case AC_MODE_FAN:  mode_bits = 3; break;
-        case AC_MODE_HEAT: mode_bits = 4; break;
-        default: mode_bits = 1; break;
-    }
-    data[6] = mode_bits;
-
-    /* Byte 7: Temperature (16-30°C, offset by 16) */
-    uint8_t temp = state->temperature;
-    if (temp < 16) temp = 16;
-    if (temp > 30) temp = 30;
-    data[7] = temp - 16;
-
-    /* Byte 8: Fan Speed */
-    uint8_t fan_bits = 0;
-    switch (state->fan_speed) {
-        case AC_FAN_AUTO:   fan_bits = 0; break;
-        case AC_FAN_LOW:    fan_bits = 1; break;
-        case AC_FAN_MEDIUM: fan_bits = 2; break;
-        case AC_FAN_HIGH:   fan_bits = 3; break;
-        default: fan_bits = 0; break;
-    }
-    data[8] = fan_bits;
-
-    /* Byte 9: Swing */
-    data[9] = (state->swing != AC_SWING_OFF) ? 0x01 : 0x00;
-
-    /* Bytes 10-14: Other fields */
-    for (int i = 10; i < 15; i++) {
-        data[i] = 0x00;
-    }
-
-    /* Byte 15: Checksum */
-    data[15] = calculate_byte_sum(data, 15);
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_FUJITSU;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-
-    /* Encode to RMT symbols */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 16, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    ESP_LOGI(TAG, "Fujitsu: Power=%s, Mode=%d, Temp=%d°C",
-             state->power ? "ON" : "OFF", state->mode, state->temperature);
-
-    return ESP_OK;
+    return ir_ac_frame_encode(&fujitsu_map, state, code);
 }
 
-/* ============================================================================
- * LG2 AC PROTOCOL ENCODER
- * ============================================================================ */
-
 esp_err_t ir_ac_encode_lg2(const ac_state_t *state, ir_code_t *code)
 {
-    /*
-     * LG2 AC Protocol (28 bits, 4 bytes but only 28 bits used)
-     * Checksum: 4-bit sum
-     * Carrier: 38kHz
-     */
-
-    if (!state || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Encoding LG2 AC state");
-
-    /* LG2 uses 28-bit encoding, we'll use 4 bytes */
-    uint32_t lg_code = 0;
-
-    /* Build 28-bit code */
-    /* Bits 0-3: Header (0x8) */
-    lg_code |= 0x8;
-
-    /* Bits 4-7: Mode (0=Cool, 1=Dry, 2=Fan, 4=Auto, 5=Heat) */
-    uint8_t mode_bits = 0;
-    switch (state->mode) {
-        case AC_MODE_COOL: mode_bits = 0; break;
-        case AC_MODE_DRY:  mode_bits = 1; break;
-        case AC_MODE_FAN:  mode_bits = 2; break;
-        case AC_MODE_AUTO: mode_bits = 4; break;
-        case AC_MODE_HEAT: mode_bits = 5; break;
-        default: mode_bits = 0; break;
-    }
-    lg_code |= (mode_bits << 4);
-
-    /* Bits 8-11: Temperature (18-30°C, encoded as (temp - 15)) */
-    uint8_t temp = state->temperature;
-    if (temp < 18) temp = 18;
-    if (temp > 30) temp = 30;
-    lg_code |= ((temp - 15) << 8);
-
-    /* Bits 12-13: Fan Speed (0=Low, 1=Med, 2=High, 3=Auto) */
-    uint8_t fan_bits = 3;
-    switch (state->fan_speed) {
-        case AC_FAN_LOW:    fan_bits = 0; break;
-        case AC_FAN_MEDIUM: fan_bits = 1; break;
-        case AC_FAN_HIGH:   fan_bits = 2; break;
-        case AC_FAN_AUTO:   fan_bits = 3; break;
-        default: fan_bits = 3; break;
-    }
-    lg_code |= (fan_bits << 12);
-
-    /* Bit 14: Power */
-    if (state->power) {
-        lg_code |= (1 << 14);
-    }
-
-    /* Bits 15-23: Other features */
-    lg_code |= (0x00 << 15);
-
-    /* Bits 24-27: Checksum (4-bit sum of nibbles) */
-    uint8_t checksum = 0;
-    for (int i = 0; i < 24; i += 4) {
-        checksum += ((lg_code >> i) & 0xF);
-    }
-    lg_code |= ((checksum & 0xF) << 24);
-
-    /* Convert to bytes */
-    uint8_t data[4];
-    data[0] = (lg_code >> 0) & 0xFF;
-    data[1] = (lg_code >> 8) & 0xFF;
-    data[2] = (lg_code >> 16) & 0xFF;
-    data[3] = (lg_code >> 24) & 0xFF;
-
-    /* Populate code structure */
-    memset(code, 0, sizeof(ir_code_t));
-    code->protocol = IR_PROTOCOL_LG2;
-    code->carrier_freq_hz = 38000;
-    code->duty_cycle_percent = 33;
-    code->bits = 28; // Only 28 bits
-
-    /* Encode to RMT symbols (only first 28 bits) */
-    esp_err_t err = encode_bytes_to_code_lsb(data, 4, code, 560, 1690, 560);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    /* Adjust raw_length to 28 bits (56 symbols: 28 × 2) */
-    code->raw_length = 56;
-
-    ESP_LOGI(TAG, "LG2: Power=%s, Mode=%d, Temp=%d°C",
-             state->power ? "ON" : "OFF", state->mode, state->temperature);
-
-    return ESP_OK;
+    return ir_ac_frame_encode(&lg2_map, state, code);
 }
@@ -0,0 +1,468 @@
+/**
+ * @file ir_ac_frame.c
+ * @brief AC Frame Field Maps and Template Cache
+ *
+ * MIT License
+ */
+
+#include "ir_ac_frame.h"
+#include "ir_protocols.h"
+#include "ir_checksum.h"
+#include "driver/rmt_tx.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ir_ac_frame";
+
+/* ============================================================================
+ * FIELD ENGINE
+ * ============================================================================ */
+
+/**
+ * @brief Encoded value of one field for a state
+ */
+static uint8_t field_value(const ac_field_t *field, const ac_state_t *state)
+{
+    int index;
+
+    switch (field->id) {
+        case AC_FIELD_POWER: index = state->power; break;
+        case AC_FIELD_MODE:  index = state->mode; break;
+        case AC_FIELD_FAN:   index = state->fan_speed; break;
+        case AC_FIELD_SWING: index = state->swing; break;
+        case AC_FIELD_TURBO: index = state->turbo; break;
+        case AC_FIELD_QUIET: index = state->quiet; break;
+        case AC_FIELD_ECONO: index = state->econo; break;
+        case AC_FIELD_SLEEP: index = state->sleep; break;
+        case AC_FIELD_TEMP: {
+            uint8_t temp = state->temperature;
+            if (temp < AC_TEMP_MIN) temp = AC_TEMP_MIN;
+            if (temp > AC_TEMP_MAX) temp = AC_TEMP_MAX;
+            index = temp - AC_TEMP_MIN;
+            break;
+        }
+        default:
+            return 0;
+    }
+
+    if (field->values == NULL) {
+        return (uint8_t)index;
+    }
+    if (index < 0 || index >= field->num_values) {
+        index = 0;
+    }
+    return field->values[index];
+}
+
+static inline uint8_t field_mask(const ac_field_t *field)
+{
+    return (uint8_t)(((1u << field->width) - 1) << field->shift);
+}
+
+/**
+ * @brief Contribution of one byte to the checksum accumulator
+ */
+static inline uint16_t checksum_term(uint8_t type, uint8_t byte)
+{
+    return type == AC_CHECKSUM_NIBBLE_SUM ? (uint16_t)((byte & 0x0F) + (byte >> 4)) : byte;
+}
+
+/**
+ * @brief Checksum accumulator over the covered bytes
+ *
+ * Byte and nibble sums are only kept modulo 256 and 16; the incremental
+ * updates in cache_patch() wrap the same way.
+ */
+static uint16_t checksum_accumulate(const ac_frame_map_t *map, const uint8_t *bytes)
+{
+    const uint8_t *start = &bytes[map->checksum_start];
+    size_t len = map->checksum_end - map->checksum_start;
+
+    switch (map->checksum) {
+        case AC_CHECKSUM_BYTE_SUM:   return ir_checksum_byte_sum(start, len);
+        case AC_CHECKSUM_XOR:        return ir_checksum_xor(start, len);
+        case AC_CHECKSUM_NIBBLE_SUM: return ir_checksum_nibble_sum(start, len);
+        default:                     return 0;
+    }
+}
+
+static inline uint8_t checksum_finish(uint8_t type, uint16_t acc)
+{
+    return type == AC_CHECKSUM_NIBBLE_SUM ? (uint8_t)(acc & 0x0F) : (uint8_t)acc;
+}
+
+/**
+ * @brief Fill a byte image from the template and every field
+ *
+ * @return Checksum accumulator over the covered bytes
+ */
+static uint16_t frame_build_bytes(const ac_frame_map_t *map, const ac_state_t *state, uint8_t *bytes)
+{
+    memcpy(bytes, map->template_bytes, map->num_bytes);
+
+    for (uint8_t i = 0; i < map->num_fields; i++) {
+        const ac_field_t *field = &map->fields[i];
+        uint8_t mask = field_mask(field);
+        bytes[field->byte] = (bytes[field->byte] & ~mask) |
+                             ((uint8_t)(field_value(field, state) << field->shift) & mask);
+    }
+
+    uint16_t acc = 0;
+    if (map->checksum != AC_CHECKSUM_NONE) {
+        acc = checksum_accumulate(map, bytes);
+        bytes[map->checksum_byte] = checksum_finish(map->checksum, acc);
+    }
+    return acc;
+}
+
+esp_err_t ir_ac_frame_encode(const ac_frame_map_t *map, const ac_state_t *state, ir_code_t *code)
+{
+    if (!map || !state || !code) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t bytes[AC_FRAME_MAX_BYTES];
+    frame_build_bytes(map, state, bytes);
+
+    memset(code, 0, sizeof(ir_code_t));
+    code->protocol = map->protocol;
+    code->carrier_freq_hz = map->carrier_hz;
+    code->duty_cycle_percent = 33;
+    code->bits = map->bits ? map->bits : map->num_bytes * 8;
+
+    esp_err_t err = ir_code_set_payload(code, bytes, map->num_bytes);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to store %u-byte payload: %s", map->num_bytes, esp_err_to_name(err));
+        return err;
+    }
+
+    /* Out-of-line payloads leave data alone; keep the 32-bit view in sync */
+    code->data = (uint32_t)bytes[0] |
+                 ((uint32_t)bytes[1] << 8) |
+                 ((uint32_t)bytes[2] << 16) |
+                 ((uint32_t)bytes[3] << 24);
+
+    ESP_LOGI(TAG, "%s: Power=%s, Mode=%d, Temp=%d°C, Fan=%d", map->name,
+             state->power ? "ON" : "OFF", state->mode, state->temperature, state->fan_speed);
+    return ESP_OK;
+}
+
+/**
+ * @brief State index for an encoded field value
+ *
+ * @return Index into the value table, or -1 if no state encodes to @p raw
+ */
+static int field_index(const ac_field_t *field, uint8_t raw)
+{
+    if (field->values == NULL) {
+        return raw ? 1 : 0;
+    }
+
+    int found = -1;
+    uint8_t first = (field->id == AC_FIELD_MODE) ? AC_MODE_AUTO : 0;
+    for (uint8_t i = first; i < field->num_values; i++) {
+        if (field->values[i] != raw) {
+            continue;
+        }
+        found = i;
+        if (field->id != AC_FIELD_TEMP) {
+            break;
+        }
+    }
+    return found;
+}
+
+esp_err_t ir_ac_frame_decode(const ac_frame_map_t *map, const uint8_t *bytes, size_t len,
+                             ac_state_t *state)
+{
+    if (!map || !bytes || !state) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* A capture holding only the state frame gets the constant leader
+     * frames back from the template */
+    uint8_t image[AC_FRAME_MAX_BYTES];
+    const uint8_t *frame = bytes + (len - map->num_bytes);
+    if (len < map->num_bytes) {
+        if (map->num_frames < 2 || len < map->frame_bytes[map->num_frames - 1]) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        size_t lead = map->num_bytes - map->frame_bytes[map->num_frames - 1];
+        memcpy(image, map->template_bytes, lead);
+        memcpy(image + lead, bytes + len - map->frame_bytes[map->num_frames - 1],
+               map->frame_bytes[map->num_frames - 1]);
+        frame = image;
+    }
+
+    if (map->checksum != AC_CHECKSUM_NONE) {
+        uint8_t sum = checksum_finish(map->checksum, checksum_accumulate(map, frame));
+        if (frame[map->checksum_byte] != sum) {
+            ESP_LOGD(TAG, "%s checksum mismatch (0x%02X != 0x%02X)", map->name,
+                     frame[map->checksum_byte], sum);
+            return ESP_ERR_INVALID_CRC;
+        }
+    }
+
+    for (uint8_t i = 0; i < map->num_fields; i++) {
+        const ac_field_t *field = &map->fields[i];
+        uint8_t raw = (frame[field->byte] & field_mask(field)) >> field->shift;
+        int index = field_index(field, raw);
+        if (index < 0) {
+            ESP_LOGD(TAG, "%s field %u: unknown value 0x%02X", map->name, field->id, raw);
+            continue;
+        }
+
+        switch (field->id) {
+            case AC_FIELD_POWER: state->power = index; break;
+            case AC_FIELD_MODE:  state->mode = (ac_mode_t)index; break;
+            case AC_FIELD_TEMP:  state->temperature = AC_TEMP_MIN + index; break;
+            case AC_FIELD_FAN:   state->fan_speed = (ac_fan_speed_t)index; break;
+            case AC_FIELD_SWING: state->swing = (ac_swing_t)index; break;
+            case AC_FIELD_TURBO: state->turbo = index; break;
+            case AC_FIELD_QUIET: state->quiet = index; break;
+            case AC_FIELD_ECONO: state->econo = index; break;
+            case AC_FIELD_SLEEP: state->sleep = index; break;
+            default: break;
+        }
+    }
+    return ESP_OK;
+}
+
+void ir_ac_frame_normalize(const ac_frame_map_t *map, ac_state_t *state)
+{
+    uint8_t bytes[AC_FRAME_MAX_BYTES];
+    frame_build_bytes(map, state, bytes);
+    ir_ac_frame_decode(map, bytes, map->num_bytes, state);
+}
+
+/* ============================================================================
+ * TEMPLATE CACHE
+ * ============================================================================ */
+
+/* Data bits of the largest image plus header and stop bit per frame */
+#define AC_FRAME_MAX_SYMBOLS    (AC_FRAME_MAX_BYTES * 8 + 2 * AC_FRAME_MAX_FRAMES)
+
+struct ac_frame_cache {
+    const ac_frame_map_t *map;
+    const ir_protocol_constants_t *proto;
+    ir_code_t header;               // Protocol and carrier for the transmitter, no payload
+    uint16_t bits;
+    uint16_t checksum_acc;
+    uint8_t bytes[AC_FRAME_MAX_BYTES];
+    uint8_t num_frames;
+    uint8_t frame_first_byte[AC_FRAME_MAX_FRAMES + 1];
+    size_t frame_first_symbol[AC_FRAME_MAX_FRAMES];
+    size_t num_symbols;
+    rmt_symbol_word_t symbols[AC_FRAME_MAX_SYMBOLS];
+};
+
+/**
+ * @brief Rewrite the symbols of one image byte
+ *
+ * Same layout as the table-driven builder in ir_control.c: per frame an
+ * optional header, one pulse distance symbol per bit LSB first and a stop
+ * bit whose space is the inter-frame gap.
+ */
+static void cache_write_byte_symbols(ac_frame_cache_t *cache, uint8_t index)
+{
+    const ir_protocol_constants_t *proto = cache->proto;
+    uint8_t byte = cache->bytes[index];
+
+    uint8_t f = 0;
+    while (index >= cache->frame_first_byte[f + 1]) {
+        f++;
+    }
+    size_t base = cache->frame_first_symbol[f] +
+                  (size_t)(index - cache->frame_first_byte[f]) * 8;
+
+    for (uint8_t k = 0; k < 8; k++) {
+        if (index * 8 + k >= cache->bits) {
+            break;
+        }
+        rmt_symbol_word_t *sym = &cache->symbols[base + k];
+        sym->level0 = 1;
+        sym->duration0 = proto->bit_mark_us;
+        sym->level1 = 0;
+        sym->duration1 = ((byte >> k) & 1) ? proto->one_space_us : proto->zero_space_us;
+    }
+}
+
+/**
+ * @brief Check that every field lies inside the checksum range
+ *
+ * cache_patch() adjusts the checksum by the delta of every changed field
+ * byte, which is only right for bytes the checksum covers. A field on the
+ * checksum byte itself would be overwritten by the sum.
+ */
+static bool map_fields_in_checksum(const ac_frame_map_t *map)
+{
+    if (map->checksum == AC_CHECKSUM_NONE) {
+        return true;
+    }
+    for (uint8_t i = 0; i < map->num_fields; i++) {
+        uint8_t byte = map->fields[i].byte;
+        if (byte < map->checksum_start || byte >= map->checksum_end || byte == map->checksum_byte) {
+            ESP_LOGE(TAG, "%s field %u (byte %u) is outside checksum bytes %u-%u", map->name,
+                     map->fields[i].id, byte, map->checksum_start, map->checksum_end - 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t cache_build(ac_frame_cache_t *cache, const ac_frame_map_t *map, const ac_state_t *state)
+{
+    if (!map_fields_in_checksum(map)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    const ir_protocol_constants_t *proto = ir_get_protocol_constants(map->protocol);
+    if (proto == NULL || proto->bit_mark_us == 0 ||
+        (proto->flags & (PROTOCOL_IS_MSB_FIRST | PROTOCOL_IS_PULSE_WIDTH |
+                         PROTOCOL_IS_BIPHASE | PROTOCOL_NO_STOP_BIT))) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    cache->map = NULL;
+    cache->proto = proto;
+    cache->bits = map->bits ? map->bits : map->num_bytes * 8;
+    cache->checksum_acc = frame_build_bytes(map, state, cache->bytes);
+
+    memset(&cache->header, 0, sizeof(cache->header));
+    cache->header.protocol = map->protocol;
+    cache->header.bits = cache->bits;
+    cache->header.carrier_freq_hz = map->carrier_hz;
+    cache->header.duty_cycle_percent = 33;
+
+    cache->num_frames = map->num_frames > 1 ? map->num_frames : 1;
+    cache->frame_first_byte[0] = 0;
+    for (uint8_t f = 0; f < cache->num_frames; f++) {
+        uint8_t len = map->num_frames > 1 ? map->frame_bytes[f] : map->num_bytes;
+        cache->frame_first_byte[f + 1] = cache->frame_first_byte[f] + len;
+    }
+
+    size_t count = 0;
+    for (uint8_t f = 0; f < cache->num_frames; f++) {
+        bool last = (f + 1 == cache->num_frames);
+        uint16_t frame_bits = last ? cache->bits - cache->frame_first_byte[f] * 8
+                                   : (cache->frame_first_byte[f + 1] - cache->frame_first_byte[f]) * 8;
+
+        if (proto->header_mark_us) {
+            cache->symbols[count++] = (rmt_symbol_word_t) {
+                .level0 = 1, .duration0 = proto->header_mark_us,
+                .level1 = 0, .duration1 = proto->header_space_us,
+            };
+        }
+        cache->frame_first_symbol[f] = count;
+        count += frame_bits;
+
+        cache->symbols[count++] = (rmt_symbol_word_t) {
+            .level0 = 1, .duration0 = proto->bit_mark_us,
+            .level1 = 0, .duration1 = last ? proto->zero_space_us : map->frame_gap_us,
+        };
+    }
+    cache->num_symbols = count;
+
+    for (uint8_t i = 0; i < map->num_bytes; i++) {
+        cache_write_byte_symbols(cache, i);
+    }
+    cache->map = map;
+
+    ESP_LOGD(TAG, "Built %s template (%u bytes, %u symbols)", map->name,
+             map->num_bytes, (unsigned)count);
+    return ESP_OK;
+}
+
+/**
+ * @brief Patch the cached image for a new state
+ *
+ * @return Number of bytes rewritten (checksum included)
+ */
+static unsigned cache_patch(ac_frame_cache_t *cache, const ac_state_t *state)
+{
+    const ac_frame_map_t *map = cache->map;
+    uint64_t dirty = 0;
+
+    for (uint8_t i = 0; i < map->num_fields; i++) {
+        const ac_field_t *field = &map->fields[i];
+        uint8_t mask = field_mask(field);
+        uint8_t old_byte = cache->bytes[field->byte];
+        uint8_t new_byte = (old_byte & ~mask) |
+                           ((uint8_t)(field_value(field, state) << field->shift) & mask);
+        if (new_byte == old_byte) {
+            continue;
+        }
+
+        if (map->checksum == AC_CHECKSUM_XOR) {
+            cache->checksum_acc ^= old_byte ^ new_byte;
+        } else if (map->checksum != AC_CHECKSUM_NONE) {
+            cache->checksum_acc += checksum_term(map->checksum, new_byte) -
+                                        checksum_term(map->checksum, old_byte);
+        }
+        cache->bytes[field->byte] = new_byte;
+        dirty |= 1ULL << field->byte;
+    }
+
+    if (dirty && map->checksum != AC_CHECKSUM_NONE) {
+        uint8_t sum = checksum_finish(map->checksum, cache->checksum_acc);
+        if (cache->bytes[map->checksum_byte] != sum) {
+            cache->bytes[map->checksum_byte] = sum;
+            dirty |= 1ULL << map->checksum_byte;
+        }
+    }
+
+    unsigned patched = 0;
+    for (uint8_t i = 0; dirty; i++, dirty >>= 1) {
+        if (dirty & 1) {
+            cache_write_byte_symbols(cache, i);
+            patched++;
+        }
+    }
+    return patched;
+}
+
+esp_err_t ir_ac_frame_transmit(ac_frame_cache_t *cache, uint8_t emitter, const ac_state_t *state)
+{
+    if (!cache || !state) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const ac_frame_map_t *map = ir_ac_frame_get_map(state->protocol);
+    if (map == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (cache->map != map) {
+        esp_err_t err = cache_build(cache, map, state);
+        if (err != ESP_OK) {
+            return err;
+        }
+    } else {
+        unsigned patched = cache_patch(cache, state);
+        ESP_LOGD(TAG, "Patched %u of %u %s bytes", patched, map->num_bytes, map->name);
+    }
+
+    return ir_transmit_symbols_on(emitter, &cache->header, cache->symbols, cache->num_symbols);
+}
+
+ac_frame_cache_t *ir_ac_frame_cache_create(void)
+{
+    ac_frame_cache_t *cache = calloc(1, sizeof(ac_frame_cache_t));
+    if (cache == NULL) {
+        ESP_LOGE(TAG, "No memory for a frame cache (%u bytes)", (unsigned)sizeof(ac_frame_cache_t));
+    }
+    return cache;
+}
+
+void ir_ac_frame_cache_delete(ac_frame_cache_t *cache)
+{
+    free(cache);
+}
+
+void ir_ac_frame_cache_reset(ac_frame_cache_t *cache)
+{
+    if (cache) {
+        cache->map = NULL;
+    }
+}
@@ -0,0 +1,199 @@
+/**
+ * @file ir_ac_frame.h
+ * @brief AC Frame Field Maps and Template Cache
+ *
+ * Every supported AC protocol is described as data instead of code: a
+ * template byte image, a field map saying where each state field lives
+ * (byte, bit offset, width, value table), the checksum that covers the
+ * state frame, the carrier and the frame structure. The maps are plain
+ * const initializers (ir_ac_encoders.c), so the description compiles
+ * straight into flash tables with no generator step. One engine runs
+ * them both ways: ac_state_t to bytes for transmission and bytes back
+ * to ac_state_t for learning. Adding a brand means adding a map.
+ *
+ * A template cache (one per AC unit) keeps the last transmitted byte
+ * image and its RMT symbol buffer. On the next state change only fields
+ * whose encoded value differs are rewritten, the checksum is adjusted by
+ * the delta of the changed bytes and only the symbols of those bytes are
+ * patched, so a temperature slider step costs a few dozen stores instead
+ * of a full encode, checksum pass, malloc and symbol build. Maps whose
+ * fields stray outside the checksum range are not cached.
+ *
+ * MIT License
+ */
+
+#ifndef IR_AC_FRAME_H
+#define IR_AC_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "ir_control.h"
+#include "ir_ac_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest AC frame image (Hitachi 264-bit) */
+#define AC_FRAME_MAX_BYTES      33
+
+/* Frames per transmission (Daikin sends a leader frame before the state) */
+#define AC_FRAME_MAX_FRAMES     2
+
+/* Temperature value tables cover AC_TEMP_MIN..AC_TEMP_MAX */
+#define AC_FRAME_TEMP_STEPS     (AC_TEMP_MAX - AC_TEMP_MIN + 1)
+
+/**
+ * @brief State field encoded by a map entry
+ */
+typedef enum {
+    AC_FIELD_POWER = 0,
+    AC_FIELD_MODE,
+    AC_FIELD_TEMP,
+    AC_FIELD_FAN,
+    AC_FIELD_SWING,
+    AC_FIELD_TURBO,
+    AC_FIELD_QUIET,
+    AC_FIELD_ECONO,
+    AC_FIELD_SLEEP,
+    AC_FIELD_MAX
+} ac_field_id_t;
+
+/**
+ * @brief Frame checksum types
+ */
+typedef enum {
+    AC_CHECKSUM_NONE = 0,
+    AC_CHECKSUM_BYTE_SUM,       // Low byte of the sum of bytes
+    AC_CHECKSUM_XOR,            // XOR of bytes
+    AC_CHECKSUM_NIBBLE_SUM,     // Low nibble of the sum of all nibbles
+} ac_checksum_type_t;
+
+/**
+ * @brief Location and encoding of one state field
+ *
+ * The value table is indexed by the state value: the enum for mode, fan
+ * and swing, temperature - AC_TEMP_MIN for temperature. Boolean fields
+ * leave it NULL and store 0/1.
+ *
+ * Tables may map several states to one value (unsupported fan speeds to
+ * Auto, temperatures below the protocol minimum to the minimum). Decoding
+ * picks the first matching state, except temperature which picks the last
+ * (the in-range one) and mode which never decodes to AC_MODE_OFF.
+ */
+typedef struct {
+    uint8_t id;                     // ac_field_id_t
+    uint8_t byte;                   // Byte index in the frame
+    uint8_t shift;                  // Bit offset in that byte
+    uint8_t width;                  // Bits (1-8)
+    const uint8_t *values;          // Value table, NULL for booleans
+    uint8_t num_values;
+} ac_field_t;
+
+/**
+ * @brief Complete description of an AC protocol frame
+ */
+typedef struct {
+    ir_protocol_t protocol;
+    const char *name;
+    uint32_t carrier_hz;
+    uint8_t num_bytes;              // Whole image, all frames
+    uint16_t bits;                  // Bits sent (0 = num_bytes * 8)
+    uint8_t num_frames;             // 0 or 1 = single frame
+    uint8_t frame_bytes[AC_FRAME_MAX_FRAMES];   // Bytes per frame when multi-frame
+    uint16_t frame_gap_us;          // Space between frames
+    const uint8_t *template_bytes;  // Constant bytes, fields start at 0
+    const ac_field_t *fields;
+    uint8_t num_fields;
+    uint8_t checksum;               // ac_checksum_type_t
+    uint8_t checksum_start;         // First byte covered
+    uint8_t checksum_end;           // One past the last byte covered
+    uint8_t checksum_byte;          // Where the checksum is stored
+} ac_frame_map_t;
+
+/**
+ * @brief Get the frame map of an AC protocol
+ *
+ * @return Map, or NULL if @p protocol is not an AC protocol
+ */
+const ac_frame_map_t *ir_ac_frame_get_map(ir_protocol_t protocol);
+
+/**
+ * @brief Encode an AC state into a code using a frame map
+ *
+ * @param map Protocol frame map
+ * @param state AC state
+ * @param code Output code (payload bytes; release with ir_code_free())
+ * @return ESP_OK, ESP_ERR_NO_MEM if the payload cannot be stored
+ */
+esp_err_t ir_ac_frame_encode(const ac_frame_map_t *map, const ac_state_t *state, ir_code_t *code);
+
+/**
+ * @brief Decode frame bytes into an AC state using a frame map
+ *
+ * Fields the map does not carry keep their value in @p state, so callers
+ * start from ir_ac_get_default_state(). Captures that include more bytes
+ * than the map (leading frames) are matched on their last bytes.
+ *
+ * @param map Protocol frame map
+ * @param bytes Frame bytes as decoded
+ * @param len Number of bytes
+ * @param state In/out AC state
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if @p len is too short,
+ *         ESP_ERR_INVALID_CRC if the checksum does not match
+ */
+esp_err_t ir_ac_frame_decode(const ac_frame_map_t *map, const uint8_t *bytes, size_t len,
+                             ac_state_t *state);
+
+/**
+ * @brief Rewrite the fields a map carries to the values its frame sends
+ *
+ * @param map Protocol frame map
+ * @param state In/out AC state
+ */
+void ir_ac_frame_normalize(const ac_frame_map_t *map, ac_state_t *state);
+
+/**
+ * @brief Template cache of one AC unit (byte image and symbol buffer)
+ */
+typedef struct ac_frame_cache ac_frame_cache_t;
+
+/**
+ * @brief Allocate an empty template cache
+ *
+ * @return Cache, or NULL if out of memory
+ */
+ac_frame_cache_t *ir_ac_frame_cache_create(void);
+
+/**
+ * @brief Free a template cache (NULL is ignored)
+ */
+void ir_ac_frame_cache_delete(ac_frame_cache_t *cache);
+
+/**
+ * @brief Transmit an AC state through a template cache
+ *
+ * The first call for a protocol builds the byte image and symbol buffer;
+ * later calls patch only what changed. The caller serializes use of each
+ * cache and of the emitter.
+ *
+ * @param cache Cache of the unit being transmitted
+ * @param emitter IR emitter the unit is bound to
+ * @param state AC state (protocol selects the map)
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if the protocol has no map, no
+ *         pulse distance timing or a field outside its checksum range,
+ *         or the ir_transmit_symbols_on() error
+ */
+esp_err_t ir_ac_frame_transmit(ac_frame_cache_t *cache, uint8_t emitter, const ac_state_t *state);
+
+/**
+ * @brief Drop the cached image so the next transmission rebuilds it
+ */
+void ir_ac_frame_cache_reset(ac_frame_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_AC_FRAME_H
@@ -0,0 +1,302 @@
+/**
+ * @file ir_ac_identify.c
+ * @brief AC Protocol Identification by Fingerprint
+ *
+ * A capture is reduced to a fingerprint (timing, frame structure and the
+ * state frame bytes) and scored against every AC protocol. The signature
+ * of a protocol is its timing constants from ir_protocols.c plus its frame
+ * map, so a protocol added to both is identified with no extra table.
+ *
+ * Score weights (sum 100):
+ * - Timing: header mark/space, bit mark, one/zero space
+ * - Length: data bits of the state frame
+ * - Frames: frame count and inter-frame gap
+ * - Checksum: the state frame checksum verifies under the protocol's map
+ * - Signature: bits the map never changes match its template
+ *
+ * MIT License
+ */
+
+#include "ir_ac_state.h"
+#include "ir_ac_frame.h"
+#include "ir_protocols.h"
+#include "ir_timing.h"
+#include "ir_distance_width.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "ir_ac_identify";
+
+#define SCORE_TIMING        35
+#define SCORE_LENGTH        20
+#define SCORE_FRAMES        10
+#define SCORE_CHECKSUM      20
+#define SCORE_SIGNATURE     15
+
+/* Candidates, one per frame map (Kaseikyo shares Panasonic's) */
+static const ir_protocol_t ac_candidates[] = {
+    IR_PROTOCOL_CARRIER,
+    IR_PROTOCOL_DAIKIN,
+    IR_PROTOCOL_HITACHI,
+    IR_PROTOCOL_MITSUBISHI,
+    IR_PROTOCOL_MIDEA,
+    IR_PROTOCOL_HAIER,
+    IR_PROTOCOL_SAMSUNG48,
+    IR_PROTOCOL_PANASONIC,
+    IR_PROTOCOL_FUJITSU,
+    IR_PROTOCOL_LG2,
+};
+
+/**
+ * @brief What one capture looks like, independent of any protocol
+ */
+typedef struct {
+    uint16_t header_mark_us;
+    uint16_t header_space_us;
+    uint16_t bit_mark_us;
+    uint16_t one_space_us;
+    uint16_t zero_space_us;
+    uint16_t frame_gap_us;
+    bool pulse_width;
+    bool repeated;                  // Every frame carries the same bytes
+    uint8_t num_frames;
+    uint16_t last_frame_bits;       // Data bits of the state (last) frame
+    const uint8_t *bytes;           // All frames back to back
+    size_t num_bytes;
+} ac_fingerprint_t;
+
+/* ============================================================================
+ * FINGERPRINT
+ * ============================================================================ */
+
+/**
+ * @brief Fingerprint a universal decoder capture from its packed record
+ */
+static bool fingerprint_from_dw(const ir_code_t *code, ir_dw_frame_t *dw, ac_fingerprint_t *fp)
+{
+    size_t len;
+    const uint8_t *payload = ir_code_get_payload(code, &len);
+    if (!payload || ir_dw_unpack(payload, len, dw) != ESP_OK || dw->num_frames == 0) {
+        return false;
+    }
+    ir_dw_set_lsb_first(dw);    // AC maps are LSB first whatever the decoder guessed
+
+    fp->header_mark_us = dw->timing.header_mark_us;
+    fp->header_space_us = dw->timing.header_space_us;
+    fp->bit_mark_us = (dw->timing.zero_mark_us + dw->timing.one_mark_us) / 2;
+    fp->one_space_us = dw->timing.one_space_us;
+    fp->zero_space_us = dw->timing.zero_space_us;
+    fp->frame_gap_us = dw->timing.frame_gap_us;
+    fp->pulse_width = dw->pulse_width;
+    fp->num_frames = dw->num_frames;
+    fp->last_frame_bits = dw->frame_bits[dw->num_frames - 1];
+    fp->bytes = dw->bytes;
+    fp->num_bytes = dw->num_bytes;
+
+    /* Frames start on byte boundaries; compare each to the first */
+    size_t first_len = (dw->frame_bits[0] + 7) / 8;
+    size_t offset = first_len;
+    fp->repeated = dw->num_frames > 1;
+    for (uint8_t f = 1; f < dw->num_frames && fp->repeated; f++) {
+        size_t frame_len = (dw->frame_bits[f] + 7) / 8;
+        fp->repeated = frame_len == first_len && offset + frame_len <= dw->num_bytes &&
+                       memcmp(&dw->bytes[offset], dw->bytes, frame_len) == 0;
+        offset += frame_len;
+    }
+    return true;
+}
+
+/**
+ * @brief Fingerprint a frame a protocol decoder already matched
+ *
+ * The decoder accepted the timing within tolerance, so its nominal
+ * constants stand in for the measured ones.
+ */
+static bool fingerprint_from_protocol(const ir_code_t *code, ac_fingerprint_t *fp)
+{
+    const ir_protocol_constants_t *proto = ir_get_protocol_constants(code->protocol);
+    size_t len;
+    const uint8_t *payload = ir_code_get_payload(code, &len);
+    if (!proto || !payload) {
+        return false;
+    }
+
+    const ac_frame_map_t *map = ir_ac_frame_get_map(code->protocol);
+
+    fp->header_mark_us = proto->header_mark_us;
+    fp->header_space_us = proto->header_space_us;
+    fp->bit_mark_us = proto->bit_mark_us;
+    fp->one_space_us = proto->one_space_us;
+    fp->zero_space_us = proto->zero_space_us;
+    fp->pulse_width = (proto->flags & PROTOCOL_IS_PULSE_WIDTH) != 0;
+    fp->num_frames = 1;
+    fp->frame_gap_us = 0;
+    fp->last_frame_bits = code->bits;
+
+    /* Multi-frame decoders keep every frame; split like the map does */
+    if (map && map->num_frames > 1 && len == map->num_bytes) {
+        fp->num_frames = map->num_frames;
+        fp->frame_gap_us = map->frame_gap_us;
+        fp->last_frame_bits = map->frame_bytes[map->num_frames - 1] * 8;
+    }
+
+    fp->bytes = payload;
+    fp->num_bytes = len;
+    return true;
+}
+
+/* ============================================================================
+ * SCORING
+ * ============================================================================ */
+
+/**
+ * @brief Full weight within half the timing tolerance, falling linearly
+ *        to 0 at the tolerance
+ *
+ * Receiver jitter stays well inside the plateau, while neighbouring
+ * protocols (Midea 4.5ms vs Haier 3ms headers) land on the slope or
+ * beyond it.
+ */
+static uint32_t timing_score(uint16_t measured, uint16_t expected, uint32_t weight)
+{
+    if (expected == 0) {
+        return measured == 0 ? weight : 0;
+    }
+
+    uint32_t diff = measured > expected ? measured - expected : expected - measured;
+    uint32_t limit = (uint32_t)expected * IR_TIMING_TOLERANCE_PERCENT / 100;
+    uint32_t plateau = limit / 2;
+    if (diff <= plateau) {
+        return weight;
+    }
+    if (diff >= limit) {
+        return 0;
+    }
+    return weight * (limit - diff) / (limit - plateau);
+}
+
+/**
+ * @brief Share of the bits the map never touches that match its template
+ *
+ * @return Score out of SCORE_SIGNATURE
+ */
+static uint32_t signature_score(const ac_frame_map_t *map, const uint8_t *frame)
+{
+    uint8_t variable[AC_FRAME_MAX_BYTES] = {0};
+    for (uint8_t i = 0; i < map->num_fields; i++) {
+        const ac_field_t *field = &map->fields[i];
+        variable[field->byte] |= (uint8_t)(((1u << field->width) - 1) << field->shift);
+    }
+    if (map->checksum != AC_CHECKSUM_NONE) {
+        variable[map->checksum_byte] = 0xFF;
+    }
+
+    uint32_t total = 0;
+    uint32_t matched = 0;
+    for (uint8_t i = 0; i < map->num_bytes; i++) {
+        uint8_t fixed = (uint8_t)~variable[i];
+        uint8_t wrong = (frame[i] ^ map->template_bytes[i]) & fixed;
+        total += __builtin_popcount(fixed);
+        matched += __builtin_popcount(fixed) - __builtin_popcount(wrong);
+    }
+    return total ? SCORE_SIGNATURE * matched / total : SCORE_SIGNATURE;
+}
+
+static uint8_t score_protocol(const ac_fingerprint_t *fp, ir_protocol_t protocol)
+{
+    const ir_protocol_constants_t *proto = ir_get_protocol_constants(protocol);
+    const ac_frame_map_t *map = ir_ac_frame_get_map(protocol);
+    if (!proto || !map) {
+        return 0;
+    }
+
+    uint32_t score = 0;
+
+    /* Timing: 5 values share SCORE_TIMING; AC protocols are all pulse distance */
+    score += timing_score(fp->header_mark_us, proto->header_mark_us, SCORE_TIMING / 5);
+    score += timing_score(fp->header_space_us, proto->header_space_us, SCORE_TIMING / 5);
+    if (!fp->pulse_width) {
+        score += timing_score(fp->bit_mark_us, proto->bit_mark_us, SCORE_TIMING / 5);
+        score += timing_score(fp->one_space_us, proto->one_space_us, SCORE_TIMING / 5);
+        score += timing_score(fp->zero_space_us, proto->zero_space_us, SCORE_TIMING / 5);
+    }
+
+    /* Length of the state frame; AC frames are fixed length */
+    uint8_t map_frames = map->num_frames > 1 ? map->num_frames : 1;
+    uint16_t state_bits = map->num_frames > 1 ? map->frame_bytes[map_frames - 1] * 8
+                                              : (map->bits ? map->bits : map->num_bytes * 8);
+    if (fp->last_frame_bits == state_bits) {
+        score += SCORE_LENGTH;
+    }
+
+    /* Frame structure: repeated single frames (Midea sends two) get half */
+    if (fp->num_frames == map_frames) {
+        score += map_frames > 1 ? SCORE_FRAMES / 2 + timing_score(fp->frame_gap_us, map->frame_gap_us,
+                                                                  SCORE_FRAMES / 2)
+                                : SCORE_FRAMES;
+    } else if (map_frames == 1 && fp->repeated) {
+        score += SCORE_FRAMES / 2;
+    }
+
+    /* Content: checksum and signature bits of the state frame */
+    if (fp->num_bytes >= map->num_bytes) {
+        const uint8_t *frame = fp->bytes + fp->num_bytes - map->num_bytes;
+        ac_state_t scratch;
+        ir_ac_get_default_state(&scratch);
+        if (map->checksum != AC_CHECKSUM_NONE &&
+            ir_ac_frame_decode(map, frame, map->num_bytes, &scratch) == ESP_OK) {
+            score += SCORE_CHECKSUM;
+        }
+        score += signature_score(map, frame);
+    }
+
+    return (uint8_t)(score > 100 ? 100 : score);
+}
+
+size_t ir_ac_identify_protocol(const ir_code_t *code, ir_ac_match_t *matches, size_t max_matches)
+{
+    if (!code || !matches || max_matches == 0) {
+        return 0;
+    }
+
+    ac_fingerprint_t fp = {0};
+    ir_dw_frame_t dw;
+    bool ok;
+    if (code->protocol == IR_PROTOCOL_PULSE_DISTANCE || code->protocol == IR_PROTOCOL_PULSE_WIDTH) {
+        ok = fingerprint_from_dw(code, &dw, &fp);
+    } else {
+        ok = fingerprint_from_protocol(code, &fp);
+    }
+    if (!ok) {
+        ESP_LOGD(TAG, "No frame data to fingerprint (%s)", ir_get_protocol_name(code->protocol));
+        return 0;
+    }
+
+    /* Insertion sort into the caller's buffer, best first */
+    size_t count = 0;
+    for (size_t c = 0; c < sizeof(ac_candidates) / sizeof(ac_candidates[0]); c++) {
+        ir_ac_match_t m = {
+            .protocol = ac_candidates[c],
+            .confidence = score_protocol(&fp, ac_candidates[c]),
+        };
+
+        size_t pos = count;
+        while (pos > 0 && matches[pos - 1].confidence < m.confidence) {
+            pos--;
+        }
+        if (pos >= max_matches) {
+            continue;
+        }
+        size_t tail = (count < max_matches ? count : max_matches - 1) - pos;
+        memmove(&matches[pos + 1], &matches[pos], tail * sizeof(matches[0]));
+        matches[pos] = m;
+        if (count < max_matches) {
+            count++;
+        }
+    }
+
+    ESP_LOGD(TAG, "Fingerprint: hdr %u/%u, bit %u/%u/%u, %u frame(s), %u bits, %u bytes",
+             fp.header_mark_us, fp.header_space_us, fp.bit_mark_us, fp.one_space_us,
+             fp.zero_space_us, fp.num_frames, fp.last_frame_bits, (unsigned)fp.num_bytes);
+    return count;
+}
@@ -5,26 +5,134 @@
  * This implements the state-based AC control model where the firmware maintains
  * complete AC state and regenerates full IR frames on any parameter change.
  *
+ * Setter changes are coalesced: each one updates the state and re-arms a
+ * settle timer, and a single commit (one IR frame, one NVS write) runs
+ * once the changes stop for IR_AC_COMMIT_SETTLE_MS. The timer only wakes
+ * the commit task of the unit's emitter: a commit waits for the
+ * transmitter and writes flash, which must not hold up the esp_timer task.
+ *
+ * Frames from the physical remote update the same state from the receive
+ * path, so the next app command starts from what the AC actually has.
+ * The receive task never waits long for a unit: it gives up on the lock
+ * after AC_RX_LOCK_TIMEOUT_MS, and the sync callback runs on the commit
+ * task.
+ *
+ * Several AC units can share the node. Each unit is one entry of an array
+ * sized at init with its own state, lock, settle timer, frame cache and
+ * NVS key; the functions without a unit argument act on unit 0. Units
+ * sharing an emitter take turns on it; each emitter has its own commit
+ * task, so units on different emitters commit in parallel.
+ *
  * Copyright (c) 2025
  */
 
 #include "ir_ac_state.h"
+#include "ir_ac_frame.h"
 #include "ir_control.h"
+#include "ir_distance_width.h"
+#include "ir_protocols.h"
+#include "ir_storage.h"
+#include "ir_timing.h"
 #include "esp_log.h"
-#include "nvs_flash.h"
-#include "nvs.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "ir_ac_state";
 
-/* NVS namespace for AC state */
+/* AC state storage: the ir_log ring when present, otherwise NVS */
 #define NVS_NAMESPACE_AC        "ir_ac"
-#define NVS_KEY_AC_STATE        "state"
+#define LOG_NAMESPACE_AC        "ac_log"
+#define NVS_KEY_AC_STATE        "state"     // Unit 0; unit n uses "state<n>"
+
+/* Receive task latency allowed on top of the next frame's own airtime */
+#define AC_RX_FRAME_SLACK_US    20000
+
+/* Longest the receive task waits for a unit a commit holds; the frame is dropped after */
+#define AC_RX_LOCK_TIMEOUT_MS   20
+
+/**
+ * @brief What a frame of a unit's protocol looks like on the wire
+ *
+ * Rebuilt when the unit's protocol changes, so the receive path only
+ * compares durations against precomputed values.
+ */
+typedef struct {
+    ir_protocol_t protocol;
+    const ir_protocol_constants_t *proto;
+    const ac_frame_map_t *map;
+    uint16_t one_threshold_us;      // Bit spaces above this are 1
+    uint16_t one_space_max_us;      // Longer spaces break the frame
+    uint8_t num_frames;
+    uint16_t frame_bits[AC_FRAME_MAX_FRAMES];
+    size_t min_symbols;
+    bool check_id;                  // First byte is a constant brand ID
+} ac_shadow_t;
+
+/**
+ * @brief One AC unit
+ */
+struct ir_ac_unit {
+    uint8_t index;
+    uint8_t emitter;                // IR LED this unit's frames go out on
+    char nvs_key[sizeof(NVS_KEY_AC_STATE) + 3];   // "state" and up to 3 index digits
+    ac_state_t state;
+    SemaphoreHandle_t lock;         // Guards state, dirty_fields, save_pending and sync_previous
+    esp_timer_handle_t commit_timer;
+    uint32_t dirty_fields;          // Bit per ac_field_id_t changed since the last commit
+    bool save_pending;              // Remote changed the state; save without transmitting
+    atomic_bool commit_due;         // Settle timer expired; the commit task runs the commit
+    uint8_t commit_retries;         // Failed commits re-armed since the last good one
+    atomic_bool sync_due;           // State changed from outside; the commit task reports it
+    bool sync_pending;              // sync_previous holds the state before the first change
+    ac_state_t sync_previous;
+    ac_frame_cache_t *cache;        // Last transmitted frame of this unit
+    ac_shadow_t shadow;             // Remote sync fingerprint
+};
 
 /* Internal state */
 static bool is_initialized = false;
-static nvs_handle_t nvs_handle_ac = 0;
-static ac_state_t current_state = {0};
+static ir_storage_ns_t ac_ns = NULL;
+static ir_storage_ns_t legacy_ac_ns = NULL;    // NVS copy to migrate when ac_ns is the ring log
+static struct ir_ac_unit *units = NULL;
+static uint8_t num_units = 0;
+
+/* Transmit scheduling: one frame at a time per emitter */
+static SemaphoreHandle_t tx_mutex[IR_TX_MAX_EMITTERS];
+static int64_t last_tx_end_us[IR_TX_MAX_EMITTERS];
+static TaskHandle_t commit_task[IR_TX_MAX_EMITTERS];   // Started for emitters that have units
+
+/* Remote sync */
+static ir_ac_sync_cb_t sync_cb = NULL;
+static void *sync_cb_arg = NULL;
+
+/*
+ * Multi-frame press being collected (receive task only). Frame gaps longer
+ * than the RX idle timeout (Daikin: ~29ms vs 10ms) end the capture, so
+ * such a press arrives as one capture per frame.
+ */
+static struct {
+    const ac_frame_map_t *map;      // NULL when nothing is being collected
+    uint8_t next_frame;             // num_frames once complete
+    uint16_t next_bit;
+    uint32_t capture;               // Capture the last frame came from
+    int64_t deadline_us;            // Latest time the next frame can end
+    uint8_t bytes[AC_FRAME_MAX_BYTES];
+} rx_partial;
+static uint32_t rx_captures = 0;
+
+static void ac_commit_timer_callback(void *arg);
+static void ac_commit_task(void *arg);
+static esp_err_t ac_commit_task_start(uint8_t emitter);
+static bool ac_rx_hook(const void *symbols, size_t num_symbols, void *arg);
+static esp_err_t ac_unit_load(ir_ac_handle_t unit);
+static esp_err_t ac_unit_save(ir_ac_handle_t unit);
+static esp_err_t ac_unit_transmit(ir_ac_handle_t unit);
 
 /* Forward declarations for protocol encoders */
 extern esp_err_t ir_ac_encode_daikin(const ac_state_t *state, ir_code_t *code);
@@ -72,94 +180,431 @@ static const char* swing_names[] = {
  * INITIALIZATION
  * ============================================================================ */
 
+static void ac_units_free(void)
+{
+    for (uint8_t i = 0; i < num_units; i++) {
+        struct ir_ac_unit *unit = &units[i];
+        if (unit->commit_timer) {
+            esp_timer_delete(unit->commit_timer);
+        }
+        if (unit->lock) {
+            vSemaphoreDelete(unit->lock);
+        }
+        ir_ac_frame_cache_delete(unit->cache);
+    }
+    free(units);
+    units = NULL;
+    num_units = 0;
+
+    for (uint8_t i = 0; i < IR_TX_MAX_EMITTERS; i++) {
+        if (tx_mutex[i]) {
+            vSemaphoreDelete(tx_mutex[i]);
+            tx_mutex[i] = NULL;
+        }
+        last_tx_end_us[i] = 0;
+    }
+}
+
+static esp_err_t ac_unit_create(struct ir_ac_unit *unit, uint8_t index)
+{
+    unit->index = index;
+    if (index == 0) {
+        snprintf(unit->nvs_key, sizeof(unit->nvs_key), "%s", NVS_KEY_AC_STATE);
+    } else {
+        snprintf(unit->nvs_key, sizeof(unit->nvs_key), "%s%u", NVS_KEY_AC_STATE, index);
+    }
+    ir_ac_get_default_state(&unit->state);
+    unit->shadow.protocol = IR_PROTOCOL_UNKNOWN;
+
+    /* Commit timer and the lock shared by setters and commits */
+    unit->lock = xSemaphoreCreateMutex();
+    unit->cache = ir_ac_frame_cache_create();
+    if (unit->lock == NULL || unit->cache == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate AC unit %u", index);
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t commit_timer_args = {
+        .callback = ac_commit_timer_callback,
+        .arg = unit,
+        .name = "ac_commit"
+    };
+    esp_err_t err = esp_timer_create(&commit_timer_args, &unit->commit_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create AC commit timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    return ESP_OK;
+}
+
 esp_err_t ir_ac_state_init(void)
+{
+    return ir_ac_state_init_units(1);
+}
+
+esp_err_t ir_ac_state_init_units(uint8_t count)
 {
     if (is_initialized) {
         ESP_LOGW(TAG, "AC state system already initialized");
         return ESP_OK;
     }
 
-    /* Initialize NVS partition if needed (shared with ir_action) */
-    esp_err_t err = nvs_flash_init_partition("ir_storage");
-    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_LOGW(TAG, "ir_storage partition needs to be erased, erasing...");
-        ESP_ERROR_CHECK(nvs_flash_erase_partition("ir_storage"));
-        err = nvs_flash_init_partition("ir_storage");
+    if (count == 0 || count > IR_AC_MAX_UNITS) {
+        ESP_LOGE(TAG, "Invalid AC unit count: %u (1-%d)", count, IR_AC_MAX_UNITS);
+        return ESP_ERR_INVALID_ARG;
     }
-    /* Ignore if already initialized by ir_action */
 
-    /* Open NVS namespace for AC state from dedicated ir_storage partition */
-    err = nvs_open_from_partition("ir_storage", NVS_NAMESPACE_AC, NVS_READWRITE, &nvs_handle_ac);
+    /* Shared storage (already initialized by ir_control_init() / ir_action_init()).
+     * Every commit rewrites the state, so it goes to the append-only ring
+     * when the partition table has one. */
+    esp_err_t err = ir_storage_init();
+    if (err == ESP_OK) {
+        err = ir_storage_mount(LOG_NAMESPACE_AC, &ir_storage_backend_log, 0);
+    }
+    esp_err_t log_err = (err == ESP_OK) ? ir_storage_open(LOG_NAMESPACE_AC, &ac_ns) : err;
+    if (err == ESP_OK && log_err == ESP_OK) {
+        err = ir_storage_open(NVS_NAMESPACE_AC, &legacy_ac_ns);
+    } else if (err == ESP_OK) {
+        if (log_err == ESP_ERR_NOT_FOUND) {
+            ESP_LOGI(TAG, "No %s partition, AC state stays in NVS", IR_STORAGE_LOG_PARTITION);
+        } else {
+            ESP_LOGW(TAG, "%s unusable (%s), AC state stays in NVS", IR_STORAGE_LOG_PARTITION,
+                     esp_err_to_name(log_err));
+        }
+        err = ir_storage_open(NVS_NAMESPACE_AC, &ac_ns);
+    }
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace from ir_storage partition: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Failed to open AC state storage: %s", esp_err_to_name(err));
         return err;
     }
 
-    /* Initialize with default state */
-    ir_ac_get_default_state(&current_state);
+    bool tx_mutex_ok = true;
+    for (uint8_t i = 0; i < IR_TX_MAX_EMITTERS; i++) {
+        tx_mutex[i] = xSemaphoreCreateMutex();
+        tx_mutex_ok = tx_mutex_ok && tx_mutex[i] != NULL;
+    }
+    units = calloc(count, sizeof(struct ir_ac_unit));
+    if (!tx_mutex_ok || units == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %u AC unit(s)", count);
+        ac_units_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    num_units = count;
+    for (uint8_t i = 0; i < count; i++) {
+        err = ac_unit_create(&units[i], i);
+        if (err != ESP_OK) {
+            ac_units_free();
+            return err;
+        }
+    }
+
+    /* Units start on the default emitter; ir_ac_unit_set_emitter() starts the others */
+    err = ac_commit_task_start(IR_TX_EMITTER_DEFAULT);
+    if (err != ESP_OK) {
+        ac_units_free();
+        return err;
+    }
 
     /* Try to load saved state */
-    err = ir_ac_load_state();
-    if (err == ESP_ERR_NOT_FOUND) {
-        ESP_LOGI(TAG, "No saved AC state, using defaults");
-    } else if (err != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to load AC state: %s", esp_err_to_name(err));
+    for (uint8_t i = 0; i < count; i++) {
+        err = ac_unit_load(&units[i]);
+        if (err == ESP_ERR_NOT_FOUND) {
+            ESP_LOGI(TAG, "AC%u: no saved state, using defaults", i);
+        } else if (err != ESP_OK) {
+            ESP_LOGW(TAG, "AC%u: failed to load state: %s", i, esp_err_to_name(err));
+        }
     }
 
     is_initialized = true;
-    ESP_LOGI(TAG, "AC state system initialized (Protocol: %s, Power: %s, Mode: %s, Temp: %d°C)",
-             current_state.is_learned ? ir_get_protocol_name(current_state.protocol) : "Not configured",
-             current_state.power ? "ON" : "OFF",
-             ir_ac_get_mode_name(current_state.mode),
-             current_state.temperature);
 
+    /* Follow the physical remote from here on */
+    ir_register_rx_hook(ac_rx_hook, NULL);
+
+    for (uint8_t i = 0; i < count; i++) {
+        const ac_state_t *state = &units[i].state;
+        ESP_LOGI(TAG, "AC%u initialized (Protocol: %s, Power: %s, Mode: %s, Temp: %d°C)", i,
+                 state->is_learned ? ir_get_protocol_name(state->protocol) : "Not configured",
+                 state->power ? "ON" : "OFF",
+                 ir_ac_get_mode_name(state->mode),
+                 state->temperature);
+    }
+
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * UNITS
+ * ============================================================================ */
+
+uint8_t ir_ac_get_num_units(void)
+{
+    return num_units;
+}
+
+ir_ac_handle_t ir_ac_get_unit(uint8_t index)
+{
+    return index < num_units ? &units[index] : NULL;
+}
+
+uint8_t ir_ac_unit_get_index(ir_ac_handle_t unit)
+{
+    return unit ? unit->index : 0;
+}
+
+esp_err_t ir_ac_unit_set_emitter(ir_ac_handle_t unit, uint8_t emitter)
+{
+    if (unit == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (emitter >= ir_tx_get_num_emitters()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ac_commit_task_start(emitter);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    unit->emitter = emitter;
+    if (atomic_load(&unit->commit_due) || atomic_load(&unit->sync_due)) {
+        xTaskNotifyGive(commit_task[emitter]);   // The old emitter's task skips it now
+    }
+    ESP_LOGI(TAG, "AC unit %u on IR emitter %u", unit->index, emitter);
     return ESP_OK;
 }
 
+uint8_t ir_ac_unit_get_emitter(ir_ac_handle_t unit)
+{
+    return unit ? unit->emitter : IR_TX_EMITTER_DEFAULT;
+}
+
 /* ============================================================================
  * STATE GETTERS
  * ============================================================================ */
 
+const ac_state_t* ir_ac_unit_get_state(ir_ac_handle_t unit)
+{
+    return unit ? &unit->state : NULL;
+}
+
+esp_err_t ir_ac_unit_copy_state(ir_ac_handle_t unit, ac_state_t *out)
+{
+    if (!is_initialized || !unit) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    memcpy(out, &unit->state, sizeof(ac_state_t));
+    xSemaphoreGive(unit->lock);
+    return ESP_OK;
+}
+
+bool ir_ac_unit_is_configured(ir_ac_handle_t unit)
+{
+    return unit && unit->state.is_learned && (unit->state.protocol != IR_PROTOCOL_UNKNOWN);
+}
+
 const ac_state_t* ir_ac_state_get(void)
 {
-    return &current_state;
+    return ir_ac_unit_get_state(ir_ac_get_unit(0));
+}
+
+esp_err_t ir_ac_copy_state(ac_state_t *out)
+{
+    return ir_ac_unit_copy_state(ir_ac_get_unit(0), out);
 }
 
 bool ir_ac_is_configured(void)
 {
-    return current_state.is_learned && (current_state.protocol != IR_PROTOCOL_UNKNOWN);
+    return ir_ac_unit_is_configured(ir_ac_get_unit(0));
 }
 
 /* ============================================================================
- * STATE SETTERS (Individual Parameters)
+ * COALESCED COMMITS
  * ============================================================================ */
 
-esp_err_t ir_ac_set_power(bool power)
+/**
+ * @brief Record changed fields and re-arm the settle timer
+ *
+ * Called with the unit lock held.
+ */
+static void ac_schedule_commit(ir_ac_handle_t unit, uint32_t fields)
 {
-    if (!is_initialized) {
-        return ESP_ERR_INVALID_STATE;
+    unit->dirty_fields |= fields;
+    esp_timer_stop(unit->commit_timer);   // Not running is fine
+    esp_timer_start_once(unit->commit_timer, (uint64_t)IR_AC_COMMIT_SETTLE_MS * 1000);
+}
+
+/* esp_timer task: hand the commit to the task of the unit's emitter */
+static void ac_commit_timer_callback(void *arg)
+{
+    ir_ac_handle_t unit = (ir_ac_handle_t)arg;
+    atomic_store(&unit->commit_due, true);
+    xTaskNotifyGive(commit_task[unit->emitter]);
+}
+
+/**
+ * @brief Record a state change from outside the app for the sync callback
+ *
+ * Called with the unit lock held. Changes before the commit task reports
+ * them fold into one callback from the first previous state.
+ */
+static void ac_schedule_sync(ir_ac_handle_t unit, const ac_state_t *previous)
+{
+    if (!unit->sync_pending) {
+        memcpy(&unit->sync_previous, previous, sizeof(ac_state_t));
+        unit->sync_pending = true;
     }
+    atomic_store(&unit->sync_due, true);
+    xTaskNotifyGive(commit_task[unit->emitter]);
+}
 
-    if (current_state.power == power) {
-        ESP_LOGD(TAG, "Power already %s", power ? "ON" : "OFF");
+/* Commit task: report a unit's pending state change */
+static void ac_unit_report_sync(ir_ac_handle_t unit)
+{
+    ac_state_t state, previous;
+
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    bool pending = unit->sync_pending;
+    unit->sync_pending = false;
+    memcpy(&state, &unit->state, sizeof(ac_state_t));
+    memcpy(&previous, &unit->sync_previous, sizeof(ac_state_t));
+    xSemaphoreGive(unit->lock);
+
+    if (pending && sync_cb) {
+        sync_cb(unit, &state, &previous, sync_cb_arg);
+    }
+}
+
+/* Runs the due commits and sync reports of the units on one emitter */
+static void ac_commit_task(void *arg)
+{
+    uint8_t emitter = (uint8_t)(uintptr_t)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (uint8_t i = 0; is_initialized && i < num_units; i++) {
+            if (units[i].emitter != emitter) {
+                continue;
+            }
+            if (atomic_exchange(&units[i].commit_due, false)) {
+                ir_ac_unit_commit(&units[i]);
+            }
+            if (atomic_exchange(&units[i].sync_due, false)) {
+                ac_unit_report_sync(&units[i]);
+            }
+        }
+    }
+}
+
+/* Kept across re-inits; a task only runs commits it is woken for */
+static esp_err_t ac_commit_task_start(uint8_t emitter)
+{
+    if (commit_task[emitter] != NULL) {
         return ESP_OK;
     }
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "ac_commit%u", emitter);
+    if (xTaskCreate(ac_commit_task, name, 4096, (void *)(uintptr_t)emitter, 5,
+                    &commit_task[emitter]) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create AC commit task for emitter %u", emitter);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
 
-    current_state.power = power;
-    ESP_LOGI(TAG, "AC Power: %s", power ? "ON" : "OFF");
+esp_err_t ir_ac_unit_commit(ir_ac_handle_t unit)
+{
+    if (!is_initialized || !unit) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    /* Transmit state */
-    esp_err_t err = ir_ac_transmit_state();
+    esp_timer_stop(unit->commit_timer);
+
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
+    uint32_t fields = unit->dirty_fields;
+    bool save = unit->save_pending;
+    unit->dirty_fields = 0;
+    unit->save_pending = false;
+
+    esp_err_t err = ESP_OK;
+    if (fields != 0) {
+        ESP_LOGI(TAG, "AC%u: committing %d changed field(s)", unit->index, __builtin_popcount(fields));
+
+        err = ac_unit_transmit(unit);
+        if (err == ESP_OK) {
+            save = true;    // Auto-save on successful transmission
+        } else {
+            unit->dirty_fields |= fields;       // Not on air yet: the next commit sends it
+            unit->save_pending |= save;
+            save = false;
+        }
+    }
+    if (save) {
+        err = ac_unit_save(unit);
+        if (err != ESP_OK) {
+            unit->save_pending = true;
+        }
+    }
+
+    /* Commits usually run on the commit task, where nobody sees the error */
     if (err == ESP_OK) {
-        ir_ac_save_state(); // Auto-save on successful transmission
+        unit->commit_retries = 0;
+    } else if (err != ESP_ERR_INVALID_STATE && err != ESP_ERR_INVALID_ARG &&
+               unit->commit_retries < IR_AC_COMMIT_RETRIES) {
+        unit->commit_retries++;
+        ESP_LOGW(TAG, "AC%u: commit failed (%s), retry %u of %d", unit->index,
+                 esp_err_to_name(err), unit->commit_retries, IR_AC_COMMIT_RETRIES);
+        ac_schedule_commit(unit, 0);
+    } else {
+        unit->commit_retries = 0;
+        ESP_LOGE(TAG, "AC%u: commit failed (%s), kept for the next change", unit->index,
+                 esp_err_to_name(err));
     }
 
+    xSemaphoreGive(unit->lock);
     return err;
 }
 
-esp_err_t ir_ac_set_mode(ac_mode_t mode)
+esp_err_t ir_ac_commit(void)
 {
-    if (!is_initialized) {
+    return ir_ac_unit_commit(ir_ac_get_unit(0));
+}
+
+/* ============================================================================
+ * STATE SETTERS (Individual Parameters)
+ * ============================================================================ */
+
+esp_err_t ir_ac_unit_set_power(ir_ac_handle_t unit, bool power)
+{
+    if (!is_initialized || !unit) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
+    if (unit->state.power == power) {
+        xSemaphoreGive(unit->lock);
+        ESP_LOGD(TAG, "Power already %s", power ? "ON" : "OFF");
+        return ESP_OK;
+    }
+
+    unit->state.power = power;
+    ac_schedule_commit(unit, 1u << AC_FIELD_POWER);
+
+    xSemaphoreGive(unit->lock);
+
+    ESP_LOGI(TAG, "AC Power: %s", power ? "ON" : "OFF");
+    return ESP_OK;
+}
+
+esp_err_t ir_ac_unit_set_mode(ir_ac_handle_t unit, ac_mode_t mode)
+{
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
@@ -168,26 +613,26 @@ esp_err_t ir_ac_set_mode(ac_mode_t mode)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (current_state.mode == mode) {
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
+    if (unit->state.mode == mode) {
+        xSemaphoreGive(unit->lock);
         ESP_LOGD(TAG, "Mode already %s", ir_ac_get_mode_name(mode));
         return ESP_OK;
     }
 
-    current_state.mode = mode;
-    ESP_LOGI(TAG, "AC Mode: %s", ir_ac_get_mode_name(mode));
+    unit->state.mode = mode;
+    ac_schedule_commit(unit, 1u << AC_FIELD_MODE);
 
-    /* Transmit state */
-    esp_err_t err = ir_ac_transmit_state();
-    if (err == ESP_OK) {
-        ir_ac_save_state();
-    }
+    xSemaphoreGive(unit->lock);
 
-    return err;
+    ESP_LOGI(TAG, "AC Mode: %s", ir_ac_get_mode_name(mode));
+    return ESP_OK;
 }
 
-esp_err_t ir_ac_set_temperature(uint8_t temperature)
+esp_err_t ir_ac_unit_set_temperature(ir_ac_handle_t unit, uint8_t temperature)
 {
-    if (!is_initialized) {
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
@@ -197,26 +642,26 @@ esp_err_t ir_ac_set_temperature(uint8_t temperature)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (current_state.temperature == temperature) {
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
+    if (unit->state.temperature == temperature) {
+        xSemaphoreGive(unit->lock);
         ESP_LOGD(TAG, "Temperature already %d°C", temperature);
         return ESP_OK;
     }
 
-    current_state.temperature = temperature;
-    ESP_LOGI(TAG, "AC Temperature: %d°C", temperature);
+    unit->state.temperature = temperature;
+    ac_schedule_commit(unit, 1u << AC_FIELD_TEMP);
 
-    /* Transmit state */
-    esp_err_t err = ir_ac_transmit_state();
-    if (err == ESP_OK) {
-        ir_ac_save_state();
-    }
+    xSemaphoreGive(unit->lock);
 
-    return err;
+    ESP_LOGI(TAG, "AC Temperature: %d°C", temperature);
+    return ESP_OK;
 }
 
-esp_err_t ir_ac_set_fan_speed(ac_fan_speed_t fan_speed)
+esp_err_t ir_ac_unit_set_fan_speed(ir_ac_handle_t unit, ac_fan_speed_t fan_speed)
 {
-    if (!is_initialized) {
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
@@ -225,26 +670,26 @@ esp_err_t ir_ac_set_fan_speed(ac_fan_speed_t fan_speed)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (current_state.fan_speed == fan_speed) {
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
+    if (unit->state.fan_speed == fan_speed) {
+        xSemaphoreGive(unit->lock);
         ESP_LOGD(TAG, "Fan speed already %s", ir_ac_get_fan_speed_name(fan_speed));
         return ESP_OK;
     }
 
-    current_state.fan_speed = fan_speed;
-    ESP_LOGI(TAG, "AC Fan Speed: %s", ir_ac_get_fan_speed_name(fan_speed));
+    unit->state.fan_speed = fan_speed;
+    ac_schedule_commit(unit, 1u << AC_FIELD_FAN);
 
-    /* Transmit state */
-    esp_err_t err = ir_ac_transmit_state();
-    if (err == ESP_OK) {
-        ir_ac_save_state();
-    }
+    xSemaphoreGive(unit->lock);
 
-    return err;
+    ESP_LOGI(TAG, "AC Fan Speed: %s", ir_ac_get_fan_speed_name(fan_speed));
+    return ESP_OK;
 }
 
-esp_err_t ir_ac_set_swing(ac_swing_t swing)
+esp_err_t ir_ac_unit_set_swing(ir_ac_handle_t unit, ac_swing_t swing)
 {
-    if (!is_initialized) {
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
@@ -253,26 +698,26 @@ esp_err_t ir_ac_set_swing(ac_swing_t swing)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (current_state.swing == swing) {
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
+    if (unit->state.swing == swing) {
+        xSemaphoreGive(unit->lock);
         ESP_LOGD(TAG, "Swing already %s", ir_ac_get_swing_name(swing));
         return ESP_OK;
     }
 
-    current_state.swing = swing;
-    ESP_LOGI(TAG, "AC Swing: %s", ir_ac_get_swing_name(swing));
+    unit->state.swing = swing;
+    ac_schedule_commit(unit, 1u << AC_FIELD_SWING);
 
-    /* Transmit state */
-    esp_err_t err = ir_ac_transmit_state();
-    if (err == ESP_OK) {
-        ir_ac_save_state();
-    }
+    xSemaphoreGive(unit->lock);
 
-    return err;
+    ESP_LOGI(TAG, "AC Swing: %s", ir_ac_get_swing_name(swing));
+    return ESP_OK;
 }
 
-esp_err_t ir_ac_set_state(const ac_state_t *state)
+esp_err_t ir_ac_unit_set_state(ir_ac_handle_t unit, const ac_state_t *state)
 {
-    if (!is_initialized || !state) {
+    if (!is_initialized || !unit || !state) {
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -283,28 +728,26 @@ esp_err_t ir_ac_set_state(const ac_state_t *state)
         return err;
     }
 
-    /* Update current state */
-    memcpy(&current_state, state, sizeof(ac_state_t));
+    /* Update current state; an explicit full update commits immediately */
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    memcpy(&unit->state, state, sizeof(ac_state_t));
+    unit->dirty_fields |= (1u << AC_FIELD_MAX) - 1;
 
     ESP_LOGI(TAG, "AC State updated: Power=%s, Mode=%s, Temp=%d°C, Fan=%s, Swing=%s",
-             current_state.power ? "ON" : "OFF",
-             ir_ac_get_mode_name(current_state.mode),
-             current_state.temperature,
-             ir_ac_get_fan_speed_name(current_state.fan_speed),
-             ir_ac_get_swing_name(current_state.swing));
-
-    /* Transmit state */
-    err = ir_ac_transmit_state();
-    if (err == ESP_OK) {
-        ir_ac_save_state();
-    }
-
-    return err;
+             unit->state.power ? "ON" : "OFF",
+             ir_ac_get_mode_name(unit->state.mode),
+             unit->state.temperature,
+             ir_ac_get_fan_speed_name(unit->state.fan_speed),
+             ir_ac_get_swing_name(unit->state.swing));
+    xSemaphoreGive(unit->lock);
+
+    /* Transmit pending setter changes along with it */
+    return ir_ac_unit_commit(unit);
 }
 
-esp_err_t ir_ac_set_protocol(ir_protocol_t protocol, uint8_t variant)
+esp_err_t ir_ac_unit_set_protocol(ir_ac_handle_t unit, ir_protocol_t protocol, uint8_t variant)
 {
-    if (!is_initialized) {
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
@@ -325,15 +768,53 @@ esp_err_t ir_ac_set_protocol(ir_protocol_t protocol, uint8_t variant)
         return ESP_ERR_NOT_SUPPORTED;
     }
 
-    current_state.protocol = protocol;
-    current_state.protocol_variant = variant;
-    current_state.is_learned = true;
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    unit->state.protocol = protocol;
+    unit->state.protocol_variant = variant;
+    unit->state.is_learned = true;
 
-    ESP_LOGI(TAG, "AC Protocol set to: %s (variant %d)",
+    ESP_LOGI(TAG, "AC%u protocol set to: %s (variant %d)", unit->index,
              ir_get_protocol_name(protocol), variant);
 
     /* Save configuration */
-    return ir_ac_save_state();
+    esp_err_t err = ac_unit_save(unit);
+    xSemaphoreGive(unit->lock);
+    return err;
+}
+
+esp_err_t ir_ac_set_power(bool power)
+{
+    return ir_ac_unit_set_power(ir_ac_get_unit(0), power);
+}
+
+esp_err_t ir_ac_set_mode(ac_mode_t mode)
+{
+    return ir_ac_unit_set_mode(ir_ac_get_unit(0), mode);
+}
+
+esp_err_t ir_ac_set_temperature(uint8_t temperature)
+{
+    return ir_ac_unit_set_temperature(ir_ac_get_unit(0), temperature);
+}
+
+esp_err_t ir_ac_set_fan_speed(ac_fan_speed_t fan_speed)
+{
+    return ir_ac_unit_set_fan_speed(ir_ac_get_unit(0), fan_speed);
+}
+
+esp_err_t ir_ac_set_swing(ac_swing_t swing)
+{
+    return ir_ac_unit_set_swing(ir_ac_get_unit(0), swing);
+}
+
+esp_err_t ir_ac_set_state(const ac_state_t *state)
+{
+    return ir_ac_unit_set_state(ir_ac_get_unit(0), state);
+}
+
+esp_err_t ir_ac_set_protocol(ir_protocol_t protocol, uint8_t variant)
+{
+    return ir_ac_unit_set_protocol(ir_ac_get_unit(0), protocol, variant);
 }
 
 /* ============================================================================
@@ -357,97 +838,94 @@ esp_err_t ir_ac_encode_state(const ac_state_t *state, ir_code_t *code)
         return err;
     }
 
-    /* Clear code structure */
-    memset(code, 0, sizeof(ir_code_t));
+    const ac_frame_map_t *map = ir_ac_frame_get_map(state->protocol);
+    if (map == NULL) {
+        ESP_LOGE(TAG, "Protocol encoder not implemented for: %s",
+                 ir_get_protocol_name(state->protocol));
+        return ESP_ERR_NOT_SUPPORTED;
+    }
 
-    /* Call protocol-specific encoder */
-    switch (state->protocol) {
-        case IR_PROTOCOL_DAIKIN:
-            err = ir_ac_encode_daikin(state, code);
-            break;
+    err = ir_ac_frame_encode(map, state, code);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to encode AC state: %s", esp_err_to_name(err));
+    } else {
+        ESP_LOGD(TAG, "AC state encoded successfully (protocol: %s, bits: %d)",
+                 ir_get_protocol_name(code->protocol), code->bits);
+    }
 
-        case IR_PROTOCOL_CARRIER:
-            err = ir_ac_encode_carrier(state, code);
-            break;
-
-        case IR_PROTOCOL_HITACHI:
-            err = ir_ac_encode_hitachi(state, code);
-            break;
-
-        case IR_PROTOCOL_MITSUBISHI:
-            err = ir_ac_encode_mitsubishi(state, code);
-            break;
-
-        case IR_PROTOCOL_FUJITSU:
-            err = ir_ac_encode_fujitsu(state, code);
-            break;
+    return err;
+}
 
-        case IR_PROTOCOL_HAIER:
-            err = ir_ac_encode_haier(state, code);
-            break;
+/**
+ * @brief Frame bytes of a captured code
+ *
+ * Protocol decoders store the frame as the payload; the universal decoder
+ * stores its packed record, re-packed LSB first like every AC frame map.
+ */
+static const uint8_t *ac_frame_bytes(const ir_code_t *code, ir_dw_frame_t *dw, size_t *len)
+{
+    if (code->protocol != IR_PROTOCOL_PULSE_DISTANCE) {
+        return ir_code_get_payload(code, len);
+    }
 
-        case IR_PROTOCOL_MIDEA:
-            err = ir_ac_encode_midea(state, code);
-            break;
+    size_t record_len;
+    const uint8_t *record = ir_code_get_payload(code, &record_len);
+    if (!record || ir_dw_unpack(record, record_len, dw) != ESP_OK) {
+        return NULL;
+    }
+    ir_dw_set_lsb_first(dw);
+    *len = dw->num_bytes;
+    return dw->bytes;
+}
 
-        case IR_PROTOCOL_SAMSUNG48:
-            err = ir_ac_encode_samsung48(state, code);
-            break;
+esp_err_t ir_ac_decode_frame(const ir_code_t *code, ir_protocol_t protocol, ac_state_t *state)
+{
+    if (!code || !state) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-        case IR_PROTOCOL_PANASONIC:
-        case IR_PROTOCOL_KASEIKYO:
-            err = ir_ac_encode_panasonic(state, code);
-            break;
+    /* Initialize state to defaults */
+    ir_ac_get_default_state(state);
 
-        case IR_PROTOCOL_LG2:
-            err = ir_ac_encode_lg2(state, code);
-            break;
+    const ac_frame_map_t *map = ir_ac_frame_get_map(protocol);
+    if (map == NULL) {
+        ESP_LOGW(TAG, "Protocol %s is not an AC protocol", ir_get_protocol_name(protocol));
+        return ESP_ERR_NOT_SUPPORTED;
+    }
 
-        default:
-            ESP_LOGE(TAG, "Protocol encoder not implemented for: %s",
-                     ir_get_protocol_name(state->protocol));
-            return ESP_ERR_NOT_SUPPORTED;
+    ir_dw_frame_t dw;
+    size_t len = 0;
+    const uint8_t *bytes = ac_frame_bytes(code, &dw, &len);
+    if (!bytes) {
+        ESP_LOGD(TAG, "%s: no frame bytes in %s code", map->name, ir_get_protocol_name(code->protocol));
+        return ESP_ERR_INVALID_SIZE;
     }
 
+    esp_err_t err = ir_ac_frame_decode(map, bytes, len, state);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to encode AC state: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGD(TAG, "AC state encoded successfully (protocol: %s, bits: %d)",
-                 ir_get_protocol_name(code->protocol), code->bits);
+        ESP_LOGD(TAG, "%s frame not decoded (%u bytes): %s", map->name,
+                 (unsigned)len, esp_err_to_name(err));
+        return err;
     }
 
-    return err;
+    state->protocol = protocol;
+    ESP_LOGD(TAG, "%s decoded: Power=%d, Mode=%d, Temp=%d°C", map->name,
+             state->power, state->mode, state->temperature);
+    return ESP_OK;
 }
 
-/**
- * @brief Decode RMT raw data to byte array (LSB-first)
- */
-static esp_err_t decode_raw_to_bytes_lsb(const uint16_t *raw_data, size_t num_marks_spaces,
-                                           uint16_t mark_us, uint16_t one_space_us, uint16_t zero_space_us,
-                                           uint8_t *bytes, size_t num_bytes)
+esp_err_t ir_ac_normalize_state(ac_state_t *state)
 {
-    if (!raw_data || !bytes || num_marks_spaces < num_bytes * 16) {
+    if (!state) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    size_t idx = 0;
-    for (size_t byte_idx = 0; byte_idx < num_bytes; byte_idx++) {
-        uint8_t byte = 0;
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            /* Skip mark (should be consistent) */
-            idx++;
-            /* Check space duration */
-            uint16_t space = raw_data[idx++];
-
-            /* Tolerance: ±30% */
-            if (space > (one_space_us * 0.7) && space < (one_space_us * 1.3)) {
-                byte |= (1 << bit);  // LSB first
-            }
-            /* If not one, assume zero (already 0 in byte) */
-        }
-        bytes[byte_idx] = byte;
+    const ac_frame_map_t *map = ir_ac_frame_get_map(state->protocol);
+    if (map == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
     }
 
+    ir_ac_frame_normalize(map, state);
     return ESP_OK;
 }
 
@@ -457,206 +935,127 @@ esp_err_t ir_ac_decode_state(const ir_code_t *code, ac_state_t *state)
         return ESP_ERR_INVALID_ARG;
     }
 
-    /* Initialize state to defaults */
-    ir_ac_get_default_state(state);
-
-    /* Check if protocol is an AC protocol */
-    switch (code->protocol) {
-        case IR_PROTOCOL_CARRIER: {
-            /* Carrier/Voltas: 128-bit (16 bytes) */
-            if (code->bits < 120) {
-                ESP_LOGW(TAG, "Carrier frame too short: %d bits", code->bits);
-                return ESP_ERR_INVALID_SIZE;
-            }
-
-            uint8_t data[16] = {0};
-            if (decode_raw_to_bytes_lsb(code->raw_data, code->raw_length, 560, 1690, 560, data, 16) != ESP_OK) {
-                return ESP_FAIL;
-            }
-
-            /* Extract power and mode from byte 3 */
-            state->power = (data[3] & 0x01) ? true : false;
-            uint8_t mode_bits = (data[3] >> 1) & 0x07;
-            switch (mode_bits) {
-                case 0: state->mode = AC_MODE_AUTO; break;
-                case 1: state->mode = AC_MODE_COOL; break;
-                case 2: state->mode = AC_MODE_DRY; break;
-                case 3: state->mode = AC_MODE_FAN; break;
-                case 4: state->mode = AC_MODE_HEAT; break;
-                default: state->mode = AC_MODE_COOL; break;
-            }
-
-            /* Temperature (byte 4, offset encoding) */
-            state->temperature = data[4] + 16;
-            if (state->temperature < AC_TEMP_MIN) state->temperature = AC_TEMP_MIN;
-            if (state->temperature > AC_TEMP_MAX) state->temperature = AC_TEMP_MAX;
-
-            /* Fan speed (byte 5) */
-            state->fan_speed = (ac_fan_speed_t)(data[5] & 0x03);
-
-            /* Swing (byte 6) */
-            state->swing = (data[6] & 0x01) ? AC_SWING_VERTICAL : AC_SWING_OFF;
-
-            /* Extended features */
-            state->turbo = (data[7] & 0x01) ? true : false;
-            state->sleep = (data[8] & 0x01) ? true : false;
-            state->econo = (data[9] & 0x01) ? true : false;
-
-            state->protocol = IR_PROTOCOL_CARRIER;
-            ESP_LOGI(TAG, "Carrier decoded: Power=%d, Mode=%d, Temp=%d°C",
-                     state->power, state->mode, state->temperature);
-            return ESP_OK;
+    ir_protocol_t protocol = code->protocol;
+    if (protocol == IR_PROTOCOL_PULSE_DISTANCE) {
+        ir_ac_match_t match;
+        if (ir_ac_identify_protocol(code, &match, 1) == 0 ||
+            match.confidence < IR_AC_IDENTIFY_MIN_CONFIDENCE) {
+            ir_ac_get_default_state(state);
+            return ESP_ERR_NOT_SUPPORTED;
         }
+        protocol = match.protocol;
+    }
 
-        case IR_PROTOCOL_DAIKIN: {
-            /* Daikin: 312-bit (19 bytes main frame) */
-            if (code->bits < 300) {
-                ESP_LOGW(TAG, "Daikin frame too short: %d bits", code->bits);
-                return ESP_ERR_INVALID_SIZE;
-            }
-
-            uint8_t data[19] = {0};
-            if (decode_raw_to_bytes_lsb(code->raw_data, code->raw_length, 428, 1280, 428, data, 19) != ESP_OK) {
-                return ESP_FAIL;
-            }
-
-            /* Extract power and mode from byte 5 */
-            state->power = (data[5] & 0x01) ? true : false;
-            uint8_t mode_bits = (data[5] >> 4) & 0x0F;
-            switch (mode_bits) {
-                case 0: state->mode = AC_MODE_FAN; break;
-                case 2: state->mode = AC_MODE_DRY; break;
-                case 3: state->mode = AC_MODE_COOL; break;
-                case 4: state->mode = AC_MODE_HEAT; break;
-                case 7: state->mode = AC_MODE_AUTO; break;
-                default: state->mode = AC_MODE_COOL; break;
-            }
-
-            /* Temperature (byte 6, scaled by 2) */
-            state->temperature = data[6] / 2;
-            if (state->temperature < AC_TEMP_MIN) state->temperature = AC_TEMP_MIN;
-            if (state->temperature > AC_TEMP_MAX) state->temperature = AC_TEMP_MAX;
-
-            /* Fan speed (byte 8, upper nibble) */
-            uint8_t fan_bits = (data[8] >> 4) & 0x0F;
-            switch (fan_bits) {
-                case 3: state->fan_speed = AC_FAN_AUTO; break;
-                case 4: state->fan_speed = AC_FAN_LOW; break;
-                case 5: state->fan_speed = AC_FAN_MEDIUM; break;
-                case 6: state->fan_speed = AC_FAN_HIGH; break;
-                case 7: state->fan_speed = AC_FAN_TURBO; break;
-                default: state->fan_speed = AC_FAN_AUTO; break;
-            }
-
-            /* Swing (byte 9) */
-            state->swing = (data[9] == 0xF1) ? AC_SWING_VERTICAL : AC_SWING_OFF;
+    return ir_ac_decode_frame(code, protocol, state);
+}
 
-            /* Advanced features (byte 13) */
-            state->turbo = (data[13] & 0x01) ? true : false;
-            state->quiet = (data[13] & 0x02) ? true : false;
-            state->econo = (data[13] & 0x04) ? true : false;
+/* Caller holds tx_mutex[emitter] */
+static void ac_wait_gap(uint8_t emitter)
+{
+    int64_t wait_us = last_tx_end_us[emitter] + (int64_t)IR_AC_UNIT_GAP_MS * 1000 - esp_timer_get_time();
+    if (last_tx_end_us[emitter] != 0 && wait_us > 0) {
+        vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000) + 1);
+    }
+}
 
-            state->protocol = IR_PROTOCOL_DAIKIN;
-            ESP_LOGI(TAG, "Daikin decoded: Power=%d, Mode=%d, Temp=%d°C",
-                     state->power, state->mode, state->temperature);
-            return ESP_OK;
+/**
+ * @brief Send a unit's frame, one frame at a time per emitter
+ *
+ * Frames of units sharing an emitter never overlap, and IR_AC_UNIT_GAP_MS
+ * of silence separates consecutive frames so no AC reads the tail of one
+ * and the head of the next as one frame. Units on other emitters proceed
+ * in parallel: settled commits run on each emitter's own commit task, and
+ * direct commits on the caller's task only wait for their own emitter.
+ */
+static esp_err_t ac_unit_send(ir_ac_handle_t unit)
+{
+    uint8_t emitter = unit->emitter;
+    xSemaphoreTake(tx_mutex[emitter], portMAX_DELAY);
+    ac_wait_gap(emitter);
+
+    /* Patch the cached frame and symbols; only changed bytes are rewritten */
+    esp_err_t err = ir_ac_frame_transmit(unit->cache, emitter, &unit->state);
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        /* No cacheable timing: encode a full code and let ir_transmit_on() build it */
+        ir_code_t code = {0};
+        err = ir_ac_encode_state(&unit->state, &code);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to encode AC state: %s", esp_err_to_name(err));
+            xSemaphoreGive(tx_mutex[emitter]);
+            return err;
         }
 
-        case IR_PROTOCOL_MIDEA: {
-            /* Midea: 48-bit (6 bytes) */
-            if (code->bits < 40) {
-                ESP_LOGW(TAG, "Midea frame too short: %d bits", code->bits);
-                return ESP_ERR_INVALID_SIZE;
-            }
-
-            uint8_t data[6] = {0};
-            if (decode_raw_to_bytes_lsb(code->raw_data, code->raw_length, 560, 1690, 560, data, 6) != ESP_OK) {
-                return ESP_FAIL;
-            }
+        err = ir_transmit_on(emitter, &code);
+        ir_code_free(&code);
+    }
 
-            /* Basic decoding for Midea (simplified) */
-            state->power = (data[1] & 0x20) ? true : false;
-            state->mode = AC_MODE_COOL;  /* Default mode */
-            state->temperature = ((data[1] & 0x0F) + 17);  /* Simplified temp extraction */
-            state->protocol = IR_PROTOCOL_MIDEA;
+    last_tx_end_us[emitter] = esp_timer_get_time();
+    xSemaphoreGive(tx_mutex[emitter]);
 
-            ESP_LOGI(TAG, "Midea decoded: Power=%d, Temp=%d°C", state->power, state->temperature);
-            return ESP_OK;
-        }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to transmit AC IR code: %s", esp_err_to_name(err));
+    }
+    return err;
+}
 
-        case IR_PROTOCOL_LG2: {
-            /* LG2: 28-bit (4 bytes) */
-            if (code->bits < 24) {
-                ESP_LOGW(TAG, "LG2 frame too short: %d bits", code->bits);
-                return ESP_ERR_INVALID_SIZE;
-            }
+/* Caller holds unit->lock */
+static esp_err_t ac_unit_transmit(ir_ac_handle_t unit)
+{
+    if (!unit->state.is_learned) {
+        ESP_LOGE(TAG, "AC%u not configured. Please learn AC protocol first.", unit->index);
+        return ESP_ERR_INVALID_STATE;
+    }
 
-            uint8_t data[4] = {0};
-            if (decode_raw_to_bytes_lsb(code->raw_data, code->raw_length, 560, 1690, 560, data, 4) != ESP_OK) {
-                return ESP_FAIL;
-            }
+    esp_err_t err = ir_ac_validate_state(&unit->state);
+    if (err != ESP_OK) {
+        return err;
+    }
 
-            /* Basic LG2 decoding (simplified) */
-            state->power = true;  /* Assume ON when frame is sent */
-            state->mode = AC_MODE_COOL;
-            state->temperature = ((data[1] & 0x0F) + 18);  /* Simplified */
-            state->protocol = IR_PROTOCOL_LG2;
+    ESP_LOGI(TAG, "Transmitting AC%u state: Power=%s, Mode=%s, Temp=%d°C", unit->index,
+             unit->state.power ? "ON" : "OFF",
+             ir_ac_get_mode_name(unit->state.mode),
+             unit->state.temperature);
 
-            ESP_LOGI(TAG, "LG2 decoded: Temp=%d°C", state->temperature);
-            return ESP_OK;
-        }
+    return ac_unit_send(unit);
+}
 
-        case IR_PROTOCOL_HITACHI:
-        case IR_PROTOCOL_MITSUBISHI:
-        case IR_PROTOCOL_HAIER:
-        case IR_PROTOCOL_SAMSUNG48:
-        case IR_PROTOCOL_PANASONIC:
-        case IR_PROTOCOL_FUJITSU:
-            /* These protocols are recognized but detailed decoding not implemented */
-            ESP_LOGW(TAG, "AC decoder for %s not fully implemented - using defaults",
-                     ir_get_protocol_name(code->protocol));
-            state->protocol = code->protocol;
-            state->power = true;  /* Assume ON */
-            state->mode = AC_MODE_COOL;
-            state->temperature = AC_TEMP_DEFAULT;
-            return ESP_OK;
-
-        default:
-            ESP_LOGW(TAG, "Protocol %s is not an AC protocol", ir_get_protocol_name(code->protocol));
-            return ESP_ERR_NOT_SUPPORTED;
+esp_err_t ir_ac_unit_transmit_state(ir_ac_handle_t unit)
+{
+    if (!is_initialized || !unit) {
+        return ESP_ERR_INVALID_STATE;
     }
+
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    esp_err_t err = ac_unit_transmit(unit);
+    xSemaphoreGive(unit->lock);
+    return err;
 }
 
 esp_err_t ir_ac_transmit_state(void)
 {
-    if (!is_initialized) {
-        return ESP_ERR_INVALID_STATE;
-    }
+    return ir_ac_unit_transmit_state(ir_ac_get_unit(0));
+}
 
-    if (!current_state.is_learned) {
-        ESP_LOGE(TAG, "AC not configured. Please learn AC protocol first.");
+esp_err_t ir_ac_unit_send_symbols(ir_ac_handle_t unit, const ir_code_t *code,
+                                  const void *symbols, size_t num_symbols, uint32_t airtime_us)
+{
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    /* Encode current state to IR code */
-    ir_code_t code = {0};
-    esp_err_t err = ir_ac_encode_state(&current_state, &code);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to encode AC state: %s", esp_err_to_name(err));
-        return err;
-    }
-
-    /* Transmit IR code */
-    ESP_LOGI(TAG, "Transmitting AC state: Power=%s, Mode=%s, Temp=%d°C",
-             current_state.power ? "ON" : "OFF",
-             ir_ac_get_mode_name(current_state.mode),
-             current_state.temperature);
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    uint8_t emitter = unit->emitter;
+    xSemaphoreTake(tx_mutex[emitter], portMAX_DELAY);
+    ac_wait_gap(emitter);
 
-    err = ir_transmit(&code);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to transmit AC IR code: %s", esp_err_to_name(err));
+    esp_err_t err = ir_transmit_symbols_async(emitter, code, symbols, num_symbols);
+    if (err == ESP_OK) {
+        /* The frame is still on air; the gap counts from its end */
+        last_tx_end_us[emitter] = esp_timer_get_time() + airtime_us;
     }
 
+    xSemaphoreGive(tx_mutex[emitter]);
+    xSemaphoreGive(unit->lock);
     return err;
 }
 
@@ -667,8 +1066,8 @@ esp_err_t ir_ac_transmit_state(void)
 /**
  * @brief Identify AC protocol from captured IR code
  *
- * Analyzes the captured IR code characteristics (bit length, carrier frequency,
- * protocol type) to identify which AC protocol it matches.
+ * Ranks every AC protocol against the capture's fingerprint and takes the
+ * best one if it clears IR_AC_IDENTIFY_MIN_CONFIDENCE.
  */
 static ir_protocol_t identify_ac_protocol(const ir_code_t *code)
 {
@@ -676,82 +1075,33 @@ static ir_protocol_t identify_ac_protocol(const ir_code_t *code)
         return IR_PROTOCOL_UNKNOWN;
     }
 
-    /* Check if already identified by decoder */
-    if (code->protocol != IR_PROTOCOL_UNKNOWN && code->protocol != IR_PROTOCOL_RAW) {
-        /* Verify it's an AC protocol */
-        switch (code->protocol) {
-            case IR_PROTOCOL_DAIKIN:
-            case IR_PROTOCOL_CARRIER:
-            case IR_PROTOCOL_HITACHI:
-            case IR_PROTOCOL_MITSUBISHI:
-            case IR_PROTOCOL_MIDEA:
-            case IR_PROTOCOL_HAIER:
-            case IR_PROTOCOL_SAMSUNG48:
-            case IR_PROTOCOL_PANASONIC:
-            case IR_PROTOCOL_FUJITSU:
-            case IR_PROTOCOL_LG2:
-                return code->protocol;
-            default:
-                break;
-        }
-    }
-
-    /* Protocol not identified by decoder - try to identify by bit length */
     ESP_LOGI(TAG, "Analyzing captured code: bits=%d, carrier=%dHz", code->bits, code->carrier_freq_hz);
 
-    /* Match by bit length (common AC protocol signatures) */
-    switch (code->bits) {
-        case 28:
-            ESP_LOGI(TAG, "Detected 28-bit frame → LG2 AC protocol");
-            return IR_PROTOCOL_LG2;
-
-        case 48:
-            /* Multiple AC protocols use 48-bit */
-            ESP_LOGI(TAG, "Detected 48-bit frame → Could be Midea, Samsung48, or Panasonic");
-            ESP_LOGI(TAG, "Defaulting to Midea (most common)");
-            return IR_PROTOCOL_MIDEA;
-
-        case 104:
-            ESP_LOGI(TAG, "Detected 104-bit frame → Haier AC protocol");
-            return IR_PROTOCOL_HAIER;
-
-        case 128:
-            ESP_LOGI(TAG, "Detected 128-bit frame → Carrier/Voltas AC protocol");
-            return IR_PROTOCOL_CARRIER;
-
-        case 152:
-            ESP_LOGI(TAG, "Detected 152-bit frame → Mitsubishi AC protocol");
-            return IR_PROTOCOL_MITSUBISHI;
-
-        case 264:
-            ESP_LOGI(TAG, "Detected 264-bit frame → Hitachi AC protocol");
-            return IR_PROTOCOL_HITACHI;
-
-        case 312:
-            ESP_LOGI(TAG, "Detected 312-bit frame → Daikin AC protocol");
-            return IR_PROTOCOL_DAIKIN;
-
-        default:
-            /* Variable length protocols */
-            if (code->bits >= 100 && code->bits <= 150) {
-                ESP_LOGI(TAG, "Detected variable length frame (%d bits) → Fujitsu AC protocol", code->bits);
-                return IR_PROTOCOL_FUJITSU;
-            }
-            break;
+    ir_ac_match_t matches[3];
+    size_t count = ir_ac_identify_protocol(code, matches, sizeof(matches) / sizeof(matches[0]));
+    for (size_t i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "  %u. %s (%u%%)", (unsigned)(i + 1),
+                 ir_get_protocol_name(matches[i].protocol), matches[i].confidence);
     }
 
-    ESP_LOGW(TAG, "Could not identify AC protocol from %d-bit frame", code->bits);
-    return IR_PROTOCOL_UNKNOWN;
+    if (count == 0 || matches[0].confidence < IR_AC_IDENTIFY_MIN_CONFIDENCE) {
+        ESP_LOGW(TAG, "Could not identify AC protocol from %d-bit frame", code->bits);
+        return IR_PROTOCOL_UNKNOWN;
+    }
+    return matches[0].protocol;
 }
 
-esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
+esp_err_t ir_ac_unit_learn_protocol(ir_ac_handle_t unit, uint32_t timeout_ms)
 {
-    if (!is_initialized) {
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
+    /* Send pending setter changes before the learned state replaces them */
+    ir_ac_unit_commit(unit);
+
     ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "AC Protocol Learning Started");
+    ESP_LOGI(TAG, "AC%u Protocol Learning Started", unit->index);
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, "Please press a button on your AC remote");
     ESP_LOGI(TAG, "Recommended: Power ON + Cool 24°C + Auto Fan");
@@ -767,6 +1117,7 @@ esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
         return err;
     } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "AC learning failed: %s", esp_err_to_name(err));
+        ir_code_free(&captured_code);
         return err;
     }
 
@@ -792,6 +1143,7 @@ esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
         ESP_LOGI(TAG, "  - Panasonic (48-bit)");
         ESP_LOGI(TAG, "  - Fujitsu (variable)");
         ESP_LOGI(TAG, "  - LG2 (28-bit)");
+        ir_code_free(&captured_code);
         return ESP_ERR_NOT_FOUND;
     }
 
@@ -800,20 +1152,25 @@ esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
     ESP_LOGI(TAG, "AC Protocol Detected: %s", ir_get_protocol_name(detected_protocol));
     ESP_LOGI(TAG, "========================================");
 
-    err = ir_ac_set_protocol(detected_protocol, 0);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set AC protocol: %s", esp_err_to_name(err));
-        return err;
-    }
+    /* Decode the initial state with the identified protocol (works for
+     * universal decoder captures too) */
+    ac_state_t decoded_state = {0};
+    bool decoded = ir_ac_decode_frame(&captured_code, detected_protocol, &decoded_state) == ESP_OK;
+    ir_code_free(&captured_code);
+
+    /* Protocol, initial state and save in one go, so no setter or remote
+     * frame lands between them */
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
 
-    /* Mark AC as configured */
-    current_state.is_learned = true;
-    snprintf(current_state.brand, sizeof(current_state.brand), "%s",
+    unit->state.protocol = detected_protocol;
+    unit->state.protocol_variant = 0;
+    unit->state.is_learned = true;
+    snprintf(unit->state.brand, sizeof(unit->state.brand), "%s",
+             ir_get_protocol_name(detected_protocol));
+    ESP_LOGI(TAG, "AC%u protocol set to: %s (variant 0)", unit->index,
              ir_get_protocol_name(detected_protocol));
 
-    /* Try to decode initial state (optional - may not be fully implemented) */
-    ac_state_t decoded_state = {0};
-    if (ir_ac_decode_state(&captured_code, &decoded_state) == ESP_OK) {
+    if (decoded) {
         ESP_LOGI(TAG, "Initial AC state decoded:");
         ESP_LOGI(TAG, "  Power: %s", decoded_state.power ? "ON" : "OFF");
         ESP_LOGI(TAG, "  Mode: %s", ir_ac_get_mode_name(decoded_state.mode));
@@ -821,11 +1178,15 @@ esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
         ESP_LOGI(TAG, "  Fan Speed: %s", ir_ac_get_fan_speed_name(decoded_state.fan_speed));
 
         /* Update current state with decoded values */
-        current_state.power = decoded_state.power;
-        current_state.mode = decoded_state.mode;
-        current_state.temperature = decoded_state.temperature;
-        current_state.fan_speed = decoded_state.fan_speed;
-        current_state.swing = decoded_state.swing;
+        unit->state.power = decoded_state.power;
+        unit->state.mode = decoded_state.mode;
+        unit->state.temperature = decoded_state.temperature;
+        unit->state.fan_speed = decoded_state.fan_speed;
+        unit->state.swing = decoded_state.swing;
+        unit->state.turbo = decoded_state.turbo;
+        unit->state.quiet = decoded_state.quiet;
+        unit->state.econo = decoded_state.econo;
+        unit->state.sleep = decoded_state.sleep;
     } else {
         ESP_LOGW(TAG, "Could not decode initial state from captured frame");
         ESP_LOGI(TAG, "Using default state: Power=OFF, Mode=Cool, Temp=24°C");
@@ -833,12 +1194,13 @@ esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
     }
 
     /* Save configuration to NVS */
-    err = ir_ac_save_state();
+    err = ac_unit_save(unit);
+    xSemaphoreGive(unit->lock);
     if (err != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to save AC configuration: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "AC configuration saved to NVS");
+        ESP_LOGE(TAG, "Failed to save AC configuration: %s", esp_err_to_name(err));
+        return err;
     }
+    ESP_LOGI(TAG, "AC configuration saved to NVS");
 
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, "AC Learning Complete!");
@@ -848,87 +1210,491 @@ esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
     return ESP_OK;
 }
 
+esp_err_t ir_ac_learn_protocol(uint32_t timeout_ms)
+{
+    return ir_ac_unit_learn_protocol(ir_ac_get_unit(0), timeout_ms);
+}
+
 /* ============================================================================
- * NVS STORAGE
+ * REMOTE SYNC
  * ============================================================================ */
 
-esp_err_t ir_ac_save_state(void)
+/**
+ * @brief Build the fingerprint of a unit's protocol
+ *
+ * Same frame layout as the transmit template: per frame a header, the
+ * data bits LSB first and a stop mark whose space is the frame gap.
+ *
+ * @return false if frames of @p protocol cannot be read this way
+ */
+static bool shadow_prepare(ac_shadow_t *shadow, ir_protocol_t protocol)
+{
+    if (shadow->protocol == protocol) {
+        return shadow->map != NULL;
+    }
+
+    shadow->protocol = protocol;
+    shadow->map = NULL;
+
+    const ir_protocol_constants_t *proto = ir_get_protocol_constants(protocol);
+    const ac_frame_map_t *map = ir_ac_frame_get_map(protocol);
+    if (!proto || !map || proto->header_mark_us == 0 || proto->bit_mark_us == 0 ||
+        (proto->flags & (PROTOCOL_IS_MSB_FIRST | PROTOCOL_IS_PULSE_WIDTH | PROTOCOL_IS_BIPHASE))) {
+        ESP_LOGD(TAG, "No remote sync for %s", ir_get_protocol_name(protocol));
+        return false;
+    }
+
+    uint16_t total_bits = map->bits ? map->bits : map->num_bytes * 8;
+    shadow->num_frames = map->num_frames > 1 ? map->num_frames : 1;
+    shadow->min_symbols = 0;
+    uint16_t first_bit = 0;
+    for (uint8_t f = 0; f < shadow->num_frames; f++) {
+        bool last = (f + 1 == shadow->num_frames);
+        shadow->frame_bits[f] = last ? total_bits - first_bit : map->frame_bytes[f] * 8;
+        first_bit += shadow->frame_bits[f];
+        shadow->min_symbols += 1 + shadow->frame_bits[f] + 1;  // Header, bits, stop
+    }
+
+    /* Brands sharing header timing (Midea, Samsung48) differ in the ID byte */
+    shadow->check_id = map->checksum == AC_CHECKSUM_NONE || map->checksum_byte != 0;
+    for (uint8_t i = 0; i < map->num_fields; i++) {
+        if (map->fields[i].byte == 0) {
+            shadow->check_id = false;
+        }
+    }
+
+    shadow->proto = proto;
+    shadow->one_threshold_us = (proto->one_space_us + proto->zero_space_us) / 2;
+    shadow->one_space_max_us = proto->one_space_us + proto->one_space_us / 2;
+    shadow->map = map;
+    return true;
+}
+
+/**
+ * @brief Read one frame of a fingerprinted protocol, starting at symbol @p pos
+ *
+ * ORs the bits into @p bytes from bit @p bit on (the frame's bytes must be
+ * clear) and advances @p pos and @p bit past the frame.
+ */
+static bool shadow_read_frame(const ac_shadow_t *shadow, uint8_t frame,
+                              const rmt_symbol_word_t *symbols, size_t num_symbols,
+                              size_t *pos, uint8_t *bytes, uint16_t *bit)
+{
+    const ir_protocol_constants_t *proto = shadow->proto;
+    size_t p = *pos;
+    uint16_t b = *bit;
+
+    if (num_symbols - p < 1 + (size_t)shadow->frame_bits[frame] + 1) {
+        return false;
+    }
+
+    if (!ir_timing_matches(ir_get_mark_us(&symbols[p]), proto->header_mark_us) ||
+        !ir_timing_matches(ir_get_space_us(&symbols[p]), proto->header_space_us)) {
+        return false;
+    }
+    p++;
+
+    for (uint16_t k = 0; k < shadow->frame_bits[frame]; k++, p++, b++) {
+        uint16_t space = ir_get_space_us(&symbols[p]);
+        if (!ir_timing_matches(ir_get_mark_us(&symbols[p]), proto->bit_mark_us) ||
+            space > shadow->one_space_max_us) {
+            return false;
+        }
+        if (space > shadow->one_threshold_us) {
+            bytes[b >> 3] |= 1u << (b & 7);
+        }
+    }
+    p++;        // Stop mark; its space is the frame gap or the idle end
+
+    *pos = p;
+    *bit = b;
+    return true;
+}
+
+/**
+ * @brief Read the frame bytes of a fingerprinted protocol from raw symbols
+ *
+ * Stops at the first symbol that does not fit, so foreign frames cost a
+ * header compare.
+ */
+static bool shadow_read(const ac_shadow_t *shadow, const rmt_symbol_word_t *symbols,
+                        size_t num_symbols, uint8_t *bytes)
+{
+    size_t pos = 0;
+    uint16_t bit = 0;
+
+    if (num_symbols < shadow->min_symbols) {
+        return false;
+    }
+
+    memset(bytes, 0, shadow->map->num_bytes);
+    for (uint8_t f = 0; f < shadow->num_frames; f++) {
+        if (!shadow_read_frame(shadow, f, symbols, num_symbols, &pos, bytes, &bit)) {
+            return false;
+        }
+    }
+
+    return !shadow->check_id || bytes[0] == shadow->map->template_bytes[0];
+}
+
+/**
+ * @brief Longest a multi-frame press can take from one capture to the end of @p frame
+ *
+ * The previous capture was handed over after the RX idle timeout, which
+ * is part of the frame gap, so gap plus airtime is an upper bound.
+ */
+static int64_t shadow_frame_window_us(const ac_shadow_t *shadow, uint8_t frame)
+{
+    const ir_protocol_constants_t *proto = shadow->proto;
+    return (int64_t)shadow->map->frame_gap_us + proto->header_mark_us + proto->header_space_us +
+           (int64_t)shadow->frame_bits[frame] * (proto->bit_mark_us + shadow->one_space_max_us) +
+           proto->bit_mark_us + AC_RX_FRAME_SLACK_US;
+}
+
+/**
+ * @brief Collect a multi-frame press that arrived one frame per capture
+ *
+ * A capture holding frame 0 starts a press; the next frame must follow
+ * within shadow_frame_window_us() or the press is dropped. Units sharing
+ * a protocol see the same capture, so a capture is applied once and
+ * later units get the same answer.
+ *
+ * @return true when @p capture completed a press (its bytes are in @p bytes)
+ */
+static bool shadow_collect(const ac_shadow_t *shadow, const rmt_symbol_word_t *symbols,
+                           size_t num_symbols, uint32_t capture, uint8_t *bytes)
+{
+    const ac_frame_map_t *map = shadow->map;
+
+    if (shadow->num_frames < 2) {
+        return false;
+    }
+
+    if (rx_partial.map != map || rx_partial.capture != capture) {
+        int64_t now = esp_timer_get_time();
+        size_t pos = 0;
+        uint16_t bit = rx_partial.next_bit;
+        bool continued = false;
+        if (rx_partial.map == map && rx_partial.next_frame < shadow->num_frames) {
+            continued = now <= rx_partial.deadline_us &&
+                        shadow_read_frame(shadow, rx_partial.next_frame, symbols, num_symbols,
+                                          &pos, rx_partial.bytes, &bit);
+            if (!continued) {
+                rx_partial.map = NULL;      // Late or not the next frame; bits may be half written
+            }
+        }
+
+        if (continued) {
+            rx_partial.next_frame++;
+        } else {
+            // Only a first frame can start a press; others leave a press of another protocol alone
+            memset(bytes, 0, map->num_bytes);
+            pos = 0;
+            bit = 0;
+            if (!shadow_read_frame(shadow, 0, symbols, num_symbols, &pos, bytes, &bit) ||
+                (shadow->check_id && bytes[0] != map->template_bytes[0])) {
+                return false;
+            }
+            memcpy(rx_partial.bytes, bytes, map->num_bytes);
+            rx_partial.map = map;
+            rx_partial.next_frame = 1;
+        }
+
+        rx_partial.next_bit = bit;
+        rx_partial.capture = capture;
+        if (rx_partial.next_frame < shadow->num_frames) {
+            rx_partial.deadline_us = now + shadow_frame_window_us(shadow, rx_partial.next_frame);
+        }
+    }
+
+    if (rx_partial.next_frame < shadow->num_frames) {
+        return false;
+    }
+    memcpy(bytes, rx_partial.bytes, map->num_bytes);
+    return true;
+}
+
+/**
+ * @brief Apply a frame from the remote to one unit
+ *
+ * @return false if the frame fails the unit's checksum
+ */
+static bool ac_unit_sync(ir_ac_handle_t unit, const uint8_t *bytes)
+{
+    const ac_frame_map_t *map = unit->shadow.map;
+
+    /* A commit holds the lock across its frame and flash save: do not stall receiving */
+    if (xSemaphoreTake(unit->lock, pdMS_TO_TICKS(AC_RX_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "AC%u busy committing, %s frame from remote dropped", unit->index, map->name);
+        return true;
+    }
+
+    if (unit->state.protocol != unit->shadow.protocol) {
+        xSemaphoreGive(unit->lock);
+        return false;
+    }
+
+    ac_state_t previous, synced, sent;
+    memcpy(&previous, &unit->state, sizeof(ac_state_t));
+    memcpy(&synced, &unit->state, sizeof(ac_state_t));
+    if (ir_ac_frame_decode(map, bytes, map->num_bytes, &synced) != ESP_OK) {
+        xSemaphoreGive(unit->lock);
+        ESP_LOGD(TAG, "%s frame from remote failed its checksum", map->name);
+        return false;
+    }
+
+    /* Compare with what our own last frame said, not with values the
+     * protocol cannot carry */
+    memcpy(&sent, &unit->state, sizeof(ac_state_t));
+    ir_ac_frame_normalize(map, &sent);
+    bool changed = memcmp(&sent, &synced, sizeof(ac_state_t)) != 0;
+
+    if (changed) {
+        memcpy(&unit->state, &synced, sizeof(ac_state_t));
+        unit->dirty_fields = 0;
+        unit->save_pending = true;
+        ac_schedule_commit(unit, 0);
+        ac_schedule_sync(unit, &previous);
+    }
+
+    xSemaphoreGive(unit->lock);
+
+    if (!changed) {
+        ESP_LOGD(TAG, "AC%u: %s frame from remote matches current state", unit->index, map->name);
+        return true;
+    }
+
+    ESP_LOGI(TAG, "AC%u state from remote: Power=%s, Mode=%s, Temp=%d°C, Fan=%s, Swing=%s",
+             unit->index,
+             synced.power ? "ON" : "OFF",
+             ir_ac_get_mode_name(synced.mode),
+             synced.temperature,
+             ir_ac_get_fan_speed_name(synced.fan_speed),
+             ir_ac_get_swing_name(synced.swing));
+    return true;
+}
+
+/**
+ * @brief Receive hook: take frames of any configured unit's protocol
+ *
+ * A frame that reads and passes its checksum is consumed even when it
+ * changes nothing, so repeated presses skip the decoder chain too.
+ * Pending app changes are dropped: the remote spoke last and the AC has
+ * its state, so resending them would undo the user's press.
+ *
+ * Units of the same brand cannot tell whose remote sent a frame, and an
+ * IR remote reaches every unit in the room, so the frame is applied to
+ * all of them.
+ *
+ * Multi-frame presses split by the RX idle timeout are collected across
+ * captures and applied when their last frame arrives; the earlier
+ * captures go on to the decoder chain as before.
+ */
+static bool ac_rx_hook(const void *symbols, size_t num_symbols, void *arg)
 {
     if (!is_initialized) {
+        return false;
+    }
+
+    uint8_t bytes[AC_FRAME_MAX_BYTES];
+    const ac_frame_map_t *read_map = NULL;     // Protocol bytes currently holds
+    bool taken = false;
+    uint32_t capture = ++rx_captures;
+
+    for (uint8_t i = 0; i < num_units; i++) {
+        ir_ac_handle_t unit = &units[i];
+        if (!ir_ac_unit_is_configured(unit) || !shadow_prepare(&unit->shadow, unit->state.protocol)) {
+            continue;
+        }
+
+        if (unit->shadow.map != read_map) {
+            if (!shadow_read(&unit->shadow, symbols, num_symbols, bytes) &&
+                !shadow_collect(&unit->shadow, symbols, num_symbols, capture, bytes)) {
+                continue;
+            }
+            read_map = unit->shadow.map;
+        }
+
+        taken |= ac_unit_sync(unit, bytes);
+    }
+    return taken;
+}
+
+esp_err_t ir_ac_register_sync_cb(ir_ac_sync_cb_t cb, void *arg)
+{
+    sync_cb_arg = arg;
+    sync_cb = cb;
+    return ESP_OK;
+}
+
+esp_err_t ir_ac_unit_adopt_state(ir_ac_handle_t unit, const ac_state_t *state)
+{
+    if (!is_initialized || !unit || !state) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    /* Save AC state to NVS */
-    esp_err_t err = nvs_set_blob(nvs_handle_ac, NVS_KEY_AC_STATE, &current_state, sizeof(ac_state_t));
+    esp_err_t err = ir_ac_validate_state(state);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
+    ac_state_t previous, adopted;
+    memcpy(&previous, &unit->state, sizeof(ac_state_t));
+    memcpy(&adopted, &unit->state, sizeof(ac_state_t));
+    adopted.power = state->power;
+    adopted.mode = state->mode;
+    adopted.temperature = state->temperature;
+    adopted.fan_speed = state->fan_speed;
+    adopted.swing = state->swing;
+
+    bool changed = memcmp(&previous, &adopted, sizeof(ac_state_t)) != 0;
+    if (changed) {
+        memcpy(&unit->state, &adopted, sizeof(ac_state_t));
+        unit->dirty_fields = 0;
+        unit->save_pending = true;
+        ac_schedule_commit(unit, 0);
+        ac_schedule_sync(unit, &previous);
+    }
+
+    xSemaphoreGive(unit->lock);
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * NVS STORAGE
+ * ============================================================================ */
+
+/* Caller holds unit->lock */
+static esp_err_t ac_unit_save(ir_ac_handle_t unit)
+{
+    /* One ring log record, or an NVS write */
+    esp_err_t err = ir_storage_set(ac_ns, unit->nvs_key, &unit->state, sizeof(ac_state_t));
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to save AC state: %s", esp_err_to_name(err));
         return err;
     }
 
-    /* Commit to NVS */
-    err = nvs_commit(nvs_handle_ac);
+    /* Commit (nothing to do for the ring log) */
+    err = ir_storage_commit(ac_ns);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
         return err;
     }
 
-    ESP_LOGD(TAG, "AC state saved to NVS");
+    ESP_LOGD(TAG, "AC%u state saved", unit->index);
     return ESP_OK;
 }
 
-esp_err_t ir_ac_load_state(void)
+esp_err_t ir_ac_unit_save_state(ir_ac_handle_t unit)
 {
-    if (!is_initialized) {
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    /* Load AC state from NVS */
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    esp_err_t err = ac_unit_save(unit);
+    xSemaphoreGive(unit->lock);
+    return err;
+}
+
+static esp_err_t ac_unit_load(ir_ac_handle_t unit)
+{
     size_t required_size = sizeof(ac_state_t);
-    esp_err_t err = nvs_get_blob(nvs_handle_ac, NVS_KEY_AC_STATE, &current_state, &required_size);
+    esp_err_t err = ir_storage_get(ac_ns, unit->nvs_key, &unit->state, &required_size);
+
+    /* First boot with the ring log: move the state saved in NVS */
+    if (err == ESP_ERR_NOT_FOUND && legacy_ac_ns != NULL) {
+        required_size = sizeof(ac_state_t);
+        err = ir_storage_get(legacy_ac_ns, unit->nvs_key, &unit->state, &required_size);
+        if (err == ESP_OK && ir_storage_set(ac_ns, unit->nvs_key, &unit->state, required_size) == ESP_OK) {
+            ESP_LOGI(TAG, "AC%u state moved from NVS to %s", unit->index, IR_STORAGE_LOG_PARTITION);
+            ir_storage_erase(legacy_ac_ns, unit->nvs_key);
+            ir_storage_commit(legacy_ac_ns);
+        }
+    }
 
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGD(TAG, "No saved AC state found");
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGD(TAG, "No saved AC%u state found", unit->index);
         return ESP_ERR_NOT_FOUND;
     } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to load AC state: %s", esp_err_to_name(err));
         return err;
     }
 
-    ESP_LOGI(TAG, "AC state loaded from NVS (Protocol: %s, Power: %s, Temp: %d°C)",
-             ir_get_protocol_name(current_state.protocol),
-             current_state.power ? "ON" : "OFF",
-             current_state.temperature);
+    ESP_LOGI(TAG, "AC%u state loaded (Protocol: %s, Power: %s, Temp: %d°C)", unit->index,
+             ir_get_protocol_name(unit->state.protocol),
+             unit->state.power ? "ON" : "OFF",
+             unit->state.temperature);
 
     return ESP_OK;
 }
 
-esp_err_t ir_ac_clear_state(void)
+esp_err_t ir_ac_unit_load_state(ir_ac_handle_t unit)
 {
-    if (!is_initialized) {
+    if (!is_initialized || !unit) {
         return ESP_ERR_INVALID_STATE;
     }
 
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+    esp_err_t err = ac_unit_load(unit);
+    xSemaphoreGive(unit->lock);
+    return err;
+}
+
+esp_err_t ir_ac_unit_clear_state(ir_ac_handle_t unit)
+{
+    if (!is_initialized || !unit) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(unit->lock, portMAX_DELAY);
+
     /* Erase from NVS */
-    esp_err_t err = nvs_erase_key(nvs_handle_ac, NVS_KEY_AC_STATE);
-    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+    esp_err_t err = ir_storage_erase(ac_ns, unit->nvs_key);
+    if (err != ESP_OK && err != ESP_ERR_NOT_FOUND) {
         ESP_LOGE(TAG, "Failed to clear AC state: %s", esp_err_to_name(err));
+        xSemaphoreGive(unit->lock);
         return err;
     }
 
     /* Commit */
-    err = nvs_commit(nvs_handle_ac);
+    err = ir_storage_commit(ac_ns);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
+        xSemaphoreGive(unit->lock);
         return err;
     }
 
-    /* Reset to default state */
-    ir_ac_get_default_state(&current_state);
+    /* Reset to default state, dropping any pending commit */
+    esp_timer_stop(unit->commit_timer);
+    atomic_store(&unit->commit_due, false);
+    ir_ac_get_default_state(&unit->state);
+    unit->dirty_fields = 0;
+    unit->save_pending = false;
+    ir_ac_frame_cache_reset(unit->cache);
 
-    ESP_LOGI(TAG, "AC configuration cleared (factory reset)");
+    ESP_LOGI(TAG, "AC%u configuration cleared (factory reset)", unit->index);
+    xSemaphoreGive(unit->lock);
     return ESP_OK;
 }
 
+esp_err_t ir_ac_save_state(void)
+{
+    return ir_ac_unit_save_state(ir_ac_get_unit(0));
+}
+
+esp_err_t ir_ac_load_state(void)
+{
+    return ir_ac_unit_load_state(ir_ac_get_unit(0));
+}
+
+esp_err_t ir_ac_clear_state(void)
+{
+    return ir_ac_unit_clear_state(ir_ac_get_unit(0));
+}
+
 /* ============================================================================
  * UTILITY FUNCTIONS
  * ============================================================================ */
@@ -10,10 +10,13 @@
 
 #include "ir_action.h"
 #include "ir_control.h"
+#include "ir_code.h"
+#include "ir_code_table.h"
+#include "ir_scene.h"
+#include "ir_storage.h"
 #include "esp_log.h"
-#include "nvs_flash.h"
-#include "nvs.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include <string.h>
 
@@ -25,9 +28,18 @@ static const char *TAG = "ir_action";
 /* Maximum NVS key length */
 #define MAX_NVS_KEY_LEN         15
 
+/* NVS key for the device-to-emitter bindings (one byte per device type) */
+#define NVS_KEY_EMITTERS        "emitters"
+
 /* Internal state */
 static bool is_initialized = false;
-static nvs_handle_t nvs_handle_action = 0;
+static ir_storage_ns_t actions_ns = NULL;
+static uint8_t device_emitters[IR_DEVICE_MAX];
+
+/* Saves, clears and the table fill in action_transmit(); recursive because
+ * ir_action_load() re-saves migrated records */
+static SemaphoreHandle_t actions_lock = NULL;
+static uint32_t actions_generation = 0;     // Bumped under actions_lock on every store change
 
 /* Current learning state */
 static ir_device_type_t learning_device = IR_DEVICE_NONE;
@@ -174,25 +186,36 @@ esp_err_t ir_action_init(void)
         return ESP_OK;
     }
 
-    /* Initialize NVS partition if needed */
-    esp_err_t err = nvs_flash_init_partition("ir_storage");
-    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_LOGW(TAG, "ir_storage partition needs to be erased, erasing...");
-        ESP_ERROR_CHECK(nvs_flash_erase_partition("ir_storage"));
-        err = nvs_flash_init_partition("ir_storage");
+    /* Shared storage (already initialized when ir_control_init() ran first) */
+    esp_err_t err = ir_storage_init();
+    if (err == ESP_OK) {
+        err = ir_storage_open(NVS_NAMESPACE_ACTIONS, &actions_ns);
     }
-    if (err != ESP_OK && err != ESP_ERR_NVS_PART_NOT_FOUND) {
-        ESP_LOGE(TAG, "Failed to initialize ir_storage partition: %s", esp_err_to_name(err));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open action storage: %s", esp_err_to_name(err));
         return err;
     }
 
-    /* Open NVS namespace for actions from dedicated ir_storage partition */
-    err = nvs_open_from_partition("ir_storage", NVS_NAMESPACE_ACTIONS, NVS_READWRITE, &nvs_handle_action);
+    /* Executed actions stay resident in the shared code table */
+    err = ir_code_table_init();
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace from ir_storage partition: %s", esp_err_to_name(err));
         return err;
     }
 
+    actions_lock = xSemaphoreCreateRecursiveMutex();
+    if (actions_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Emitter bindings; missing key means every device on the default emitter */
+    size_t emitters_len = sizeof(device_emitters);
+    memset(device_emitters, IR_TX_EMITTER_DEFAULT, sizeof(device_emitters));
+    err = ir_storage_get(actions_ns, NVS_KEY_EMITTERS, device_emitters, &emitters_len);
+    if (err != ESP_OK && err != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Failed to load emitter bindings: %s", esp_err_to_name(err));
+        memset(device_emitters, IR_TX_EMITTER_DEFAULT, sizeof(device_emitters));
+    }
+
     is_initialized = true;
     ESP_LOGI(TAG, "Action mapping system initialized");
     return ESP_OK;
@@ -291,16 +314,69 @@ esp_err_t ir_action_cancel_learning(void)
  * ACTION EXECUTION
  * ============================================================================ */
 
-esp_err_t ir_action_execute(ir_device_type_t device, ir_action_t action)
+/* Emitter bound to a device; bindings to emitters not fitted fall back to the default */
+static uint8_t action_emitter(ir_device_type_t device)
+{
+    uint8_t emitter = (device > IR_DEVICE_NONE && device < IR_DEVICE_MAX) ?
+                      device_emitters[device] : IR_TX_EMITTER_DEFAULT;
+    if (emitter != IR_TX_EMITTER_ALL && emitter >= ir_tx_get_num_emitters()) {
+        ESP_LOGW(TAG, "%s bound to missing emitter %d, using default",
+                 ir_action_get_device_name(device), emitter);
+        emitter = IR_TX_EMITTER_DEFAULT;
+    }
+    return emitter;
+}
+
+/* Code table row of a device; the IR_DEVICE_NONE row holds the legacy buttons */
+static bool action_has_table_row(ir_device_type_t device)
+{
+    return device > IR_DEVICE_NONE && device < IR_DEVICE_MAX;
+}
+
+/* Send on one emitter, or broadcast on all (broadcasts always wait) */
+static esp_err_t action_send(uint8_t emitter, const ir_code_t *code, bool wait)
+{
+    if (emitter == IR_TX_EMITTER_ALL) {
+        return ir_transmit_broadcast((1u << ir_tx_get_num_emitters()) - 1, code);
+    }
+    return wait ? ir_transmit_on(emitter, code) : ir_transmit_async(emitter, code);
+}
+
+/*
+ * Send an action on its device's emitter, optionally without waiting.
+ * Resident codes go straight from the code table; others are loaded from
+ * storage once and made resident for the next time.
+ */
+static esp_err_t action_transmit(ir_device_type_t device, ir_action_t action, bool wait)
 {
     if (!is_initialized) {
         ESP_LOGE(TAG, "Action system not initialized");
         return ESP_ERR_INVALID_STATE;
     }
 
+    uint8_t emitter = action_emitter(device);
+    esp_err_t err;
+
+    /* Broadcasts synchronize several channels and take the storage path */
+    if (emitter != IR_TX_EMITTER_ALL && action_has_table_row(device)) {
+        err = ir_code_table_transmit(device, action, emitter, wait);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Executed action: %s.%s",
+                     ir_action_get_device_name(device),
+                     ir_action_get_action_name(action));
+            return ESP_OK;
+        } else if (err != ESP_ERR_NOT_FOUND && err != ESP_ERR_INVALID_ARG) {
+            ESP_LOGE(TAG, "Failed to transmit IR code: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+
     /* Load IR code for this action */
     ir_code_t code = {0};
-    esp_err_t err = ir_action_load(device, action, &code);
+    xSemaphoreTakeRecursive(actions_lock, portMAX_DELAY);
+    err = ir_action_load(device, action, &code);
+    uint32_t generation = actions_generation;
+    xSemaphoreGiveRecursive(actions_lock);
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "Action %s.%s not learned",
                  ir_action_get_device_name(device),
@@ -313,14 +389,37 @@ esp_err_t ir_action_execute(ir_device_type_t device, ir_action_t action)
              ir_action_get_device_name(device),
              ir_action_get_action_name(action));
 
-    err = ir_transmit(&code);
+    err = action_send(emitter, &code, wait);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to transmit IR code: %s", esp_err_to_name(err));
     }
 
+    /* Arena full is not an error: the code just stays on the storage path.
+     * A save or clear during the send already changed the stored code, and
+     * this copy must not replace what it left in the table. */
+    if (action_has_table_row(device)) {
+        xSemaphoreTakeRecursive(actions_lock, portMAX_DELAY);
+        if (generation == actions_generation) {
+            ir_code_table_put(device, action, &code);
+        }
+        xSemaphoreGiveRecursive(actions_lock);
+    }
+
+    /* ir_transmit_async() keeps its own copy of the frame */
+    ir_code_free(&code);
     return err;
 }
 
+esp_err_t ir_action_execute(ir_device_type_t device, ir_action_t action)
+{
+    return action_transmit(device, action, true);
+}
+
+esp_err_t ir_action_execute_async(ir_device_type_t device, ir_action_t action)
+{
+    return action_transmit(device, action, false);
+}
+
 esp_err_t ir_action_execute_repeat(ir_device_type_t device, ir_action_t action,
                                      uint8_t repeat_count, uint16_t repeat_interval_ms)
 {
@@ -347,10 +446,12 @@ esp_err_t ir_action_execute_repeat(ir_device_type_t device, ir_action_t action,
              repeat_count, interval);
 
     /* Transmit multiple times */
+    uint8_t emitter = action_emitter(device);
     for (uint8_t i = 0; i < repeat_count; i++) {
-        err = ir_transmit(&code);
+        err = action_send(emitter, &code, true);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Failed to transmit repeat %d: %s", i, esp_err_to_name(err));
+            ir_code_free(&code);
             return err;
         }
 
@@ -359,6 +460,7 @@ esp_err_t ir_action_execute_repeat(ir_device_type_t device, ir_action_t action,
         }
     }
 
+    ir_code_free(&code);
     return ESP_OK;
 }
 
@@ -388,11 +490,9 @@ static esp_err_t generate_nvs_key_internal(ir_device_type_t device, ir_action_t
     return ESP_OK;
 }
 
-esp_err_t ir_action_save(ir_device_type_t device, ir_action_t action, const ir_code_t *code)
+/* Write one action record and refresh its table slot (actions_lock held) */
+static esp_err_t action_store(ir_device_type_t device, ir_action_t action, const ir_code_t *code)
 {
-    if (!is_initialized || !code) {
-        return ESP_ERR_INVALID_ARG;
-    }
 
     /* Generate NVS key */
     char nvs_key[MAX_NVS_KEY_LEN + 1];
@@ -401,9 +501,15 @@ esp_err_t ir_action_save(ir_device_type_t device, ir_action_t action, const ir_c
         return err;
     }
 
-    /* Save IR code to NVS */
-    /* Note: For RAW codes, we need to save raw_data separately */
-    err = nvs_set_blob(nvs_handle_action, nvs_key, code, sizeof(ir_code_t));
+    /* Save versioned record to NVS (RAW symbols go under a separate key) */
+    uint8_t record[IR_CODE_RECORD_MAX_SIZE];
+    size_t record_len = ir_code_serialize(code, record, sizeof(record));
+    if (record_len == 0) {
+        ESP_LOGE(TAG, "Action %s payload too long to save (%d bits)", nvs_key, code->bits);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    err = ir_storage_set(actions_ns, nvs_key, record, record_len);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to save action %s: %s", nvs_key, esp_err_to_name(err));
         return err;
@@ -414,21 +520,26 @@ esp_err_t ir_action_save(ir_device_type_t device, ir_action_t action, const ir_c
         char raw_key[MAX_NVS_KEY_LEN + 5];
         snprintf(raw_key, sizeof(raw_key), "%s_raw", nvs_key);
 
-        err = nvs_set_blob(nvs_handle_action, raw_key, code->raw_data,
-                            code->raw_length * sizeof(uint16_t));
+        err = ir_storage_set(actions_ns, raw_key, code->raw_data,
+                            code->raw_length * IR_CODE_RAW_SYMBOL_BYTES);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Failed to save RAW data for %s: %s", nvs_key, esp_err_to_name(err));
             return err;
         }
     }
 
-    /* Commit to NVS */
-    err = nvs_commit(nvs_handle_action);
+    /* Commit to NVS (deferred inside an ir_storage batch) */
+    err = ir_storage_commit(actions_ns);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
         return err;
     }
 
+    /* Replace a resident copy; not-yet-executed actions are loaded on first use */
+    if (action_has_table_row(device) && ir_code_table_contains(device, action)) {
+        ir_code_table_put(device, action, code);
+    }
+
     ESP_LOGI(TAG, "Saved action %s.%s to NVS (key: %s)",
              ir_action_get_device_name(device),
              ir_action_get_action_name(action),
@@ -437,6 +548,23 @@ esp_err_t ir_action_save(ir_device_type_t device, ir_action_t action, const ir_c
     return ESP_OK;
 }
 
+esp_err_t ir_action_save(ir_device_type_t device, ir_action_t action, const ir_code_t *code)
+{
+    if (!is_initialized || !code) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTakeRecursive(actions_lock, portMAX_DELAY);
+    esp_err_t err = action_store(device, action, code);
+    actions_generation++;
+    xSemaphoreGiveRecursive(actions_lock);
+
+    if (err == ESP_OK) {
+        ir_scene_refresh_action(device, action);   // Scenes using it hold the old frame
+    }
+    return err;
+}
+
 esp_err_t ir_action_load(ir_device_type_t device, ir_action_t action, ir_code_t *code)
 {
     if (!is_initialized || !code) {
@@ -450,36 +578,70 @@ esp_err_t ir_action_load(ir_device_type_t device, ir_action_t action, ir_code_t
         return err;
     }
 
-    /* Load IR code from NVS */
-    size_t required_size = sizeof(ir_code_t);
-    err = nvs_get_blob(nvs_handle_action, nvs_key, code, &required_size);
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
+    /* Load IR code record from NVS */
+    uint8_t record[IR_CODE_RECORD_MAX_SIZE];
+    size_t record_len = sizeof(record);
+    err = ir_storage_get(actions_ns, nvs_key, record, &record_len);
+    if (err == ESP_ERR_NOT_FOUND) {
         return ESP_ERR_NOT_FOUND;
     } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to load action %s: %s", nvs_key, esp_err_to_name(err));
         return err;
     }
 
-    /* If RAW protocol, load raw data array */
+    bool migrated = false;
+    err = ir_code_deserialize(record, record_len, code, &migrated);
+    if (err == ESP_ERR_INVALID_VERSION && migrated) {
+        ESP_LOGW(TAG, "Action %s was saved in a format that cannot be migrated; learn it again", nvs_key);
+        return err;
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Unreadable record for action %s: %s", nvs_key, esp_err_to_name(err));
+        return err;
+    }
+
+    /* If RAW protocol, load raw symbol array */
     if (code->protocol == IR_PROTOCOL_RAW && code->raw_length > 0) {
         char raw_key[MAX_NVS_KEY_LEN + 5];
         snprintf(raw_key, sizeof(raw_key), "%s_raw", nvs_key);
 
-        /* Allocate memory for raw data */
-        code->raw_data = (uint16_t*)malloc(code->raw_length * sizeof(uint16_t));
+        size_t raw_size = 0;
+        err = ir_storage_get(actions_ns, raw_key, NULL, &raw_size);
+        if (err != ESP_OK || raw_size < IR_CODE_RAW_SYMBOL_BYTES) {
+            ESP_LOGE(TAG, "Missing RAW data for %s", nvs_key);
+            ir_code_free(code);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        /* Records before v2 saved 2 bytes of each 4-byte symbol: the capture is lost */
+        if (raw_size != (size_t)code->raw_length * IR_CODE_RAW_SYMBOL_BYTES) {
+            ESP_LOGW(TAG, "RAW data of action %s is %s; learn it again", nvs_key,
+                     migrated ? "truncated (saved before record v2)" : "inconsistent");
+            ir_code_free(code);
+            return ESP_ERR_INVALID_VERSION;
+        }
+
+        code->raw_data = (uint16_t*)malloc(raw_size);
         if (!code->raw_data) {
             ESP_LOGE(TAG, "Failed to allocate memory for RAW data");
+            ir_code_free(code);
             return ESP_ERR_NO_MEM;
         }
 
-        size_t raw_size = code->raw_length * sizeof(uint16_t);
-        err = nvs_get_blob(nvs_handle_action, raw_key, code->raw_data, &raw_size);
+        err = ir_storage_get(actions_ns, raw_key, code->raw_data, &raw_size);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Failed to load RAW data for %s: %s", nvs_key, esp_err_to_name(err));
-            free(code->raw_data);
-            code->raw_data = NULL;
+            ir_code_free(code);
             return err;
         }
+        code->raw_length = raw_size / IR_CODE_RAW_SYMBOL_BYTES;
+    }
+
+    if (migrated) {
+        ESP_LOGI(TAG, "Migrating action %s to code record v%d", nvs_key, IR_CODE_RECORD_VERSION);
+        /* Same code in the new format: no scene refresh (a scene may be compiling this load) */
+        xSemaphoreTakeRecursive(actions_lock, portMAX_DELAY);
+        action_store(device, action, code);
+        xSemaphoreGiveRecursive(actions_lock);
     }
 
     ESP_LOGD(TAG, "Loaded action %s.%s from NVS (protocol: %s)",
@@ -493,15 +655,14 @@ esp_err_t ir_action_load(ir_device_type_t device, ir_action_t action, ir_code_t
 bool ir_action_is_learned(ir_device_type_t device, ir_action_t action)
 {
     ir_code_t code = {0};
-    return (ir_action_load(device, action, &code) == ESP_OK);
+    bool learned = (ir_action_load(device, action, &code) == ESP_OK);
+    ir_code_free(&code);
+    return learned;
 }
 
-esp_err_t ir_action_clear(ir_device_type_t device, ir_action_t action)
+/* Erase one action record and its table slot (actions_lock held) */
+static esp_err_t action_erase(ir_device_type_t device, ir_action_t action)
 {
-    if (!is_initialized) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
     /* Generate NVS key */
     char nvs_key[MAX_NVS_KEY_LEN + 1];
     esp_err_t err = generate_nvs_key_internal(device, action, nvs_key, sizeof(nvs_key));
@@ -509,9 +670,13 @@ esp_err_t ir_action_clear(ir_device_type_t device, ir_action_t action)
         return err;
     }
 
+    if (action_has_table_row(device)) {
+        ir_code_table_remove(device, action);
+    }
+
     /* Erase from NVS */
-    err = nvs_erase_key(nvs_handle_action, nvs_key);
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
+    err = ir_storage_erase(actions_ns, nvs_key);
+    if (err == ESP_ERR_NOT_FOUND) {
         return ESP_OK; // Already cleared
     } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to clear action %s: %s", nvs_key, esp_err_to_name(err));
@@ -521,10 +686,10 @@ esp_err_t ir_action_clear(ir_device_type_t device, ir_action_t action)
     /* Also erase RAW data if exists */
     char raw_key[MAX_NVS_KEY_LEN + 5];
     snprintf(raw_key, sizeof(raw_key), "%s_raw", nvs_key);
-    nvs_erase_key(nvs_handle_action, raw_key); // Ignore errors for RAW key
+    ir_storage_erase(actions_ns, raw_key); // Ignore errors for RAW key
 
     /* Commit */
-    err = nvs_commit(nvs_handle_action);
+    err = ir_storage_commit(actions_ns);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
         return err;
@@ -537,6 +702,21 @@ esp_err_t ir_action_clear(ir_device_type_t device, ir_action_t action)
     return ESP_OK;
 }
 
+esp_err_t ir_action_clear(ir_device_type_t device, ir_action_t action)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTakeRecursive(actions_lock, portMAX_DELAY);
+    esp_err_t err = action_erase(device, action);
+    actions_generation++;
+    xSemaphoreGiveRecursive(actions_lock);
+
+    ir_scene_refresh_action(device, action);
+    return err;
+}
+
 esp_err_t ir_action_clear_device(ir_device_type_t device)
 {
     if (!is_initialized) {
@@ -545,12 +725,18 @@ esp_err_t ir_action_clear_device(ir_device_type_t device)
 
     ESP_LOGI(TAG, "Clearing all actions for device: %s", ir_action_get_device_name(device));
 
-    /* Iterate through all possible actions and clear */
+    /* Iterate through all possible actions and clear (one commit) */
+    ir_storage_begin_batch();
+    xSemaphoreTakeRecursive(actions_lock, portMAX_DELAY);
     for (int i = IR_ACTION_NONE + 1; i < IR_ACTION_MAX; i++) {
-        ir_action_clear(device, (ir_action_t)i);
+        action_erase(device, (ir_action_t)i);
     }
+    actions_generation++;
+    xSemaphoreGiveRecursive(actions_lock);
+    esp_err_t err = ir_storage_end_batch();
 
-    return ESP_OK;
+    ir_scene_refresh_action(device, IR_ACTION_NONE);
+    return err;
 }
 
 esp_err_t ir_action_clear_all(void)
@@ -561,23 +747,80 @@ esp_err_t ir_action_clear_all(void)
 
     ESP_LOGI(TAG, "Clearing all action mappings (factory reset)");
 
+    xSemaphoreTakeRecursive(actions_lock, portMAX_DELAY);
+    actions_generation++;
+
     /* Erase entire namespace */
-    esp_err_t err = nvs_erase_all(nvs_handle_action);
+    esp_err_t err = ir_storage_erase_all(actions_ns);
+    if (err == ESP_OK) {
+        err = ir_storage_commit(actions_ns);
+    }
+    if (err == ESP_OK) {
+        memset(device_emitters, IR_TX_EMITTER_DEFAULT, sizeof(device_emitters));
+        for (int i = IR_DEVICE_NONE + 1; i < IR_DEVICE_MAX; i++) {
+            ir_code_table_clear_row(i);
+        }
+    }
+
+    xSemaphoreGiveRecursive(actions_lock);
+
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to erase all actions: %s", esp_err_to_name(err));
         return err;
     }
 
-    err = nvs_commit(nvs_handle_action);
+    ir_scene_refresh();
+
+    ESP_LOGI(TAG, "All action mappings cleared");
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * EMITTER BINDING
+ * ============================================================================ */
+
+esp_err_t ir_action_set_emitter(ir_device_type_t device, uint8_t emitter)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (device <= IR_DEVICE_NONE || device >= IR_DEVICE_MAX ||
+        (emitter >= IR_TX_MAX_EMITTERS && emitter != IR_TX_EMITTER_ALL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (device_emitters[device] == emitter) {
+        return ESP_OK;
+    }
+
+    uint8_t previous = device_emitters[device];
+    device_emitters[device] = emitter;
+
+    esp_err_t err = ir_storage_set(actions_ns, NVS_KEY_EMITTERS, device_emitters,
+                                 sizeof(device_emitters));
+    if (err == ESP_OK) {
+        err = ir_storage_commit(actions_ns);
+    }
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Failed to save emitter binding: %s", esp_err_to_name(err));
+        device_emitters[device] = previous;
         return err;
     }
 
-    ESP_LOGI(TAG, "All action mappings cleared");
+    ESP_LOGI(TAG, "%s bound to IR emitter %d", ir_action_get_device_name(device), emitter);
+    ir_scene_refresh_action(device, IR_ACTION_NONE);
     return ESP_OK;
 }
 
+uint8_t ir_action_get_emitter(ir_device_type_t device)
+{
+    if (device <= IR_DEVICE_NONE || device >= IR_DEVICE_MAX) {
+        return IR_TX_EMITTER_DEFAULT;
+    }
+    return device_emitters[device];
+}
+
 /* ============================================================================
  * UTILITY FUNCTIONS
  * ============================================================================ */
@@ -0,0 +1,132 @@
+/**
+ * @file ir_carrier_detect.c
+ * @brief IR Carrier Frequency / Duty Cycle Estimator Implementation
+ *
+ * Pure C (no ESP-IDF dependencies) so it can be compiled on the host and
+ * fed synthetic edge streams.
+ *
+ * MIT License
+ */
+
+#include "ir_carrier_detect.h"
+
+/* Common IR carriers (Hz) used by ir_carrier_normalize() */
+static const uint32_t common_carriers_hz[] = {
+    30000, 33000, 36000, 38000, 40000, 56000, 455000
+};
+
+#define IR_CARRIER_SNAP_PERCENT  4
+
+static void sort_u32(uint32_t *values, size_t count) {
+    // Insertion sort - at most IR_CARRIER_MAX_SAMPLES entries
+    for (size_t i = 1; i < count; i++) {
+        uint32_t v = values[i];
+        size_t j = i;
+        while (j > 0 && values[j - 1] > v) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = v;
+    }
+}
+
+bool ir_carrier_estimate(const uint32_t *durations, size_t count, uint32_t tick_hz,
+                         ir_carrier_estimate_t *result) {
+    if (durations == NULL || result == NULL || tick_hz == 0 || count < 2) {
+        return false;
+    }
+
+    // Period bounds in ticks for the plausible carrier range
+    uint32_t min_period = tick_hz / IR_CARRIER_MAX_HZ;
+    uint32_t max_period = tick_hz / IR_CARRIER_MIN_HZ;
+    if (min_period < 2) {
+        // Tick rate too low to resolve the carrier at all
+        min_period = 2;
+    }
+
+    // Pass 1: sample candidate periods (ON + following OFF) for the median
+    uint32_t samples[IR_CARRIER_MAX_SAMPLES];
+    size_t num_samples = 0;
+
+    for (size_t i = 0; i + 1 < count && num_samples < IR_CARRIER_MAX_SAMPLES; i += 2) {
+        uint32_t on = durations[i];
+        uint32_t off = durations[i + 1];
+        uint32_t period = on + off;
+
+        if (on == 0 || off == 0 || period < min_period || period > max_period) {
+            continue;  // Mark/space gap or glitch, not a carrier cycle
+        }
+        samples[num_samples++] = period;
+    }
+
+    if (num_samples < IR_CARRIER_MIN_CYCLES) {
+        return false;
+    }
+
+    sort_u32(samples, num_samples);
+    uint32_t median = samples[num_samples / 2];
+    uint32_t tolerance = (median * IR_CARRIER_PERIOD_TOLERANCE_PERCENT) / 100;
+
+    // Pass 2: average every consistent cycle in the full stream
+    uint64_t sum_period = 0;
+    uint64_t sum_on = 0;
+    uint32_t cycles = 0;
+
+    for (size_t i = 0; i + 1 < count; i += 2) {
+        uint32_t on = durations[i];
+        uint32_t off = durations[i + 1];
+        uint32_t period = on + off;
+
+        if (on == 0 || off == 0) {
+            continue;
+        }
+        if (period + tolerance < median || period > median + tolerance) {
+            continue;
+        }
+        sum_period += period;
+        sum_on += on;
+        cycles++;
+    }
+
+    if (cycles < IR_CARRIER_MIN_CYCLES || sum_period == 0) {
+        return false;
+    }
+
+    // frequency = tick_hz / (sum_period / cycles), rounded
+    uint64_t freq = ((uint64_t)tick_hz * cycles + sum_period / 2) / sum_period;
+    uint32_t duty = (uint32_t)((sum_on * 100 + sum_period / 2) / sum_period);
+
+    if (freq < IR_CARRIER_MIN_HZ || freq > IR_CARRIER_MAX_HZ) {
+        return false;
+    }
+    if (duty < 1) {
+        duty = 1;
+    } else if (duty > 99) {
+        duty = 99;
+    }
+
+    result->frequency_hz = (uint32_t)freq;
+    result->duty_percent = (uint8_t)duty;
+    result->cycles = cycles > UINT16_MAX ? UINT16_MAX : (uint16_t)cycles;
+    return true;
+}
+
+uint32_t ir_carrier_normalize(uint32_t frequency_hz) {
+    // Windows of neighbouring carriers overlap (36/38/40 kHz): take the closest
+    uint32_t best = 0;
+    uint32_t best_distance = UINT32_MAX;
+    for (size_t i = 0; i < sizeof(common_carriers_hz) / sizeof(common_carriers_hz[0]); i++) {
+        uint32_t nominal = common_carriers_hz[i];
+        uint32_t window = (nominal * IR_CARRIER_SNAP_PERCENT) / 100;
+        uint32_t distance = frequency_hz > nominal ? frequency_hz - nominal : nominal - frequency_hz;
+        if (distance <= window && distance < best_distance) {
+            best = nominal;
+            best_distance = distance;
+        }
+    }
+    if (best != 0) {
+        return best;
+    }
+
+    return ((frequency_hz + 50) / 100) * 100;
+}
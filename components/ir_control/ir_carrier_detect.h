@@ -0,0 +1,86 @@
+/**
+ * @file ir_carrier_detect.h
+ * @brief IR Carrier Frequency / Duty Cycle Estimator
+ *
+ * Estimates the sub-carrier frequency and duty cycle of a captured IR burst
+ * from the raw (non-demodulated) edge stream of a photodiode such as the
+ * TSMP58000 or a bare PIN diode + comparator.
+ *
+ * The estimator is plain C with no ESP-IDF dependencies so it can be built
+ * and exercised on the host with synthetic edge streams. The ESP-specific
+ * RMT capture lives in ir_control.c and only flattens RMT symbols into
+ * alternating ON/OFF durations before calling in here.
+ *
+ * MIT License
+ */
+
+#ifndef IR_CARRIER_DETECT_H
+#define IR_CARRIER_DETECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Plausible carrier range (covers 30-56 kHz consumer IR and 455 kHz B&O) */
+#define IR_CARRIER_MIN_HZ           20000
+#define IR_CARRIER_MAX_HZ           500000
+
+/* Minimum number of consistent carrier cycles for a valid estimate */
+#define IR_CARRIER_MIN_CYCLES       8
+
+/* Maximum number of cycles sampled for the median (bounds stack use) */
+#define IR_CARRIER_MAX_SAMPLES      64
+
+/* Cycles further than this from the median period are rejected as glitches */
+#define IR_CARRIER_PERIOD_TOLERANCE_PERCENT  20
+
+/**
+ * @brief Carrier estimation result
+ */
+typedef struct {
+    uint32_t frequency_hz;      // Estimated carrier frequency
+    uint8_t duty_percent;       // Estimated ON time in percent of a period (1-99)
+    uint16_t cycles;            // Number of carrier cycles used for the estimate
+} ir_carrier_estimate_t;
+
+/**
+ * @brief Estimate carrier frequency and duty cycle from an edge stream
+ *
+ * @p durations holds alternating ON/OFF segment lengths in ticks of
+ * @p tick_hz, starting with an ON segment. Long OFF segments (the gaps
+ * between marks of the modulated frame) and runt cycles are ignored, so
+ * a whole frame or just the first mark can be passed in.
+ *
+ * The carrier period is taken as the median of the sampled ON+OFF cycles;
+ * frequency and duty are then averaged over all cycles within
+ * IR_CARRIER_PERIOD_TOLERANCE_PERCENT of that median.
+ *
+ * @param durations Alternating ON/OFF durations in ticks (ON first)
+ * @param count Number of entries in @p durations
+ * @param tick_hz Tick rate of @p durations (e.g. RMT resolution)
+ * @param result Output estimate
+ * @return true if at least IR_CARRIER_MIN_CYCLES consistent cycles were found
+ */
+bool ir_carrier_estimate(const uint32_t *durations, size_t count, uint32_t tick_hz,
+                         ir_carrier_estimate_t *result);
+
+/**
+ * @brief Round a measured carrier to the nearest common IR carrier
+ *
+ * Snaps to 30/33/36/38/40/56/455 kHz when within 4%, otherwise rounds to
+ * the nearest 100 Hz. Keeps learned codes stable across captures.
+ *
+ * @param frequency_hz Measured frequency
+ * @return Normalized frequency in Hz
+ */
+uint32_t ir_carrier_normalize(uint32_t frequency_hz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_CARRIER_DETECT_H
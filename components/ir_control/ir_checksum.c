@@ -0,0 +1,126 @@
+/**
+ * @file ir_checksum.c
+ * @brief Frame Checksum Kernels
+ *
+ * MIT License
+ */
+
+#include "ir_checksum.h"
+#include <string.h>
+
+/* Unaligned 32-bit load; byte order does not matter to the kernels */
+static inline uint32_t load_word(const uint8_t *p) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+uint8_t ir_checksum_byte_sum(const uint8_t *data, size_t len) {
+    uint32_t lanes = 0;     // Two 16-bit lanes, each gathering two bytes per word
+    uint32_t sum = 0;
+    size_t i = 0;
+
+    /* 2 * 255 per word and lane: fold before 128 words overflow a lane */
+    while (len - i >= 4) {
+        size_t words = (len - i) / 4;
+        if (words > 128) {
+            words = 128;
+        }
+        for (size_t n = 0; n < words; n++, i += 4) {
+            uint32_t w = load_word(&data[i]);
+            lanes += (w & 0x00FF00FFu) + ((w >> 8) & 0x00FF00FFu);
+        }
+        sum += (lanes & 0xFFFFu) + (lanes >> 16);
+        lanes = 0;
+    }
+    for (; i < len; i++) {
+        sum += data[i];
+    }
+    return (uint8_t)sum;
+}
+
+uint8_t ir_checksum_nibble_sum(const uint8_t *data, size_t len) {
+    uint32_t lanes = 0;     // Four 8-bit lanes, each gathering two nibbles per word
+    uint32_t sum = 0;
+    size_t i = 0;
+
+    /* 2 * 15 per word and lane: fold before 8 words overflow a lane */
+    while (len - i >= 4) {
+        size_t words = (len - i) / 4;
+        if (words > 8) {
+            words = 8;
+        }
+        for (size_t n = 0; n < words; n++, i += 4) {
+            uint32_t w = load_word(&data[i]);
+            lanes += (w & 0x0F0F0F0Fu) + ((w >> 4) & 0x0F0F0F0Fu);
+        }
+        sum += (lanes & 0xFF) + ((lanes >> 8) & 0xFF) + ((lanes >> 16) & 0xFF) + (lanes >> 24);
+        lanes = 0;
+    }
+    for (; i < len; i++) {
+        sum += (data[i] & 0x0F) + (data[i] >> 4);
+    }
+    return (uint8_t)(sum & 0x0F);
+}
+
+uint8_t ir_checksum_xor(const uint8_t *data, size_t len) {
+    uint32_t acc = 0;
+    size_t i = 0;
+
+    for (; len - i >= 4; i += 4) {
+        acc ^= load_word(&data[i]);
+    }
+    acc ^= acc >> 16;
+    acc ^= acc >> 8;
+
+    uint8_t x = (uint8_t)acc;
+    for (; i < len; i++) {
+        x ^= data[i];
+    }
+    return x;
+}
+
+bool ir_checksum_inverted_pairs(const uint8_t *data, size_t len) {
+    if (len == 0 || (len & 1)) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i += 2) {
+        if ((uint8_t)(data[i] ^ data[i + 1]) != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ir_checksum_inverted_halves(const uint8_t *data, size_t len) {
+    if (len == 0 || (len & 1)) {
+        return false;
+    }
+    size_t half = len / 2;
+    for (size_t i = 0; i < half; i++) {
+        if ((uint8_t)(data[i] ^ data[i + half]) != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t ir_checksum_crc8(const uint8_t *data, size_t len, uint8_t poly, uint8_t init) {
+    /* CRC of each high nibble value shifted through the register */
+    uint8_t table[16];
+    for (uint8_t n = 0; n < 16; n++) {
+        uint8_t crc = (uint8_t)(n << 4);
+        for (uint8_t k = 0; k < 4; k++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ poly) : (uint8_t)(crc << 1);
+        }
+        table[n] = crc;
+    }
+
+    uint8_t crc = init;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (uint8_t)(crc << 4) ^ table[crc >> 4];
+        crc = (uint8_t)(crc << 4) ^ table[crc >> 4];
+    }
+    return crc;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file ir_checksum.h
+ * @brief Frame Checksum Kernels
+ *
+ * One implementation of every integrity check used by the decoders and
+ * the AC frame engine:
+ * - Byte sum (Daikin, Mitsubishi, Hitachi, Fujitsu as two's complement)
+ * - Nibble sum (Carrier/Voltas, LG)
+ * - XOR (Haier, Midea and Samsung48 state frames, Panasonic)
+ * - Inverted byte pairs and halves (NEC style, Midea)
+ * - CRC-8 with any polynomial
+ *
+ * The sum and XOR kernels consume four bytes per step with SWAR lane
+ * arithmetic; results do not depend on alignment or byte order. Plain C
+ * with no ESP-IDF dependencies, so it can be built and exercised on the
+ * host.
+ *
+ * MIT License
+ */
+
+#ifndef IR_CHECKSUM_H
+#define IR_CHECKSUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Low byte of the sum of @p len bytes
+ *
+ * Two's complement checksums (Fujitsu) are (uint8_t)-ir_checksum_byte_sum().
+ */
+uint8_t ir_checksum_byte_sum(const uint8_t *data, size_t len);
+
+/**
+ * @brief Low nibble of the sum of every nibble of @p len bytes
+ */
+uint8_t ir_checksum_nibble_sum(const uint8_t *data, size_t len);
+
+/**
+ * @brief XOR of @p len bytes
+ */
+uint8_t ir_checksum_xor(const uint8_t *data, size_t len);
+
+/**
+ * @brief Check that every odd byte is the inverse of the byte before it
+ *
+ * NEC style address/~address, command/~command frames.
+ *
+ * @param len Number of bytes (even)
+ */
+bool ir_checksum_inverted_pairs(const uint8_t *data, size_t len);
+
+/**
+ * @brief Check that the second half of a frame is the inverse of the first
+ *
+ * Midea style data[i] == ~data[i + len / 2].
+ *
+ * @param len Number of bytes (even)
+ */
+bool ir_checksum_inverted_halves(const uint8_t *data, size_t len);
+
+/**
+ * @brief CRC-8, MSB first, no reflection or final XOR
+ *
+ * Uses a 16-entry nibble table built for @p poly on each call, so any
+ * polynomial works without a 256-byte table per variant.
+ *
+ * @param poly Polynomial without the x^8 term (0x07 = CRC-8/SMBUS)
+ * @param init Initial register value
+ */
+uint8_t ir_checksum_crc8(const uint8_t *data, size_t len, uint8_t poly, uint8_t init);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_CHECKSUM_H
@@ -0,0 +1,405 @@
+/**
+ * @file ir_code.c
+ * @brief IR Code Payload Storage, Learned-Code Arena and NVS Records
+ *
+ * MIT License
+ */
+
+#include "ir_code.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Version 1 NVS blob: the pre-compact ir_code_t as laid out on ESP32
+ *
+ * The raw_data pointer was saved too; it is meaningless after a reboot.
+ */
+typedef struct {
+    uint32_t protocol;
+    uint32_t data;
+    uint16_t bits;
+    uint32_t raw_data;
+    uint16_t raw_length;
+    uint16_t address;
+    uint16_t command;
+    uint8_t flags;
+    uint32_t carrier_freq_hz;
+    uint8_t duty_cycle_percent;
+    uint8_t repeat_count;
+    uint16_t repeat_period_ms;
+    uint8_t validation_status;
+} ir_code_v1_t;
+
+_Static_assert(sizeof(ir_code_v1_t) == IR_CODE_RECORD_V1_SIZE, "v1 blob layout changed");
+
+#if UINTPTR_MAX == 0xFFFFFFFF
+_Static_assert(sizeof(ir_code_t) == 32, "ir_code_t should be 16B header + 16B payload");
+#endif
+
+/* ============================================================================
+ * PAYLOAD ACCESS
+ * ============================================================================ */
+
+bool ir_code_is_external(const ir_code_t *code) {
+    if (code->protocol == IR_PROTOCOL_RAW) {
+        return false;
+    }
+    return code->protocol == IR_PROTOCOL_PULSE_DISTANCE ||
+           code->protocol == IR_PROTOCOL_PULSE_WIDTH ||
+           code->bits > IR_CODE_INLINE_BYTES * 8;
+}
+
+/**
+ * @brief Out-of-line block of a code (RAW symbols or long payload)
+ */
+static uint8_t *external_block(const ir_code_t *code, size_t *size) {
+    if (code->protocol == IR_PROTOCOL_RAW) {
+        *size = (size_t)code->raw_length * IR_CODE_RAW_SYMBOL_BYTES;
+        return (uint8_t *)code->raw_data;
+    }
+    if (ir_code_is_external(code)) {
+        *size = code->payload_len;
+        return code->payload_ext;
+    }
+    *size = 0;
+    return NULL;
+}
+
+const uint8_t *ir_code_get_payload(const ir_code_t *code, size_t *len) {
+    size_t length = 0;
+    const uint8_t *payload = NULL;
+
+    if (code != NULL && code->protocol != IR_PROTOCOL_RAW) {
+        if (ir_code_is_external(code)) {
+            payload = code->payload_ext;
+            length = payload ? code->payload_len : 0;
+        } else {
+            payload = code->payload;
+            length = (code->bits + 7) / 8;
+        }
+    }
+
+    if (len) {
+        *len = length;
+    }
+    return length ? payload : NULL;
+}
+
+esp_err_t ir_code_set_payload(ir_code_t *code, const uint8_t *bytes, size_t len) {
+    if (code == NULL || (bytes == NULL && len > 0) || code->protocol == IR_PROTOCOL_RAW) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!ir_code_is_external(code)) {
+        if (len > IR_CODE_INLINE_BYTES) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memset(code->payload, 0, sizeof(code->payload));
+        if (len > 0) {
+            memcpy(code->payload, bytes, len);
+        }
+        return ESP_OK;
+    }
+
+    if (len > UINT16_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t *copy = NULL;
+    if (len > 0) {
+        copy = malloc(len);
+        if (copy == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(copy, bytes, len);
+    }
+
+    free(code->payload_ext);
+    code->payload_ext = copy;
+    code->payload_len = (uint16_t)len;
+    return ESP_OK;
+}
+
+esp_err_t ir_code_set_raw(ir_code_t *code, const void *symbols, size_t num_symbols) {
+    if (code == NULL || symbols == NULL || num_symbols == 0 || num_symbols > UINT16_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t size = num_symbols * IR_CODE_RAW_SYMBOL_BYTES;
+    uint16_t *copy = malloc(size);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, symbols, size);
+
+    ir_code_free(code);
+    code->protocol = IR_PROTOCOL_RAW;
+    code->raw_data = copy;
+    code->raw_length = (uint16_t)num_symbols;
+    return ESP_OK;
+}
+
+esp_err_t ir_code_copy(ir_code_t *dst, const ir_code_t *src) {
+    if (dst == NULL || src == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *dst = *src;
+
+    size_t size;
+    const uint8_t *block = external_block(src, &size);
+    if (block == NULL) {
+        return ESP_OK;
+    }
+
+    uint8_t *copy = size ? malloc(size) : NULL;
+    if (copy == NULL && size) {
+        dst->payload_ext = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    if (copy) {
+        memcpy(copy, block, size);
+    }
+    dst->payload_ext = copy;  // Same storage as raw_data
+    return ESP_OK;
+}
+
+void ir_code_free(ir_code_t *code) {
+    if (code == NULL) {
+        return;
+    }
+
+    size_t size;
+    uint8_t *block = external_block(code, &size);
+    free(block);
+    memset(code, 0, sizeof(*code));
+}
+
+/* ============================================================================
+ * LEARNED-CODE ARENA
+ * ============================================================================ */
+
+static inline size_t arena_align(size_t size) {
+    return (size + 3) & ~(size_t)3;
+}
+
+static inline bool arena_owns(const ir_code_arena_t *arena, const uint8_t *block) {
+    const uint8_t *base = (const uint8_t *)arena->base;
+    return block >= base && block < base + arena->size;
+}
+
+esp_err_t ir_code_arena_store(ir_code_arena_t *arena, ir_code_t *table, size_t count,
+                              size_t index, const ir_code_t *src) {
+    if (arena == NULL || table == NULL || src == NULL || index >= count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (src >= table && src < table + count) {
+        return ESP_ERR_INVALID_ARG;  // Releasing the entry could move src's block
+    }
+
+    size_t size;
+    const uint8_t *block = external_block(src, &size);
+
+    ir_code_arena_release(arena, table, count, index);
+    table[index] = *src;
+    if (block == NULL) {
+        return ESP_OK;
+    }
+    if (size == 0) {
+        table[index].payload_ext = NULL;
+        return ESP_OK;
+    }
+
+    uint8_t *dst;
+    size_t aligned = arena_align(size);
+    if (arena->used + aligned <= arena->size) {
+        dst = (uint8_t *)arena->base + arena->used;
+        arena->used += aligned;
+    } else {
+        dst = malloc(size);
+        if (dst == NULL) {
+            memset(&table[index], 0, sizeof(ir_code_t));
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    memcpy(dst, block, size);
+    table[index].payload_ext = dst;
+    return ESP_OK;
+}
+
+void ir_code_arena_release(ir_code_arena_t *arena, ir_code_t *table, size_t count,
+                           size_t index) {
+    if (arena == NULL || table == NULL || index >= count) {
+        return;
+    }
+
+    size_t size;
+    uint8_t *block = external_block(&table[index], &size);
+
+    if (block && arena_owns(arena, block)) {
+        uint8_t *base = (uint8_t *)arena->base;
+        size_t aligned = arena_align(size);
+        uint8_t *tail = block + aligned;
+
+        memmove(block, tail, (size_t)(base + arena->used - tail));
+        arena->used -= aligned;
+
+        for (size_t i = 0; i < count; i++) {
+            size_t other_size;
+            uint8_t *other = external_block(&table[i], &other_size);
+            if (i != index && other && arena_owns(arena, other) && other > block) {
+                table[i].payload_ext = other - aligned;
+            }
+        }
+    } else {
+        free(block);
+    }
+
+    memset(&table[index], 0, sizeof(ir_code_t));
+}
+
+/* ============================================================================
+ * NVS RECORDS
+ * ============================================================================ */
+
+size_t ir_code_serialize(const ir_code_t *code, uint8_t *buf, size_t buf_size) {
+    if (code == NULL || buf == NULL) {
+        return 0;
+    }
+
+    ir_code_record_t record = {
+        .magic = IR_CODE_RECORD_MAGIC,
+        .version = IR_CODE_RECORD_VERSION,
+        .protocol = code->protocol,
+        .flags = code->flags,
+        .bits = code->bits,
+        .address = code->address,
+        .command = code->command,
+        .repeat_period_ms = code->repeat_period_ms,
+        .carrier_freq_hz = code->carrier_freq_hz,
+        .duty_cycle_percent = code->duty_cycle_percent,
+        .validation_status = code->validation_status,
+        .data = code->data,
+    };
+
+    size_t payload_len = 0;
+    const uint8_t *payload = NULL;
+    if (code->protocol == IR_PROTOCOL_RAW) {
+        record.length = code->raw_length;
+    } else {
+        payload = ir_code_get_payload(code, &payload_len);
+        if (payload_len > IR_CODE_MAX_PAYLOAD_BYTES) {
+            return 0;
+        }
+        record.length = (uint16_t)payload_len;
+    }
+
+    size_t total = sizeof(record) + payload_len;
+    if (total > buf_size) {
+        return 0;
+    }
+
+    memcpy(buf, &record, sizeof(record));
+    if (payload_len > 0) {
+        memcpy(buf + sizeof(record), payload, payload_len);
+    }
+    return total;
+}
+
+/**
+ * @brief Migrate a version 1 blob
+ *
+ * Version 1 only kept 32 payload bits and no timing, so longer codes and
+ * universal-decoder codes cannot be rebuilt; they are rejected rather than
+ * migrated into a code that transmits something else. repeat_count is
+ * dropped: validation_status already records how many frames were matched.
+ */
+static esp_err_t deserialize_v1(const uint8_t *buf, ir_code_t *code) {
+    ir_code_v1_t v1;
+    memcpy(&v1, buf, sizeof(v1));
+
+    if (v1.protocol > IR_PROTOCOL_RAW) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (v1.protocol == IR_PROTOCOL_PULSE_DISTANCE || v1.protocol == IR_PROTOCOL_PULSE_WIDTH ||
+        (v1.protocol != IR_PROTOCOL_RAW && v1.bits > 32)) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    code->protocol = (uint8_t)v1.protocol;
+    code->flags = v1.flags;
+    code->bits = v1.bits;
+    code->address = v1.address;
+    code->command = v1.command;
+    code->carrier_freq_hz = v1.carrier_freq_hz;
+    code->duty_cycle_percent = v1.duty_cycle_percent;
+    code->validation_status = v1.validation_status;
+    code->repeat_period_ms = v1.repeat_period_ms;
+
+    if (code->protocol == IR_PROTOCOL_RAW) {
+        code->raw_length = v1.raw_length;
+    } else {
+        code->data = v1.data;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ir_code_deserialize(const uint8_t *buf, size_t len, ir_code_t *code, bool *migrated) {
+    if (buf == NULL || code == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(code, 0, sizeof(*code));
+    if (migrated) {
+        *migrated = false;
+    }
+
+    if (len == 0 || buf[0] != IR_CODE_RECORD_MAGIC) {
+        if (len != IR_CODE_RECORD_V1_SIZE) {
+            return ESP_ERR_INVALID_VERSION;
+        }
+        if (migrated) {
+            *migrated = true;
+        }
+        return deserialize_v1(buf, code);
+    }
+
+    if (len < sizeof(ir_code_record_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ir_code_record_t record;
+    memcpy(&record, buf, sizeof(record));
+    if (record.version != IR_CODE_RECORD_VERSION || record.protocol > IR_PROTOCOL_RAW) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    code->protocol = record.protocol;
+    code->flags = record.flags;
+    code->bits = record.bits;
+    code->address = record.address;
+    code->command = record.command;
+    code->repeat_period_ms = record.repeat_period_ms;
+    code->carrier_freq_hz = record.carrier_freq_hz;
+    code->duty_cycle_percent = record.duty_cycle_percent;
+    code->validation_status = record.validation_status;
+
+    if (code->protocol == IR_PROTOCOL_RAW) {
+        code->raw_length = record.length;
+        return ESP_OK;
+    }
+
+    if (len < sizeof(record) + record.length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t ret = ir_code_set_payload(code, buf + sizeof(record), record.length);
+    if (ret != ESP_OK) {
+        memset(code, 0, sizeof(*code));
+        return ret;
+    }
+    code->data = record.data;
+    return ESP_OK;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file ir_code.h
+ * @brief IR Code Payload Storage, Learned-Code Arena and NVS Records
+ *
+ * ir_code_t keeps a 16-byte header of hot metadata and a 16-byte payload
+ * union. Payloads longer than IR_CODE_INLINE_BYTES (Mitsubishi 152-bit,
+ * Daikin 312-bit, Hitachi 264/344-bit, universal decoder frames) and RAW
+ * symbol arrays live out of line:
+ * - Codes in flight (decoders, encoders, callbacks) own a heap block that
+ *   ir_code_free() releases
+ * - The learned-code table keeps its blocks in one static arena, packed
+ *   back to back and compacted on release, so 32 learned buttons do not
+ *   fragment the heap. When the arena is full the block falls back to heap.
+ *
+ * NVS stores a versioned record instead of the raw struct, so the layout
+ * can change without breaking saved codes. Version 1 was the bare 36-byte
+ * ir_code_t blob of firmware before the compact layout; it is migrated on
+ * load.
+ *
+ * Plain C with no ESP-IDF dependencies beyond esp_err_t, so it can be
+ * built and exercised on the host.
+ *
+ * MIT License
+ */
+
+#ifndef IR_CODE_H
+#define IR_CODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ir_control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Longest out-of-line payload (packed universal decoder frame is 67 bytes) */
+#define IR_CODE_MAX_PAYLOAD_BYTES   80
+
+/* RAW codes hold rmt_symbol_word_t (one 32-bit word per mark/space pair) */
+#define IR_CODE_RAW_SYMBOL_BYTES    4
+
+/* Learned-code arena: about four RAW captures or ~60 long AC frames */
+#define IR_CODE_ARENA_SIZE          4096
+
+/* NVS record format */
+#define IR_CODE_RECORD_MAGIC        0xC0    // Never a valid v1 protocol byte
+#define IR_CODE_RECORD_VERSION      2
+#define IR_CODE_RECORD_V1_SIZE      36      // sizeof(ir_code_t) on ESP32 before v2
+
+/**
+ * @brief NVS record header (payload bytes follow for non-RAW codes)
+ *
+ * RAW symbols are stored under a separate key as before.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t magic;                  // IR_CODE_RECORD_MAGIC
+    uint8_t version;                // IR_CODE_RECORD_VERSION
+    uint8_t protocol;
+    uint8_t flags;
+    uint16_t bits;
+    uint16_t address;
+    uint16_t command;
+    uint16_t repeat_period_ms;
+    uint32_t carrier_freq_hz;
+    uint8_t duty_cycle_percent;
+    uint8_t validation_status;
+    uint32_t data;                  // First 32 payload bits (legacy view)
+    uint16_t length;                // RAW: symbol count, otherwise payload bytes
+} ir_code_record_t;
+
+#define IR_CODE_RECORD_MAX_SIZE     (sizeof(ir_code_record_t) + IR_CODE_MAX_PAYLOAD_BYTES)
+
+/**
+ * @brief Arena for the out-of-line data of a table of codes
+ */
+typedef struct {
+    uint32_t *base;                 // Word-aligned so RMT symbols can live here
+    size_t size;                    // Capacity in bytes
+    size_t used;                    // Bytes in use (blocks are packed from base)
+} ir_code_arena_t;
+
+/**
+ * @brief Check whether a code keeps its payload out of line
+ */
+bool ir_code_is_external(const ir_code_t *code);
+
+/**
+ * @brief Copy @p src into @p table[index], placing out-of-line data in the arena
+ *
+ * The previous entry at @p index is released first. Falls back to the heap
+ * when the arena is full. @p src must not point into @p table.
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM if neither arena nor heap has room
+ */
+esp_err_t ir_code_arena_store(ir_code_arena_t *arena, ir_code_t *table, size_t count,
+                              size_t index, const ir_code_t *src);
+
+/**
+ * @brief Release @p table[index] and zero it
+ *
+ * Arena blocks above the released one are moved down and the pointers of
+ * the other table entries are updated.
+ */
+void ir_code_arena_release(ir_code_arena_t *arena, ir_code_t *table, size_t count,
+                           size_t index);
+
+/**
+ * @brief Serialize a code into an NVS record
+ *
+ * @param code IR code
+ * @param buf Output buffer (IR_CODE_RECORD_MAX_SIZE is always enough)
+ * @param buf_size Capacity of @p buf
+ * @return Record length, 0 if @p buf is too small or the payload too long
+ */
+size_t ir_code_serialize(const ir_code_t *code, uint8_t *buf, size_t buf_size);
+
+/**
+ * @brief Parse an NVS record (current or version 1) into a code
+ *
+ * Out-of-line payloads are heap allocated. RAW codes come back with
+ * raw_length set and raw_data NULL; the caller loads the symbols.
+ *
+ * @param buf Record bytes
+ * @param len Record length
+ * @param code Output code
+ * @param migrated Set to true if @p buf was a version 1 blob (may be NULL)
+ * @return ESP_OK, ESP_ERR_INVALID_VERSION for unknown records and for
+ *         version 1 codes it cannot rebuild (payloads over 32 bits,
+ *         PULSE_DISTANCE/PULSE_WIDTH), ESP_ERR_INVALID_SIZE for truncated
+ *         ones, ESP_ERR_NO_MEM
+ */
+esp_err_t ir_code_deserialize(const uint8_t *buf, size_t len, ir_code_t *code, bool *migrated);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_CODE_H
@@ -0,0 +1,370 @@
+/**
+ * @file ir_code_table.c
+ * @brief RAM-resident table of transmit-ready codes
+ *
+ * Slot word: first arena word of the span in the low half, symbol count
+ * in the high half, 0 when empty. Arena words are handed out first-fit
+ * from a bitmap, so spans are never moved once published. Replaced spans
+ * sit in a second bitmap until they are safe to reuse.
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_code_table.h"
+#include "ir_carrier_detect.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ir_code_table";
+
+_Static_assert(IR_CODE_TABLE_COLS >= IR_BTN_MAX, "button row must fit in a table row");
+_Static_assert(IR_CODE_TABLE_ARENA_WORDS <= UINT16_MAX, "spans use 16-bit offsets");
+_Static_assert(sizeof(ir_code_span_header_t) == sizeof(uint32_t), "header is one arena word");
+
+#define SLOT_PACK(first, count)     ((uint32_t)(first) | ((uint32_t)(count) << 16))
+#define SLOT_FIRST(slot)            ((uint16_t)((slot) & 0xFFFF))
+#define SLOT_COUNT(slot)            ((uint16_t)((slot) >> 16))
+
+static _Atomic uint32_t table[IR_CODE_TABLE_ROWS][IR_CODE_TABLE_COLS]
+    __attribute__((aligned(IR_CODE_TABLE_LINE_BYTES)));
+
+// Span headers and rmt_symbol_word_t symbols; a set bit marks a word in use
+static uint32_t arena[IR_CODE_TABLE_ARENA_WORDS];
+static uint32_t arena_map[IR_CODE_TABLE_ARENA_WORDS / 32];
+static uint16_t arena_used = 0;
+
+// Words of unpublished spans that readers or frames may still be using
+static uint32_t retired_map[IR_CODE_TABLE_ARENA_WORDS / 32];
+static uint16_t retired_words = 0;
+static uint8_t retired_seen = 0;            // Bit per reader counter seen empty since the last retire
+static int64_t retired_since_us = 0;
+
+// Writers only; readers go through the atomics below
+static SemaphoreHandle_t write_mutex = NULL;
+
+// Readers between slot load and hand-off, split by the epoch they entered in
+static atomic_uint readers[2];
+static atomic_uint reader_epoch = 0;
+static atomic_uint hits = 0;
+static atomic_uint misses = 0;
+static uint32_t grace_waits = 0;
+static uint32_t grace_wait_us_max = 0;
+
+static inline bool slot_valid(uint8_t row, uint16_t col)
+{
+    return row < IR_CODE_TABLE_ROWS && col < IR_CODE_TABLE_COLS;
+}
+
+static inline bool word_used(size_t i)
+{
+    return arena_map[i / 32] & (1UL << (i % 32));
+}
+
+static void words_mark(uint32_t *map, size_t first, size_t count, bool set)
+{
+    for (size_t i = first; i < first + count; i++) {
+        if (set) {
+            map[i / 32] |= 1UL << (i % 32);
+        } else {
+            map[i / 32] &= ~(1UL << (i % 32));
+        }
+    }
+}
+
+/**
+ * @brief First free run of @p count words (writer lock held)
+ *
+ * @return First word, or -1 when no run is long enough
+ */
+static int words_alloc(size_t count)
+{
+    size_t run = 0;
+    for (size_t i = 0; i < IR_CODE_TABLE_ARENA_WORDS; i++) {
+        run = word_used(i) ? 0 : run + 1;
+        if (run == count) {
+            size_t first = i + 1 - count;
+            words_mark(arena_map, first, count, true);
+            arena_used += count;
+            return (int)first;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Reuse retired words once no reader or frame can still see them (writer lock held)
+ *
+ * Never blocks. Readers count themselves in before loading a slot and
+ * writers swap the slot before looking at the counts (all sequentially
+ * consistent), so a reader that counts itself in after a counter was
+ * seen empty sees the new slot. Once both counters have been seen empty
+ * since the last retire, only frames already queued can still read a
+ * retired span; the words are reused when every emitter is idle.
+ * Otherwise they stay retired until a later writer call: a writer never
+ * waits for readers or for the transmitter.
+ *
+ * Flipping the epoch sends new readers to the counter already seen
+ * empty, so a steady stream of transmits cannot keep both counters busy.
+ */
+static void retired_reclaim(void)
+{
+    if (retired_words == 0) {
+        return;
+    }
+
+    for (unsigned c = 0; c < 2; c++) {
+        if (atomic_load(&readers[c]) == 0) {
+            retired_seen |= 1u << c;
+        }
+    }
+    unsigned current = atomic_load(&reader_epoch) & 1;
+    if (retired_seen == (1u << (current ^ 1))) {
+        atomic_fetch_xor(&reader_epoch, 1);
+    }
+
+    if (retired_seen != 3 || ir_tx_wait_all_done(0) != ESP_OK) {
+        grace_waits++;
+        return;
+    }
+
+    for (size_t i = 0; i < IR_CODE_TABLE_ARENA_WORDS / 32; i++) {
+        arena_map[i] &= ~retired_map[i];
+        retired_map[i] = 0;
+    }
+    arena_used -= retired_words;
+    retired_words = 0;
+
+    uint32_t waited = (uint32_t)(esp_timer_get_time() - retired_since_us);
+    if (waited > grace_wait_us_max) {
+        grace_wait_us_max = waited;
+    }
+}
+
+/**
+ * @brief Retire unpublished spans (writer lock held)
+ *
+ * Their words stay allocated until retired_reclaim() finds them unused;
+ * every writer call gives earlier retired spans another try.
+ */
+static void spans_retire(const uint32_t *slots, size_t num_slots)
+{
+    bool any = false;
+    for (size_t i = 0; i < num_slots; i++) {
+        if (SLOT_COUNT(slots[i]) > 0) {
+            words_mark(retired_map, SLOT_FIRST(slots[i]), SLOT_COUNT(slots[i]) + 1, true);
+            retired_words += SLOT_COUNT(slots[i]) + 1;
+            any = true;
+        }
+    }
+    if (any) {
+        // Readers in now may have loaded the old slots: wait for both counters again
+        retired_seen = 0;
+        retired_since_us = esp_timer_get_time();
+        atomic_fetch_xor(&reader_epoch, 1);
+    }
+    retired_reclaim();
+}
+
+esp_err_t ir_code_table_init(void)
+{
+    if (write_mutex != NULL) {
+        return ESP_OK;
+    }
+
+    write_mutex = xSemaphoreCreateMutex();
+    if (write_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Code table: %d x %d slots, %d-word arena",
+             IR_CODE_TABLE_ROWS, IR_CODE_TABLE_COLS, IR_CODE_TABLE_ARENA_WORDS);
+    return ESP_OK;
+}
+
+esp_err_t ir_code_table_put(uint8_t row, uint16_t col, const ir_code_t *code)
+{
+    if (!slot_valid(row, col) || code == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (write_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Render outside the lock; transmits keep going meanwhile
+    void *symbols = NULL;
+    size_t num_symbols = 0;
+    esp_err_t ret = ir_render_code(code, &symbols, &num_symbols);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+
+    uint32_t slot = 0;
+    int first = -1;
+    if (num_symbols > 0 && num_symbols < IR_CODE_TABLE_ARENA_WORDS) {
+        first = words_alloc(num_symbols + 1);
+        if (first < 0 && retired_words > 0) {
+            retired_reclaim();
+            first = words_alloc(num_symbols + 1);
+        }
+    }
+
+    if (first >= 0) {
+        ir_code_span_header_t header = {
+            .carrier_10hz = code->carrier_freq_hz <= IR_CARRIER_MAX_HZ ?
+                            (uint16_t)(code->carrier_freq_hz / 10) : 0,
+            .protocol = code->protocol,
+            .duty_cycle_percent = code->duty_cycle_percent,
+        };
+        memcpy(&arena[first], &header, sizeof(header));
+        memcpy(&arena[first + 1], symbols, num_symbols * sizeof(arena[0]));
+        slot = SLOT_PACK(first, num_symbols);
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+
+    // Publish; the span is complete before the slot points at it. A stale
+    // code is dropped even when the new one does not fit.
+    uint32_t old = atomic_exchange(&table[row][col], slot);
+    spans_retire(&old, 1);
+
+    xSemaphoreGive(write_mutex);
+    free(symbols);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Arena full, slot %d.%d not resident (%u symbols)", row, col,
+                 (unsigned)num_symbols);
+    }
+    return ret;
+}
+
+void ir_code_table_remove(uint8_t row, uint16_t col)
+{
+    if (!slot_valid(row, col) || write_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+    uint32_t old = atomic_exchange(&table[row][col], 0);
+    spans_retire(&old, 1);
+    xSemaphoreGive(write_mutex);
+}
+
+void ir_code_table_clear_row(uint8_t row)
+{
+    if (row >= IR_CODE_TABLE_ROWS || write_mutex == NULL) {
+        return;
+    }
+
+    // One grace period for the whole row
+    uint32_t old[IR_CODE_TABLE_COLS];
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+    for (uint16_t col = 0; col < IR_CODE_TABLE_COLS; col++) {
+        old[col] = atomic_exchange(&table[row][col], 0);
+    }
+    spans_retire(old, IR_CODE_TABLE_COLS);
+    xSemaphoreGive(write_mutex);
+}
+
+bool ir_code_table_contains(uint8_t row, uint16_t col)
+{
+    if (!slot_valid(row, col)) {
+        return false;
+    }
+    return SLOT_COUNT(atomic_load(&table[row][col])) > 0;
+}
+
+esp_err_t ir_code_table_transmit(uint8_t row, uint16_t col, uint8_t emitter, bool wait)
+{
+    if (!slot_valid(row, col)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Counted in until the span is queued, so it cannot be reused first
+    unsigned epoch = atomic_load(&reader_epoch) & 1;
+    atomic_fetch_add(&readers[epoch], 1);
+
+    uint32_t slot = atomic_load(&table[row][col]);
+    if (SLOT_COUNT(slot) == 0) {
+        atomic_fetch_sub(&readers[epoch], 1);
+        atomic_fetch_add_explicit(&misses, 1, memory_order_relaxed);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ir_code_span_header_t header;
+    memcpy(&header, &arena[SLOT_FIRST(slot)], sizeof(header));
+
+    // The emitter only needs the carrier settings besides the symbols
+    ir_code_t code = {
+        .protocol = header.protocol,
+        .carrier_freq_hz = header.carrier_10hz * 10UL,
+        .duty_cycle_percent = header.duty_cycle_percent,
+    };
+
+    esp_err_t ret = ir_transmit_span_async(emitter, &code, &arena[SLOT_FIRST(slot) + 1],
+                                           SLOT_COUNT(slot));
+    atomic_fetch_sub(&readers[epoch], 1);
+    atomic_fetch_add_explicit(&hits, 1, memory_order_relaxed);
+
+    if (ret == ESP_OK && wait) {
+        ret = ir_tx_wait_done(emitter, IR_TX_TIMEOUT_MS);
+    }
+
+    if (ret == ESP_OK) {
+        ESP_LOGD(TAG, "Sent %s from slot %d.%d (%d symbols)",
+                 ir_get_protocol_name(code.protocol), row, col, SLOT_COUNT(slot));
+    } else {
+        ESP_LOGE(TAG, "%s transmission error: %s",
+                 ir_get_protocol_name(code.protocol), esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void ir_code_table_get_stats(ir_code_table_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->words_capacity = IR_CODE_TABLE_ARENA_WORDS;
+    stats->hits = atomic_load(&hits);
+    stats->misses = atomic_load(&misses);
+    if (write_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+    for (uint8_t row = 0; row < IR_CODE_TABLE_ROWS; row++) {
+        for (uint16_t col = 0; col < IR_CODE_TABLE_COLS; col++) {
+            if (SLOT_COUNT(atomic_load(&table[row][col])) > 0) {
+                stats->resident++;
+            }
+        }
+    }
+    stats->words_used = arena_used;
+    stats->grace_waits = grace_waits;
+    stats->grace_wait_us_max = grace_wait_us_max;
+    xSemaphoreGive(write_mutex);
+}
+
+void ir_code_table_reset_stats(void)
+{
+    atomic_store(&hits, 0);
+    atomic_store(&misses, 0);
+    if (write_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(write_mutex, portMAX_DELAY);
+    grace_waits = 0;
+    grace_wait_us_max = 0;
+    xSemaphoreGive(write_mutex);
+}
@@ -0,0 +1,142 @@
+/**
+ * @file ir_code_table.h
+ * @brief RAM-resident table of transmit-ready codes
+ *
+ * One flat table indexed by (device, action) serves both code stores:
+ * row IR_DEVICE_NONE holds the 32 legacy buttons (column = ir_button_t),
+ * the other rows the actions of each device type. A slot is one 32-bit
+ * word locating a span in a shared arena: a header word with the carrier
+ * settings, then the pre-rendered RMT symbols. Transmitting is one lookup
+ * and a hand-off of the span to the copy encoder: no storage read, no
+ * encoding, no symbol copy.
+ *
+ * Buttons are put in the table when they are learned or loaded, actions
+ * the first time they are executed and whenever they are saved. Codes
+ * that do not fit in the arena are simply not resident; callers then fall
+ * back to their own store, so the table is a cache and never the only
+ * copy of a code.
+ *
+ * Readers take no lock. A span is never modified once published: a
+ * writer (learning, clear, import) fills a fresh span, then swaps it into
+ * the slot with one atomic store. The old span is retired and only reused
+ * once no reader is between its slot load and its hand-off and no frame
+ * that may still be reading it is in flight. Writers are serialized among
+ * themselves but never wait for readers or the transmitter: spans still
+ * in use stay retired and are reclaimed by a later writer call, so the
+ * receive task can update the table while it learns.
+ *
+ * Copyright (c) 2025
+ */
+
+#ifndef IR_CODE_TABLE_H
+#define IR_CODE_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ir_control.h"
+#include "ir_action.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IR_CODE_TABLE_ROW_BUTTONS       IR_DEVICE_NONE
+#define IR_CODE_TABLE_ROWS              IR_DEVICE_MAX
+
+/* Columns rounded up so every row starts on a cache line */
+#define IR_CODE_TABLE_LINE_BYTES        32
+#define IR_CODE_TABLE_COLS              ((IR_ACTION_MAX + 7) & ~7)
+
+/* Shared span arena (8 KB): ~60 NEC-style codes or ~8 long AC frames */
+#define IR_CODE_TABLE_ARENA_WORDS       2048
+
+/**
+ * @brief Span header (first arena word of a span)
+ */
+typedef struct {
+    uint16_t carrier_10hz;          // Code carrier / 10, 0 = protocol default
+    uint8_t protocol;
+    uint8_t duty_cycle_percent;
+} ir_code_span_header_t;
+
+/**
+ * @brief Table counters
+ */
+typedef struct {
+    uint16_t resident;              // Slots holding a span
+    uint16_t words_used;            // Arena words, span headers included
+    uint16_t words_capacity;
+    uint32_t hits;                  // Transmits served from the table
+    uint32_t misses;                // Lookups of codes not resident
+    uint32_t grace_waits;           // Reclaims put off because readers or frames were active
+    uint32_t grace_wait_us_max;     // Longest time retired spans waited for reuse
+} ir_code_table_stats_t;
+
+/**
+ * @brief Create the writer lock (later calls return ESP_OK)
+ *
+ * Called by ir_control_init() and ir_action_init().
+ */
+esp_err_t ir_code_table_init(void);
+
+/**
+ * @brief Render a code and make it resident, replacing the slot's previous span
+ *
+ * Never blocks on readers or the transmitter.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM when the arena has no
+ *         room (the slot is then left empty), or the ir_render_code() error
+ */
+esp_err_t ir_code_table_put(uint8_t row, uint16_t col, const ir_code_t *code);
+
+/**
+ * @brief Drop a slot's span
+ */
+void ir_code_table_remove(uint8_t row, uint16_t col);
+
+/**
+ * @brief Drop every span of a row
+ */
+void ir_code_table_clear_row(uint8_t row);
+
+/**
+ * @brief Whether a slot holds a span
+ */
+bool ir_code_table_contains(uint8_t row, uint16_t col);
+
+/**
+ * @brief Send a resident code on one emitter (lock-free)
+ *
+ * @param wait Wait for the frame to finish
+ * @return ESP_OK, ESP_ERR_NOT_FOUND when the code is not resident, or the
+ *         transmission error
+ */
+esp_err_t ir_code_table_transmit(uint8_t row, uint16_t col, uint8_t emitter, bool wait);
+
+/**
+ * @brief Read the table counters
+ */
+void ir_code_table_get_stats(ir_code_table_stats_t *stats);
+
+/**
+ * @brief Reset the hit, miss and grace period counters
+ */
+void ir_code_table_reset_stats(void);
+
+/**
+ * @brief Queue symbols on an emitter without copying them (ir_control.c)
+ *
+ * The symbols must stay in place until the frame is out; the table
+ * guarantees that by reusing a retired span only once every emitter has
+ * been seen idle after the span's last reader handed it off.
+ */
+esp_err_t ir_transmit_span_async(uint8_t emitter, const ir_code_t *code,
+                                 const void *symbols, size_t num_symbols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_CODE_TABLE_H
@@ -11,10 +11,16 @@
 
 #include "ir_control.h"
 #include "ir_protocols.h"
+#include "ir_carrier_detect.h"
+#include "ir_rx_diversity.h"
+#include "ir_code.h"
+#include "ir_code_table.h"
+#include "ir_storage.h"
 #include "driver/rmt_tx.h"
 #include "driver/rmt_rx.h"
 #include "driver/rmt_encoder.h"
 #include "driver/gpio.h"
+#include "soc/soc_caps.h"
 #include "esp_log.h"
 #include "esp_attr.h"
 #include "esp_timer.h"
@@ -22,8 +28,7 @@
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "freertos/semphr.h"
-#include "nvs_flash.h"
-#include "nvs.h"
+#include <stdatomic.h>
 #include <string.h>
 
 // Include all protocol decoders
@@ -49,6 +54,7 @@
 #include "decoders/ir_bosewave.h"
 #include "decoders/ir_fast.h"
 #include "decoders/ir_apple.h"
+#include "decoders/ir_bang_olufsen.h"
 
 static const char *TAG = "IR_CONTROL";
 
@@ -57,6 +63,25 @@ static const char *TAG = "IR_CONTROL";
  * ============================================================================ */
 
 #define RMT_TICK_RESOLUTION_HZ  1000000  // 1MHz resolution, 1 tick = 1us
+#define IR_RX_IDLE_NS           10000000 // Space that ends a capture (10ms)
+
+// Carrier capture (non-demodulated photodiode) needs sub-microsecond resolution:
+// 40MHz gives ~88 ticks per 455kHz period and ~1050 per 38kHz period
+#define CARRIER_RX_RESOLUTION_HZ    40000000
+#define CARRIER_RX_SYMBOLS          64       // First mark burst is enough (8+ cycles)
+#define CARRIER_RX_IDLE_NS          100000   // Gap > 100us ends the burst capture
+#define CARRIER_RX_GLITCH_NS        100
+
+// Main receiver plus the optional diversity receivers
+#define IR_RX_NUM_RECEIVERS     (1 + (IR_RX2_GPIO >= 0) + (IR_RX3_GPIO >= 0))
+
+// The main receiver takes three memory blocks on its own; with diversity
+// receivers fitted every RX channel gets one block and ping-pongs instead
+#if IR_RX_NUM_RECEIVERS > 1
+#define IR_RX_MEM_SYMBOLS       SOC_RMT_MEM_WORDS_PER_CHANNEL
+#else
+#define IR_RX_MEM_SYMBOLS       128
+#endif
 
 /* ============================================================================
  * IR PROTOCOL TIMING (in microseconds)
@@ -90,22 +115,68 @@ static const char *TAG = "IR_CONTROL";
  * STATIC VARIABLES
  * ============================================================================ */
 
-// RMT channels and encoders
-static rmt_channel_handle_t tx_channel = NULL;
-static rmt_channel_handle_t rx_channel = NULL;
-static rmt_encoder_handle_t nec_encoder = NULL;
-static rmt_encoder_handle_t samsung_encoder = NULL;
-static rmt_encoder_handle_t copy_encoder = NULL;
+// TX emitters: one RMT channel per IR LED. Encoders keep per-transmission
+// state, so every channel has its own set.
+typedef struct {
+    int gpio_num;
+    uint32_t default_carrier_hz;        // Used when neither code nor protocol has one
+    rmt_channel_handle_t channel;
+    rmt_encoder_handle_t nec_encoder;
+    rmt_encoder_handle_t samsung_encoder;
+    rmt_encoder_handle_t copy_encoder;
+    SemaphoreHandle_t idle;             // Taken per frame, given by the TX done ISR
+    ir_code_t code;                     // Encoder input, valid until the frame is out
+    rmt_symbol_word_t *symbols;         // Owned symbol buffer, freed on the next frame
+    uint32_t carrier_hz;                // Carrier currently applied to the channel
+    uint8_t duty_percent;
+    volatile bool broadcast;            // Frame is part of a synchronized broadcast
+} ir_emitter_t;
+
+static ir_emitter_t emitters[IR_TX_MAX_EMITTERS];
+static uint8_t num_emitters = 0;
+
+// Broadcast: one synchronized frame at a time; TX done events of its
+// channels are counted here instead of releasing the emitters
+static SemaphoreHandle_t broadcast_mutex = NULL;
+static SemaphoreHandle_t broadcast_done = NULL;
+
+// RMT RX channels: IR_RX_GPIO first, then the diversity receivers
+typedef struct {
+    rmt_channel_handle_t channel;
+    rmt_symbol_word_t symbols[IR_MAX_CODE_LENGTH];
+    uint8_t index;
+    bool armed;                         // rmt_receive() pending on this channel
+} ir_receiver_t;
+
+// Receive queue item: which receiver captured the frame
+typedef struct {
+    uint8_t receiver;
+    rmt_rx_done_event_data_t data;
+} ir_rx_event_t;
 
-// RX buffers and queue
-static rmt_symbol_word_t raw_symbols[IR_MAX_CODE_LENGTH];
+static ir_receiver_t receivers[IR_RX_NUM_RECEIVERS];
+static uint8_t num_receivers = 0;
+
+// RX queue
 static QueueHandle_t receive_queue = NULL;
 static TaskHandle_t rx_task_handle = NULL;
 static rmt_receive_config_t receive_config;
 
-// Learned codes storage
+// Learned codes storage (long payloads and RAW symbols live in the arena)
 static ir_code_t learned_codes[IR_BTN_MAX];
+static uint32_t learned_arena_buf[IR_CODE_ARENA_SIZE / sizeof(uint32_t)];
+static ir_code_arena_t learned_arena = {
+    .base = learned_arena_buf,
+    .size = sizeof(learned_arena_buf),
+};
+// Writers; readers use learned_mask and the code table. The button row of
+// the code table is only written under this lock (table writers never
+// block), so learned_codes and the table change together.
 static SemaphoreHandle_t codes_mutex = NULL;
+static atomic_uint learned_mask = 0;                // Bit per button with a learned code
+static atomic_uint learned_queries = 0;             // ir_is_learned() calls
+static ir_code_access_stats_t codes_lock_stats;     // Lock fields only, updated under codes_mutex
+static ir_storage_ns_t codes_ns = NULL;            // IR_NVS_NAMESPACE, opened at init
 
 // Last received code for repeat detection
 static ir_code_t last_nec_code = {0};
@@ -126,6 +197,28 @@ static esp_timer_handle_t learning_timer = NULL;
 
 // Callbacks
 static ir_callbacks_t callbacks = {0};
+static ir_rx_hook_t rx_hook = NULL;
+static void *rx_hook_arg = NULL;
+
+#if IR_CARRIER_RX_GPIO >= 0
+// Carrier measurement channel (armed only while learning)
+static rmt_channel_handle_t carrier_rx_channel = NULL;
+static rmt_symbol_word_t carrier_symbols[CARRIER_RX_SYMBOLS];
+static QueueHandle_t carrier_queue = NULL;
+static rmt_receive_config_t carrier_receive_config;
+static bool carrier_rx_armed = false;
+static ir_carrier_estimate_t carrier_estimate;     // Carrier of the frame being processed
+static bool carrier_estimate_valid = false;
+#endif
+
+#if IR_RX_NUM_RECEIVERS > 1
+// Diversity combining: captures flattened to mark/space durations, and the
+// merged frame rebuilt as symbols for the decoders
+static uint32_t diversity_durations[IR_RX_NUM_RECEIVERS][IR_MAX_CODE_LENGTH * 2];
+static uint32_t combined_durations[IR_MAX_CODE_LENGTH * 2];
+static rmt_symbol_word_t combined_symbols[IR_MAX_CODE_LENGTH];
+#endif
+static ir_rx_diversity_stats_t diversity_stats;
 
 /* ============================================================================
  * BUTTON NAMES
@@ -306,8 +399,6 @@ static esp_err_t decode_nec_protocol(const rmt_symbol_word_t *symbols, size_t nu
     code->address = full_address;
     code->command = command;
     code->flags = is_extended ? IR_FLAG_EXTENDED : 0;
-    code->raw_length = 0;
-    code->raw_data = NULL;
 
     // Store as last NEC code for repeat detection
     memcpy(&last_nec_code, code, sizeof(ir_code_t));
@@ -377,8 +468,6 @@ static esp_err_t decode_samsung_protocol(const rmt_symbol_word_t *symbols, size_
     code->protocol = IR_PROTOCOL_SAMSUNG;
     code->data = decoded_data;
     code->bits = 32;
-    code->raw_length = 0;
-    code->raw_data = NULL;
 
     ESP_LOGI(TAG, "Decoded Samsung: Data=0x%08lX", decoded_data);
 
@@ -491,6 +580,36 @@ static esp_err_t ir_trim_gaps(const rmt_symbol_word_t *symbols, size_t num_symbo
     return ESP_OK;
 }
 
+/**
+ * @brief Compare the payload bytes of two decoded codes
+ *
+ * Universal decoder payloads carry re-measured timing, so only their data
+ * bits must repeat between frames.
+ */
+static bool ir_payloads_match(const ir_code_t *code1, const ir_code_t *code2)
+{
+    size_t len1, len2;
+    const uint8_t *payload1 = ir_code_get_payload(code1, &len1);
+    const uint8_t *payload2 = ir_code_get_payload(code2, &len2);
+
+    if (payload1 == NULL || payload2 == NULL) {
+        return payload1 == payload2;
+    }
+
+    if (code1->protocol == IR_PROTOCOL_PULSE_DISTANCE || code1->protocol == IR_PROTOCOL_PULSE_WIDTH) {
+        ir_dw_frame_t frame1, frame2;
+        if (ir_dw_unpack(payload1, len1, &frame1) != ESP_OK ||
+            ir_dw_unpack(payload2, len2, &frame2) != ESP_OK) {
+            return false;
+        }
+        return (frame1.num_frames == frame2.num_frames &&
+                memcmp(frame1.frame_bits, frame2.frame_bits, sizeof(frame1.frame_bits)) == 0 &&
+                memcmp(frame1.bytes, frame2.bytes, frame1.num_bytes) == 0);
+    }
+
+    return len1 == len2 && memcmp(payload1, payload2, len1) == 0;
+}
+
 /**
  * @brief Compare two IR codes for equality (for multi-frame verification)
  *
@@ -517,11 +636,12 @@ static bool ir_codes_match(const ir_code_t *code1, const ir_code_t *code2)
                     code1->command == code2->command &&
                     code1->bits == code2->bits);
         } else {
-            // For other protocols, compare data, address, command
+            // For other protocols, compare the full payload, address, command
             return (code1->data == code2->data &&
                     code1->address == code2->address &&
                     code1->command == code2->command &&
-                    code1->bits == code2->bits);
+                    code1->bits == code2->bits &&
+                    ir_payloads_match(code1, code2));
         }
     } else {
         // For RAW codes, compare length and timing (with tolerance)
@@ -570,6 +690,115 @@ static void ir_populate_metadata(ir_code_t *code)
     code->duty_cycle_percent = 33;
 }
 
+/* ============================================================================
+ * CARRIER MEASUREMENT (optional photodiode input)
+ * ============================================================================ */
+
+#if IR_CARRIER_RX_GPIO >= 0
+/**
+ * @brief Arm the carrier capture channel if it is idle
+ */
+static void ir_carrier_capture_arm(void)
+{
+    if (carrier_rx_channel == NULL || carrier_rx_armed) {
+        return;
+    }
+
+    if (rmt_receive(carrier_rx_channel, carrier_symbols, sizeof(carrier_symbols),
+                    &carrier_receive_config) == ESP_OK) {
+        carrier_rx_armed = true;
+    }
+}
+
+/**
+ * @brief Measure the carrier of the frame that just arrived
+ *
+ * Called first thing for every frame. Drops the previous frame's result,
+ * takes the newest capture (the first burst of this frame), flattens its
+ * high-resolution RMT symbols into alternating ON/OFF durations and runs
+ * the estimator. Re-arms the capture channel while learning, so the next
+ * frame gets a capture of its own instead of this one.
+ */
+static void ir_carrier_capture_frame(void)
+{
+    rmt_rx_done_event_data_t carrier_data;
+    bool have_capture = false;
+
+    carrier_estimate_valid = false;
+
+    // Keep only the newest capture
+    while (carrier_queue && xQueueReceive(carrier_queue, &carrier_data, 0) == pdTRUE) {
+        carrier_rx_armed = false;
+        have_capture = true;
+    }
+
+    if (have_capture) {
+        uint32_t durations[CARRIER_RX_SYMBOLS * 2];
+        size_t count = 0;
+
+        for (size_t i = 0; i < carrier_data.num_symbols; i++) {
+            uint32_t dur[2] = { carrier_data.received_symbols[i].duration0,
+                                carrier_data.received_symbols[i].duration1 };
+            uint32_t lvl[2] = { carrier_data.received_symbols[i].level0,
+                                carrier_data.received_symbols[i].level1 };
+
+            for (int h = 0; h < 2; h++) {
+                if (dur[h] == 0) {
+                    continue;  // End marker
+                }
+                if (count == 0 && lvl[h] == 0) {
+                    continue;  // Stream must start with an ON segment
+                }
+                // Merge same-level halves so durations strictly alternate
+                bool expect_on = (count % 2) == 0;
+                if ((lvl[h] != 0) == expect_on) {
+                    durations[count++] = dur[h];
+                } else {
+                    durations[count - 1] += dur[h];
+                }
+            }
+        }
+
+        carrier_estimate_valid = ir_carrier_estimate(durations, count, CARRIER_RX_RESOLUTION_HZ,
+                                                     &carrier_estimate);
+        if (!carrier_estimate_valid) {
+            ESP_LOGD(TAG, "Carrier capture inconclusive (%d edges)", count);
+        }
+    }
+
+    if (learning_mode) {
+        ir_carrier_capture_arm();
+    }
+}
+
+/**
+ * @brief Apply the current frame's carrier measurement (if any) to a code
+ *
+ * On success the measured carrier replaces the protocol table value and
+ * IR_VALIDATION_CARRIER_DETECTED is set.
+ *
+ * @param code Code to update
+ */
+static void ir_apply_carrier_measurement(ir_code_t *code)
+{
+    if (!carrier_estimate_valid) {
+        return;
+    }
+
+    code->carrier_freq_hz = ir_carrier_normalize(carrier_estimate.frequency_hz);
+    code->duty_cycle_percent = carrier_estimate.duty_percent;
+    code->validation_status |= IR_VALIDATION_CARRIER_DETECTED;
+
+    ESP_LOGI(TAG, "Measured carrier: %lu Hz (raw %lu Hz), duty %d%% over %d cycles",
+             code->carrier_freq_hz, carrier_estimate.frequency_hz,
+             carrier_estimate.duty_percent, carrier_estimate.cycles);
+}
+#else
+static inline void ir_carrier_capture_arm(void) {}
+static inline void ir_carrier_capture_frame(void) {}
+static inline void ir_apply_carrier_measurement(ir_code_t *code) { (void)code; }
+#endif
+
 /* ============================================================================
  * LEARNING MODE TIMEOUT
  * ============================================================================ */
@@ -591,6 +820,261 @@ static void learning_timeout_callback(void *arg)
     current_learning_button = IR_BTN_MAX;
 }
 
+/* ============================================================================
+ * RECEIVERS AND DIVERSITY COMBINING
+ * ============================================================================ */
+
+/**
+ * @brief Re-arm every receiver whose capture has been consumed
+ */
+static void ir_rx_arm(void)
+{
+    for (uint8_t i = 0; i < num_receivers; i++) {
+        if (receivers[i].armed) {
+            continue;
+        }
+        if (rmt_receive(receivers[i].channel, receivers[i].symbols,
+                        sizeof(receivers[i].symbols), &receive_config) == ESP_OK) {
+            receivers[i].armed = true;
+        }
+    }
+}
+
+#if IR_RX_NUM_RECEIVERS > 1
+/**
+ * @brief Flatten RX symbols into alternating mark/space durations, mark first
+ */
+static size_t ir_symbols_to_durations(const rmt_symbol_word_t *symbols, size_t num_symbols,
+                                      uint32_t *durations, size_t max_durations)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < num_symbols; i++) {
+        uint32_t dur[2] = { symbols[i].duration0, symbols[i].duration1 };
+        uint32_t lvl[2] = { symbols[i].level0, symbols[i].level1 };
+
+        for (int h = 0; h < 2; h++) {
+            if (dur[h] == 0) {
+                continue;  // End marker
+            }
+            if (count == 0 && lvl[h] == 0) {
+                continue;  // Leading idle
+            }
+            bool expect_mark = (count % 2) == 0;
+            if ((lvl[h] != 0) == expect_mark) {
+                if (count == max_durations) {
+                    return count;
+                }
+                durations[count++] = dur[h];
+            } else {
+                durations[count - 1] += dur[h];
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Rebuild RX symbols (mark in level0) from mark/space durations
+ */
+static size_t ir_durations_to_symbols(const uint32_t *durations, size_t count,
+                                      rmt_symbol_word_t *symbols, size_t max_symbols)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < count && n < max_symbols; i += 2) {
+        uint32_t mark = durations[i];
+        uint32_t space = (i + 1 < count) ? durations[i + 1] : 0;
+        symbols[n++] = (rmt_symbol_word_t) {
+            .level0 = 1, .duration0 = mark > 0x7FFF ? 0x7FFF : mark,
+            .level1 = 0, .duration1 = space > 0x7FFF ? 0x7FFF : space,
+        };
+    }
+    return n;
+}
+
+/**
+ * @brief Collect the other receivers' captures of a frame and merge them
+ *
+ * Waits up to IR_RX_DIVERSITY_WINDOW_MS for the receivers that have not
+ * reported yet. A second capture from a receiver already seen belongs to
+ * the next frame and goes back to the front of the queue.
+ *
+ * @param first Event that started the frame
+ * @param rx_data Frame to decode (combined symbols when several captures merged)
+ * @return true if another receiver supplied what the main receiver lacked
+ */
+static bool ir_rx_combine(const ir_rx_event_t *first, rmt_rx_done_event_data_t *rx_data)
+{
+    ir_rx_event_t events[IR_RX_NUM_RECEIVERS];
+    bool have[IR_RX_NUM_RECEIVERS] = {0};
+    uint8_t num_captures = 1;
+
+    events[first->receiver] = *first;
+    have[first->receiver] = true;
+    *rx_data = first->data;
+
+    int64_t deadline = esp_timer_get_time() + IR_RX_DIVERSITY_WINDOW_MS * 1000;
+    while (num_captures < num_receivers) {
+        int64_t left_us = deadline - esp_timer_get_time();
+        ir_rx_event_t event;
+        if (left_us <= 0 ||
+            xQueueReceive(receive_queue, &event, pdMS_TO_TICKS((left_us + 999) / 1000)) != pdTRUE) {
+            break;
+        }
+        receivers[event.receiver].armed = false;
+        if (have[event.receiver]) {
+            xQueueSendToFront(receive_queue, &event, 0);
+            break;
+        }
+        events[event.receiver] = event;
+        have[event.receiver] = true;
+        num_captures++;
+    }
+
+    diversity_stats.frames++;
+    if (!have[0]) {
+        diversity_stats.primary_missed++;
+    }
+    if (num_captures == 1) {
+        return !have[0];
+    }
+
+    uint32_t *captures[IR_RX_NUM_RECEIVERS];
+    size_t counts[IR_RX_NUM_RECEIVERS];
+    size_t n = 0;
+    for (uint8_t r = 0; r < num_receivers; r++) {
+        if (!have[r]) {
+            continue;
+        }
+        counts[n] = ir_symbols_to_durations(events[r].data.received_symbols, events[r].data.num_symbols,
+                                            diversity_durations[n], IR_MAX_CODE_LENGTH * 2);
+        captures[n] = diversity_durations[n];
+        n++;
+    }
+
+    ir_diversity_result_t result;
+    size_t count = ir_diversity_combine(captures, counts, n, combined_durations,
+                                        IR_MAX_CODE_LENGTH * 2, &result);
+    if (count == 0) {
+        return !have[0];
+    }
+
+    rx_data->received_symbols = combined_symbols;
+    rx_data->num_symbols = ir_durations_to_symbols(combined_durations, count,
+                                                   combined_symbols, IR_MAX_CODE_LENGTH);
+
+    if (result.captures_used > 1) {
+        diversity_stats.combined++;
+    }
+    if (result.edges_repaired > 0) {
+        diversity_stats.repaired++;
+    }
+    if (result.edges_rejected > 0) {
+        diversity_stats.rejected++;
+    }
+    ESP_LOGD(TAG, "Diversity: %d/%d captures, %d edges repaired, %d rejected, %d glitches",
+             result.captures_used, num_captures, result.edges_repaired,
+             result.edges_rejected, result.glitches_removed);
+
+    return !have[0] || result.edges_repaired > 0;
+}
+#endif
+
+esp_err_t ir_rx_get_diversity_stats(ir_rx_diversity_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *stats = diversity_stats;
+    return (num_receivers > 1) ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+void ir_rx_reset_diversity_stats(void)
+{
+    memset(&diversity_stats, 0, sizeof(diversity_stats));
+}
+
+/* ============================================================================
+ * LEARNED CODE ACCESS
+ * ============================================================================ */
+
+_Static_assert(IR_BTN_MAX <= 32, "learned_mask has one bit per button");
+
+/**
+ * @brief Take the codes lock, counting contention
+ */
+static void codes_lock(void)
+{
+    uint32_t waited = 0;
+    if (xSemaphoreTake(codes_mutex, 0) != pdTRUE) {
+        int64_t start = esp_timer_get_time();
+        xSemaphoreTake(codes_mutex, portMAX_DELAY);
+        waited = (uint32_t)(esp_timer_get_time() - start);
+        codes_lock_stats.lock_contended++;
+    }
+
+    codes_lock_stats.locks++;
+    if (waited > codes_lock_stats.lock_wait_us_max) {
+        codes_lock_stats.lock_wait_us_max = waited;
+    }
+}
+
+static void codes_unlock(void)
+{
+    xSemaphoreGive(codes_mutex);
+}
+
+/**
+ * @brief Publish whether a button holds a code (codes lock held)
+ */
+static void learned_mask_update(int button)
+{
+    if (learned_codes[button].protocol != IR_PROTOCOL_UNKNOWN) {
+        atomic_fetch_or(&learned_mask, 1u << button);
+    } else {
+        atomic_fetch_and(&learned_mask, ~(1u << button));
+    }
+}
+
+esp_err_t ir_get_code_access_stats(ir_code_access_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ir_code_table_stats_t table_stats;
+    ir_code_table_get_stats(&table_stats);
+
+    // Not counted as a lock of its own
+    if (codes_mutex != NULL) {
+        xSemaphoreTake(codes_mutex, portMAX_DELAY);
+        *stats = codes_lock_stats;
+        xSemaphoreGive(codes_mutex);
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+
+    stats->lock_free_reads = table_stats.hits + atomic_load(&learned_queries);
+    stats->table_misses = table_stats.misses;
+    stats->grace_waits = table_stats.grace_waits;
+    stats->grace_wait_us_max = table_stats.grace_wait_us_max;
+    return ESP_OK;
+}
+
+void ir_reset_code_access_stats(void)
+{
+    ir_code_table_reset_stats();
+    atomic_store(&learned_queries, 0);
+
+    if (codes_mutex != NULL) {
+        xSemaphoreTake(codes_mutex, portMAX_DELAY);
+        memset(&codes_lock_stats, 0, sizeof(codes_lock_stats));
+        xSemaphoreGive(codes_mutex);
+    }
+}
+
 /* ============================================================================
  * IR RECEIVE TASK
  * ============================================================================ */
@@ -600,14 +1084,22 @@ static void learning_timeout_callback(void *arg)
  */
 static void ir_receive_task(void *pvParameters)
 {
+    ir_rx_event_t rx_event;
     rmt_rx_done_event_data_t rx_data;
-    ir_code_t received_code;
+    ir_code_t received_code = {0};
 
     ESP_LOGI(TAG, "IR receive task started");
 
     while (1) {
         // Wait for received data from ISR
-        if (xQueueReceive(receive_queue, &rx_data, portMAX_DELAY) == pdTRUE) {
+        if (xQueueReceive(receive_queue, &rx_event, portMAX_DELAY) == pdTRUE) {
+            receivers[rx_event.receiver].armed = false;
+            rx_data = rx_event.data;
+            ir_carrier_capture_frame();     // No-op without a photodiode
+            bool diversity_rescue = false;
+#if IR_RX_NUM_RECEIVERS > 1
+            diversity_rescue = ir_rx_combine(&rx_event, &rx_data);
+#endif
             ESP_LOGI(TAG, "Received %d RMT symbols", rx_data.num_symbols);
 
             // ========== SIGNAL PROCESSING & FILTERING ==========
@@ -642,8 +1134,17 @@ static void ir_receive_task(void *pvParameters)
             ESP_LOGD(TAG, "Signal processing: %d → %d (noise filter) → %d (gap trim) symbols",
                      rx_data.num_symbols, filtered_count, processed_count);
 
+            // Frames the hook recognizes (AC remote sync) skip the decoder chain
+            if (!learning_mode && rx_hook && rx_hook(processed_symbols, processed_count, rx_hook_arg)) {
+                if (diversity_rescue) {
+                    diversity_stats.rescued++;
+                }
+                ir_rx_arm();
+                continue;
+            }
+
             // ========== PROTOCOL DECODING ==========
-            memset(&received_code, 0, sizeof(ir_code_t));
+            ir_code_free(&received_code);  // Previous frame's payload, then zero
             esp_err_t ret = ESP_FAIL;
 
             // Try protocols in priority order (most common first for performance)
@@ -742,6 +1243,12 @@ static void ir_receive_task(void *pvParameters)
                 ret = ir_decode_fast(rx_data.received_symbols, rx_data.num_symbols, &received_code);
             }
 
+#if IR_RX_IDLE_NS > BEO_START_GAP_NS
+            if (ret != ESP_OK) {
+                ret = ir_decode_bang_olufsen(rx_data.received_symbols, rx_data.num_symbols, &received_code);
+            }
+#endif
+
             // TIER 4: Universal decoder (fallback for unknown protocols)
             if (ret != ESP_OK) {
                 ret = ir_decode_distance_width(rx_data.received_symbols, rx_data.num_symbols, &received_code);
@@ -751,10 +1258,19 @@ static void ir_receive_task(void *pvParameters)
             }
 
             if (ret == ESP_OK) {
+                if (diversity_rescue) {
+                    diversity_stats.rescued++;
+                }
+
                 // Successfully decoded - populate metadata
                 ir_populate_metadata(&received_code);
                 received_code.validation_status = processing_flags;
 
+                // Measured carrier (if a photodiode is fitted) overrides the table value
+                if (learning_mode) {
+                    ir_apply_carrier_measurement(&received_code);
+                }
+
                 if (learning_mode && current_learning_button < IR_BTN_MAX) {
                     // ========== COMMERCIAL-GRADE MULTI-FRAME VERIFICATION ==========
                     // Require 2-3 consecutive matching frames for reliable learning
@@ -770,12 +1286,12 @@ static void ir_receive_task(void *pvParameters)
                     // Store frame in verification buffer
                     if (verify_frame_idx == 0) {
                         // First frame - store and wait for more
-                        verify_frames[0] = received_code;
+                        ir_code_free(&verify_frames[0]);
+                        ir_code_copy(&verify_frames[0], &received_code);
                         verify_frame_idx = 1;
                         last_frame_time = current_time;
 
                         received_code.validation_status |= IR_VALIDATION_SINGLE_FRAME;
-                        received_code.repeat_count = 1;
 
                         ESP_LOGI(TAG, "Learning frame 1/3 - waiting for verification...");
                     } else {
@@ -784,6 +1300,14 @@ static void ir_receive_task(void *pvParameters)
                             verify_frame_idx++;
                             last_frame_time = current_time;
 
+                            // Carrier may only have been captured on a later frame
+                            if ((received_code.validation_status & IR_VALIDATION_CARRIER_DETECTED) &&
+                                !(verify_frames[0].validation_status & IR_VALIDATION_CARRIER_DETECTED)) {
+                                verify_frames[0].carrier_freq_hz = received_code.carrier_freq_hz;
+                                verify_frames[0].duty_cycle_percent = received_code.duty_cycle_percent;
+                                verify_frames[0].validation_status |= IR_VALIDATION_CARRIER_DETECTED;
+                            }
+
                             ESP_LOGI(TAG, "Learning frame %d/3 - match confirmed", verify_frame_idx);
 
                             // Check if we have enough matching frames
@@ -797,12 +1321,17 @@ static void ir_receive_task(void *pvParameters)
                                 } else {
                                     verified_code.validation_status |= IR_VALIDATION_THREE_FRAMES;
                                 }
-                                verified_code.repeat_count = verify_frame_idx;
 
                                 // Store the verified code
-                                xSemaphoreTake(codes_mutex, portMAX_DELAY);
-                                learned_codes[current_learning_button] = verified_code;
-                                xSemaphoreGive(codes_mutex);
+                                codes_lock();
+                                if (ir_code_arena_store(&learned_arena, learned_codes, IR_BTN_MAX,
+                                                        current_learning_button, &verified_code) != ESP_OK) {
+                                    ESP_LOGE(TAG, "Failed to store %u-bit payload", verified_code.bits);
+                                }
+                                learned_mask_update(current_learning_button);
+                                ir_code_table_put(IR_CODE_TABLE_ROW_BUTTONS, current_learning_button,
+                                                  &verified_code);
+                                codes_unlock();
 
                                 ESP_LOGI(TAG, "✓ Learned %s code for button '%s' (%d frames verified, carrier: %lu Hz)",
                                          protocol_names[verified_code.protocol],
@@ -827,11 +1356,13 @@ static void ir_receive_task(void *pvParameters)
                                 learning_mode = false;
                                 current_learning_button = IR_BTN_MAX;
                                 verify_frame_idx = 0;
+                                ir_code_free(&verify_frames[0]);
                             }
                         } else {
                             // Frame mismatch - reset verification
                             ESP_LOGW(TAG, "Frame mismatch - restarting verification");
-                            verify_frames[0] = received_code;
+                            ir_code_free(&verify_frames[0]);
+                            ir_code_copy(&verify_frames[0], &received_code);
                             verify_frame_idx = 1;
                             last_frame_time = current_time;
                         }
@@ -850,28 +1381,23 @@ static void ir_receive_task(void *pvParameters)
                     ESP_LOGI(TAG, "Non-standard protocol detected (%d symbols)", rx_data.num_symbols);
 
                     if (learning_mode && current_learning_button < IR_BTN_MAX) {
-                        // Store as RAW code
-                        xSemaphoreTake(codes_mutex, portMAX_DELAY);
-
-                        // Free any existing raw_data
-                        if (learned_codes[current_learning_button].raw_data != NULL) {
-                            free(learned_codes[current_learning_button].raw_data);
-                        }
-
-                        // Allocate memory for raw symbols
-                        size_t raw_data_size = rx_data.num_symbols * sizeof(rmt_symbol_word_t);
-                        rmt_symbol_word_t *raw_data = (rmt_symbol_word_t *)malloc(raw_data_size);
-
-                        if (raw_data != NULL) {
-                            memcpy(raw_data, rx_data.received_symbols, raw_data_size);
-
-                            received_code.protocol = IR_PROTOCOL_RAW;
-                            received_code.data = 0;
-                            received_code.bits = 0;
-                            received_code.raw_data = (uint16_t *)raw_data;
-                            received_code.raw_length = rx_data.num_symbols;
-
-                            learned_codes[current_learning_button] = received_code;
+                        // Store as RAW code: copy the raw symbols
+                        if (ir_code_set_raw(&received_code, rx_data.received_symbols,
+                                            rx_data.num_symbols) == ESP_OK) {
+                            received_code.carrier_freq_hz = IR_CARRIER_FREQ_HZ;
+                            received_code.duty_cycle_percent = 33;
+                            received_code.validation_status = processing_flags;
+                            ir_apply_carrier_measurement(&received_code);
+
+                            codes_lock();
+                            if (ir_code_arena_store(&learned_arena, learned_codes, IR_BTN_MAX,
+                                                    current_learning_button, &received_code) != ESP_OK) {
+                                ESP_LOGE(TAG, "Failed to store %d RAW symbols", rx_data.num_symbols);
+                            }
+                            learned_mask_update(current_learning_button);
+                            ir_code_table_put(IR_CODE_TABLE_ROW_BUTTONS, current_learning_button,
+                                              &received_code);
+                            codes_unlock();
 
                             ESP_LOGI(TAG, "Learned RAW code for button '%s' (%d symbols)",
                                      button_names[current_learning_button], rx_data.num_symbols);
@@ -902,27 +1428,13 @@ static void ir_receive_task(void *pvParameters)
                             learning_mode = false;
                             current_learning_button = IR_BTN_MAX;
                         }
-
-                        xSemaphoreGive(codes_mutex);
                     } else {
                         // Normal mode: Create temporary RAW code and call callback
-                        size_t raw_data_size = rx_data.num_symbols * sizeof(rmt_symbol_word_t);
-                        rmt_symbol_word_t *raw_data = (rmt_symbol_word_t *)malloc(raw_data_size);
-
-                        if (raw_data != NULL) {
-                            memcpy(raw_data, rx_data.received_symbols, raw_data_size);
-
-                            received_code.protocol = IR_PROTOCOL_RAW;
-                            received_code.data = 0;
-                            received_code.bits = 0;
-                            received_code.raw_data = (uint16_t *)raw_data;
-                            received_code.raw_length = rx_data.num_symbols;
-
+                        if (ir_code_set_raw(&received_code, rx_data.received_symbols,
+                                            rx_data.num_symbols) == ESP_OK) {
                             if (callbacks.receive_cb) {
                                 callbacks.receive_cb(&received_code, callbacks.user_arg);
                             }
-
-                            free(raw_data);
                         }
                     }
                 } else if (learning_mode) {
@@ -935,7 +1447,7 @@ static void ir_receive_task(void *pvParameters)
             }
 
             // Restart receiving
-            rmt_receive(rx_channel, raw_symbols, sizeof(raw_symbols), &receive_config);
+            ir_rx_arm();
         }
     }
 }
@@ -1258,132 +1770,335 @@ static bool IRAM_ATTR rmt_rx_done_callback(rmt_channel_handle_t channel,
     return high_task_wakeup == pdTRUE;
 }
 
-/* ============================================================================
- * PUBLIC API - INITIALIZATION
- * ============================================================================ */
-
-esp_err_t ir_control_init(void)
+static bool IRAM_ATTR ir_rx_done_callback(rmt_channel_handle_t channel,
+                                          const rmt_rx_done_event_data_t *edata,
+                                          void *user_ctx)
 {
-    esp_err_t ret = ESP_OK;
-
-    ESP_LOGI(TAG, "Initializing IR control (TX: GPIO%d, RX: GPIO%d)", IR_TX_GPIO, IR_RX_GPIO);
-
-    // Create mutex
-    codes_mutex = xSemaphoreCreateMutex();
-    if (codes_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create mutex");
-        return ESP_ERR_NO_MEM;
-    }
-
-    // Initialize learned codes
-    memset(learned_codes, 0, sizeof(learned_codes));
-
-    // Create receive queue
-    receive_queue = xQueueCreate(10, sizeof(rmt_rx_done_event_data_t));
-    if (receive_queue == NULL) {
-        ESP_LOGE(TAG, "Failed to create receive queue");
-        return ESP_ERR_NO_MEM;
-    }
-
-    // Configure TX channel
-    rmt_tx_channel_config_t tx_config = {
-        .gpio_num = IR_TX_GPIO,
-        .clk_src = RMT_CLK_SRC_DEFAULT,
-        .resolution_hz = RMT_TICK_RESOLUTION_HZ,
-        .mem_block_symbols = 64,
-        .trans_queue_depth = 4,
-        .flags.with_dma = false,
+    BaseType_t high_task_wakeup = pdFALSE;
+    ir_rx_event_t event = {
+        .receiver = ((ir_receiver_t *)user_ctx)->index,
+        .data = *edata,
     };
+    xQueueSendFromISR(receive_queue, &event, &high_task_wakeup);
+    return high_task_wakeup == pdTRUE;
+}
 
-    ret = rmt_new_tx_channel(&tx_config, &tx_channel);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create TX channel: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
-    // Configure RX channel
+/**
+ * @brief Create, hook up and enable one demodulated RX channel
+ */
+static esp_err_t ir_receiver_create(ir_receiver_t *rx, int gpio_num)
+{
     rmt_rx_channel_config_t rx_config = {
-        .gpio_num = IR_RX_GPIO,
+        .gpio_num = gpio_num,
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = RMT_TICK_RESOLUTION_HZ,
-        .mem_block_symbols = 128,
+        .mem_block_symbols = IR_RX_MEM_SYMBOLS,
         .intr_priority = 0,
         .flags.invert_in = true,   // IR receivers are active-LOW
         .flags.io_loop_back = false,
         .flags.with_dma = false,
     };
 
-    ret = rmt_new_rx_channel(&rx_config, &rx_channel);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create RX channel: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
-    // Create encoders
-    ret = rmt_new_nec_encoder((const rmt_encoder_t **)&nec_encoder);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create NEC encoder: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
-    ret = rmt_new_samsung_encoder((const rmt_encoder_t **)&samsung_encoder);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create Samsung encoder: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
-    rmt_copy_encoder_config_t copy_config = {};
-    ret = rmt_new_copy_encoder(&copy_config, &copy_encoder);
+    esp_err_t ret = rmt_new_rx_channel(&rx_config, &rx->channel);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create copy encoder: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to create RX channel on GPIO%d: %s", gpio_num, esp_err_to_name(ret));
+        rx->channel = NULL;
         return ret;
     }
 
-    // Register RX callback
     rmt_rx_event_callbacks_t cbs = {
-        .on_recv_done = rmt_rx_done_callback,
+        .on_recv_done = ir_rx_done_callback,
     };
-    ret = rmt_rx_register_event_callbacks(rx_channel, &cbs, receive_queue);
+    ret = rmt_rx_register_event_callbacks(rx->channel, &cbs, rx);
+    if (ret == ESP_OK) {
+        ret = rmt_enable(rx->channel);
+    }
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register RX callback: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to start RX channel on GPIO%d: %s", gpio_num, esp_err_to_name(ret));
+        rmt_del_channel(rx->channel);
+        rx->channel = NULL;
         return ret;
     }
 
-    // Configure carrier wave (38kHz)
+    rx->armed = false;
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * TX EMITTERS
+ * ============================================================================ */
+
+static bool IRAM_ATTR rmt_tx_done_callback(rmt_channel_handle_t channel,
+                                           const rmt_tx_done_event_data_t *edata,
+                                           void *user_ctx)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    ir_emitter_t *em = (ir_emitter_t *)user_ctx;
+    xSemaphoreGiveFromISR(em->broadcast ? broadcast_done : em->idle, &high_task_wakeup);
+    return high_task_wakeup == pdTRUE;
+}
+
+static void ir_emitter_destroy(ir_emitter_t *em)
+{
+    if (em->channel) {
+        rmt_disable(em->channel);
+        rmt_del_channel(em->channel);
+    }
+    if (em->nec_encoder) {
+        rmt_del_encoder(em->nec_encoder);
+    }
+    if (em->samsung_encoder) {
+        rmt_del_encoder(em->samsung_encoder);
+    }
+    if (em->copy_encoder) {
+        rmt_del_encoder(em->copy_encoder);
+    }
+    if (em->idle) {
+        vSemaphoreDelete(em->idle);
+    }
+    free(em->symbols);
+    memset(em, 0, sizeof(*em));
+}
+
+/**
+ * @brief Create the RMT TX channel, encoders and carrier for one emitter
+ *
+ * Each channel uses a single RMT memory block (refilled ping-pong for long
+ * frames) so all four TX channels fit next to the RX channels.
+ */
+static esp_err_t ir_emitter_create(ir_emitter_t *em, const ir_tx_emitter_config_t *config)
+{
+    memset(em, 0, sizeof(*em));
+    em->gpio_num = config->gpio_num;
+    em->default_carrier_hz = config->carrier_hz ? config->carrier_hz : IR_CARRIER_FREQ_HZ;
+    em->duty_percent = 33;
+    em->carrier_hz = em->default_carrier_hz;
+
+    em->idle = xSemaphoreCreateBinary();
+    if (em->idle == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(em->idle);
+
+    rmt_tx_channel_config_t tx_config = {
+        .gpio_num = config->gpio_num,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = RMT_TICK_RESOLUTION_HZ,
+        .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+        .trans_queue_depth = 4,
+        .flags.with_dma = false,
+    };
+
+    esp_err_t ret = rmt_new_tx_channel(&tx_config, &em->channel);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create TX channel on GPIO%d: %s", config->gpio_num,
+                 esp_err_to_name(ret));
+        goto err;
+    }
+
+    ret = rmt_new_nec_encoder((const rmt_encoder_t **)&em->nec_encoder);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create NEC encoder: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
+    ret = rmt_new_samsung_encoder((const rmt_encoder_t **)&em->samsung_encoder);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create Samsung encoder: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
+    rmt_copy_encoder_config_t copy_config = {};
+    ret = rmt_new_copy_encoder(&copy_config, &em->copy_encoder);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create copy encoder: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = rmt_tx_done_callback,
+    };
+    ret = rmt_tx_register_event_callbacks(em->channel, &cbs, em);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register TX callback: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
     rmt_carrier_config_t carrier_cfg = {
-        .frequency_hz = IR_CARRIER_FREQ_HZ,
-        .duty_cycle = 0.33,
+        .frequency_hz = em->carrier_hz,
+        .duty_cycle = em->duty_percent / 100.0f,
         .flags.polarity_active_low = false,
     };
-    ret = rmt_apply_carrier(tx_channel, &carrier_cfg);
+    ret = rmt_apply_carrier(em->channel, &carrier_cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to apply carrier: %s", esp_err_to_name(ret));
-        return ret;
+        goto err;
     }
 
-    // Enable channels
-    ret = rmt_enable(tx_channel);
+    ret = rmt_enable(em->channel);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to enable TX channel: %s", esp_err_to_name(ret));
+        goto err;
+    }
+    return ESP_OK;
+
+err:
+    ir_emitter_destroy(em);
+    return ret;
+}
+
+esp_err_t ir_tx_add_emitter(const ir_tx_emitter_config_t *config, uint8_t *emitter)
+{
+    if (config == NULL || config->gpio_num < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (num_emitters == 0) {
+        return ESP_ERR_INVALID_STATE;   // ir_control_init() creates emitter 0
+    }
+    if (num_emitters >= IR_TX_MAX_EMITTERS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ir_emitter_create(&emitters[num_emitters], config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "IR emitter %d on GPIO%d", num_emitters, config->gpio_num);
+    if (emitter) {
+        *emitter = num_emitters;
+    }
+    num_emitters++;
+    return ESP_OK;
+}
+
+uint8_t ir_tx_get_num_emitters(void)
+{
+    return num_emitters;
+}
+
+/* ============================================================================
+ * PUBLIC API - INITIALIZATION
+ * ============================================================================ */
+
+esp_err_t ir_control_init(void)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_LOGI(TAG, "Initializing IR control (TX: GPIO%d, RX: GPIO%d)", IR_TX_GPIO, IR_RX_GPIO);
+
+    // Storage first: learned codes may be saved as soon as RX runs
+    ret = ir_storage_init();
+    if (ret == ESP_OK) {
+        ret = ir_storage_open(IR_NVS_NAMESPACE, &codes_ns);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open code storage: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Create mutexes
+    codes_mutex = xSemaphoreCreateMutex();
+    broadcast_mutex = xSemaphoreCreateMutex();
+    broadcast_done = xSemaphoreCreateCounting(IR_TX_MAX_EMITTERS, 0);
+    if (codes_mutex == NULL || broadcast_mutex == NULL || broadcast_done == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Initialize learned codes
+    memset(learned_codes, 0, sizeof(learned_codes));
+
+    // Create receive queue
+    receive_queue = xQueueCreate(10, sizeof(ir_rx_event_t));
+    if (receive_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create receive queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Emitter 0 (TX channel, encoders, 38kHz carrier)
+    ir_tx_emitter_config_t emitter_config = {
+        .gpio_num = IR_TX_GPIO,
+        .carrier_hz = IR_CARRIER_FREQ_HZ,
+    };
+    ret = ir_emitter_create(&emitters[0], &emitter_config);
+    if (ret != ESP_OK) {
         return ret;
     }
+    num_emitters = 1;
 
-    ret = rmt_enable(rx_channel);
+    // Main RX channel, then the diversity receivers (before the carrier
+    // channel, which is optional and gets whatever memory is left)
+    ret = ir_receiver_create(&receivers[0], IR_RX_GPIO);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to enable RX channel: %s", esp_err_to_name(ret));
         return ret;
     }
+    num_receivers = 1;
+
+#if IR_RX_NUM_RECEIVERS > 1
+    const int diversity_gpios[] = { IR_RX2_GPIO, IR_RX3_GPIO };
+    for (int i = 0; i < 2; i++) {
+        if (diversity_gpios[i] < 0) {
+            continue;
+        }
+        receivers[num_receivers].index = num_receivers;
+        if (ir_receiver_create(&receivers[num_receivers], diversity_gpios[i]) != ESP_OK) {
+            // Not fatal - fewer receivers to combine
+            ESP_LOGW(TAG, "Diversity receiver on GPIO%d disabled", diversity_gpios[i]);
+            continue;
+        }
+        ESP_LOGI(TAG, "Diversity receiver %d on GPIO%d", num_receivers, diversity_gpios[i]);
+        num_receivers++;
+    }
+#endif
+
+#if IR_CARRIER_RX_GPIO >= 0
+    // Configure carrier measurement channel (non-demodulating photodiode)
+    carrier_queue = xQueueCreate(2, sizeof(rmt_rx_done_event_data_t));
+    if (carrier_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create carrier queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    rmt_rx_channel_config_t carrier_rx_config = {
+        .gpio_num = IR_CARRIER_RX_GPIO,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = CARRIER_RX_RESOLUTION_HZ,
+        .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+        .intr_priority = 0,
+        .flags.invert_in = true,   // Photodiode modules are active-LOW
+        .flags.io_loop_back = false,
+        .flags.with_dma = false,
+    };
+
+    ret = rmt_new_rx_channel(&carrier_rx_config, &carrier_rx_channel);
+    if (ret != ESP_OK) {
+        // Not fatal - learning falls back to protocol table carriers
+        ESP_LOGW(TAG, "Carrier measurement disabled: %s", esp_err_to_name(ret));
+        carrier_rx_channel = NULL;
+    } else {
+        rmt_rx_event_callbacks_t carrier_cbs = {
+            .on_recv_done = rmt_rx_done_callback,
+        };
+        rmt_rx_register_event_callbacks(carrier_rx_channel, &carrier_cbs, carrier_queue);
+        rmt_enable(carrier_rx_channel);
+
+        carrier_receive_config.signal_range_min_ns = CARRIER_RX_GLITCH_NS;
+        carrier_receive_config.signal_range_max_ns = CARRIER_RX_IDLE_NS;
+        ESP_LOGI(TAG, "Carrier measurement enabled on GPIO%d", IR_CARRIER_RX_GPIO);
+    }
+#endif
 
     // Configure receive parameters
     receive_config.signal_range_min_ns = 1250;
-    receive_config.signal_range_max_ns = 10000000;
+    receive_config.signal_range_max_ns = IR_RX_IDLE_NS;
     receive_config.flags.en_partial_rx = false;
 
     // Start receiving
-    ret = rmt_receive(rx_channel, raw_symbols, sizeof(raw_symbols), &receive_config);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start receiving: %s", esp_err_to_name(ret));
-        return ret;
+    ir_rx_arm();
+    if (!receivers[0].armed) {
+        ESP_LOGE(TAG, "Failed to start receiving");
+        return ESP_FAIL;
     }
 
     // Create IR receive task
@@ -1412,6 +2127,13 @@ esp_err_t ir_control_init(void)
         return ret;
     }
 
+    // Transmit-ready table, filled as codes are loaded and learned
+    ret = ir_code_table_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create code table");
+        return ret;
+    }
+
     // Load saved codes from NVS
     ir_load_all_codes();
 
@@ -1439,6 +2161,9 @@ esp_err_t ir_learn_start(ir_button_t button, uint32_t timeout_ms)
     learning_mode = true;
     current_learning_button = button;
 
+    // Start sampling the photodiode (no-op when not fitted)
+    ir_carrier_capture_arm();
+
     // Start timeout timer
     esp_timer_start_once(learning_timer, timeout_ms * 1000);
 
@@ -1459,202 +2184,782 @@ esp_err_t ir_learn_stop(void)
     learning_mode = false;
     current_learning_button = IR_BTN_MAX;
 
-    return ESP_OK;
+    return ESP_OK;
+}
+
+bool ir_is_learning(void)
+{
+    return learning_mode;
+}
+
+/* Synchronous learning support */
+static SemaphoreHandle_t learn_sync_sem = NULL;
+static ir_code_t *learn_sync_code = NULL;
+static esp_err_t learn_sync_result = ESP_OK;
+
+static void learn_sync_success_cb(ir_button_t button, ir_code_t *code, void *arg)
+{
+    if (learn_sync_code && code) {
+        ir_code_copy(learn_sync_code, code);
+        learn_sync_result = ESP_OK;
+    }
+    if (learn_sync_sem) {
+        xSemaphoreGive(learn_sync_sem);
+    }
+}
+
+static void learn_sync_fail_cb(ir_button_t button, void *arg)
+{
+    learn_sync_result = ESP_ERR_TIMEOUT;
+    if (learn_sync_sem) {
+        xSemaphoreGive(learn_sync_sem);
+    }
+}
+
+esp_err_t ir_learn_code(uint32_t timeout_ms, ir_code_t *code)
+{
+    if (!code) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (timeout_ms == 0) {
+        timeout_ms = IR_LEARN_TIMEOUT_MS;
+    }
+
+    /* Create semaphore if not exists */
+    if (learn_sync_sem == NULL) {
+        learn_sync_sem = xSemaphoreCreateBinary();
+        if (learn_sync_sem == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    /* Save original callbacks */
+    ir_callbacks_t original_callbacks = callbacks;
+
+    /* Set temporary callbacks for synchronous operation */
+    ir_callbacks_t sync_callbacks = {
+        .learn_success_cb = learn_sync_success_cb,
+        .learn_fail_cb = learn_sync_fail_cb,
+        .receive_cb = NULL,
+        .user_arg = NULL
+    };
+
+    learn_sync_code = code;
+    learn_sync_result = ESP_FAIL;
+    callbacks = sync_callbacks;
+
+    /* Start learning */
+    esp_err_t err = ir_learn_start(IR_BTN_CUSTOM_1, timeout_ms);
+    if (err != ESP_OK) {
+        callbacks = original_callbacks;
+        return err;
+    }
+
+    /* Wait for callback with timeout */
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms + 1000); // Extra 1s margin
+    if (xSemaphoreTake(learn_sync_sem, ticks) == pdTRUE) {
+        /* Callback was triggered */
+        err = learn_sync_result;
+    } else {
+        /* Timeout */
+        err = ESP_ERR_TIMEOUT;
+        ir_learn_stop();
+    }
+
+    /* Restore original callbacks */
+    callbacks = original_callbacks;
+    learn_sync_code = NULL;
+
+    return err;
+}
+
+/* ============================================================================
+ * PAYLOAD SYMBOL BUILDER
+ * ============================================================================ */
+
+/**
+ * @brief Append one mark/space symbol
+ */
+static inline bool ir_push_symbol(rmt_symbol_word_t *symbols, size_t *count, size_t max_symbols,
+                                  uint16_t mark_us, uint16_t space_us)
+{
+    if (*count >= max_symbols) {
+        return false;
+    }
+    symbols[(*count)++] = (rmt_symbol_word_t) {
+        .level0 = 1, .duration0 = mark_us,
+        .level1 = 0, .duration1 = space_us,
+    };
+    return true;
+}
+
+/**
+ * @brief Build TX symbols for a payload code from the protocol table
+ *
+ * Header, payload bits (LSB or MSB first, pulse distance or pulse width)
+ * and stop bit, using the same constants the decoders match against.
+ * A two-frame Daikin payload is split back into its frames.
+ */
+static size_t ir_build_table_symbols(const ir_code_t *code, const ir_protocol_constants_t *proto,
+                                     rmt_symbol_word_t *symbols, size_t max_symbols)
+{
+    size_t len;
+    const uint8_t *payload = ir_code_get_payload(code, &len);
+    if (payload == NULL) {
+        return 0;
+    }
+
+    uint16_t bits = code->bits < len * 8 ? code->bits : (uint16_t)(len * 8);
+    bool msb_first = (proto->flags & PROTOCOL_IS_MSB_FIRST) || (code->flags & IR_FLAG_MSB_FIRST);
+    bool pulse_width = (proto->flags & PROTOCOL_IS_PULSE_WIDTH) != 0;
+    bool stop_bit = !pulse_width && !(proto->flags & PROTOCOL_NO_STOP_BIT);
+    uint16_t split = (code->protocol == IR_PROTOCOL_DAIKIN && len == DAIKIN_TOTAL_BYTES)
+                         ? DAIKIN_FRAME1_BYTES * 8 : bits;
+
+    size_t count = 0;
+    uint16_t bit = 0;
+
+    while (bit < bits) {
+        uint16_t frame_end = bit < split ? split : bits;
+        uint16_t gap_us = frame_end < bits ? DAIKIN_GAP : proto->zero_space_us;
+
+        if (proto->header_mark_us &&
+            !ir_push_symbol(symbols, &count, max_symbols, proto->header_mark_us, proto->header_space_us)) {
+            return 0;
+        }
+
+        for (; bit < frame_end; bit++) {
+            uint16_t index = msb_first ? (bits - 1 - bit) : bit;
+            bool one = (payload[index / 8] >> (index % 8)) & 1;
+            uint16_t mark_us, space_us;
+
+            if (pulse_width) {
+                mark_us = one ? proto->one_space_us : proto->bit_mark_us;
+                space_us = (bit + 1 == frame_end) ? gap_us : proto->zero_space_us;
+            } else {
+                mark_us = proto->bit_mark_us;
+                space_us = one ? proto->one_space_us : proto->zero_space_us;
+            }
+            if (!ir_push_symbol(symbols, &count, max_symbols, mark_us, space_us)) {
+                return 0;
+            }
+        }
+
+        if (stop_bit && !ir_push_symbol(symbols, &count, max_symbols, proto->bit_mark_us, gap_us)) {
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Build TX symbols for a decoded code (caller frees the result)
+ *
+ * Universal decoder codes replay their recorded timing; RC5, RC6 and B&O
+ * have their own builders; other protocols with distance/width constants
+ * use the protocol table. Other bi-phase codes and codes without a payload
+ * return NULL.
+ */
+static rmt_symbol_word_t *ir_build_payload_symbols(const ir_code_t *code,
+                                                    const ir_protocol_constants_t *proto,
+                                                    size_t *num_symbols)
+{
+    *num_symbols = 0;
+
+    size_t len;
+    const uint8_t *payload = ir_code_get_payload(code, &len);
+    if (payload == NULL) {
+        return NULL;
+    }
+
+    if (code->protocol == IR_PROTOCOL_PULSE_DISTANCE || code->protocol == IR_PROTOCOL_PULSE_WIDTH) {
+        ir_dw_frame_t frame;
+        if (ir_dw_unpack(payload, len, &frame) != ESP_OK) {
+            return NULL;
+        }
+        // Header + stop + up to two idle symbols for a long gap, per frame
+        size_t max_symbols = frame.total_bits + 4 * frame.num_frames;
+        rmt_symbol_word_t *symbols = malloc(max_symbols * sizeof(rmt_symbol_word_t));
+        if (symbols != NULL) {
+            *num_symbols = ir_dw_build_symbols(&frame, symbols, max_symbols);
+        }
+        return symbols;
+    }
+
+    size_t (*build)(const ir_code_t *, rmt_symbol_word_t *, size_t) = NULL;
+    switch (code->protocol) {
+        case IR_PROTOCOL_RC5:           build = ir_rc5_build_symbols; break;
+        case IR_PROTOCOL_RC6:           build = ir_rc6_build_symbols; break;
+        case IR_PROTOCOL_BANG_OLUFSEN:  build = ir_bang_olufsen_build_symbols; break;
+        default:                        break;
+    }
+    if (build != NULL) {
+        // At most one symbol per bit plus leader, prefix and trailer
+        size_t max_symbols = code->bits + 8;
+        rmt_symbol_word_t *symbols = malloc(max_symbols * sizeof(rmt_symbol_word_t));
+        if (symbols != NULL) {
+            *num_symbols = build(code, symbols, max_symbols);
+        }
+        return symbols;
+    }
+
+    if (proto == NULL || (proto->flags & PROTOCOL_IS_BIPHASE) || proto->bit_mark_us == 0) {
+        return NULL;
+    }
+
+    // Header + stop bit per frame (at most two frames)
+    size_t max_symbols = code->bits + 4;
+    rmt_symbol_word_t *symbols = malloc(max_symbols * sizeof(rmt_symbol_word_t));
+    if (symbols != NULL) {
+        *num_symbols = ir_build_table_symbols(code, proto, symbols, max_symbols);
+    }
+    return symbols;
+}
+
+/**
+ * @brief Build the symbols the NEC or Samsung encoder emits for a code
+ *
+ * Same stream as rmt_encode_nec() / rmt_encode_samsung(): leading symbol,
+ * the 32 data bits in memory byte order (MSB first in each byte), and the
+ * ending symbol. Caller frees the result.
+ */
+static rmt_symbol_word_t *ir_build_encoder_symbols(const ir_code_t *code, size_t *num_symbols)
+{
+    const size_t max_symbols = 2 + 32;
+    rmt_symbol_word_t *symbols = malloc(max_symbols * sizeof(rmt_symbol_word_t));
+    *num_symbols = 0;
+    if (symbols == NULL) {
+        return NULL;
+    }
+
+    bool samsung = (code->protocol == IR_PROTOCOL_SAMSUNG);
+    size_t n = 0;
+    symbols[n++] = (rmt_symbol_word_t) {
+        .level0 = 1,
+        .duration0 = samsung ? SAMSUNG_LEADING_CODE_HIGH_US : NEC_LEADING_CODE_HIGH_US,
+        .level1 = 0,
+        .duration1 = samsung ? SAMSUNG_LEADING_CODE_LOW_US : NEC_LEADING_CODE_LOW_US,
+    };
+
+    const uint8_t *bytes = (const uint8_t *)&code->data;
+    for (int i = 0; i < 4; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            bool one = (bytes[i] >> bit) & 1;
+            symbols[n++] = (rmt_symbol_word_t) {
+                .level0 = 1,
+                .duration0 = one ? NEC_PAYLOAD_ONE_HIGH_US : NEC_PAYLOAD_ZERO_HIGH_US,
+                .level1 = 0,
+                .duration1 = one ? NEC_PAYLOAD_ONE_LOW_US : NEC_PAYLOAD_ZERO_LOW_US,
+            };
+        }
+    }
+
+    symbols[n++] = (rmt_symbol_word_t) {
+        .level0 = 1,
+        .duration0 = NEC_PAYLOAD_ZERO_HIGH_US,
+        .level1 = 0,
+        .duration1 = 0x7FFF,
+    };
+
+    *num_symbols = n;
+    return symbols;
+}
+
+/* ============================================================================
+ * PUBLIC API - TRANSMISSION
+ * ============================================================================ */
+
+/**
+ * @brief Configure an emitter's carrier for a code
+ *
+ * Prefers the carrier stored with the code (measured during learning),
+ * falls back to the protocol table, then the emitter default. The channel
+ * is only reprogrammed when the carrier changes.
+ */
+static esp_err_t ir_apply_code_carrier(ir_emitter_t *em, const ir_code_t *code,
+                                       const ir_protocol_constants_t *proto)
+{
+    // ========== MULTI-FREQUENCY CARRIER SUPPORT ==========
+    uint32_t carrier_hz = code->carrier_freq_hz;
+    if (carrier_hz < IR_CARRIER_MIN_HZ || carrier_hz > IR_CARRIER_MAX_HZ) {
+        carrier_hz = proto ? (proto->carrier_khz * 1000) : em->default_carrier_hz;
+    }
+
+    uint8_t duty_percent = code->duty_cycle_percent;
+    if (duty_percent < 10 || duty_percent > 90) {
+        duty_percent = 33;
+    }
+
+    if (carrier_hz != em->carrier_hz || duty_percent != em->duty_percent) {
+        rmt_carrier_config_t carrier_cfg = {
+            .frequency_hz = carrier_hz,
+            .duty_cycle = duty_percent / 100.0f,
+            .flags.polarity_active_low = false,
+        };
+
+        esp_err_t ret = rmt_apply_carrier(em->channel, &carrier_cfg);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to set carrier to %lu Hz", carrier_hz);
+            return ret;
+        }
+        em->carrier_hz = carrier_hz;
+        em->duty_percent = duty_percent;
+    }
+
+    ESP_LOGI(TAG, "Transmitting %s @ %lu Hz (%d%% duty) on GPIO%d",
+             ir_protocol_to_string(code->protocol), carrier_hz, duty_percent, em->gpio_num);
+    return ESP_OK;
+}
+
+/**
+ * @brief Wait for an emitter's previous frame and take the emitter
+ */
+static esp_err_t ir_emitter_claim(ir_emitter_t *em)
+{
+    if (xSemaphoreTake(em->idle, pdMS_TO_TICKS(IR_TX_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGE(TAG, "Emitter on GPIO%d busy", em->gpio_num);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // The previous frame is out; its buffer can go
+    free(em->symbols);
+    em->symbols = NULL;
+    return ESP_OK;
+}
+
+/**
+ * @brief Queue one frame on an emitter
+ *
+ * Waits for the emitter's previous frame, then hands the frame to the RMT
+ * driver and returns without waiting for it. Everything the encoders read
+ * while the frame is out (the code, the symbols) is copied into the
+ * emitter, so callers may release their buffers immediately, unless
+ * @p borrow is set: the symbols are then sent in place and must outlive
+ * the frame. The emitter stays busy until the TX done interrupt.
+ *
+ * @param symbols Pre-built symbols, or NULL to encode @p code
+ */
+static esp_err_t ir_emitter_queue(ir_emitter_t *em, const ir_code_t *code,
+                                  const rmt_symbol_word_t *symbols, size_t num_symbols,
+                                  bool borrow)
+{
+    esp_err_t ret = ir_emitter_claim(em);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    const ir_protocol_constants_t *proto = ir_get_protocol_constants(code->protocol);
+    ret = ir_apply_code_carrier(em, code, proto);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(em->idle);
+        return ret;
+    }
+
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+    };
+    rmt_encoder_handle_t encoder = em->copy_encoder;
+    const rmt_symbol_word_t *tx_symbols = NULL;
+
+    if (symbols != NULL && borrow) {
+        tx_symbols = symbols;
+    } else if (symbols != NULL) {
+        em->symbols = malloc(num_symbols * sizeof(rmt_symbol_word_t));
+        if (em->symbols == NULL) {
+            xSemaphoreGive(em->idle);
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(em->symbols, symbols, num_symbols * sizeof(rmt_symbol_word_t));
+    } else if (code->protocol == IR_PROTOCOL_NEC || code->protocol == IR_PROTOCOL_APPLE) {
+        encoder = em->nec_encoder;
+    } else if (code->protocol == IR_PROTOCOL_SAMSUNG) {
+        encoder = em->samsung_encoder;
+    } else if (code->protocol == IR_PROTOCOL_RAW) {
+        // RAW symbols as captured
+        if (code->raw_data == NULL || code->raw_length == 0) {
+            ESP_LOGE(TAG, "RAW code has no symbols");
+            xSemaphoreGive(em->idle);
+            return ESP_ERR_INVALID_STATE;
+        }
+        num_symbols = code->raw_length;
+        em->symbols = malloc(num_symbols * sizeof(rmt_symbol_word_t));
+        if (em->symbols == NULL) {
+            xSemaphoreGive(em->idle);
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(em->symbols, code->raw_data, num_symbols * sizeof(rmt_symbol_word_t));
+    } else {
+        // Symbols rebuilt from the payload; without timing fall back to
+        // the NEC encoder (most compatible)
+        em->symbols = ir_build_payload_symbols(code, proto, &num_symbols);
+        if (em->symbols == NULL || num_symbols == 0) {
+            ESP_LOGI(TAG, "Using NEC encoder for %s protocol", ir_protocol_to_string(code->protocol));
+            free(em->symbols);
+            em->symbols = NULL;
+            encoder = em->nec_encoder;
+        }
+    }
+
+    if (encoder == em->copy_encoder) {
+        ret = rmt_transmit(em->channel, encoder, tx_symbols ? tx_symbols : em->symbols,
+                           num_symbols * sizeof(rmt_symbol_word_t), &tx_config);
+    } else {
+        // Protocol encoders read the payload from the code during the frame
+        em->code = *code;
+        ret = rmt_transmit(em->channel, encoder, &em->code, sizeof(ir_code_t), &tx_config);
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "%s transmission error: %s",
+                 ir_get_protocol_name(code->protocol), esp_err_to_name(ret));
+        free(em->symbols);
+        em->symbols = NULL;
+        xSemaphoreGive(em->idle);
+    }
+    return ret;
+}
+
+static esp_err_t ir_emitter_start(ir_emitter_t *em, const ir_code_t *code,
+                                  const rmt_symbol_word_t *symbols, size_t num_symbols)
+{
+    return ir_emitter_queue(em, code, symbols, num_symbols, false);
+}
+
+/**
+ * @brief Wait for an emitter to go idle without claiming it
+ */
+static esp_err_t ir_emitter_wait(ir_emitter_t *em, uint32_t timeout_ms)
+{
+    if (xSemaphoreTake(em->idle, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    xSemaphoreGive(em->idle);
+    return ESP_OK;
+}
+
+/**
+ * @brief Send a frame on an emitter and wait for it
+ */
+static esp_err_t ir_emitter_send(ir_emitter_t *em, const ir_code_t *code,
+                                 const rmt_symbol_word_t *symbols, size_t num_symbols)
+{
+    esp_err_t ret = ir_emitter_start(em, code, symbols, num_symbols);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = ir_emitter_wait(em, IR_TX_TIMEOUT_MS);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "✓ Transmitted %s code (%d bits)",
+                 ir_get_protocol_name(code->protocol), code->bits);
+    } else {
+        ESP_LOGE(TAG, "%s transmission error: %s",
+                 ir_get_protocol_name(code->protocol), esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t ir_transmit(ir_code_t *code)
+{
+    return ir_transmit_on(IR_TX_EMITTER_DEFAULT, code);
+}
+
+esp_err_t ir_transmit_on(uint8_t emitter, const ir_code_t *code)
+{
+    if (code == NULL || emitter >= num_emitters) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return ir_emitter_send(&emitters[emitter], code, NULL, 0);
+}
+
+esp_err_t ir_transmit_symbols(const ir_code_t *code, const void *symbols, size_t num_symbols)
+{
+    return ir_transmit_symbols_on(IR_TX_EMITTER_DEFAULT, code, symbols, num_symbols);
+}
+
+esp_err_t ir_transmit_symbols_on(uint8_t emitter, const ir_code_t *code,
+                                 const void *symbols, size_t num_symbols)
+{
+    if (code == NULL || symbols == NULL || num_symbols == 0 || emitter >= num_emitters) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return ir_emitter_send(&emitters[emitter], code,
+                           (const rmt_symbol_word_t *)symbols, num_symbols);
 }
 
-bool ir_is_learning(void)
+esp_err_t ir_transmit_async(uint8_t emitter, const ir_code_t *code)
 {
-    return learning_mode;
-}
+    if (code == NULL || emitter >= num_emitters) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-/* Synchronous learning support */
-static SemaphoreHandle_t learn_sync_sem = NULL;
-static ir_code_t *learn_sync_code = NULL;
-static esp_err_t learn_sync_result = ESP_OK;
+    return ir_emitter_start(&emitters[emitter], code, NULL, 0);
+}
 
-static void learn_sync_success_cb(ir_button_t button, ir_code_t *code, void *arg)
+esp_err_t ir_transmit_symbols_async(uint8_t emitter, const ir_code_t *code,
+                                    const void *symbols, size_t num_symbols)
 {
-    if (learn_sync_code && code) {
-        memcpy(learn_sync_code, code, sizeof(ir_code_t));
-        learn_sync_result = ESP_OK;
-    }
-    if (learn_sync_sem) {
-        xSemaphoreGive(learn_sync_sem);
+    if (code == NULL || symbols == NULL || num_symbols == 0 || emitter >= num_emitters) {
+        return ESP_ERR_INVALID_ARG;
     }
+
+    return ir_emitter_start(&emitters[emitter], code,
+                            (const rmt_symbol_word_t *)symbols, num_symbols);
 }
 
-static void learn_sync_fail_cb(ir_button_t button, void *arg)
+esp_err_t ir_transmit_span_async(uint8_t emitter, const ir_code_t *code,
+                                 const void *symbols, size_t num_symbols)
 {
-    learn_sync_result = ESP_ERR_TIMEOUT;
-    if (learn_sync_sem) {
-        xSemaphoreGive(learn_sync_sem);
+    if (code == NULL || symbols == NULL || num_symbols == 0 || emitter >= num_emitters) {
+        return ESP_ERR_INVALID_ARG;
     }
+
+    return ir_emitter_queue(&emitters[emitter], code,
+                            (const rmt_symbol_word_t *)symbols, num_symbols, true);
 }
 
-esp_err_t ir_learn_code(uint32_t timeout_ms, ir_code_t *code)
+esp_err_t ir_render_code(const ir_code_t *code, void **symbols, size_t *num_symbols)
 {
-    if (!code) {
+    if (code == NULL || symbols == NULL || num_symbols == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (timeout_ms == 0) {
-        timeout_ms = IR_LEARN_TIMEOUT_MS;
-    }
+    rmt_symbol_word_t *out = NULL;
+    size_t count = 0;
 
-    /* Create semaphore if not exists */
-    if (learn_sync_sem == NULL) {
-        learn_sync_sem = xSemaphoreCreateBinary();
-        if (learn_sync_sem == NULL) {
-            return ESP_ERR_NO_MEM;
+    if (code->protocol == IR_PROTOCOL_RAW) {
+        if (code->raw_data == NULL || code->raw_length == 0) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        count = code->raw_length;
+        out = malloc(count * sizeof(rmt_symbol_word_t));
+        if (out != NULL) {
+            memcpy(out, code->raw_data, count * sizeof(rmt_symbol_word_t));
+        }
+    } else if (code->protocol == IR_PROTOCOL_NEC || code->protocol == IR_PROTOCOL_APPLE ||
+               code->protocol == IR_PROTOCOL_SAMSUNG) {
+        out = ir_build_encoder_symbols(code, &count);
+    } else {
+        // Same fallback as ir_emitter_start(): NEC timing without a table
+        out = ir_build_payload_symbols(code, ir_get_protocol_constants(code->protocol), &count);
+        if (out == NULL || count == 0) {
+            free(out);
+            out = ir_build_encoder_symbols(code, &count);
         }
     }
 
-    /* Save original callbacks */
-    ir_callbacks_t original_callbacks = callbacks;
+    if (out == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    *symbols = out;
+    *num_symbols = count;
+    return ESP_OK;
+}
 
-    /* Set temporary callbacks for synchronous operation */
-    ir_callbacks_t sync_callbacks = {
-        .learn_success_cb = learn_sync_success_cb,
-        .learn_fail_cb = learn_sync_fail_cb,
-        .receive_cb = NULL,
-        .user_arg = NULL
-    };
+esp_err_t ir_tx_wait_done(uint8_t emitter, uint32_t timeout_ms)
+{
+    if (emitter >= num_emitters) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    learn_sync_code = code;
-    learn_sync_result = ESP_FAIL;
-    callbacks = sync_callbacks;
+    return ir_emitter_wait(&emitters[emitter], timeout_ms);
+}
 
-    /* Start learning */
-    esp_err_t err = ir_learn_start(IR_BTN_CUSTOM_1, timeout_ms);
-    if (err != ESP_OK) {
-        callbacks = original_callbacks;
-        return err;
+esp_err_t ir_tx_wait_all_done(uint32_t timeout_ms)
+{
+    esp_err_t ret = ESP_OK;
+    for (uint8_t i = 0; i < num_emitters; i++) {
+        if (ir_emitter_wait(&emitters[i], timeout_ms) != ESP_OK) {
+            ret = ESP_ERR_TIMEOUT;
+        }
     }
+    return ret;
+}
 
-    /* Wait for callback with timeout */
-    TickType_t ticks = pdMS_TO_TICKS(timeout_ms + 1000); // Extra 1s margin
-    if (xSemaphoreTake(learn_sync_sem, ticks) == pdTRUE) {
-        /* Callback was triggered */
-        err = learn_sync_result;
-    } else {
-        /* Timeout */
-        err = ESP_ERR_TIMEOUT;
-        ir_learn_stop();
+esp_err_t ir_transmit_button(ir_button_t button)
+{
+    if (button >= IR_BTN_MAX) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    /* Restore original callbacks */
-    callbacks = original_callbacks;
-    learn_sync_code = NULL;
+    // One lookup: pre-rendered symbols go straight to the emitter
+    esp_err_t ret = ir_code_table_transmit(IR_CODE_TABLE_ROW_BUTTONS, button,
+                                           IR_TX_EMITTER_DEFAULT, true);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Transmitted button '%s'", button_names[button]);
+    }
+    if (ret != ESP_ERR_NOT_FOUND) {
+        return ret;
+    }
 
-    return err;
+    // Not resident (arena full): encode from the learned table
+    if (!ir_is_learned(button)) {
+        ESP_LOGW(TAG, "Button '%s' not learned", button_names[button]);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_LOGI(TAG, "Transmitting button '%s'", button_names[button]);
+
+    // Send a copy so the RX task is never kept off the lock by a frame
+    ir_code_t code;
+    codes_lock();
+    ret = ir_code_copy(&code, &learned_codes[button]);
+    codes_unlock();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = ir_transmit(&code);
+    ir_code_free(&code);
+    return ret;
 }
 
 /* ============================================================================
- * PUBLIC API - TRANSMISSION
+ * PUBLIC API - BROADCAST
  * ============================================================================ */
 
-esp_err_t ir_transmit(ir_code_t *code)
+/**
+ * @brief Release emitters claimed for a broadcast
+ */
+static void ir_broadcast_release(uint32_t emitter_mask)
+{
+    for (uint8_t i = 0; i < num_emitters; i++) {
+        if (emitter_mask & (1u << i)) {
+            emitters[i].broadcast = false;
+            xSemaphoreGive(emitters[i].idle);
+        }
+    }
+}
+
+esp_err_t ir_transmit_broadcast(uint32_t emitter_mask, const ir_code_t *code)
 {
-    if (code == NULL) {
+    if (code == NULL || emitter_mask == 0 || (emitter_mask >> num_emitters) != 0) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // ========== MULTI-FREQUENCY CARRIER SUPPORT ==========
-    const ir_protocol_constants_t *proto = ir_get_protocol_constants(code->protocol);
-    uint32_t carrier_hz = proto ? (proto->carrier_khz * 1000) : 38000;
+    // A single emitter needs no synchronization
+    if ((emitter_mask & (emitter_mask - 1)) == 0) {
+        return ir_transmit_on(__builtin_ctz(emitter_mask), code);
+    }
 
-    rmt_carrier_config_t carrier_cfg = {
-        .frequency_hz = carrier_hz,
-        .duty_cycle = 0.33f,
-        .flags.polarity_active_low = false,
-    };
+    // Encode once: every channel replays the same buffer through its copy encoder
+    const ir_protocol_constants_t *proto = ir_get_protocol_constants(code->protocol);
+    rmt_symbol_word_t *built_symbols = NULL;
+    const rmt_symbol_word_t *tx_symbols;
+    size_t num_symbols = 0;
+
+    if (code->protocol == IR_PROTOCOL_RAW) {
+        tx_symbols = (const rmt_symbol_word_t *)code->raw_data;
+        num_symbols = tx_symbols ? code->raw_length : 0;
+    } else if (code->protocol == IR_PROTOCOL_NEC || code->protocol == IR_PROTOCOL_APPLE ||
+               code->protocol == IR_PROTOCOL_SAMSUNG) {
+        built_symbols = ir_build_encoder_symbols(code, &num_symbols);
+        tx_symbols = built_symbols;
+    } else {
+        // No payload timing: NEC encoding, as ir_transmit() falls back to
+        built_symbols = ir_build_payload_symbols(code, proto, &num_symbols);
+        if (built_symbols == NULL || num_symbols == 0) {
+            free(built_symbols);
+            built_symbols = ir_build_encoder_symbols(code, &num_symbols);
+        }
+        tx_symbols = built_symbols;
+    }
 
-    esp_err_t ret = rmt_apply_carrier(tx_channel, &carrier_cfg);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set carrier to %lu Hz", carrier_hz);
-        return ret;
+    if (tx_symbols == NULL || num_symbols == 0) {
+        free(built_symbols);
+        return code->protocol == IR_PROTOCOL_RAW ? ESP_ERR_INVALID_STATE : ESP_ERR_NO_MEM;
     }
 
-    ESP_LOGI(TAG, "Transmitting %s @ %lu Hz", ir_protocol_to_string(code->protocol), carrier_hz);
+    xSemaphoreTake(broadcast_mutex, portMAX_DELAY);
+    while (xSemaphoreTake(broadcast_done, 0) == pdTRUE) {
+        // Drop completions left over from a timed-out broadcast
+    }
 
-    rmt_transmit_config_t tx_config = {
-        .loop_count = 0,
-    };
+    // Claim in index order so concurrent claimers cannot deadlock
+    rmt_channel_handle_t channels[IR_TX_MAX_EMITTERS];
+    uint32_t claimed = 0;
+    size_t num_channels = 0;
+    esp_err_t ret = ESP_OK;
 
-    if (code->protocol == IR_PROTOCOL_NEC || code->protocol == IR_PROTOCOL_APPLE) {
-        ret = rmt_transmit(tx_channel, nec_encoder, code, sizeof(ir_code_t), &tx_config);
-        if (ret == ESP_OK) {
-            ret = rmt_tx_wait_all_done(tx_channel, 1000);
-            if (ret == ESP_OK) {
-                ESP_LOGI(TAG, "Transmitted NEC/Apple code: 0x%08lX", code->data);
-            } else {
-                ESP_LOGE(TAG, "NEC transmission error: %s", esp_err_to_name(ret));
-            }
+    for (uint8_t i = 0; i < num_emitters && ret == ESP_OK; i++) {
+        if (!(emitter_mask & (1u << i))) {
+            continue;
         }
-    } else if (code->protocol == IR_PROTOCOL_SAMSUNG || code->protocol == IR_PROTOCOL_SAMSUNG48) {
-        ret = rmt_transmit(tx_channel, samsung_encoder, code, sizeof(ir_code_t), &tx_config);
+        ret = ir_emitter_claim(&emitters[i]);
         if (ret == ESP_OK) {
-            ret = rmt_tx_wait_all_done(tx_channel, 1000);
-            if (ret == ESP_OK) {
-                ESP_LOGI(TAG, "Transmitted Samsung code: 0x%08lX", code->data);
-            } else {
-                ESP_LOGE(TAG, "Samsung transmission error: %s", esp_err_to_name(ret));
-            }
+            claimed |= 1u << i;
+            ret = ir_apply_code_carrier(&emitters[i], code, proto);
+            emitters[i].broadcast = true;
+            channels[num_channels++] = emitters[i].channel;
         }
-    } else if (code->raw_data != NULL) {
-        // Use raw transmission for any protocol with raw_data (includes AC protocols)
-        rmt_symbol_word_t *raw_symbols = (rmt_symbol_word_t *)code->raw_data;
-        size_t num_symbols = code->raw_length;
+    }
 
-        ESP_LOGI(TAG, "Transmitting %s IR code (%d symbols)",
-                 ir_get_protocol_name(code->protocol), num_symbols);
+    // Channels in a sync manager start together once all have a frame
+    // queued; the manager is dropped again so ordinary transmissions on
+    // these channels are not held back waiting for the group
+    rmt_sync_manager_handle_t sync = NULL;
+    if (ret == ESP_OK) {
+        rmt_sync_manager_config_t sync_config = {
+            .tx_channel_array = channels,
+            .array_size = num_channels,
+        };
+        ret = rmt_new_sync_manager(&sync_config, &sync);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create sync manager: %s", esp_err_to_name(ret));
+        }
+    }
 
-        ret = rmt_transmit(tx_channel, copy_encoder, raw_symbols,
-                          num_symbols * sizeof(rmt_symbol_word_t), &tx_config);
-        if (ret == ESP_OK) {
-            ret = rmt_tx_wait_all_done(tx_channel, 1000);
-            if (ret == ESP_OK) {
-                ESP_LOGI(TAG, "✓ Transmitted %s code (%d symbols, %d bits)",
-                         ir_get_protocol_name(code->protocol), num_symbols, code->bits);
-            } else {
-                ESP_LOGE(TAG, "%s transmission error: %s",
-                         ir_get_protocol_name(code->protocol), esp_err_to_name(ret));
+    size_t queued = 0;
+    if (ret == ESP_OK) {
+        rmt_transmit_config_t tx_config = {
+            .loop_count = 0,
+        };
+        for (uint8_t i = 0; i < num_emitters && ret == ESP_OK; i++) {
+            if (claimed & (1u << i)) {
+                ret = rmt_transmit(emitters[i].channel, emitters[i].copy_encoder, tx_symbols,
+                                   num_symbols * sizeof(rmt_symbol_word_t), &tx_config);
+                if (ret == ESP_OK) {
+                    queued++;
+                }
             }
         }
-    } else {
-        // For all other decoded protocols, try NEC encoder (most compatible)
-        ESP_LOGI(TAG, "Using NEC encoder for %s protocol", ir_protocol_to_string(code->protocol));
-        ret = rmt_transmit(tx_channel, nec_encoder, code, sizeof(ir_code_t), &tx_config);
-        if (ret == ESP_OK) {
-            ret = rmt_tx_wait_all_done(tx_channel, 1000);
-            if (ret == ESP_OK) {
-                ESP_LOGI(TAG, "Transmitted %s code: 0x%08lX", ir_protocol_to_string(code->protocol), code->data);
-            } else {
-                ESP_LOGE(TAG, "Transmission error: %s", esp_err_to_name(ret));
+    }
+
+    if (ret == ESP_OK) {
+        for (size_t i = 0; i < queued; i++) {
+            if (xSemaphoreTake(broadcast_done, pdMS_TO_TICKS(IR_TX_TIMEOUT_MS)) != pdTRUE) {
+                ret = ESP_ERR_TIMEOUT;
+                break;
+            }
+        }
+    } else if (queued > 0) {
+        // Frames waiting for a sync start that will never come: abort them
+        for (uint8_t i = 0; i < num_emitters; i++) {
+            if (claimed & (1u << i)) {
+                rmt_disable(emitters[i].channel);
+                rmt_enable(emitters[i].channel);
             }
         }
     }
 
-    return ret;
-}
-
-esp_err_t ir_transmit_button(ir_button_t button)
-{
-    if (button >= IR_BTN_MAX) {
-        return ESP_ERR_INVALID_ARG;
+    if (sync) {
+        rmt_del_sync_manager(sync);
     }
+    ir_broadcast_release(claimed);
+    xSemaphoreGive(broadcast_mutex);
+    free(built_symbols);
 
-    if (!ir_is_learned(button)) {
-        ESP_LOGW(TAG, "Button '%s' not learned", button_names[button]);
-        return ESP_ERR_NOT_FOUND;
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "✓ Broadcast %s code on %d emitters (%d symbols)",
+                 ir_get_protocol_name(code->protocol), num_channels, num_symbols);
+    } else {
+        ESP_LOGE(TAG, "%s broadcast error: %s",
+                 ir_get_protocol_name(code->protocol), esp_err_to_name(ret));
     }
-
-    ESP_LOGI(TAG, "Transmitting button '%s'", button_names[button]);
-
-    xSemaphoreTake(codes_mutex, portMAX_DELAY);
-    esp_err_t ret = ir_transmit(&learned_codes[button]);
-    xSemaphoreGive(codes_mutex);
-
     return ret;
 }
 
@@ -1668,26 +2973,25 @@ esp_err_t ir_save_code(ir_button_t button, ir_code_t *code)
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t nvs_handle;
-    esp_err_t ret;
-
-    ret = nvs_open_from_partition("ir_storage", IR_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS from ir_storage partition: %s", esp_err_to_name(ret));
-        return ret;
+    if (codes_ns == NULL) {
+        return ESP_ERR_INVALID_STATE;
     }
 
+    esp_err_t ret;
     char key[20];
     snprintf(key, sizeof(key), "btn_%d", button);
 
-    // Save basic ir_code_t (without raw_data pointer)
-    ir_code_t code_to_save = *code;
-    code_to_save.raw_data = NULL;
+    // Save versioned record (header + payload, without pointers)
+    uint8_t record[IR_CODE_RECORD_MAX_SIZE];
+    size_t record_len = ir_code_serialize(code, record, sizeof(record));
+    if (record_len == 0) {
+        ESP_LOGW(TAG, "Button %d payload too long to save (%u bits)", button, code->bits);
+        return ESP_ERR_INVALID_SIZE;
+    }
 
-    ret = nvs_set_blob(nvs_handle, key, &code_to_save, sizeof(ir_code_t));
+    ret = ir_storage_set(codes_ns, key, record, record_len);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to save button %d metadata: %s", button, esp_err_to_name(ret));
-        nvs_close(nvs_handle);
         return ret;
     }
 
@@ -1696,85 +3000,120 @@ esp_err_t ir_save_code(ir_button_t button, ir_code_t *code)
         snprintf(key, sizeof(key), "raw_%d", button);
         size_t raw_size = code->raw_length * sizeof(rmt_symbol_word_t);
 
-        ret = nvs_set_blob(nvs_handle, key, code->raw_data, raw_size);
+        ret = ir_storage_set(codes_ns, key, code->raw_data, raw_size);
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to save button %d RAW data: %s", button, esp_err_to_name(ret));
         }
     }
 
-    nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
+    // Deferred inside an ir_storage batch
+    ir_storage_commit(codes_ns);
 
     ESP_LOGI(TAG, "Saved code for button '%s'", button_names[button]);
     return ESP_OK;
 }
 
-esp_err_t ir_load_code(ir_button_t button, ir_code_t *code)
+/**
+ * @brief Read one button's record (and RAW symbols) into a heap-owned code
+ *
+ * @param migrated Set when the record was a version 1 blob
+ */
+static esp_err_t ir_read_code(ir_button_t button, ir_code_t *code, bool *migrated)
 {
-    if (button >= IR_BTN_MAX || code == NULL) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    nvs_handle_t nvs_handle;
-    esp_err_t ret;
-
-    ret = nvs_open_from_partition("ir_storage", IR_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (ret != ESP_OK) {
-        return ESP_ERR_NOT_FOUND;
-    }
-
     char key[20];
-    size_t required_size = sizeof(ir_code_t);
+    uint8_t record[IR_CODE_RECORD_MAX_SIZE];
+    size_t record_len = sizeof(record);
     snprintf(key, sizeof(key), "btn_%d", button);
 
-    ret = nvs_get_blob(nvs_handle, key, code, &required_size);
+    esp_err_t ret = ir_storage_get(codes_ns, key, record, &record_len);
     if (ret != ESP_OK) {
-        nvs_close(nvs_handle);
         return ESP_ERR_NOT_FOUND;
     }
 
+    ret = ir_code_deserialize(record, record_len, code, migrated);
+    if (ret == ESP_ERR_INVALID_VERSION && migrated && *migrated) {
+        ESP_LOGW(TAG, "Code for '%s' was saved in a format that cannot be migrated; learn it again",
+                 button_names[button]);
+        return ret;
+    } else if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Unreadable code record for '%s': %s", button_names[button], esp_err_to_name(ret));
+        return ret;
+    }
+
     // If RAW protocol, load raw_data
     if (code->protocol == IR_PROTOCOL_RAW && code->raw_length > 0) {
         snprintf(key, sizeof(key), "raw_%d", button);
 
         size_t raw_size = 0;
-        ret = nvs_get_blob(nvs_handle, key, NULL, &raw_size);
+        ret = ir_storage_get(codes_ns, key, NULL, &raw_size);
         if (ret != ESP_OK || raw_size == 0) {
-            nvs_close(nvs_handle);
+            ir_code_free(code);
             return ESP_ERR_INVALID_STATE;
         }
 
         rmt_symbol_word_t *raw_data = (rmt_symbol_word_t *)malloc(raw_size);
         if (raw_data == NULL) {
-            nvs_close(nvs_handle);
+            ir_code_free(code);
             return ESP_ERR_NO_MEM;
         }
 
-        ret = nvs_get_blob(nvs_handle, key, raw_data, &raw_size);
+        ret = ir_storage_get(codes_ns, key, raw_data, &raw_size);
         if (ret != ESP_OK) {
             free(raw_data);
-            nvs_close(nvs_handle);
+            ir_code_free(code);
             return ESP_ERR_INVALID_STATE;
         }
 
         code->raw_data = (uint16_t *)raw_data;
+        code->raw_length = raw_size / sizeof(rmt_symbol_word_t);
     }
 
-    nvs_close(nvs_handle);
     return ESP_OK;
 }
 
-esp_err_t ir_save_all_codes(void)
+esp_err_t ir_load_code(ir_button_t button, ir_code_t *code)
 {
-    xSemaphoreTake(codes_mutex, portMAX_DELAY);
+    if (button >= IR_BTN_MAX || code == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (codes_ns == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    bool migrated = false;
+    esp_err_t ret = ir_read_code(button, code, &migrated);
+
+    if (ret == ESP_OK && migrated) {
+        ESP_LOGI(TAG, "Migrating '%s' to code record v%d", button_names[button], IR_CODE_RECORD_VERSION);
+        ir_save_code(button, code);
+    }
 
+    return ret;
+}
+
+esp_err_t ir_save_all_codes(void)
+{
+    // One namespace open and one commit for all buttons. Flash writes
+    // stay off the lock; each code is copied under it.
+    ir_storage_begin_batch();
     for (int i = 0; i < IR_BTN_MAX; i++) {
-        if (learned_codes[i].protocol != IR_PROTOCOL_UNKNOWN) {
-            ir_save_code((ir_button_t)i, &learned_codes[i]);
+        ir_code_t code;
+        codes_lock();
+        bool copied = learned_codes[i].protocol != IR_PROTOCOL_UNKNOWN &&
+                      ir_code_copy(&code, &learned_codes[i]) == ESP_OK;
+        codes_unlock();
+        if (copied) {
+            ir_save_code((ir_button_t)i, &code);
+            ir_code_free(&code);
         }
     }
+    esp_err_t ret = ir_storage_end_batch();
 
-    xSemaphoreGive(codes_mutex);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit IR codes: %s", esp_err_to_name(ret));
+        return ret;
+    }
 
     ESP_LOGI(TAG, "All IR codes saved");
     return ESP_OK;
@@ -1782,63 +3121,70 @@ esp_err_t ir_save_all_codes(void)
 
 esp_err_t ir_load_all_codes(void)
 {
-    nvs_handle_t nvs_handle;
     esp_err_t ret;
 
-    ret = nvs_open_from_partition("ir_storage", IR_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (ret != ESP_OK) {
+    if (codes_ns == NULL) {
         ESP_LOGI(TAG, "No saved IR codes found");
         return ESP_OK;
     }
 
-    xSemaphoreTake(codes_mutex, portMAX_DELAY);
+    codes_lock();
 
     int loaded_count = 0;
+    uint32_t migrated_mask = 0;
     for (int i = 0; i < IR_BTN_MAX; i++) {
-        char key[20];
-        size_t required_size = sizeof(ir_code_t);
-        snprintf(key, sizeof(key), "btn_%d", i);
+        ir_code_t loaded;
+        bool migrated = false;
 
-        ret = nvs_get_blob(nvs_handle, key, &learned_codes[i], &required_size);
+        ret = ir_read_code((ir_button_t)i, &loaded, &migrated);
         if (ret != ESP_OK) {
             continue;
         }
 
-        // Load RAW data if needed
-        if (learned_codes[i].protocol == IR_PROTOCOL_RAW && learned_codes[i].raw_length > 0) {
-            snprintf(key, sizeof(key), "raw_%d", i);
-
-            size_t raw_size = 0;
-            ret = nvs_get_blob(nvs_handle, key, NULL, &raw_size);
-            if (ret != ESP_OK || raw_size == 0) {
-                learned_codes[i].protocol = IR_PROTOCOL_UNKNOWN;
-                continue;
-            }
-
-            rmt_symbol_word_t *raw_data = (rmt_symbol_word_t *)malloc(raw_size);
-            if (raw_data == NULL) {
-                learned_codes[i].protocol = IR_PROTOCOL_UNKNOWN;
-                continue;
-            }
-
-            ret = nvs_get_blob(nvs_handle, key, raw_data, &raw_size);
-            if (ret != ESP_OK) {
-                free(raw_data);
-                learned_codes[i].protocol = IR_PROTOCOL_UNKNOWN;
-                continue;
-            }
+        // Long payloads and RAW symbols move into the learned-code arena
+        ret = ir_code_arena_store(&learned_arena, learned_codes, IR_BTN_MAX, i, &loaded);
+        ir_code_free(&loaded);
+        learned_mask_update(i);
+        if (ret != ESP_OK) {
+            continue;
+        }
 
-            learned_codes[i].raw_data = (uint16_t *)raw_data;
+        if (migrated) {
+            migrated_mask |= 1UL << i;
         }
 
+        ir_code_table_put(IR_CODE_TABLE_ROW_BUTTONS, i, &learned_codes[i]);
         loaded_count++;
         ESP_LOGI(TAG, "Loaded %s code for '%s'",
                  protocol_names[learned_codes[i].protocol],
                  button_names[i]);
     }
 
-    xSemaphoreGive(codes_mutex);
-    nvs_close(nvs_handle);
+    codes_unlock();
+
+    // Rewrite version 1 blobs once so later boots read the compact record.
+    // Flash writes stay off the lock; each code is copied under it.
+    if (migrated_mask) {
+        ir_storage_begin_batch();
+        for (int i = 0; i < IR_BTN_MAX; i++) {
+            if (!(migrated_mask & (1UL << i))) {
+                continue;
+            }
+            ir_code_t code;
+            codes_lock();
+            bool copied = learned_codes[i].protocol != IR_PROTOCOL_UNKNOWN &&
+                          ir_code_copy(&code, &learned_codes[i]) == ESP_OK;
+            codes_unlock();
+            if (copied) {
+                ir_save_code((ir_button_t)i, &code);
+                ir_code_free(&code);
+            }
+        }
+        ir_storage_end_batch();
+
+        ESP_LOGI(TAG, "Migrated %d code(s) to record v%d",
+                 __builtin_popcount(migrated_mask), IR_CODE_RECORD_VERSION);
+    }
 
     ESP_LOGI(TAG, "Loaded %d IR codes from NVS", loaded_count);
     return ESP_OK;
@@ -1850,30 +3196,25 @@ esp_err_t ir_clear_code(ir_button_t button)
         return ESP_ERR_INVALID_ARG;
     }
 
-    xSemaphoreTake(codes_mutex, portMAX_DELAY);
+    codes_lock();
 
-    // Free raw_data if allocated
-    if (learned_codes[button].raw_data != NULL) {
-        free(learned_codes[button].raw_data);
-    }
-
-    memset(&learned_codes[button], 0, sizeof(ir_code_t));
+    // Release payload/raw data (arena or heap)
+    ir_code_arena_release(&learned_arena, learned_codes, IR_BTN_MAX, button);
+    learned_mask_update(button);
+    ir_code_table_remove(IR_CODE_TABLE_ROW_BUTTONS, button);
 
-    xSemaphoreGive(codes_mutex);
+    codes_unlock();
 
     // Clear from NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open_from_partition("ir_storage", IR_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret == ESP_OK) {
+    if (codes_ns != NULL) {
         char key[20];
         snprintf(key, sizeof(key), "btn_%d", button);
-        nvs_erase_key(nvs_handle, key);
+        ir_storage_erase(codes_ns, key);
 
         snprintf(key, sizeof(key), "raw_%d", button);
-        nvs_erase_key(nvs_handle, key);
+        ir_storage_erase(codes_ns, key);
 
-        nvs_commit(nvs_handle);
-        nvs_close(nvs_handle);
+        ir_storage_commit(codes_ns);
     }
 
     ESP_LOGI(TAG, "Cleared code for button '%s'", button_names[button]);
@@ -1882,26 +3223,21 @@ esp_err_t ir_clear_code(ir_button_t button)
 
 esp_err_t ir_clear_all_codes(void)
 {
-    xSemaphoreTake(codes_mutex, portMAX_DELAY);
+    codes_lock();
 
-    // Free all raw_data
+    // Release all payload/raw data (arena or heap)
     for (int i = 0; i < IR_BTN_MAX; i++) {
-        if (learned_codes[i].raw_data != NULL) {
-            free(learned_codes[i].raw_data);
-        }
+        ir_code_arena_release(&learned_arena, learned_codes, IR_BTN_MAX, i);
     }
+    atomic_store(&learned_mask, 0);
+    ir_code_table_clear_row(IR_CODE_TABLE_ROW_BUTTONS);
 
-    memset(learned_codes, 0, sizeof(learned_codes));
-
-    xSemaphoreGive(codes_mutex);
+    codes_unlock();
 
     // Clear NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open_from_partition("ir_storage", IR_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret == ESP_OK) {
-        nvs_erase_all(nvs_handle);
-        nvs_commit(nvs_handle);
-        nvs_close(nvs_handle);
+    if (codes_ns != NULL) {
+        ir_storage_erase_all(codes_ns);
+        ir_storage_commit(codes_ns);
     }
 
     ESP_LOGI(TAG, "All IR codes cleared");
@@ -1918,11 +3254,8 @@ bool ir_is_learned(ir_button_t button)
         return false;
     }
 
-    xSemaphoreTake(codes_mutex, portMAX_DELAY);
-    bool learned = (learned_codes[button].protocol != IR_PROTOCOL_UNKNOWN);
-    xSemaphoreGive(codes_mutex);
-
-    return learned;
+    atomic_fetch_add_explicit(&learned_queries, 1, memory_order_relaxed);
+    return atomic_load(&learned_mask) & (1u << button);
 }
 
 const char* ir_get_button_name(ir_button_t button)
@@ -1956,3 +3289,12 @@ esp_err_t ir_register_callbacks(const ir_callbacks_t *cbs)
     ESP_LOGI(TAG, "IR callbacks registered");
     return ESP_OK;
 }
+
+esp_err_t ir_register_rx_hook(ir_rx_hook_t hook, void *arg)
+{
+    rx_hook_arg = arg;
+    rx_hook = hook;
+
+    ESP_LOGI(TAG, "IR receive hook %s", hook ? "registered" : "removed");
+    return ESP_OK;
+}
@@ -0,0 +1,1151 @@
+/**
+ * @file ir_formats.c
+ * @brief Streaming Pronto Hex, LIRC and IRDB CSV parsers and writers
+ *
+ * MIT License
+ */
+
+#include "ir_formats.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define PARSE_CHUNK             128     // Bytes pulled from the reader at a time
+#define PARSE_TOKEN_LEN         48      // Longer tokens are truncated
+#define PARSE_LINE_LEN          160     // Longest CSV row
+#define PARSE_CSV_FIELDS        8
+
+#define PRONTO_CLOCK_HZ         4145146 // Pronto time base: 0.241246 us per unit
+#define PRONTO_UNIT_PS          241246
+#define MAX_DURATION_US         0x7FFF  // rmt_symbol_word_t duration field
+
+#define DEFAULT_CARRIER_HZ      38000
+#define DEFAULT_DUTY_PERCENT    33
+
+/* LIRC flags understood by the parser */
+#define LIRC_SPACE_ENC          0x01
+#define LIRC_RAW_CODES          0x02
+#define LIRC_REVERSE            0x04
+#define LIRC_UNSUPPORTED        0x80    // RC5, RC6, SHIFT_ENC, ...
+
+/**
+ * @brief LIRC remote definition and section state
+ */
+typedef struct {
+    enum { LIRC_OUTSIDE, LIRC_REMOTE, LIRC_CODES, LIRC_RAW } section;
+    uint8_t flags;
+    uint16_t bits;
+    uint16_t pre_data_bits;
+    uint16_t post_data_bits;
+    uint64_t pre_data;
+    uint64_t post_data;
+    uint32_t header[2];
+    uint32_t one[2];
+    uint32_t zero[2];
+    uint32_t pre[2];
+    uint32_t post[2];
+    uint32_t plead;
+    uint32_t ptrail;
+    uint32_t frequency;
+    uint8_t duty_cycle;
+
+    char key[PARSE_TOKEN_LEN];  // First token of the current line
+    uint8_t value_index;        // Values seen after the key
+    uint64_t code;              // "begin codes" line value
+    bool have_code;
+    bool raw_active;            // Collecting a raw code
+    uint32_t raw_index;         // Durations collected
+} lirc_t;
+
+/**
+ * @brief Parser state (one allocation per parse)
+ */
+typedef struct {
+    ir_format_read_fn read;
+    void *read_ctx;
+    ir_format_entry_cb_t cb;
+    void *arg;
+    ir_format_stats_t stats;
+
+    char in[PARSE_CHUNK];
+    size_t in_len;
+    size_t in_pos;
+    bool eof;
+
+    char tok[PARSE_TOKEN_LEN];
+    bool tok_line_start;        // Token is the first on its line
+    bool at_line_start;
+
+    char remote[IR_FORMAT_NAME_LEN];
+    char name[IR_FORMAT_NAME_LEN];
+
+    uint32_t symbols[IR_FORMAT_MAX_SYMBOLS];
+    size_t num_symbols;
+    uint32_t pending_mark;
+    bool overflow;
+
+    lirc_t lirc;
+} parser_t;
+
+/* ============================================================================
+ * INPUT
+ * ============================================================================ */
+
+static int next_char(parser_t *p) {
+    if (p->in_pos == p->in_len) {
+        if (p->eof) {
+            return -1;
+        }
+        p->in_len = p->read(p->read_ctx, p->in, sizeof(p->in));
+        p->in_pos = 0;
+        if (p->in_len == 0) {
+            p->eof = true;
+            return -1;
+        }
+    }
+    return (unsigned char)p->in[p->in_pos++];
+}
+
+/**
+ * @brief Next whitespace-separated token; '#' starts a comment
+ */
+static bool next_token(parser_t *p) {
+    bool line_start = p->at_line_start;
+    int c;
+
+    for (;;) {
+        c = next_char(p);
+        if (c < 0) {
+            return false;
+        }
+        if (c == '#') {
+            while (c >= 0 && c != '\n') {
+                c = next_char(p);
+            }
+        }
+        if (c == '\n') {
+            p->stats.lines++;
+            line_start = true;
+        } else if (c >= 0 && !isspace(c)) {
+            break;
+        }
+    }
+
+    size_t len = 0;
+    while (c >= 0 && !isspace(c)) {
+        if (len < sizeof(p->tok) - 1) {
+            p->tok[len++] = (char)c;
+        }
+        c = next_char(p);
+    }
+    p->tok[len] = '\0';
+    p->tok_line_start = line_start;
+    p->at_line_start = (c == '\n');
+    if (c == '\n') {
+        p->stats.lines++;
+    }
+    return true;
+}
+
+/**
+ * @brief Next line without its terminator (overlong lines are truncated)
+ */
+static bool next_line(parser_t *p, char *line, size_t size) {
+    size_t len = 0;
+    int c = next_char(p);
+    if (c < 0) {
+        return false;
+    }
+    while (c >= 0 && c != '\n') {
+        if (c != '\r' && len < size - 1) {
+            line[len++] = (char)c;
+        }
+        c = next_char(p);
+    }
+    line[len] = '\0';
+    p->stats.lines++;
+    return true;
+}
+
+static bool parse_number(const char *s, uint64_t *value) {
+    char *end;
+    *value = strtoull(s, &end, 0);
+    return end != s && *end == '\0';
+}
+
+static void copy_name(char *dst, const char *src) {
+    snprintf(dst, IR_FORMAT_NAME_LEN, "%s", src);
+}
+
+/* ============================================================================
+ * SYMBOLS
+ * ============================================================================ */
+
+static void sym_reset(parser_t *p) {
+    p->num_symbols = 0;
+    p->pending_mark = 0;
+    p->overflow = false;
+}
+
+static void sym_mark(parser_t *p, uint32_t us) {
+    p->pending_mark += us;
+}
+
+static void sym_space(parser_t *p, uint32_t us) {
+    if (p->pending_mark == 0) {
+        // Leading spaces carry nothing; later ones extend the last symbol
+        if (p->num_symbols > 0) {
+            uint32_t *sym = &p->symbols[p->num_symbols - 1];
+            uint32_t space = IR_FORMAT_SYMBOL_SPACE(*sym) + us;
+            *sym = IR_FORMAT_SYMBOL(IR_FORMAT_SYMBOL_MARK(*sym),
+                                    space > MAX_DURATION_US ? MAX_DURATION_US : space);
+        }
+        return;
+    }
+    if (p->num_symbols == IR_FORMAT_MAX_SYMBOLS) {
+        p->overflow = true;
+        return;
+    }
+    uint32_t mark = p->pending_mark > MAX_DURATION_US ? MAX_DURATION_US : p->pending_mark;
+    uint32_t space = us > MAX_DURATION_US ? MAX_DURATION_US : us;
+    p->symbols[p->num_symbols++] = IR_FORMAT_SYMBOL(mark, space);
+    p->pending_mark = 0;
+}
+
+static void entry_init(parser_t *p, ir_format_entry_t *entry) {
+    memset(entry, 0, sizeof(*entry));
+    entry->remote = p->remote;
+    entry->name = p->name;
+    entry->device = -1;
+    entry->subdevice = -1;
+    entry->function = -1;
+}
+
+static esp_err_t deliver(parser_t *p, const ir_format_entry_t *entry) {
+    p->stats.parsed++;
+    return p->cb(entry, p->arg);
+}
+
+/**
+ * @brief Hand the collected symbols to the callback as a RAW code
+ */
+static esp_err_t emit_raw(parser_t *p, uint32_t carrier_hz, uint8_t duty_cycle) {
+    if (p->pending_mark > 0) {
+        sym_space(p, 0);
+    }
+    if (p->overflow || p->num_symbols == 0) {
+        p->stats.skipped++;
+        return ESP_OK;
+    }
+
+    ir_format_entry_t entry;
+    entry_init(p, &entry);
+    entry.code.protocol = IR_PROTOCOL_RAW;
+    entry.code.carrier_freq_hz = carrier_hz ? carrier_hz : DEFAULT_CARRIER_HZ;
+    entry.code.duty_cycle_percent = duty_cycle ? duty_cycle : DEFAULT_DUTY_PERCENT;
+    entry.code.raw_data = (uint16_t *)p->symbols;
+    entry.code.raw_length = (uint16_t)p->num_symbols;
+    return deliver(p, &entry);
+}
+
+/* ============================================================================
+ * PRONTO HEX
+ * ============================================================================ */
+
+typedef struct {
+    bool in_name;               // Collecting "name words:" before the hex
+    bool bad;
+    uint32_t words;
+    uint32_t header[4];         // Type, frequency, once pairs, repeat pairs
+} pronto_t;
+
+static bool is_hex_word(const char *s) {
+    return strlen(s) == 4 && isxdigit((unsigned char)s[0]) && isxdigit((unsigned char)s[1]) &&
+           isxdigit((unsigned char)s[2]) && isxdigit((unsigned char)s[3]);
+}
+
+static void pronto_token(parser_t *p, pronto_t *st) {
+    if (st->in_name) {
+        size_t len = strlen(p->tok);
+        bool last = len > 0 && p->tok[len - 1] == ':';
+        if (last) {
+            p->tok[len - 1] = '\0';
+        }
+        size_t used = strlen(p->name);
+        snprintf(p->name + used, sizeof(p->name) - used, "%s%s", used ? " " : "", p->tok);
+        st->in_name = !last;
+        return;
+    }
+
+    if (!is_hex_word(p->tok)) {
+        st->bad = true;
+        return;
+    }
+    uint32_t word = (uint32_t)strtoul(p->tok, NULL, 16);
+    uint32_t index = st->words++;
+    if (index < 4) {
+        st->header[index] = word;
+        return;
+    }
+
+    /* Use the once sequence, or the repeat sequence (which then starts at
+     * the same word) if there is none */
+    uint32_t pair_words = 2 * (st->header[2] ? st->header[2] : st->header[3]);
+    if (index >= 4 + pair_words || st->header[1] == 0) {
+        return;
+    }
+    uint32_t us = (uint32_t)(((uint64_t)word * st->header[1] * PRONTO_UNIT_PS + 500000) / 1000000);
+    if (index % 2 == 0) {
+        sym_mark(p, us);
+    } else {
+        sym_space(p, us);
+    }
+}
+
+static esp_err_t pronto_finish(parser_t *p, pronto_t *st) {
+    bool valid = !st->bad && !st->in_name && st->words >= 4 &&
+                 st->header[0] == 0x0000 && st->header[1] > 0 &&
+                 st->header[2] + st->header[3] > 0 &&
+                 st->words == 4 + 2 * (st->header[2] + st->header[3]);
+    if (!valid) {
+        if (st->words > 0 || st->in_name || p->name[0]) {
+            p->stats.skipped++;     // Includes a name with no code after it
+        }
+        return ESP_OK;
+    }
+    return emit_raw(p, PRONTO_CLOCK_HZ / st->header[1], 0);
+}
+
+static esp_err_t parse_pronto(parser_t *p) {
+    pronto_t st;
+    bool in_line = false;
+    esp_err_t err = ESP_OK;
+
+    while (err == ESP_OK && next_token(p)) {
+        if (p->tok_line_start) {
+            if (in_line) {
+                err = pronto_finish(p, &st);
+            }
+            memset(&st, 0, sizeof(st));
+            p->name[0] = '\0';
+            sym_reset(p);
+            st.in_name = !is_hex_word(p->tok);
+            in_line = true;
+        }
+        pronto_token(p, &st);
+    }
+    if (err == ESP_OK && in_line) {
+        err = pronto_finish(p, &st);
+    }
+    return err;
+}
+
+/* ============================================================================
+ * LIRC
+ * ============================================================================ */
+
+static bool near_us(uint32_t measured, uint32_t expected) {
+    return measured * 4 >= expected * 3 && measured * 4 <= expected * 5;
+}
+
+static void lirc_bits(parser_t *p, const lirc_t *l, uint64_t value, uint16_t bits) {
+    for (uint16_t i = 0; i < bits; i++) {
+        uint16_t shift = (l->flags & LIRC_REVERSE) ? i : bits - 1 - i;
+        const uint32_t *pair = ((value >> shift) & 1) ? l->one : l->zero;
+        sym_mark(p, pair[0]);
+        sym_space(p, pair[1]);
+    }
+}
+
+/**
+ * @brief Turn a 32-bit SPACE_ENC code with NEC timing into an NEC code
+ */
+static bool lirc_as_nec(const lirc_t *l, uint64_t code, ir_code_t *out) {
+    if (l->pre_data_bits + l->bits != 32 || l->post_data_bits || l->plead || l->pre[0] || l->post[0] ||
+        !near_us(l->header[0], 9000) || !near_us(l->header[1], 4500) ||
+        !near_us(l->one[0], 560) || !near_us(l->one[1], 1690) ||
+        !near_us(l->zero[0], 560) || !near_us(l->zero[1], 560)) {
+        return false;
+    }
+
+    uint32_t sent = (uint32_t)((l->pre_data << l->bits) | code);
+    uint32_t data = 0;
+    if (l->flags & LIRC_REVERSE) {
+        data = sent;
+    } else {
+        for (int i = 0; i < 32; i++) {
+            data |= ((sent >> (31 - i)) & 1u) << i;     // NEC sends LSB first
+        }
+    }
+
+    uint8_t address = data & 0xFF;
+    uint8_t address_inv = (data >> 8) & 0xFF;
+    uint8_t command = (data >> 16) & 0xFF;
+    if ((command ^ ((data >> 24) & 0xFF)) != 0xFF) {
+        return false;
+    }
+
+    out->protocol = IR_PROTOCOL_NEC;
+    out->data = data;
+    out->bits = 32;
+    out->command = command;
+    if ((address ^ address_inv) == 0xFF) {
+        out->address = address;
+    } else {
+        out->address = address | (address_inv << 8);
+        out->flags = IR_FLAG_EXTENDED;
+    }
+    out->carrier_freq_hz = l->frequency ? l->frequency : DEFAULT_CARRIER_HZ;
+    out->duty_cycle_percent = l->duty_cycle ? l->duty_cycle : DEFAULT_DUTY_PERCENT;
+    return true;
+}
+
+static esp_err_t lirc_emit_code(parser_t *p, lirc_t *l) {
+    l->have_code = false;
+    if (!(l->flags & LIRC_SPACE_ENC) || (l->flags & LIRC_UNSUPPORTED) || l->bits == 0 ||
+        l->bits > 64 || l->pre_data_bits > 64 || l->post_data_bits > 64 || l->one[0] == 0) {
+        p->stats.skipped++;
+        return ESP_OK;
+    }
+
+    ir_format_entry_t entry;
+    entry_init(p, &entry);
+    if (lirc_as_nec(l, l->code, &entry.code)) {
+        return deliver(p, &entry);
+    }
+
+    sym_reset(p);
+    if (l->header[0] || l->header[1]) {
+        sym_mark(p, l->header[0]);
+        sym_space(p, l->header[1]);
+    }
+    sym_mark(p, l->plead);
+    lirc_bits(p, l, l->pre_data, l->pre_data_bits);
+    if (l->pre[0] || l->pre[1]) {
+        sym_mark(p, l->pre[0]);
+        sym_space(p, l->pre[1]);
+    }
+    lirc_bits(p, l, l->code, l->bits);
+    if (l->post[0] || l->post[1]) {
+        sym_mark(p, l->post[0]);
+        sym_space(p, l->post[1]);
+    }
+    lirc_bits(p, l, l->post_data, l->post_data_bits);
+    sym_mark(p, l->ptrail);
+    return emit_raw(p, l->frequency, l->duty_cycle);
+}
+
+static esp_err_t lirc_finish_raw(parser_t *p, lirc_t *l) {
+    if (!l->raw_active) {
+        return ESP_OK;
+    }
+    l->raw_active = false;
+    return emit_raw(p, l->frequency, l->duty_cycle);
+}
+
+static void lirc_parse_flags(lirc_t *l, const char *value) {
+    char flags[PARSE_TOKEN_LEN];
+    copy_name(flags, value);
+    char *save = NULL;
+    for (char *flag = strtok_r(flags, "|", &save); flag; flag = strtok_r(NULL, "|", &save)) {
+        if (strcasecmp(flag, "SPACE_ENC") == 0) {
+            l->flags |= LIRC_SPACE_ENC;
+        } else if (strcasecmp(flag, "RAW_CODES") == 0) {
+            l->flags |= LIRC_RAW_CODES;
+        } else if (strcasecmp(flag, "REVERSE") == 0) {
+            l->flags |= LIRC_REVERSE;
+        } else if (strcasecmp(flag, "RC5") == 0 || strcasecmp(flag, "RC6") == 0 ||
+                   strcasecmp(flag, "SHIFT_ENC") == 0 || strcasecmp(flag, "SPACE_FIRST") == 0 ||
+                   strcasecmp(flag, "GRUNDIG") == 0 || strcasecmp(flag, "BO") == 0 ||
+                   strcasecmp(flag, "XMP") == 0 || strcasecmp(flag, "SERIAL") == 0) {
+            l->flags |= LIRC_UNSUPPORTED;
+        }
+        // CONST_LENGTH, NO_HEAD_REP, ... only affect repeats
+    }
+}
+
+/**
+ * @brief One value of a remote parameter line
+ */
+static void lirc_remote_value(parser_t *p, lirc_t *l, const char *value, uint8_t index) {
+    uint64_t n = 0;
+    bool numeric = parse_number(value, &n);
+
+    if (strcasecmp(l->key, "name") == 0 && index == 0) {
+        copy_name(p->remote, value);
+    } else if (strcasecmp(l->key, "flags") == 0) {
+        lirc_parse_flags(l, value);
+    } else if (!numeric) {
+        return;
+    } else if (strcasecmp(l->key, "bits") == 0) {
+        l->bits = (uint16_t)n;
+    } else if (strcasecmp(l->key, "pre_data_bits") == 0) {
+        l->pre_data_bits = (uint16_t)n;
+    } else if (strcasecmp(l->key, "post_data_bits") == 0) {
+        l->post_data_bits = (uint16_t)n;
+    } else if (strcasecmp(l->key, "pre_data") == 0) {
+        l->pre_data = n;
+    } else if (strcasecmp(l->key, "post_data") == 0) {
+        l->post_data = n;
+    } else if (strcasecmp(l->key, "plead") == 0) {
+        l->plead = (uint32_t)n;
+    } else if (strcasecmp(l->key, "ptrail") == 0) {
+        l->ptrail = (uint32_t)n;
+    } else if (strcasecmp(l->key, "frequency") == 0) {
+        l->frequency = (uint32_t)n;
+    } else if (strcasecmp(l->key, "duty_cycle") == 0) {
+        l->duty_cycle = (uint8_t)n;
+    } else if (index < 2) {
+        uint32_t *pair = strcasecmp(l->key, "header") == 0 ? l->header :
+                         strcasecmp(l->key, "one") == 0 ? l->one :
+                         strcasecmp(l->key, "zero") == 0 ? l->zero :
+                         strcasecmp(l->key, "pre") == 0 ? l->pre :
+                         strcasecmp(l->key, "post") == 0 ? l->post : NULL;
+        if (pair) {
+            pair[index] = (uint32_t)n;
+        }
+    }
+}
+
+static void lirc_raw_duration(parser_t *p, lirc_t *l, const char *value) {
+    uint64_t us;
+    if (!l->raw_active || !parse_number(value, &us)) {
+        return;
+    }
+    if (l->raw_index++ % 2 == 0) {
+        sym_mark(p, (uint32_t)us);
+    } else {
+        sym_space(p, (uint32_t)us);
+    }
+}
+
+/**
+ * @brief Finish the current line (codes are emitted once their line ends)
+ */
+static esp_err_t lirc_end_line(parser_t *p, lirc_t *l) {
+    if (l->section == LIRC_CODES && l->have_code) {
+        return lirc_emit_code(p, l);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t lirc_token(parser_t *p, lirc_t *l) {
+    esp_err_t err = ESP_OK;
+
+    if (p->tok_line_start) {
+        err = lirc_end_line(p, l);
+        copy_name(l->key, p->tok);
+        l->value_index = 0;
+        if (l->section == LIRC_RAW && isdigit((unsigned char)p->tok[0])) {
+            l->key[0] = '\0';
+            lirc_raw_duration(p, l, p->tok);
+        }
+        return err;
+    }
+
+    uint8_t index = l->value_index++;
+    if (strcasecmp(l->key, "begin") == 0) {
+        if (strcasecmp(p->tok, "remote") == 0) {
+            memset(l, 0, sizeof(*l));
+            l->section = LIRC_REMOTE;
+            p->remote[0] = '\0';
+        } else if (strcasecmp(p->tok, "codes") == 0 && l->section == LIRC_REMOTE) {
+            l->section = LIRC_CODES;
+        } else if (strcasecmp(p->tok, "raw_codes") == 0 && l->section == LIRC_REMOTE) {
+            l->section = LIRC_RAW;
+        }
+    } else if (strcasecmp(l->key, "end") == 0) {
+        err = lirc_finish_raw(p, l);
+        if (strcasecmp(p->tok, "remote") == 0) {
+            l->section = LIRC_OUTSIDE;
+        } else if (l->section == LIRC_CODES || l->section == LIRC_RAW) {
+            l->section = LIRC_REMOTE;
+        }
+    } else if (l->section == LIRC_REMOTE) {
+        lirc_remote_value(p, l, p->tok, index);
+    } else if (l->section == LIRC_CODES && index == 0) {
+        // "KEY_POWER 0x10EF [0x...]": the first value is the code
+        copy_name(p->name, l->key);
+        l->have_code = parse_number(p->tok, &l->code);
+        if (!l->have_code) {
+            p->stats.skipped++;
+        }
+    } else if (l->section == LIRC_RAW) {
+        if (strcasecmp(l->key, "name") == 0 && index == 0) {
+            err = lirc_finish_raw(p, l);
+            copy_name(p->name, p->tok);
+            sym_reset(p);
+            l->raw_active = true;
+            l->raw_index = 0;
+        } else {
+            lirc_raw_duration(p, l, p->tok);
+        }
+    }
+    return err;
+}
+
+static esp_err_t parse_lirc(parser_t *p) {
+    lirc_t *l = &p->lirc;
+    esp_err_t err = ESP_OK;
+
+    memset(l, 0, sizeof(*l));
+    while (err == ESP_OK && next_token(p)) {
+        err = lirc_token(p, l);
+    }
+    if (err == ESP_OK) {
+        err = lirc_end_line(p, l);
+    }
+    if (err == ESP_OK) {
+        err = lirc_finish_raw(p, l);
+    }
+    return err;
+}
+
+/* ============================================================================
+ * IRDB CSV
+ * ============================================================================ */
+
+typedef enum {
+    CSV_NEC,
+    CSV_NECX,
+    CSV_SONY12,
+    CSV_SONY15,
+    CSV_SONY20,
+    CSV_RC5,
+    CSV_RC6,
+    CSV_JVC,
+    CSV_DENON,
+} csv_protocol_t;
+
+static const struct {
+    const char *name;
+    csv_protocol_t protocol;
+} csv_protocols[] = {
+    { "NEC1", CSV_NEC },        // First name of each protocol is the one written
+    { "NEC", CSV_NEC },
+    { "NEC2", CSV_NEC },
+    { "NECx2", CSV_NECX },
+    { "NECx1", CSV_NECX },
+    { "Samsung32", CSV_NECX },
+    { "Sony12", CSV_SONY12 },
+    { "Sony15", CSV_SONY15 },
+    { "Sony20", CSV_SONY20 },
+    { "RC5", CSV_RC5 },
+    { "RC6", CSV_RC6 },
+    { "JVC", CSV_JVC },
+    { "Denon", CSV_DENON },
+    { "Sharp", CSV_DENON },
+};
+
+#define CSV_NUM_PROTOCOLS   (sizeof(csv_protocols) / sizeof(csv_protocols[0]))
+
+/**
+ * @brief Build a code from IRDB protocol, device, subdevice and function
+ */
+static bool csv_to_code(csv_protocol_t protocol, int device, int subdevice, int function, ir_code_t *code) {
+    if (device < 0 || device > 0xFF || function < 0 || function > 0xFF) {
+        return false;
+    }
+    uint32_t d = (uint32_t)device;
+    uint32_t f = (uint32_t)function;
+
+    switch (protocol) {
+        case CSV_NEC: {
+            uint32_t s = subdevice < 0 ? (~d & 0xFF) : ((uint32_t)subdevice & 0xFF);
+            code->protocol = IR_PROTOCOL_NEC;
+            code->data = d | (s << 8) | (f << 16) | ((~f & 0xFF) << 24);
+            code->bits = 32;
+            code->command = f;
+            if (s == (~d & 0xFF)) {
+                code->address = d;
+            } else {
+                code->address = d | (s << 8);
+                code->flags = IR_FLAG_EXTENDED;
+            }
+            code->carrier_freq_hz = 38000;
+            break;
+        }
+        case CSV_NECX: {
+            uint32_t s = subdevice < 0 ? d : ((uint32_t)subdevice & 0xFF);
+            code->protocol = IR_PROTOCOL_SAMSUNG;
+            code->data = d | (s << 8) | (f << 16) | ((~f & 0xFF) << 24);
+            code->bits = 32;
+            code->carrier_freq_hz = 38000;
+            break;
+        }
+        case CSV_SONY12:
+        case CSV_SONY15:
+        case CSV_SONY20:
+            if (f > 0x7F || (protocol != CSV_SONY15 && d > 0x1F)) {
+                return false;
+            }
+            code->protocol = IR_PROTOCOL_SONY;
+            code->data = f | (d << 7);
+            code->bits = protocol == CSV_SONY12 ? 12 : protocol == CSV_SONY15 ? 15 : 20;
+            if (protocol == CSV_SONY20) {
+                code->data |= ((uint32_t)(subdevice < 0 ? 0 : subdevice) & 0xFF) << 12;
+            }
+            code->address = code->data >> 7;
+            code->command = f;
+            code->carrier_freq_hz = 40000;
+            break;
+        case CSV_RC5:
+            if (d > 0x1F || f > 0x7F) {
+                return false;
+            }
+            code->protocol = IR_PROTOCOL_RC5;
+            code->data = (1u << 13) | ((f & 0x40) ? 0 : (1u << 12)) | (d << 6) | (f & 0x3F);
+            code->bits = 14;
+            code->address = d;
+            code->command = f;
+            code->carrier_freq_hz = 36000;
+            break;
+        case CSV_RC6:
+            // Mode 0, toggle 0: the data is the 16-bit payload
+            code->protocol = IR_PROTOCOL_RC6;
+            code->data = (d << 8) | f;
+            code->bits = 3 + 1 + 16;
+            code->address = d;
+            code->command = f;
+            code->carrier_freq_hz = 36000;
+            break;
+        case CSV_JVC:
+            code->protocol = IR_PROTOCOL_JVC;
+            code->data = d | (f << 8);
+            code->bits = 16;
+            code->address = d;
+            code->command = f;
+            code->carrier_freq_hz = 38000;
+            break;
+        case CSV_DENON:
+            if (d > 0x1F) {
+                return false;
+            }
+            code->protocol = IR_PROTOCOL_DENON;
+            code->data = d | (f << 5);
+            code->bits = 15;
+            code->address = d;
+            code->command = f;
+            code->carrier_freq_hz = 38000;
+            break;
+        default:
+            return false;
+    }
+    code->duty_cycle_percent = DEFAULT_DUTY_PERCENT;
+    return true;
+}
+
+/**
+ * @brief Express a code as IRDB protocol, device, subdevice and function
+ */
+static bool code_to_csv(const ir_code_t *code, csv_protocol_t *protocol,
+                        int *device, int *subdevice, int *function) {
+    uint32_t data = code->data;
+    *subdevice = -1;
+
+    switch (code->protocol) {
+        case IR_PROTOCOL_NEC:
+            if (code->bits != 32) {
+                return false;
+            }
+            *protocol = CSV_NEC;
+            *device = data & 0xFF;
+            if (((data >> 8) & 0xFF) != (~data & 0xFF)) {
+                *subdevice = (data >> 8) & 0xFF;
+            }
+            *function = (data >> 16) & 0xFF;
+            return true;
+        case IR_PROTOCOL_SAMSUNG:
+            if (code->bits != 32) {
+                return false;
+            }
+            *protocol = CSV_NECX;
+            *device = data & 0xFF;
+            *subdevice = (data >> 8) & 0xFF;
+            *function = (data >> 16) & 0xFF;
+            return true;
+        case IR_PROTOCOL_SONY:
+            *protocol = code->bits == 12 ? CSV_SONY12 : code->bits == 15 ? CSV_SONY15 : CSV_SONY20;
+            if (code->bits != 12 && code->bits != 15 && code->bits != 20) {
+                return false;
+            }
+            *function = data & 0x7F;
+            *device = (data >> 7) & (code->bits == 15 ? 0xFF : 0x1F);
+            if (code->bits == 20) {
+                *subdevice = (data >> 12) & 0xFF;
+            }
+            return true;
+        case IR_PROTOCOL_RC5:
+            *protocol = CSV_RC5;
+            *device = (data >> 6) & 0x1F;
+            *function = (data & 0x3F) | (((data >> 12) & 1) ? 0 : 0x40);
+            return true;
+        case IR_PROTOCOL_RC6:
+            if (code->bits != 3 + 1 + 16 || (data >> 17) != 0) {
+                return false;   // Only mode 0 has an IRDB form
+            }
+            *protocol = CSV_RC6;
+            *device = (data >> 8) & 0xFF;
+            *function = data & 0xFF;
+            return true;
+        case IR_PROTOCOL_JVC:
+            *protocol = CSV_JVC;
+            *device = data & 0xFF;
+            *function = (data >> 8) & 0xFF;
+            return true;
+        case IR_PROTOCOL_DENON:
+            *protocol = CSV_DENON;
+            *device = data & 0x1F;
+            *function = (data >> 5) & 0xFF;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Split a CSV row in place (double quotes protect commas)
+ */
+static size_t csv_split(char *line, char **fields, size_t max_fields) {
+    size_t count = 0;
+    char *in = line;
+
+    while (count < max_fields) {
+        while (*in == ' ' || *in == '\t') {
+            in++;
+        }
+        char *out = in;
+        fields[count++] = out;
+        bool quoted = *in == '"';
+        if (quoted) {
+            in++;
+        }
+        while (*in && (quoted || *in != ',')) {
+            if (quoted && *in == '"') {
+                if (in[1] == '"') {
+                    in++;               // Escaped quote
+                } else {
+                    quoted = false;
+                    in++;
+                    continue;
+                }
+            }
+            *out++ = *in++;
+        }
+        bool more = *in == ',';
+        *out = '\0';
+        while (out > fields[count - 1] && (out[-1] == ' ' || out[-1] == '\t')) {
+            *--out = '\0';
+        }
+        if (!more) {
+            break;
+        }
+        in++;
+    }
+    return count;
+}
+
+static esp_err_t parse_csv(parser_t *p) {
+    enum { COL_NAME, COL_PROTOCOL, COL_DEVICE, COL_SUBDEVICE, COL_FUNCTION, COL_COUNT };
+    static const char *const headers[COL_COUNT] = {
+        "functionname", "protocol", "device", "subdevice", "function"
+    };
+    int column[COL_COUNT] = { 0, 1, 2, 3, 4 };
+    char line[PARSE_LINE_LEN];
+    char *fields[PARSE_CSV_FIELDS];
+    bool first = true;
+    esp_err_t err = ESP_OK;
+
+    while (err == ESP_OK && next_line(p, line, sizeof(line))) {
+        size_t count = csv_split(line, fields, PARSE_CSV_FIELDS);
+        if (count == 1 && fields[0][0] == '\0') {
+            continue;
+        }
+
+        if (first) {
+            first = false;
+            bool header = false;
+            for (size_t i = 0; i < count; i++) {
+                for (int c = 0; c < COL_COUNT; c++) {
+                    if (strcasecmp(fields[i], headers[c]) == 0) {
+                        column[c] = (int)i;
+                        header = true;
+                    }
+                }
+            }
+            if (header) {
+                continue;
+            }
+        }
+
+        const char *protocol_name = (size_t)column[COL_PROTOCOL] < count ? fields[column[COL_PROTOCOL]] : "";
+        size_t proto = 0;
+        while (proto < CSV_NUM_PROTOCOLS && strcasecmp(protocol_name, csv_protocols[proto].name) != 0) {
+            proto++;
+        }
+
+        ir_format_entry_t entry;
+        entry_init(p, &entry);
+        copy_name(p->name, (size_t)column[COL_NAME] < count ? fields[column[COL_NAME]] : "");
+        int *values[3] = { &entry.device, &entry.subdevice, &entry.function };
+        for (int c = COL_DEVICE; c <= COL_FUNCTION; c++) {
+            if ((size_t)column[c] < count && fields[column[c]][0] != '\0') {
+                *values[c - COL_DEVICE] = (int)strtol(fields[column[c]], NULL, 0);
+            }
+        }
+
+        if (proto == CSV_NUM_PROTOCOLS ||
+            !csv_to_code(csv_protocols[proto].protocol, entry.device, entry.subdevice,
+                         entry.function, &entry.code)) {
+            p->stats.skipped++;
+            continue;
+        }
+        err = deliver(p, &entry);
+    }
+    return err;
+}
+
+/* ============================================================================
+ * PARSE API
+ * ============================================================================ */
+
+esp_err_t ir_format_parse(ir_format_t format, ir_format_read_fn read, void *read_ctx,
+                          ir_format_entry_cb_t cb, void *arg, ir_format_stats_t *stats) {
+    if (format >= IR_FORMAT_MAX || read == NULL || cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    parser_t *p = calloc(1, sizeof(parser_t));
+    if (p == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    p->read = read;
+    p->read_ctx = read_ctx;
+    p->cb = cb;
+    p->arg = arg;
+    p->at_line_start = true;
+
+    esp_err_t err;
+    switch (format) {
+        case IR_FORMAT_PRONTO: err = parse_pronto(p); break;
+        case IR_FORMAT_LIRC:   err = parse_lirc(p); break;
+        default:               err = parse_csv(p); break;
+    }
+
+    if (stats) {
+        *stats = p->stats;
+    }
+    free(p);
+    return err;
+}
+
+size_t ir_format_read_file(void *ctx, char *buf, size_t len) {
+    return fread(buf, 1, len, (FILE *)ctx);
+}
+
+size_t ir_format_read_mem(void *ctx, char *buf, size_t len) {
+    ir_format_mem_t *mem = ctx;
+    size_t left = mem->len - mem->pos;
+    if (len > left) {
+        len = left;
+    }
+    memcpy(buf, mem->data + mem->pos, len);
+    mem->pos += len;
+    return len;
+}
+
+esp_err_t ir_format_write_file(void *ctx, const char *buf, size_t len) {
+    return fwrite(buf, 1, len, (FILE *)ctx) == len ? ESP_OK : ESP_FAIL;
+}
+
+/* ============================================================================
+ * WRITERS
+ * ============================================================================ */
+
+static void emitf(ir_format_writer_t *w, const char *fmt, ...) {
+    if (w->err != ESP_OK) {
+        return;
+    }
+
+    char buf[96];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (len > 0) {
+        w->err = w->write(w->ctx, buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+    }
+}
+
+/* LIRC names are single tokens */
+static void token_name(char *out, const char *name) {
+    copy_name(out, name && name[0] ? name : "unnamed");
+    for (char *c = out; *c; c++) {
+        if (isspace((unsigned char)*c) || *c == '#') {
+            *c = '_';
+        }
+    }
+}
+
+static void write_pronto(ir_format_writer_t *w, const char *name, uint32_t carrier_hz,
+                         const uint32_t *symbols, size_t num_symbols) {
+    uint32_t freq_word = (PRONTO_CLOCK_HZ + carrier_hz / 2) / carrier_hz;
+    uint64_t unit_ps = (uint64_t)freq_word * PRONTO_UNIT_PS;
+
+    if (name && name[0]) {
+        emitf(w, "%s: ", name);
+    }
+    emitf(w, "0000 %04X %04X 0000", (unsigned)freq_word, (unsigned)num_symbols);
+    for (size_t i = 0; i < num_symbols; i++) {
+        uint32_t mark = IR_FORMAT_SYMBOL_MARK(symbols[i]);
+        uint32_t space = IR_FORMAT_SYMBOL_SPACE(symbols[i]);
+        if (space == 0) {
+            space = IR_FORMAT_DEFAULT_GAP_US;   // Pronto needs a lead-out
+        }
+        uint64_t mark_units = ((uint64_t)mark * 1000000 + unit_ps / 2) / unit_ps;
+        uint64_t space_units = ((uint64_t)space * 1000000 + unit_ps / 2) / unit_ps;
+        emitf(w, " %04X %04X", (unsigned)(mark_units ? (mark_units > 0xFFFF ? 0xFFFF : mark_units) : 1),
+              (unsigned)(space_units > 0xFFFF ? 0xFFFF : space_units));
+    }
+    emitf(w, "\n");
+}
+
+static void write_lirc(ir_format_writer_t *w, const char *name, uint32_t carrier_hz,
+                       const uint32_t *symbols, size_t num_symbols) {
+    char token[IR_FORMAT_NAME_LEN];
+
+    if (!w->header_written) {
+        token_name(token, w->remote);
+        emitf(w, "begin remote\n\n  name  %s\n  flags RAW_CODES\n  eps            30\n  aeps          100\n",
+              token);
+        emitf(w, "  frequency  %u\n  gap        %u\n\n  begin raw_codes\n",
+              (unsigned)carrier_hz, (unsigned)IR_FORMAT_DEFAULT_GAP_US);
+        w->header_written = true;
+    }
+
+    token_name(token, name);
+    emitf(w, "\n    name %s\n", token);
+    size_t column = 0;
+    for (size_t i = 0; i < num_symbols; i++) {
+        uint32_t durations[2] = { IR_FORMAT_SYMBOL_MARK(symbols[i]), IR_FORMAT_SYMBOL_SPACE(symbols[i]) };
+        for (int half = 0; half < 2; half++) {
+            if (half == 1 && (durations[1] == 0 || i + 1 == num_symbols)) {
+                break;  // Raw codes end with a pulse
+            }
+            emitf(w, "%s%7u", column == 0 ? "     " : "", (unsigned)durations[half]);
+            if (++column == 6) {
+                emitf(w, "\n");
+                column = 0;
+            }
+        }
+    }
+    if (column > 0) {
+        emitf(w, "\n");
+    }
+}
+
+esp_err_t ir_format_writer_begin(ir_format_writer_t *writer, ir_format_t format, const char *remote,
+                                 ir_format_write_fn write, void *ctx) {
+    if (writer == NULL || format >= IR_FORMAT_MAX || write == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    writer->format = format;
+    writer->write = write;
+    writer->ctx = ctx;
+    copy_name(writer->remote, remote ? remote : "");
+
+    if (format == IR_FORMAT_IRDB_CSV) {
+        emitf(writer, "functionname,protocol,device,subdevice,function\n");
+    }
+    return writer->err;
+}
+
+esp_err_t ir_format_write_code(ir_format_writer_t *writer, const char *name, const ir_code_t *code) {
+    if (writer == NULL || code == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (writer->format != IR_FORMAT_IRDB_CSV) {
+        if (code->protocol != IR_PROTOCOL_RAW || code->raw_data == NULL || code->raw_length == 0) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        return ir_format_write_symbols(writer, name, code->carrier_freq_hz,
+                                       (const uint32_t *)code->raw_data, code->raw_length);
+    }
+
+    csv_protocol_t protocol;
+    int device, subdevice, function;
+    if (!code_to_csv(code, &protocol, &device, &subdevice, &function)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    size_t proto = 0;
+    while (csv_protocols[proto].protocol != protocol) {
+        proto++;
+    }
+
+    name = name ? name : "";
+    if (strpbrk(name, ",\"")) {
+        emitf(writer, "\"");
+        for (const char *c = name; *c; c++) {
+            emitf(writer, *c == '"' ? "\"\"" : "%c", *c);
+        }
+        emitf(writer, "\"");
+    } else {
+        emitf(writer, "%s", name);
+    }
+    emitf(writer, ",%s,%d,%d,%d\n", csv_protocols[proto].name, device, subdevice, function);
+    if (writer->err == ESP_OK) {
+        writer->written++;
+    }
+    return writer->err;
+}
+
+esp_err_t ir_format_write_symbols(ir_format_writer_t *writer, const char *name, uint32_t carrier_hz,
+                                  const uint32_t *symbols, size_t num_symbols) {
+    if (writer == NULL || symbols == NULL || num_symbols == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (carrier_hz == 0) {
+        carrier_hz = DEFAULT_CARRIER_HZ;
+    }
+
+    switch (writer->format) {
+        case IR_FORMAT_PRONTO:
+            write_pronto(writer, name, carrier_hz, symbols, num_symbols);
+            break;
+        case IR_FORMAT_LIRC:
+            write_lirc(writer, name, carrier_hz, symbols, num_symbols);
+            break;
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (writer->err == ESP_OK) {
+        writer->written++;
+    }
+    return writer->err;
+}
+
+esp_err_t ir_format_writer_end(ir_format_writer_t *writer) {
+    if (writer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (writer->format == IR_FORMAT_LIRC && writer->header_written) {
+        emitf(writer, "\n  end raw_codes\n\nend remote\n");
+    }
+    return writer->err;
+}
+
+const char *ir_format_get_name(ir_format_t format) {
+    switch (format) {
+        case IR_FORMAT_PRONTO:   return "pronto";
+        case IR_FORMAT_LIRC:     return "lirc";
+        case IR_FORMAT_IRDB_CSV: return "csv";
+        default:                 return "unknown";
+    }
+}
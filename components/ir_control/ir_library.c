@@ -0,0 +1,799 @@
+/**
+ * @file ir_library.c
+ * @brief Large IR code library on the SPIFFS "storage" partition
+ *
+ * The sorted index file is never rewritten in place. Additions go to the
+ * end of irlib.dat and irlib.tail and into a small sorted RAM buffer;
+ * when the buffer fills, the index and the buffer are merged into
+ * irlib.idx.new, which then replaces irlib.idx. Every reader sees the
+ * union of both, with the buffer winning on equal keys.
+ *
+ * A merge interrupted by a power cut leaves either the old index plus
+ * the tail file (merged again at the next addition) or only
+ * irlib.idx.new (renamed at init).
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_library.h"
+#include "ir_code.h"
+#include "ir_checksum.h"
+#include "ir_storage.h"
+#include "esp_log.h"
+#include "esp_spiffs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char *TAG = "ir_library";
+
+#define LIB_DAT_PATH            IR_LIBRARY_BASE_PATH "/irlib.dat"
+#define LIB_IDX_PATH            IR_LIBRARY_BASE_PATH "/irlib.idx"
+#define LIB_IDX_NEW_PATH        IR_LIBRARY_BASE_PATH "/irlib.idx.new"
+#define LIB_TAIL_PATH           IR_LIBRARY_BASE_PATH "/irlib.tail"
+
+#define LIB_RECORD_MAGIC        0x1B
+#define LIB_CRC_POLY            0x07
+#define LIB_MERGE_CHUNK         16      // Index entries per read while merging
+
+/**
+ * @brief Index entry (irlib.idx, irlib.tail and the RAM tail)
+ */
+typedef struct {
+    char brand[IR_LIBRARY_BRAND_LEN];
+    uint8_t device;
+    uint8_t action;
+    uint16_t codeset;
+    uint32_t offset;                // Record position in irlib.dat
+    uint16_t length;                // Record length including its header
+    uint16_t popularity;
+} lib_index_entry_t;
+
+_Static_assert(sizeof(lib_index_entry_t) == 28, "index entry layout is on flash");
+
+/**
+ * @brief Record header in irlib.dat (body follows)
+ *
+ * Carries the key so the index can be rebuilt from irlib.dat alone.
+ */
+typedef struct {
+    uint8_t magic;                  // LIB_RECORD_MAGIC
+    uint8_t crc;                    // CRC-8 of the rest of the header and the body
+    uint16_t body_len;
+    char brand[IR_LIBRARY_BRAND_LEN];
+    uint8_t device;
+    uint8_t action;
+    uint16_t codeset;
+    uint16_t popularity;
+    uint16_t reserved;
+} lib_record_header_t;
+
+_Static_assert(sizeof(lib_record_header_t) == 28, "record header layout is on flash");
+
+/* Internal state */
+static bool is_initialized = false;
+static SemaphoreHandle_t lib_lock = NULL;   // Recursive: foreach callbacks may load
+static FILE *idx_file = NULL;
+static FILE *dat_file = NULL;
+static size_t idx_count = 0;
+static lib_index_entry_t tail[IR_LIBRARY_TAIL_MAX];     // Sorted
+static size_t tail_count = 0;
+static size_t tail_new = 0;                 // Tail keys not in the index
+
+/* ============================================================================
+ * KEYS
+ * ============================================================================ */
+
+static void normalize_brand(char *out, const char *brand)
+{
+    memset(out, 0, IR_LIBRARY_BRAND_LEN);
+    for (size_t i = 0; brand && brand[i] && i < IR_LIBRARY_BRAND_LEN - 1; i++) {
+        out[i] = (char)tolower((unsigned char)brand[i]);
+    }
+}
+
+/* Order: brand → device → code set → function */
+static int key_compare(const lib_index_entry_t *a, const lib_index_entry_t *b)
+{
+    int c = memcmp(a->brand, b->brand, IR_LIBRARY_BRAND_LEN);
+    if (c != 0) {
+        return c;
+    }
+    if (a->device != b->device) {
+        return a->device < b->device ? -1 : 1;
+    }
+    if (a->codeset != b->codeset) {
+        return a->codeset < b->codeset ? -1 : 1;
+    }
+    if (a->action != b->action) {
+        return a->action < b->action ? -1 : 1;
+    }
+    return 0;
+}
+
+static void make_key(lib_index_entry_t *key, const char *brand, uint8_t device,
+                     uint16_t codeset, uint8_t action)
+{
+    memset(key, 0, sizeof(*key));
+    normalize_brand(key->brand, brand);
+    key->device = device;
+    key->codeset = codeset;
+    key->action = action;
+}
+
+static void entry_to_public(const lib_index_entry_t *entry, ir_library_entry_t *out)
+{
+    memcpy(out->brand, entry->brand, IR_LIBRARY_BRAND_LEN);
+    out->device = entry->device;
+    out->action = entry->action;
+    out->codeset = entry->codeset;
+    out->popularity = entry->popularity;
+}
+
+/* ============================================================================
+ * INDEX
+ * ============================================================================ */
+
+static bool idx_read(size_t i, lib_index_entry_t *entry)
+{
+    return fseek(idx_file, (long)(i * sizeof(*entry)), SEEK_SET) == 0 &&
+           fread(entry, sizeof(*entry), 1, idx_file) == 1;
+}
+
+/**
+ * @brief First index position whose key is not below @p key
+ *
+ * One entry read per step.
+ */
+static size_t idx_lower_bound(const lib_index_entry_t *key)
+{
+    size_t lo = 0, hi = idx_count;
+    lib_index_entry_t entry;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (!idx_read(mid, &entry)) {
+            return idx_count;
+        }
+        if (key_compare(&entry, key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static bool idx_find(const lib_index_entry_t *key, lib_index_entry_t *entry)
+{
+    size_t i = idx_lower_bound(key);
+    return i < idx_count && idx_read(i, entry) && key_compare(entry, key) == 0;
+}
+
+/* First tail position whose key is not below @p key */
+static size_t tail_lower_bound(const lib_index_entry_t *key)
+{
+    size_t lo = 0, hi = tail_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (key_compare(&tail[mid], key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static const lib_index_entry_t *tail_find(const lib_index_entry_t *key)
+{
+    size_t i = tail_lower_bound(key);
+    return (i < tail_count && key_compare(&tail[i], key) == 0) ? &tail[i] : NULL;
+}
+
+/**
+ * @brief Put an entry into the RAM tail (caller ensures there is room)
+ */
+static void tail_insert(const lib_index_entry_t *entry)
+{
+    size_t i = tail_lower_bound(entry);
+    if (i < tail_count && key_compare(&tail[i], entry) == 0) {
+        tail[i] = *entry;   // Newer record of the same key
+        return;
+    }
+
+    lib_index_entry_t existing;
+    if (!idx_find(entry, &existing)) {
+        tail_new++;
+    }
+    memmove(&tail[i + 1], &tail[i], (tail_count - i) * sizeof(tail[0]));
+    tail[i] = *entry;
+    tail_count++;
+}
+
+static esp_err_t idx_open(void)
+{
+    if (idx_file) {
+        fclose(idx_file);
+    }
+    idx_file = fopen(LIB_IDX_PATH, "rb");
+    if (idx_file == NULL) {
+        idx_count = 0;
+        return ESP_FAIL;
+    }
+    setvbuf(idx_file, NULL, _IONBF, 0);   // Each probe reads exactly one entry
+
+    struct stat st;
+    if (stat(LIB_IDX_PATH, &st) != 0 || st.st_size % sizeof(lib_index_entry_t) != 0) {
+        fclose(idx_file);
+        idx_file = NULL;
+        idx_count = 0;
+        return ESP_ERR_INVALID_SIZE;
+    }
+    idx_count = st.st_size / sizeof(lib_index_entry_t);
+    return ESP_OK;
+}
+
+/**
+ * @brief Merge the tail into a new index and swap it in
+ */
+static esp_err_t lib_merge(void)
+{
+    if (tail_count == 0) {
+        return ESP_OK;
+    }
+
+    FILE *out = fopen(LIB_IDX_NEW_PATH, "wb");
+    if (out == NULL) {
+        ESP_LOGE(TAG, "Cannot create %s", LIB_IDX_NEW_PATH);
+        return ESP_FAIL;
+    }
+
+    lib_index_entry_t chunk[LIB_MERGE_CHUNK];
+    size_t chunk_len = 0, chunk_pos = 0;
+    size_t i = 0, j = 0, written = 0;
+    bool ok = true;
+
+    if (idx_count > 0 && fseek(idx_file, 0, SEEK_SET) != 0) {
+        ok = false;
+    }
+
+    while (ok && (i < idx_count || j < tail_count)) {
+        if (chunk_pos == chunk_len && i < idx_count) {
+            size_t want = idx_count - i < LIB_MERGE_CHUNK ? idx_count - i : LIB_MERGE_CHUNK;
+            chunk_len = fread(chunk, sizeof(chunk[0]), want, idx_file);
+            chunk_pos = 0;
+            if (chunk_len != want) {
+                ok = false;
+                break;
+            }
+        }
+
+        const lib_index_entry_t *next;
+        if (i >= idx_count) {
+            next = &tail[j++];
+        } else if (j >= tail_count) {
+            next = &chunk[chunk_pos++];
+            i++;
+        } else {
+            int c = key_compare(&chunk[chunk_pos], &tail[j]);
+            if (c < 0) {
+                next = &chunk[chunk_pos++];
+                i++;
+            } else {
+                if (c == 0) {
+                    chunk_pos++;    // Replaced by the tail entry
+                    i++;
+                }
+                next = &tail[j++];
+            }
+        }
+
+        ok = fwrite(next, sizeof(*next), 1, out) == 1;
+        written++;
+    }
+
+    if (fclose(out) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        remove(LIB_IDX_NEW_PATH);
+        ESP_LOGE(TAG, "Index merge failed, %u additions stay pending", (unsigned)tail_count);
+        return ESP_FAIL;
+    }
+
+    fclose(idx_file);
+    idx_file = NULL;
+    remove(LIB_IDX_PATH);
+    if (rename(LIB_IDX_NEW_PATH, LIB_IDX_PATH) != 0 || idx_open() != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot replace %s", LIB_IDX_PATH);
+        return ESP_FAIL;
+    }
+    remove(LIB_TAIL_PATH);
+
+    ESP_LOGI(TAG, "Merged %u additions, index has %u entries", (unsigned)tail_count, (unsigned)written);
+    tail_count = 0;
+    tail_new = 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief Record an appended record in the tail file and the RAM tail
+ */
+static esp_err_t lib_index_add(const lib_index_entry_t *entry)
+{
+    FILE *f = fopen(LIB_TAIL_PATH, "ab");
+    if (f == NULL) {
+        return ESP_FAIL;
+    }
+    bool ok = fwrite(entry, sizeof(*entry), 1, f) == 1;
+    if (fclose(f) != 0 || !ok) {
+        return ESP_FAIL;
+    }
+
+    tail_insert(entry);
+    return tail_count == IR_LIBRARY_TAIL_MAX ? lib_merge() : ESP_OK;
+}
+
+/* ============================================================================
+ * RECORDS
+ * ============================================================================ */
+
+static uint8_t record_crc(const lib_record_header_t *header, const uint8_t *body)
+{
+    uint8_t crc = ir_checksum_crc8((const uint8_t *)header + 2, sizeof(*header) - 2, LIB_CRC_POLY, 0);
+    return ir_checksum_crc8(body, header->body_len, LIB_CRC_POLY, crc);
+}
+
+/**
+ * @brief Read and check a record (caller frees *body)
+ */
+static esp_err_t record_read(uint32_t offset, lib_record_header_t *header, uint8_t **body)
+{
+    *body = NULL;
+    if (fseek(dat_file, offset, SEEK_SET) != 0 ||
+        fread(header, sizeof(*header), 1, dat_file) != 1 ||
+        header->magic != LIB_RECORD_MAGIC) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    uint8_t *buf = malloc(header->body_len ? header->body_len : 1);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (fread(buf, 1, header->body_len, dat_file) != header->body_len ||
+        record_crc(header, buf) != header->crc) {
+        free(buf);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    *body = buf;
+    return ESP_OK;
+}
+
+static esp_err_t record_load(const lib_index_entry_t *entry, ir_code_t *code)
+{
+    lib_record_header_t header;
+    uint8_t *body;
+    esp_err_t err = record_read(entry->offset, &header, &body);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Damaged record at %lu", (unsigned long)entry->offset);
+        return err;
+    }
+
+    memset(code, 0, sizeof(*code));
+    err = ir_code_deserialize(body, header.body_len, code, NULL);
+    if (err == ESP_OK && code->protocol == IR_PROTOCOL_RAW) {
+        // Symbols follow the code record
+        size_t raw_bytes = (size_t)code->raw_length * IR_CODE_RAW_SYMBOL_BYTES;
+        if (header.body_len != sizeof(ir_code_record_t) + raw_bytes) {
+            err = ESP_ERR_INVALID_SIZE;
+        } else if ((code->raw_data = malloc(raw_bytes)) == NULL) {
+            err = ESP_ERR_NO_MEM;
+        } else {
+            memcpy(code->raw_data, body + sizeof(ir_code_record_t), raw_bytes);
+        }
+        if (err != ESP_OK) {
+            code->raw_length = 0;
+        }
+    }
+
+    free(body);
+    return err;
+}
+
+/**
+ * @brief Rebuild the index by scanning irlib.dat
+ *
+ * Entries are fed through the tail, so RAM use stays fixed however large
+ * the library is. A damaged record is an append cut short by a power
+ * loss; records added after that reboot follow it, so the scan steps
+ * over it byte by byte until the next record whose CRC checks.
+ */
+static esp_err_t lib_rebuild_index(void)
+{
+    long dat_size = fseek(dat_file, 0, SEEK_END) == 0 ? ftell(dat_file) : -1;
+    if (dat_size < 0) {
+        return ESP_FAIL;
+    }
+    if (dat_size > 0) {
+        ESP_LOGW(TAG, "Rebuilding library index");
+    }
+
+    FILE *f = fopen(LIB_IDX_PATH, "wb");
+    if (f == NULL || fclose(f) != 0) {
+        return ESP_FAIL;
+    }
+    remove(LIB_TAIL_PATH);
+    tail_count = 0;
+    tail_new = 0;
+    esp_err_t err = idx_open();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    uint32_t offset = 0;
+    uint32_t skipped = 0;
+    lib_record_header_t header;
+    uint8_t *body;
+    while (offset + sizeof(header) <= (uint32_t)dat_size) {
+        if (record_read(offset, &header, &body) != ESP_OK) {
+            offset++;
+            skipped++;
+            continue;
+        }
+        free(body);
+
+        lib_index_entry_t entry;
+        make_key(&entry, header.brand, header.device, header.codeset, header.action);
+        entry.offset = offset;
+        entry.length = sizeof(header) + header.body_len;
+        entry.popularity = header.popularity;
+
+        tail_insert(&entry);
+        if (tail_count == IR_LIBRARY_TAIL_MAX && lib_merge() != ESP_OK) {
+            return ESP_FAIL;
+        }
+        offset += entry.length;
+    }
+    if (skipped + (dat_size - offset) > 0) {
+        ESP_LOGW(TAG, "Skipped %lu damaged bytes of %s", (unsigned long)(skipped + (dat_size - offset)),
+                 LIB_DAT_PATH);
+    }
+    return lib_merge();
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+static esp_err_t lib_mount(void)
+{
+    if (esp_spiffs_mounted(IR_LIBRARY_PARTITION)) {
+        return ESP_OK;
+    }
+
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = IR_LIBRARY_BASE_PATH,
+        .partition_label = IR_LIBRARY_PARTITION,
+        .max_files = 5,
+        .format_if_mount_failed = true,
+    };
+    esp_err_t err = esp_vfs_spiffs_register(&conf);
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGI(TAG, "No %s partition, code library disabled", IR_LIBRARY_PARTITION);
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mount %s: %s", IR_LIBRARY_PARTITION, esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t ir_library_init(void)
+{
+    if (is_initialized) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = lib_mount();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    lib_lock = xSemaphoreCreateRecursiveMutex();
+    if (lib_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    dat_file = fopen(LIB_DAT_PATH, "a+b");
+    if (dat_file == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", LIB_DAT_PATH);
+        return ESP_FAIL;
+    }
+
+    /* Finish a merge that got as far as removing the old index */
+    struct stat st;
+    if (stat(LIB_IDX_PATH, &st) != 0 && stat(LIB_IDX_NEW_PATH, &st) == 0) {
+        rename(LIB_IDX_NEW_PATH, LIB_IDX_PATH);
+    }
+    remove(LIB_IDX_NEW_PATH);
+
+    if (idx_open() != ESP_OK) {
+        err = lib_rebuild_index();
+    } else {
+        FILE *f = fopen(LIB_TAIL_PATH, "rb");
+        if (f != NULL) {
+            lib_index_entry_t entry;
+            while (err == ESP_OK && fread(&entry, sizeof(entry), 1, f) == 1) {
+                tail_insert(&entry);
+                if (tail_count == IR_LIBRARY_TAIL_MAX) {
+                    err = lib_merge();
+                }
+            }
+            fclose(f);
+        }
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Library index unusable: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    is_initialized = true;
+    ESP_LOGI(TAG, "Code library ready: %u codes", (unsigned)ir_library_get_count());
+    return ESP_OK;
+}
+
+void ir_library_deinit(void)
+{
+    if (!is_initialized) {
+        return;
+    }
+
+    xSemaphoreTakeRecursive(lib_lock, portMAX_DELAY);
+    is_initialized = false;
+    if (idx_file) {
+        fclose(idx_file);
+        idx_file = NULL;
+    }
+    fclose(dat_file);
+    dat_file = NULL;
+    idx_count = 0;
+    tail_count = 0;
+    tail_new = 0;
+    xSemaphoreGiveRecursive(lib_lock);
+
+    vSemaphoreDelete(lib_lock);
+    lib_lock = NULL;
+}
+
+esp_err_t ir_library_add(const ir_library_entry_t *entry, const ir_code_t *code)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (entry == NULL || code == NULL || entry->brand[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t raw_bytes = code->protocol == IR_PROTOCOL_RAW ?
+                       (size_t)code->raw_length * IR_CODE_RAW_SYMBOL_BYTES : 0;
+    if (code->protocol == IR_PROTOCOL_RAW && (raw_bytes == 0 || code->raw_data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t *body = malloc(IR_CODE_RECORD_MAX_SIZE + raw_bytes);
+    if (body == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    size_t body_len = ir_code_serialize(code, body, IR_CODE_RECORD_MAX_SIZE);
+    if (body_len == 0 || body_len + raw_bytes > UINT16_MAX - sizeof(lib_record_header_t)) {
+        free(body);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (raw_bytes > 0) {
+        memcpy(body + body_len, code->raw_data, raw_bytes);
+        body_len += raw_bytes;
+    }
+
+    lib_index_entry_t key;
+    make_key(&key, entry->brand, entry->device, entry->codeset, entry->action);
+    key.popularity = entry->popularity;
+
+    lib_record_header_t header = {
+        .magic = LIB_RECORD_MAGIC,
+        .body_len = body_len,
+        .device = key.device,
+        .action = key.action,
+        .codeset = key.codeset,
+        .popularity = key.popularity,
+    };
+    memcpy(header.brand, key.brand, IR_LIBRARY_BRAND_LEN);
+    header.crc = record_crc(&header, body);
+
+    xSemaphoreTakeRecursive(lib_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_FAIL;
+    if (fseek(dat_file, 0, SEEK_END) == 0) {
+        long offset = ftell(dat_file);
+        if (offset >= 0 &&
+            fwrite(&header, sizeof(header), 1, dat_file) == 1 &&
+            fwrite(body, 1, body_len, dat_file) == body_len &&
+            fflush(dat_file) == 0) {
+            key.offset = offset;
+            key.length = sizeof(header) + body_len;
+            err = lib_index_add(&key);
+        }
+    }
+
+    xSemaphoreGiveRecursive(lib_lock);
+    free(body);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add %s code: %s", key.brand, esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t ir_library_flush(void)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTakeRecursive(lib_lock, portMAX_DELAY);
+    esp_err_t err = lib_merge();
+    xSemaphoreGiveRecursive(lib_lock);
+    return err;
+}
+
+esp_err_t ir_library_lookup(const char *brand, ir_device_type_t device, uint16_t codeset,
+                            ir_action_t action, ir_code_t *code)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (brand == NULL || code == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lib_index_entry_t key, entry;
+    make_key(&key, brand, device, codeset, action);
+
+    xSemaphoreTakeRecursive(lib_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    const lib_index_entry_t *pending = tail_find(&key);
+    if (pending) {
+        err = record_load(pending, code);
+    } else if (idx_find(&key, &entry)) {
+        err = record_load(&entry, code);
+    }
+
+    xSemaphoreGiveRecursive(lib_lock);
+    return err;
+}
+
+esp_err_t ir_library_load(const ir_library_entry_t *entry, ir_code_t *code)
+{
+    if (entry == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ir_library_lookup(entry->brand, entry->device, entry->codeset, entry->action, code);
+}
+
+esp_err_t ir_library_foreach(const char *brand, ir_device_type_t device,
+                             ir_library_visit_cb_t cb, void *arg)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lib_index_entry_t start;
+    make_key(&start, brand, brand ? device : 0, 0, 0);
+
+    xSemaphoreTakeRecursive(lib_lock, portMAX_DELAY);
+
+    size_t i = idx_lower_bound(&start);
+    size_t j = tail_lower_bound(&start);
+    lib_index_entry_t from_idx;
+    bool have_idx = i < idx_count && idx_read(i, &from_idx);
+
+    while (have_idx || j < tail_count) {
+        const lib_index_entry_t *next;
+        if (!have_idx || (j < tail_count && key_compare(&tail[j], &from_idx) <= 0)) {
+            if (have_idx && key_compare(&tail[j], &from_idx) == 0) {
+                i++;    // Replaced by the tail entry
+            }
+            next = &tail[j++];
+        } else {
+            next = &from_idx;
+            i++;
+        }
+
+        if (brand && (memcmp(next->brand, start.brand, IR_LIBRARY_BRAND_LEN) != 0 ||
+                      (device != IR_DEVICE_NONE && next->device != device))) {
+            break;
+        }
+
+        ir_library_entry_t visit;
+        entry_to_public(next, &visit);
+        if (!cb(&visit, arg)) {
+            break;
+        }
+
+        // The callback may have moved the index file position
+        have_idx = i < idx_count && idx_read(i, &from_idx);
+    }
+
+    xSemaphoreGiveRecursive(lib_lock);
+    return ESP_OK;
+}
+
+typedef struct {
+    uint16_t codeset;
+    ir_device_type_t target;
+    size_t imported;
+    esp_err_t err;
+} import_ctx_t;
+
+static bool import_visit(const ir_library_entry_t *entry, void *arg)
+{
+    import_ctx_t *ctx = arg;
+    if (entry->codeset < ctx->codeset) {
+        return true;
+    }
+    if (entry->codeset > ctx->codeset) {
+        return false;   // Past the code set in key order
+    }
+
+    ir_code_t code;
+    if (ir_library_load(entry, &code) != ESP_OK) {
+        return true;    // Skip damaged records
+    }
+    esp_err_t err = ir_action_save(ctx->target, (ir_action_t)entry->action, &code);
+    ir_code_free(&code);
+
+    if (err != ESP_OK) {
+        ctx->err = err;
+        return false;
+    }
+    ctx->imported++;
+    return true;
+}
+
+esp_err_t ir_library_import_remote(const char *brand, ir_device_type_t device, uint16_t codeset,
+                                   ir_device_type_t target, size_t *imported)
+{
+    if (brand == NULL || device == IR_DEVICE_NONE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    import_ctx_t ctx = { .codeset = codeset, .target = target, .err = ESP_OK };
+    ir_storage_begin_batch();
+    esp_err_t err = ir_library_foreach(brand, device, import_visit, &ctx);
+    esp_err_t commit_err = ir_storage_end_batch();
+    if (err == ESP_OK) {
+        err = ctx.err != ESP_OK ? ctx.err : commit_err;
+    }
+    if (err == ESP_OK && ctx.imported == 0) {
+        err = ESP_ERR_NOT_FOUND;
+    }
+    if (imported) {
+        *imported = ctx.imported;
+    }
+
+    ESP_LOGI(TAG, "Imported %u codes of %s %s set %u into %s", (unsigned)ctx.imported, brand,
+             ir_action_get_device_name(device), codeset, ir_action_get_device_name(target));
+    return err;
+}
+
+size_t ir_library_get_count(void)
+{
+    return idx_count + tail_new;
+}
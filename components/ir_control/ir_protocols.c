@@ -478,15 +478,17 @@ static const ir_protocol_constants_t PROTOCOL_DATABASE[] = {
     // Reference: Arduino-IRremote/src/ir_BangOlufsen.hpp
     // WARNING: Uses 455kHz carrier - VERY different from standard 38kHz!
     // NOTE: Cannot be received with standard 38kHz receivers
+    // Pulse-position code in units of 3125us: 200us mark, mark-to-mark
+    // 1T = "0", 3T = "1", 2T = repeat previous bit, 5T start, 4T stop
     {
         .protocol = IR_PROTOCOL_BANG_OLUFSEN,
         .carrier_khz = 455,  // 455kHz! Special receiver needed
-        .header_mark_us = 3125,
-        .header_space_us = 3125,
-        .bit_mark_us = 625,
-        .one_space_us = 625,
-        .zero_space_us = 1250,
-        .flags = PROTOCOL_IS_MSB_FIRST | PROTOCOL_IS_PULSE_WIDTH,
+        .header_mark_us = 200,
+        .header_space_us = 15425,   // 5T start pulse
+        .bit_mark_us = 200,
+        .one_space_us = 9175,       // 3T - mark
+        .zero_space_us = 2925,      // 1T - mark
+        .flags = PROTOCOL_IS_MSB_FIRST | PROTOCOL_IS_PULSE_DISTANCE,
         .repeat_period_ms = 100,
         .bits = 16
     },
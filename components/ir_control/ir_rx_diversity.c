@@ -0,0 +1,210 @@
+/**
+ * @file ir_rx_diversity.c
+ * @brief Diversity combining of captures from several IR receivers
+ *
+ * Pure C (no ESP-IDF dependencies) so it can be compiled on the host and
+ * fed synthetic captures.
+ *
+ * MIT License
+ */
+
+#include "ir_rx_diversity.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool durations_match(uint32_t a, uint32_t b) {
+    uint32_t hi = a > b ? a : b;
+    uint32_t diff = a > b ? a - b : b - a;
+    uint32_t tolerance = (hi * IR_DIVERSITY_TOLERANCE_PERCENT) / 100;
+    if (tolerance < IR_DIVERSITY_TOLERANCE_US) {
+        tolerance = IR_DIVERSITY_TOLERANCE_US;
+    }
+    return diff <= tolerance;
+}
+
+/**
+ * @brief Merge glitch pulses into the surrounding segment, in place
+ *
+ * A short mark inside a space (or short space inside a mark) is folded
+ * together with the segment after it into the segment before it, which
+ * keeps marks and spaces alternating. Leading and trailing glitches are
+ * dropped.
+ */
+static size_t remove_glitches(uint32_t *durations, size_t count, uint16_t *removed) {
+    size_t out = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (durations[i] >= IR_DIVERSITY_GLITCH_US) {
+            durations[out++] = durations[i];
+            continue;
+        }
+
+        (*removed)++;
+        if (out == 0) {
+            i++;  // Runt mark before the frame: drop it and its space
+        } else if (i + 1 < count) {
+            durations[out - 1] += durations[i] + durations[i + 1];
+            i++;
+        }
+        // Trailing runt: dropped
+    }
+    return out;
+}
+
+/* One segment of the accumulated frame */
+typedef struct {
+    uint32_t us;            // Average over the captures that agree
+    uint8_t support;        // Captures that have this segment
+    uint8_t oppose;         // Captures that lack this pulse (pulse middles only)
+    bool inserted;          // Pulse taken from a non-reference capture
+} div_segment_t;
+
+/**
+ * @brief Fold one capture into the accumulated frame
+ *
+ * Both walks advance by an odd number of segments per step, so marks stay
+ * aligned with marks. Pulses only one side has are kept for now and voted
+ * on once every capture is in.
+ *
+ * @return New length in @p out, or 0 if the capture does not align
+ */
+static size_t merge_capture(const div_segment_t *acc, size_t acc_count,
+                            const uint32_t *other, size_t other_count,
+                            div_segment_t *out, size_t max_out) {
+    size_t i = 0, j = 0, k = 0;
+
+    while (i < acc_count && j < other_count && k + 3 <= max_out) {
+        if (durations_match(acc[i].us, other[j])) {
+            out[k] = acc[i];
+            out[k].us = (acc[i].us * acc[i].support + other[j]) / (acc[i].support + 1);
+            out[k++].support++;
+            i++;
+            j++;
+        } else if (i + 2 < acc_count &&
+                   durations_match(other[j], acc[i].us + acc[i + 1].us + acc[i + 2].us)) {
+            // Other capture lacks a pulse the accumulator has
+            memcpy(&out[k], &acc[i], 3 * sizeof(div_segment_t));
+            out[k + 1].oppose++;
+            k += 3;
+            i += 3;
+            j++;
+        } else if (j + 2 < other_count &&
+                   durations_match(acc[i].us, other[j] + other[j + 1] + other[j + 2])) {
+            // Accumulator lacks a pulse the other capture has
+            for (int n = 0; n < 3; n++) {
+                out[k + n] = (div_segment_t) { .us = other[j + n], .support = 1 };
+            }
+            out[k + 1].oppose = acc[i].support;
+            out[k + 1].inserted = true;
+            k += 3;
+            i++;
+            j += 3;
+        } else {
+            return 0;
+        }
+    }
+
+    // One capture ended early (last pulse lost, or buffer full)
+    while (i < acc_count && k < max_out) {
+        out[k++] = acc[i++];
+    }
+    while (j < other_count && k < max_out) {
+        out[k++] = (div_segment_t) { .us = other[j++], .support = 1, .inserted = true };
+    }
+    return k;
+}
+
+size_t ir_diversity_combine(uint32_t *const captures[], size_t counts[], size_t num_captures,
+                            uint32_t *out, size_t max_out, ir_diversity_result_t *result) {
+    ir_diversity_result_t local;
+    if (result == NULL) {
+        result = &local;
+    }
+    memset(result, 0, sizeof(*result));
+
+    if (captures == NULL || counts == NULL || out == NULL || max_out == 0 ||
+        num_captures == 0 || num_captures > IR_DIVERSITY_MAX_CAPTURES) {
+        return 0;
+    }
+
+    size_t non_empty = 0;
+    for (size_t c = 0; c < num_captures; c++) {
+        counts[c] = captures[c] ? remove_glitches(captures[c], counts[c], &result->glitches_removed) : 0;
+        if (counts[c] > 0) {
+            non_empty++;
+        }
+    }
+
+    // Reference: the edge count most captures share; ties go to the most detail
+    size_t ref = 0;
+    size_t ref_agree = 0;
+    for (size_t c = 0; c < num_captures; c++) {
+        if (counts[c] == 0) {
+            continue;
+        }
+        size_t agree = 0;
+        for (size_t o = 0; o < num_captures; o++) {
+            agree += (counts[o] == counts[c]);
+        }
+        if (agree > ref_agree || (agree == ref_agree && counts[c] > counts[ref])) {
+            ref = c;
+            ref_agree = agree;
+        }
+    }
+    if (counts[ref] == 0) {
+        return 0;
+    }
+
+    size_t count = counts[ref] < max_out ? counts[ref] : max_out;
+    result->reference = ref;
+    result->captures_used = 1;
+    if (non_empty == 1) {
+        memcpy(out, captures[ref], count * sizeof(uint32_t));
+        return count;
+    }
+
+    div_segment_t *acc = malloc(2 * max_out * sizeof(div_segment_t));
+    if (acc == NULL) {
+        memcpy(out, captures[ref], count * sizeof(uint32_t));
+        return count;
+    }
+    div_segment_t *merged = acc + max_out;
+    for (size_t k = 0; k < count; k++) {
+        acc[k] = (div_segment_t) { .us = captures[ref][k], .support = 1 };
+    }
+
+    for (size_t c = 0; c < num_captures; c++) {
+        if (c == ref || counts[c] == 0) {
+            continue;
+        }
+
+        size_t n = merge_capture(acc, count, captures[c], counts[c], merged, max_out);
+        if (n == 0) {
+            continue;  // Could not align: leave this capture out
+        }
+
+        memcpy(acc, merged, n * sizeof(div_segment_t));
+        count = n;
+        result->captures_used++;
+    }
+
+    // Vote: a pulse fewer captures show than lack is folded back into the
+    // segment around it. With two captures a tie keeps the pulse, since a
+    // receiver losing a pulse is far more common than inventing one.
+    size_t n = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (k > 0 && k + 1 < count && acc[k].oppose > acc[k].support) {
+            out[n - 1] += acc[k].us + acc[k + 1].us;
+            result->edges_rejected += 2;
+            k++;
+            continue;
+        }
+        if (acc[k].inserted) {
+            result->edges_repaired += (k + 1 < count) ? 2 : 1;
+        }
+        out[n++] = acc[k].us;
+    }
+
+    free(acc);
+    return n;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file ir_rx_diversity.h
+ * @brief Diversity combining of captures from several IR receivers
+ *
+ * Two or three demodulating receivers looking at the same remote from
+ * different spots rarely lose the same edge. Their captures of one frame
+ * are aligned segment by segment and merged into one cleaner edge stream
+ * before decoding: timing is averaged where the receivers agree, a pulse
+ * one receiver dropped is taken from another, and with three receivers
+ * the edge count most of them agree on wins.
+ *
+ * Like ir_carrier_detect, this is plain C with no ESP-IDF dependencies so
+ * it can be exercised on the host. ir_control.c flattens RMT symbols into
+ * alternating mark/space durations before calling in here.
+ *
+ * MIT License
+ */
+
+#ifndef IR_RX_DIVERSITY_H
+#define IR_RX_DIVERSITY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Most captures combined into one frame */
+#define IR_DIVERSITY_MAX_CAPTURES           3
+
+/* Marks and spaces shorter than this are glitches, merged into their neighbours */
+#define IR_DIVERSITY_GLITCH_US              100
+
+/* Two durations match when within this percentage or absolute distance */
+#define IR_DIVERSITY_TOLERANCE_PERCENT      25
+#define IR_DIVERSITY_TOLERANCE_US           150
+
+/**
+ * @brief What combining did to a frame
+ */
+typedef struct {
+    uint8_t captures_used;      // Captures merged into the result (1 = no diversity)
+    uint8_t reference;          // Capture the others were aligned to
+    uint16_t edges_repaired;    // Segments taken from another capture to fill a dropout
+    uint16_t edges_rejected;    // Segments of a pulse most captures did not see
+    uint16_t glitches_removed;  // Glitch pulses removed across all captures
+} ir_diversity_result_t;
+
+/**
+ * @brief Merge several captures of one frame
+ *
+ * Each capture holds alternating mark/space durations in microseconds,
+ * mark first. Captures are cleaned of glitches in place, the reference is
+ * chosen (the edge count most captures share, else the most detailed
+ * capture), and the others are folded in:
+ *  - matching segments are averaged;
+ *  - where one capture shows a single segment and another
+ *    segment/pulse/segment of the same total, the pulse is kept
+ *    provisionally;
+ *  - once all captures are in, each such pulse stays if at least as many
+ *    captures saw it as missed it (with three receivers: majority).
+ * A capture that cannot be aligned is left out.
+ *
+ * @param captures Duration arrays (modified: glitches removed)
+ * @param counts In: entries per capture; out: entries after cleaning
+ * @param num_captures Number of captures (1 to IR_DIVERSITY_MAX_CAPTURES)
+ * @param out Merged durations (mark first)
+ * @param max_out Capacity of @p out
+ * @param result Optional combining report
+ * @return Number of entries written to @p out (0 if every capture is empty)
+ */
+size_t ir_diversity_combine(uint32_t *const captures[], size_t counts[], size_t num_captures,
+                            uint32_t *out, size_t max_out, ir_diversity_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_RX_DIVERSITY_H
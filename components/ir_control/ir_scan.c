@@ -0,0 +1,419 @@
+/**
+ * @file ir_scan.c
+ * @brief "Find my device" code scan over the IR code library
+ *
+ * The scan task keeps one frame on the air while it loads and renders
+ * the next candidate, then starts that one at the previous frame's start
+ * plus the protocol spacing. Start times are recorded per candidate so a
+ * confirmation can be mapped back to what the user saw.
+ *
+ * Between frames the task sleeps on a one-shot esp_timer that wakes it
+ * SCAN_WAKE_EARLY_US before the next start and spins for the rest, so it
+ * neither burns CPU for a tick nor starts late by one.
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_scan.h"
+#include "ir_library.h"
+#include "ir_control.h"
+#include "ir_protocols.h"
+#include "driver/rmt_types.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ir_scan";
+
+/* Wake this long before a frame's start (timer dispatch and task switch), then spin */
+#define SCAN_WAKE_EARLY_US      300
+
+/**
+ * @brief One code set to try
+ */
+typedef struct {
+    ir_library_entry_t entry;
+    int64_t sent_us;                // Frame start, 0 = not sent
+} scan_candidate_t;
+
+/* Internal state */
+static SemaphoreHandle_t scan_lock = NULL;     // Guards everything below
+static esp_timer_handle_t wake_timer = NULL;   // Wakes the scan task before a frame
+static TaskHandle_t scan_task_handle = NULL;
+static ir_scan_state_t scan_state = IR_SCAN_IDLE;
+static bool task_active = false;               // Scan task still owns candidates[]
+static char scan_brand[IR_LIBRARY_BRAND_LEN];
+static ir_device_type_t scan_device = IR_DEVICE_NONE;
+static ir_action_t scan_action = IR_ACTION_POWER;
+static uint8_t scan_emitter = IR_TX_EMITTER_DEFAULT;
+static uint16_t scan_gap_ms = 0;
+static ir_scan_done_cb_t scan_done_cb = NULL;
+static void *scan_done_arg = NULL;
+static scan_candidate_t *candidates = NULL;
+static uint16_t num_candidates = 0;
+static uint16_t num_sent = 0;
+static uint16_t last_sent = 0;
+static int64_t confirm_us = 0;
+
+/* ============================================================================
+ * CANDIDATES
+ * ============================================================================ */
+
+static bool collect_visit(const ir_library_entry_t *entry, void *arg)
+{
+    if (entry->action == scan_action) {
+        candidates[num_candidates].entry = *entry;
+        candidates[num_candidates].sent_us = 0;
+        num_candidates++;
+    }
+    return num_candidates < IR_SCAN_MAX_CANDIDATES;
+}
+
+/* Most popular first; code set order among equals */
+static int candidate_compare(const void *a, const void *b)
+{
+    const ir_library_entry_t *x = &((const scan_candidate_t *)a)->entry;
+    const ir_library_entry_t *y = &((const scan_candidate_t *)b)->entry;
+    if (x->popularity != y->popularity) {
+        return x->popularity > y->popularity ? -1 : 1;
+    }
+    return (int)x->codeset - (int)y->codeset;
+}
+
+/* ============================================================================
+ * SCAN TASK
+ * ============================================================================ */
+
+static void wake_timer_callback(void *arg)
+{
+    xTaskNotifyGive(scan_task_handle);
+}
+
+static void wait_until(int64_t target_us)
+{
+    int64_t remaining_us = target_us - esp_timer_get_time();
+    if (remaining_us > SCAN_WAKE_EARLY_US &&
+        esp_timer_start_once(wake_timer, remaining_us - SCAN_WAKE_EARLY_US) == ESP_OK) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    while (esp_timer_get_time() < target_us) {
+        // Spin the last few hundred microseconds
+    }
+}
+
+/**
+ * @brief Shortest start-to-start spacing after a frame
+ *
+ * The protocol's repeat period when it has one (receivers expect frames
+ * no closer), otherwise the frame plus IR_SCAN_MIN_GAP_MS. An explicit
+ * gap overrides both.
+ */
+static uint32_t frame_spacing_us(const ir_code_t *code, const rmt_symbol_word_t *symbols,
+                                 size_t num_symbols)
+{
+    uint32_t frame_us = 0;
+    for (size_t i = 0; i < num_symbols; i++) {
+        frame_us += symbols[i].duration0 + symbols[i].duration1;
+    }
+
+    if (scan_gap_ms > 0) {
+        return frame_us + scan_gap_ms * 1000u;
+    }
+
+    uint32_t spacing_us = frame_us + IR_SCAN_MIN_GAP_MS * 1000u;
+    uint32_t period_ms = code->repeat_period_ms;
+    if (period_ms == 0) {
+        const ir_protocol_constants_t *proto = ir_get_protocol_constants(code->protocol);
+        period_ms = proto ? proto->repeat_period_ms : 0;
+    }
+    if (period_ms * 1000 > spacing_us) {
+        spacing_us = period_ms * 1000;
+    }
+    return spacing_us;
+}
+
+static void scan_task(void *arg)
+{
+    int64_t next_us = esp_timer_get_time();
+    int64_t start_us = next_us;
+
+    for (uint16_t i = 0; i < num_candidates; i++) {
+        scan_candidate_t *candidate = &candidates[i];
+
+        /* Render while the previous frame is on the air */
+        ir_code_t code;
+        void *symbols = NULL;
+        size_t num_symbols = 0;
+        if (ir_library_load(&candidate->entry, &code) != ESP_OK) {
+            ESP_LOGW(TAG, "Skipping code set %u: unreadable", candidate->entry.codeset);
+            continue;
+        }
+        if (ir_render_code(&code, &symbols, &num_symbols) != ESP_OK) {
+            ESP_LOGW(TAG, "Skipping code set %u: cannot render", candidate->entry.codeset);
+            ir_code_free(&code);
+            continue;
+        }
+
+        wait_until(next_us);
+
+        xSemaphoreTake(scan_lock, portMAX_DELAY);
+        bool running = scan_state == IR_SCAN_RUNNING;
+        if (running) {
+            candidate->sent_us = esp_timer_get_time();
+            last_sent = candidate->entry.codeset;
+            num_sent++;
+        }
+        xSemaphoreGive(scan_lock);
+
+        if (running) {
+            esp_err_t err = ir_transmit_symbols_async(scan_emitter, &code, symbols, num_symbols);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "Code set %u not sent: %s", candidate->entry.codeset, esp_err_to_name(err));
+            }
+            ESP_LOGD(TAG, "Code set %u (%s, popularity %u)", candidate->entry.codeset,
+                     ir_get_protocol_name(code.protocol), candidate->entry.popularity);
+            next_us = candidate->sent_us + frame_spacing_us(&code, symbols, num_symbols);
+        }
+
+        free(symbols);
+        ir_code_free(&code);
+        if (!running) {
+            break;
+        }
+    }
+    ir_tx_wait_done(scan_emitter, IR_TX_TIMEOUT_MS);
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    if (scan_state == IR_SCAN_RUNNING) {
+        scan_state = IR_SCAN_EXHAUSTED;
+    }
+    ir_scan_state_t state = scan_state;
+    ir_scan_done_cb_t done_cb = scan_done_cb;
+    void *done_arg = scan_done_arg;
+    ESP_LOGI(TAG, "Scan %s: %u of %u code sets in %lld ms",
+             state == IR_SCAN_CONFIRMED ? "confirmed" :
+             state == IR_SCAN_EXHAUSTED ? "found nothing" : "stopped",
+             num_sent, num_candidates, (esp_timer_get_time() - start_us) / 1000);
+    task_active = false;
+    xSemaphoreGive(scan_lock);
+
+    if (done_cb) {
+        done_cb(state, done_arg);
+    }
+    vTaskDelete(NULL);
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+esp_err_t ir_scan_init(void)
+{
+    if (scan_lock != NULL) {
+        return ESP_OK;
+    }
+
+    const esp_timer_create_args_t wake_timer_args = {
+        .callback = wake_timer_callback,
+        .name = "scan_wake"
+    };
+    esp_err_t err = esp_timer_create(&wake_timer_args, &wake_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create scan timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    scan_lock = xSemaphoreCreateMutex();
+    return scan_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t ir_scan_start(const ir_scan_config_t *config)
+{
+    if (scan_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config == NULL || config->brand == NULL || config->device == IR_DEVICE_NONE ||
+        config->emitter >= ir_tx_get_num_emitters()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+
+    if (task_active) {
+        xSemaphoreGive(scan_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (candidates == NULL) {
+        candidates = malloc(IR_SCAN_MAX_CANDIDATES * sizeof(scan_candidate_t));
+        if (candidates == NULL) {
+            xSemaphoreGive(scan_lock);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    strlcpy(scan_brand, config->brand, sizeof(scan_brand));
+    scan_device = config->device;
+    scan_action = config->action != IR_ACTION_NONE ? config->action : IR_ACTION_POWER;
+    scan_emitter = config->emitter;
+    scan_gap_ms = config->gap_ms;
+    scan_done_cb = config->done_cb;
+    scan_done_arg = config->done_arg;
+    num_candidates = 0;
+    num_sent = 0;
+    confirm_us = 0;
+
+    esp_err_t err = ir_library_foreach(scan_brand, scan_device, collect_visit, NULL);
+    if (err == ESP_OK && num_candidates == 0) {
+        err = ESP_ERR_NOT_FOUND;
+    }
+    if (err != ESP_OK) {
+        scan_state = IR_SCAN_IDLE;
+        xSemaphoreGive(scan_lock);
+        ESP_LOGW(TAG, "No %s %s codes to scan: %s", config->brand,
+                 ir_action_get_device_name(config->device), esp_err_to_name(err));
+        return err;
+    }
+    qsort(candidates, num_candidates, sizeof(candidates[0]), candidate_compare);
+
+    scan_state = IR_SCAN_RUNNING;
+    task_active = true;
+    if (xTaskCreate(scan_task, "ir_scan", 4096, NULL, 5, &scan_task_handle) != pdPASS) {
+        scan_state = IR_SCAN_IDLE;
+        task_active = false;
+        xSemaphoreGive(scan_lock);
+        ESP_LOGE(TAG, "Failed to create scan task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreGive(scan_lock);
+
+    ESP_LOGI(TAG, "Scanning %u %s %s code sets for %s", num_candidates, config->brand,
+             ir_action_get_device_name(config->device), ir_action_get_action_name(scan_action));
+    return ESP_OK;
+}
+
+esp_err_t ir_scan_confirm(void)
+{
+    if (scan_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    if (scan_state == IR_SCAN_RUNNING) {
+        scan_state = IR_SCAN_CONFIRMED;
+        confirm_us = esp_timer_get_time();
+        err = ESP_OK;
+    }
+    xSemaphoreGive(scan_lock);
+
+    return err;
+}
+
+esp_err_t ir_scan_stop(void)
+{
+    if (scan_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    if (scan_state == IR_SCAN_RUNNING) {
+        scan_state = IR_SCAN_IDLE;
+    }
+    xSemaphoreGive(scan_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t ir_scan_try(uint16_t codeset)
+{
+    if (scan_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ir_library_entry_t entry;
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    if (task_active || num_candidates == 0) {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    for (uint16_t i = 0; err == ESP_ERR_NOT_FOUND && i < num_candidates; i++) {
+        if (candidates[i].entry.codeset == codeset) {
+            entry = candidates[i].entry;
+            err = ESP_OK;
+        }
+    }
+    xSemaphoreGive(scan_lock);
+
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ir_code_t code;
+    err = ir_library_load(&entry, &code);
+    if (err == ESP_OK) {
+        err = ir_transmit_on(scan_emitter, &code);
+        ir_code_free(&code);
+    }
+    ESP_LOGI(TAG, "Tried code set %u: %s", codeset, esp_err_to_name(err));
+    return err;
+}
+
+esp_err_t ir_scan_get_status(ir_scan_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(status, 0, sizeof(*status));
+    if (scan_lock == NULL) {
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+
+    status->state = scan_state;
+    status->total = num_candidates;
+    status->sent = num_sent;
+    status->current = last_sent;
+
+    if (scan_state == IR_SCAN_CONFIRMED) {
+        /* Candidates were sent in array order; walk back from the last one */
+        int64_t earliest_us = confirm_us - IR_SCAN_REACTION_MS * 1000LL;
+        for (int i = num_candidates - 1; i >= 0 && status->num_suspects < IR_SCAN_MAX_SUSPECTS; i--) {
+            const scan_candidate_t *candidate = &candidates[i];
+            if (candidate->sent_us == 0) {
+                continue;
+            }
+            if (candidate->sent_us < earliest_us && status->num_suspects > 0) {
+                break;
+            }
+            status->suspects[status->num_suspects++] = candidate->entry.codeset;
+        }
+    }
+
+    xSemaphoreGive(scan_lock);
+    return ESP_OK;
+}
+
+esp_err_t ir_scan_get_target(char *brand, ir_device_type_t *device)
+{
+    if (brand == NULL || device == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (scan_lock == NULL || scan_device == IR_DEVICE_NONE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(scan_lock, portMAX_DELAY);
+    memcpy(brand, scan_brand, IR_LIBRARY_BRAND_LEN);
+    *device = scan_device;
+    xSemaphoreGive(scan_lock);
+    return ESP_OK;
+}
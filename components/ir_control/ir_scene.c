@@ -0,0 +1,733 @@
+/**
+ * @file ir_scene.c
+ * @brief Multi-device IR scenes with pre-rendered timelines
+ *
+ * Each stored scene keeps its steps (what is saved to NVS) and a compiled
+ * timeline: one frame per step with its symbols, carrier, emitter and
+ * start offset. Timelines are reference counted so a scene can be saved
+ * or recompiled while an older timeline of it is still playing; the
+ * playback task drops its reference when the last frame is out.
+ *
+ * An AC step only sets power, mode, temperature, fan and swing; the
+ * unit's other fields (turbo, quiet, econo, sleep) may change after the
+ * scene compiled, so AC frames are re-encoded from the unit's current
+ * state when they differ, before the playback clock starts.
+ *
+ * Frames start at their offsets from the first frame. The playback task
+ * sleeps on a one-shot esp_timer that wakes it SCENE_WAKE_EARLY_US before
+ * each offset and spins on esp_timer_get_time() for the rest, so start
+ * jitter stays in the microseconds and the spin never depends on the
+ * tick rate.
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_scene.h"
+#include "ir_control.h"
+#include "ir_action.h"
+#include "ir_ac_state.h"
+#include "ir_storage.h"
+#include "driver/rmt_types.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ir_scene";
+
+/* NVS namespace for scenes; slot n is stored under "scene<n>" */
+#define NVS_NAMESPACE_SCENES    "ir_scenes"
+#define SCENE_BLOB_VERSION      1
+
+/* Scenes waiting to play */
+#define SCENE_QUEUE_LEN         4
+
+/* Wake this long before a frame's start (timer dispatch and task switch), then spin */
+#define SCENE_WAKE_EARLY_US     300
+
+/**
+ * @brief One pre-rendered frame of a timeline
+ */
+typedef struct {
+    uint32_t start_us;              // Offset from the first frame
+    uint32_t delay_us;              // Pause after the frame
+    uint8_t emitter;                // Emitter index or IR_TX_EMITTER_ALL
+    ir_code_t code;                 // Carrier source; sent whole on IR_TX_EMITTER_ALL
+    rmt_symbol_word_t *symbols;
+    size_t num_symbols;
+    ir_ac_handle_t ac_unit;         // AC steps: unit taking over ac_state
+    ac_state_t *ac_state;
+} scene_frame_t;
+
+/**
+ * @brief Compiled scene
+ */
+typedef struct {
+    uint32_t refs;                  // Owning scene plus queued/playing copies
+    char name[IR_SCENE_NAME_LEN];
+    uint32_t duration_us;
+    size_t num_frames;
+    scene_frame_t frames[];
+} scene_timeline_t;
+
+/**
+ * @brief One scene slot
+ */
+typedef struct {
+    bool used;
+    uint8_t num_steps;
+    char name[IR_SCENE_NAME_LEN];
+    ir_scene_step_t steps[IR_SCENE_MAX_STEPS];
+    scene_timeline_t *timeline;     // NULL if the steps did not compile
+} scene_slot_t;
+
+/**
+ * @brief Stored form of a scene (only num_steps steps are written)
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t num_steps;
+    char name[IR_SCENE_NAME_LEN];
+    ir_scene_step_t steps[IR_SCENE_MAX_STEPS];
+} scene_blob_t;
+
+/* Internal state */
+static bool is_initialized = false;
+static ir_storage_ns_t scenes_ns = NULL;
+static scene_slot_t scenes[IR_SCENE_MAX];
+static SemaphoreHandle_t scene_lock = NULL;    // Guards scenes[] and timeline refs
+static QueueHandle_t play_queue = NULL;        // scene_timeline_t *, one reference each
+static TaskHandle_t scene_task_handle = NULL;
+static esp_timer_handle_t wake_timer = NULL;   // Wakes the playback task before a frame
+
+/* ============================================================================
+ * COMPILATION
+ * ============================================================================ */
+
+static void timeline_release(scene_timeline_t *timeline)
+{
+    if (timeline == NULL || --timeline->refs > 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < timeline->num_frames; i++) {
+        scene_frame_t *frame = &timeline->frames[i];
+        ir_code_free(&frame->code);
+        free(frame->symbols);
+        free(frame->ac_state);
+    }
+    free(timeline);
+}
+
+/**
+ * @brief Time the RMT channel is busy with a frame
+ */
+static uint32_t frame_duration_us(const rmt_symbol_word_t *symbols, size_t num_symbols)
+{
+    uint32_t us = 0;
+    for (size_t i = 0; i < num_symbols; i++) {
+        us += symbols[i].duration0 + symbols[i].duration1;
+    }
+    return us;
+}
+
+/**
+ * @brief Load or encode a step's code and render it
+ */
+static esp_err_t compile_step(const ir_scene_step_t *step, scene_frame_t *frame)
+{
+    esp_err_t err;
+
+    if (step->type == IR_SCENE_STEP_ACTION) {
+        err = ir_action_load(step->target, step->action, &frame->code);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "%s.%s not learned",
+                     ir_action_get_device_name(step->target),
+                     ir_action_get_action_name(step->action));
+            return ESP_ERR_NOT_FOUND;
+        }
+        frame->emitter = ir_action_get_emitter(step->target);
+    } else if (step->type == IR_SCENE_STEP_AC) {
+        ir_ac_handle_t unit = ir_ac_get_unit(step->target);
+        if (!ir_ac_unit_is_configured(unit)) {
+            ESP_LOGW(TAG, "AC%u not configured", step->target);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        frame->ac_state = malloc(sizeof(ac_state_t));
+        if (frame->ac_state == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        err = ir_ac_unit_copy_state(unit, frame->ac_state);
+        if (err != ESP_OK) {
+            return err;
+        }
+        frame->ac_state->power = step->power != 0;
+        frame->ac_state->mode = step->mode;
+        frame->ac_state->temperature = step->temperature;
+        frame->ac_state->fan_speed = step->fan_speed;
+        frame->ac_state->swing = step->swing;
+
+        err = ir_ac_validate_state(frame->ac_state);
+        if (err == ESP_OK) {
+            err = ir_ac_encode_state(frame->ac_state, &frame->code);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "AC%u state does not encode: %s", step->target, esp_err_to_name(err));
+            return err;
+        }
+        frame->ac_unit = unit;
+        frame->emitter = ir_ac_unit_get_emitter(unit);
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (frame->emitter != IR_TX_EMITTER_ALL && frame->emitter >= ir_tx_get_num_emitters()) {
+        frame->emitter = IR_TX_EMITTER_DEFAULT;
+    }
+
+    void *symbols = NULL;
+    err = ir_render_code(&frame->code, &symbols, &frame->num_symbols);
+    frame->symbols = symbols;
+    return err;
+}
+
+/**
+ * @brief Place every frame after the previous one and its pause
+ */
+static void timeline_layout(scene_timeline_t *timeline)
+{
+    uint32_t offset_us = 0;
+    for (size_t i = 0; i < timeline->num_frames; i++) {
+        scene_frame_t *frame = &timeline->frames[i];
+        frame->start_us = offset_us;
+        offset_us += frame_duration_us(frame->symbols, frame->num_symbols) + frame->delay_us;
+    }
+    timeline->duration_us = offset_us;
+}
+
+/**
+ * @brief Re-encode an AC frame from its unit's current state
+ *
+ * The step's five fields (kept in frame->ac_state) go on top of what the
+ * unit has now. Nothing is encoded when that is the compiled state.
+ */
+static esp_err_t ac_frame_update(scene_frame_t *frame)
+{
+    ac_state_t state;
+    esp_err_t err = ir_ac_unit_copy_state(frame->ac_unit, &state);
+    if (err != ESP_OK) {
+        return err;
+    }
+    state.power = frame->ac_state->power;
+    state.mode = frame->ac_state->mode;
+    state.temperature = frame->ac_state->temperature;
+    state.fan_speed = frame->ac_state->fan_speed;
+    state.swing = frame->ac_state->swing;
+    if (memcmp(&state, frame->ac_state, sizeof(ac_state_t)) == 0) {
+        return ESP_OK;
+    }
+
+    ir_code_t code = {0};
+    void *symbols = NULL;
+    size_t num_symbols = 0;
+    err = ir_ac_validate_state(&state);
+    if (err == ESP_OK) {
+        err = ir_ac_encode_state(&state, &code);
+    }
+    if (err == ESP_OK) {
+        err = ir_render_code(&code, &symbols, &num_symbols);
+    }
+    if (err != ESP_OK) {
+        ir_code_free(&code);
+        return err;
+    }
+
+    ir_code_free(&frame->code);
+    free(frame->symbols);
+    frame->code = code;
+    frame->symbols = symbols;
+    frame->num_symbols = num_symbols;
+    memcpy(frame->ac_state, &state, sizeof(ac_state_t));
+    return ESP_OK;
+}
+
+/**
+ * @brief Compile steps into a timeline (one reference, owned by the caller)
+ */
+static esp_err_t compile_scene(const char *name, const ir_scene_step_t *steps, size_t num_steps,
+                               scene_timeline_t **out)
+{
+    scene_timeline_t *timeline = calloc(1, sizeof(scene_timeline_t) + num_steps * sizeof(scene_frame_t));
+    if (timeline == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timeline->refs = 1;
+    strlcpy(timeline->name, name, sizeof(timeline->name));
+
+    for (size_t i = 0; i < num_steps; i++) {
+        scene_frame_t *frame = &timeline->frames[i];
+        timeline->num_frames = i + 1;    // Release frees what the step allocated
+
+        esp_err_t err = compile_step(&steps[i], frame);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Scene \"%s\" step %u: %s", name, (unsigned)i + 1, esp_err_to_name(err));
+            timeline_release(timeline);
+            return err;
+        }
+        frame->delay_us = (uint32_t)steps[i].delay_ms * 1000;
+    }
+    timeline_layout(timeline);
+
+    *out = timeline;
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * PLAYBACK
+ * ============================================================================ */
+
+static void wake_timer_callback(void *arg)
+{
+    xTaskNotifyGive(scene_task_handle);
+}
+
+static void wait_until(int64_t target_us)
+{
+    int64_t remaining_us = target_us - esp_timer_get_time();
+    if (remaining_us > SCENE_WAKE_EARLY_US &&
+        esp_timer_start_once(wake_timer, remaining_us - SCENE_WAKE_EARLY_US) == ESP_OK) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    while (esp_timer_get_time() < target_us) {
+        // Spin the last few hundred microseconds
+    }
+}
+
+static void play_timeline(scene_timeline_t *timeline)
+{
+    uint32_t all_emitters = (1u << ir_tx_get_num_emitters()) - 1;
+    int64_t max_late_us = 0;
+    size_t sent = 0;
+
+    /* Only this task touches frames after compilation. A new AC frame
+     * can be longer or shorter, which moves the frames after it. */
+    for (size_t i = 0; i < timeline->num_frames; i++) {
+        scene_frame_t *frame = &timeline->frames[i];
+        if (frame->ac_unit == NULL) {
+            continue;
+        }
+        esp_err_t err = ac_frame_update(frame);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Scene \"%s\" frame %u keeps its compiled AC state: %s",
+                     timeline->name, (unsigned)i + 1, esp_err_to_name(err));
+        }
+    }
+    timeline_layout(timeline);
+
+    ESP_LOGI(TAG, "Playing scene \"%s\" (%u frames, %lu ms)", timeline->name,
+             (unsigned)timeline->num_frames, timeline->duration_us / 1000);
+
+    int64_t start_us = esp_timer_get_time();
+    for (size_t i = 0; i < timeline->num_frames; i++) {
+        const scene_frame_t *frame = &timeline->frames[i];
+
+        int64_t target_us = start_us + frame->start_us;
+        wait_until(target_us);
+        int64_t late_us = esp_timer_get_time() - target_us;
+        if (late_us > max_late_us) {
+            max_late_us = late_us;
+        }
+
+        esp_err_t err;
+        if (frame->ac_unit != NULL) {
+            /* Same emitter turn and inter-frame gap as the unit's own commits */
+            err = ir_ac_unit_send_symbols(frame->ac_unit, &frame->code, frame->symbols,
+                                          frame->num_symbols,
+                                          frame_duration_us(frame->symbols, frame->num_symbols));
+        } else if (frame->emitter == IR_TX_EMITTER_ALL) {
+            err = ir_transmit_broadcast(all_emitters, &frame->code);
+        } else {
+            err = ir_transmit_symbols_async(frame->emitter, &frame->code,
+                                            frame->symbols, frame->num_symbols);
+        }
+        if (err == ESP_OK) {
+            sent++;
+        } else {
+            ESP_LOGW(TAG, "Scene \"%s\" frame %u failed: %s", timeline->name,
+                     (unsigned)i + 1, esp_err_to_name(err));
+        }
+    }
+    ir_tx_wait_all_done(IR_TX_TIMEOUT_MS);
+
+    /* Report AC states only now; the sync callback may talk to the cloud */
+    for (size_t i = 0; i < timeline->num_frames; i++) {
+        const scene_frame_t *frame = &timeline->frames[i];
+        if (frame->ac_unit != NULL) {
+            ir_ac_unit_adopt_state(frame->ac_unit, frame->ac_state);
+        }
+    }
+
+    ESP_LOGI(TAG, "Scene \"%s\" done: %u/%u frames, worst start %lld us late", timeline->name,
+             (unsigned)sent, (unsigned)timeline->num_frames, max_late_us);
+}
+
+static void scene_task(void *arg)
+{
+    scene_timeline_t *timeline;
+
+    while (1) {
+        if (xQueueReceive(play_queue, &timeline, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        play_timeline(timeline);
+
+        xSemaphoreTake(scene_lock, portMAX_DELAY);
+        timeline_release(timeline);
+        xSemaphoreGive(scene_lock);
+    }
+}
+
+/* ============================================================================
+ * STORAGE
+ * ============================================================================ */
+
+static void slot_key(size_t slot, char *key, size_t len)
+{
+    snprintf(key, len, "scene%u", (unsigned)slot);
+}
+
+static esp_err_t slot_store(size_t slot, const char *name, const ir_scene_step_t *steps,
+                            size_t num_steps)
+{
+    scene_blob_t blob = {
+        .version = SCENE_BLOB_VERSION,
+        .num_steps = num_steps,
+    };
+    strlcpy(blob.name, name, sizeof(blob.name));
+    memcpy(blob.steps, steps, num_steps * sizeof(ir_scene_step_t));
+
+    char key[16];
+    slot_key(slot, key, sizeof(key));
+    esp_err_t err = ir_storage_set(scenes_ns, key, &blob,
+                                   offsetof(scene_blob_t, steps) + num_steps * sizeof(ir_scene_step_t));
+    if (err == ESP_OK) {
+        err = ir_storage_commit(scenes_ns);
+    }
+    return err;
+}
+
+static void slot_load(size_t slot)
+{
+    char key[16];
+    slot_key(slot, key, sizeof(key));
+
+    scene_blob_t blob;
+    size_t len = sizeof(blob);
+    esp_err_t err = ir_storage_get(scenes_ns, key, &blob, &len);
+    if (err == ESP_ERR_NOT_FOUND) {
+        return;
+    }
+    if (err != ESP_OK || len < offsetof(scene_blob_t, steps) || blob.version != SCENE_BLOB_VERSION ||
+        blob.num_steps == 0 || blob.num_steps > IR_SCENE_MAX_STEPS ||
+        len != offsetof(scene_blob_t, steps) + blob.num_steps * sizeof(ir_scene_step_t)) {
+        ESP_LOGW(TAG, "Dropping unreadable scene in %s", key);
+        ir_storage_erase(scenes_ns, key);
+        ir_storage_commit(scenes_ns);
+        return;
+    }
+
+    scene_slot_t *scene = &scenes[slot];
+    scene->used = true;
+    scene->num_steps = blob.num_steps;
+    blob.name[IR_SCENE_NAME_LEN - 1] = '\0';
+    strlcpy(scene->name, blob.name, sizeof(scene->name));
+    memcpy(scene->steps, blob.steps, blob.num_steps * sizeof(ir_scene_step_t));
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+/* Called with scene_lock held */
+static scene_slot_t *scene_find(const char *name)
+{
+    for (size_t i = 0; i < IR_SCENE_MAX; i++) {
+        if (scenes[i].used && strcmp(scenes[i].name, name) == 0) {
+            return &scenes[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t ir_scene_init(void)
+{
+    if (is_initialized) {
+        return ESP_OK;
+    }
+
+    /* Shared storage was initialized by ir_control_init() */
+    esp_err_t err = ir_storage_open(NVS_NAMESPACE_SCENES, &scenes_ns);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open scene storage: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    scene_lock = xSemaphoreCreateMutex();
+    play_queue = xQueueCreate(SCENE_QUEUE_LEN, sizeof(scene_timeline_t *));
+    if (scene_lock == NULL || play_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t wake_timer_args = {
+        .callback = wake_timer_callback,
+        .name = "scene_wake"
+    };
+    err = esp_timer_create(&wake_timer_args, &wake_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create scene timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    if (xTaskCreate(scene_task, "ir_scene", 4096, NULL, 6, &scene_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create scene task");
+        return ESP_FAIL;
+    }
+
+    for (size_t i = 0; i < IR_SCENE_MAX; i++) {
+        slot_load(i);
+    }
+    is_initialized = true;
+
+    ir_scene_refresh();
+    ESP_LOGI(TAG, "Scene engine initialized (%u scenes)", (unsigned)ir_scene_get_count());
+    return ESP_OK;
+}
+
+esp_err_t ir_scene_save(const char *name, const ir_scene_step_t *steps, size_t num_steps)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (name == NULL || name[0] == '\0' || strlen(name) >= IR_SCENE_NAME_LEN ||
+        steps == NULL || num_steps == 0 || num_steps > IR_SCENE_MAX_STEPS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Compile first: a scene that cannot play is not stored */
+    scene_timeline_t *timeline = NULL;
+    esp_err_t err = compile_scene(name, steps, num_steps, &timeline);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    xSemaphoreTake(scene_lock, portMAX_DELAY);
+
+    scene_slot_t *scene = scene_find(name);
+    if (scene == NULL) {
+        for (size_t i = 0; i < IR_SCENE_MAX && scene == NULL; i++) {
+            if (!scenes[i].used) {
+                scene = &scenes[i];
+            }
+        }
+    }
+    if (scene == NULL) {
+        timeline_release(timeline);
+        xSemaphoreGive(scene_lock);
+        ESP_LOGE(TAG, "No free scene slot (%d in use)", IR_SCENE_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+
+    err = slot_store(scene - scenes, name, steps, num_steps);
+    if (err != ESP_OK) {
+        timeline_release(timeline);
+        xSemaphoreGive(scene_lock);
+        ESP_LOGE(TAG, "Failed to save scene \"%s\": %s", name, esp_err_to_name(err));
+        return err;
+    }
+
+    timeline_release(scene->timeline);
+    scene->used = true;
+    scene->num_steps = num_steps;
+    strlcpy(scene->name, name, sizeof(scene->name));
+    memcpy(scene->steps, steps, num_steps * sizeof(ir_scene_step_t));
+    scene->timeline = timeline;
+    uint32_t duration_us = timeline->duration_us;     // The playback task may lay it out again
+
+    xSemaphoreGive(scene_lock);
+
+    ESP_LOGI(TAG, "Scene \"%s\" saved: %u steps, %lu ms", name, (unsigned)num_steps,
+             duration_us / 1000);
+    return ESP_OK;
+}
+
+esp_err_t ir_scene_delete(const char *name)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (name == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(scene_lock, portMAX_DELAY);
+
+    scene_slot_t *scene = scene_find(name);
+    if (scene == NULL) {
+        xSemaphoreGive(scene_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    char key[16];
+    slot_key(scene - scenes, key, sizeof(key));
+    esp_err_t err = ir_storage_erase(scenes_ns, key);
+    if (err == ESP_OK) {
+        err = ir_storage_commit(scenes_ns);
+    }
+    if (err == ESP_OK) {
+        timeline_release(scene->timeline);
+        memset(scene, 0, sizeof(*scene));
+    }
+
+    xSemaphoreGive(scene_lock);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to delete scene \"%s\": %s", name, esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "Scene \"%s\" deleted", name);
+    return ESP_OK;
+}
+
+esp_err_t ir_scene_play(const char *name)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (name == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(scene_lock, portMAX_DELAY);
+
+    scene_slot_t *scene = scene_find(name);
+    scene_timeline_t *timeline = scene ? scene->timeline : NULL;
+    if (timeline != NULL) {
+        timeline->refs++;
+    }
+
+    xSemaphoreGive(scene_lock);
+
+    if (timeline == NULL) {
+        return scene ? ESP_ERR_INVALID_STATE : ESP_ERR_NOT_FOUND;
+    }
+
+    if (xQueueSend(play_queue, &timeline, 0) != pdTRUE) {
+        xSemaphoreTake(scene_lock, portMAX_DELAY);
+        timeline_release(timeline);
+        xSemaphoreGive(scene_lock);
+        ESP_LOGW(TAG, "Scene queue full, \"%s\" not played", name);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+/* Called with scene_lock held; IR_DEVICE_NONE matches every scene */
+static bool scene_uses(const scene_slot_t *scene, ir_device_type_t device, ir_action_t action)
+{
+    if (device == IR_DEVICE_NONE) {
+        return true;
+    }
+    for (size_t i = 0; i < scene->num_steps; i++) {
+        const ir_scene_step_t *step = &scene->steps[i];
+        if (step->type == IR_SCENE_STEP_ACTION && step->target == device &&
+            (action == IR_ACTION_NONE || step->action == action)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static esp_err_t scenes_recompile(ir_device_type_t device, ir_action_t action)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+
+    xSemaphoreTake(scene_lock, portMAX_DELAY);
+    for (size_t i = 0; i < IR_SCENE_MAX; i++) {
+        scene_slot_t *scene = &scenes[i];
+        if (!scene->used || !scene_uses(scene, device, action)) {
+            continue;
+        }
+
+        scene_timeline_t *timeline = NULL;
+        esp_err_t err = compile_scene(scene->name, scene->steps, scene->num_steps, &timeline);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Scene \"%s\" cannot play until it compiles", scene->name);
+            if (ret == ESP_OK) {
+                ret = err;
+            }
+        }
+        timeline_release(scene->timeline);
+        scene->timeline = timeline;
+    }
+    xSemaphoreGive(scene_lock);
+
+    return ret;
+}
+
+esp_err_t ir_scene_refresh(void)
+{
+    return scenes_recompile(IR_DEVICE_NONE, IR_ACTION_NONE);
+}
+
+esp_err_t ir_scene_refresh_action(ir_device_type_t device, ir_action_t action)
+{
+    if (device <= IR_DEVICE_NONE || device >= IR_DEVICE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return scenes_recompile(device, action);
+}
+
+size_t ir_scene_get_count(void)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < IR_SCENE_MAX; i++) {
+        count += scenes[i].used;
+    }
+    return count;
+}
+
+esp_err_t ir_scene_get_name(size_t index, char *name, size_t len)
+{
+    if (name == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!is_initialized) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(scene_lock, portMAX_DELAY);
+    for (size_t i = 0; i < IR_SCENE_MAX; i++) {
+        if (scenes[i].used && index-- == 0) {
+            strlcpy(name, scenes[i].name, len);
+            err = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(scene_lock);
+
+    return err;
+}
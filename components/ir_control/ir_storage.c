@@ -0,0 +1,534 @@
+/**
+ * @file ir_storage.c
+ * @brief Key/value storage shared by ir_control, ir_action, ir_ac_state and ir_scene
+ *
+ * Everything, backend calls included, runs under one lock, so the value
+ * cache never disagrees with the backend and a batch end cannot race a
+ * write. Cache entries are tagged with a namespace slot; the least
+ * recently used one is replaced on a miss.
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_storage.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "ir_storage";
+
+/**
+ * @brief Namespace slot
+ */
+struct ir_storage_ns {
+    char name[IR_STORAGE_KEY_MAX];              // Empty for a free slot
+    const ir_storage_backend_t *backend;
+    void *ctx;                                  // Backend handle, NULL until opened
+    bool dirty;                                 // Commit when the batch ends
+    ir_storage_stats_t stats;
+};
+
+/**
+ * @brief Cached value, or a key known to be missing
+ */
+typedef struct {
+    struct ir_storage_ns *ns;                   // NULL for a free entry
+    bool present;
+    uint8_t len;
+    uint32_t last_use;
+    char key[IR_STORAGE_KEY_MAX];
+    uint8_t value[IR_STORAGE_CACHE_VALUE_MAX];
+} cache_entry_t;
+
+static SemaphoreHandle_t storage_lock = NULL;
+static const ir_storage_backend_t *default_backend = NULL;
+static const ir_storage_backend_t *ready_backends[IR_STORAGE_MAX_BACKENDS];
+static struct ir_storage_ns namespaces[IR_STORAGE_MAX_NAMESPACES];
+static cache_entry_t cache[IR_STORAGE_CACHE_ENTRIES];
+static uint32_t cache_clock = 0;
+static uint8_t batch_depth = 0;
+
+/* ============================================================================
+ * INTERNAL
+ * ============================================================================ */
+
+/* Caller holds storage_lock */
+static esp_err_t backend_ready(const ir_storage_backend_t *backend)
+{
+    size_t i;
+    for (i = 0; i < IR_STORAGE_MAX_BACKENDS && ready_backends[i] != NULL; i++) {
+        if (ready_backends[i] == backend) {
+            return ESP_OK;
+        }
+    }
+    if (i == IR_STORAGE_MAX_BACKENDS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = backend->init ? backend->init() : ESP_OK;
+    if (err == ESP_ERR_NOT_FOUND) {
+        return err;     // Optional partition missing; the caller says what it falls back to
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "%s backend init failed: %s", backend->name, esp_err_to_name(err));
+        return err;
+    }
+    ready_backends[i] = backend;
+    return ESP_OK;
+}
+
+/* Caller holds storage_lock; NULL when missing (create: and no free slot) */
+static struct ir_storage_ns *ns_find(const char *name, bool create)
+{
+    struct ir_storage_ns *free_slot = NULL;
+    for (size_t i = 0; i < IR_STORAGE_MAX_NAMESPACES; i++) {
+        if (namespaces[i].name[0] == '\0') {
+            if (free_slot == NULL) {
+                free_slot = &namespaces[i];
+            }
+        } else if (strcmp(namespaces[i].name, name) == 0) {
+            return &namespaces[i];
+        }
+    }
+    if (!create || free_slot == NULL) {
+        return NULL;
+    }
+    strlcpy(free_slot->name, name, sizeof(free_slot->name));
+    free_slot->backend = default_backend;
+    return free_slot;
+}
+
+/* Caller holds storage_lock */
+static cache_entry_t *cache_find(struct ir_storage_ns *ns, const char *key)
+{
+    for (size_t i = 0; i < IR_STORAGE_CACHE_ENTRIES; i++) {
+        if (cache[i].ns == ns && strcmp(cache[i].key, key) == 0) {
+            cache[i].last_use = ++cache_clock;
+            return &cache[i];
+        }
+    }
+    return NULL;
+}
+
+/* Caller holds storage_lock; data NULL records a missing key */
+static void cache_put(struct ir_storage_ns *ns, const char *key, const void *data, size_t len)
+{
+    cache_entry_t *entry = cache_find(ns, key);
+    if (data != NULL && len > IR_STORAGE_CACHE_VALUE_MAX) {
+        if (entry != NULL) {
+            entry->ns = NULL;
+        }
+        return;
+    }
+
+    if (entry == NULL) {
+        entry = &cache[0];
+        for (size_t i = 0; i < IR_STORAGE_CACHE_ENTRIES && entry->ns != NULL; i++) {
+            if (cache[i].ns == NULL || cache[i].last_use < entry->last_use) {
+                entry = &cache[i];
+            }
+        }
+        entry->ns = ns;
+        strlcpy(entry->key, key, sizeof(entry->key));
+        entry->last_use = ++cache_clock;
+    }
+
+    entry->present = (data != NULL);
+    entry->len = entry->present ? len : 0;
+    if (entry->present) {
+        memcpy(entry->value, data, len);
+    }
+}
+
+/* Caller holds storage_lock */
+static void cache_drop_ns(struct ir_storage_ns *ns)
+{
+    for (size_t i = 0; i < IR_STORAGE_CACHE_ENTRIES; i++) {
+        if (cache[i].ns == ns) {
+            cache[i].ns = NULL;
+        }
+    }
+}
+
+/* Caller holds storage_lock; 0 for a missing key */
+static size_t value_size(struct ir_storage_ns *ns, const char *key)
+{
+    cache_entry_t *entry = cache_find(ns, key);
+    if (entry != NULL) {
+        return entry->len;
+    }
+    size_t len = 0;
+    return ns->backend->get(ns->ctx, key, NULL, &len) == ESP_OK ? len : 0;
+}
+
+/* Caller holds storage_lock */
+static esp_err_t ns_commit(struct ir_storage_ns *ns)
+{
+    esp_err_t err = ns->backend->commit ? ns->backend->commit(ns->ctx) : ESP_OK;
+    ns->stats.commits++;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Commit of %s failed: %s", ns->name, esp_err_to_name(err));
+    }
+    return err;
+}
+
+/* Caller holds storage_lock; commits every dirty namespace */
+static esp_err_t batch_flush(void)
+{
+    esp_err_t ret = ESP_OK;
+    size_t commits = 0;
+
+    for (size_t i = 0; i < IR_STORAGE_MAX_NAMESPACES; i++) {
+        struct ir_storage_ns *ns = &namespaces[i];
+        if (!ns->dirty) {
+            continue;
+        }
+        ns->dirty = false;
+        esp_err_t err = ns_commit(ns);
+        if (err != ESP_OK && ret == ESP_OK) {
+            ret = err;
+        }
+        commits++;
+    }
+
+    if (commits > 0) {
+        ESP_LOGI(TAG, "Batch done: %u namespace commit(s)", (unsigned)commits);
+    }
+    return ret;
+}
+
+static bool ns_valid(ir_storage_ns_t ns)
+{
+    return ns != NULL && ns->ctx != NULL && storage_lock != NULL;
+}
+
+/* ============================================================================
+ * PUBLIC API - SETUP
+ * ============================================================================ */
+
+esp_err_t ir_storage_init(void)
+{
+    return ir_storage_init_with(&ir_storage_backend_nvs);
+}
+
+esp_err_t ir_storage_init_with(const ir_storage_backend_t *backend)
+{
+    if (backend == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (storage_lock != NULL) {
+        return ESP_OK;
+    }
+
+    storage_lock = xSemaphoreCreateMutex();
+    if (storage_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+    default_backend = backend;
+    esp_err_t err = backend_ready(backend);
+    xSemaphoreGive(storage_lock);
+
+    if (err != ESP_OK) {
+        vSemaphoreDelete(storage_lock);
+        storage_lock = NULL;
+    }
+    return err;
+}
+
+void ir_storage_deinit(void)
+{
+    if (storage_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    batch_flush();
+    batch_depth = 0;
+    for (size_t i = 0; i < IR_STORAGE_MAX_NAMESPACES; i++) {
+        if (namespaces[i].ctx != NULL && namespaces[i].backend->close) {
+            namespaces[i].backend->close(namespaces[i].ctx);
+        }
+    }
+    memset(namespaces, 0, sizeof(namespaces));
+    memset(cache, 0, sizeof(cache));
+    memset(ready_backends, 0, sizeof(ready_backends));
+    default_backend = NULL;
+
+    xSemaphoreGive(storage_lock);
+    vSemaphoreDelete(storage_lock);
+    storage_lock = NULL;
+}
+
+esp_err_t ir_storage_mount(const char *namespace_name, const ir_storage_backend_t *backend,
+                           size_t quota_bytes)
+{
+    if (namespace_name == NULL || namespace_name[0] == '\0' ||
+        strlen(namespace_name) >= IR_STORAGE_KEY_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (storage_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_OK;
+    struct ir_storage_ns *ns = ns_find(namespace_name, true);
+    if (ns == NULL) {
+        err = ESP_ERR_NO_MEM;
+    } else if (ns->ctx != NULL) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        ns->backend = backend ? backend : default_backend;
+        ns->stats.quota_bytes = quota_bytes;
+        if (quota_bytes > 0 && ns->backend->used == NULL) {
+            ESP_LOGW(TAG, "%s backend cannot account a quota for %s", ns->backend->name,
+                     namespace_name);
+            ns->stats.quota_bytes = 0;
+        }
+    }
+
+    xSemaphoreGive(storage_lock);
+    return err;
+}
+
+esp_err_t ir_storage_open(const char *namespace_name, ir_storage_ns_t *handle)
+{
+    if (namespace_name == NULL || handle == NULL || strlen(namespace_name) >= IR_STORAGE_KEY_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (storage_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_OK;
+    struct ir_storage_ns *ns = ns_find(namespace_name, true);
+    if (ns == NULL) {
+        err = ESP_ERR_NO_MEM;
+    } else if (ns->ctx == NULL) {
+        err = backend_ready(ns->backend);
+        bool missing = (err == ESP_ERR_NOT_FOUND);
+        if (err == ESP_OK) {
+            err = ns->backend->open(namespace_name, &ns->ctx);
+        }
+        if (err == ESP_OK && ns->stats.quota_bytes > 0) {
+            err = ns->backend->used(ns->ctx, &ns->stats.used_bytes);
+            if (err != ESP_OK) {
+                ns->backend->close(ns->ctx);
+            }
+        }
+        if (err != ESP_OK) {
+            if (!missing) {
+                ESP_LOGE(TAG, "Failed to open %s: %s", namespace_name, esp_err_to_name(err));
+            }
+            ns->ctx = NULL;
+        }
+    }
+    if (err == ESP_OK) {
+        *handle = ns;
+    }
+
+    xSemaphoreGive(storage_lock);
+    return err;
+}
+
+/* ============================================================================
+ * PUBLIC API - ACCESS
+ * ============================================================================ */
+
+esp_err_t ir_storage_get(ir_storage_ns_t ns, const char *key, void *buf, size_t *len)
+{
+    if (!ns_valid(ns) || key == NULL || len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    esp_err_t err;
+    ns->stats.reads++;
+    cache_entry_t *entry = cache_find(ns, key);
+    if (entry != NULL) {
+        ns->stats.cache_hits++;
+        if (!entry->present) {
+            err = ESP_ERR_NOT_FOUND;
+        } else if (buf != NULL && *len < entry->len) {
+            err = ESP_ERR_INVALID_SIZE;
+        } else {
+            if (buf != NULL) {
+                memcpy(buf, entry->value, entry->len);
+            }
+            *len = entry->len;
+            err = ESP_OK;
+        }
+    } else {
+        size_t capacity = *len;
+        err = ns->backend->get(ns->ctx, key, buf, len);
+        if (err == ESP_ERR_NOT_FOUND) {
+            cache_put(ns, key, NULL, 0);
+        } else if (err == ESP_OK && buf != NULL && *len <= capacity) {
+            cache_put(ns, key, buf, *len);
+        }
+    }
+
+    xSemaphoreGive(storage_lock);
+    return err;
+}
+
+esp_err_t ir_storage_set(ir_storage_ns_t ns, const char *key, const void *data, size_t len)
+{
+    if (!ns_valid(ns) || key == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    size_t used = ns->stats.used_bytes;
+    if (ns->stats.quota_bytes > 0) {
+        used = used - value_size(ns, key) + len;
+        if (used > ns->stats.quota_bytes) {
+            ESP_LOGW(TAG, "%s over quota (%u of %u bytes)", ns->name, (unsigned)used,
+                     (unsigned)ns->stats.quota_bytes);
+            xSemaphoreGive(storage_lock);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    esp_err_t err = ns->backend->set(ns->ctx, key, data, len);
+    if (err == ESP_OK) {
+        ns->stats.writes++;
+        ns->stats.used_bytes = used;
+        cache_put(ns, key, data, len);
+    } else {
+        cache_entry_t *entry = cache_find(ns, key);
+        if (entry != NULL) {
+            entry->ns = NULL;       // Backend state unknown
+        }
+    }
+
+    xSemaphoreGive(storage_lock);
+    return err;
+}
+
+esp_err_t ir_storage_erase(ir_storage_ns_t ns, const char *key)
+{
+    if (!ns_valid(ns) || key == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    cache_entry_t *entry = cache_find(ns, key);
+    esp_err_t err;
+    if (entry != NULL && !entry->present) {
+        err = ESP_ERR_NOT_FOUND;
+    } else {
+        size_t old_len = ns->stats.quota_bytes > 0 ? value_size(ns, key) : 0;
+        err = ns->backend->erase(ns->ctx, key);
+        if (err == ESP_OK) {
+            ns->stats.erases++;
+            ns->stats.used_bytes -= old_len;
+        }
+        if (err == ESP_OK || err == ESP_ERR_NOT_FOUND) {
+            cache_put(ns, key, NULL, 0);
+        }
+    }
+
+    xSemaphoreGive(storage_lock);
+    return err;
+}
+
+esp_err_t ir_storage_erase_all(ir_storage_ns_t ns)
+{
+    if (!ns_valid(ns)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    esp_err_t err = ns->backend->erase_all(ns->ctx);
+    cache_drop_ns(ns);
+    if (err == ESP_OK) {
+        ns->stats.erases++;
+        ns->stats.used_bytes = 0;
+    }
+
+    xSemaphoreGive(storage_lock);
+    return err;
+}
+
+/* ============================================================================
+ * PUBLIC API - COMMITS
+ * ============================================================================ */
+
+esp_err_t ir_storage_commit(ir_storage_ns_t ns)
+{
+    if (!ns_valid(ns)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    esp_err_t err = ESP_OK;
+    if (batch_depth > 0) {
+        ns->dirty = true;
+        ns->stats.deferred_commits++;
+    } else {
+        err = ns_commit(ns);
+    }
+
+    xSemaphoreGive(storage_lock);
+    return err;
+}
+
+void ir_storage_begin_batch(void)
+{
+    if (storage_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+    batch_depth++;
+    xSemaphoreGive(storage_lock);
+}
+
+esp_err_t ir_storage_end_batch(void)
+{
+    if (storage_lock == NULL) {
+        return ESP_OK;      // Nothing was deferred
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+
+    esp_err_t ret = ESP_OK;
+    if (batch_depth == 0) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (--batch_depth == 0) {
+        ret = batch_flush();
+    }
+
+    xSemaphoreGive(storage_lock);
+    return ret;
+}
+
+bool ir_storage_in_batch(void)
+{
+    return batch_depth > 0;
+}
+
+esp_err_t ir_storage_get_stats(ir_storage_ns_t ns, ir_storage_stats_t *stats)
+{
+    if (!ns_valid(ns) || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(storage_lock, portMAX_DELAY);
+    *stats = ns->stats;
+    xSemaphoreGive(storage_lock);
+    return ESP_OK;
+}
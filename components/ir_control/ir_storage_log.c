@@ -0,0 +1,703 @@
+/**
+ * @file ir_storage_log.c
+ * @brief Append-only ring log backend of ir_storage (ir_log partition)
+ *
+ * For state that changes many times a day (AC state), where rewriting
+ * NVS keeps churning the same pages. Every set or erase appends one
+ * record, written with a single flash program; nothing is committed.
+ *
+ * Layout: the partition is a ring of 4 KB sectors. Each used sector
+ * starts with a header holding an increasing sequence number, followed
+ * by records (header, namespace name, key, value, padded to 4 bytes)
+ * protected by a CRC-32. A RAM index maps each live key to where its
+ * latest value sits in flash.
+ *
+ * Compaction: two sectors are kept erased after every write. When the
+ * head opens the second to last of them, the live records of the oldest
+ * sector are copied to the new head, where they always fit, and the
+ * oldest sector is retired: its header is cleared, then it is erased.
+ * The other erased sector is the reserve, so a compaction cut short by a
+ * reset always has a fresh sector to be finished in at the next boot. If
+ * a copy fails, compaction stops and the oldest sector stays in place
+ * with every value that was not copied yet; the next write retries it in
+ * the head, and while no sector is erased, writes leave the head room
+ * for those copies.
+ *
+ * A failed program leaves a torn record; writing goes on after it, so
+ * write errors do not use up sectors. Boot replay reads the sectors
+ * oldest first and rebuilds the index, skipping torn records up to the
+ * next intact one; a torn record with nothing after it (a reset mid
+ * write) ends its sector and the next write opens a new one. Replay
+ * reads at most the whole partition once (16 KB in the stock tables).
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_storage.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "ir_storage_log";
+
+#define LOG_SECTOR_SIZE         4096
+#define LOG_SECTOR_MAGIC        0x474C5249      // "IRLG"
+#define LOG_RECORD_MAGIC        0xA55A
+#define LOG_ERASED_MAGIC        0xFFFF
+#define LOG_MIN_SECTORS         3
+
+/* Record types */
+#define LOG_SET                 1
+#define LOG_ERASE               2
+#define LOG_ERASE_ALL           3
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                 // LOG_SECTOR_MAGIC
+    uint32_t seq;                   // Higher is newer
+} log_sector_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t magic;                 // LOG_RECORD_MAGIC
+    uint8_t type;
+    uint8_t ns_len;
+    uint8_t key_len;
+    uint8_t reserved;
+    uint16_t value_len;
+    uint32_t crc;                   // Over the fields above, names and value
+} log_record_t;
+
+#define LOG_RECORD_MAX  (sizeof(log_record_t) + 2 * IR_STORAGE_KEY_MAX + IR_STORAGE_LOG_VALUE_MAX)
+
+/**
+ * @brief Live key
+ */
+typedef struct {
+    uint8_t ns;                     // Namespace slot + 1, 0 = free
+    char key[IR_STORAGE_KEY_MAX];
+    uint32_t value_addr;            // Partition offset of the value bytes
+    uint16_t len;
+} log_key_t;
+
+static const esp_partition_t *partition = NULL;
+static uint16_t num_sectors = 0;
+static uint16_t head = 0;           // Sector being written
+static uint16_t tail = 0;           // Oldest used sector
+static uint32_t write_off = 0;      // Next record offset within the head sector
+static uint32_t head_seq = 0;
+static bool compacting = false;
+static char namespaces[IR_STORAGE_LOG_MAX_NAMESPACES][IR_STORAGE_KEY_MAX];
+static log_key_t keys[IR_STORAGE_LOG_MAX_KEYS];
+
+static esp_err_t log_append(uint8_t type, uint8_t ns, const char *key, const void *value,
+                            size_t len, uint32_t *value_addr);
+
+/* ============================================================================
+ * INDEX
+ * ============================================================================ */
+
+/* Slot + 1 of a namespace, registering it if new; 0 when the table is full */
+static uint8_t ns_slot(const char *name, size_t len)
+{
+    for (uint8_t i = 0; i < IR_STORAGE_LOG_MAX_NAMESPACES; i++) {
+        if (namespaces[i][0] == '\0') {
+            memcpy(namespaces[i], name, len);
+            namespaces[i][len] = '\0';
+            return i + 1;
+        }
+        if (strlen(namespaces[i]) == len && memcmp(namespaces[i], name, len) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static log_key_t *key_find(uint8_t ns, const char *key)
+{
+    for (size_t i = 0; i < IR_STORAGE_LOG_MAX_KEYS; i++) {
+        if (keys[i].ns == ns && strcmp(keys[i].key, key) == 0) {
+            return &keys[i];
+        }
+    }
+    return NULL;
+}
+
+static bool key_room(void)
+{
+    for (size_t i = 0; i < IR_STORAGE_LOG_MAX_KEYS; i++) {
+        if (keys[i].ns == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static log_key_t *key_add(uint8_t ns, const char *key)
+{
+    log_key_t *entry = key_find(ns, key);
+    for (size_t i = 0; entry == NULL && i < IR_STORAGE_LOG_MAX_KEYS; i++) {
+        if (keys[i].ns == 0) {
+            entry = &keys[i];
+            entry->ns = ns;
+            strlcpy(entry->key, key, sizeof(entry->key));
+        }
+    }
+    return entry;
+}
+
+static void index_apply(uint8_t type, uint8_t ns, const char *key, uint32_t value_addr, uint16_t len)
+{
+    if (type == LOG_ERASE_ALL) {
+        for (size_t i = 0; i < IR_STORAGE_LOG_MAX_KEYS; i++) {
+            if (keys[i].ns == ns) {
+                keys[i].ns = 0;
+            }
+        }
+        return;
+    }
+
+    log_key_t *entry = (type == LOG_SET) ? key_add(ns, key) : key_find(ns, key);
+    if (entry == NULL) {
+        if (type == LOG_SET) {
+            ESP_LOGW(TAG, "Index full, dropping %s", key);
+        }
+        return;
+    }
+    if (type == LOG_ERASE) {
+        entry->ns = 0;
+    } else {
+        entry->value_addr = value_addr;
+        entry->len = len;
+    }
+}
+
+/* ============================================================================
+ * SECTORS
+ * ============================================================================ */
+
+static uint32_t sector_addr(uint16_t sector)
+{
+    return (uint32_t)sector * LOG_SECTOR_SIZE;
+}
+
+static uint16_t sectors_used(void)
+{
+    return (head + num_sectors - tail) % num_sectors + 1;
+}
+
+static uint16_t sectors_erased(void)
+{
+    return num_sectors - sectors_used();
+}
+
+/* Retired sectors are erased right away, so most sectors need no erase here */
+static bool sector_blank(uint16_t sector)
+{
+    uint32_t buf[64];
+    for (uint32_t off = 0; off < LOG_SECTOR_SIZE; off += sizeof(buf)) {
+        if (esp_partition_read(partition, sector_addr(sector) + off, buf, sizeof(buf)) != ESP_OK) {
+            return false;
+        }
+        for (size_t i = 0; i < sizeof(buf) / sizeof(buf[0]); i++) {
+            if (buf[i] != UINT32_MAX) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static esp_err_t sector_start(uint16_t sector, uint32_t seq)
+{
+    if (!sector_blank(sector)) {
+        esp_err_t err = esp_partition_erase_range(partition, sector_addr(sector), LOG_SECTOR_SIZE);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    /* Magic last: a header torn before it leaves the sector free */
+    esp_err_t err = esp_partition_write(partition, sector_addr(sector) + offsetof(log_sector_t, seq),
+                                        &seq, sizeof(seq));
+    if (err != ESP_OK) {
+        return err;
+    }
+    uint32_t magic = LOG_SECTOR_MAGIC;
+    return esp_partition_write(partition, sector_addr(sector) + offsetof(log_sector_t, magic),
+                               &magic, sizeof(magic));
+}
+
+static esp_err_t sector_open_next(void)
+{
+    uint16_t next = (head + 1) % num_sectors;
+    esp_err_t err = sector_start(next, head_seq + 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+    head = next;
+    head_seq++;
+    write_off = sizeof(log_sector_t);
+    return ESP_OK;
+}
+
+static size_t record_size(uint8_t ns, const char *key, size_t len)
+{
+    size_t raw_size = sizeof(log_record_t) + strlen(namespaces[ns - 1]) + (key ? strlen(key) : 0) + len;
+    return (raw_size + 3) & ~(size_t)3;
+}
+
+static bool key_in_tail(const log_key_t *entry)
+{
+    uint32_t start = sector_addr(tail);
+    /* value_addr - 1 is inside the record even for an empty value at a sector's end */
+    return entry->ns != 0 && entry->value_addr - 1 >= start &&
+           entry->value_addr - 1 < start + LOG_SECTOR_SIZE;
+}
+
+/* Head space the oldest sector's live records take once copied */
+static size_t tail_live_bytes(void)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < IR_STORAGE_LOG_MAX_KEYS; i++) {
+        if (key_in_tail(&keys[i])) {
+            total += record_size(keys[i].ns, keys[i].key, keys[i].len);
+        }
+    }
+    return total;
+}
+
+/*
+ * Copy the oldest sector's live records to the head and retire it. When
+ * they do not fit in the head, a fresh head is opened first, which may
+ * take the reserve. On any failure the oldest sector is left in place.
+ */
+static esp_err_t log_compact(void)
+{
+    if (sectors_used() < 2) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = ESP_OK;
+    if (write_off + tail_live_bytes() > LOG_SECTOR_SIZE) {
+        err = sectors_erased() > 0 ? sector_open_next() : ESP_ERR_NO_MEM;
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "No room to compact sector %u: %s", tail, esp_err_to_name(err));
+            return err;
+        }
+    }
+
+    uint32_t start = sector_addr(tail);
+    size_t moved = 0;
+    uint8_t value[IR_STORAGE_LOG_VALUE_MAX];
+
+    compacting = true;
+    for (size_t i = 0; i < IR_STORAGE_LOG_MAX_KEYS && err == ESP_OK; i++) {
+        log_key_t *entry = &keys[i];
+        if (!key_in_tail(entry)) {
+            continue;
+        }
+        /* The index moves to the copy only once it is written */
+        uint32_t value_addr;
+        err = esp_partition_read(partition, entry->value_addr, value, entry->len);
+        if (err == ESP_OK) {
+            err = log_append(LOG_SET, entry->ns, entry->key, value, entry->len, &value_addr);
+        }
+        if (err == ESP_OK) {
+            entry->value_addr = value_addr;
+            moved++;
+        }
+    }
+    compacting = false;
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Compaction of sector %u stopped, sector kept: %s", tail, esp_err_to_name(err));
+        return err;
+    }
+
+    /* The cleared header retires the sector even if the erase is cut short */
+    uint32_t retired = 0;
+    err = esp_partition_write(partition, start, &retired, sizeof(retired));
+    if (err != ESP_OK) {
+        return err;
+    }
+    ESP_LOGD(TAG, "Compacted sector %u: %u live record(s) moved", tail, (unsigned)moved);
+    tail = (tail + 1) % num_sectors;
+
+    err = esp_partition_erase_range(partition, start, LOG_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Erase of retired sector failed: %s", esp_err_to_name(err));
+    }
+    return ESP_OK;
+}
+
+/*
+ * Compact until the reserve is back. With @p may_open the first pass
+ * goes to a fresh head when needed; other passes only run while the
+ * oldest sector still fits in what is left of the head.
+ */
+static esp_err_t log_reserve_restore(bool may_open)
+{
+    esp_err_t err = ESP_OK;
+    for (; err == ESP_OK && sectors_erased() < 2 && sectors_used() > 1; may_open = false) {
+        if (!may_open && write_off + tail_live_bytes() > LOG_SECTOR_SIZE) {
+            break;
+        }
+        err = log_compact();
+    }
+    return err;
+}
+
+/* Open the next sector; compact when only the reserve is left erased */
+static esp_err_t log_advance(void)
+{
+    if (sectors_erased() == 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = sector_open_next();
+    if (err != ESP_OK) {
+        return err;
+    }
+    return sectors_erased() < 2 ? log_reserve_restore(true) : ESP_OK;
+}
+
+static esp_err_t log_append(uint8_t type, uint8_t ns, const char *key, const void *value,
+                            size_t len, uint32_t *value_addr)
+{
+    const char *ns_name = namespaces[ns - 1];
+    size_t ns_len = strlen(ns_name);
+    size_t key_len = key ? strlen(key) : 0;
+    size_t raw_size = sizeof(log_record_t) + ns_len + key_len + len;
+    size_t size = (raw_size + 3) & ~(size_t)3;
+
+    if (len > IR_STORAGE_LOG_VALUE_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!compacting && sectors_erased() < 2) {
+        /* A compaction stopped by a write error: finish it in the head */
+        log_reserve_restore(false);
+        if (sectors_erased() == 0 && write_off + size + tail_live_bytes() > LOG_SECTOR_SIZE) {
+            return ESP_ERR_NO_MEM;      // Keep room for the oldest sector's copies
+        }
+    }
+    if (write_off + size > LOG_SECTOR_SIZE) {
+        if (compacting) {
+            return ESP_ERR_NO_MEM;
+        }
+        esp_err_t err = log_advance();
+        if (err != ESP_OK) {
+            return err;
+        }
+        /* Compaction may have filled the fresh head */
+        if (write_off + size > LOG_SECTOR_SIZE && (err = log_advance()) != ESP_OK) {
+            return err;
+        }
+    }
+
+    uint8_t buf[LOG_RECORD_MAX + 4];
+    log_record_t *record = (log_record_t *)buf;
+    uint8_t *payload = buf + sizeof(log_record_t);
+
+    memset(buf, 0xFF, size);
+    record->magic = LOG_RECORD_MAGIC;
+    record->type = type;
+    record->ns_len = ns_len;
+    record->key_len = key_len;
+    record->reserved = 0xFF;
+    record->value_len = len;
+    memcpy(payload, ns_name, ns_len);
+    if (key_len > 0) {
+        memcpy(payload + ns_len, key, key_len);
+    }
+    if (len > 0) {
+        memcpy(payload + ns_len + key_len, value, len);
+    }
+    record->crc = esp_rom_crc32_le(0, buf, offsetof(log_record_t, crc));
+    record->crc = esp_rom_crc32_le(record->crc, payload, raw_size - sizeof(log_record_t));
+
+    uint32_t addr = sector_addr(head) + write_off;
+    esp_err_t err = esp_partition_write(partition, addr, buf, size);
+    write_off += size;      // Even when torn: replay skips it
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (value_addr) {
+        *value_addr = addr + sizeof(log_record_t) + ns_len + key_len;
+    }
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * REPLAY
+ * ============================================================================ */
+
+/* Read the record at @p off of the sector at @p base; false unless intact */
+static bool record_read(uint32_t base, uint32_t off, log_record_t *record, uint8_t *payload)
+{
+    if (esp_partition_read(partition, base + off, record, sizeof(*record)) != ESP_OK ||
+        record->magic != LOG_RECORD_MAGIC) {
+        return false;
+    }
+
+    size_t payload_len = record->ns_len + record->key_len + record->value_len;
+    size_t size = (sizeof(*record) + payload_len + 3) & ~(size_t)3;
+    if (record->ns_len == 0 || record->ns_len >= IR_STORAGE_KEY_MAX ||
+        record->key_len >= IR_STORAGE_KEY_MAX || record->value_len > IR_STORAGE_LOG_VALUE_MAX ||
+        off + size > LOG_SECTOR_SIZE ||
+        esp_partition_read(partition, base + off + sizeof(*record), payload, payload_len) != ESP_OK) {
+        return false;
+    }
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)record, offsetof(log_record_t, crc));
+    return esp_rom_crc32_le(crc, payload, payload_len) == record->crc;
+}
+
+/* Apply a sector's records; returns the offset after the last good one */
+static uint32_t replay_sector(uint16_t sector, size_t *records)
+{
+    uint32_t base = sector_addr(sector);
+    uint32_t off = sizeof(log_sector_t);
+    uint8_t buf[LOG_RECORD_MAX];
+
+    while (off + sizeof(log_record_t) <= LOG_SECTOR_SIZE) {
+        log_record_t record;
+        if (esp_partition_read(partition, base + off, &record, sizeof(record)) != ESP_OK ||
+            record.magic == LOG_ERASED_MAGIC) {
+            return off;
+        }
+
+        if (!record_read(base, off, &record, buf)) {
+            /* Resume at the next intact record; none after it means a reset */
+            uint32_t torn = off;
+            do {
+                off += 4;
+            } while (off + sizeof(log_record_t) <= LOG_SECTOR_SIZE && !record_read(base, off, &record, buf));
+            ESP_LOGW(TAG, "Torn record in sector %u at %lu", sector, (unsigned long)torn);
+            if (off + sizeof(log_record_t) > LOG_SECTOR_SIZE) {
+                return LOG_SECTOR_SIZE;
+            }
+        }
+
+        size_t size = (sizeof(record) + record.ns_len + record.key_len + record.value_len + 3) & ~(size_t)3;
+        uint8_t ns = ns_slot((const char *)buf, record.ns_len);
+        if (ns != 0) {
+            char key[IR_STORAGE_KEY_MAX];
+            memcpy(key, buf + record.ns_len, record.key_len);
+            key[record.key_len] = '\0';
+            index_apply(record.type, ns, key,
+                        base + off + sizeof(record) + record.ns_len + record.key_len,
+                        record.value_len);
+        }
+        (*records)++;
+        off += size;
+    }
+    return off;
+}
+
+/* Sequence number of a used sector, 0 for a free one */
+static uint32_t sector_seq(uint16_t sector)
+{
+    log_sector_t header;
+    if (esp_partition_read(partition, sector_addr(sector), &header, sizeof(header)) != ESP_OK ||
+        header.magic != LOG_SECTOR_MAGIC) {
+        return 0;
+    }
+    return header.seq;
+}
+
+static esp_err_t log_replay(void)
+{
+    uint16_t used = 0;
+
+    for (uint16_t i = 0; i < num_sectors; i++) {
+        uint32_t seq = sector_seq(i);
+        if (seq == 0) {
+            continue;
+        }
+        used++;
+        if (seq > head_seq) {
+            head = i;
+            head_seq = seq;
+        }
+    }
+
+    if (used == 0) {
+        ESP_LOGI(TAG, "Formatting %u sectors", num_sectors);
+        head = tail = 0;
+        head_seq = 1;
+        write_off = sizeof(log_sector_t);
+        return sector_start(0, head_seq);
+    }
+
+    /* Sectors are used in ring order, so the oldest is used - 1 behind the head */
+    tail = (head + num_sectors - (used - 1)) % num_sectors;
+
+    size_t records = 0;
+    for (uint16_t n = 0, s = tail; n < used; n++, s = (s + 1) % num_sectors) {
+        if (sector_seq(s) == 0) {
+            ESP_LOGW(TAG, "Sector %u missing from the ring", s);
+            continue;
+        }
+        write_off = replay_sector(s, &records);
+    }
+    ESP_LOGD(TAG, "Replayed %u record(s) from %u sector(s)", (unsigned)records, used);
+
+    /* Reset during compaction: finish it, in the reserve if the head is torn */
+    if (sectors_erased() < 2) {
+        esp_err_t err = log_reserve_restore(true);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Compaction not finished: %s", esp_err_to_name(err));
+        }
+    }
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * BACKEND
+ * ============================================================================ */
+
+static esp_err_t log_init(void)
+{
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                         IR_STORAGE_LOG_PARTITION);
+    if (partition == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    num_sectors = partition->size / LOG_SECTOR_SIZE;
+    if (num_sectors < LOG_MIN_SECTORS) {
+        ESP_LOGE(TAG, "%s needs at least %d sectors", IR_STORAGE_LOG_PARTITION, LOG_MIN_SECTORS);
+        partition = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memset(namespaces, 0, sizeof(namespaces));
+    memset(keys, 0, sizeof(keys));
+    head_seq = 0;
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = log_replay();
+    if (err != ESP_OK) {
+        partition = NULL;
+        return err;
+    }
+
+    size_t live = 0;
+    for (size_t i = 0; i < IR_STORAGE_LOG_MAX_KEYS; i++) {
+        live += keys[i].ns != 0;
+    }
+    ESP_LOGI(TAG, "Ring log: %u/%u sectors, %u live key(s), replay %lld us", sectors_used(),
+             num_sectors, (unsigned)live, (long long)(esp_timer_get_time() - start_us));
+    return ESP_OK;
+}
+
+static esp_err_t log_open(const char *namespace_name, void **ctx)
+{
+    uint8_t ns = ns_slot(namespace_name, strlen(namespace_name));
+    if (ns == 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    *ctx = (void *)(uintptr_t)ns;
+    return ESP_OK;
+}
+
+static void log_close(void *ctx)
+{
+    (void)ctx;
+}
+
+static esp_err_t log_get(void *ctx, const char *key, void *buf, size_t *len)
+{
+    log_key_t *entry = key_find((uint8_t)(uintptr_t)ctx, key);
+    if (entry == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (buf != NULL) {
+        if (*len < entry->len) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        esp_err_t err = esp_partition_read(partition, entry->value_addr, buf, entry->len);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    *len = entry->len;
+    return ESP_OK;
+}
+
+static esp_err_t log_set(void *ctx, const char *key, const void *data, size_t len)
+{
+    uint8_t ns = (uint8_t)(uintptr_t)ctx;
+    if (len > IR_STORAGE_LOG_VALUE_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* Unchanged values cost a read, not a flash program */
+    log_key_t *entry = key_find(ns, key);
+    if (entry != NULL && entry->len == len) {
+        uint8_t current[IR_STORAGE_LOG_VALUE_MAX];
+        if (esp_partition_read(partition, entry->value_addr, current, len) == ESP_OK &&
+            memcmp(current, data, len) == 0) {
+            return ESP_OK;
+        }
+    }
+    if (entry == NULL && !key_room()) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Indexed only once written: compaction during the append walks the index */
+    uint32_t value_addr;
+    esp_err_t err = log_append(LOG_SET, ns, key, data, len, &value_addr);
+    if (err == ESP_OK) {
+        index_apply(LOG_SET, ns, key, value_addr, len);
+    }
+    return err;
+}
+
+static esp_err_t log_erase(void *ctx, const char *key)
+{
+    uint8_t ns = (uint8_t)(uintptr_t)ctx;
+    log_key_t *entry = key_find(ns, key);
+    if (entry == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t err = log_append(LOG_ERASE, ns, key, NULL, 0, NULL);
+    if (err == ESP_OK) {
+        key_find(ns, key)->ns = 0;
+    }
+    return err;
+}
+
+static esp_err_t log_erase_all(void *ctx)
+{
+    uint8_t ns = (uint8_t)(uintptr_t)ctx;
+    esp_err_t err = log_append(LOG_ERASE_ALL, ns, NULL, NULL, 0, NULL);
+    if (err == ESP_OK) {
+        index_apply(LOG_ERASE_ALL, ns, NULL, 0, 0);
+    }
+    return err;
+}
+
+static esp_err_t log_used(void *ctx, size_t *bytes)
+{
+    uint8_t ns = (uint8_t)(uintptr_t)ctx;
+    size_t total = 0;
+    for (size_t i = 0; i < IR_STORAGE_LOG_MAX_KEYS; i++) {
+        if (keys[i].ns == ns) {
+            total += keys[i].len;
+        }
+    }
+    *bytes = total;
+    return ESP_OK;
+}
+
+const ir_storage_backend_t ir_storage_backend_log = {
+    .name = "log",
+    .init = log_init,
+    .open = log_open,
+    .close = log_close,
+    .get = log_get,
+    .set = log_set,
+    .erase = log_erase,
+    .erase_all = log_erase_all,
+    .used = log_used,
+};
@@ -0,0 +1,161 @@
+/**
+ * @file ir_storage_mem.c
+ * @brief In-memory backend of ir_storage
+ *
+ * Namespaces are heap lists of key/value entries that outlive
+ * ir_storage_deinit(), so a host test can "reboot" the storage layer and
+ * read back what it wrote. Commits are no-ops. Plain C apart from
+ * esp_err.h; calls are serialized by the storage layer.
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_storage.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct mem_entry {
+    struct mem_entry *next;
+    char key[IR_STORAGE_KEY_MAX];
+    size_t len;
+    uint8_t data[];
+} mem_entry_t;
+
+typedef struct mem_ns {
+    struct mem_ns *next;
+    char name[IR_STORAGE_KEY_MAX];
+    mem_entry_t *entries;
+} mem_ns_t;
+
+static mem_ns_t *mem_namespaces = NULL;
+
+static mem_entry_t **mem_find(mem_ns_t *ns, const char *key)
+{
+    mem_entry_t **link = &ns->entries;
+    while (*link != NULL && strcmp((*link)->key, key) != 0) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static void mem_free_entries(mem_ns_t *ns)
+{
+    while (ns->entries != NULL) {
+        mem_entry_t *next = ns->entries->next;
+        free(ns->entries);
+        ns->entries = next;
+    }
+}
+
+static esp_err_t mem_open(const char *namespace_name, void **ctx)
+{
+    mem_ns_t *ns = mem_namespaces;
+    while (ns != NULL && strcmp(ns->name, namespace_name) != 0) {
+        ns = ns->next;
+    }
+
+    if (ns == NULL) {
+        ns = calloc(1, sizeof(mem_ns_t));
+        if (ns == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        strncpy(ns->name, namespace_name, sizeof(ns->name) - 1);
+        ns->next = mem_namespaces;
+        mem_namespaces = ns;
+    }
+
+    *ctx = ns;
+    return ESP_OK;
+}
+
+static void mem_close(void *ctx)
+{
+    (void)ctx;      // Data stays until ir_storage_mem_reset()
+}
+
+static esp_err_t mem_get(void *ctx, const char *key, void *buf, size_t *len)
+{
+    mem_entry_t *entry = *mem_find(ctx, key);
+    if (entry == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (buf != NULL) {
+        if (*len < entry->len) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(buf, entry->data, entry->len);
+    }
+    *len = entry->len;
+    return ESP_OK;
+}
+
+static esp_err_t mem_set(void *ctx, const char *key, const void *data, size_t len)
+{
+    if (strlen(key) >= IR_STORAGE_KEY_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mem_entry_t **link = mem_find(ctx, key);
+    mem_entry_t *entry = realloc(*link, sizeof(mem_entry_t) + len);
+    if (entry == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (*link == NULL) {
+        entry->next = NULL;
+        strncpy(entry->key, key, sizeof(entry->key) - 1);
+        entry->key[sizeof(entry->key) - 1] = '\0';
+    }
+    entry->len = len;
+    memcpy(entry->data, data, len);
+    *link = entry;
+    return ESP_OK;
+}
+
+static esp_err_t mem_erase(void *ctx, const char *key)
+{
+    mem_entry_t **link = mem_find(ctx, key);
+    mem_entry_t *entry = *link;
+    if (entry == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *link = entry->next;
+    free(entry);
+    return ESP_OK;
+}
+
+static esp_err_t mem_erase_all(void *ctx)
+{
+    mem_free_entries(ctx);
+    return ESP_OK;
+}
+
+static esp_err_t mem_used(void *ctx, size_t *bytes)
+{
+    size_t total = 0;
+    for (mem_entry_t *entry = ((mem_ns_t *)ctx)->entries; entry != NULL; entry = entry->next) {
+        total += entry->len;
+    }
+    *bytes = total;
+    return ESP_OK;
+}
+
+void ir_storage_mem_reset(void)
+{
+    while (mem_namespaces != NULL) {
+        mem_ns_t *next = mem_namespaces->next;
+        mem_free_entries(mem_namespaces);
+        free(mem_namespaces);
+        mem_namespaces = next;
+    }
+}
+
+const ir_storage_backend_t ir_storage_backend_mem = {
+    .name = "mem",
+    .open = mem_open,
+    .close = mem_close,
+    .get = mem_get,
+    .set = mem_set,
+    .erase = mem_erase,
+    .erase_all = mem_erase_all,
+    .used = mem_used,
+};
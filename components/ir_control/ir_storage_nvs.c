@@ -0,0 +1,137 @@
+/**
+ * @file ir_storage_nvs.c
+ * @brief NVS backend of ir_storage (ir_storage partition)
+ *
+ * The backend context is the open handle plus its namespace name (the
+ * entry iterator of IDF 5.0 takes names, not handles). NVS error codes
+ * are mapped to the generic ones the storage layer promises.
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_storage.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ir_storage_nvs";
+
+static esp_err_t nvs_map_err(esp_err_t err)
+{
+    switch (err) {
+        case ESP_ERR_NVS_NOT_FOUND:         return ESP_ERR_NOT_FOUND;
+        case ESP_ERR_NVS_INVALID_LENGTH:    return ESP_ERR_INVALID_SIZE;
+        default:                            return err;
+    }
+}
+
+typedef struct {
+    nvs_handle_t handle;
+    char namespace_name[IR_STORAGE_KEY_MAX];
+} nvs_ctx_t;
+
+static nvs_handle_t nvs_ctx_handle(void *ctx)
+{
+    return ((nvs_ctx_t *)ctx)->handle;
+}
+
+static esp_err_t nvs_backend_init(void)
+{
+    esp_err_t err = nvs_flash_init_partition(IR_STORAGE_PARTITION);
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_LOGW(TAG, "%s partition needs to be erased, erasing...", IR_STORAGE_PARTITION);
+        err = nvs_flash_erase_partition(IR_STORAGE_PARTITION);
+        if (err == ESP_OK) {
+            err = nvs_flash_init_partition(IR_STORAGE_PARTITION);
+        }
+    }
+    return err;
+}
+
+static esp_err_t nvs_backend_open(const char *namespace_name, void **ctx)
+{
+    nvs_ctx_t *nvs = calloc(1, sizeof(nvs_ctx_t));
+    if (nvs == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = nvs_open_from_partition(IR_STORAGE_PARTITION, namespace_name, NVS_READWRITE,
+                                            &nvs->handle);
+    if (err != ESP_OK) {
+        free(nvs);
+        return err;
+    }
+    strlcpy(nvs->namespace_name, namespace_name, sizeof(nvs->namespace_name));
+    *ctx = nvs;
+    return ESP_OK;
+}
+
+static void nvs_backend_close(void *ctx)
+{
+    nvs_close(nvs_ctx_handle(ctx));
+    free(ctx);
+}
+
+static esp_err_t nvs_backend_get(void *ctx, const char *key, void *buf, size_t *len)
+{
+    return nvs_map_err(nvs_get_blob(nvs_ctx_handle(ctx), key, buf, len));
+}
+
+static esp_err_t nvs_backend_set(void *ctx, const char *key, const void *data, size_t len)
+{
+    return nvs_set_blob(nvs_ctx_handle(ctx), key, data, len);
+}
+
+static esp_err_t nvs_backend_erase(void *ctx, const char *key)
+{
+    return nvs_map_err(nvs_erase_key(nvs_ctx_handle(ctx), key));
+}
+
+static esp_err_t nvs_backend_erase_all(void *ctx)
+{
+    return nvs_erase_all(nvs_ctx_handle(ctx));
+}
+
+static esp_err_t nvs_backend_commit(void *ctx)
+{
+    return nvs_commit(nvs_ctx_handle(ctx));
+}
+
+/* Walks the namespace once at open; only done for namespaces with a quota */
+static esp_err_t nvs_backend_used(void *ctx, size_t *bytes)
+{
+    nvs_ctx_t *nvs = ctx;
+    nvs_iterator_t it = NULL;
+    size_t total = 0;
+
+    esp_err_t err = nvs_entry_find(IR_STORAGE_PARTITION, nvs->namespace_name, NVS_TYPE_BLOB, &it);
+    while (err == ESP_OK) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+
+        size_t len = 0;
+        if (nvs_get_blob(nvs->handle, info.key, NULL, &len) == ESP_OK) {
+            total += len;
+        }
+        err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+
+    *bytes = total;
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+}
+
+const ir_storage_backend_t ir_storage_backend_nvs = {
+    .name = "nvs",
+    .init = nvs_backend_init,
+    .open = nvs_backend_open,
+    .close = nvs_backend_close,
+    .get = nvs_backend_get,
+    .set = nvs_backend_set,
+    .erase = nvs_backend_erase,
+    .erase_all = nvs_backend_erase_all,
+    .commit = nvs_backend_commit,
+    .used = nvs_backend_used,
+};
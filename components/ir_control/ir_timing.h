@@ -15,6 +15,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "driver/rmt_rx.h"
 
 #ifdef __cplusplus
@@ -97,6 +98,29 @@ static inline uint16_t ir_get_space_us(const rmt_symbol_word_t *symbol) {
     return symbol->duration1;
 }
 
+/**
+ * @brief Check that a fixed-length frame ends before a symbol
+ *
+ * The symbol after the last data bit carries the stop mark. Its space is
+ * either the end of the capture (0) or a gap at least as long as the
+ * header space; anything shorter is another data bit, so the capture is
+ * a longer protocol that only starts like this one.
+ *
+ * @param symbols RMT symbols of the capture
+ * @param num_symbols Number of symbols
+ * @param stop_index Index of the stop symbol (header + data bits)
+ * @param header_space_us Header space of the protocol
+ * @return true if no data bits follow the frame
+ */
+static inline bool ir_frame_ends_at(const rmt_symbol_word_t *symbols, size_t num_symbols,
+                                    size_t stop_index, uint16_t header_space_us) {
+    if (stop_index >= num_symbols) {
+        return true;
+    }
+    uint16_t space_us = symbols[stop_index].duration1;
+    return space_us == 0 || space_us >= header_space_us;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,310 @@
+/**
+ * @file ir_transfer.c
+ * @brief Import and export of learned codes as Pronto Hex, LIRC or IRDB CSV
+ *
+ * Copyright (c) 2025
+ */
+
+#include "ir_transfer.h"
+#include "ir_control.h"
+#include "ir_storage.h"
+#include "esp_log.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ir_transfer";
+
+#define NAME_KEY_LEN            IR_FORMAT_NAME_LEN
+
+/**
+ * @brief Common button names that differ from the action names
+ *
+ * Keys are normalized (see normalize_name()).
+ */
+static const struct {
+    const char *name;
+    ir_action_t action;
+} name_aliases[] = {
+    { "volup",          IR_ACTION_VOL_UP },
+    { "voldown",        IR_ACTION_VOL_DOWN },
+    { "chup",           IR_ACTION_CH_UP },
+    { "chdown",         IR_ACTION_CH_DOWN },
+    { "channelprevious", IR_ACTION_CH_PREV },
+    { "prevch",         IR_ACTION_CH_PREV },
+    { "prech",          IR_ACTION_CH_PREV },
+    { "last",           IR_ACTION_CH_PREV },
+    { "recall",         IR_ACTION_CH_PREV },
+    { "up",             IR_ACTION_NAV_UP },
+    { "down",           IR_ACTION_NAV_DOWN },
+    { "left",           IR_ACTION_NAV_LEFT },
+    { "right",          IR_ACTION_NAV_RIGHT },
+    { "ok",             IR_ACTION_NAV_OK },
+    { "enter",          IR_ACTION_NAV_OK },
+    { "select",         IR_ACTION_NAV_OK },
+    { "return",         IR_ACTION_BACK },
+    { "display",        IR_ACTION_INFO },
+    { "source",         IR_ACTION_TV_INPUT },
+    { "epg",            IR_ACTION_STB_GUIDE },
+    { "rec",            IR_ACTION_STB_RECORD },
+    { "play",           IR_ACTION_STB_PLAY_PAUSE },
+    { "pause",          IR_ACTION_STB_PLAY_PAUSE },
+    { "rewind",         IR_ACTION_STB_REWIND },
+    { "rew",            IR_ACTION_STB_REWIND },
+    { "fastforward",    IR_ACTION_STB_FORWARD },
+    { "ffwd",           IR_ACTION_STB_FORWARD },
+    { "ff",             IR_ACTION_STB_FORWARD },
+    { "next",           IR_ACTION_STB_NEXT_TRACK },
+    { "previous",       IR_ACTION_STB_PREV_TRACK },
+    { "prev",           IR_ACTION_STB_PREV_TRACK },
+    { "subtitles",      IR_ACTION_STB_SUBTITLE },
+};
+
+#define NUM_NAME_ALIASES    (sizeof(name_aliases) / sizeof(name_aliases[0]))
+
+/* ============================================================================
+ * NAME MATCHING
+ * ============================================================================ */
+
+/**
+ * @brief Lower-case alphanumerics only; "+" / "-" become "up" / "down"
+ *
+ * A leading "key" or "btn" (LIRC's KEY_POWER, Flipper's BTN_...) is dropped.
+ */
+static void normalize_name(const char *name, char *out, size_t size)
+{
+    size_t len = 0;
+    out[0] = '\0';
+
+    for (const char *c = name; *c && len < size - 1; c++) {
+        const char *add = NULL;
+        char single[2] = { 0 };
+        if (isalnum((unsigned char)*c)) {
+            single[0] = (char)tolower((unsigned char)*c);
+            add = single;
+        } else if (*c == '+') {
+            add = "up";
+        } else if (*c == '-' && c[1] == '\0') {
+            add = "down";       // Trailing only: "Vol-", not "Ch-Up"
+        }
+        if (add) {
+            len += strlcpy(out + len, add, size - len);
+            len = len < size ? len : size - 1;
+        }
+    }
+
+    if ((strncmp(out, "key", 3) == 0 || strncmp(out, "btn", 3) == 0) && out[3] != '\0') {
+        memmove(out, out + 3, strlen(out + 3) + 1);
+    }
+}
+
+ir_action_t ir_transfer_match_action(const char *name)
+{
+    if (!name) {
+        return IR_ACTION_NONE;
+    }
+
+    char key[NAME_KEY_LEN];
+    normalize_name(name, key, sizeof(key));
+    if (key[0] == '\0') {
+        return IR_ACTION_NONE;
+    }
+
+    /* Bare digits are the number keys */
+    if (key[0] >= '0' && key[0] <= '9' && key[1] == '\0') {
+        return (ir_action_t)(IR_ACTION_NUM_0 + (key[0] - '0'));
+    }
+
+    char candidate[NAME_KEY_LEN];
+    for (int i = IR_ACTION_NONE + 1; i < IR_ACTION_MAX; i++) {
+        normalize_name(ir_action_get_action_name((ir_action_t)i), candidate, sizeof(candidate));
+        if (strcmp(key, candidate) == 0) {
+            return (ir_action_t)i;
+        }
+    }
+
+    for (size_t i = 0; i < NUM_NAME_ALIASES; i++) {
+        if (strcmp(key, name_aliases[i].name) == 0) {
+            return name_aliases[i].action;
+        }
+    }
+    return IR_ACTION_NONE;
+}
+
+/* ============================================================================
+ * IMPORT
+ * ============================================================================ */
+
+typedef struct {
+    ir_device_type_t device;
+    ir_transfer_stats_t *stats;
+} import_ctx_t;
+
+static esp_err_t import_entry_cb(const ir_format_entry_t *entry, void *arg)
+{
+    import_ctx_t *ctx = (import_ctx_t *)arg;
+
+    ir_action_t action = ir_transfer_match_action(entry->name);
+    if (action == IR_ACTION_NONE) {
+        ESP_LOGD(TAG, "No action for \"%s\"", entry->name);
+        ctx->stats->unmatched++;
+        return ESP_OK;
+    }
+
+    esp_err_t err = ir_action_save(ctx->device, action, &entry->code);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save \"%s\": %s", entry->name, esp_err_to_name(err));
+        return err;
+    }
+    ctx->stats->saved++;
+    return ESP_OK;
+}
+
+esp_err_t ir_transfer_import(ir_format_t format, ir_format_read_fn read, void *ctx,
+                             ir_device_type_t device, ir_transfer_stats_t *stats)
+{
+    if (device <= IR_DEVICE_NONE || device >= IR_DEVICE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ir_transfer_stats_t local = {0};
+    import_ctx_t import = {
+        .device = device,
+        .stats = &local,
+    };
+
+    ir_storage_begin_batch();
+    esp_err_t err = ir_format_parse(format, read, ctx, import_entry_cb, &import, &local.format);
+    esp_err_t commit_err = ir_storage_end_batch();
+    if (err == ESP_OK) {
+        err = commit_err;
+    }
+
+    ESP_LOGI(TAG, "Imported %u %s codes for %s (%u unmatched, %u unsupported, %u lines)",
+             local.saved, ir_format_get_name(format), ir_action_get_device_name(device),
+             local.unmatched, (unsigned)local.format.skipped, (unsigned)local.format.lines);
+
+    if (stats) {
+        *stats = local;
+    }
+    return err;
+}
+
+esp_err_t ir_transfer_import_file(ir_format_t format, const char *path,
+                                  ir_device_type_t device, ir_transfer_stats_t *stats)
+{
+    if (!path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t err = ir_transfer_import(format, ir_format_read_file, file, device, stats);
+    fclose(file);
+    return err;
+}
+
+esp_err_t ir_transfer_import_blob(ir_format_t format, const char *data, size_t len,
+                                  ir_device_type_t device, ir_transfer_stats_t *stats)
+{
+    if (!data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ir_format_mem_t mem = {
+        .data = data,
+        .len = len,
+        .pos = 0,
+    };
+    return ir_transfer_import(format, ir_format_read_mem, &mem, device, stats);
+}
+
+/* ============================================================================
+ * EXPORT
+ * ============================================================================ */
+
+static esp_err_t export_code(ir_format_writer_t *writer, const char *name, const ir_code_t *code)
+{
+    if (writer->format == IR_FORMAT_IRDB_CSV || code->protocol == IR_PROTOCOL_RAW) {
+        return ir_format_write_code(writer, name, code);
+    }
+
+    /* Pronto and LIRC carry timing: render protocol codes first */
+    void *symbols = NULL;
+    size_t num_symbols = 0;
+    esp_err_t err = ir_render_code(code, &symbols, &num_symbols);
+    if (err != ESP_OK) {
+        return err == ESP_ERR_NO_MEM ? err : ESP_ERR_NOT_SUPPORTED;
+    }
+    err = ir_format_write_symbols(writer, name, code->carrier_freq_hz, symbols, num_symbols);
+    free(symbols);
+    return err;
+}
+
+esp_err_t ir_transfer_export(ir_format_t format, ir_device_type_t device,
+                             ir_format_write_fn write, void *ctx, ir_transfer_stats_t *stats)
+{
+    if (device <= IR_DEVICE_NONE || device >= IR_DEVICE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ir_transfer_stats_t local = {0};
+    ir_format_writer_t writer;
+    esp_err_t err = ir_format_writer_begin(&writer, format, ir_action_get_device_name(device), write, ctx);
+
+    for (int i = IR_ACTION_NONE + 1; i < IR_ACTION_MAX && err == ESP_OK; i++) {
+        ir_code_t code = {0};
+        if (ir_action_load(device, (ir_action_t)i, &code) != ESP_OK) {
+            continue;
+        }
+
+        err = export_code(&writer, ir_action_get_action_name((ir_action_t)i), &code);
+        if (err == ESP_OK) {
+            local.saved++;
+        } else if (err == ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGD(TAG, "%s (%s) has no %s form", ir_action_get_action_name((ir_action_t)i),
+                     ir_get_protocol_name(code.protocol), ir_format_get_name(format));
+            local.unsupported++;
+            err = ESP_OK;
+        }
+        ir_code_free(&code);
+    }
+
+    esp_err_t end_err = ir_format_writer_end(&writer);
+    if (err == ESP_OK) {
+        err = end_err;
+    }
+
+    ESP_LOGI(TAG, "Exported %u %s codes as %s (%u unsupported)", local.saved,
+             ir_action_get_device_name(device), ir_format_get_name(format), local.unsupported);
+
+    if (stats) {
+        *stats = local;
+    }
+    return err;
+}
+
+esp_err_t ir_transfer_export_file(ir_format_t format, ir_device_type_t device, const char *path,
+                                  ir_transfer_stats_t *stats)
+{
+    if (!path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        ESP_LOGE(TAG, "Cannot create %s", path);
+        return ESP_FAIL;
+    }
+
+    esp_err_t err = ir_transfer_export(format, device, ir_format_write_file, file, stats);
+    if (fclose(file) != 0 && err == ESP_OK) {
+        err = ESP_FAIL;
+    }
+    return err;
+}
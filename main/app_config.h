@@ -15,6 +15,9 @@
 // IR Hardware
 #define GPIO_IR_TX              17  // IR Transmitter (940nm LED)
 #define GPIO_IR_RX              18  // IR Receiver (IRM-3638T, active-LOW)
+#define GPIO_IR_TX_2            -1  // Extra IR emitters, own RMT channel each
+#define GPIO_IR_TX_3            -1  // (-1 = not fitted)
+#define GPIO_IR_TX_4            -1
 
 // Status LED
 #define GPIO_RGB_LED            11  // WS2812B RGB LED (ESP32-S3 compatible)
@@ -42,6 +45,8 @@
 #define IR_LEARNING_TIMEOUT_MS  30000   // 30 seconds
 #define IR_TX_RMT_CHANNEL       1       // RMT channel for TX
 #define IR_RX_RMT_CHANNEL       2       // RMT channel for RX
+#define AC_NUM_UNITS            1       // AC units driven by this node (1-4)
+#define AC_UNIT_EMITTERS        { 0, 1, 2, 3 }  // IR emitter of each AC unit
 
 /* ============================================================================
  * RGB LED CONFIGURATION
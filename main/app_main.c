@@ -7,6 +7,9 @@
  * - Logical action mapping (RainMaker params → IR codes)
  * - AC state-based control (full state regeneration)
  * - Custom device (12 programmable buttons for any IR appliance)
+ * - IR scenes: multi-device sequences played from pre-rendered frames
+ * - IR code library on SPIFFS (8MB/16MB flash)
+ * - Code scan: find a remote's code set in the library (boot button confirms)
  * - BLE WiFi provisioning
  * - Cloud control via RainMaker app
  * - IR learning and transmission
@@ -23,6 +26,7 @@
  * v3.1+ - Custom device support for generic IR appliances
  */
 
+#include <stdio.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -44,6 +48,9 @@
 #include "esp_rmaker_console.h"
 #include "esp_rmaker_utils.h"
 #include "rmaker_devices.h"
+#include "param_map.h"
+#include "scene_service.h"
+#include "scan_service.h"
 
 /* Application headers */
 #include "app_config.h"
@@ -51,6 +58,9 @@
 #include "ir_control.h"
 #include "ir_action.h"
 #include "ir_ac_state.h"
+#include "ir_scene.h"
+#include "ir_library.h"
+#include "ir_scan.h"
 #include "rgb_led.h"
 
 static const char *TAG = "app_main";
@@ -60,7 +70,7 @@ static const char *TAG = "app_main";
  * ============================================================================ */
 
 static esp_rmaker_device_t *tv_device = NULL;
-static esp_rmaker_device_t *ac_device = NULL;
+static esp_rmaker_device_t *ac_devices[IR_AC_MAX_UNITS] = {NULL};
 static esp_rmaker_device_t *stb_device = NULL;
 static esp_rmaker_device_t *speaker_device = NULL;
 static esp_rmaker_device_t *fan_device = NULL;
@@ -156,481 +166,321 @@ static void ir_learn_fail_callback(ir_button_t button, void *arg)
 }
 
 /* ============================================================================
- * TV DEVICE CALLBACKS
+ * PARAMETER BINDINGS
  * ============================================================================ */
 
-static esp_err_t tv_write_cb(const esp_rmaker_device_t *device,
-                               const esp_rmaker_param_t *param,
-                               const esp_rmaker_param_val_t val,
-                               void *priv_data,
-                               esp_rmaker_write_ctx_t *ctx)
-{
-    const char *param_name = esp_rmaker_param_get_name(param);
-    ESP_LOGI(TAG, "TV parameter update: %s", param_name);
-
-    /* TRIGGER BUTTONS - Execute IR action immediately when pressed */
-    if (strcmp(param_name, "Power") == 0) {
-        ESP_LOGI(TAG, "TV Power button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_POWER);
-    }
-    else if (strcmp(param_name, "Vol_Up") == 0) {
-        ESP_LOGI(TAG, "TV Volume Up button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_VOL_UP);
-    }
-    else if (strcmp(param_name, "Vol_Down") == 0) {
-        ESP_LOGI(TAG, "TV Volume Down button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_VOL_DOWN);
-    }
-    else if (strcmp(param_name, "Mute") == 0) {
-        ESP_LOGI(TAG, "TV Mute button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_MUTE);
-    }
-    else if (strcmp(param_name, "Ch_Up") == 0) {
-        ESP_LOGI(TAG, "TV Channel Up button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_CH_UP);
-    }
-    else if (strcmp(param_name, "Ch_Down") == 0) {
-        ESP_LOGI(TAG, "TV Channel Down button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_CH_DOWN);
-    }
-    else if (strcmp(param_name, "Input") == 0) {
-        ESP_LOGI(TAG, "TV Input button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_TV_INPUT);
-    }
-    else if (strcmp(param_name, "Menu") == 0) {
-        ESP_LOGI(TAG, "TV Menu button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_MENU);
-    }
-    else if (strcmp(param_name, "OK") == 0) {
-        ESP_LOGI(TAG, "TV OK button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_NAV_OK);
-    }
-    else if (strcmp(param_name, "Back") == 0) {
-        ESP_LOGI(TAG, "TV Back button pressed");
-        return ir_action_execute(IR_DEVICE_TV, IR_ACTION_BACK);
-    }
-    /* Learn Mode - Dropdown selection */
-    else if (strcmp(param_name, "Learn_Mode") == 0) {
-        const char *action_name = val.val.s;
-        ESP_LOGI(TAG, "TV Learn Mode: %s", action_name);
-
-        /* Map dropdown selection to ir_action_t */
-        ir_action_t action = IR_ACTION_NONE;
-        if (strcmp(action_name, "Power") == 0) action = IR_ACTION_POWER;
-        else if (strcmp(action_name, "VolumeUp") == 0) action = IR_ACTION_VOL_UP;
-        else if (strcmp(action_name, "VolumeDown") == 0) action = IR_ACTION_VOL_DOWN;
-        else if (strcmp(action_name, "Mute") == 0) action = IR_ACTION_MUTE;
-        else if (strcmp(action_name, "ChannelUp") == 0) action = IR_ACTION_CH_UP;
-        else if (strcmp(action_name, "ChannelDown") == 0) action = IR_ACTION_CH_DOWN;
-        else if (strcmp(action_name, "Input") == 0) action = IR_ACTION_TV_INPUT;
-        else if (strcmp(action_name, "Menu") == 0) action = IR_ACTION_MENU;
-        else if (strcmp(action_name, "OK") == 0) action = IR_ACTION_NAV_OK;
-        else if (strcmp(action_name, "Back") == 0) action = IR_ACTION_BACK;
-        else {
-            ESP_LOGW(TAG, "Unknown action: %s", action_name);
-            return ESP_ERR_INVALID_ARG;
-        }
+/* Learn dropdown values → actions ("None" selects nothing) */
+static const param_option_t tv_learn_actions[] = {
+    {"Power", IR_ACTION_POWER}, {"VolumeUp", IR_ACTION_VOL_UP}, {"VolumeDown", IR_ACTION_VOL_DOWN},
+    {"Mute", IR_ACTION_MUTE}, {"ChannelUp", IR_ACTION_CH_UP}, {"ChannelDown", IR_ACTION_CH_DOWN},
+    {"Input", IR_ACTION_TV_INPUT}, {"Menu", IR_ACTION_MENU}, {"OK", IR_ACTION_NAV_OK},
+    {"Back", IR_ACTION_BACK},
+};
+
+static const param_option_t stb_learn_actions[] = {
+    {"Power", IR_ACTION_POWER}, {"ChannelUp", IR_ACTION_CH_UP}, {"ChannelDown", IR_ACTION_CH_DOWN},
+    {"PlayPause", IR_ACTION_STB_PLAY_PAUSE}, {"Guide", IR_ACTION_STB_GUIDE}, {"Menu", IR_ACTION_MENU},
+    {"OK", IR_ACTION_NAV_OK}, {"Back", IR_ACTION_BACK},
+};
+
+static const param_option_t speaker_learn_actions[] = {
+    {"Power", IR_ACTION_POWER}, {"VolumeUp", IR_ACTION_VOL_UP}, {"VolumeDown", IR_ACTION_VOL_DOWN},
+    {"Mute", IR_ACTION_MUTE},
+};
+
+static const param_option_t custom_learn_actions[] = {
+    {"Power", IR_ACTION_POWER},
+    {"Button1", IR_ACTION_CUSTOM_1}, {"Button2", IR_ACTION_CUSTOM_2}, {"Button3", IR_ACTION_CUSTOM_3},
+    {"Button4", IR_ACTION_CUSTOM_4}, {"Button5", IR_ACTION_CUSTOM_5}, {"Button6", IR_ACTION_CUSTOM_6},
+    {"Button7", IR_ACTION_CUSTOM_7}, {"Button8", IR_ACTION_CUSTOM_8}, {"Button9", IR_ACTION_CUSTOM_9},
+    {"Button10", IR_ACTION_CUSTOM_10}, {"Button11", IR_ACTION_CUSTOM_11}, {"Button12", IR_ACTION_CUSTOM_12},
+};
+
+/* AC dropdown values (anything else keeps the default: Cool / Auto) */
+static const param_option_t ac_mode_values[] = {
+    {"Cool", AC_MODE_COOL}, {"Heat", AC_MODE_HEAT}, {"Auto", AC_MODE_AUTO},
+    {"Dry", AC_MODE_DRY}, {"Fan", AC_MODE_FAN},
+};
+
+static const param_option_t ac_fan_speed_values[] = {
+    {"Auto", AC_FAN_AUTO}, {"Low", AC_FAN_LOW}, {"Medium", AC_FAN_MEDIUM}, {"High", AC_FAN_HIGH},
+};
+
+#define AC_PROTOCOL_AUTO_DETECT     (-1)
+
+static const param_option_t ac_protocol_values[] = {
+    {"Auto-Detect", AC_PROTOCOL_AUTO_DETECT},
+    {"Daikin", IR_PROTOCOL_DAIKIN}, {"Carrier", IR_PROTOCOL_CARRIER}, {"Voltas", IR_PROTOCOL_CARRIER},
+    {"Hitachi", IR_PROTOCOL_HITACHI}, {"Mitsubishi", IR_PROTOCOL_MITSUBISHI},
+    {"Midea", IR_PROTOCOL_MIDEA}, {"Haier", IR_PROTOCOL_HAIER},
+    {"Samsung48", IR_PROTOCOL_SAMSUNG48}, {"Samsung", IR_PROTOCOL_SAMSUNG48},
+    {"Panasonic", IR_PROTOCOL_PANASONIC}, {"Fujitsu", IR_PROTOCOL_FUJITSU},
+    {"LG2", IR_PROTOCOL_LG2}, {"LG", IR_PROTOCOL_LG2},
+};
+
+#define OPTIONS(table)  .options = (table), .num_options = sizeof(table) / sizeof((table)[0])
 
-        /* Start learning */
-        learning_state.device = IR_DEVICE_TV;
-        learning_state.action = action;
-        learning_state.is_active = true;
+/**
+ * @brief Create a push button parameter that executes (device, action)
+ */
+static void add_trigger_param(esp_rmaker_device_t *rm_device, const char *name, uint8_t flags,
+                              ir_device_type_t device, ir_action_t action)
+{
+    esp_rmaker_param_t *button = esp_rmaker_param_create(name, "esp.param.toggle",
+                                                           esp_rmaker_bool(false), flags);
+    esp_rmaker_param_add_ui_type(button, ESP_RMAKER_UI_TRIGGER);
+    esp_rmaker_device_add_param(rm_device, button);
+
+    param_map_bind(button, &(param_binding_t) {
+        .kind = PARAM_KIND_TRIGGER, .device = device, .action = action,
+    });
+}
 
-        rgb_led_set_mode(LED_MODE_IR_LEARNING);
-        return ir_action_learn(IR_DEVICE_TV, action, IR_LEARNING_TIMEOUT_MS);
-    }
+/**
+ * @brief Create the Learn_Mode dropdown of a device
+ */
+static void add_learn_param(esp_rmaker_device_t *rm_device, ir_device_type_t device,
+                            const char **valid, int num_valid,
+                            const param_option_t *actions, size_t num_actions)
+{
+    esp_rmaker_param_t *learn_mode = esp_rmaker_param_create("Learn_Mode", "esp.param.string",
+                                                               esp_rmaker_str("None"), PROP_FLAG_WRITE);
+    esp_rmaker_param_add_ui_type(learn_mode, ESP_RMAKER_UI_DROPDOWN);
+    esp_rmaker_param_add_valid_str_list(learn_mode, valid, num_valid);
+    esp_rmaker_device_add_param(rm_device, learn_mode);
 
-    return ESP_OK;
+    param_map_bind(learn_mode, &(param_binding_t) {
+        .kind = PARAM_KIND_LEARN, .device = device, .options = actions, .num_options = num_actions,
+    });
 }
 
 /* ============================================================================
- * AC DEVICE CALLBACKS
+ * DEVICE WRITE CALLBACK
  * ============================================================================ */
 
-static esp_err_t ac_write_cb(const esp_rmaker_device_t *device,
-                               const esp_rmaker_param_t *param,
-                               const esp_rmaker_param_val_t val,
-                               void *priv_data,
-                               esp_rmaker_write_ctx_t *ctx)
+/**
+ * @brief Start learning the action picked in a Learn_Mode dropdown
+ */
+static esp_err_t start_learning(const param_binding_t *binding, const char *action_name)
 {
-    const char *param_name = esp_rmaker_param_get_name(param);
-    ESP_LOGI(TAG, "AC parameter update: %s", param_name);
-
-    /* AC Power */
-    if (strcmp(param_name, ESP_RMAKER_DEF_POWER_NAME) == 0) {
-        bool power = val.val.b;
-        ESP_LOGI(TAG, "AC Power: %s", power ? "ON" : "OFF");
-        return ir_ac_set_power(power);
-    }
-    /* AC Mode */
-    else if (strcmp(param_name, "Mode") == 0) {
-        const char *mode_str = val.val.s;
-        ESP_LOGI(TAG, "AC Mode: %s", mode_str);
-
-        ac_mode_t mode = AC_MODE_COOL;
-        if (strcmp(mode_str, "Cool") == 0) mode = AC_MODE_COOL;
-        else if (strcmp(mode_str, "Heat") == 0) mode = AC_MODE_HEAT;
-        else if (strcmp(mode_str, "Auto") == 0) mode = AC_MODE_AUTO;
-        else if (strcmp(mode_str, "Dry") == 0) mode = AC_MODE_DRY;
-        else if (strcmp(mode_str, "Fan") == 0) mode = AC_MODE_FAN;
-
-        return ir_ac_set_mode(mode);
-    }
-    /* AC Temperature */
-    else if (strcmp(param_name, ESP_RMAKER_DEF_TEMPERATURE_NAME) == 0) {
-        float temp = val.val.f;
-        uint8_t temperature = (uint8_t)temp;
-        ESP_LOGI(TAG, "AC Temperature: %d°C", temperature);
-        return ir_ac_set_temperature(temperature);
-    }
-    /* AC Fan Speed */
-    else if (strcmp(param_name, "Fan_Speed") == 0) {
-        const char *fan_str = val.val.s;
-        ESP_LOGI(TAG, "AC Fan Speed: %s", fan_str);
-
-        ac_fan_speed_t fan_speed = AC_FAN_AUTO;
-        if (strcmp(fan_str, "Auto") == 0) fan_speed = AC_FAN_AUTO;
-        else if (strcmp(fan_str, "Low") == 0) fan_speed = AC_FAN_LOW;
-        else if (strcmp(fan_str, "Medium") == 0) fan_speed = AC_FAN_MEDIUM;
-        else if (strcmp(fan_str, "High") == 0) fan_speed = AC_FAN_HIGH;
-
-        return ir_ac_set_fan_speed(fan_speed);
-    }
-    /* AC Swing */
-    else if (strcmp(param_name, "Swing") == 0) {
-        bool swing = val.val.b;
-        ESP_LOGI(TAG, "AC Swing: %s", swing ? "ON" : "OFF");
-        return ir_ac_set_swing(swing ? AC_SWING_VERTICAL : AC_SWING_OFF);
+    ESP_LOGI(TAG, "%s Learn Mode: %s", ir_action_get_device_name(binding->device), action_name);
+
+    int action;
+    if (!param_map_option(binding, action_name, &action)) {
+        ESP_LOGW(TAG, "Unknown action: %s", action_name);
+        return ESP_ERR_INVALID_ARG;
     }
-    /* AC Learn Protocol */
-    else if (strcmp(param_name, "Learn_Protocol") == 0) {
-        const char *protocol_str = val.val.s;
-        ESP_LOGI(TAG, "AC Learn Protocol: %s", protocol_str);
-
-        /* Auto-detect mode - trigger AC learning */
-        if (strcmp(protocol_str, "Auto-Detect") == 0) {
-            ESP_LOGI(TAG, "Starting AC protocol auto-detection...");
-            rgb_led_set_mode(LED_MODE_IR_LEARNING);
-
-            esp_err_t err = ir_ac_learn_protocol(IR_LEARNING_TIMEOUT_MS);
-
-            if (err == ESP_OK) {
-                ESP_LOGI(TAG, "AC protocol learned successfully!");
-                rgb_led_set_mode(LED_MODE_IR_LEARNING_SUCCESS);
-                vTaskDelay(pdMS_TO_TICKS(1500));
-            } else {
-                ESP_LOGE(TAG, "AC protocol learning failed: %s", esp_err_to_name(err));
-                rgb_led_set_mode(LED_MODE_IR_LEARNING_FAILED);
-                vTaskDelay(pdMS_TO_TICKS(1500));
-            }
 
-            /* Return to connected state */
-            if (app_wifi_is_connected()) {
-                rgb_led_set_mode(LED_MODE_WIFI_CONNECTED);
-            } else {
-                rgb_led_set_mode(LED_MODE_OFF);
-            }
+    /* Start learning */
+    learning_state.device = binding->device;
+    learning_state.action = (ir_action_t)action;
+    learning_state.is_active = true;
 
-            return err;
-        }
+    rgb_led_set_mode(LED_MODE_IR_LEARNING);
+    return ir_action_learn(binding->device, (ir_action_t)action, IR_LEARNING_TIMEOUT_MS);
+}
 
-        /* Manual protocol selection */
-        ir_protocol_t protocol = IR_PROTOCOL_UNKNOWN;
-        if (strcmp(protocol_str, "Daikin") == 0) protocol = IR_PROTOCOL_DAIKIN;
-        else if (strcmp(protocol_str, "Carrier") == 0 || strcmp(protocol_str, "Voltas") == 0) {
-            protocol = IR_PROTOCOL_CARRIER;
-        }
-        else if (strcmp(protocol_str, "Hitachi") == 0) protocol = IR_PROTOCOL_HITACHI;
-        else if (strcmp(protocol_str, "Mitsubishi") == 0) protocol = IR_PROTOCOL_MITSUBISHI;
-        else if (strcmp(protocol_str, "Midea") == 0) protocol = IR_PROTOCOL_MIDEA;
-        else if (strcmp(protocol_str, "Haier") == 0) protocol = IR_PROTOCOL_HAIER;
-        else if (strcmp(protocol_str, "Samsung48") == 0) protocol = IR_PROTOCOL_SAMSUNG48;
-        else if (strcmp(protocol_str, "Panasonic") == 0) protocol = IR_PROTOCOL_PANASONIC;
-        else if (strcmp(protocol_str, "Fujitsu") == 0) protocol = IR_PROTOCOL_FUJITSU;
-        else if (strcmp(protocol_str, "LG2") == 0) protocol = IR_PROTOCOL_LG2;
-        else if (strcmp(protocol_str, "Samsung") == 0) protocol = IR_PROTOCOL_SAMSUNG48;
-        else if (strcmp(protocol_str, "LG") == 0) protocol = IR_PROTOCOL_LG2;
-
-        if (protocol != IR_PROTOCOL_UNKNOWN) {
-            esp_err_t err = ir_ac_set_protocol(protocol, 0);
-            if (err == ESP_OK) {
-                ESP_LOGI(TAG, "AC protocol manually set to: %s", protocol_str);
-            }
-            return err;
-        }
+/**
+ * @brief Learn or set the protocol of an AC unit
+ */
+static esp_err_t ac_set_protocol(ir_ac_handle_t unit, const param_binding_t *binding,
+                                 const char *protocol_str)
+{
+    ESP_LOGI(TAG, "AC Learn Protocol: %s", protocol_str);
 
+    int protocol;
+    if (!param_map_option(binding, protocol_str, &protocol)) {
         ESP_LOGW(TAG, "Unknown protocol: %s", protocol_str);
         return ESP_ERR_INVALID_ARG;
     }
 
-    return ESP_OK;
-}
+    /* Manual protocol selection */
+    if (protocol != AC_PROTOCOL_AUTO_DETECT) {
+        esp_err_t err = ir_ac_unit_set_protocol(unit, (ir_protocol_t)protocol, 0);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "AC protocol manually set to: %s", protocol_str);
+            ir_scene_refresh();
+        }
+        return err;
+    }
 
-/* ============================================================================
- * SPEAKER DEVICE CALLBACKS
- * ============================================================================ */
+    /* Auto-detect mode - trigger AC learning */
+    ESP_LOGI(TAG, "Starting AC protocol auto-detection...");
+    rgb_led_set_mode(LED_MODE_IR_LEARNING);
 
-static esp_err_t speaker_write_cb(const esp_rmaker_device_t *device,
-                                    const esp_rmaker_param_t *param,
-                                    const esp_rmaker_param_val_t val,
-                                    void *priv_data,
-                                    esp_rmaker_write_ctx_t *ctx)
-{
-    const char *param_name = esp_rmaker_param_get_name(param);
-    ESP_LOGI(TAG, "Speaker parameter update: %s", param_name);
+    esp_err_t err = ir_ac_unit_learn_protocol(unit, IR_LEARNING_TIMEOUT_MS);
 
-    /* TRIGGER BUTTONS - Execute IR action immediately when pressed */
-    if (strcmp(param_name, "Power") == 0) {
-        ESP_LOGI(TAG, "Soundbar Power button pressed");
-        return ir_action_execute(IR_DEVICE_SPEAKER, IR_ACTION_POWER);
-    }
-    else if (strcmp(param_name, "Vol_Up") == 0) {
-        ESP_LOGI(TAG, "Soundbar Volume Up button pressed");
-        return ir_action_execute(IR_DEVICE_SPEAKER, IR_ACTION_VOL_UP);
-    }
-    else if (strcmp(param_name, "Vol_Down") == 0) {
-        ESP_LOGI(TAG, "Soundbar Volume Down button pressed");
-        return ir_action_execute(IR_DEVICE_SPEAKER, IR_ACTION_VOL_DOWN);
-    }
-    else if (strcmp(param_name, "Mute") == 0) {
-        ESP_LOGI(TAG, "Soundbar Mute button pressed");
-        return ir_action_execute(IR_DEVICE_SPEAKER, IR_ACTION_MUTE);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "AC protocol learned successfully!");
+        ir_scene_refresh();
+        rgb_led_set_mode(LED_MODE_IR_LEARNING_SUCCESS);
+        vTaskDelay(pdMS_TO_TICKS(1500));
+    } else {
+        ESP_LOGE(TAG, "AC protocol learning failed: %s", esp_err_to_name(err));
+        rgb_led_set_mode(LED_MODE_IR_LEARNING_FAILED);
+        vTaskDelay(pdMS_TO_TICKS(1500));
     }
-    /* Learn Mode - Dropdown selection */
-    else if (strcmp(param_name, "Learn_Mode") == 0) {
-        const char *action_name = val.val.s;
-        ESP_LOGI(TAG, "Soundbar Learn Mode: %s", action_name);
-
-        /* Map dropdown selection to ir_action_t */
-        ir_action_t action = IR_ACTION_NONE;
-        if (strcmp(action_name, "Power") == 0) action = IR_ACTION_POWER;
-        else if (strcmp(action_name, "VolumeUp") == 0) action = IR_ACTION_VOL_UP;
-        else if (strcmp(action_name, "VolumeDown") == 0) action = IR_ACTION_VOL_DOWN;
-        else if (strcmp(action_name, "Mute") == 0) action = IR_ACTION_MUTE;
-        else {
-            ESP_LOGW(TAG, "Unknown action: %s", action_name);
-            return ESP_ERR_INVALID_ARG;
-        }
-
-        /* Start learning */
-        learning_state.device = IR_DEVICE_SPEAKER;
-        learning_state.action = action;
-        learning_state.is_active = true;
 
-        rgb_led_set_mode(LED_MODE_IR_LEARNING);
-        return ir_action_learn(IR_DEVICE_SPEAKER, action, IR_LEARNING_TIMEOUT_MS);
+    /* Return to connected state */
+    if (app_wifi_is_connected()) {
+        rgb_led_set_mode(LED_MODE_WIFI_CONNECTED);
+    } else {
+        rgb_led_set_mode(LED_MODE_OFF);
     }
 
-    return ESP_OK;
+    return err;
 }
 
-/* ============================================================================
- * FAN DEVICE CALLBACKS
- * ============================================================================ */
-
-static esp_err_t fan_write_cb(const esp_rmaker_device_t *device,
-                                const esp_rmaker_param_t *param,
-                                const esp_rmaker_param_val_t val,
-                                void *priv_data,
-                                esp_rmaker_write_ctx_t *ctx)
+/**
+ * @brief Apply a write to an AC parameter
+ */
+static esp_err_t ac_param_write(ir_ac_handle_t unit, const param_binding_t *binding,
+                                const esp_rmaker_param_val_t val)
 {
-    const char *param_name = esp_rmaker_param_get_name(param);
-    ESP_LOGI(TAG, "Fan parameter update: %s", param_name);
-
-    if (strcmp(param_name, ESP_RMAKER_DEF_POWER_NAME) == 0) {
-        return ir_action_execute(IR_DEVICE_FAN, IR_ACTION_POWER);
-    } else if (strcmp(param_name, ESP_RMAKER_DEF_SPEED_NAME) == 0) {
-        int speed = val.val.i;
-        ESP_LOGI(TAG, "Fan Speed: %d", speed);
-
-        /* Map speed to discrete actions */
-        ir_action_t action = IR_ACTION_FAN_SPEED_1;
-        switch (speed) {
-            case 1: action = IR_ACTION_FAN_SPEED_1; break;
-            case 2: action = IR_ACTION_FAN_SPEED_2; break;
-            case 3: action = IR_ACTION_FAN_SPEED_3; break;
-            case 4: action = IR_ACTION_FAN_SPEED_4; break;
-            case 5: action = IR_ACTION_FAN_SPEED_5; break;
-            default: action = IR_ACTION_FAN_SPEED_3; break;
-        }
+    int value;
 
-        return ir_action_execute(IR_DEVICE_FAN, action);
-    } else if (strcmp(param_name, "Swing") == 0) {
-        return ir_action_execute(IR_DEVICE_FAN, IR_ACTION_FAN_SWING);
-    }
+    switch (binding->kind) {
+        case PARAM_KIND_AC_POWER:
+            ESP_LOGI(TAG, "AC Power: %s", val.val.b ? "ON" : "OFF");
+            return ir_ac_unit_set_power(unit, val.val.b);
 
-    return ESP_OK;
-}
+        case PARAM_KIND_AC_MODE:
+            ESP_LOGI(TAG, "AC Mode: %s", val.val.s);
+            if (!param_map_option(binding, val.val.s, &value)) {
+                value = AC_MODE_COOL;
+            }
+            return ir_ac_unit_set_mode(unit, (ac_mode_t)value);
 
-/* ============================================================================
- * STB DEVICE CALLBACKS
- * ============================================================================ */
+        case PARAM_KIND_AC_TEMPERATURE:
+            ESP_LOGI(TAG, "AC Temperature: %d°C", (uint8_t)val.val.f);
+            return ir_ac_unit_set_temperature(unit, (uint8_t)val.val.f);
 
-static esp_err_t stb_write_cb(const esp_rmaker_device_t *device,
-                                const esp_rmaker_param_t *param,
-                                const esp_rmaker_param_val_t val,
-                                void *priv_data,
-                                esp_rmaker_write_ctx_t *ctx)
-{
-    const char *param_name = esp_rmaker_param_get_name(param);
-    ESP_LOGI(TAG, "STB parameter update: %s", param_name);
+        case PARAM_KIND_AC_FAN_SPEED:
+            ESP_LOGI(TAG, "AC Fan Speed: %s", val.val.s);
+            if (!param_map_option(binding, val.val.s, &value)) {
+                value = AC_FAN_AUTO;
+            }
+            return ir_ac_unit_set_fan_speed(unit, (ac_fan_speed_t)value);
 
-    /* TRIGGER BUTTONS - Execute IR action immediately when pressed */
-    if (strcmp(param_name, "Power") == 0) {
-        ESP_LOGI(TAG, "STB Power button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_POWER);
-    }
-    else if (strcmp(param_name, "Ch_Up") == 0) {
-        ESP_LOGI(TAG, "STB Channel Up button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_CH_UP);
-    }
-    else if (strcmp(param_name, "Ch_Down") == 0) {
-        ESP_LOGI(TAG, "STB Channel Down button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_CH_DOWN);
-    }
-    else if (strcmp(param_name, "Play_Pause") == 0) {
-        ESP_LOGI(TAG, "STB Play/Pause button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_STB_PLAY_PAUSE);
-    }
-    else if (strcmp(param_name, "Guide") == 0) {
-        ESP_LOGI(TAG, "STB Guide button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_STB_GUIDE);
-    }
-    else if (strcmp(param_name, "Menu") == 0) {
-        ESP_LOGI(TAG, "STB Menu button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_MENU);
-    }
-    else if (strcmp(param_name, "OK") == 0) {
-        ESP_LOGI(TAG, "STB OK button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_NAV_OK);
+        case PARAM_KIND_AC_SWING:
+            ESP_LOGI(TAG, "AC Swing: %s", val.val.b ? "ON" : "OFF");
+            return ir_ac_unit_set_swing(unit, val.val.b ? AC_SWING_VERTICAL : AC_SWING_OFF);
+
+        case PARAM_KIND_AC_PROTOCOL:
+            return ac_set_protocol(unit, binding, val.val.s);
+
+        default:
+            return ESP_OK;
     }
-    else if (strcmp(param_name, "Back") == 0) {
-        ESP_LOGI(TAG, "STB Back button pressed");
-        return ir_action_execute(IR_DEVICE_STB, IR_ACTION_BACK);
+}
+
+/**
+ * @brief Write callback shared by all devices
+ *
+ * Every writable parameter was bound to its (device, action) or AC setting
+ * when it was created, so a write is one hash lookup on the parameter
+ * handle. Unbound parameters (Name) are accepted without action.
+ */
+static esp_err_t device_write_cb(const esp_rmaker_device_t *device,
+                                 const esp_rmaker_param_t *param,
+                                 const esp_rmaker_param_val_t val,
+                                 void *priv_data,
+                                 esp_rmaker_write_ctx_t *ctx)
+{
+    const param_binding_t *binding = param_map_find(param);
+    if (binding == NULL) {
+        return ESP_OK;
     }
-    /* Learn Mode - Dropdown selection */
-    else if (strcmp(param_name, "Learn_Mode") == 0) {
-        const char *action_name = val.val.s;
-        ESP_LOGI(TAG, "STB Learn Mode: %s", action_name);
-
-        /* Map dropdown selection to ir_action_t */
-        ir_action_t action = IR_ACTION_NONE;
-        if (strcmp(action_name, "Power") == 0) action = IR_ACTION_POWER;
-        else if (strcmp(action_name, "ChannelUp") == 0) action = IR_ACTION_CH_UP;
-        else if (strcmp(action_name, "ChannelDown") == 0) action = IR_ACTION_CH_DOWN;
-        else if (strcmp(action_name, "PlayPause") == 0) action = IR_ACTION_STB_PLAY_PAUSE;
-        else if (strcmp(action_name, "Guide") == 0) action = IR_ACTION_STB_GUIDE;
-        else if (strcmp(action_name, "Menu") == 0) action = IR_ACTION_MENU;
-        else if (strcmp(action_name, "OK") == 0) action = IR_ACTION_NAV_OK;
-        else if (strcmp(action_name, "Back") == 0) action = IR_ACTION_BACK;
-        else {
-            ESP_LOGW(TAG, "Unknown action: %s", action_name);
-            return ESP_ERR_INVALID_ARG;
-        }
 
-        /* Start learning */
-        learning_state.device = IR_DEVICE_STB;
-        learning_state.action = action;
-        learning_state.is_active = true;
+    ESP_LOGI(TAG, "%s parameter update: %s", ir_action_get_device_name(binding->device),
+             esp_rmaker_param_get_name(param));
 
-        rgb_led_set_mode(LED_MODE_IR_LEARNING);
-        return ir_action_learn(IR_DEVICE_STB, action, IR_LEARNING_TIMEOUT_MS);
-    }
+    switch (binding->kind) {
+        case PARAM_KIND_TRIGGER:
+            return ir_action_execute(binding->device, binding->action);
 
-    return ESP_OK;
+        case PARAM_KIND_LEARN:
+            return start_learning(binding, val.val.s);
+
+        case PARAM_KIND_FAN_SPEED: {
+            ESP_LOGI(TAG, "Fan Speed: %d", val.val.i);
+
+            /* Map speed to discrete actions */
+            ir_action_t action = IR_ACTION_FAN_SPEED_3;
+            if (val.val.i >= 1 && val.val.i <= 5) {
+                action = IR_ACTION_FAN_SPEED_1 + (val.val.i - 1);
+            }
+            return ir_action_execute(IR_DEVICE_FAN, action);
+        }
+
+        default:
+            /* The unit handle is the AC device's priv_data */
+            return ac_param_write((ir_ac_handle_t)priv_data, binding, val);
+    }
 }
 
 /* ============================================================================
- * CUSTOM DEVICE CALLBACKS
+ * AC REMOTE SYNC
  * ============================================================================ */
 
-static esp_err_t custom_write_cb(const esp_rmaker_device_t *device,
-                                   const esp_rmaker_param_t *param,
-                                   const esp_rmaker_param_val_t val,
-                                   void *priv_data,
-                                   esp_rmaker_write_ctx_t *ctx)
+/**
+ * @brief Callback when the physical AC remote changed the AC state
+ *
+ * Publishes only the params that changed, all in one report: every value
+ * but the last is updated silently and the last update reports them
+ * together.
+ */
+static void ac_sync_callback(ir_ac_handle_t unit, const ac_state_t *state,
+                             const ac_state_t *previous, void *arg)
 {
-    const char *param_name = esp_rmaker_param_get_name(param);
-    ESP_LOGI(TAG, "Custom device parameter update: %s", param_name);
-
-    /* TRIGGER BUTTONS - Execute IR action immediately when pressed */
-    if (strcmp(param_name, "Power") == 0) {
-        ESP_LOGI(TAG, "Custom Power button pressed");
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_POWER);
-    }
-    /* Button 1-12 */
-    else if (strcmp(param_name, "Button_1") == 0) {
-        ESP_LOGI(TAG, "Custom Button 1 pressed");
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_1);
-    }
-    else if (strcmp(param_name, "Button_2") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_2);
-    }
-    else if (strcmp(param_name, "Button_3") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_3);
-    }
-    else if (strcmp(param_name, "Button_4") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_4);
-    }
-    else if (strcmp(param_name, "Button_5") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_5);
+    esp_rmaker_device_t *ac_device = ac_devices[ir_ac_unit_get_index(unit)];
+    if (!devices_created || !ac_device) {
+        return;
     }
-    else if (strcmp(param_name, "Button_6") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_6);
+
+    esp_rmaker_param_t *params[5];
+    esp_rmaker_param_val_t vals[5];
+    int count = 0;
+
+    if (state->power != previous->power) {
+        params[count] = esp_rmaker_device_get_param_by_name(ac_device, ESP_RMAKER_DEF_POWER_NAME);
+        vals[count++] = esp_rmaker_bool(state->power);
     }
-    else if (strcmp(param_name, "Button_7") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_7);
+    if (state->mode != previous->mode) {
+        params[count] = esp_rmaker_device_get_param_by_name(ac_device, "Mode");
+        vals[count++] = esp_rmaker_str(ir_ac_get_mode_name(state->mode));
     }
-    else if (strcmp(param_name, "Button_8") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_8);
+    if (state->temperature != previous->temperature) {
+        params[count] = esp_rmaker_device_get_param_by_name(ac_device, ESP_RMAKER_DEF_TEMPERATURE_NAME);
+        vals[count++] = esp_rmaker_float(state->temperature);
     }
-    else if (strcmp(param_name, "Button_9") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_9);
+    if (state->fan_speed != previous->fan_speed && state->fan_speed <= AC_FAN_HIGH) {
+        params[count] = esp_rmaker_device_get_param_by_name(ac_device, "Fan_Speed");
+        vals[count++] = esp_rmaker_str(ir_ac_get_fan_speed_name(state->fan_speed));
     }
-    else if (strcmp(param_name, "Button_10") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_10);
+    if ((state->swing != AC_SWING_OFF) != (previous->swing != AC_SWING_OFF)) {
+        params[count] = esp_rmaker_device_get_param_by_name(ac_device, "Swing");
+        vals[count++] = esp_rmaker_bool(state->swing != AC_SWING_OFF);
     }
-    else if (strcmp(param_name, "Button_11") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_11);
+
+    /* Drop params the device does not have */
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (params[i]) {
+            params[n] = params[i];
+            vals[n++] = vals[i];
+        }
     }
-    else if (strcmp(param_name, "Button_12") == 0) {
-        return ir_action_execute(IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_12);
+    if (n == 0) {
+        return;
     }
-    /* Learn Mode */
-    else if (strcmp(param_name, "Learn_Mode") == 0) {
-        const char *action_name = val.val.s;
-        ESP_LOGI(TAG, "Custom Learn Mode: %s", action_name);
-
-        /* Map action name to ir_action_t */
-        ir_action_t action = IR_ACTION_NONE;
-        if (strcmp(action_name, "Power") == 0) action = IR_ACTION_POWER;
-        else if (strcmp(action_name, "Button1") == 0) action = IR_ACTION_CUSTOM_1;
-        else if (strcmp(action_name, "Button2") == 0) action = IR_ACTION_CUSTOM_2;
-        else if (strcmp(action_name, "Button3") == 0) action = IR_ACTION_CUSTOM_3;
-        else if (strcmp(action_name, "Button4") == 0) action = IR_ACTION_CUSTOM_4;
-        else if (strcmp(action_name, "Button5") == 0) action = IR_ACTION_CUSTOM_5;
-        else if (strcmp(action_name, "Button6") == 0) action = IR_ACTION_CUSTOM_6;
-        else if (strcmp(action_name, "Button7") == 0) action = IR_ACTION_CUSTOM_7;
-        else if (strcmp(action_name, "Button8") == 0) action = IR_ACTION_CUSTOM_8;
-        else if (strcmp(action_name, "Button9") == 0) action = IR_ACTION_CUSTOM_9;
-        else if (strcmp(action_name, "Button10") == 0) action = IR_ACTION_CUSTOM_10;
-        else if (strcmp(action_name, "Button11") == 0) action = IR_ACTION_CUSTOM_11;
-        else if (strcmp(action_name, "Button12") == 0) action = IR_ACTION_CUSTOM_12;
-        else {
-            ESP_LOGW(TAG, "Unknown action: %s", action_name);
-            return ESP_ERR_INVALID_ARG;
-        }
-
-        /* Start learning */
-        learning_state.device = IR_DEVICE_CUSTOM;
-        learning_state.action = action;
-        learning_state.is_active = true;
 
-        rgb_led_set_mode(LED_MODE_IR_LEARNING);
-        return ir_action_learn(IR_DEVICE_CUSTOM, action, IR_LEARNING_TIMEOUT_MS);
+    for (int i = 0; i < n - 1; i++) {
+        esp_rmaker_param_update(params[i], vals[i]);
     }
+    esp_rmaker_param_update_and_report(params[n - 1], vals[n - 1]);
 
-    return ESP_OK;
+    ESP_LOGI(TAG, "AC remote sync: reported %d changed param(s)", n);
 }
 
 /* ============================================================================
@@ -646,89 +496,62 @@ static esp_err_t create_tv_device(esp_rmaker_node_t *node)
         return ESP_FAIL;
     }
 
-    esp_rmaker_device_add_cb(tv_device, tv_write_cb, NULL);
+    esp_rmaker_device_add_cb(tv_device, device_write_cb, NULL);
     esp_rmaker_device_add_param(tv_device, esp_rmaker_name_param_create("Name", "TV Remote"));
 
     /* Remote control buttons - all as TRIGGERS (momentary push buttons) */
-    esp_rmaker_param_t *power_btn = esp_rmaker_param_create("Power", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(power_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, power_btn);
-
-    esp_rmaker_param_t *vol_up_btn = esp_rmaker_param_create("Vol_Up", "esp.param.toggle",
-                                                               esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(vol_up_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, vol_up_btn);
-
-    esp_rmaker_param_t *vol_down_btn = esp_rmaker_param_create("Vol_Down", "esp.param.toggle",
-                                                                 esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(vol_down_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, vol_down_btn);
-
-    esp_rmaker_param_t *mute_btn = esp_rmaker_param_create("Mute", "esp.param.toggle",
-                                                             esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(mute_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, mute_btn);
-
-    esp_rmaker_param_t *ch_up_btn = esp_rmaker_param_create("Ch_Up", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(ch_up_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, ch_up_btn);
-
-    esp_rmaker_param_t *ch_down_btn = esp_rmaker_param_create("Ch_Down", "esp.param.toggle",
-                                                                esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(ch_down_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, ch_down_btn);
-
-    esp_rmaker_param_t *input_btn = esp_rmaker_param_create("Input", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(input_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, input_btn);
-
-    esp_rmaker_param_t *menu_btn = esp_rmaker_param_create("Menu", "esp.param.toggle",
-                                                             esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(menu_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, menu_btn);
-
-    esp_rmaker_param_t *ok_btn = esp_rmaker_param_create("OK", "esp.param.toggle",
-                                                           esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(ok_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, ok_btn);
-
-    esp_rmaker_param_t *back_btn = esp_rmaker_param_create("Back", "esp.param.toggle",
-                                                             esp_rmaker_bool(false), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(back_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(tv_device, back_btn);
+    add_trigger_param(tv_device, "Power", PROP_FLAG_READ | PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_POWER);
+    add_trigger_param(tv_device, "Vol_Up", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_VOL_UP);
+    add_trigger_param(tv_device, "Vol_Down", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_VOL_DOWN);
+    add_trigger_param(tv_device, "Mute", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_MUTE);
+    add_trigger_param(tv_device, "Ch_Up", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_CH_UP);
+    add_trigger_param(tv_device, "Ch_Down", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_CH_DOWN);
+    add_trigger_param(tv_device, "Input", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_TV_INPUT);
+    add_trigger_param(tv_device, "Menu", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_MENU);
+    add_trigger_param(tv_device, "OK", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_NAV_OK);
+    add_trigger_param(tv_device, "Back", PROP_FLAG_WRITE, IR_DEVICE_TV, IR_ACTION_BACK);
 
     /* Learning mode dropdown */
-    esp_rmaker_param_t *learn_mode = esp_rmaker_param_create("Learn_Mode", "esp.param.string",
-                                                               esp_rmaker_str("None"), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(learn_mode, ESP_RMAKER_UI_DROPDOWN);
     static const char *learn_options[] = {"None", "Power", "VolumeUp", "VolumeDown", "Mute",
                                            "ChannelUp", "ChannelDown", "Input", "Menu", "OK", "Back"};
-    esp_rmaker_param_add_valid_str_list(learn_mode, learn_options, 11);
-    esp_rmaker_device_add_param(tv_device, learn_mode);
+    add_learn_param(tv_device, IR_DEVICE_TV, learn_options, 11,
+                    tv_learn_actions, sizeof(tv_learn_actions) / sizeof(tv_learn_actions[0]));
 
     esp_rmaker_node_add_device(node, tv_device);
     ESP_LOGI(TAG, "TV Remote device created with push button controls");
     return ESP_OK;
 }
 
-static esp_err_t create_ac_device(esp_rmaker_node_t *node)
+static esp_err_t create_ac_device(esp_rmaker_node_t *node, ir_ac_handle_t unit)
 {
-    ac_device = esp_rmaker_ac_device_create("AC", NULL, false);
+    uint8_t index = ir_ac_unit_get_index(unit);
+    char name[8] = "AC";
+    if (index > 0) {
+        snprintf(name, sizeof(name), "AC %u", index + 1);
+    }
+
+    /* The unit handle comes back as priv_data in device_write_cb */
+    esp_rmaker_device_t *ac_device = esp_rmaker_ac_device_create(name, unit, false);
     if (!ac_device) {
         ESP_LOGE(TAG, "Failed to create AC device");
         return ESP_FAIL;
     }
+    ac_devices[index] = ac_device;
 
-    esp_rmaker_device_add_cb(ac_device, ac_write_cb, NULL);
+    esp_rmaker_device_add_cb(ac_device, device_write_cb, NULL);
 
     /* Get current AC state */
-    const ac_state_t *state = ir_ac_state_get();
+    ac_state_t state;
+    ir_ac_unit_copy_state(unit, &state);
 
     /* Add AC-specific parameters */
-    esp_rmaker_device_add_param(ac_device, esp_rmaker_name_param_create("Name", "AC"));
+    esp_rmaker_device_add_param(ac_device, esp_rmaker_name_param_create("Name", name));
+
+    /* Power parameter (only on a primary AC device) */
+    esp_rmaker_param_t *power = esp_rmaker_device_get_param_by_name(ac_device, ESP_RMAKER_DEF_POWER_NAME);
+    if (power) {
+        param_map_bind(power, &(param_binding_t) { .kind = PARAM_KIND_AC_POWER, .device = IR_DEVICE_AC });
+    }
 
     /* Mode parameter */
     esp_rmaker_param_t *mode = esp_rmaker_param_create("Mode", "esp.param.mode",
@@ -737,13 +560,17 @@ static esp_err_t create_ac_device(esp_rmaker_node_t *node)
     static const char *mode_options[] = {"Off", "Cool", "Heat", "Dry", "Fan", "Auto"};
     esp_rmaker_param_add_valid_str_list(mode, mode_options, 6);
     esp_rmaker_device_add_param(ac_device, mode);
+    param_map_bind(mode, &(param_binding_t) {
+        .kind = PARAM_KIND_AC_MODE, .device = IR_DEVICE_AC, OPTIONS(ac_mode_values),
+    });
 
     /* Temperature parameter */
     esp_rmaker_param_t *temp = esp_rmaker_temperature_param_create("Temperature",
-                                                                     state->temperature);
+                                                                     state.temperature);
     esp_rmaker_param_add_bounds(temp, esp_rmaker_float(AC_TEMP_MIN),
                                  esp_rmaker_float(AC_TEMP_MAX), esp_rmaker_float(1));
     esp_rmaker_device_add_param(ac_device, temp);
+    param_map_bind(temp, &(param_binding_t) { .kind = PARAM_KIND_AC_TEMPERATURE, .device = IR_DEVICE_AC });
 
     /* Fan Speed parameter */
     esp_rmaker_param_t *fan_speed = esp_rmaker_param_create("Fan_Speed", "esp.param.mode",
@@ -752,11 +579,15 @@ static esp_err_t create_ac_device(esp_rmaker_node_t *node)
     static const char *fan_speed_options[] = {"Auto", "Low", "Medium", "High"};
     esp_rmaker_param_add_valid_str_list(fan_speed, fan_speed_options, 4);
     esp_rmaker_device_add_param(ac_device, fan_speed);
+    param_map_bind(fan_speed, &(param_binding_t) {
+        .kind = PARAM_KIND_AC_FAN_SPEED, .device = IR_DEVICE_AC, OPTIONS(ac_fan_speed_values),
+    });
 
     /* Swing parameter */
     esp_rmaker_param_t *swing = esp_rmaker_param_create("Swing", "esp.param.toggle",
                                                           esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
     esp_rmaker_device_add_param(ac_device, swing);
+    param_map_bind(swing, &(param_binding_t) { .kind = PARAM_KIND_AC_SWING, .device = IR_DEVICE_AC });
 
     /* Protocol selection parameter */
     esp_rmaker_param_t *learn_protocol = esp_rmaker_param_create("Learn_Protocol", "esp.param.string",
@@ -765,10 +596,13 @@ static esp_err_t create_ac_device(esp_rmaker_node_t *node)
     static const char *protocol_options[] = {"Daikin", "Mitsubishi", "LG", "Samsung", "Panasonic", "Hitachi"};
     esp_rmaker_param_add_valid_str_list(learn_protocol, protocol_options, 6);
     esp_rmaker_device_add_param(ac_device, learn_protocol);
+    param_map_bind(learn_protocol, &(param_binding_t) {
+        .kind = PARAM_KIND_AC_PROTOCOL, .device = IR_DEVICE_AC, OPTIONS(ac_protocol_values),
+    });
 
     esp_rmaker_node_add_device(node, ac_device);
-    ESP_LOGI(TAG, "AC device created (Protocol: %s)",
-             state->is_learned ? ir_get_protocol_name(state->protocol) : "Not configured");
+    ESP_LOGI(TAG, "%s device created (Protocol: %s)", name,
+             state.is_learned ? ir_get_protocol_name(state.protocol) : "Not configured");
     return ESP_OK;
 }
 
@@ -781,37 +615,20 @@ static esp_err_t create_speaker_device(esp_rmaker_node_t *node)
         return ESP_FAIL;
     }
 
-    esp_rmaker_device_add_cb(speaker_device, speaker_write_cb, NULL);
+    esp_rmaker_device_add_cb(speaker_device, device_write_cb, NULL);
     esp_rmaker_device_add_param(speaker_device, esp_rmaker_name_param_create("Name", "Soundbar Remote"));
 
     /* Remote control buttons - all as TRIGGERS (momentary push buttons) */
-    esp_rmaker_param_t *power_btn = esp_rmaker_param_create("Power", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(power_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(speaker_device, power_btn);
-
-    esp_rmaker_param_t *vol_up_btn = esp_rmaker_param_create("Vol_Up", "esp.param.toggle",
-                                                               esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(vol_up_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(speaker_device, vol_up_btn);
-
-    esp_rmaker_param_t *vol_down_btn = esp_rmaker_param_create("Vol_Down", "esp.param.toggle",
-                                                                 esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(vol_down_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(speaker_device, vol_down_btn);
-
-    esp_rmaker_param_t *mute_btn = esp_rmaker_param_create("Mute", "esp.param.toggle",
-                                                             esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(mute_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(speaker_device, mute_btn);
+    const uint8_t flags = PROP_FLAG_READ | PROP_FLAG_WRITE;
+    add_trigger_param(speaker_device, "Power", flags, IR_DEVICE_SPEAKER, IR_ACTION_POWER);
+    add_trigger_param(speaker_device, "Vol_Up", flags, IR_DEVICE_SPEAKER, IR_ACTION_VOL_UP);
+    add_trigger_param(speaker_device, "Vol_Down", flags, IR_DEVICE_SPEAKER, IR_ACTION_VOL_DOWN);
+    add_trigger_param(speaker_device, "Mute", flags, IR_DEVICE_SPEAKER, IR_ACTION_MUTE);
 
     /* Learning mode dropdown */
-    esp_rmaker_param_t *learn_mode = esp_rmaker_param_create("Learn_Mode", "esp.param.string",
-                                                               esp_rmaker_str("None"), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(learn_mode, ESP_RMAKER_UI_DROPDOWN);
     static const char *soundbar_learn_options[] = {"None", "Power", "VolumeUp", "VolumeDown", "Mute"};
-    esp_rmaker_param_add_valid_str_list(learn_mode, soundbar_learn_options, 5);
-    esp_rmaker_device_add_param(speaker_device, learn_mode);
+    add_learn_param(speaker_device, IR_DEVICE_SPEAKER, soundbar_learn_options, 5,
+                    speaker_learn_actions, sizeof(speaker_learn_actions) / sizeof(speaker_learn_actions[0]));
 
     esp_rmaker_node_add_device(node, speaker_device);
     ESP_LOGI(TAG, "Soundbar Remote device created");
@@ -826,19 +643,29 @@ static esp_err_t create_fan_device(esp_rmaker_node_t *node)
         return ESP_FAIL;
     }
 
-    esp_rmaker_device_add_cb(fan_device, fan_write_cb, NULL);
+    esp_rmaker_device_add_cb(fan_device, device_write_cb, NULL);
 
-    /* Note: Name parameter is automatically added by esp_rmaker_fan_device_create() */
+    /* Note: Name and Power parameters are automatically added by esp_rmaker_fan_device_create() */
+    esp_rmaker_param_t *power = esp_rmaker_device_get_param_by_name(fan_device, ESP_RMAKER_DEF_POWER_NAME);
+    if (power) {
+        param_map_bind(power, &(param_binding_t) {
+            .kind = PARAM_KIND_TRIGGER, .device = IR_DEVICE_FAN, .action = IR_ACTION_POWER,
+        });
+    }
 
     /* Fan speed */
     esp_rmaker_param_t *speed = esp_rmaker_speed_param_create("Speed", 3);
     esp_rmaker_param_add_bounds(speed, esp_rmaker_int(1), esp_rmaker_int(5), esp_rmaker_int(1));
     esp_rmaker_device_add_param(fan_device, speed);
+    param_map_bind(speed, &(param_binding_t) { .kind = PARAM_KIND_FAN_SPEED, .device = IR_DEVICE_FAN });
 
     /* Swing */
     esp_rmaker_param_t *swing = esp_rmaker_param_create("Swing", "esp.param.toggle",
                                                           esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
     esp_rmaker_device_add_param(fan_device, swing);
+    param_map_bind(swing, &(param_binding_t) {
+        .kind = PARAM_KIND_TRIGGER, .device = IR_DEVICE_FAN, .action = IR_ACTION_FAN_SWING,
+    });
 
     esp_rmaker_node_add_device(node, fan_device);
     ESP_LOGI(TAG, "Fan device created");
@@ -854,81 +681,49 @@ static esp_err_t create_stb_device(esp_rmaker_node_t *node)
         return ESP_FAIL;
     }
 
-    esp_rmaker_device_add_cb(stb_device, stb_write_cb, NULL);
+    esp_rmaker_device_add_cb(stb_device, device_write_cb, NULL);
     esp_rmaker_device_add_param(stb_device, esp_rmaker_name_param_create("Name", "STB Remote"));
 
     /* Remote control buttons - all as TRIGGERS (momentary push buttons) */
-    esp_rmaker_param_t *power_btn = esp_rmaker_param_create("Power", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(power_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, power_btn);
-
-    esp_rmaker_param_t *ch_up_btn = esp_rmaker_param_create("Ch_Up", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(ch_up_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, ch_up_btn);
-
-    esp_rmaker_param_t *ch_down_btn = esp_rmaker_param_create("Ch_Down", "esp.param.toggle",
-                                                                esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(ch_down_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, ch_down_btn);
-
-    esp_rmaker_param_t *play_pause_btn = esp_rmaker_param_create("Play_Pause", "esp.param.toggle",
-                                                                   esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(play_pause_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, play_pause_btn);
-
-    esp_rmaker_param_t *guide_btn = esp_rmaker_param_create("Guide", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(guide_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, guide_btn);
-
-    esp_rmaker_param_t *menu_btn = esp_rmaker_param_create("Menu", "esp.param.toggle",
-                                                             esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(menu_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, menu_btn);
-
-    esp_rmaker_param_t *ok_btn = esp_rmaker_param_create("OK", "esp.param.toggle",
-                                                           esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(ok_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, ok_btn);
-
-    esp_rmaker_param_t *back_btn = esp_rmaker_param_create("Back", "esp.param.toggle",
-                                                             esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(back_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(stb_device, back_btn);
+    const uint8_t flags = PROP_FLAG_READ | PROP_FLAG_WRITE;
+    add_trigger_param(stb_device, "Power", flags, IR_DEVICE_STB, IR_ACTION_POWER);
+    add_trigger_param(stb_device, "Ch_Up", flags, IR_DEVICE_STB, IR_ACTION_CH_UP);
+    add_trigger_param(stb_device, "Ch_Down", flags, IR_DEVICE_STB, IR_ACTION_CH_DOWN);
+    add_trigger_param(stb_device, "Play_Pause", flags, IR_DEVICE_STB, IR_ACTION_STB_PLAY_PAUSE);
+    add_trigger_param(stb_device, "Guide", flags, IR_DEVICE_STB, IR_ACTION_STB_GUIDE);
+    add_trigger_param(stb_device, "Menu", flags, IR_DEVICE_STB, IR_ACTION_MENU);
+    add_trigger_param(stb_device, "OK", flags, IR_DEVICE_STB, IR_ACTION_NAV_OK);
+    add_trigger_param(stb_device, "Back", flags, IR_DEVICE_STB, IR_ACTION_BACK);
 
     /* Learning mode dropdown */
-    esp_rmaker_param_t *learn_mode = esp_rmaker_param_create("Learn_Mode", "esp.param.string",
-                                                               esp_rmaker_str("None"), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(learn_mode, ESP_RMAKER_UI_DROPDOWN);
     static const char *stb_learn_options[] = {"None", "Power", "ChannelUp", "ChannelDown",
                                                "PlayPause", "Guide", "Menu", "OK", "Back"};
-    esp_rmaker_param_add_valid_str_list(learn_mode, stb_learn_options, 9);
-    esp_rmaker_device_add_param(stb_device, learn_mode);
+    add_learn_param(stb_device, IR_DEVICE_STB, stb_learn_options, 9,
+                    stb_learn_actions, sizeof(stb_learn_actions) / sizeof(stb_learn_actions[0]));
 
     esp_rmaker_node_add_device(node, stb_device);
     ESP_LOGI(TAG, "STB Remote device created");
     return ESP_OK;
 }
 
-static esp_err_t create_custom_device(esp_rmaker_node_t *node)
+/**
+ * @brief Create one Custom Remote device (Power, Button_1-12, Learn_Mode)
+ */
+static esp_rmaker_device_t *create_custom_remote(esp_rmaker_node_t *node, const char *name)
 {
     /* Create as generic device for full control over UI */
-    custom_device = esp_rmaker_device_create("Custom Remote", ESP_RMAKER_DEVICE_OTHER, NULL);
-    if (!custom_device) {
-        ESP_LOGE(TAG, "Failed to create Custom device");
-        return ESP_FAIL;
+    esp_rmaker_device_t *device = esp_rmaker_device_create(name, ESP_RMAKER_DEVICE_OTHER, NULL);
+    if (!device) {
+        ESP_LOGE(TAG, "Failed to create %s device", name);
+        return NULL;
     }
 
-    esp_rmaker_device_add_cb(custom_device, custom_write_cb, NULL);
-    esp_rmaker_device_add_param(custom_device, esp_rmaker_name_param_create("Name", "Custom Remote"));
+    esp_rmaker_device_add_cb(device, device_write_cb, NULL);
+    esp_rmaker_device_add_param(device, esp_rmaker_name_param_create("Name", name));
 
     /* Power button as TRIGGER */
-    esp_rmaker_param_t *power_btn = esp_rmaker_param_create("Power", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(power_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(custom_device, power_btn);
+    const uint8_t flags = PROP_FLAG_READ | PROP_FLAG_WRITE;
+    add_trigger_param(device, "Power", flags, IR_DEVICE_CUSTOM, IR_ACTION_POWER);
 
     /* Button 1-12 as TRIGGERS (momentary push buttons) */
     static const char *button_names[] = {
@@ -937,117 +732,37 @@ static esp_err_t create_custom_device(esp_rmaker_node_t *node)
         "Button_9", "Button_10", "Button_11", "Button_12"
     };
     for (int i = 0; i < 12; i++) {
-        esp_rmaker_param_t *button = esp_rmaker_param_create(button_names[i], "esp.param.toggle",
-                                                               esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-        esp_rmaker_param_add_ui_type(button, ESP_RMAKER_UI_TRIGGER);
-        esp_rmaker_device_add_param(custom_device, button);
+        add_trigger_param(device, button_names[i], flags, IR_DEVICE_CUSTOM, IR_ACTION_CUSTOM_1 + i);
     }
 
     /* Learning mode parameter */
-    esp_rmaker_param_t *learn_mode = esp_rmaker_param_create("Learn_Mode", "esp.param.string",
-                                                               esp_rmaker_str("None"), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(learn_mode, ESP_RMAKER_UI_DROPDOWN);
     static const char *custom_learn_options[] = {"None", "Power", "Button1", "Button2", "Button3", "Button4",
                                                    "Button5", "Button6", "Button7", "Button8", "Button9",
                                                    "Button10", "Button11", "Button12"};
-    esp_rmaker_param_add_valid_str_list(learn_mode, custom_learn_options, 14);
-    esp_rmaker_device_add_param(custom_device, learn_mode);
+    add_learn_param(device, IR_DEVICE_CUSTOM, custom_learn_options, 14,
+                    custom_learn_actions, sizeof(custom_learn_actions) / sizeof(custom_learn_actions[0]));
 
-    esp_rmaker_node_add_device(node, custom_device);
-    ESP_LOGI(TAG, "Custom Remote device created");
-    return ESP_OK;
+    esp_rmaker_node_add_device(node, device);
+    ESP_LOGI(TAG, "%s device created", name);
+    return device;
 }
 
-static esp_err_t create_custom_device_2(esp_rmaker_node_t *node)
+static esp_err_t create_custom_device(esp_rmaker_node_t *node)
 {
-    /* Create as generic device for full control over UI */
-    custom_device_2 = esp_rmaker_device_create("Custom Remote 2", ESP_RMAKER_DEVICE_OTHER, NULL);
-    if (!custom_device_2) {
-        ESP_LOGE(TAG, "Failed to create Custom device 2");
-        return ESP_FAIL;
-    }
-
-    esp_rmaker_device_add_cb(custom_device_2, custom_write_cb, NULL);
-    esp_rmaker_device_add_param(custom_device_2, esp_rmaker_name_param_create("Name", "Custom Remote 2"));
-
-    /* Power button as TRIGGER */
-    esp_rmaker_param_t *power_btn = esp_rmaker_param_create("Power", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(power_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(custom_device_2, power_btn);
-
-    /* Button 1-12 as TRIGGERS (momentary push buttons) */
-    static const char *button_names_2[] = {
-        "Button_1", "Button_2", "Button_3", "Button_4",
-        "Button_5", "Button_6", "Button_7", "Button_8",
-        "Button_9", "Button_10", "Button_11", "Button_12"
-    };
-    for (int i = 0; i < 12; i++) {
-        esp_rmaker_param_t *button = esp_rmaker_param_create(button_names_2[i], "esp.param.toggle",
-                                                               esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-        esp_rmaker_param_add_ui_type(button, ESP_RMAKER_UI_TRIGGER);
-        esp_rmaker_device_add_param(custom_device_2, button);
-    }
+    custom_device = create_custom_remote(node, "Custom Remote");
+    return custom_device ? ESP_OK : ESP_FAIL;
+}
 
-    /* Learning mode parameter */
-    esp_rmaker_param_t *learn_mode = esp_rmaker_param_create("Learn_Mode", "esp.param.string",
-                                                               esp_rmaker_str("None"), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(learn_mode, ESP_RMAKER_UI_DROPDOWN);
-    static const char *custom2_learn_options[] = {"None", "Power", "Button1", "Button2", "Button3", "Button4",
-                                                    "Button5", "Button6", "Button7", "Button8", "Button9",
-                                                    "Button10", "Button11", "Button12"};
-    esp_rmaker_param_add_valid_str_list(learn_mode, custom2_learn_options, 14);
-    esp_rmaker_device_add_param(custom_device_2, learn_mode);
-
-    esp_rmaker_node_add_device(node, custom_device_2);
-    ESP_LOGI(TAG, "Custom Remote 2 device created");
-    return ESP_OK;
+static esp_err_t create_custom_device_2(esp_rmaker_node_t *node)
+{
+    custom_device_2 = create_custom_remote(node, "Custom Remote 2");
+    return custom_device_2 ? ESP_OK : ESP_FAIL;
 }
 
 static esp_err_t create_custom_device_3(esp_rmaker_node_t *node)
 {
-    /* Create as generic device for full control over UI */
-    custom_device_3 = esp_rmaker_device_create("Custom Remote 3", ESP_RMAKER_DEVICE_OTHER, NULL);
-    if (!custom_device_3) {
-        ESP_LOGE(TAG, "Failed to create Custom device 3");
-        return ESP_FAIL;
-    }
-
-    esp_rmaker_device_add_cb(custom_device_3, custom_write_cb, NULL);
-    esp_rmaker_device_add_param(custom_device_3, esp_rmaker_name_param_create("Name", "Custom Remote 3"));
-
-    /* Power button as TRIGGER */
-    esp_rmaker_param_t *power_btn = esp_rmaker_param_create("Power", "esp.param.toggle",
-                                                              esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(power_btn, ESP_RMAKER_UI_TRIGGER);
-    esp_rmaker_device_add_param(custom_device_3, power_btn);
-
-    /* Button 1-12 as TRIGGERS (momentary push buttons) */
-    static const char *button_names_3[] = {
-        "Button_1", "Button_2", "Button_3", "Button_4",
-        "Button_5", "Button_6", "Button_7", "Button_8",
-        "Button_9", "Button_10", "Button_11", "Button_12"
-    };
-    for (int i = 0; i < 12; i++) {
-        esp_rmaker_param_t *button = esp_rmaker_param_create(button_names_3[i], "esp.param.toggle",
-                                                               esp_rmaker_bool(false), PROP_FLAG_READ | PROP_FLAG_WRITE);
-        esp_rmaker_param_add_ui_type(button, ESP_RMAKER_UI_TRIGGER);
-        esp_rmaker_device_add_param(custom_device_3, button);
-    }
-
-    /* Learning mode parameter */
-    esp_rmaker_param_t *learn_mode = esp_rmaker_param_create("Learn_Mode", "esp.param.string",
-                                                               esp_rmaker_str("None"), PROP_FLAG_WRITE);
-    esp_rmaker_param_add_ui_type(learn_mode, ESP_RMAKER_UI_DROPDOWN);
-    static const char *custom3_learn_options[] = {"None", "Power", "Button1", "Button2", "Button3", "Button4",
-                                                    "Button5", "Button6", "Button7", "Button8", "Button9",
-                                                    "Button10", "Button11", "Button12"};
-    esp_rmaker_param_add_valid_str_list(learn_mode, custom3_learn_options, 14);
-    esp_rmaker_device_add_param(custom_device_3, learn_mode);
-
-    esp_rmaker_node_add_device(node, custom_device_3);
-    ESP_LOGI(TAG, "Custom Remote 3 device created");
-    return ESP_OK;
+    custom_device_3 = create_custom_remote(node, "Custom Remote 3");
+    return custom_device_3 ? ESP_OK : ESP_FAIL;
 }
 
 /* ============================================================================
@@ -1088,7 +803,7 @@ static void reset_handler_task(void *arg)
 }
 
 /* ============================================================================
- * BOOT BUTTON HANDLER (WiFi Reset / Factory Reset)
+ * BOOT BUTTON HANDLER (Scan Confirm / WiFi Reset / Factory Reset)
  * ============================================================================ */
 
 static void boot_button_timer_cb(TimerHandle_t timer)
@@ -1103,7 +818,9 @@ static void boot_button_timer_cb(TimerHandle_t timer)
 
             /* Clear all IR codes */
             ir_action_clear_all();
-            ir_ac_clear_state();
+            for (uint8_t i = 0; i < ir_ac_get_num_units(); i++) {
+                ir_ac_unit_clear_state(ir_ac_get_unit(i));
+            }
 
             /* Reset WiFi and restart */
             esp_rmaker_factory_reset(0, 2);
@@ -1119,6 +836,11 @@ static void boot_button_timer_cb(TimerHandle_t timer)
             }
         }
 
+        /* Short press while a code scan runs: the device just reacted */
+        if (press_duration < BUTTON_WIFI_RESET_MS && ir_scan_confirm() == ESP_OK) {
+            ESP_LOGI(TAG, "Code scan confirmed by button");
+        }
+
         xTimerStop(timer, 0);
         factory_reset_triggered = false;
     }
@@ -1201,13 +923,48 @@ void app_main(void)
     ESP_LOGI(TAG, "Initializing IR control...");
     ESP_ERROR_CHECK(ir_control_init());
 
+    /* Extra IR emitters, each on its own RMT channel */
+    const int extra_tx_gpios[] = { GPIO_IR_TX_2, GPIO_IR_TX_3, GPIO_IR_TX_4 };
+    for (size_t i = 0; i < sizeof(extra_tx_gpios) / sizeof(extra_tx_gpios[0]); i++) {
+        if (extra_tx_gpios[i] < 0) {
+            continue;
+        }
+        ir_tx_emitter_config_t emitter_config = {
+            .gpio_num = extra_tx_gpios[i],
+        };
+        esp_err_t err = ir_tx_add_emitter(&emitter_config, NULL);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "IR emitter on GPIO%d unavailable: %s", extra_tx_gpios[i], esp_err_to_name(err));
+        }
+    }
+
     /* Initialize action mapping system */
     ESP_LOGI(TAG, "Initializing action mapping system...");
     ESP_ERROR_CHECK(ir_action_init());
 
+    /* Code library is optional: 4MB partition tables have no storage partition */
+    esp_err_t lib_err = ir_library_init();
+    if (lib_err != ESP_OK && lib_err != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "IR code library unavailable: %s", esp_err_to_name(lib_err));
+    }
+    if (lib_err == ESP_OK) {
+        ESP_ERROR_CHECK(ir_scan_init());
+    }
+
     /* Initialize AC state management */
     ESP_LOGI(TAG, "Initializing AC state management...");
-    ESP_ERROR_CHECK(ir_ac_state_init());
+    ESP_ERROR_CHECK(ir_ac_state_init_units(AC_NUM_UNITS));
+    const uint8_t ac_unit_emitters[IR_AC_MAX_UNITS] = AC_UNIT_EMITTERS;
+    for (uint8_t i = 0; i < ir_ac_get_num_units(); i++) {
+        if (ac_unit_emitters[i] < ir_tx_get_num_emitters()) {
+            ir_ac_unit_set_emitter(ir_ac_get_unit(i), ac_unit_emitters[i]);
+        }
+    }
+    ESP_ERROR_CHECK(ir_ac_register_sync_cb(ac_sync_callback, NULL));
+
+    /* Initialize scenes (compiled against the actions and AC units above) */
+    ESP_LOGI(TAG, "Initializing IR scenes...");
+    ESP_ERROR_CHECK(ir_scene_init());
 
     /* Register IR callbacks */
     ir_callbacks_t ir_callbacks = {
@@ -1247,7 +1004,9 @@ void app_main(void)
     /* Create ALL devices BEFORE starting RainMaker (OFFICIAL PATTERN) */
     ESP_LOGI(TAG, "Creating RainMaker devices...");
     ESP_ERROR_CHECK(create_tv_device(rainmaker_node));
-    ESP_ERROR_CHECK(create_ac_device(rainmaker_node));
+    for (uint8_t i = 0; i < ir_ac_get_num_units(); i++) {
+        ESP_ERROR_CHECK(create_ac_device(rainmaker_node, ir_ac_get_unit(i)));
+    }
     ESP_ERROR_CHECK(create_stb_device(rainmaker_node));
     ESP_ERROR_CHECK(create_speaker_device(rainmaker_node));
     ESP_ERROR_CHECK(create_fan_device(rainmaker_node));
@@ -1255,7 +1014,15 @@ void app_main(void)
     ESP_ERROR_CHECK(create_custom_device_2(rainmaker_node));
     ESP_ERROR_CHECK(create_custom_device_3(rainmaker_node));
     devices_created = true;
-    ESP_LOGI(TAG, "All RainMaker devices created (8 devices total)");
+    ESP_LOGI(TAG, "All RainMaker devices created (%d devices total)", 7 + ir_ac_get_num_units());
+
+    /* IR scenes service */
+    ESP_ERROR_CHECK(scene_service_create(rainmaker_node));
+
+    /* Code scan service (needs the code library) */
+    if (lib_err == ESP_OK) {
+        ESP_ERROR_CHECK(scan_service_create(rainmaker_node));
+    }
 
     /* Enable OTA */
     esp_rmaker_ota_enable_default();
@@ -0,0 +1,161 @@
+/**
+ * @file param_map.c
+ * @brief RainMaker parameter → IR action lookup implementation
+ *
+ * Two open-addressing tables with linear probing. Both are filled while
+ * the devices are created, before esp_rmaker_start(), and only read
+ * afterwards, so no locking is needed.
+ */
+
+#include "param_map.h"
+#include <stdint.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "param_map";
+
+typedef struct {
+    const esp_rmaker_param_t *param;    // NULL = free slot
+    param_binding_t binding;
+} param_slot_t;
+
+typedef struct {
+    const param_option_t *table;        // NULL = free slot
+    const param_option_t *option;
+    uint32_t hash;
+} option_slot_t;
+
+static param_slot_t param_slots[PARAM_MAP_SLOTS];
+static option_slot_t option_slots[PARAM_OPTION_SLOTS];
+static size_t num_params = 0;
+static size_t num_options = 0;
+
+static inline uint32_t fibonacci_index(uint32_t key, unsigned bits)
+{
+    // Fibonacci hashing: the multiply carries every key bit upward, so the
+    // slot comes from the top bits (the low ones of heap pointers are zero)
+    return (uint32_t)(key * 2654435769u) >> (32 - bits);
+}
+
+static inline uint32_t pointer_hash(const void *ptr)
+{
+    return fibonacci_index((uint32_t)(uintptr_t)ptr, PARAM_MAP_BITS);
+}
+
+static inline uint32_t option_index(const param_option_t *table, uint32_t hash)
+{
+    return fibonacci_index(hash ^ (uint32_t)(uintptr_t)table, PARAM_OPTION_BITS);
+}
+
+static uint32_t string_hash(const char *str)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static const option_slot_t *option_find(const param_option_t *table, const char *name, uint32_t hash)
+{
+    uint32_t mask = PARAM_OPTION_SLOTS - 1;
+    uint32_t i = option_index(table, hash);
+
+    for (size_t probe = 0; probe < PARAM_OPTION_SLOTS; probe++, i = (i + 1) & mask) {
+        const option_slot_t *slot = &option_slots[i];
+        if (slot->table == NULL) {
+            return NULL;
+        }
+        if (slot->table == table && slot->hash == hash && strcmp(slot->option->name, name) == 0) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t option_table_index(const param_option_t *table, size_t count)
+{
+    if (count == 0 || option_find(table, table[0].name, string_hash(table[0].name))) {
+        return ESP_OK;  // Nothing to index, or already indexed
+    }
+    if ((num_options + count) * 4 > PARAM_OPTION_SLOTS * 3) {
+        ESP_LOGE(TAG, "Option index full (%u slots)", PARAM_OPTION_SLOTS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t mask = PARAM_OPTION_SLOTS - 1;
+    for (size_t n = 0; n < count; n++) {
+        uint32_t hash = string_hash(table[n].name);
+        uint32_t i = option_index(table, hash);
+        while (option_slots[i].table != NULL) {
+            i = (i + 1) & mask;
+        }
+        option_slots[i] = (option_slot_t) { .table = table, .option = &table[n], .hash = hash };
+        num_options++;
+    }
+    return ESP_OK;
+}
+
+esp_err_t param_map_bind(const esp_rmaker_param_t *param, const param_binding_t *binding)
+{
+    if (param == NULL || binding == NULL || (binding->num_options > 0 && binding->options == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t mask = PARAM_MAP_SLOTS - 1;
+    uint32_t i = pointer_hash(param);
+    while (param_slots[i].param != NULL && param_slots[i].param != param) {
+        i = (i + 1) & mask;
+    }
+
+    if (param_slots[i].param == NULL && (num_params + 1) * 4 > PARAM_MAP_SLOTS * 3) {
+        ESP_LOGE(TAG, "Parameter map full (%u slots)", PARAM_MAP_SLOTS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = option_table_index(binding->options, binding->num_options);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (param_slots[i].param == NULL) {
+        num_params++;
+    }
+    param_slots[i].param = param;
+    param_slots[i].binding = *binding;
+    return ESP_OK;
+}
+
+const param_binding_t *param_map_find(const esp_rmaker_param_t *param)
+{
+    uint32_t mask = PARAM_MAP_SLOTS - 1;
+    uint32_t i = pointer_hash(param);
+
+    for (size_t probe = 0; probe < PARAM_MAP_SLOTS; probe++, i = (i + 1) & mask) {
+        if (param_slots[i].param == param) {
+            return &param_slots[i].binding;
+        }
+        if (param_slots[i].param == NULL) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+bool param_map_option(const param_binding_t *binding, const char *name, int *value)
+{
+    if (binding == NULL || binding->options == NULL || name == NULL) {
+        return false;
+    }
+
+    const option_slot_t *slot = option_find(binding->options, name, string_hash(name));
+    if (slot == NULL) {
+        return false;
+    }
+    if (value) {
+        *value = slot->option->value;
+    }
+    return true;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file param_map.h
+ * @brief RainMaker parameter → IR action lookup
+ *
+ * Every writable parameter is bound once, right after it is created in
+ * create_*_device(), to what a write should do. Write callbacks look the
+ * parameter up by its handle instead of comparing its name against every
+ * parameter the device has, and dropdown values are looked up in a hashed
+ * index instead of a strcmp chain. Both lookups are O(1).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_rmaker_core.h"
+#include "ir_action.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PARAM_MAP_BITS          8
+#define PARAM_MAP_SLOTS         (1u << PARAM_MAP_BITS)      // Bound parameters (at most 3/4 used)
+#define PARAM_OPTION_BITS       7
+#define PARAM_OPTION_SLOTS      (1u << PARAM_OPTION_BITS)   // Dropdown values across all option tables
+
+/**
+ * @brief What a write to a parameter does
+ */
+typedef enum {
+    PARAM_KIND_TRIGGER = 0,     // Push button: execute (device, action)
+    PARAM_KIND_LEARN,           // Learn dropdown: learn the selected action on device
+    PARAM_KIND_FAN_SPEED,       // Fan speed slider (1-5)
+    PARAM_KIND_AC_POWER,
+    PARAM_KIND_AC_MODE,
+    PARAM_KIND_AC_TEMPERATURE,
+    PARAM_KIND_AC_FAN_SPEED,
+    PARAM_KIND_AC_SWING,
+    PARAM_KIND_AC_PROTOCOL,
+} param_kind_t;
+
+/**
+ * @brief One dropdown value and what it maps to (action, mode, protocol...)
+ */
+typedef struct {
+    const char *name;
+    int value;
+} param_option_t;
+
+/**
+ * @brief Binding of one parameter
+ */
+typedef struct {
+    param_kind_t kind;
+    ir_device_type_t device;
+    ir_action_t action;                 // PARAM_KIND_TRIGGER only
+    const param_option_t *options;      // Dropdown values (NULL if none)
+    size_t num_options;
+} param_binding_t;
+
+/**
+ * @brief Bind a parameter
+ *
+ * The option table must be static; it is indexed the first time it is
+ * bound and shared by every parameter bound to it.
+ *
+ * @param param Parameter handle
+ * @param binding What writes to it do (copied)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM if a table is full
+ */
+esp_err_t param_map_bind(const esp_rmaker_param_t *param, const param_binding_t *binding);
+
+/**
+ * @brief Look up a parameter's binding
+ *
+ * @param param Parameter handle
+ * @return Binding, or NULL if the parameter was not bound
+ */
+const param_binding_t *param_map_find(const esp_rmaker_param_t *param);
+
+/**
+ * @brief Look up a dropdown value in a binding's option table
+ *
+ * @param binding Binding with options
+ * @param name Value written by the app
+ * @param value Output mapped value
+ * @return true if found
+ */
+bool param_map_option(const param_binding_t *binding, const char *name, int *value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file scan_service.c
+ * @brief RainMaker service for the library code scan
+ *
+ * Typical flow: write Start, press Found (or the boot button) when the
+ * device reacts, Try the suspects from Status one by one, then Use the
+ * code set that worked.
+ */
+
+#include "scan_service.h"
+#include <string.h>
+#include <strings.h>
+#include "cJSON.h"
+#include "esp_log.h"
+#include "esp_rmaker_standard_types.h"
+#include "ir_action.h"
+#include "ir_library.h"
+#include "ir_scan.h"
+
+static const char *TAG = "scan_service";
+
+static esp_rmaker_param_t *status_param = NULL;
+static esp_rmaker_param_t *start_param = NULL;
+static esp_rmaker_param_t *found_param = NULL;
+static esp_rmaker_param_t *stop_param = NULL;
+static esp_rmaker_param_t *try_param = NULL;
+static esp_rmaker_param_t *use_param = NULL;
+
+/* ============================================================================
+ * STATUS
+ * ============================================================================ */
+
+static const char *state_name(ir_scan_state_t state)
+{
+    switch (state) {
+        case IR_SCAN_RUNNING:   return "running";
+        case IR_SCAN_CONFIRMED: return "confirmed";
+        case IR_SCAN_EXHAUSTED: return "not found";
+        default:                return "idle";
+    }
+}
+
+/**
+ * @brief Publish scan progress (caller frees the result)
+ */
+static char *scan_status_json(void)
+{
+    ir_scan_status_t status;
+    ir_scan_get_status(&status);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "state", state_name(status.state));
+    cJSON_AddNumberToObject(root, "sent", status.sent);
+    cJSON_AddNumberToObject(root, "total", status.total);
+    cJSON *suspects = cJSON_AddArrayToObject(root, "suspects");
+    for (uint8_t i = 0; i < status.num_suspects; i++) {
+        cJSON_AddItemToArray(suspects, cJSON_CreateNumber(status.suspects[i]));
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return json;
+}
+
+static void report_status(void)
+{
+    char *json = scan_status_json();
+    if (json) {
+        esp_rmaker_param_update_and_report(status_param, esp_rmaker_str(json));
+        cJSON_free(json);
+    }
+}
+
+static void scan_done_cb(ir_scan_state_t state, void *arg)
+{
+    report_status();
+}
+
+/* ============================================================================
+ * COMMANDS
+ * ============================================================================ */
+
+static bool find_name(const cJSON *item, int count, const char *(*get_name)(int), int *value)
+{
+    if (!cJSON_IsString(item)) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcasecmp(item->valuestring, get_name(i)) == 0) {
+            *value = i;
+            return true;
+        }
+    }
+    ESP_LOGW(TAG, "Unknown name: %s", item->valuestring);
+    return false;
+}
+
+static const char *device_name(int i)
+{
+    return ir_action_get_device_name((ir_device_type_t)i);
+}
+
+static const char *action_name(int i)
+{
+    return ir_action_get_action_name((ir_action_t)i);
+}
+
+static esp_err_t start_scan(const char *json)
+{
+    cJSON *root = cJSON_Parse(json);
+    if (root == NULL) {
+        ESP_LOGW(TAG, "Scan request is not valid JSON");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int device = IR_DEVICE_NONE;
+    int action = IR_ACTION_POWER;
+    const cJSON *brand = cJSON_GetObjectItem(root, "brand");
+    const cJSON *item = cJSON_GetObjectItem(root, "action");
+    const cJSON *gap = cJSON_GetObjectItem(root, "gap");
+
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+    if (cJSON_IsString(brand) &&
+        find_name(cJSON_GetObjectItem(root, "device"), IR_DEVICE_MAX, device_name, &device) &&
+        (item == NULL || find_name(item, IR_ACTION_MAX, action_name, &action))) {
+        ir_scan_config_t config = {
+            .brand = brand->valuestring,
+            .device = (ir_device_type_t)device,
+            .action = (ir_action_t)action,
+            .emitter = ir_action_get_emitter((ir_device_type_t)device),
+            .gap_ms = cJSON_IsNumber(gap) && gap->valueint > 0 ? (uint16_t)gap->valueint : 0,
+            .done_cb = scan_done_cb,
+        };
+        if (config.emitter >= ir_tx_get_num_emitters()) {
+            config.emitter = IR_TX_EMITTER_DEFAULT;
+        }
+        err = ir_scan_start(&config);
+    }
+
+    cJSON_Delete(root);
+    return err;
+}
+
+/**
+ * @brief Import a code set found by the last scan into its device
+ */
+static esp_err_t use_codeset(int codeset)
+{
+    char brand[IR_LIBRARY_BRAND_LEN];
+    ir_device_type_t device;
+    esp_err_t err = ir_scan_get_target(brand, &device);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    size_t imported = 0;
+    err = ir_library_import_remote(brand, device, (uint16_t)codeset, device, &imported);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "%s now uses %s code set %d (%u functions)",
+                 ir_action_get_device_name(device), brand, codeset, (unsigned)imported);
+    }
+    return err;
+}
+
+/* ============================================================================
+ * SERVICE
+ * ============================================================================ */
+
+static esp_err_t scan_write_cb(const esp_rmaker_device_t *device,
+                               const esp_rmaker_param_t *param,
+                               const esp_rmaker_param_val_t val,
+                               void *priv_data,
+                               esp_rmaker_write_ctx_t *ctx)
+{
+    esp_err_t err;
+
+    if (param == start_param) {
+        err = start_scan(val.val.s);
+    } else if (param == found_param) {
+        err = ir_scan_confirm();
+    } else if (param == stop_param) {
+        err = ir_scan_stop();
+    } else if (param == try_param) {
+        err = ir_scan_try((uint16_t)val.val.i);
+    } else if (param == use_param) {
+        err = use_codeset(val.val.i);
+    } else {
+        return ESP_OK;
+    }
+
+    report_status();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "%s failed: %s", esp_rmaker_param_get_name(param), esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t scan_service_create(esp_rmaker_node_t *node)
+{
+    esp_rmaker_device_t *service = esp_rmaker_service_create("IR Code Scan", "esp.service.ir-code-scan", NULL);
+    if (!service) {
+        ESP_LOGE(TAG, "Failed to create IR Code Scan service");
+        return ESP_FAIL;
+    }
+
+    esp_rmaker_device_add_cb(service, scan_write_cb, NULL);
+
+    char *status = scan_status_json();
+    status_param = esp_rmaker_param_create("Status", "esp.param.ir-scan-status",
+                                           esp_rmaker_str(status ? status : "{}"), PROP_FLAG_READ);
+    cJSON_free(status);
+    start_param = esp_rmaker_param_create("Start", "esp.param.ir-scan-start",
+                                          esp_rmaker_str(""), PROP_FLAG_WRITE);
+    found_param = esp_rmaker_param_create("Found", "esp.param.ir-scan-found",
+                                          esp_rmaker_bool(false), PROP_FLAG_WRITE);
+    esp_rmaker_param_add_ui_type(found_param, ESP_RMAKER_UI_TRIGGER);
+    stop_param = esp_rmaker_param_create("Stop", "esp.param.ir-scan-stop",
+                                         esp_rmaker_bool(false), PROP_FLAG_WRITE);
+    esp_rmaker_param_add_ui_type(stop_param, ESP_RMAKER_UI_TRIGGER);
+    try_param = esp_rmaker_param_create("Try", "esp.param.ir-scan-try",
+                                        esp_rmaker_int(0), PROP_FLAG_WRITE);
+    use_param = esp_rmaker_param_create("Use", "esp.param.ir-scan-use",
+                                        esp_rmaker_int(0), PROP_FLAG_WRITE);
+
+    esp_rmaker_service_add_param(service, status_param);
+    esp_rmaker_service_add_param(service, start_param);
+    esp_rmaker_service_add_param(service, found_param);
+    esp_rmaker_service_add_param(service, stop_param);
+    esp_rmaker_service_add_param(service, try_param);
+    esp_rmaker_service_add_param(service, use_param);
+
+    esp_rmaker_node_add_device(node, service);
+    ESP_LOGI(TAG, "IR Code Scan service created");
+    return ESP_OK;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file scan_service.h
+ * @brief RainMaker service for the library code scan
+ *
+ * Exposes ir_scan as an "IR Code Scan" service:
+ * - Start (write): {"brand": "Sony", "device": "TV"} plus optional
+ *   "action" (default Power) and "gap" (ms after each frame)
+ * - Found (write): the device reacted; stops the scan
+ * - Stop (write): abandon the scan
+ * - Try (write): re-send one suspect code set
+ * - Use (write): import a code set into the scanned device's actions
+ * - Status (read): JSON with state, progress and suspects
+ *
+ * A short press of the boot button also counts as Found.
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_rmaker_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the IR Code Scan service and add it to the node
+ *
+ * Call after ir_library_init() and ir_scan_init(), before esp_rmaker_start().
+ *
+ * @param node RainMaker node
+ * @return ESP_OK, ESP_FAIL if the service could not be created
+ */
+esp_err_t scan_service_create(esp_rmaker_node_t *node);
+
+#ifdef __cplusplus
+}
+#endif
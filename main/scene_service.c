@@ -0,0 +1,288 @@
+/**
+ * @file scene_service.c
+ * @brief RainMaker service for IR scenes
+ *
+ * A scene is saved by writing its definition to the Save param:
+ *
+ *   {"name": "Movie",
+ *    "steps": [{"device": "TV", "action": "Power", "delay": 3000},
+ *              {"device": "Speaker", "action": "HDMI1"},
+ *              {"ac": 0, "power": true, "mode": "Cool", "temperature": 24}]}
+ *
+ * Device, action, mode, fan ("fan") and swing names are the ones the
+ * ir_action and ir_ac_state name tables use (case-insensitive). "ac" is
+ * the AC unit index; AC fields left out keep the unit's state at the time
+ * the scene is saved. "delay" is the pause in ms after the step's frame.
+ */
+
+#include "scene_service.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "cJSON.h"
+#include "esp_log.h"
+#include "ir_action.h"
+#include "ir_ac_state.h"
+#include "ir_scene.h"
+
+static const char *TAG = "scene_service";
+
+static esp_rmaker_param_t *scenes_param = NULL;
+static esp_rmaker_param_t *run_param = NULL;
+static esp_rmaker_param_t *save_param = NULL;
+static esp_rmaker_param_t *delete_param = NULL;
+
+/* ============================================================================
+ * NAME LOOKUP
+ * ============================================================================ */
+
+typedef enum {
+    NAME_DEVICE,
+    NAME_ACTION,
+    NAME_AC_MODE,
+    NAME_AC_FAN_SPEED,
+    NAME_AC_SWING,
+} name_kind_t;
+
+static const char *kind_name(name_kind_t kind, int value)
+{
+    switch (kind) {
+        case NAME_DEVICE:       return ir_action_get_device_name((ir_device_type_t)value);
+        case NAME_ACTION:       return ir_action_get_action_name((ir_action_t)value);
+        case NAME_AC_MODE:      return ir_ac_get_mode_name((ac_mode_t)value);
+        case NAME_AC_FAN_SPEED: return ir_ac_get_fan_speed_name((ac_fan_speed_t)value);
+        default:                return ir_ac_get_swing_name((ac_swing_t)value);
+    }
+}
+
+static int kind_count(name_kind_t kind)
+{
+    switch (kind) {
+        case NAME_DEVICE:       return IR_DEVICE_MAX;
+        case NAME_ACTION:       return IR_ACTION_MAX;
+        case NAME_AC_MODE:      return AC_MODE_MAX;
+        case NAME_AC_FAN_SPEED: return AC_FAN_MAX;
+        default:                return AC_SWING_MAX;
+    }
+}
+
+/**
+ * @brief Look a name up in one of the component name tables
+ *
+ * Runs only when a scene is saved, so a linear scan is fine.
+ */
+static bool find_name(name_kind_t kind, const cJSON *item, uint8_t *value)
+{
+    if (!cJSON_IsString(item)) {
+        return false;
+    }
+    for (int i = 0; i < kind_count(kind); i++) {
+        if (strcasecmp(item->valuestring, kind_name(kind, i)) == 0) {
+            *value = (uint8_t)i;
+            return true;
+        }
+    }
+    ESP_LOGW(TAG, "Unknown name: %s", item->valuestring);
+    return false;
+}
+
+/* ============================================================================
+ * SCENE DEFINITION PARSING
+ * ============================================================================ */
+
+static esp_err_t parse_ac_step(const cJSON *item, int index, ir_scene_step_t *step)
+{
+    ir_ac_handle_t unit = (index >= 0 && index < ir_ac_get_num_units()) ? ir_ac_get_unit(index) : NULL;
+    if (unit == NULL) {
+        ESP_LOGW(TAG, "No AC unit %d", index);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ac_state_t current;
+    if (ir_ac_unit_copy_state(unit, &current) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    step->type = IR_SCENE_STEP_AC;
+    step->target = index;
+    step->power = current.power;
+    step->mode = current.mode;
+    step->temperature = current.temperature;
+    step->fan_speed = current.fan_speed;
+    step->swing = current.swing;
+
+    const cJSON *field = cJSON_GetObjectItem(item, "power");
+    if (field) {
+        step->power = cJSON_IsTrue(field);
+    }
+    field = cJSON_GetObjectItem(item, "temperature");
+    if (cJSON_IsNumber(field)) {
+        step->temperature = (uint8_t)field->valueint;
+    }
+    field = cJSON_GetObjectItem(item, "swing");
+    if (cJSON_IsBool(field)) {
+        step->swing = cJSON_IsTrue(field) ? AC_SWING_VERTICAL : AC_SWING_OFF;
+    } else if (field && !find_name(NAME_AC_SWING, field, &step->swing)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    field = cJSON_GetObjectItem(item, "mode");
+    if (field && !find_name(NAME_AC_MODE, field, &step->mode)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    field = cJSON_GetObjectItem(item, "fan");
+    if (field && !find_name(NAME_AC_FAN_SPEED, field, &step->fan_speed)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t parse_step(const cJSON *item, ir_scene_step_t *step)
+{
+    memset(step, 0, sizeof(*step));
+
+    const cJSON *delay = cJSON_GetObjectItem(item, "delay");
+    if (cJSON_IsNumber(delay)) {
+        step->delay_ms = delay->valueint < 0 ? 0 :
+                         delay->valueint > UINT16_MAX ? UINT16_MAX : delay->valueint;
+    }
+
+    const cJSON *ac = cJSON_GetObjectItem(item, "ac");
+    if (cJSON_IsNumber(ac)) {
+        return parse_ac_step(item, ac->valueint, step);
+    }
+
+    step->type = IR_SCENE_STEP_ACTION;
+    if (!find_name(NAME_DEVICE, cJSON_GetObjectItem(item, "device"), &step->target) ||
+        !find_name(NAME_ACTION, cJSON_GetObjectItem(item, "action"), &step->action)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t save_scene(const char *json)
+{
+    cJSON *root = cJSON_Parse(json);
+    if (root == NULL) {
+        ESP_LOGW(TAG, "Scene definition is not valid JSON");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    ir_scene_step_t steps[IR_SCENE_MAX_STEPS];
+    size_t num_steps = 0;
+
+    const cJSON *name = cJSON_GetObjectItem(root, "name");
+    const cJSON *list = cJSON_GetObjectItem(root, "steps");
+    if (!cJSON_IsString(name) || !cJSON_IsArray(list) ||
+        cJSON_GetArraySize(list) > IR_SCENE_MAX_STEPS) {
+        ESP_LOGW(TAG, "Scene needs a name and 1-%d steps", IR_SCENE_MAX_STEPS);
+        err = ESP_ERR_INVALID_ARG;
+    }
+
+    const cJSON *item;
+    cJSON_ArrayForEach(item, list) {
+        if (err != ESP_OK) {
+            break;
+        }
+        err = parse_step(item, &steps[num_steps++]);
+    }
+
+    if (err == ESP_OK) {
+        err = ir_scene_save(name->valuestring, steps, num_steps);
+    }
+    cJSON_Delete(root);
+    return err;
+}
+
+/* ============================================================================
+ * SERVICE
+ * ============================================================================ */
+
+/**
+ * @brief Publish the stored scene names (caller frees the result)
+ */
+static char *scene_names_json(void)
+{
+    cJSON *names = cJSON_CreateArray();
+    char name[IR_SCENE_NAME_LEN];
+
+    for (size_t i = 0; i < ir_scene_get_count(); i++) {
+        if (ir_scene_get_name(i, name, sizeof(name)) == ESP_OK) {
+            cJSON_AddItemToArray(names, cJSON_CreateString(name));
+        }
+    }
+
+    char *json = cJSON_PrintUnformatted(names);
+    cJSON_Delete(names);
+    return json;
+}
+
+static void report_scene_names(void)
+{
+    char *json = scene_names_json();
+    if (json) {
+        esp_rmaker_param_update_and_report(scenes_param, esp_rmaker_str(json));
+        cJSON_free(json);
+    }
+}
+
+static esp_err_t scene_write_cb(const esp_rmaker_device_t *device,
+                                const esp_rmaker_param_t *param,
+                                const esp_rmaker_param_val_t val,
+                                void *priv_data,
+                                esp_rmaker_write_ctx_t *ctx)
+{
+    esp_err_t err;
+
+    if (param == run_param) {
+        ESP_LOGI(TAG, "Run scene: %s", val.val.s);
+        err = ir_scene_play(val.val.s);
+    } else if (param == save_param) {
+        err = save_scene(val.val.s);
+        if (err == ESP_OK) {
+            report_scene_names();
+        }
+    } else if (param == delete_param) {
+        err = ir_scene_delete(val.val.s);
+        if (err == ESP_OK) {
+            report_scene_names();
+        }
+    } else {
+        return ESP_OK;
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "%s failed: %s", esp_rmaker_param_get_name(param), esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t scene_service_create(esp_rmaker_node_t *node)
+{
+    esp_rmaker_device_t *service = esp_rmaker_service_create("IR Scenes", "esp.service.ir-scenes", NULL);
+    if (!service) {
+        ESP_LOGE(TAG, "Failed to create IR Scenes service");
+        return ESP_FAIL;
+    }
+
+    esp_rmaker_device_add_cb(service, scene_write_cb, NULL);
+
+    char *names = scene_names_json();
+    scenes_param = esp_rmaker_param_create("Scenes", "esp.param.ir-scene-list",
+                                           esp_rmaker_str(names ? names : "[]"), PROP_FLAG_READ);
+    cJSON_free(names);
+    run_param = esp_rmaker_param_create("Run", "esp.param.ir-scene-run",
+                                        esp_rmaker_str(""), PROP_FLAG_WRITE);
+    save_param = esp_rmaker_param_create("Save", "esp.param.ir-scene-save",
+                                         esp_rmaker_str(""), PROP_FLAG_WRITE);
+    delete_param = esp_rmaker_param_create("Delete", "esp.param.ir-scene-delete",
+                                           esp_rmaker_str(""), PROP_FLAG_WRITE);
+
+    esp_rmaker_service_add_param(service, scenes_param);
+    esp_rmaker_service_add_param(service, run_param);
+    esp_rmaker_service_add_param(service, save_param);
+    esp_rmaker_service_add_param(service, delete_param);
+
+    esp_rmaker_node_add_device(node, service);
+    ESP_LOGI(TAG, "IR Scenes service created");
+    return ESP_OK;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file scene_service.h
+ * @brief RainMaker service for IR scenes
+ *
+ * Exposes the ir_scene engine as an "IR Scenes" service:
+ * - Scenes (read): JSON array of the stored scene names
+ * - Run (write): name of a scene to play
+ * - Save (write): scene definition as JSON (format in scene_service.c)
+ * - Delete (write): name of a scene to delete
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_rmaker_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the IR Scenes service and add it to the node
+ *
+ * Call after ir_scene_init() and before esp_rmaker_start().
+ *
+ * @param node RainMaker node
+ * @return ESP_OK, ESP_FAIL if the service could not be created
+ */
+esp_err_t scene_service_create(esp_rmaker_node_t *node);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,190 @@
+/**
+ * @file ac_capture.c
+ * @brief Synthetic AC captures for the host tests
+ *
+ * MIT License
+ */
+
+#include "ac_capture.h"
+#include "host_ir_control.h"
+#include "ir_apple.h"
+#include "ir_bosewave.h"
+#include "ir_carrier.h"
+#include "ir_daikin.h"
+#include "ir_denon.h"
+#include "ir_distance_width.h"
+#include "ir_fast.h"
+#include "ir_fujitsu.h"
+#include "ir_haier.h"
+#include "ir_hitachi.h"
+#include "ir_jvc.h"
+#include "ir_lego.h"
+#include "ir_lg.h"
+#include "ir_magiquest.h"
+#include "ir_midea.h"
+#include "ir_mitsubishi.h"
+#include "ir_panasonic.h"
+#include "ir_rc5.h"
+#include "ir_rc6.h"
+#include "ir_samsung48.h"
+#include "ir_sony.h"
+#include "ir_whynter.h"
+#include <string.h>
+
+const ir_protocol_t ac_capture_protocols[] = {
+    IR_PROTOCOL_CARRIER,
+    IR_PROTOCOL_DAIKIN,
+    IR_PROTOCOL_HITACHI,
+    IR_PROTOCOL_MITSUBISHI,
+    IR_PROTOCOL_MIDEA,
+    IR_PROTOCOL_HAIER,
+    IR_PROTOCOL_SAMSUNG48,
+    IR_PROTOCOL_PANASONIC,
+    IR_PROTOCOL_FUJITSU,
+    IR_PROTOCOL_LG2,
+};
+const size_t ac_capture_num_protocols = sizeof(ac_capture_protocols) / sizeof(ac_capture_protocols[0]);
+
+static ac_frame_cache_t *cache = NULL;
+
+size_t ac_capture_transmit(const ac_state_t *state, bool fresh,
+                           rmt_symbol_word_t *symbols, size_t max_symbols)
+{
+    if (!cache) {
+        cache = ir_ac_frame_cache_create();
+    }
+    if (fresh) {
+        ir_ac_frame_cache_reset(cache);
+    }
+
+    host_tx_num_symbols = 0;
+    if (ir_ac_frame_transmit(cache, 0, state) != ESP_OK || host_tx_num_symbols > max_symbols) {
+        return 0;
+    }
+    memcpy(symbols, host_tx_symbols, host_tx_num_symbols * sizeof(rmt_symbol_word_t));
+    if (host_tx_num_symbols > 0) {
+        symbols[host_tx_num_symbols - 1].duration1 = 0;
+    }
+    return host_tx_num_symbols;
+}
+
+static uint32_t distort_duration(uint32_t us, int stretch_us, unsigned jitter_percent, uint32_t *rng)
+{
+    if (us == 0) {
+        return 0;   // End marker
+    }
+    *rng = *rng * 1103515245u + 12345u;
+    int range = (int)(us * jitter_percent / 100);
+    int noise = range ? (int)((*rng >> 16) % (2 * range + 1)) - range : 0;
+    int out = (int)us + stretch_us + noise;
+    if (out < 1) {
+        out = 1;
+    }
+    return out > 0x7FFF ? 0x7FFF : (uint32_t)out;
+}
+
+void ac_capture_distort(rmt_symbol_word_t *symbols, size_t num_symbols, int stretch_us,
+                        unsigned jitter_percent, uint32_t seed)
+{
+    uint32_t rng = seed;
+    for (size_t i = 0; i < num_symbols; i++) {
+        symbols[i].duration0 = distort_duration(symbols[i].duration0, stretch_us, jitter_percent, &rng);
+        symbols[i].duration1 = distort_duration(symbols[i].duration1, -stretch_us, jitter_percent, &rng);
+    }
+}
+
+esp_err_t ac_capture_decode(ir_protocol_t protocol, const rmt_symbol_word_t *symbols,
+                            size_t num_symbols, ir_code_t *code)
+{
+    switch (protocol) {
+        case IR_PROTOCOL_CARRIER:    return ir_decode_carrier(symbols, num_symbols, code);
+        case IR_PROTOCOL_DAIKIN:     return ir_decode_daikin(symbols, num_symbols, code);
+        case IR_PROTOCOL_HITACHI:    return ir_decode_hitachi(symbols, num_symbols, code);
+        case IR_PROTOCOL_MITSUBISHI: return ir_decode_mitsubishi(symbols, num_symbols, code);
+        case IR_PROTOCOL_MIDEA:      return ir_decode_midea(symbols, num_symbols, code);
+        case IR_PROTOCOL_HAIER:      return ir_decode_haier(symbols, num_symbols, code);
+        case IR_PROTOCOL_SAMSUNG48:  return ir_decode_samsung48(symbols, num_symbols, code);
+        case IR_PROTOCOL_PANASONIC:  return ir_decode_panasonic(symbols, num_symbols, code);
+        case IR_PROTOCOL_FUJITSU:    return ir_decode_fujitsu(symbols, num_symbols, code);
+        default:                     return ir_decode_distance_width(symbols, num_symbols, code);
+    }
+}
+
+esp_err_t ac_capture_receive(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code)
+{
+    static esp_err_t (*const chain[])(const rmt_symbol_word_t *, size_t, ir_code_t *) = {
+        ir_decode_sony,
+        ir_decode_rc5,
+        ir_decode_rc6,
+        ir_decode_jvc,
+        ir_decode_lg,
+        ir_decode_denon,
+        ir_decode_panasonic,
+        ir_decode_samsung48,
+        ir_decode_apple,
+        ir_decode_mitsubishi,
+        ir_decode_daikin,
+        ir_decode_fujitsu,
+        ir_decode_haier,
+        ir_decode_midea,
+        ir_decode_carrier,
+        ir_decode_hitachi,
+        ir_decode_whynter,
+        ir_decode_lego,
+        ir_decode_magiquest,
+        ir_decode_bosewave,
+        ir_decode_fast,
+    };
+
+    for (size_t i = 0; i < sizeof(chain) / sizeof(chain[0]); i++) {
+        memset(code, 0, sizeof(*code));
+        if (chain[i](symbols, num_symbols, code) == ESP_OK) {
+            return ESP_OK;
+        }
+        ir_code_free(code);
+    }
+    memset(code, 0, sizeof(*code));
+    return ir_decode_distance_width(symbols, num_symbols, code);
+}
+
+size_t ac_capture_bytes(const ir_code_t *code, uint8_t *bytes, size_t max_bytes)
+{
+    ir_dw_frame_t frame;
+    size_t len;
+    const uint8_t *payload = ir_code_get_payload(code, &len);
+    if (!payload) {
+        return 0;
+    }
+
+    if (code->protocol == IR_PROTOCOL_PULSE_DISTANCE || code->protocol == IR_PROTOCOL_PULSE_WIDTH) {
+        if (ir_dw_unpack(payload, len, &frame) != ESP_OK) {
+            return 0;
+        }
+        payload = frame.bytes;
+        len = frame.num_bytes;
+    }
+
+    if (len > max_bytes) {
+        return 0;
+    }
+    memcpy(bytes, payload, len);
+    return len;
+}
+
+void ac_capture_state(ir_protocol_t protocol, uint32_t index, ac_state_t *state)
+{
+    memset(state, 0, sizeof(*state));
+    state->protocol = protocol;
+    state->is_learned = true;
+
+    /* Mixed radices so neighbouring indices differ in every field */
+    state->power = index & 1;
+    state->mode = (ac_mode_t)(1 + (index / 2) % (AC_MODE_MAX - 1));
+    state->temperature = AC_TEMP_MIN + (index * 7) % (AC_TEMP_MAX - AC_TEMP_MIN + 1);
+    state->fan_speed = (ac_fan_speed_t)((index / 3) % AC_FAN_MAX);
+    state->swing = (ac_swing_t)((index / 5) % AC_SWING_MAX);
+    state->turbo = (index / 11) & 1;
+    state->quiet = (index / 13) & 1;
+    state->econo = (index / 17) & 1;
+    state->sleep = (index / 19) & 1;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file ac_capture.h
+ * @brief Synthetic AC captures for the host tests
+ *
+ * Frames are produced by the real transmit path (ir_ac_frame_transmit()
+ * through a template cache), with ir_transmit_symbols_on() replaced by a
+ * recorder, then optionally distorted the way a demodulating receiver
+ * distorts them before they are handed to the decoders.
+ *
+ * MIT License
+ */
+
+#ifndef AC_CAPTURE_H
+#define AC_CAPTURE_H
+
+#include "ir_ac_frame.h"
+#include "driver/rmt_types.h"
+
+/* Longest AC transmission (Hitachi 264 bits) plus headers and stop bits */
+#define AC_CAPTURE_MAX_SYMBOLS  (AC_FRAME_MAX_BYTES * 8 + 2 * AC_FRAME_MAX_FRAMES)
+
+/* AC protocols with a frame map */
+extern const ir_protocol_t ac_capture_protocols[];
+extern const size_t ac_capture_num_protocols;
+
+/**
+ * @brief Transmit @p state and return the symbols that went on air
+ *
+ * As a receiver captures them: the space after the last mark runs into
+ * the idle timeout, which the RMT receiver reports as 0.
+ *
+ * @param fresh Drop the template cache first (full build instead of patch)
+ * @return Number of symbols, 0 if the state could not be transmitted
+ */
+size_t ac_capture_transmit(const ac_state_t *state, bool fresh,
+                           rmt_symbol_word_t *symbols, size_t max_symbols);
+
+/**
+ * @brief Distort a capture like a demodulating receiver
+ *
+ * Marks grow by @p stretch_us and spaces shrink by the same amount
+ * (demodulator delay), then every duration gets up to +-@p jitter_percent
+ * of deterministic noise.
+ */
+void ac_capture_distort(rmt_symbol_word_t *symbols, size_t num_symbols, int stretch_us,
+                        unsigned jitter_percent, uint32_t seed);
+
+/**
+ * @brief Run the decoder the receive task would use for @p protocol
+ *
+ * The dedicated decoder, or the universal pulse distance decoder for
+ * protocols without one (LG2).
+ *
+ * @return The decoder result
+ */
+esp_err_t ac_capture_decode(ir_protocol_t protocol, const rmt_symbol_word_t *symbols,
+                            size_t num_symbols, ir_code_t *code);
+
+/**
+ * @brief Decode a capture like the receive task
+ *
+ * Tries the decoders in the receive task's order and falls back to the
+ * universal decoder, so a frame a shorter protocol's decoder accepts first
+ * decodes as that protocol here too. NEC and Samsung32, decoded inside
+ * ir_control.c, are left out.
+ *
+ * @return ESP_OK, or the universal decoder error
+ */
+esp_err_t ac_capture_receive(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code);
+
+/**
+ * @brief Frame bytes of a decoded code (payload, or the universal decoder's bytes)
+ *
+ * @return Number of bytes copied to @p bytes, 0 if there are none
+ */
+size_t ac_capture_bytes(const ir_code_t *code, uint8_t *bytes, size_t max_bytes);
+
+/**
+ * @brief State with every field set from @p index, spread over all values
+ */
+void ac_capture_state(ir_protocol_t protocol, uint32_t index, ac_state_t *state);
+
+#endif // AC_CAPTURE_H
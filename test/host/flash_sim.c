@@ -0,0 +1,74 @@
+/**
+ * @file flash_sim.c
+ * @brief Simulated ir_log partition for the host tests
+ *
+ * MIT License
+ */
+
+#include "flash_sim.h"
+#include "esp_partition.h"
+#include <assert.h>
+#include <string.h>
+
+uint8_t flash_sim[FLASH_SIM_SIZE];
+int flash_sim_fail_after = -1;
+bool flash_sim_present = true;
+unsigned flash_sim_programs;
+unsigned flash_sim_erases;
+
+static const esp_partition_t partition = {
+    .size = FLASH_SIM_SIZE,
+    .label = "ir_log",
+};
+
+void flash_sim_reset(void)
+{
+    memset(flash_sim, 0xFF, sizeof(flash_sim));
+    flash_sim_fail_after = -1;
+    flash_sim_programs = 0;
+    flash_sim_erases = 0;
+}
+
+const esp_partition_t *esp_partition_find_first(int type, int subtype, const char *label)
+{
+    return flash_sim_present && strcmp(label, partition.label) == 0 ? &partition : NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t len)
+{
+    assert(offset + len <= FLASH_SIM_SIZE);
+    memcpy(dst, flash_sim + offset, len);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t len)
+{
+    const uint8_t *bytes = src;
+    assert(offset + len <= FLASH_SIM_SIZE);
+
+    if (flash_sim_fail_after == 0) {
+        /* Torn program: only the first half reaches the flash */
+        for (size_t i = 0; i < len / 2; i++) {
+            flash_sim[offset + i] &= bytes[i];
+        }
+        return ESP_FAIL;
+    }
+    if (flash_sim_fail_after > 0) {
+        flash_sim_fail_after--;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        flash_sim[offset + i] &= bytes[i];
+    }
+    flash_sim_programs++;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t len)
+{
+    assert(offset % FLASH_SIM_SECTOR_SIZE == 0 && len % FLASH_SIM_SECTOR_SIZE == 0);
+    assert(offset + len <= FLASH_SIM_SIZE);
+    memset(flash_sim + offset, 0xFF, len);
+    flash_sim_erases++;
+    return ESP_OK;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file flash_sim.h
+ * @brief Simulated ir_log partition for the host tests
+ *
+ * NOR semantics: programming can only clear bits, erase sets a whole
+ * 4 KB sector to 0xFF. A write can be made to fail, tearing it after
+ * half its bytes, to stand in for a reset during a flash program.
+ *
+ * MIT License
+ */
+
+#ifndef FLASH_SIM_H
+#define FLASH_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FLASH_SIM_SIZE          (16 * 1024)
+#define FLASH_SIM_SECTOR_SIZE   4096
+
+extern uint8_t flash_sim[FLASH_SIM_SIZE];
+
+/* Writes that succeed before the next one is torn (-1 = never tear) */
+extern int flash_sim_fail_after;
+
+/* false = the partition table has no ir_log partition */
+extern bool flash_sim_present;
+
+extern unsigned flash_sim_programs;
+extern unsigned flash_sim_erases;
+
+/**
+ * @brief Erase the whole partition and clear the counters
+ */
+void flash_sim_reset(void);
+
+#endif // FLASH_SIM_H
@@ -0,0 +1,20 @@
+/**
+ * @file host_compat.c
+ * @brief newlib functions the host C library lacks
+ *
+ * MIT License
+ */
+
+#include "host_compat.h"
+#include <string.h>
+
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t copy = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return len;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file host_compat.h
+ * @brief newlib functions the host C library lacks (forced include)
+ *
+ * MIT License
+ */
+
+#ifndef HOST_COMPAT_H
+#define HOST_COMPAT_H
+
+#include <stddef.h>
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+#endif // HOST_COMPAT_H
@@ -0,0 +1,143 @@
+/**
+ * @file host_freertos.c
+ * @brief FreeRTOS and esp_timer calls used by the modules under test, on pthreads
+ *
+ * Mutexes are pthread mutexes so the concurrent tests exercise real
+ * locking. Delays sleep for the tick length.
+ *
+ * MIT License
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+static SemaphoreHandle_t mutex_create(int type)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutex_t *mutex = malloc(sizeof(*mutex));
+    if (!mutex) {
+        return NULL;
+    }
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, type);
+    pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return mutex_create(PTHREAD_MUTEX_NORMAL);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return mutex_create(PTHREAD_MUTEX_RECURSIVE);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem) {
+        pthread_mutex_destroy(sem);
+        free(sem);
+    }
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY) {
+        return pthread_mutex_lock(sem) == 0 ? pdTRUE : pdFALSE;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t ns = deadline.tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000;
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+    return pthread_mutex_timedlock(sem, &deadline) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pthread_mutex_unlock(sem) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    return xSemaphoreTake(sem, ticks);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+    return xSemaphoreGive(sem);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec = ticks / configTICK_RATE_HZ,
+        .tv_nsec = (long)(ticks % configTICK_RATE_HZ) * portTICK_PERIOD_MS * 1000000,
+    };
+    if (ticks == 0) {
+        sched_yield();
+    } else {
+        nanosleep(&ts, NULL);
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * configTICK_RATE_HZ + ts.tv_nsec / (portTICK_PERIOD_MS * 1000000));
+}
+
+/* ============================================================================
+ * TASKS AND TIMERS
+ *
+ * The modules under test create their worker tasks and timers in their
+ * init functions, which the host tests do not call.
+ * ============================================================================ */
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t priority, TaskHandle_t *out)
+{
+    return pdFAIL;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    vTaskDelay(ticks == portMAX_DELAY ? 1 : ticks);
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return pdPASS;
+}
+
+int esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+int esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+int esp_timer_stop(esp_timer_handle_t timer)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+int esp_timer_delete(esp_timer_handle_t timer)
+{
+    return ESP_ERR_INVALID_STATE;
+}
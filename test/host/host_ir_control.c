@@ -0,0 +1,115 @@
+/**
+ * @file host_ir_control.c
+ * @brief Recording stand-in for the ir_control.c transmit and receive API
+ *
+ * MIT License
+ */
+
+#include "host_ir_control.h"
+#include "ir_code_table.h"
+#include "ir_protocols.h"
+#include <stdlib.h>
+#include <string.h>
+
+rmt_symbol_word_t host_tx_symbols[HOST_TX_MAX_SYMBOLS];
+size_t host_tx_num_symbols;
+ir_code_t host_tx_code;
+unsigned host_tx_count;
+
+esp_err_t ir_transmit_symbols_on(uint8_t emitter, const ir_code_t *code,
+                                 const void *symbols, size_t num_symbols)
+{
+    if (num_symbols > HOST_TX_MAX_SYMBOLS) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(host_tx_symbols, symbols, num_symbols * sizeof(rmt_symbol_word_t));
+    host_tx_num_symbols = num_symbols;
+    host_tx_code = *code;
+    host_tx_count++;
+    return ESP_OK;
+}
+
+esp_err_t ir_transmit_symbols_async(uint8_t emitter, const ir_code_t *code,
+                                    const void *symbols, size_t num_symbols)
+{
+    return ir_transmit_symbols_on(emitter, code, symbols, num_symbols);
+}
+
+esp_err_t ir_transmit_span_async(uint8_t emitter, const ir_code_t *code,
+                                 const void *symbols, size_t num_symbols)
+{
+    return ir_transmit_symbols_on(emitter, code, symbols, num_symbols);
+}
+
+/* Protocol encoders live in ir_control.c: only pre-built symbols are sent */
+esp_err_t ir_transmit_on(uint8_t emitter, const ir_code_t *code)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t ir_transmit_async(uint8_t emitter, const ir_code_t *code)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t ir_transmit_broadcast(uint32_t emitter_mask, const ir_code_t *code)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t ir_render_code(const ir_code_t *code, void **symbols, size_t *num_symbols)
+{
+    if (code == NULL || symbols == NULL || num_symbols == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (code->protocol != IR_PROTOCOL_RAW) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (code->raw_data == NULL || code->raw_length == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *symbols = malloc(code->raw_length * sizeof(rmt_symbol_word_t));
+    if (*symbols == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(*symbols, code->raw_data, code->raw_length * sizeof(rmt_symbol_word_t));
+    *num_symbols = code->raw_length;
+    return ESP_OK;
+}
+
+/* Recorded frames are done as soon as they are queued */
+esp_err_t ir_tx_wait_done(uint8_t emitter, uint32_t timeout_ms)
+{
+    return ESP_OK;
+}
+
+esp_err_t ir_tx_wait_all_done(uint32_t timeout_ms)
+{
+    return ESP_OK;
+}
+
+uint8_t ir_tx_get_num_emitters(void)
+{
+    return 1;
+}
+
+esp_err_t ir_learn_start(ir_button_t button, uint32_t timeout_ms)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t ir_learn_code(uint32_t timeout_ms, ir_code_t *code)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t ir_register_rx_hook(ir_rx_hook_t hook, void *arg)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+const char *ir_get_protocol_name(ir_protocol_t protocol)
+{
+    return ir_protocol_to_string(protocol);
+}
@@ -0,0 +1,27 @@
+/**
+ * @file host_ir_control.h
+ * @brief Stand-in for the ir_control.c transmit and receive API
+ *
+ * Transmissions of pre-built symbols are recorded instead of sent and
+ * complete at once. Protocol codes (no encoders on the host), learning
+ * and receive hooks report ESP_ERR_NOT_SUPPORTED; ir_render_code() only
+ * copies RAW codes.
+ *
+ * MIT License
+ */
+
+#ifndef HOST_IR_CONTROL_H
+#define HOST_IR_CONTROL_H
+
+#include "ir_control.h"
+#include "driver/rmt_types.h"
+
+#define HOST_TX_MAX_SYMBOLS     1024
+
+/* Last frame passed to ir_transmit_symbols_on() or one of the async variants */
+extern rmt_symbol_word_t host_tx_symbols[HOST_TX_MAX_SYMBOLS];
+extern size_t host_tx_num_symbols;
+extern ir_code_t host_tx_code;
+extern unsigned host_tx_count;
+
+#endif // HOST_IR_CONTROL_H
@@ -0,0 +1,21 @@
+/**
+ * @file host_storage_nvs.c
+ * @brief NVS backend stand-in: there is no NVS on the host
+ *
+ * ir_storage_init() fails with ESP_ERR_NOT_SUPPORTED; tests select the
+ * in-memory backend with ir_storage_init_with(&ir_storage_backend_mem).
+ *
+ * MIT License
+ */
+
+#include "ir_storage.h"
+
+static esp_err_t nvs_unsupported(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+const ir_storage_backend_t ir_storage_backend_nvs = {
+    .name = "nvs",
+    .init = nvs_unsupported,
+};
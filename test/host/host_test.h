@@ -0,0 +1,38 @@
+/**
+ * @file host_test.h
+ * @brief Minimal check macros for the host tests
+ *
+ * A failed check prints its location and the test keeps going, so one
+ * run reports every failure. HOST_TEST_RESULT() is the exit status.
+ *
+ * MIT License
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int host_test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+        long long a_ = (long long)(actual), e_ = (long long)(expected); \
+        if (a_ != e_) { \
+            fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, \
+                    #actual, a_, e_); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+#define HOST_TEST_RESULT() \
+    (printf("%s: %s\n", __FILE__, host_test_failures ? "FAILED" : "passed"), \
+     host_test_failures ? 1 : 0)
+
+#endif // HOST_TEST_H
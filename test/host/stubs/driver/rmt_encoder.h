@@ -0,0 +1,3 @@
+/* Host stand-in for ESP-IDF driver/rmt_encoder.h */
+#pragma once
+#include "driver/rmt_types.h"
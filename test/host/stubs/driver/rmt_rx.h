@@ -0,0 +1,3 @@
+/* Host stand-in for ESP-IDF driver/rmt_rx.h */
+#pragma once
+#include "driver/rmt_types.h"
@@ -0,0 +1,3 @@
+/* Host stand-in for ESP-IDF driver/rmt_tx.h */
+#pragma once
+#include "driver/rmt_types.h"
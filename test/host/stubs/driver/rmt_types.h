@@ -0,0 +1,157 @@
+/* Host stand-in for ESP-IDF driver/rmt_types.h and the RMT driver API */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef union {
+    struct {
+        uint32_t duration0 : 15;
+        uint32_t level0 : 1;
+        uint32_t duration1 : 15;
+        uint32_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef int gpio_num_t;
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t rmt_encoder_t;
+typedef rmt_encoder_t *rmt_encoder_handle_t;
+typedef struct rmt_sync_manager_t *rmt_sync_manager_handle_t;
+
+typedef enum {
+    RMT_ENCODING_RESET = 0,
+    RMT_ENCODING_COMPLETE = 1,
+    RMT_ENCODING_MEM_FULL = 2,
+} rmt_encode_state_t;
+
+struct rmt_encoder_t {
+    size_t (*encode)(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *data,
+                     size_t size, rmt_encode_state_t *state);
+    esp_err_t (*reset)(rmt_encoder_t *encoder);
+    esp_err_t (*del)(rmt_encoder_t *encoder);
+};
+
+typedef struct {
+    rmt_symbol_word_t *received_symbols;
+    size_t num_symbols;
+    struct {
+        uint32_t is_last : 1;
+    } flags;
+} rmt_rx_done_event_data_t;
+
+typedef struct {
+    size_t num_symbols;
+} rmt_tx_done_event_data_t;
+
+typedef bool (*rmt_rx_done_callback_t)(rmt_channel_handle_t, const rmt_rx_done_event_data_t *, void *);
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t, const rmt_tx_done_event_data_t *, void *);
+
+typedef struct {
+    rmt_rx_done_callback_t on_recv_done;
+} rmt_rx_event_callbacks_t;
+
+typedef struct {
+    rmt_tx_done_callback_t on_trans_done;
+} rmt_tx_event_callbacks_t;
+
+typedef enum { RMT_CLK_SRC_DEFAULT } rmt_clock_source_t;
+
+typedef struct {
+    gpio_num_t gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    size_t trans_queue_depth;
+    int intr_priority;
+    struct {
+        uint32_t invert_out : 1;
+        uint32_t with_dma : 1;
+        uint32_t io_loop_back : 1;
+        uint32_t io_od_mode : 1;
+        uint32_t allow_pd : 1;
+    } flags;
+} rmt_tx_channel_config_t;
+
+typedef struct {
+    gpio_num_t gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    int intr_priority;
+    struct {
+        uint32_t invert_in : 1;
+        uint32_t with_dma : 1;
+        uint32_t io_loop_back : 1;
+        uint32_t allow_pd : 1;
+    } flags;
+} rmt_rx_channel_config_t;
+
+typedef struct {
+    uint32_t signal_range_min_ns;
+    uint32_t signal_range_max_ns;
+    struct {
+        uint32_t en_partial_rx : 1;
+    } flags;
+} rmt_receive_config_t;
+
+typedef struct {
+    int loop_count;
+    struct {
+        uint32_t eot_level : 1;
+        uint32_t queue_nonblocking : 1;
+    } flags;
+} rmt_transmit_config_t;
+
+typedef struct {
+    uint32_t frequency_hz;
+    float duty_cycle;
+    struct {
+        uint32_t polarity_active_low : 1;
+        uint32_t always_on : 1;
+    } flags;
+} rmt_carrier_config_t;
+
+typedef struct {
+    int dummy;
+} rmt_copy_encoder_config_t;
+
+typedef struct {
+    rmt_symbol_word_t bit0;
+    rmt_symbol_word_t bit1;
+    struct {
+        uint32_t msb_first : 1;
+    } flags;
+} rmt_bytes_encoder_config_t;
+
+typedef struct {
+    const rmt_channel_handle_t *tx_channel_array;
+    size_t array_size;
+} rmt_sync_manager_config_t;
+
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *out);
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t *config, rmt_channel_handle_t *out);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+esp_err_t rmt_apply_carrier(rmt_channel_handle_t channel, const rmt_carrier_config_t *config);
+esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void *data,
+                       size_t size, const rmt_transmit_config_t *config);
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t channel, int timeout_ms);
+esp_err_t rmt_receive(rmt_channel_handle_t channel, void *buffer, size_t size,
+                      const rmt_receive_config_t *config);
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t channel,
+                                          const rmt_rx_event_callbacks_t *cbs, void *arg);
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t channel,
+                                          const rmt_tx_event_callbacks_t *cbs, void *arg);
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *out);
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *out);
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder);
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder);
+esp_err_t rmt_new_sync_manager(const rmt_sync_manager_config_t *config, rmt_sync_manager_handle_t *out);
+esp_err_t rmt_del_sync_manager(rmt_sync_manager_handle_t synchro);
+esp_err_t rmt_sync_reset(rmt_sync_manager_handle_t synchro);
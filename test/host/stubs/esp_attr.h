@@ -0,0 +1,4 @@
+/* Host stand-in for ESP-IDF esp_attr.h */
+#pragma once
+#define IRAM_ATTR
+#define DRAM_ATTR
@@ -0,0 +1,18 @@
+/* Host stand-in for ESP-IDF esp_log.h: errors go to stderr, warnings too with -DHOST_LOG_WARN */
+#pragma once
+#include <stdio.h>
+
+#ifdef HOST_LOG_WARN
+#define HOST_LOG_WARN_ENABLED 1
+#else
+#define HOST_LOG_WARN_ENABLED 0
+#endif
+
+/* Keeps the arguments used without checking formats written for 32-bit long */
+static inline void host_log_discard(const char *tag, ...) { (void)tag; }
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) do { if (HOST_LOG_WARN_ENABLED) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGI(tag, fmt, ...) host_log_discard(tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) host_log_discard(tag, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) host_log_discard(tag, ##__VA_ARGS__)
@@ -0,0 +1,22 @@
+/* Host stand-in for ESP-IDF esp_spiffs.h: the library base path is a plain directory */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct {
+    const char *base_path;
+    const char *partition_label;
+    size_t max_files;
+    bool format_if_mount_failed;
+} esp_vfs_spiffs_conf_t;
+
+static inline bool esp_spiffs_mounted(const char *partition_label)
+{
+    return true;
+}
+
+static inline esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t *conf)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,32 @@
+/* Host stand-in for FreeRTOS.h: types and constants; functions live in host_freertos.c */
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef void *SemaphoreHandle_t;
+typedef void *QueueHandle_t;
+typedef void *TaskHandle_t;
+typedef void *TimerHandle_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef int portMUX_TYPE;
+
+#define portMAX_DELAY               0xffffffffu
+#define pdTRUE                      1
+#define pdFALSE                     0
+#define pdPASS                      1
+#define pdFAIL                      0
+#define configTICK_RATE_HZ          100
+#define portTICK_PERIOD_MS          (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms) / portTICK_PERIOD_MS)
+#define portYIELD_FROM_ISR(x)       (void)(x)
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux)     (void)(mux)
+#define portEXIT_CRITICAL(mux)      (void)(mux)
+#define tskIDLE_PRIORITY            0
+#define configMAX_PRIORITIES        25
+#define configMAX_TASK_NAME_LEN     16
+
+typedef enum { eNoAction, eSetBits, eIncrement, eSetValueWithOverwrite } eNotifyAction;
@@ -0,0 +1,5 @@
+/* Host stand-in for ESP-IDF soc/soc_caps.h (ESP32-S3 values) */
+#pragma once
+#define SOC_RMT_TX_CANDIDATES_PER_GROUP     4
+#define SOC_RMT_RX_CANDIDATES_PER_GROUP     4
+#define SOC_RMT_MEM_WORDS_PER_CHANNEL       48
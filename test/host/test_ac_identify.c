@@ -0,0 +1,136 @@
+/**
+ * @file test_ac_identify.c
+ * @brief AC protocol identification over a synthetic capture corpus
+ *
+ * The corpus is every AC protocol transmitted in a spread of states,
+ * distorted like a demodulating receiver (marks stretched, spaces
+ * shortened, timing jitter) and decoded by:
+ * - the universal pulse distance decoder, as for an unknown remote;
+ * - the receive task's decoder chain, where the first decoder to accept
+ *   the frame wins, so a shorter protocol with the same timing (Panasonic
+ *   before Daikin, Fujitsu before Mitsubishi) must not claim it.
+ * Identification must rank the protocol that was sent first, with at
+ * least IR_AC_IDENTIFY_MIN_CONFIDENCE, from that single capture.
+ *
+ * MIT License
+ */
+
+#include "ac_capture.h"
+#include "ir_ac_state.h"
+#include "ir_distance_width.h"
+#include "host_test.h"
+#include <string.h>
+#include <time.h>
+
+#define STATES_PER_PROTOCOL     24
+
+/* Receiver distortions: mark stretch (us), jitter (%) */
+static const struct {
+    int stretch_us;
+    unsigned jitter_percent;
+} receivers[] = {
+    { 0, 0 },
+    { 60, 3 },
+    { -40, 5 },
+    { 100, 8 },
+};
+
+static unsigned identified;
+static unsigned captures;
+static double identify_ns;
+
+static void check_identified(const ir_code_t *code, ir_protocol_t expected, const char *path)
+{
+    ir_ac_match_t matches[IR_AC_IDENTIFY_MAX_MATCHES];
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    size_t count = ir_ac_identify_protocol(code, matches, IR_AC_IDENTIFY_MAX_MATCHES);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    identify_ns += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+    captures++;
+
+    bool ok = count > 0 && matches[0].protocol == expected &&
+              matches[0].confidence >= IR_AC_IDENTIFY_MIN_CONFIDENCE &&
+              (count == 1 || matches[1].confidence < matches[0].confidence);
+    if (!ok) {
+        fprintf(stderr, "%s capture of %s identified as %s (%u%%), runner-up %s (%u%%)\n",
+                path, ir_get_protocol_name(expected),
+                count ? ir_get_protocol_name(matches[0].protocol) : "-",
+                count ? matches[0].confidence : 0,
+                count > 1 ? ir_get_protocol_name(matches[1].protocol) : "-",
+                count > 1 ? matches[1].confidence : 0);
+    }
+    CHECK(ok);
+    identified += ok;
+
+    /* Ranked best first */
+    for (size_t i = 1; i < count; i++) {
+        CHECK(matches[i].confidence <= matches[i - 1].confidence);
+    }
+}
+
+static void test_corpus(void)
+{
+    rmt_symbol_word_t sent[AC_CAPTURE_MAX_SYMBOLS];
+    rmt_symbol_word_t received[AC_CAPTURE_MAX_SYMBOLS];
+
+    for (size_t p = 0; p < ac_capture_num_protocols; p++) {
+        ir_protocol_t protocol = ac_capture_protocols[p];
+
+        for (uint32_t index = 0; index < STATES_PER_PROTOCOL; index++) {
+            ac_state_t state;
+            ac_capture_state(protocol, index, &state);
+            size_t n = ac_capture_transmit(&state, false, sent, AC_CAPTURE_MAX_SYMBOLS);
+            CHECK(n > 0);
+
+            for (size_t r = 0; r < sizeof(receivers) / sizeof(receivers[0]); r++) {
+                memcpy(received, sent, n * sizeof(sent[0]));
+                ac_capture_distort(received, n, receivers[r].stretch_us,
+                                   receivers[r].jitter_percent, index * 31 + r);
+
+                ir_code_t code = {0};
+                if (ir_decode_distance_width(received, n, &code) == ESP_OK) {
+                    check_identified(&code, protocol, "universal");
+                } else {
+                    fprintf(stderr, "%s state %u: universal decoder failed\n",
+                            ir_get_protocol_name(protocol), (unsigned)index);
+                    CHECK(false);
+                }
+                ir_code_free(&code);
+
+                CHECK_EQ(ac_capture_receive(received, n, &code), ESP_OK);
+                check_identified(&code, protocol, ir_get_protocol_name(code.protocol));
+                ir_code_free(&code);
+            }
+        }
+    }
+
+    printf("identified %u of %u captures, %.2f us per identification\n",
+           identified, captures, identify_ns / captures / 1000);
+}
+
+static void test_not_ac(void)
+{
+    ir_ac_match_t matches[IR_AC_IDENTIFY_MAX_MATCHES];
+    ir_code_t nec = {
+        .protocol = IR_PROTOCOL_NEC,
+        .bits = 32,
+        .data = 0xF708FB04,
+    };
+
+    /* A TV remote never reaches the minimum confidence */
+    size_t count = ir_ac_identify_protocol(&nec, matches, IR_AC_IDENTIFY_MAX_MATCHES);
+    CHECK(count == 0 || matches[0].confidence < IR_AC_IDENTIFY_MIN_CONFIDENCE);
+
+    CHECK_EQ(ir_ac_identify_protocol(NULL, matches, 1), 0);
+    CHECK_EQ(ir_ac_identify_protocol(&nec, NULL, 1), 0);
+    CHECK_EQ(ir_ac_identify_protocol(&nec, matches, 0), 0);
+}
+
+int main(void)
+{
+    test_corpus();
+    test_not_ac();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,204 @@
+/**
+ * @file test_ac_roundtrip.c
+ * @brief Exact AC state round trips through the frame maps
+ *
+ * The contract of ir_ac_decode_frame(): for every state s of a protocol,
+ * decoding the encoded frame of s gives ir_ac_normalize_state(s).
+ * - Every state of every mapped protocol (all modes, temperatures, fan
+ *   speeds, swing modes and flags): normalize is idempotent, does not
+ *   change the encoded bytes, and decoding the frame gives it back.
+ * - A spread of states also goes on air through the template cache: the
+ *   patched symbols equal a full build, and the capture decodes to the
+ *   normalized state through the receive chain and through the universal
+ *   decoder, with and without receiver distortion.
+ *
+ * MIT License
+ */
+
+#include "ac_capture.h"
+#include "ir_ac_frame.h"
+#include "ir_ac_state.h"
+#include "ir_distance_width.h"
+#include "host_test.h"
+#include <string.h>
+
+/* Every Nth state also goes on air */
+#define AIR_STRIDE      37
+
+/**
+ * @brief Compare the fields @p map carries, report the first mismatch
+ */
+static bool same_fields(const ac_frame_map_t *map, const ac_state_t *a, const ac_state_t *b)
+{
+    for (uint8_t i = 0; i < map->num_fields; i++) {
+        int va, vb;
+        switch (map->fields[i].id) {
+            case AC_FIELD_POWER: va = a->power;       vb = b->power;       break;
+            case AC_FIELD_MODE:  va = a->mode;        vb = b->mode;        break;
+            case AC_FIELD_TEMP:  va = a->temperature; vb = b->temperature; break;
+            case AC_FIELD_FAN:   va = a->fan_speed;   vb = b->fan_speed;   break;
+            case AC_FIELD_SWING: va = a->swing;       vb = b->swing;       break;
+            case AC_FIELD_TURBO: va = a->turbo;       vb = b->turbo;       break;
+            case AC_FIELD_QUIET: va = a->quiet;       vb = b->quiet;       break;
+            case AC_FIELD_ECONO: va = a->econo;       vb = b->econo;       break;
+            case AC_FIELD_SLEEP: va = a->sleep;       vb = b->sleep;       break;
+            default:             continue;
+        }
+        if (va != vb) {
+            fprintf(stderr, "%s field %u: %d, expected %d\n", map->name, map->fields[i].id, va, vb);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Decode a capture as @p protocol and compare with @p expected
+ */
+static void check_decoded(const ir_code_t *code, const ac_frame_map_t *map, const ac_state_t *expected)
+{
+    ac_state_t decoded;
+    CHECK_EQ(ir_ac_decode_frame(code, map->protocol, &decoded), ESP_OK);
+    CHECK_EQ(decoded.protocol, map->protocol);
+    CHECK(same_fields(map, &decoded, expected));
+}
+
+/**
+ * @brief Send @p state on air and decode it back every way the device can
+ */
+static void check_on_air(const ac_frame_map_t *map, const ac_state_t *state,
+                         const ac_state_t *normalized, uint32_t seed)
+{
+    rmt_symbol_word_t patched[AC_CAPTURE_MAX_SYMBOLS];
+    rmt_symbol_word_t fresh[AC_CAPTURE_MAX_SYMBOLS];
+
+    /* The template cache patches the previous state's symbols */
+    size_t n = ac_capture_transmit(state, false, patched, AC_CAPTURE_MAX_SYMBOLS);
+    size_t fresh_n = ac_capture_transmit(state, true, fresh, AC_CAPTURE_MAX_SYMBOLS);
+    CHECK(n > 0);
+    CHECK_EQ(n, fresh_n);
+    CHECK(memcmp(patched, fresh, n * sizeof(patched[0])) == 0);
+
+    /* Clean, then through a receiver that stretches marks and jitters */
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            ac_capture_distort(patched, n, 60, 5, seed);
+        }
+
+        ir_code_t code = {0};
+        CHECK_EQ(ac_capture_receive(patched, n, &code), ESP_OK);
+        check_decoded(&code, map, normalized);
+        ir_code_free(&code);
+
+        CHECK_EQ(ir_decode_distance_width(patched, n, &code), ESP_OK);
+        check_decoded(&code, map, normalized);
+
+        /* Unknown remote: identify first, then decode */
+        ac_state_t decoded;
+        CHECK_EQ(ir_ac_decode_state(&code, &decoded), ESP_OK);
+        CHECK_EQ(decoded.protocol, map->protocol);
+        CHECK(same_fields(map, &decoded, normalized));
+        ir_code_free(&code);
+    }
+}
+
+static void test_protocol(ir_protocol_t protocol)
+{
+    const ac_frame_map_t *map = ir_ac_frame_get_map(protocol);
+    CHECK(map != NULL);
+    if (!map) {
+        return;
+    }
+
+    unsigned states = 0;
+    unsigned on_air = 0;
+    ac_state_t state = {0};
+    state.protocol = protocol;
+    state.is_learned = true;
+
+    for (int power = 0; power < 2; power++) {
+        for (int mode = 0; mode < AC_MODE_MAX; mode++) {
+            for (int temp = AC_TEMP_MIN; temp <= AC_TEMP_MAX; temp++) {
+                for (int fan = 0; fan < AC_FAN_MAX; fan++) {
+                    for (int swing = 0; swing < AC_SWING_MAX; swing++) {
+                        for (int flags = 0; flags < 16; flags++) {
+                            state.power = power;
+                            state.mode = (ac_mode_t)mode;
+                            state.temperature = (uint8_t)temp;
+                            state.fan_speed = (ac_fan_speed_t)fan;
+                            state.swing = (ac_swing_t)swing;
+                            state.turbo = flags & 1;
+                            state.quiet = (flags >> 1) & 1;
+                            state.econo = (flags >> 2) & 1;
+                            state.sleep = (flags >> 3) & 1;
+
+                            ac_state_t normalized = state;
+                            CHECK_EQ(ir_ac_normalize_state(&normalized), ESP_OK);
+                            ac_state_t twice = normalized;
+                            CHECK_EQ(ir_ac_normalize_state(&twice), ESP_OK);
+                            CHECK(memcmp(&twice, &normalized, sizeof(twice)) == 0);
+
+                            /* Normalizing never changes what goes on air */
+                            ir_code_t code = {0};
+                            ir_code_t code_normalized = {0};
+                            size_t len, len_normalized;
+                            CHECK_EQ(ir_ac_encode_state(&state, &code), ESP_OK);
+                            CHECK_EQ(ir_ac_encode_state(&normalized, &code_normalized), ESP_OK);
+                            const uint8_t *bytes = ir_code_get_payload(&code, &len);
+                            const uint8_t *bytes_normalized = ir_code_get_payload(&code_normalized,
+                                                                                  &len_normalized);
+                            CHECK_EQ(len, map->num_bytes);
+                            CHECK(len == len_normalized && memcmp(bytes, bytes_normalized, len) == 0);
+                            ir_code_free(&code_normalized);
+
+                            check_decoded(&code, map, &normalized);
+                            ir_code_free(&code);
+
+                            if (states % AIR_STRIDE == 0) {
+                                check_on_air(map, &state, &normalized, states);
+                                on_air++;
+                            }
+                            states++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    printf("%-10s %u states, %u on air\n", map->name, states, on_air);
+}
+
+static void test_invalid(void)
+{
+    ac_state_t state;
+    ir_code_t nec = {
+        .protocol = IR_PROTOCOL_NEC,
+        .bits = 32,
+        .data = 0xF708FB04,
+    };
+
+    CHECK_EQ(ir_ac_decode_frame(&nec, IR_PROTOCOL_NEC, &state), ESP_ERR_NOT_SUPPORTED);
+    CHECK_EQ(ir_ac_decode_frame(NULL, IR_PROTOCOL_DAIKIN, &state), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(ir_ac_decode_frame(&nec, IR_PROTOCOL_DAIKIN, NULL), ESP_ERR_INVALID_ARG);
+
+    /* A short frame is not read past its end */
+    uint8_t bytes[4] = { 0x11, 0xDA, 0x27, 0x00 };
+    ir_code_t code = { .protocol = IR_PROTOCOL_DAIKIN };
+    CHECK_EQ(ir_code_set_payload(&code, bytes, sizeof(bytes)), ESP_OK);
+    CHECK_EQ(ir_ac_decode_frame(&code, IR_PROTOCOL_DAIKIN, &state), ESP_ERR_INVALID_SIZE);
+    ir_code_free(&code);
+
+    state.protocol = IR_PROTOCOL_NEC;
+    CHECK_EQ(ir_ac_normalize_state(&state), ESP_ERR_NOT_SUPPORTED);
+    CHECK_EQ(ir_ac_normalize_state(NULL), ESP_ERR_INVALID_ARG);
+}
+
+int main(void)
+{
+    for (size_t p = 0; p < ac_capture_num_protocols; p++) {
+        test_protocol(ac_capture_protocols[p]);
+    }
+    test_invalid();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,421 @@
+/**
+ * @file test_biphase.c
+ * @brief Bi-phase encoders against their decoders
+ *
+ * - RC5, RC6-0-16, RC6-6-20/24/32 and B&O codes built into symbols
+ *   decode back to the same code, and rebuilding the decoded code gives
+ *   the same symbols.
+ * - RC6 codes stored as a bare 32-bit payload (bits = 32, before the
+ *   mode was kept) go out as RC6-6-32 and decode with their toggle.
+ * - The same frames still decode when every half-bit arrives as its own
+ *   run instead of merged with its neighbour, and with the mark
+ *   stretching and random jitter of a real receiver.
+ * - Runs off the unit grid, truncated frames and the other protocol's
+ *   frames are rejected.
+ *
+ * MIT License
+ */
+
+#include "ir_biphase.h"
+#include "ir_rc5.h"
+#include "ir_rc6.h"
+#include "ir_bang_olufsen.h"
+#include "host_test.h"
+#include <string.h>
+
+#define MAX_SYMBOLS     96
+
+/* Receiver distortion: marks stretched by this much, spaces shortened */
+#define MARK_STRETCH_US 120
+
+static uint32_t rng = 2718;
+
+static int random_offset(int range)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 16) % (2 * range + 1)) - range;
+}
+
+/* ============================================================================
+ * CODES
+ * ============================================================================ */
+
+static ir_code_t rc5_code(uint8_t toggle, uint8_t address, uint8_t command)
+{
+    ir_code_t code = { .protocol = IR_PROTOCOL_RC5, .bits = RC5_BITS };
+    uint32_t s2 = (command & 0x40) ? 0 : 1;             // RC5X: inverted command bit 6
+    code.data = (1u << 13) | (s2 << 12) | ((uint32_t)toggle << 11) |
+                ((uint32_t)(address & 0x1F) << 6) | (command & 0x3F);
+    return code;
+}
+
+/* RC6 with a payload of up to 24 bits: value = mode, trailer, payload */
+static ir_code_t rc6_code(uint8_t mode, uint8_t trailer, uint8_t payload_bits, uint32_t payload)
+{
+    ir_code_t code = { .protocol = IR_PROTOCOL_RC6, .bits = RC6_MODE_BITS + 1 + payload_bits };
+    code.data = ((uint32_t)mode << (payload_bits + 1)) | ((uint32_t)trailer << payload_bits) | payload;
+    return code;
+}
+
+static ir_code_t rc6_32_code(uint8_t mode, uint8_t trailer, uint32_t payload)
+{
+    ir_code_t code = { .protocol = IR_PROTOCOL_RC6, .bits = RC6_MODE_BITS + 1 + 32 };
+    uint8_t bytes[5] = {
+        payload & 0xFF, (payload >> 8) & 0xFF, (payload >> 16) & 0xFF, payload >> 24,
+        (uint8_t)((mode << 1) | trailer),
+    };
+    CHECK_EQ(ir_code_set_payload(&code, bytes, sizeof(bytes)), ESP_OK);
+    return code;
+}
+
+static ir_code_t beo_code(uint8_t bits, uint32_t value)
+{
+    ir_code_t code = { .protocol = IR_PROTOCOL_BANG_OLUFSEN, .bits = bits, .data = value };
+    return code;
+}
+
+typedef size_t (*build_fn_t)(const ir_code_t *code, rmt_symbol_word_t *symbols, size_t max_symbols);
+typedef esp_err_t (*decode_fn_t)(const rmt_symbol_word_t *symbols, size_t num_symbols, ir_code_t *code);
+
+static bool same_payload(const ir_code_t *a, const ir_code_t *b)
+{
+    size_t len_a, len_b;
+    const uint8_t *pa = ir_code_get_payload(a, &len_a);
+    const uint8_t *pb = ir_code_get_payload(b, &len_b);
+    return len_a == len_b && (len_a == 0 || memcmp(pa, pb, len_a) == 0);
+}
+
+/* ============================================================================
+ * CAPTURES
+ * ============================================================================ */
+
+/**
+ * @brief Split every run into single-unit runs of the same level
+ *
+ * The RMT reports whole runs, but the engine must not care how a run is
+ * cut into half-symbols.
+ */
+static size_t split_halves(const rmt_symbol_word_t *in, size_t count, uint16_t unit_us,
+                           rmt_symbol_word_t *out, size_t max_out)
+{
+    uint16_t durations[4 * MAX_SYMBOLS];
+    uint8_t levels[4 * MAX_SYMBOLS];
+    size_t halves = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint16_t dur[2] = { in[i].duration0, in[i].duration1 };
+        uint8_t lvl[2] = { in[i].level0, in[i].level1 };
+        for (int h = 0; h < 2; h++) {
+            uint16_t left = dur[h];
+            /* Leave the final idle gap whole */
+            while (left > unit_us && left < unit_us * IR_BIPHASE_MAX_RUN_UNITS &&
+                   halves < 4 * MAX_SYMBOLS - 1) {
+                durations[halves] = unit_us;
+                levels[halves++] = lvl[h];
+                left -= unit_us;
+            }
+            durations[halves] = left;
+            levels[halves++] = lvl[h];
+        }
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i + 1 < halves && n < max_out; i += 2) {
+        out[n++] = (rmt_symbol_word_t) {
+            .level0 = levels[i], .duration0 = durations[i],
+            .level1 = levels[i + 1], .duration1 = durations[i + 1],
+        };
+    }
+    return n;
+}
+
+/* Stretch marks, shorten the spaces after them, then add random jitter */
+static void distort(rmt_symbol_word_t *symbols, size_t count, int stretch_us, int jitter_us)
+{
+    for (size_t i = 0; i < count; i++) {
+        symbols[i].duration0 += stretch_us + random_offset(jitter_us);
+        symbols[i].duration1 -= stretch_us - random_offset(jitter_us);
+    }
+}
+
+/**
+ * @brief Build @p code, decode it as built, split and distorted, and rebuild
+ *
+ * Half-bit splitting and mark stretching apply to bi-phase frames, those
+ * with a @p unit_us.
+ *
+ * @param decoded Output: the code decoded from the clean capture
+ */
+static void check_round_trip(const char *name, const ir_code_t *code, build_fn_t build,
+                             decode_fn_t decode, uint16_t unit_us, int jitter_us,
+                             ir_code_t *decoded)
+{
+    rmt_symbol_word_t symbols[MAX_SYMBOLS];
+    rmt_symbol_word_t capture[MAX_SYMBOLS];
+    size_t count = build(code, symbols, MAX_SYMBOLS);
+    if (count == 0) {
+        fprintf(stderr, "%s: not built\n", name);
+        CHECK(count > 0);
+        return;
+    }
+
+    memset(decoded, 0, sizeof(*decoded));
+    CHECK_EQ(decode(symbols, count, decoded), ESP_OK);
+    CHECK_EQ(decoded->protocol, code->protocol);
+
+    /* The decoded code goes out exactly as the original */
+    size_t rebuilt_count = build(decoded, capture, MAX_SYMBOLS);
+    CHECK_EQ(rebuilt_count, count);
+    CHECK(memcmp(capture, symbols, count * sizeof(symbols[0])) == 0);
+
+    if (unit_us > 0) {
+        size_t split = split_halves(symbols, count, unit_us, capture, MAX_SYMBOLS);
+        ir_code_t from_split = { 0 };
+        CHECK_EQ(decode(capture, split, &from_split), ESP_OK);
+        CHECK_EQ(from_split.bits, decoded->bits);
+        CHECK(same_payload(&from_split, decoded));
+        ir_code_free(&from_split);
+    }
+
+    for (int pass = 0; pass < 8; pass++) {
+        memcpy(capture, symbols, count * sizeof(symbols[0]));
+        if (pass == 0 && unit_us > 0) {
+            distort(capture, count, MARK_STRETCH_US, 0);
+        } else {
+            distort(capture, count, 0, jitter_us);
+        }
+        ir_code_t from_air = { 0 };
+        esp_err_t err = decode(capture, count, &from_air);
+        if (err != ESP_OK || !same_payload(&from_air, decoded)) {
+            fprintf(stderr, "%s: distorted capture %d does not decode\n", name, pass);
+        }
+        CHECK_EQ(err, ESP_OK);
+        CHECK_EQ(from_air.bits, decoded->bits);
+        CHECK(same_payload(&from_air, decoded));
+        ir_code_free(&from_air);
+    }
+}
+
+/* ============================================================================
+ * RC5
+ * ============================================================================ */
+
+static void test_rc5(void)
+{
+    static const uint8_t commands[] = { 0x00, 0x01, 0x0C, 0x2A, 0x3F, 0x40, 0x55, 0x7F };
+
+    for (uint8_t address = 0; address < 32; address += 5) {
+        for (size_t c = 0; c < sizeof(commands); c++) {
+            for (uint8_t toggle = 0; toggle < 2; toggle++) {
+                ir_code_t code = rc5_code(toggle, address, commands[c]);
+                ir_code_t decoded;
+                check_round_trip("RC5", &code, ir_rc5_build_symbols, ir_decode_rc5,
+                                 RC5_UNIT, 200, &decoded);
+                CHECK_EQ(decoded.bits, RC5_BITS);
+                CHECK_EQ(decoded.data, code.data);
+                CHECK_EQ(decoded.address, address);
+                CHECK_EQ(decoded.command, commands[c]);
+                CHECK_EQ((decoded.flags & IR_FLAG_TOGGLE_BIT) != 0, toggle);
+            }
+        }
+    }
+
+    ir_code_t wrong_bits = rc5_code(0, 1, 1);
+    wrong_bits.bits = 12;
+    rmt_symbol_word_t symbols[MAX_SYMBOLS];
+    CHECK_EQ(ir_rc5_build_symbols(&wrong_bits, symbols, MAX_SYMBOLS), 0);
+}
+
+/* ============================================================================
+ * RC6
+ * ============================================================================ */
+
+static void test_rc6_short(void)
+{
+    static const struct {
+        uint8_t mode;
+        uint8_t payload_bits;
+        uint32_t payload;
+    } cases[] = {
+        { 0, 16, 0x0000 }, { 0, 16, 0x040C }, { 0, 16, 0xFFFF }, { 0, 16, 0xA55A },
+        { 6, 16, 0x1234 },
+        { 6, 20, 0x00000 }, { 6, 20, 0xC00C0 }, { 6, 20, 0xFFFFF }, { 6, 20, 0x5A5A5 },
+        { 6, 24, 0x000000 }, { 6, 24, 0x80ABCD }, { 6, 24, 0xFFFFFF }, { 3, 24, 0x123456 },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        for (uint8_t trailer = 0; trailer < 2; trailer++) {
+            ir_code_t code = rc6_code(cases[i].mode, trailer, cases[i].payload_bits, cases[i].payload);
+            ir_code_t decoded;
+            check_round_trip("RC6", &code, ir_rc6_build_symbols, ir_decode_rc6,
+                             RC6_UNIT, 100, &decoded);
+            CHECK_EQ(decoded.bits, code.bits);
+            CHECK_EQ(decoded.data, code.data);
+            CHECK_EQ(decoded.address, (uint16_t)(cases[i].payload >> 8));
+            CHECK_EQ(decoded.command, cases[i].payload & 0xFF);
+            CHECK_EQ((decoded.flags & IR_FLAG_TOGGLE_BIT) != 0, trailer);
+        }
+    }
+
+    /* Mode 0 only has 16-bit payloads */
+    ir_code_t bad_mode = rc6_code(0, 0, 20, 0x12345);
+    rmt_symbol_word_t symbols[MAX_SYMBOLS];
+    CHECK_EQ(ir_rc6_build_symbols(&bad_mode, symbols, MAX_SYMBOLS), 0);
+}
+
+static void test_rc6_32(void)
+{
+    static const uint32_t payloads[] = { 0x00000000, 0x12345678, 0xFFFFFFFF, 0x800F040C, 0x800F840C };
+
+    for (size_t i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++) {
+        for (uint8_t trailer = 0; trailer < 2; trailer++) {
+            ir_code_t code = rc6_32_code(6, trailer, payloads[i]);
+            ir_code_t decoded;
+            check_round_trip("RC6-6-32", &code, ir_rc6_build_symbols, ir_decode_rc6,
+                             RC6_UNIT, 100, &decoded);
+            CHECK_EQ(decoded.bits, RC6_MODE_BITS + 1 + 32);
+            CHECK(same_payload(&decoded, &code));
+            CHECK_EQ(decoded.data, payloads[i]);
+            CHECK_EQ(decoded.command, payloads[i] & 0xFF);
+
+            /* MCE carries its toggle in payload bit 15 and keeps it out of the address */
+            bool mce = (payloads[i] >> 16) == RC6_MCE_CUSTOMER;
+            bool toggle = mce ? (payloads[i] & RC6_MCE_TOGGLE_MASK) != 0 : trailer;
+            CHECK_EQ((decoded.flags & IR_FLAG_TOGGLE_BIT) != 0, toggle);
+            CHECK_EQ(decoded.address, mce ? (uint16_t)(payloads[i] >> 8) & ~(RC6_MCE_TOGGLE_MASK >> 8)
+                                          : (uint16_t)(payloads[i] >> 8));
+            ir_code_free(&decoded);
+            ir_code_free(&code);
+        }
+    }
+}
+
+/* Codes saved with bits = 32 hold the payload only; they go out as RC6-6-32 */
+static void test_rc6_legacy_32(void)
+{
+    static const uint32_t payloads[] = { 0x800F040C, 0x800F8410, 0x00000001 };
+
+    for (size_t i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++) {
+        for (uint8_t toggle = 0; toggle < 2; toggle++) {
+            ir_code_t legacy = { .protocol = IR_PROTOCOL_RC6, .bits = 32, .data = payloads[i] };
+            legacy.flags = toggle ? IR_FLAG_TOGGLE_BIT : 0;
+
+            ir_code_t expected = rc6_32_code(6, toggle, payloads[i]);
+            rmt_symbol_word_t legacy_symbols[MAX_SYMBOLS];
+            rmt_symbol_word_t expected_symbols[MAX_SYMBOLS];
+            size_t count = ir_rc6_build_symbols(&legacy, legacy_symbols, MAX_SYMBOLS);
+            CHECK(count > 0);
+            CHECK_EQ(ir_rc6_build_symbols(&expected, expected_symbols, MAX_SYMBOLS), count);
+            CHECK(memcmp(legacy_symbols, expected_symbols, count * sizeof(legacy_symbols[0])) == 0);
+
+            ir_code_t decoded = { 0 };
+            CHECK_EQ(ir_decode_rc6(legacy_symbols, count, &decoded), ESP_OK);
+            CHECK_EQ(decoded.bits, RC6_MODE_BITS + 1 + 32);
+            CHECK_EQ(decoded.data, payloads[i]);
+            CHECK(same_payload(&decoded, &expected));
+            ir_code_free(&decoded);
+            ir_code_free(&expected);
+        }
+    }
+}
+
+/* ============================================================================
+ * B&O
+ * ============================================================================ */
+
+static void test_bang_olufsen(void)
+{
+    static const struct {
+        uint8_t bits;
+        uint32_t value;
+    } cases[] = {
+        { 16, 0x0000 }, { 16, 0xFFFF }, { 16, 0x0035 }, { 16, 0xA55A }, { 16, 0x8001 },
+        { 8, 0x5C }, { 24, 0x123456 }, { 32, 0xDEADBEEF },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ir_code_t code = beo_code(cases[i].bits, cases[i].value);
+        ir_code_t decoded;
+        /* Pulse-position code: no half-bits to split */
+        check_round_trip("B&O", &code, ir_bang_olufsen_build_symbols, ir_decode_bang_olufsen,
+                         0, BEO_MARK_TOLERANCE / 2, &decoded);
+        CHECK_EQ(decoded.bits, cases[i].bits);
+        CHECK_EQ(decoded.data, cases[i].value);
+        CHECK_EQ(decoded.command, cases[i].value & 0xFF);
+    }
+
+    /* Without the "0 0" prefix */
+    ir_code_t code = beo_code(16, 0x0135);
+    rmt_symbol_word_t symbols[MAX_SYMBOLS];
+    size_t count = ir_bang_olufsen_build_symbols(&code, symbols, MAX_SYMBOLS);
+    ir_code_t decoded = { 0 };
+    CHECK_EQ(ir_decode_bang_olufsen(&symbols[2], count - 2, &decoded), ESP_OK);
+    CHECK_EQ(decoded.data, 0x0135);
+
+    /* A pulse period between units */
+    symbols[5].duration1 += BEO_UNIT / 2;
+    CHECK_EQ(ir_decode_bang_olufsen(symbols, count, &decoded), ESP_FAIL);
+
+    code.bits = BEO_MAX_BITS + 1;
+    CHECK_EQ(ir_bang_olufsen_build_symbols(&code, symbols, MAX_SYMBOLS), 0);
+}
+
+/* ============================================================================
+ * REJECTS
+ * ============================================================================ */
+
+static void test_rejects(void)
+{
+    rmt_symbol_word_t symbols[MAX_SYMBOLS];
+    rmt_symbol_word_t capture[MAX_SYMBOLS];
+    ir_code_t decoded = { 0 };
+
+    ir_code_t rc5 = rc5_code(1, 0x14, 0x21);
+    size_t rc5_count = ir_rc5_build_symbols(&rc5, symbols, MAX_SYMBOLS);
+    CHECK_EQ(ir_decode_rc6(symbols, rc5_count, &decoded), ESP_FAIL);
+
+    /* A run halfway between one and two units */
+    memcpy(capture, symbols, rc5_count * sizeof(symbols[0]));
+    capture[2].duration0 = RC5_UNIT * 3 / 2;
+    CHECK_EQ(ir_decode_rc5(capture, rc5_count, &decoded), ESP_FAIL);
+
+    /* Frame cut short by an early idle gap */
+    memcpy(capture, symbols, rc5_count * sizeof(symbols[0]));
+    capture[3].duration1 = RC5_UNIT * (IR_BIPHASE_MAX_RUN_UNITS + 1);
+    CHECK(ir_decode_rc5(capture, rc5_count, &decoded) != ESP_OK);
+
+    /* Too short to be a frame at all */
+    CHECK_EQ(ir_decode_rc5(symbols, 3, &decoded), ESP_ERR_INVALID_ARG);
+
+    ir_code_t rc6 = rc6_code(0, 0, 16, 0x040C);
+    size_t rc6_count = ir_rc6_build_symbols(&rc6, symbols, MAX_SYMBOLS);
+    CHECK_EQ(ir_decode_rc5(symbols, rc6_count, &decoded), ESP_FAIL);
+
+    /* Leader mark one unit short */
+    memcpy(capture, symbols, rc6_count * sizeof(symbols[0]));
+    capture[0].duration0 -= RC6_UNIT;
+    CHECK_EQ(ir_decode_rc6(capture, rc6_count, &decoded), ESP_FAIL);
+
+    /* Trailer bit sent single length: the payload no longer lines up */
+    ir_biphase_config_t single_trailer = {
+        .unit_us = RC6_UNIT,
+        .leader_mark_units = RC6_LEADER_MARK_UNITS,
+        .leader_space_units = RC6_LEADER_SPACE_UNITS,
+        .one_is_mark_first = true,
+    };
+    size_t count = ir_biphase_build_symbols(&single_trailer, (1ULL << 20) | rc6.data, 21, -1,
+                                            capture, MAX_SYMBOLS);
+    CHECK(count > 0);
+    CHECK_EQ(ir_decode_rc6(capture, count, &decoded), ESP_FAIL);
+}
+
+int main(void)
+{
+    test_rc5();
+    test_rc6_short();
+    test_rc6_32();
+    test_rc6_legacy_32();
+    test_bang_olufsen();
+    test_rejects();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,143 @@
+/**
+ * @file test_carrier_detect.c
+ * @brief Carrier estimator on synthetic photodiode edge streams
+ *
+ * Frames are built the way the raw capture sees them at the 40 MHz
+ * carrier RX resolution: every mark is a run of ON/OFF carrier cycles
+ * with a little edge jitter, marks are separated by long OFF gaps.
+ *
+ * MIT License
+ */
+
+#include "ir_carrier_detect.h"
+#include "host_test.h"
+#include <string.h>
+
+#define TICK_HZ         40000000    // CARRIER_RX_RESOLUTION_HZ in ir_control.c
+#define MAX_EDGES       4096
+
+static uint32_t edges[MAX_EDGES];
+static uint32_t rng = 1;
+
+/* +-1 tick of edge jitter, deterministic */
+static int jitter(void)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 16) % 3) - 1;
+}
+
+/**
+ * @brief Append @p cycles carrier cycles followed by a gap of @p gap_us
+ */
+static size_t add_mark(size_t n, uint32_t carrier_hz, uint8_t duty_percent, unsigned cycles,
+                       uint32_t gap_us)
+{
+    uint32_t period = TICK_HZ / carrier_hz;
+    uint32_t on = period * duty_percent / 100;
+
+    for (unsigned c = 0; c < cycles && n + 2 <= MAX_EDGES; c++) {
+        edges[n++] = on + jitter();
+        edges[n++] = period - on + jitter();
+    }
+    /* The last OFF runs into the gap between marks */
+    edges[n - 1] += gap_us * (TICK_HZ / 1000000);
+    return n;
+}
+
+/**
+ * @brief NEC-like frame: 9 ms header mark, then 560 us marks
+ */
+static size_t build_frame(uint32_t carrier_hz, uint8_t duty_percent)
+{
+    size_t n = add_mark(0, carrier_hz, duty_percent, 9000 * carrier_hz / 1000000, 4500);
+    for (int bit = 0; bit < 32; bit++) {
+        n = add_mark(n, carrier_hz, duty_percent, 560 * carrier_hz / 1000000, bit & 1 ? 1690 : 560);
+    }
+    return n;
+}
+
+static void check_carrier(uint32_t carrier_hz, uint8_t duty_percent)
+{
+    ir_carrier_estimate_t est;
+    size_t n = build_frame(carrier_hz, duty_percent);
+
+    CHECK(ir_carrier_estimate(edges, n, TICK_HZ, &est));
+    /* Within 0.5% of the carrier actually synthesized (whole tick periods) */
+    uint32_t sent_hz = TICK_HZ / (TICK_HZ / carrier_hz);
+    CHECK(est.frequency_hz * 1000ull >= sent_hz * 995ull && est.frequency_hz * 1000ull <= sent_hz * 1005ull);
+    CHECK(est.duty_percent + 2 >= duty_percent && est.duty_percent <= duty_percent + 2);
+    CHECK(est.cycles >= IR_CARRIER_MIN_CYCLES);
+    CHECK_EQ(ir_carrier_normalize(est.frequency_hz), carrier_hz);
+}
+
+static void test_common_carriers(void)
+{
+    check_carrier(38000, 33);
+    check_carrier(36000, 50);
+    check_carrier(40000, 25);
+    check_carrier(56000, 33);
+    check_carrier(455000, 50);     // B&O
+}
+
+static void test_first_mark_only(void)
+{
+    ir_carrier_estimate_t est;
+    size_t n = add_mark(0, 38000, 33, 20, 0);
+
+    CHECK(ir_carrier_estimate(edges, n, TICK_HZ, &est));
+    CHECK_EQ(ir_carrier_normalize(est.frequency_hz), 38000);
+}
+
+static void test_glitches_rejected(void)
+{
+    ir_carrier_estimate_t est;
+    size_t n = build_frame(38000, 33);
+
+    /* A few runts and a doubled cycle do not move the median */
+    edges[10] = 3;
+    edges[11] = 4;
+    edges[40] += edges[42] + edges[43];
+    CHECK(ir_carrier_estimate(edges, n, TICK_HZ, &est));
+    CHECK_EQ(ir_carrier_normalize(est.frequency_hz), 38000);
+}
+
+static void test_no_carrier(void)
+{
+    ir_carrier_estimate_t est;
+
+    /* Too few cycles */
+    size_t n = add_mark(0, 38000, 33, IR_CARRIER_MIN_CYCLES - 1, 0);
+    CHECK(!ir_carrier_estimate(edges, n, TICK_HZ, &est));
+
+    /* A demodulated stream: only marks and spaces, no sub-carrier edges */
+    for (n = 0; n < 64; n += 2) {
+        edges[n] = 560 * (TICK_HZ / 1000000);
+        edges[n + 1] = 1690 * (TICK_HZ / 1000000);
+    }
+    CHECK(!ir_carrier_estimate(edges, n, TICK_HZ, &est));
+
+    CHECK(!ir_carrier_estimate(NULL, 10, TICK_HZ, &est));
+    CHECK(!ir_carrier_estimate(edges, 1, TICK_HZ, &est));
+    CHECK(!ir_carrier_estimate(edges, n, 0, &est));
+}
+
+static void test_normalize(void)
+{
+    CHECK_EQ(ir_carrier_normalize(37200), 38000);
+    CHECK_EQ(ir_carrier_normalize(38900), 38000);
+    CHECK_EQ(ir_carrier_normalize(39100), 40000);
+    CHECK_EQ(ir_carrier_normalize(35100), 36000);
+    CHECK_EQ(ir_carrier_normalize(440000), 455000);
+    CHECK_EQ(ir_carrier_normalize(47040), 47000);
+    CHECK_EQ(ir_carrier_normalize(47060), 47100);
+}
+
+int main(void)
+{
+    test_common_carriers();
+    test_first_mark_only();
+    test_glitches_rejected();
+    test_no_carrier();
+    test_normalize();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,397 @@
+/**
+ * @file test_code_table.c
+ * @brief Lock-free code table reads against a concurrent writer
+ *
+ * Built with ThreadSanitizer. The emitter is modelled by a transmitter
+ * thread that sends queued frames some time after ir_transmit_span_async()
+ * returned, reading the symbols in place as the RMT does.
+ * - Put, contains and transmit on one thread: hit and miss counters,
+ *   render errors, invalid slots, a full arena leaving the slot empty.
+ * - A replaced span is not reused while a frame of it is still queued;
+ *   the grace wait is counted, and the words come back once the emitter
+ *   is idle.
+ * - Four readers transmit while the writer puts, removes and clears rows:
+ *   every frame, when queued and when sent, carries the symbols of a code
+ *   its slot held.
+ * - With readers and frames done, clearing the table frees every word.
+ *
+ * MIT License
+ */
+
+#include "ir_code_table.h"
+#include "host_test.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define QUEUE_LEN       8
+#define NUM_READERS     4
+#define TEST_ROWS       3       // Rows 1..3
+#define TEST_COLS       8
+#define CARRIER_HZ      38000
+
+/* ============================================================================
+ * EMITTER MODEL
+ * ============================================================================ */
+
+/*
+ * Code id n renders to 3n symbols; symbol i is (n << 16) | i. The id
+ * travels as the duty cycle, which the span header keeps.
+ */
+static size_t code_len(uint8_t id)
+{
+    return 3u * id;
+}
+
+typedef struct {
+    const uint32_t *symbols;
+    size_t num_symbols;
+    uint8_t id;
+} frame_t;
+
+static pthread_mutex_t tx_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tx_cond = PTHREAD_COND_INITIALIZER;
+static frame_t queue[QUEUE_LEN];
+static size_t queue_head = 0;
+static size_t queue_count = 0;
+static bool tx_sending = false;
+static bool tx_hold = false;            // Keep frames queued
+static bool tx_stop = false;
+
+static atomic_uint bad_frames;
+static atomic_uint frames_sent;
+
+static void frame_check(const uint32_t *symbols, size_t num_symbols, uint8_t id)
+{
+    bool ok = num_symbols == code_len(id);
+    for (size_t i = 0; ok && i < num_symbols; i++) {
+        ok = symbols[i] == ((uint32_t)id << 16 | i);
+    }
+    if (!ok) {
+        atomic_fetch_add(&bad_frames, 1);
+    }
+}
+
+esp_err_t ir_render_code(const ir_code_t *code, void **symbols, size_t *num_symbols)
+{
+    if (code->protocol == IR_PROTOCOL_UNKNOWN) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    uint8_t id = code->duty_cycle_percent;
+    uint32_t *words = malloc(code_len(id) * sizeof(uint32_t));
+    if (words == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < code_len(id); i++) {
+        words[i] = (uint32_t)id << 16 | i;
+    }
+    *symbols = words;
+    *num_symbols = code_len(id);
+    return ESP_OK;
+}
+
+esp_err_t ir_transmit_span_async(uint8_t emitter, const ir_code_t *code,
+                                 const void *symbols, size_t num_symbols)
+{
+    if (code->carrier_freq_hz != CARRIER_HZ || code->protocol != IR_PROTOCOL_NEC) {
+        atomic_fetch_add(&bad_frames, 1);
+    }
+    frame_check(symbols, num_symbols, code->duty_cycle_percent);
+
+    pthread_mutex_lock(&tx_lock);
+    while (queue_count == QUEUE_LEN) {
+        pthread_cond_wait(&tx_cond, &tx_lock);
+    }
+    queue[(queue_head + queue_count) % QUEUE_LEN] = (frame_t) {
+        .symbols = symbols,
+        .num_symbols = num_symbols,
+        .id = code->duty_cycle_percent,
+    };
+    queue_count++;
+    pthread_cond_broadcast(&tx_cond);
+    pthread_mutex_unlock(&tx_lock);
+    return ESP_OK;
+}
+
+static bool tx_idle(void)
+{
+    return queue_count == 0 && !tx_sending;
+}
+
+esp_err_t ir_tx_wait_all_done(uint32_t timeout_ms)
+{
+    pthread_mutex_lock(&tx_lock);
+    while (timeout_ms > 0 && !tx_idle() && !tx_hold) {
+        pthread_cond_wait(&tx_cond, &tx_lock);
+    }
+    bool idle = tx_idle();
+    pthread_mutex_unlock(&tx_lock);
+    return idle ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t ir_tx_wait_done(uint8_t emitter, uint32_t timeout_ms)
+{
+    return ir_tx_wait_all_done(timeout_ms);
+}
+
+const char *ir_get_protocol_name(ir_protocol_t protocol)
+{
+    return protocol == IR_PROTOCOL_NEC ? "NEC" : "UNKNOWN";
+}
+
+/* Sends queued frames later, reading the symbols where they were queued */
+static void *transmitter(void *arg)
+{
+    pthread_mutex_lock(&tx_lock);
+    for (;;) {
+        while (!tx_stop && (queue_count == 0 || tx_hold)) {
+            pthread_cond_wait(&tx_cond, &tx_lock);
+        }
+        if (tx_stop) {
+            break;
+        }
+        frame_t frame = queue[queue_head];
+        queue_head = (queue_head + 1) % QUEUE_LEN;
+        queue_count--;
+        tx_sending = true;
+        pthread_mutex_unlock(&tx_lock);
+
+        sched_yield();
+        frame_check(frame.symbols, frame.num_symbols, frame.id);
+        atomic_fetch_add(&frames_sent, 1);
+
+        pthread_mutex_lock(&tx_lock);
+        tx_sending = false;
+        pthread_cond_broadcast(&tx_cond);
+    }
+    pthread_mutex_unlock(&tx_lock);
+    return NULL;
+}
+
+static void tx_set_hold(bool hold)
+{
+    pthread_mutex_lock(&tx_lock);
+    tx_hold = hold;
+    pthread_cond_broadcast(&tx_cond);
+    pthread_mutex_unlock(&tx_lock);
+}
+
+static ir_code_t make_code(uint8_t id)
+{
+    ir_code_t code = {
+        .protocol = IR_PROTOCOL_NEC,
+        .carrier_freq_hz = CARRIER_HZ,
+        .duty_cycle_percent = id,
+    };
+    return code;
+}
+
+static uint16_t words_used(void)
+{
+    ir_code_table_stats_t stats;
+    ir_code_table_get_stats(&stats);
+    return stats.words_used;
+}
+
+static void table_clear(void)
+{
+    for (uint8_t row = 0; row < IR_CODE_TABLE_ROWS; row++) {
+        ir_code_table_clear_row(row);
+    }
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================ */
+
+static void test_basic(void)
+{
+    ir_code_table_stats_t stats;
+    ir_code_t code = make_code(7);
+
+    CHECK_EQ(ir_code_table_put(1, 0, &code), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(ir_code_table_init(), ESP_OK);
+    CHECK_EQ(ir_code_table_init(), ESP_OK);
+
+    CHECK_EQ(ir_code_table_put(IR_CODE_TABLE_ROWS, 0, &code), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(ir_code_table_put(1, IR_CODE_TABLE_COLS, &code), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(ir_code_table_put(1, 0, NULL), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(ir_code_table_transmit(IR_CODE_TABLE_ROWS, 0, 0, false), ESP_ERR_INVALID_ARG);
+    CHECK(!ir_code_table_contains(1, IR_CODE_TABLE_COLS));
+
+    CHECK(!ir_code_table_contains(1, 0));
+    CHECK_EQ(ir_code_table_transmit(1, 0, 0, true), ESP_ERR_NOT_FOUND);
+
+    CHECK_EQ(ir_code_table_put(1, 0, &code), ESP_OK);
+    CHECK(ir_code_table_contains(1, 0));
+    CHECK_EQ(words_used(), code_len(7) + 1);
+    CHECK_EQ(ir_code_table_transmit(1, 0, 0, true), ESP_OK);
+    CHECK_EQ(atomic_load(&frames_sent), 1);
+
+    /* A render error leaves the slot as it was */
+    ir_code_t unknown = make_code(9);
+    unknown.protocol = IR_PROTOCOL_UNKNOWN;
+    CHECK_EQ(ir_code_table_put(1, 0, &unknown), ESP_ERR_NOT_SUPPORTED);
+    CHECK(ir_code_table_contains(1, 0));
+
+    ir_code_table_get_stats(&stats);
+    CHECK_EQ(stats.resident, 1);
+    CHECK_EQ(stats.hits, 1);
+    CHECK_EQ(stats.misses, 1);
+    CHECK_EQ(stats.words_capacity, IR_CODE_TABLE_ARENA_WORDS);
+
+    /* Fill the arena: the code that does not fit leaves its slot empty */
+    ir_code_t big = make_code(80);
+    size_t fitted = 0;
+    esp_err_t err = ESP_OK;
+    for (uint16_t col = 1; col < IR_CODE_TABLE_COLS && err == ESP_OK; col++) {
+        err = ir_code_table_put(2, col, &big);
+        if (err == ESP_OK) {
+            fitted++;
+        } else {
+            CHECK_EQ(err, ESP_ERR_NO_MEM);
+            CHECK(!ir_code_table_contains(2, col));
+        }
+    }
+    CHECK_EQ(err, ESP_ERR_NO_MEM);
+    CHECK_EQ(fitted, (IR_CODE_TABLE_ARENA_WORDS - code_len(7) - 1) / (code_len(80) + 1));
+
+    table_clear();
+    CHECK_EQ(words_used(), 0);
+    ir_code_table_reset_stats();
+    ir_code_table_get_stats(&stats);
+    CHECK_EQ(stats.resident, 0);
+    CHECK_EQ(stats.hits, 0);
+    CHECK_EQ(stats.misses, 0);
+    CHECK_EQ(stats.grace_waits, 0);
+}
+
+static void test_grace(void)
+{
+    ir_code_table_stats_t stats;
+    ir_code_t first = make_code(10);
+    ir_code_t second = make_code(20);
+    ir_code_t third = make_code(5);
+
+    CHECK_EQ(ir_code_table_put(1, 0, &first), ESP_OK);
+
+    /* The frame stays queued: its span must not be reused */
+    tx_set_hold(true);
+    CHECK_EQ(ir_code_table_transmit(1, 0, 0, false), ESP_OK);
+    CHECK_EQ(ir_code_table_put(1, 0, &second), ESP_OK);
+    CHECK_EQ(ir_code_table_put(1, 1, &third), ESP_OK);
+    CHECK_EQ(ir_code_table_put(1, 1, &second), ESP_OK);
+    CHECK_EQ(words_used(), code_len(10) + code_len(20) * 2 + code_len(5) + 4);
+    ir_code_table_get_stats(&stats);
+    CHECK(stats.grace_waits >= 3);
+
+    /* Sent only now, from the original words */
+    tx_set_hold(false);
+    CHECK_EQ(ir_tx_wait_all_done(1000), ESP_OK);
+    CHECK_EQ(atomic_load(&bad_frames), 0);
+
+    /* Idle emitter: the next writer call reclaims every retired span */
+    ir_code_table_remove(1, 1);
+    CHECK_EQ(words_used(), code_len(20) + 1);
+    ir_code_table_get_stats(&stats);
+    printf("grace: %u waits, longest %u us\n", (unsigned)stats.grace_waits,
+           (unsigned)stats.grace_wait_us_max);
+
+    /* Freed words are handed out again */
+    CHECK_EQ(ir_code_table_put(1, 1, &first), ESP_OK);
+    CHECK_EQ(ir_code_table_transmit(1, 1, 0, true), ESP_OK);
+    CHECK_EQ(atomic_load(&bad_frames), 0);
+
+    table_clear();
+    CHECK_EQ(words_used(), 0);
+}
+
+static atomic_bool readers_stop;
+
+static void *reader(void *arg)
+{
+    uint32_t rng = (uint32_t)(uintptr_t)arg;
+    for (unsigned n = 1; !atomic_load(&readers_stop); n++) {
+        rng = rng * 1103515245u + 12345u;
+        uint8_t row = 1 + (rng >> 8) % TEST_ROWS;
+        uint16_t col = (rng >> 16) % TEST_COLS;
+        ir_code_table_transmit(row, col, 0, false);
+        if (n % 4 == 0) {
+            usleep(50);        // Let the emitter go idle now and then
+        }
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    pthread_t threads[NUM_READERS];
+    ir_code_table_stats_t stats;
+
+    ir_code_table_reset_stats();
+    atomic_store(&frames_sent, 0);
+    for (uintptr_t i = 0; i < NUM_READERS; i++) {
+        pthread_create(&threads[i], NULL, reader, (void *)(i + 1));
+    }
+
+    unsigned full = 0;
+    for (int i = 0; i < 20000; i++) {
+        uint8_t row = 1 + i % TEST_ROWS;
+        uint16_t col = (i * 7) % TEST_COLS;
+        ir_code_t code = make_code(1 + i % 40);
+
+        if (i % 5 == 0) {
+            ir_code_table_remove(row, col);
+        } else if (ir_code_table_put(row, col, &code) != ESP_OK) {
+            full++;
+        }
+        if (i % 997 == 0) {
+            ir_code_table_clear_row(row);
+        }
+        if (i % 8 == 0) {
+            usleep(50);
+        }
+    }
+
+    atomic_store(&readers_stop, true);
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    CHECK_EQ(ir_tx_wait_all_done(1000), ESP_OK);
+
+    ir_code_table_get_stats(&stats);
+    printf("concurrent: %u hits, %u misses, %u frames sent, %u puts over capacity, "
+           "%u grace waits, longest %u us\n", (unsigned)stats.hits, (unsigned)stats.misses,
+           atomic_load(&frames_sent), full, (unsigned)stats.grace_waits,
+           (unsigned)stats.grace_wait_us_max);
+    CHECK_EQ(atomic_load(&bad_frames), 0);
+    CHECK_EQ(atomic_load(&frames_sent), stats.hits);
+    CHECK(stats.hits > 0);
+    CHECK(stats.grace_waits > 0);
+
+    /* Nothing in flight: every word comes back */
+    table_clear();
+    ir_code_table_get_stats(&stats);
+    CHECK_EQ(stats.resident, 0);
+    CHECK_EQ(stats.words_used, 0);
+}
+
+int main(void)
+{
+    pthread_t tx_thread;
+    pthread_create(&tx_thread, NULL, transmitter, NULL);
+
+    test_basic();
+    test_grace();
+    test_concurrent();
+
+    pthread_mutex_lock(&tx_lock);
+    tx_stop = true;
+    pthread_cond_broadcast(&tx_cond);
+    pthread_mutex_unlock(&tx_lock);
+    pthread_join(tx_thread, NULL);
+    return HOST_TEST_RESULT();
+}
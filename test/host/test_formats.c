@@ -0,0 +1,642 @@
+/**
+ * @file test_formats.c
+ * @brief Pronto Hex, LIRC and IRDB CSV round trips, and import/export
+ *
+ * - RAW frames written as Pronto parse back within half a carrier period
+ *   per duration, with the lead-out the writer adds; written as LIRC raw
+ *   codes they parse back exactly.
+ * - Every IRDB protocol the CSV writer knows round trips over a spread of
+ *   device, subdevice and function values; quoted names survive.
+ * - LIRC SPACE_ENC remotes with NEC timing become NEC codes, others RAW.
+ * - Malformed entries are counted and skipped; every input also parses
+ *   identically when the reader returns one byte at a time.
+ * - Button names map to actions; an import is saved with one commit and
+ *   exports back to the same codes.
+ *
+ * MIT License
+ */
+
+#include "ir_formats.h"
+#include "ir_transfer.h"
+#include "ir_action.h"
+#include "ir_scene.h"
+#include "ir_storage.h"
+#include "host_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ENTRIES     64
+#define OUT_SIZE        32768
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+typedef struct {
+    char remote[IR_FORMAT_NAME_LEN];
+    char name[IR_FORMAT_NAME_LEN];
+    int device;
+    int subdevice;
+    int function;
+    ir_code_t code;             // Owned copy
+} entry_t;
+
+typedef struct {
+    entry_t entries[MAX_ENTRIES];
+    size_t count;
+    ir_format_stats_t stats;
+} parsed_t;
+
+static esp_err_t collect_cb(const ir_format_entry_t *entry, void *arg)
+{
+    parsed_t *parsed = arg;
+    if (parsed->count == MAX_ENTRIES) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    entry_t *out = &parsed->entries[parsed->count++];
+    snprintf(out->remote, sizeof(out->remote), "%s", entry->remote);
+    snprintf(out->name, sizeof(out->name), "%s", entry->name);
+    out->device = entry->device;
+    out->subdevice = entry->subdevice;
+    out->function = entry->function;
+    return ir_code_copy(&out->code, &entry->code);
+}
+
+static void parsed_free(parsed_t *parsed)
+{
+    for (size_t i = 0; i < parsed->count; i++) {
+        ir_code_free(&parsed->entries[i].code);
+    }
+    parsed->count = 0;
+}
+
+/* Reader that hands out one byte per call, splitting every token */
+static size_t read_bytewise(void *ctx, char *buf, size_t len)
+{
+    return ir_format_read_mem(ctx, buf, len ? 1 : 0);
+}
+
+static bool same_code(const ir_code_t *a, const ir_code_t *b)
+{
+    if (a->protocol != b->protocol || a->carrier_freq_hz != b->carrier_freq_hz) {
+        return false;
+    }
+    if (a->protocol == IR_PROTOCOL_RAW) {
+        return a->raw_length == b->raw_length &&
+               memcmp(a->raw_data, b->raw_data, a->raw_length * sizeof(uint32_t)) == 0;
+    }
+    return a->bits == b->bits && a->data == b->data && a->address == b->address &&
+           a->command == b->command && a->flags == b->flags;
+}
+
+/**
+ * @brief Parse @p text in chunks and byte by byte; both must agree
+ */
+static esp_err_t parse_text(ir_format_t format, const char *text, parsed_t *parsed)
+{
+    ir_format_mem_t mem = { .data = text, .len = strlen(text), .pos = 0 };
+    parsed->count = 0;
+    esp_err_t err = ir_format_parse(format, ir_format_read_mem, &mem, collect_cb, parsed, &parsed->stats);
+
+    static parsed_t bytewise;
+    ir_format_mem_t mem2 = { .data = text, .len = strlen(text), .pos = 0 };
+    bytewise.count = 0;
+    CHECK_EQ(ir_format_parse(format, read_bytewise, &mem2, collect_cb, &bytewise, &bytewise.stats), err);
+    CHECK_EQ(bytewise.count, parsed->count);
+    CHECK_EQ(bytewise.stats.parsed, parsed->stats.parsed);
+    CHECK_EQ(bytewise.stats.skipped, parsed->stats.skipped);
+    CHECK_EQ(bytewise.stats.lines, parsed->stats.lines);
+    for (size_t i = 0; i < bytewise.count && i < parsed->count; i++) {
+        CHECK(strcmp(bytewise.entries[i].name, parsed->entries[i].name) == 0);
+        CHECK(same_code(&bytewise.entries[i].code, &parsed->entries[i].code));
+    }
+    parsed_free(&bytewise);
+    return err;
+}
+
+/* Output sink */
+static char out_text[OUT_SIZE];
+static size_t out_len;
+
+static esp_err_t write_out(void *ctx, const char *buf, size_t len)
+{
+    if (out_len + len >= OUT_SIZE) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(out_text + out_len, buf, len);
+    out_len += len;
+    out_text[out_len] = '\0';
+    return ESP_OK;
+}
+
+static void out_reset(void)
+{
+    out_len = 0;
+    out_text[0] = '\0';
+}
+
+static uint32_t rng = 4242;
+
+static uint32_t random_range(uint32_t lo, uint32_t hi)
+{
+    rng = rng * 1103515245u + 12345u;
+    return lo + (rng >> 8) % (hi - lo + 1);
+}
+
+/**
+ * @brief Random RAW frame; the last space is 0 like a captured frame
+ */
+static void random_frame(uint32_t *symbols, size_t num_symbols)
+{
+    for (size_t i = 0; i < num_symbols; i++) {
+        uint32_t space = i + 1 == num_symbols ? 0 : random_range(150, 20000);
+        symbols[i] = IR_FORMAT_SYMBOL(random_range(150, 9000), space);
+    }
+}
+
+static const size_t frame_lengths[] = { 1, 2, 18, 34, 100, IR_FORMAT_MAX_SYMBOLS };
+#define NUM_FRAMES  (sizeof(frame_lengths) / sizeof(frame_lengths[0]))
+
+static uint32_t frames[NUM_FRAMES][IR_FORMAT_MAX_SYMBOLS];
+
+/* ============================================================================
+ * PRONTO AND LIRC
+ * ============================================================================ */
+
+static void test_pronto_roundtrip(void)
+{
+    static const uint32_t carriers[] = { 36000, 38000, 40000, 56000 };
+    static parsed_t parsed;
+    ir_format_writer_t writer;
+
+    for (size_t c = 0; c < sizeof(carriers) / sizeof(carriers[0]); c++) {
+        out_reset();
+        CHECK_EQ(ir_format_writer_begin(&writer, IR_FORMAT_PRONTO, NULL, write_out, NULL), ESP_OK);
+        for (size_t f = 0; f < NUM_FRAMES; f++) {
+            char name[16];
+            snprintf(name, sizeof(name), "Key %u", (unsigned)f);
+            random_frame(frames[f], frame_lengths[f]);
+            CHECK_EQ(ir_format_write_symbols(&writer, name, carriers[c], frames[f], frame_lengths[f]), ESP_OK);
+        }
+        CHECK_EQ(ir_format_writer_end(&writer), ESP_OK);
+        CHECK_EQ(writer.written, NUM_FRAMES);
+
+        CHECK_EQ(parse_text(IR_FORMAT_PRONTO, out_text, &parsed), ESP_OK);
+        CHECK_EQ(parsed.count, NUM_FRAMES);
+        CHECK_EQ(parsed.stats.skipped, 0);
+
+        /* One Pronto unit is one carrier period */
+        uint32_t freq_word = (4145146 + carriers[c] / 2) / carriers[c];
+        double unit_us = freq_word * 0.241246;
+        for (size_t f = 0; f < parsed.count; f++) {
+            const ir_code_t *code = &parsed.entries[f].code;
+            char name[16];
+            snprintf(name, sizeof(name), "Key %u", (unsigned)f);
+            CHECK(strcmp(parsed.entries[f].name, name) == 0);
+            CHECK_EQ(code->protocol, IR_PROTOCOL_RAW);
+            CHECK(abs((int)code->carrier_freq_hz - (int)carriers[c]) * 100 < (int)carriers[c]);
+            CHECK_EQ(code->raw_length, frame_lengths[f]);
+            if (code->raw_length != frame_lengths[f]) {
+                continue;
+            }
+
+            const uint32_t *got = (const uint32_t *)code->raw_data;
+            for (size_t i = 0; i < code->raw_length; i++) {
+                uint32_t space = IR_FORMAT_SYMBOL_SPACE(frames[f][i]);
+                if (space == 0) {
+                    space = IR_FORMAT_DEFAULT_GAP_US;   // Lead-out added by the writer
+                }
+                CHECK(abs((int)IR_FORMAT_SYMBOL_MARK(got[i]) - (int)IR_FORMAT_SYMBOL_MARK(frames[f][i])) <=
+                      unit_us / 2 + 1);
+                CHECK(abs((int)IR_FORMAT_SYMBOL_SPACE(got[i]) - (int)space) <= unit_us / 2 + 1);
+            }
+        }
+        parsed_free(&parsed);
+    }
+}
+
+static void test_lirc_raw_roundtrip(void)
+{
+    static parsed_t parsed;
+    ir_format_writer_t writer;
+
+    out_reset();
+    CHECK_EQ(ir_format_writer_begin(&writer, IR_FORMAT_LIRC, "living room", write_out, NULL), ESP_OK);
+    for (size_t f = 0; f < NUM_FRAMES; f++) {
+        char name[16];
+        snprintf(name, sizeof(name), "Key %u", (unsigned)f);
+        random_frame(frames[f], frame_lengths[f]);
+        CHECK_EQ(ir_format_write_symbols(&writer, name, 36000, frames[f], frame_lengths[f]), ESP_OK);
+    }
+    CHECK_EQ(ir_format_writer_end(&writer), ESP_OK);
+
+    CHECK_EQ(parse_text(IR_FORMAT_LIRC, out_text, &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, NUM_FRAMES);
+    CHECK_EQ(parsed.stats.skipped, 0);
+    for (size_t f = 0; f < parsed.count; f++) {
+        const ir_code_t *code = &parsed.entries[f].code;
+        char name[16];
+        snprintf(name, sizeof(name), "Key_%u", (unsigned)f);     // Names are single tokens
+        CHECK(strcmp(parsed.entries[f].name, name) == 0);
+        CHECK(strcmp(parsed.entries[f].remote, "living_room") == 0);
+        CHECK_EQ(code->protocol, IR_PROTOCOL_RAW);
+        CHECK_EQ(code->carrier_freq_hz, 36000);
+        CHECK_EQ(code->raw_length, frame_lengths[f]);
+        CHECK(code->raw_length == frame_lengths[f] &&
+              memcmp(code->raw_data, frames[f], frame_lengths[f] * sizeof(uint32_t)) == 0);
+    }
+    parsed_free(&parsed);
+}
+
+static void test_lirc_space_enc(void)
+{
+    static parsed_t parsed;
+    const char *text =
+        "# LG TV, NEC timing\n"
+        "begin remote\n"
+        "  name  lg_tv\n"
+        "  bits           16\n"
+        "  flags SPACE_ENC|CONST_LENGTH\n"
+        "  header       9000  4500\n"
+        "  one           560  1690\n"
+        "  zero          560   560\n"
+        "  ptrail        560\n"
+        "  pre_data_bits   16\n"
+        "  pre_data       0x20DF\n"
+        "  gap          108000\n"
+        "  begin codes\n"
+        "    KEY_POWER                0x10EF   # comment\n"
+        "    KEY_VOLUMEUP             0x40BF\n"
+        "  end codes\n"
+        "end remote\n"
+        "begin remote\n"
+        "  name  other\n"
+        "  bits           8\n"
+        "  flags SPACE_ENC\n"
+        "  header       3400  1700\n"
+        "  one           420  1300\n"
+        "  zero          420   420\n"
+        "  ptrail        420\n"
+        "  frequency   40000\n"
+        "  begin codes\n"
+        "    KEY_MUTE     0xA5\n"
+        "    KEY_BAD      zz\n"
+        "  end codes\n"
+        "end remote\n"
+        "begin remote\n"
+        "  name  philips\n"
+        "  bits           13\n"
+        "  flags RC5|CONST_LENGTH\n"
+        "  one            889   889\n"
+        "  zero           889   889\n"
+        "  begin codes\n"
+        "    KEY_POWER    0x100C\n"
+        "  end codes\n"
+        "end remote\n";
+
+    CHECK_EQ(parse_text(IR_FORMAT_LIRC, text, &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 3);
+    CHECK_EQ(parsed.stats.skipped, 2);     // KEY_BAD and the RC5 remote
+    if (parsed.count != 3) {
+        parsed_free(&parsed);
+        return;
+    }
+
+    /* NEC address 0x04, command 0x08 */
+    const ir_code_t *power = &parsed.entries[0].code;
+    CHECK(strcmp(parsed.entries[0].remote, "lg_tv") == 0);
+    CHECK(strcmp(parsed.entries[0].name, "KEY_POWER") == 0);
+    CHECK_EQ(power->protocol, IR_PROTOCOL_NEC);
+    CHECK_EQ(power->bits, 32);
+    CHECK_EQ(power->data, 0xF708FB04);
+    CHECK_EQ(power->address, 0x04);
+    CHECK_EQ(power->command, 0x08);
+    CHECK_EQ(power->flags, 0);
+    CHECK_EQ(parsed.entries[1].code.command, 0x02);
+
+    /* Header, 8 bits MSB first, trailing pulse */
+    const ir_code_t *mute = &parsed.entries[2].code;
+    CHECK(strcmp(parsed.entries[2].remote, "other") == 0);
+    CHECK_EQ(mute->protocol, IR_PROTOCOL_RAW);
+    CHECK_EQ(mute->carrier_freq_hz, 40000);
+    CHECK_EQ(mute->raw_length, 1 + 8 + 1);
+    if (mute->raw_length == 1 + 8 + 1) {
+        const uint32_t *sym = (const uint32_t *)mute->raw_data;
+        CHECK_EQ(sym[0], IR_FORMAT_SYMBOL(3400, 1700));
+        for (int i = 0; i < 8; i++) {
+            CHECK_EQ(sym[1 + i], IR_FORMAT_SYMBOL(420, ((0xA5 >> (7 - i)) & 1) ? 1300 : 420));
+        }
+        CHECK_EQ(sym[9], IR_FORMAT_SYMBOL(420, 0));
+    }
+    parsed_free(&parsed);
+}
+
+/* ============================================================================
+ * IRDB CSV
+ * ============================================================================ */
+
+static void test_csv_roundtrip(void)
+{
+    static const char *const protocols[] = {
+        "NEC1", "NECx2", "Sony12", "Sony15", "Sony20", "RC5", "RC6", "JVC", "Denon"
+    };
+    static const int devices[] = { 0, 1, 4, 0x1F, 0x20, 0x7F, 0xFF };
+    static const int subdevices[] = { -1, 0, 0x55, 0xFB };
+    static const int functions[] = { 0, 1, 8, 0x3F, 0x40, 0x7F, 0x80, 0xFF };
+    static parsed_t parsed, reparsed;
+    static char text[8192];
+
+    for (size_t p = 0; p < sizeof(protocols) / sizeof(protocols[0]); p++) {
+        size_t len = (size_t)snprintf(text, sizeof(text), "functionname,protocol,device,subdevice,function\n");
+        size_t rows = 0;
+        for (size_t d = 0; d < sizeof(devices) / sizeof(devices[0]); d++) {
+            for (size_t s = 0; s < sizeof(subdevices) / sizeof(subdevices[0]); s++) {
+                for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++, rows++) {
+                    len += (size_t)snprintf(text + len, sizeof(text) - len, "k%u,%s,%d,%d,%d\n",
+                                            (unsigned)rows, protocols[p], devices[d], subdevices[s],
+                                            functions[f]);
+                }
+            }
+        }
+        CHECK(len < sizeof(text));
+
+        /* Rows in batches so the entry buffer never fills */
+        const char *row = strchr(text, '\n') + 1;
+        size_t accepted = 0;
+        while (*row) {
+            static char chunk[2048];
+            const char *end = row;
+            for (int i = 0; i < MAX_ENTRIES && *end; i++) {
+                end = strchr(end, '\n') + 1;
+            }
+            snprintf(chunk, sizeof(chunk), "%.*s", (int)(end - row), row);
+            row = end;
+
+            CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV, chunk, &parsed), ESP_OK);
+            accepted += parsed.count;
+
+            ir_format_writer_t writer;
+            out_reset();
+            CHECK_EQ(ir_format_writer_begin(&writer, IR_FORMAT_IRDB_CSV, NULL, write_out, NULL), ESP_OK);
+            for (size_t i = 0; i < parsed.count; i++) {
+                CHECK_EQ(ir_format_write_code(&writer, parsed.entries[i].name, &parsed.entries[i].code), ESP_OK);
+            }
+            CHECK_EQ(ir_format_writer_end(&writer), ESP_OK);
+
+            /* Written rows use each protocol's canonical name and parse to the same codes */
+            CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV, out_text, &reparsed), ESP_OK);
+            CHECK_EQ(reparsed.count, parsed.count);
+            CHECK_EQ(reparsed.stats.skipped, 0);
+            for (size_t i = 0; i < reparsed.count && i < parsed.count; i++) {
+                CHECK(strcmp(reparsed.entries[i].name, parsed.entries[i].name) == 0);
+                CHECK(same_code(&reparsed.entries[i].code, &parsed.entries[i].code));
+                CHECK_EQ(reparsed.entries[i].function, parsed.entries[i].function);
+            }
+            parsed_free(&parsed);
+            parsed_free(&reparsed);
+        }
+        printf("%-7s %u of %u rows accepted\n", protocols[p], (unsigned)accepted, (unsigned)rows);
+        CHECK(accepted > 0);
+    }
+
+    /* Known vector: NEC1 4/8 is the LG power key */
+    CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV, "Power,NEC1,4,-1,8\n", &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 1);
+    if (parsed.count == 1) {
+        CHECK_EQ(parsed.entries[0].code.protocol, IR_PROTOCOL_NEC);
+        CHECK_EQ(parsed.entries[0].code.data, 0xF708FB04);
+    }
+    parsed_free(&parsed);
+}
+
+static void test_csv_names(void)
+{
+    static parsed_t parsed;
+    ir_format_writer_t writer;
+    ir_code_t code = {0};
+    const char *name = "Say \"Hi\", then";
+
+    CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV, "x,NEC1,1,-1,2\n", &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 1);
+    code = parsed.entries[0].code;
+
+    out_reset();
+    CHECK_EQ(ir_format_writer_begin(&writer, IR_FORMAT_IRDB_CSV, NULL, write_out, NULL), ESP_OK);
+    CHECK_EQ(ir_format_write_code(&writer, name, &code), ESP_OK);
+    CHECK(strstr(out_text, "\"Say \"\"Hi\"\", then\",NEC1,1,-1,2\n") != NULL);
+    parsed_free(&parsed);
+
+    CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV, out_text, &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 1);
+    CHECK(parsed.count == 1 && strcmp(parsed.entries[0].name, name) == 0);
+    parsed_free(&parsed);
+
+    /* Columns are found by header name, in any order */
+    CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV,
+                        "protocol,function,functionname,device,subdevice\r\nNEC1,8,Power,4,-1\r\n",
+                        &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 1);
+    CHECK(parsed.count == 1 && strcmp(parsed.entries[0].name, "Power") == 0 &&
+          parsed.entries[0].code.data == 0xF708FB04);
+    parsed_free(&parsed);
+
+    /* Codes without an IRDB form */
+    ir_code_t raw = { .protocol = IR_PROTOCOL_RAW };
+    CHECK_EQ(ir_format_write_code(&writer, "raw", &raw), ESP_ERR_NOT_SUPPORTED);
+    ir_code_t rc6 = { .protocol = IR_PROTOCOL_RC6, .bits = 36, .data = 0x12345 };
+    CHECK_EQ(ir_format_write_code(&writer, "mce", &rc6), ESP_ERR_NOT_SUPPORTED);
+    CHECK_EQ(ir_format_write_symbols(&writer, "raw", 0, frames[0], 1), ESP_ERR_NOT_SUPPORTED);
+}
+
+/* ============================================================================
+ * MALFORMED INPUT
+ * ============================================================================ */
+
+static void test_malformed(void)
+{
+    static parsed_t parsed;
+
+    CHECK_EQ(parse_text(IR_FORMAT_PRONTO,
+                        "Good: 0000 006D 0001 0000 0010 0020\n"
+                        "0000 006D 0002 0000 0010 0020\n"           // Fewer pairs than declared
+                        "0000 006D 0001 0000 00zz 0020\n"           // Not hex
+                        "0100 006D 0001 0000 0010 0020\n"           // Modulated codes only
+                        "0000 0000 0001 0000 0010 0020\n"           // No frequency
+                        "Name without code:\n"
+                        "\n"
+                        "# comment\n"
+                        "0000 006D 0000 0001 0010 0020\n",          // Repeat sequence only
+                        &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 2);
+    CHECK_EQ(parsed.stats.parsed, 2);
+    CHECK_EQ(parsed.stats.skipped, 5);
+    CHECK_EQ(parsed.stats.lines, 9);
+    CHECK(parsed.count == 2 && strcmp(parsed.entries[0].name, "Good") == 0 &&
+          parsed.entries[1].name[0] == '\0');
+    parsed_free(&parsed);
+
+    CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV,
+                        "functionname,protocol,device,subdevice,function\n"
+                        "Power,NEC1,4,-1,8\n"
+                        "Odd,XMP,1,2,3\n"                           // Unknown protocol
+                        "Big,Sony12,32,-1,1\n"                      // Device beyond 5 bits
+                        "Neg,NEC1,-4,-1,8\n"
+                        "Short,NEC1\n"
+                        "\n",
+                        &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 1);
+    CHECK_EQ(parsed.stats.skipped, 4);
+    parsed_free(&parsed);
+
+    /* An oversized raw code is skipped, not truncated */
+    static char text[IR_FORMAT_MAX_SYMBOLS * 16 + 128];
+    size_t len = (size_t)snprintf(text, sizeof(text),
+                                  "begin remote\n name big\n flags RAW_CODES\n begin raw_codes\n name long\n");
+    for (int i = 0; i < 2 * IR_FORMAT_MAX_SYMBOLS + 1; i++) {
+        len += (size_t)snprintf(text + len, sizeof(text) - len, " %d", 500);
+    }
+    snprintf(text + len, sizeof(text) - len, "\n name ok\n 500 500 500\n end raw_codes\nend remote\n");
+    CHECK_EQ(parse_text(IR_FORMAT_LIRC, text, &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 1);
+    CHECK_EQ(parsed.stats.skipped, 1);
+    CHECK(parsed.count == 1 && strcmp(parsed.entries[0].name, "ok") == 0 &&
+          parsed.entries[0].code.raw_length == 2);
+    parsed_free(&parsed);
+
+    CHECK_EQ(ir_format_parse(IR_FORMAT_MAX, ir_format_read_mem, NULL, collect_cb, &parsed, NULL),
+             ESP_ERR_INVALID_ARG);
+}
+
+/* ============================================================================
+ * TRANSFER
+ * ============================================================================ */
+
+/* ir_action.c refreshes scenes that use a changed action; there are none here */
+esp_err_t ir_scene_refresh(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t ir_scene_refresh_action(ir_device_type_t device, ir_action_t action)
+{
+    return ESP_OK;
+}
+
+static void test_match_action(void)
+{
+    CHECK_EQ(ir_transfer_match_action("KEY_VOLUMEUP"), IR_ACTION_VOL_UP);
+    CHECK_EQ(ir_transfer_match_action("Vol+"), IR_ACTION_VOL_UP);
+    CHECK_EQ(ir_transfer_match_action("volume_up"), IR_ACTION_VOL_UP);
+    CHECK_EQ(ir_transfer_match_action("VolumeUp"), IR_ACTION_VOL_UP);
+    CHECK_EQ(ir_transfer_match_action("Vol-"), IR_ACTION_VOL_DOWN);
+    CHECK_EQ(ir_transfer_match_action("BTN_POWER"), IR_ACTION_POWER);
+    CHECK_EQ(ir_transfer_match_action("key_mute"), IR_ACTION_MUTE);
+    CHECK_EQ(ir_transfer_match_action("KEY_OK"), IR_ACTION_NAV_OK);
+    CHECK_EQ(ir_transfer_match_action("0"), IR_ACTION_NUM_0);
+    CHECK_EQ(ir_transfer_match_action("KEY_7"), IR_ACTION_NUM_7);
+    CHECK_EQ(ir_transfer_match_action("Num9"), IR_ACTION_NUM_9);
+    CHECK_EQ(ir_transfer_match_action("Ch-Up"), IR_ACTION_CH_UP);
+    CHECK_EQ(ir_transfer_match_action("key"), IR_ACTION_NONE);
+    CHECK_EQ(ir_transfer_match_action("12"), IR_ACTION_NONE);
+    CHECK_EQ(ir_transfer_match_action("Frobnicate"), IR_ACTION_NONE);
+    CHECK_EQ(ir_transfer_match_action(""), IR_ACTION_NONE);
+    CHECK_EQ(ir_transfer_match_action(NULL), IR_ACTION_NONE);
+}
+
+static void test_import_export(void)
+{
+    static parsed_t parsed;
+    ir_storage_ns_t ns;
+    ir_storage_stats_t before, after;
+    ir_transfer_stats_t stats;
+
+    CHECK_EQ(ir_storage_init_with(&ir_storage_backend_mem), ESP_OK);
+    CHECK_EQ(ir_action_init(), ESP_OK);
+    CHECK_EQ(ir_storage_open("ir_actions", &ns), ESP_OK);
+
+    const char *csv =
+        "functionname,protocol,device,subdevice,function\n"
+        "KEY_POWER,NEC1,4,-1,8\n"
+        "Vol+,NEC1,4,-1,2\n"
+        "Vol-,NEC1,4,-1,3\n"
+        "1,NECx2,7,7,4\n"
+        "Frobnicate,NEC1,4,-1,99\n"
+        "Mute,XMP,1,2,3\n";
+    CHECK_EQ(ir_storage_get_stats(ns, &before), ESP_OK);
+    CHECK_EQ(ir_transfer_import_blob(IR_FORMAT_IRDB_CSV, csv, strlen(csv), IR_DEVICE_TV, &stats), ESP_OK);
+    CHECK_EQ(ir_storage_get_stats(ns, &after), ESP_OK);
+    CHECK_EQ(stats.saved, 4);
+    CHECK_EQ(stats.unmatched, 1);
+    CHECK_EQ(stats.format.skipped, 1);
+    CHECK_EQ(after.commits - before.commits, 1);   // One commit for the whole import
+    CHECK(after.deferred_commits > before.deferred_commits);
+
+    ir_code_t code = {0};
+    CHECK_EQ(ir_action_load(IR_DEVICE_TV, IR_ACTION_VOL_UP, &code), ESP_OK);
+    CHECK_EQ(code.protocol, IR_PROTOCOL_NEC);
+    CHECK_EQ(code.command, 2);
+    ir_code_free(&code);
+
+    /* A RAW code next to the protocol codes */
+    const char *pronto = "Info: 0000 006D 0002 0000 0155 00AA 0015 0400\n";
+    CHECK_EQ(ir_transfer_import_blob(IR_FORMAT_PRONTO, pronto, strlen(pronto), IR_DEVICE_TV, &stats), ESP_OK);
+    CHECK_EQ(stats.saved, 1);
+
+    /* CSV export carries the protocol codes and skips the RAW one */
+    out_reset();
+    CHECK_EQ(ir_transfer_export(IR_FORMAT_IRDB_CSV, IR_DEVICE_TV, write_out, NULL, &stats), ESP_OK);
+    CHECK_EQ(stats.saved, 4);
+    CHECK_EQ(stats.unsupported, 1);
+    CHECK_EQ(parse_text(IR_FORMAT_IRDB_CSV, out_text, &parsed), ESP_OK);
+    CHECK_EQ(parsed.count, 4);
+    for (size_t i = 0; i < parsed.count; i++) {
+        ir_action_t action = ir_transfer_match_action(parsed.entries[i].name);
+        CHECK(action != IR_ACTION_NONE);
+        CHECK_EQ(ir_action_load(IR_DEVICE_TV, action, &code), ESP_OK);
+        CHECK(same_code(&parsed.entries[i].code, &code));
+        ir_code_free(&code);
+    }
+    parsed_free(&parsed);
+
+    /* Pronto and LIRC export the RAW code (protocol codes need the encoders) */
+    CHECK_EQ(ir_action_load(IR_DEVICE_TV, IR_ACTION_INFO, &code), ESP_OK);
+    for (int format = IR_FORMAT_PRONTO; format <= IR_FORMAT_LIRC; format++) {
+        out_reset();
+        CHECK_EQ(ir_transfer_export((ir_format_t)format, IR_DEVICE_TV, write_out, NULL, &stats), ESP_OK);
+        CHECK_EQ(stats.saved, 1);
+        CHECK_EQ(parse_text((ir_format_t)format, out_text, &parsed), ESP_OK);
+        CHECK_EQ(parsed.count, 1);
+        if (parsed.count == 1) {
+            /* LIRC raw codes end with a pulse: the lead-out is not written */
+            const ir_code_t *got = &parsed.entries[0].code;
+            uint32_t *last = (uint32_t *)&code.raw_data[2 * (code.raw_length - 1)];
+            uint32_t saved_last = *last;
+            if (format == IR_FORMAT_LIRC) {
+                *last = IR_FORMAT_SYMBOL(IR_FORMAT_SYMBOL_MARK(*last), 0);
+            }
+            CHECK(strcmp(parsed.entries[0].name, "Info") == 0);
+            CHECK(same_code(got, &code));
+            *last = saved_last;
+        }
+        parsed_free(&parsed);
+    }
+    ir_code_free(&code);
+
+    CHECK_EQ(ir_transfer_import_blob(IR_FORMAT_IRDB_CSV, csv, strlen(csv), IR_DEVICE_NONE, NULL),
+             ESP_ERR_INVALID_ARG);
+    CHECK_EQ(ir_transfer_import_blob(IR_FORMAT_IRDB_CSV, NULL, 0, IR_DEVICE_TV, NULL), ESP_ERR_INVALID_ARG);
+}
+
+int main(void)
+{
+    test_pronto_roundtrip();
+    test_lirc_raw_roundtrip();
+    test_lirc_space_enc();
+    test_csv_roundtrip();
+    test_csv_names();
+    test_malformed();
+    test_match_action();
+    test_import_export();
+    return HOST_TEST_RESULT();
+}
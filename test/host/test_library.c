@@ -0,0 +1,388 @@
+/**
+ * @file test_library.c
+ * @brief Code library files in a scratch directory
+ *
+ * IR_LIBRARY_BASE_PATH is "." for this test, which runs in a fresh
+ * temporary directory; ir_library_deinit() / ir_library_init() stand in
+ * for a reboot.
+ * - A 751-code run added in scrambled key order: every code looks up,
+ *   foreach visits them in key order, and the index is merged every
+ *   IR_LIBRARY_TAIL_MAX additions with the rest replayed from irlib.tail.
+ * - Interrupted merges: only irlib.idx.new left, the old index plus the
+ *   tail with a half-written irlib.idx.new, and a merged index whose tail
+ *   file was not removed yet. Nothing is lost or counted twice.
+ * - A record torn by a power cut at the end of irlib.dat: the codes
+ *   before it survive an index rebuild, and so do codes added after it.
+ *
+ * MIT License
+ */
+
+#include "ir_library.h"
+#include "ir_code.h"
+#include "host_test.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RUN_CODES       751     // Prime, so the insertion stride visits every code once
+#define RUN_STRIDE      263
+#define NUM_BRANDS      7
+#define INDEX_ENTRY     28      // sizeof(lib_index_entry_t)
+
+static const char *const brands[NUM_BRANDS] = {
+    "Samsung", "LG", "Sony", "Philips", "Panasonic", "TCL", "Videocon",
+};
+
+/* Codes whose latest record replaced an earlier one */
+static uint32_t replaced_salt[RUN_CODES + 64];
+
+/* ir_action.c refreshes scenes that use a changed action; there are none here */
+esp_err_t ir_scene_refresh(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t ir_scene_refresh_action(ir_device_type_t device, ir_action_t action)
+{
+    return ESP_OK;
+}
+
+/* ============================================================================
+ * CODES
+ * ============================================================================ */
+
+/* Code i: brand i % 7, code set i / 7, one function each */
+static ir_library_entry_t make_entry(unsigned i)
+{
+    ir_library_entry_t entry = { 0 };
+    strlcpy(entry.brand, brands[i % NUM_BRANDS], sizeof(entry.brand));
+    entry.device = (i % NUM_BRANDS) % 2 ? IR_DEVICE_TV : IR_DEVICE_STB;
+    entry.codeset = (uint16_t)(i / NUM_BRANDS);
+    entry.action = IR_ACTION_POWER + i % 5;
+    entry.popularity = (uint16_t)(i * 37 % 1000);
+    return entry;
+}
+
+/* NEC codes, with a RAW capture every 50th */
+static ir_code_t make_code(unsigned i, uint32_t salt, uint16_t *raw)
+{
+    ir_code_t code = { .carrier_freq_hz = 38000, .duty_cycle_percent = 33 };
+    if (i % 50 == 7) {
+        code.protocol = IR_PROTOCOL_RAW;
+        for (unsigned k = 0; k < 8; k++) {
+            raw[k] = (uint16_t)(560 + i + k + salt);
+        }
+        code.raw_data = raw;
+        code.raw_length = 4;
+    } else {
+        code.protocol = IR_PROTOCOL_NEC;
+        code.bits = 32;
+        code.data = i * 2654435761u ^ salt;
+        code.address = (uint16_t)(i & 0xFF);
+        code.command = (uint16_t)((i >> 8) + salt);
+    }
+    return code;
+}
+
+static void add_code(unsigned i, uint32_t salt)
+{
+    uint16_t raw[8];
+    ir_library_entry_t entry = make_entry(i);
+    ir_code_t code = make_code(i, salt, raw);
+    CHECK_EQ(ir_library_add(&entry, &code), ESP_OK);
+    replaced_salt[i] = salt;
+}
+
+static bool lookup_matches(unsigned i)
+{
+    ir_library_entry_t entry = make_entry(i);
+    uint16_t raw[8];
+    ir_code_t expected = make_code(i, replaced_salt[i], raw);
+    ir_code_t code;
+
+    /* Brands are found in any case */
+    char brand[IR_LIBRARY_BRAND_LEN];
+    for (size_t k = 0; k < sizeof(brand); k++) {
+        brand[k] = (char)(k % 2 ? entry.brand[k] : toupper((unsigned char)entry.brand[k]));
+    }
+    if (ir_library_lookup(brand, entry.device, entry.codeset, entry.action, &code) != ESP_OK) {
+        return false;
+    }
+
+    bool same = code.protocol == expected.protocol;
+    if (same && code.protocol == IR_PROTOCOL_RAW) {
+        same = code.raw_length == expected.raw_length &&
+               memcmp(code.raw_data, raw, expected.raw_length * IR_CODE_RAW_SYMBOL_BYTES) == 0;
+    } else if (same) {
+        same = code.data == expected.data && code.address == expected.address &&
+               code.command == expected.command;
+    }
+    ir_code_free(&code);
+    return same;
+}
+
+/* ============================================================================
+ * CHECKS
+ * ============================================================================ */
+
+typedef struct {
+    size_t visited;
+    bool ordered;
+    ir_library_entry_t last;
+} visit_ctx_t;
+
+static int entry_compare(const ir_library_entry_t *a, const ir_library_entry_t *b)
+{
+    int c = memcmp(a->brand, b->brand, IR_LIBRARY_BRAND_LEN);
+    if (c != 0) {
+        return c;
+    }
+    if (a->device != b->device) {
+        return a->device < b->device ? -1 : 1;
+    }
+    if (a->codeset != b->codeset) {
+        return a->codeset < b->codeset ? -1 : 1;
+    }
+    return a->action == b->action ? 0 : a->action < b->action ? -1 : 1;
+}
+
+static bool visit(const ir_library_entry_t *entry, void *arg)
+{
+    visit_ctx_t *ctx = arg;
+    if (ctx->visited > 0 && entry_compare(&ctx->last, entry) >= 0) {
+        ctx->ordered = false;
+    }
+    ctx->last = *entry;
+    ctx->visited++;
+    return true;
+}
+
+/**
+ * @brief Codes [0, n) except @p missing are all there, once, in key order
+ */
+static void check_library(unsigned n, int missing)
+{
+    size_t expected = n - (missing >= 0 && (unsigned)missing < n);
+    CHECK_EQ(ir_library_get_count(), expected);
+
+    unsigned found = 0;
+    for (unsigned i = 0; i < n; i++) {
+        if ((int)i == missing) {
+            ir_library_entry_t entry = make_entry(i);
+            ir_code_t code;
+            CHECK_EQ(ir_library_load(&entry, &code), ESP_ERR_NOT_FOUND);
+            continue;
+        }
+        if (lookup_matches(i)) {
+            found++;
+        } else {
+            fprintf(stderr, "code %u missing or wrong\n", i);
+        }
+    }
+    CHECK_EQ(found, expected);
+
+    visit_ctx_t ctx = { .ordered = true };
+    CHECK_EQ(ir_library_foreach(NULL, IR_DEVICE_NONE, visit, &ctx), ESP_OK);
+    CHECK_EQ(ctx.visited, expected);
+    CHECK(ctx.ordered);
+}
+
+static long file_size(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void reboot(void)
+{
+    ir_library_deinit();
+    CHECK_EQ(ir_library_init(), ESP_OK);
+}
+
+static void wipe(void)
+{
+    ir_library_deinit();
+    remove("irlib.dat");
+    remove("irlib.idx");
+    remove("irlib.idx.new");
+    remove("irlib.tail");
+    memset(replaced_salt, 0, sizeof(replaced_salt));
+    CHECK_EQ(ir_library_init(), ESP_OK);
+}
+
+/* ============================================================================
+ * BULK RUN
+ * ============================================================================ */
+
+static void test_bulk_run(void)
+{
+    wipe();
+    CHECK_EQ(ir_library_get_count(), 0);
+
+    for (unsigned k = 0; k < RUN_CODES; k++) {
+        add_code(k * RUN_STRIDE % RUN_CODES, 0);
+    }
+    check_library(RUN_CODES, -1);
+
+    /* Merged every IR_LIBRARY_TAIL_MAX additions, the rest waits in the tail */
+    unsigned merged = RUN_CODES / IR_LIBRARY_TAIL_MAX * IR_LIBRARY_TAIL_MAX;
+    CHECK_EQ(file_size("irlib.idx"), (long)merged * INDEX_ENTRY);
+    CHECK_EQ(file_size("irlib.tail"), (long)(RUN_CODES - merged) * INDEX_ENTRY);
+
+    /* Replacing a code keeps the count; the newer record wins */
+    add_code(5, 0x5A5A);
+    add_code(7, 0x11);
+    check_library(RUN_CODES, -1);
+
+    reboot();
+    check_library(RUN_CODES, -1);
+
+    CHECK_EQ(ir_library_flush(), ESP_OK);
+    CHECK_EQ(file_size("irlib.idx"), (long)RUN_CODES * INDEX_ENTRY);
+    CHECK_EQ(file_size("irlib.tail"), -1);
+    check_library(RUN_CODES, -1);
+
+    reboot();
+    check_library(RUN_CODES, -1);
+
+    /* One brand and device only */
+    size_t sony = 0;
+    for (unsigned i = 0; i < RUN_CODES; i++) {
+        sony += strcmp(brands[i % NUM_BRANDS], "Sony") == 0;
+    }
+    visit_ctx_t ctx = { .ordered = true };
+    CHECK_EQ(ir_library_foreach("sony", IR_DEVICE_STB, visit, &ctx), ESP_OK);
+    CHECK_EQ(ctx.visited, sony);
+    CHECK(ctx.ordered);
+}
+
+/* ============================================================================
+ * INTERRUPTED MERGES
+ * ============================================================================ */
+
+static void test_interrupted_merge(void)
+{
+    wipe();
+    for (unsigned i = 0; i < 200; i++) {
+        add_code(i, 0);
+    }
+    CHECK_EQ(ir_library_flush(), ESP_OK);
+
+    /* Cut after the old index was removed, before the rename */
+    ir_library_deinit();
+    CHECK_EQ(rename("irlib.idx", "irlib.idx.new"), 0);
+    CHECK_EQ(ir_library_init(), ESP_OK);
+    CHECK_EQ(file_size("irlib.idx"), 200L * INDEX_ENTRY);
+    CHECK_EQ(file_size("irlib.idx.new"), -1);
+    check_library(200, -1);
+
+    /* Cut while writing the new index: old index and tail are still whole */
+    for (unsigned i = 200; i < 230; i++) {
+        add_code(i, 0);
+    }
+    add_code(3, 0x33);
+    ir_library_deinit();
+    FILE *f = fopen("irlib.idx.new", "wb");
+    CHECK(f != NULL);
+    char partial[INDEX_ENTRY * 5 / 2] = { 0 };
+    fwrite(partial, 1, sizeof(partial), f);
+    fclose(f);
+    CHECK_EQ(ir_library_init(), ESP_OK);
+    CHECK_EQ(file_size("irlib.idx.new"), -1);
+    check_library(230, -1);
+    CHECK_EQ(ir_library_flush(), ESP_OK);
+    check_library(230, -1);
+
+    /* Cut after the rename, before the tail file was removed */
+    for (unsigned i = 230; i < 240; i++) {
+        add_code(i, 0);
+    }
+    f = fopen("irlib.tail", "rb");
+    CHECK(f != NULL);
+    char tail_copy[10 * INDEX_ENTRY];
+    size_t tail_len = fread(tail_copy, 1, sizeof(tail_copy), f);
+    fclose(f);
+    CHECK_EQ(tail_len, sizeof(tail_copy));
+    CHECK_EQ(ir_library_flush(), ESP_OK);
+    ir_library_deinit();
+    f = fopen("irlib.tail", "wb");
+    fwrite(tail_copy, 1, tail_len, f);
+    fclose(f);
+    CHECK_EQ(ir_library_init(), ESP_OK);
+    check_library(240, -1);     // Replayed entries are already in the index
+    reboot();
+    check_library(240, -1);
+}
+
+/* ============================================================================
+ * TORN RECORD
+ * ============================================================================ */
+
+static void test_torn_record(void)
+{
+    wipe();
+    for (unsigned i = 0; i < 99; i++) {
+        add_code(i, 0);
+    }
+    long dat_before = file_size("irlib.dat");
+    long tail_before = file_size("irlib.tail");
+    add_code(99, 0);
+
+    /* Power cut halfway through the record: the tail entry was never written */
+    ir_library_deinit();
+    long record_len = file_size("irlib.dat") - dat_before;
+    CHECK_EQ(truncate("irlib.dat", dat_before + record_len / 2), 0);
+    CHECK_EQ(truncate("irlib.tail", tail_before), 0);
+    CHECK_EQ(ir_library_init(), ESP_OK);
+    check_library(100, 99);
+
+    /* Damaged index: rebuilt from irlib.dat, up to the torn record */
+    ir_library_deinit();
+    CHECK_EQ(truncate("irlib.idx", INDEX_ENTRY * 3 + 5), 0);
+    CHECK_EQ(ir_library_init(), ESP_OK);
+    check_library(100, 99);
+
+    /* Added after the reboot, behind the torn bytes: found by the next rebuild too */
+    add_code(99, 0x99);
+    add_code(100, 0);
+    check_library(101, -1);
+    ir_library_deinit();
+    remove("irlib.idx");
+    CHECK_EQ(ir_library_init(), ESP_OK);
+    check_library(101, -1);
+
+    /* Cut inside the last record's header */
+    dat_before = file_size("irlib.dat");
+    add_code(101, 0);
+    ir_library_deinit();
+    CHECK_EQ(truncate("irlib.dat", dat_before + 10), 0);
+    remove("irlib.idx");
+    remove("irlib.tail");
+    CHECK_EQ(ir_library_init(), ESP_OK);
+    check_library(102, 101);
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/irlib_XXXXXX";
+    if (mkdtemp(dir) == NULL || chdir(dir) != 0) {
+        perror("scratch directory");
+        return 1;
+    }
+
+    test_bulk_run();
+    test_interrupted_merge();
+    test_torn_record();
+
+    ir_library_deinit();
+    remove("irlib.dat");
+    remove("irlib.idx");
+    remove("irlib.idx.new");
+    remove("irlib.tail");
+    if (chdir("/") == 0) {
+        rmdir(dir);
+    }
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,298 @@
+/**
+ * @file test_rx_diversity.c
+ * @brief Diversity combining on synthetic captures of one NEC frame
+ *
+ * - Captures that agree merge into the frame with averaged timing.
+ * - A pulse one receiver lost is repaired from another, also when each
+ *   of two receivers lost a different pulse.
+ * - A spurious pulse only one of three receivers saw is voted out, and
+ *   the space it split comes back whole.
+ * - Runts before, inside and after the frame are removed.
+ * - A capture that does not align is left out of the merge.
+ *
+ * MIT License
+ */
+
+#include "ir_rx_diversity.h"
+#include "host_test.h"
+#include <string.h>
+
+#define MAX_DURATIONS   80
+
+#define NEC_BIT_MARK    560
+#define NEC_ZERO_SPACE  560
+#define NEC_ONE_SPACE   1690
+
+static const uint32_t nec_data = 0xA55A08F7;
+
+static uint32_t frame[MAX_DURATIONS];
+static size_t frame_len;
+
+/**
+ * @brief Build the reference frame: header, 32 bits LSB first, final mark
+ */
+static void build_frame(void)
+{
+    size_t n = 0;
+    frame[n++] = 9000;
+    frame[n++] = 4500;
+    for (int bit = 0; bit < 32; bit++) {
+        frame[n++] = NEC_BIT_MARK;
+        frame[n++] = (nec_data >> bit) & 1 ? NEC_ONE_SPACE : NEC_ZERO_SPACE;
+    }
+    frame[n++] = NEC_BIT_MARK;
+    frame_len = n;
+}
+
+/* Copy of the frame with offset added to every duration */
+static size_t copy_frame(uint32_t *capture, int offset)
+{
+    for (size_t i = 0; i < frame_len; i++) {
+        capture[i] = frame[i] + offset;
+    }
+    return frame_len;
+}
+
+/**
+ * @brief Remove the mark at @p index: it merges with the spaces around it
+ */
+static size_t lose_pulse(uint32_t *capture, size_t count, size_t index)
+{
+    capture[index - 1] += capture[index] + capture[index + 1];
+    memmove(&capture[index], &capture[index + 2], (count - index - 2) * sizeof(capture[0]));
+    return count - 2;
+}
+
+/**
+ * @brief Split the space at @p index with a @p mark_us pulse @p at_us into it
+ */
+static size_t add_pulse(uint32_t *capture, size_t count, size_t index, uint32_t at_us,
+                        uint32_t mark_us)
+{
+    uint32_t space = capture[index];
+    memmove(&capture[index + 2], &capture[index], (count - index) * sizeof(capture[0]));
+    capture[index] = at_us;
+    capture[index + 1] = mark_us;
+    capture[index + 2] = space - at_us - mark_us;
+    return count + 2;
+}
+
+static bool same_as_frame(const uint32_t *out, size_t count)
+{
+    return count == frame_len && memcmp(out, frame, frame_len * sizeof(frame[0])) == 0;
+}
+
+/* ============================================================================
+ * AGREEMENT
+ * ============================================================================ */
+
+static void test_agreeing_captures(void)
+{
+    uint32_t a[MAX_DURATIONS], b[MAX_DURATIONS], c[MAX_DURATIONS];
+    uint32_t out[MAX_DURATIONS];
+    uint32_t *captures[] = { a, b, c };
+    size_t counts[] = { copy_frame(a, -40), copy_frame(b, 0), copy_frame(c, 40) };
+    ir_diversity_result_t result;
+
+    size_t n = ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.captures_used, 3);
+    CHECK_EQ(result.edges_repaired, 0);
+    CHECK_EQ(result.edges_rejected, 0);
+    CHECK_EQ(result.glitches_removed, 0);
+
+    /* One receiver: passed through */
+    counts[0] = copy_frame(a, 0);
+    n = ir_diversity_combine(captures, counts, 1, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.captures_used, 1);
+
+    /* Empty captures are skipped */
+    counts[0] = 0;
+    counts[1] = copy_frame(b, 0);
+    counts[2] = 0;
+    n = ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.reference, 1);
+    CHECK_EQ(result.captures_used, 1);
+
+    counts[1] = 0;
+    CHECK_EQ(ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result), 0);
+}
+
+/* ============================================================================
+ * REPAIR
+ * ============================================================================ */
+
+static void test_lost_pulse_repaired(void)
+{
+    uint32_t a[MAX_DURATIONS], b[MAX_DURATIONS];
+    uint32_t out[MAX_DURATIONS];
+    uint32_t *captures[] = { a, b };
+    size_t counts[2];
+    ir_diversity_result_t result;
+
+    /* Receiver A lost bit 5's mark; B saw everything */
+    counts[0] = lose_pulse(a, copy_frame(a, 0), 2 + 2 * 5);
+    counts[1] = copy_frame(b, 0);
+    size_t n = ir_diversity_combine(captures, counts, 2, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.reference, 1);
+    CHECK_EQ(result.captures_used, 2);
+    CHECK_EQ(result.edges_rejected, 0);
+
+    /* Each lost a different mark: the reference is filled in from the other */
+    counts[0] = lose_pulse(a, copy_frame(a, 0), 2 + 2 * 3);
+    counts[1] = lose_pulse(b, copy_frame(b, 0), 2 + 2 * 20);
+    n = ir_diversity_combine(captures, counts, 2, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.captures_used, 2);
+    CHECK_EQ(result.edges_repaired, 2);
+    CHECK_EQ(result.edges_rejected, 0);
+
+    /* One receiver missed the final mark */
+    counts[0] = copy_frame(a, 0) - 2;
+    counts[1] = copy_frame(b, 0);
+    n = ir_diversity_combine(captures, counts, 2, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+}
+
+/* ============================================================================
+ * VOTING
+ * ============================================================================ */
+
+static void test_spurious_pulse_voted_out(void)
+{
+    uint32_t a[MAX_DURATIONS], b[MAX_DURATIONS], c[MAX_DURATIONS];
+    uint32_t out[MAX_DURATIONS];
+    uint32_t *captures[] = { a, b, c };
+    size_t counts[3];
+    ir_diversity_result_t result;
+
+    /* C saw a reflection in the middle of a "1" space */
+    size_t one_space = 0;
+    for (size_t i = 3; i < frame_len && one_space == 0; i += 2) {
+        one_space = frame[i] == NEC_ONE_SPACE ? i : 0;
+    }
+    CHECK(one_space > 0);
+
+    counts[0] = copy_frame(a, 0);
+    counts[1] = copy_frame(b, 0);
+    counts[2] = add_pulse(c, copy_frame(c, 0), one_space, 700, 300);
+    size_t n = ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.captures_used, 3);
+    CHECK_EQ(result.edges_rejected, 2);
+    CHECK_EQ(result.edges_repaired, 0);
+
+    /* In the first capture: the edge count the others share still picks the reference */
+    counts[0] = add_pulse(a, copy_frame(a, 0), one_space, 700, 300);
+    counts[1] = copy_frame(b, 0);
+    counts[2] = copy_frame(c, 0);
+    n = ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.reference, 1);
+    CHECK_EQ(result.edges_rejected, 2);
+
+    /* Two of three saw it: it stays */
+    counts[0] = add_pulse(a, copy_frame(a, 0), one_space, 700, 300);
+    counts[1] = add_pulse(b, copy_frame(b, 0), one_space, 700, 300);
+    counts[2] = copy_frame(c, 0);
+    n = ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result);
+    CHECK_EQ(n, frame_len + 2);
+    CHECK_EQ(out[one_space + 1], 300);
+    CHECK_EQ(result.edges_rejected, 0);
+}
+
+/* ============================================================================
+ * RUNTS
+ * ============================================================================ */
+
+static void test_runts_removed(void)
+{
+    uint32_t a[MAX_DURATIONS], b[MAX_DURATIONS];
+    uint32_t out[MAX_DURATIONS];
+    uint32_t *captures[] = { a, b };
+    size_t counts[2];
+    ir_diversity_result_t result;
+
+    /* Leading runt and its space, then the frame */
+    a[0] = 40;
+    a[1] = 3000;
+    counts[0] = 2 + copy_frame(&a[2], 0);
+
+    /* Trailing runt after a gap, and a space runt inside the header mark */
+    counts[1] = copy_frame(b, 0);
+    b[counts[1]++] = 2000;
+    b[counts[1]++] = 60;
+    memmove(&b[2], &b[0], counts[1] * sizeof(b[0]));
+    b[0] = 5000;
+    b[1] = 30;
+    b[2] = 9000 - 5000 - 30;
+    counts[1] += 2;
+
+    size_t n = ir_diversity_combine(captures, counts, 2, out, MAX_DURATIONS, &result);
+    CHECK_EQ(result.glitches_removed, 3);
+    CHECK_EQ(counts[0], frame_len);
+    CHECK_EQ(counts[1], frame_len + 1);     // The gap before the trailing runt stays
+    CHECK_EQ(result.captures_used, 2);
+    CHECK_EQ(n, frame_len + 1);
+    CHECK(memcmp(out, frame, frame_len * sizeof(frame[0])) == 0);
+    CHECK_EQ(out[frame_len], 2000);
+
+    /* A runt alone is no frame */
+    a[0] = 50;
+    a[1] = 400;
+    counts[0] = 2;
+    CHECK_EQ(ir_diversity_combine(captures, counts, 1, out, MAX_DURATIONS, &result), 0);
+}
+
+/* ============================================================================
+ * ALIGNMENT
+ * ============================================================================ */
+
+static void test_unaligned_capture_left_out(void)
+{
+    uint32_t a[MAX_DURATIONS], b[MAX_DURATIONS], c[MAX_DURATIONS];
+    uint32_t out[MAX_DURATIONS];
+    uint32_t *captures[] = { a, b, c };
+    size_t counts[3];
+    ir_diversity_result_t result;
+
+    /* C caught a different remote: Sony-style 2.4 ms header, 600 us units */
+    counts[0] = copy_frame(a, 0);
+    counts[1] = copy_frame(b, 0);
+    counts[2] = 0;
+    c[counts[2]++] = 2400;
+    for (int bit = 0; bit < 12; bit++) {
+        c[counts[2]++] = 600;
+        c[counts[2]++] = bit & 1 ? 1200 : 600;
+    }
+    size_t n = ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.captures_used, 2);
+    CHECK(result.reference != 2);
+
+    /* Same edge count, timing stretched threefold: does not align either */
+    counts[1] = copy_frame(b, 0);
+    for (size_t i = 0; i < counts[1]; i++) {
+        b[i] *= 3;
+    }
+    counts[0] = copy_frame(a, 0);
+    counts[2] = copy_frame(c, 0);
+    n = ir_diversity_combine(captures, counts, 3, out, MAX_DURATIONS, &result);
+    CHECK(same_as_frame(out, n));
+    CHECK_EQ(result.captures_used, 2);
+    CHECK_EQ(result.reference, 0);
+}
+
+int main(void)
+{
+    build_frame();
+    test_agreeing_captures();
+    test_lost_pulse_repaired();
+    test_spurious_pulse_voted_out();
+    test_runts_removed();
+    test_unaligned_capture_left_out();
+    return HOST_TEST_RESULT();
+}
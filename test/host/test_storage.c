@@ -0,0 +1,421 @@
+/**
+ * @file test_storage.c
+ * @brief Storage layer over the in-memory backend
+ *
+ * - Namespace handles are opened once and shared; mounts after the first
+ *   open are refused.
+ * - The value cache answers repeated reads and known-missing keys without
+ *   the backend, evicts the least recently used entry, never holds values
+ *   over IR_STORAGE_CACHE_VALUE_MAX, and forgets a key whose write failed.
+ * - Quotas account overwrites and erases.
+ * - Nested batches merge commits into one per written namespace.
+ * - Data survives a deinit/init "reboot", which also flushes an open batch.
+ * - A short benchmark prints cached and uncached read cost.
+ *
+ * MIT License
+ */
+
+#include "ir_storage.h"
+#include "host_test.h"
+#include <string.h>
+#include <time.h>
+
+/* ============================================================================
+ * COUNTING BACKEND
+ * ============================================================================ */
+
+/* The memory backend with call counters and an injectable set failure */
+static struct {
+    unsigned gets;
+    unsigned sets;
+    unsigned commits;
+    bool fail_set;
+} counting;
+
+static esp_err_t counting_get(void *ctx, const char *key, void *buf, size_t *len)
+{
+    counting.gets++;
+    return ir_storage_backend_mem.get(ctx, key, buf, len);
+}
+
+static esp_err_t counting_set(void *ctx, const char *key, const void *data, size_t len)
+{
+    counting.sets++;
+    return counting.fail_set ? ESP_FAIL : ir_storage_backend_mem.set(ctx, key, data, len);
+}
+
+static esp_err_t counting_erase(void *ctx, const char *key)
+{
+    return ir_storage_backend_mem.erase(ctx, key);
+}
+
+static esp_err_t counting_erase_all(void *ctx)
+{
+    return ir_storage_backend_mem.erase_all(ctx);
+}
+
+static esp_err_t counting_commit(void *ctx)
+{
+    counting.commits++;
+    return ESP_OK;
+}
+
+static esp_err_t counting_open(const char *namespace_name, void **ctx)
+{
+    return ir_storage_backend_mem.open(namespace_name, ctx);
+}
+
+static void counting_close(void *ctx)
+{
+    ir_storage_backend_mem.close(ctx);
+}
+
+static esp_err_t counting_used(void *ctx, size_t *bytes)
+{
+    return ir_storage_backend_mem.used(ctx, bytes);
+}
+
+static const ir_storage_backend_t backend_counting = {
+    .name = "counting",
+    .open = counting_open,
+    .close = counting_close,
+    .get = counting_get,
+    .set = counting_set,
+    .erase = counting_erase,
+    .erase_all = counting_erase_all,
+    .commit = counting_commit,
+    .used = counting_used,
+};
+
+static void reset_all(void)
+{
+    ir_storage_deinit();
+    ir_storage_mem_reset();
+    memset(&counting, 0, sizeof(counting));
+    CHECK_EQ(ir_storage_init_with(&backend_counting), ESP_OK);
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================ */
+
+static void test_handles(void)
+{
+    ir_storage_ns_t a, b, c;
+
+    CHECK_EQ(ir_storage_open("ir_codes", &a), ESP_ERR_INVALID_STATE);   // Before init
+    CHECK_EQ(ir_storage_mount("ir_codes", NULL, 0), ESP_ERR_INVALID_STATE);
+
+    reset_all();
+    CHECK_EQ(ir_storage_open("ir_codes", &a), ESP_OK);
+    CHECK_EQ(ir_storage_open("ir_codes", &b), ESP_OK);
+    CHECK(a == b);
+    CHECK_EQ(ir_storage_open("ir_actions", &c), ESP_OK);
+    CHECK(a != c);
+    CHECK_EQ(ir_storage_mount("ir_codes", NULL, 100), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(ir_storage_open("a_namespace_name_too_long", &c), ESP_ERR_INVALID_ARG);
+
+    /* Every slot taken */
+    for (int i = 2; i < IR_STORAGE_MAX_NAMESPACES; i++) {
+        char name[IR_STORAGE_KEY_MAX];
+        snprintf(name, sizeof(name), "ns%d", i);
+        CHECK_EQ(ir_storage_open(name, &c), ESP_OK);
+    }
+    CHECK_EQ(ir_storage_open("one_more", &c), ESP_ERR_NO_MEM);
+
+    CHECK_EQ(ir_storage_get(NULL, "k", NULL, &(size_t){0}), ESP_ERR_INVALID_ARG);
+}
+
+static void test_cache(void)
+{
+    ir_storage_ns_t ns;
+    ir_storage_stats_t stats;
+    uint8_t buf[200];
+    size_t len;
+
+    reset_all();
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+
+    /* A missing key is asked once */
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_ERR_NOT_FOUND);
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(counting.gets, 1);
+
+    /* A written value is read from the cache */
+    CHECK_EQ(ir_storage_set(ns, "k", "hello", 5), ESP_OK);
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_OK);
+    CHECK(len == 5 && memcmp(buf, "hello", 5) == 0);
+    len = 2;
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_ERR_INVALID_SIZE);
+    len = 0;
+    CHECK_EQ(ir_storage_get(ns, "k", NULL, &len), ESP_OK);
+    CHECK_EQ(len, 5);
+    CHECK_EQ(counting.gets, 1);
+
+    CHECK_EQ(ir_storage_get_stats(ns, &stats), ESP_OK);
+    CHECK_EQ(stats.reads, 5);
+    CHECK_EQ(stats.cache_hits, 4);
+    CHECK_EQ(stats.writes, 1);
+
+    /* Large values always come from the backend */
+    uint8_t big[IR_STORAGE_CACHE_VALUE_MAX + 1];
+    memset(big, 7, sizeof(big));
+    CHECK_EQ(ir_storage_set(ns, "big", big, sizeof(big)), ESP_OK);
+    for (int i = 0; i < 3; i++) {
+        len = sizeof(buf);
+        CHECK_EQ(ir_storage_get(ns, "big", buf, &len), ESP_OK);
+        CHECK(len == sizeof(big) && memcmp(buf, big, len) == 0);
+    }
+    CHECK_EQ(counting.gets, 4);
+
+    /* A cached small value replaced by a large one is not served stale */
+    CHECK_EQ(ir_storage_set(ns, "k", big, sizeof(big)), ESP_OK);
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_OK);
+    CHECK_EQ(len, sizeof(big));
+
+    /* Erase is remembered as missing */
+    CHECK_EQ(ir_storage_erase(ns, "k"), ESP_OK);
+    unsigned gets = counting.gets;
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(ir_storage_erase(ns, "k"), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(counting.gets, gets);
+}
+
+static void test_lru(void)
+{
+    ir_storage_ns_t ns;
+    char key[IR_STORAGE_KEY_MAX];
+    size_t len;
+    int value;
+
+    reset_all();
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+
+    /* One more key than the cache holds; key 0 is kept hot */
+    for (int i = 0; i <= IR_STORAGE_CACHE_ENTRIES; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        CHECK_EQ(ir_storage_set(ns, key, &i, sizeof(i)), ESP_OK);
+        len = sizeof(value);
+        CHECK_EQ(ir_storage_get(ns, "k0", &value, &len), ESP_OK);
+    }
+    CHECK_EQ(counting.gets, 0);
+
+    /* k1 was the least recently used */
+    len = sizeof(value);
+    CHECK_EQ(ir_storage_get(ns, "k1", &value, &len), ESP_OK);
+    CHECK_EQ(value, 1);
+    CHECK_EQ(counting.gets, 1);
+    len = sizeof(value);
+    CHECK_EQ(ir_storage_get(ns, "k0", &value, &len), ESP_OK);
+    CHECK_EQ(counting.gets, 1);
+
+    /* Many more keys than entries: every value still reads back right */
+    for (int i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "b%d", i);
+        CHECK_EQ(ir_storage_set(ns, key, &i, sizeof(i)), ESP_OK);
+    }
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 100; i++) {
+            snprintf(key, sizeof(key), "b%d", (i * 37) % 100);
+            len = sizeof(value);
+            CHECK_EQ(ir_storage_get(ns, key, &value, &len), ESP_OK);
+            CHECK_EQ(value, (i * 37) % 100);
+        }
+    }
+}
+
+static void test_write_failure(void)
+{
+    ir_storage_ns_t ns;
+    char buf[8];
+    size_t len;
+
+    reset_all();
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+    CHECK_EQ(ir_storage_set(ns, "k", "old", 4), ESP_OK);
+
+    /* The backend keeps the old value; so must the cache */
+    counting.fail_set = true;
+    CHECK_EQ(ir_storage_set(ns, "k", "new", 4), ESP_FAIL);
+    counting.fail_set = false;
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_OK);
+    CHECK(strcmp(buf, "old") == 0);
+    CHECK_EQ(counting.gets, 1);
+}
+
+static void test_quota(void)
+{
+    ir_storage_ns_t ns;
+    ir_storage_stats_t stats;
+    uint8_t data[100] = {0};
+
+    reset_all();
+    CHECK_EQ(ir_storage_mount("quota", NULL, 100), ESP_OK);
+    CHECK_EQ(ir_storage_open("quota", &ns), ESP_OK);
+
+    CHECK_EQ(ir_storage_set(ns, "x", data, 60), ESP_OK);
+    CHECK_EQ(ir_storage_set(ns, "y", data, 50), ESP_ERR_NO_MEM);
+    CHECK_EQ(ir_storage_set(ns, "x", data, 90), ESP_OK);    // Overwrite counts the difference
+    CHECK_EQ(ir_storage_set(ns, "y", data, 10), ESP_OK);
+    CHECK_EQ(ir_storage_get_stats(ns, &stats), ESP_OK);
+    CHECK_EQ(stats.used_bytes, 100);
+    CHECK_EQ(stats.quota_bytes, 100);
+
+    CHECK_EQ(ir_storage_erase(ns, "x"), ESP_OK);
+    CHECK_EQ(ir_storage_erase(ns, "x"), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(ir_storage_set(ns, "z", data, 90), ESP_OK);
+    CHECK_EQ(ir_storage_set(ns, "w", data, 1), ESP_ERR_NO_MEM);
+    CHECK_EQ(ir_storage_erase_all(ns), ESP_OK);
+    CHECK_EQ(ir_storage_set(ns, "w", data, 100), ESP_OK);
+
+    /* Usage is read back from the backend after a reboot */
+    ir_storage_deinit();
+    CHECK_EQ(ir_storage_init_with(&backend_counting), ESP_OK);
+    CHECK_EQ(ir_storage_mount("quota", NULL, 100), ESP_OK);
+    CHECK_EQ(ir_storage_open("quota", &ns), ESP_OK);
+    CHECK_EQ(ir_storage_get_stats(ns, &stats), ESP_OK);
+    CHECK_EQ(stats.used_bytes, 100);
+    CHECK_EQ(ir_storage_set(ns, "v", data, 1), ESP_ERR_NO_MEM);
+}
+
+static void test_batch(void)
+{
+    ir_storage_ns_t a, b, idle;
+    ir_storage_stats_t stats;
+
+    reset_all();
+    CHECK_EQ(ir_storage_open("ir_codes", &a), ESP_OK);
+    CHECK_EQ(ir_storage_open("ir_actions", &b), ESP_OK);
+    CHECK_EQ(ir_storage_open("ir_scenes", &idle), ESP_OK);
+
+    CHECK(!ir_storage_in_batch());
+    ir_storage_begin_batch();
+    ir_storage_begin_batch();
+    CHECK(ir_storage_in_batch());
+    for (int i = 0; i < 100; i++) {
+        char key[IR_STORAGE_KEY_MAX];
+        snprintf(key, sizeof(key), "b%d", i);
+        CHECK_EQ(ir_storage_set(i % 2 ? a : b, key, &i, sizeof(i)), ESP_OK);
+        CHECK_EQ(ir_storage_commit(i % 2 ? a : b), ESP_OK);
+    }
+    CHECK_EQ(ir_storage_end_batch(), ESP_OK);
+    CHECK_EQ(counting.commits, 0);                  // Inner end: still deferred
+    CHECK_EQ(ir_storage_end_batch(), ESP_OK);
+    CHECK_EQ(counting.commits, 2);                  // One per written namespace
+    CHECK(!ir_storage_in_batch());
+
+    CHECK_EQ(ir_storage_get_stats(a, &stats), ESP_OK);
+    CHECK_EQ(stats.commits, 1);
+    CHECK_EQ(stats.deferred_commits, 50);
+    CHECK_EQ(ir_storage_get_stats(idle, &stats), ESP_OK);
+    CHECK_EQ(stats.commits, 0);
+
+    CHECK_EQ(ir_storage_end_batch(), ESP_ERR_INVALID_STATE);
+
+    /* Outside a batch every commit goes through */
+    CHECK_EQ(ir_storage_commit(a), ESP_OK);
+    CHECK_EQ(counting.commits, 3);
+}
+
+static void test_reboot(void)
+{
+    ir_storage_ns_t ns;
+    char buf[16];
+    size_t len;
+
+    reset_all();
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+    CHECK_EQ(ir_storage_set(ns, "k", "kept", 5), ESP_OK);
+
+    /* Deinit flushes an open batch */
+    ir_storage_begin_batch();
+    CHECK_EQ(ir_storage_commit(ns), ESP_OK);
+    CHECK_EQ(counting.commits, 0);
+    ir_storage_deinit();
+    CHECK_EQ(counting.commits, 1);
+    CHECK(!ir_storage_in_batch());
+
+    CHECK_EQ(ir_storage_init_with(&backend_counting), ESP_OK);
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_OK);
+    CHECK(len == 5 && strcmp(buf, "kept") == 0);
+
+    CHECK_EQ(ir_storage_erase_all(ns), ESP_OK);
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_ERR_NOT_FOUND);
+
+    /* mem_reset is a factory reset */
+    CHECK_EQ(ir_storage_set(ns, "k", "gone", 5), ESP_OK);
+    ir_storage_deinit();
+    ir_storage_mem_reset();
+    CHECK_EQ(ir_storage_init_with(&backend_counting), ESP_OK);
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+    len = sizeof(buf);
+    CHECK_EQ(ir_storage_get(ns, "k", buf, &len), ESP_ERR_NOT_FOUND);
+}
+
+/* ============================================================================
+ * BENCHMARK
+ * ============================================================================ */
+
+static double elapsed_ns(const struct timespec *t0, const struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec);
+}
+
+static void bench(void)
+{
+    enum { ROUNDS = 200000 };
+    ir_storage_ns_t ns;
+    uint8_t code[26] = {0};
+    uint8_t big[IR_STORAGE_CACHE_VALUE_MAX + 1] = {0};
+    uint8_t buf[128];
+    size_t len;
+    struct timespec t0, t1, t2;
+
+    reset_all();
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+    for (int i = 0; i < 40; i++) {
+        char key[IR_STORAGE_KEY_MAX];
+        snprintf(key, sizeof(key), "tv_%d", i);
+        CHECK_EQ(ir_storage_set(ns, key, code, sizeof(code)), ESP_OK);
+    }
+    CHECK_EQ(ir_storage_set(ns, "big", big, sizeof(big)), ESP_OK);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < ROUNDS; i++) {
+        len = sizeof(buf);
+        ir_storage_get(ns, "tv_5", buf, &len);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (int i = 0; i < ROUNDS; i++) {
+        len = sizeof(buf);
+        ir_storage_get(ns, "big", buf, &len);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+
+    printf("get: cached %.1f ns, backend (41 keys) %.1f ns\n",
+           elapsed_ns(&t0, &t1) / ROUNDS, elapsed_ns(&t1, &t2) / ROUNDS);
+    ir_storage_deinit();
+    ir_storage_mem_reset();
+}
+
+int main(void)
+{
+    test_handles();
+    test_cache();
+    test_lru();
+    test_write_failure();
+    test_quota();
+    test_batch();
+    test_reboot();
+    bench();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,303 @@
+/**
+ * @file test_storage_log.c
+ * @brief Ring log backend on a simulated NOR partition
+ *
+ * - 20000 writes over four keys with periodic reboots: every replay gives
+ *   the latest value of every key, and unchanged values cost no program.
+ * - A write torn at any point leaves the previous value after a reboot;
+ *   an injected tear on every write of a long run never loses another key,
+ *   whether it hits a record, a compaction copy or a sector header.
+ * - A reset in the middle of compaction (next sector opened, torn record
+ *   in it) is finished at the next boot.
+ * - Failed copies during compaction keep the oldest sector.
+ * - Two sectors are erased after every successful write.
+ * - Without an ir_log partition the namespace fails to open with
+ *   ESP_ERR_NOT_FOUND.
+ *
+ * MIT License
+ */
+
+#include "ir_storage.h"
+#include "flash_sim.h"
+#include "host_test.h"
+#include <string.h>
+
+#define NUM_SECTORS     (FLASH_SIM_SIZE / FLASH_SIM_SECTOR_SIZE)
+#define SECTOR_MAGIC    0x474C5249      // ir_storage_log.c sector header: "IRLG", then seq
+#define NUM_KEYS        4
+
+/* Larger than IR_STORAGE_CACHE_VALUE_MAX, so reads always reach the log */
+typedef struct {
+    int value;
+    char pad[76];
+} state_t;
+
+static ir_storage_ns_t ac_ns;
+static ir_storage_ns_t misc_ns;
+
+static void boot(void)
+{
+    ir_storage_deinit();
+    CHECK_EQ(ir_storage_init_with(&ir_storage_backend_mem), ESP_OK);
+    CHECK_EQ(ir_storage_mount("ac_log", &ir_storage_backend_log, 0), ESP_OK);
+    CHECK_EQ(ir_storage_mount("misc", &ir_storage_backend_log, 0), ESP_OK);
+    CHECK_EQ(ir_storage_open("ac_log", &ac_ns), ESP_OK);
+    CHECK_EQ(ir_storage_open("misc", &misc_ns), ESP_OK);
+}
+
+static void key_name(int index, char *key, size_t size)
+{
+    snprintf(key, size, index ? "state%d" : "state", index);
+}
+
+static esp_err_t set_state(const char *key, int value)
+{
+    state_t state = { .value = value };
+    return ir_storage_set(ac_ns, key, &state, sizeof(state));
+}
+
+/* INT32_MIN when missing */
+static int get_state(const char *key)
+{
+    state_t state;
+    size_t len = sizeof(state);
+    if (ir_storage_get(ac_ns, key, &state, &len) != ESP_OK || len != sizeof(state)) {
+        return INT32_MIN;
+    }
+    return state.value;
+}
+
+static int get_counter(void)
+{
+    int value;
+    size_t len = sizeof(value);
+    return ir_storage_get(misc_ns, "cnt", &value, &len) == ESP_OK ? value : INT32_MIN;
+}
+
+static int erased_sectors(void)
+{
+    int erased = 0;
+    for (int s = 0; s < NUM_SECTORS; s++) {
+        const uint8_t *sector = flash_sim + s * FLASH_SIM_SECTOR_SIZE;
+        uint32_t magic;
+        memcpy(&magic, sector, sizeof(magic));
+        if (magic == SECTOR_MAGIC) {
+            continue;
+        }
+        bool blank = true;
+        for (int i = 0; i < FLASH_SIM_SECTOR_SIZE && blank; i++) {
+            blank = sector[i] == 0xFF;
+        }
+        erased += blank;
+    }
+    return erased;
+}
+
+static int model[NUM_KEYS];
+
+static void check_model(void)
+{
+    for (int k = 0; k < NUM_KEYS; k++) {
+        char key[IR_STORAGE_KEY_MAX];
+        key_name(k, key, sizeof(key));
+        CHECK_EQ(get_state(key), model[k]);
+    }
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================ */
+
+static void test_no_partition(void)
+{
+    ir_storage_ns_t ns;
+
+    flash_sim_present = false;
+    ir_storage_deinit();
+    CHECK_EQ(ir_storage_init_with(&ir_storage_backend_mem), ESP_OK);
+    CHECK_EQ(ir_storage_mount("ac_log", &ir_storage_backend_log, 0), ESP_OK);
+    CHECK_EQ(ir_storage_open("ac_log", &ns), ESP_ERR_NOT_FOUND);
+
+    /* Other namespaces are unaffected */
+    CHECK_EQ(ir_storage_open("ir_codes", &ns), ESP_OK);
+    ir_storage_deinit();
+    flash_sim_present = true;
+}
+
+static void test_replay(void)
+{
+    flash_sim_reset();
+    boot();
+    CHECK_EQ(get_state("state"), INT32_MIN);
+
+    for (int i = 1; i <= 20000; i++) {
+        char key[IR_STORAGE_KEY_MAX];
+        int k = i % NUM_KEYS;
+        key_name(k, key, sizeof(key));
+        CHECK_EQ(set_state(key, i), ESP_OK);
+        model[k] = i;
+
+        if (i == 5000) {
+            int counter = 42;
+            CHECK_EQ(ir_storage_set(misc_ns, "cnt", &counter, sizeof(counter)), ESP_OK);
+            CHECK_EQ(ir_storage_set(misc_ns, "gone", &counter, sizeof(counter)), ESP_OK);
+            CHECK_EQ(ir_storage_erase(misc_ns, "gone"), ESP_OK);
+        }
+        if (i % 997 == 0) {
+            boot();
+            check_model();
+        }
+    }
+    printf("20000 writes: %u programs, %u erases\n", flash_sim_programs, flash_sim_erases);
+    CHECK(flash_sim_erases < 20000 / 16);
+
+    boot();
+    check_model();
+    CHECK_EQ(get_counter(), 42);
+    size_t len = 0;
+    CHECK_EQ(ir_storage_get(misc_ns, "gone", NULL, &len), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(erased_sectors(), 2);
+
+    /* Writing the value already stored costs nothing */
+    unsigned programs = flash_sim_programs;
+    CHECK_EQ(set_state("state1", model[1]), ESP_OK);
+    CHECK_EQ(flash_sim_programs, programs);
+}
+
+static void test_torn_write(void)
+{
+    /* Torn program of the record itself */
+    flash_sim_fail_after = 0;
+    CHECK(set_state("state2", -5) != ESP_OK);
+    flash_sim_fail_after = -1;
+    boot();
+    check_model();
+
+    CHECK_EQ(set_state("state2", 777), ESP_OK);
+    model[2] = 777;
+    boot();
+    check_model();
+
+    /* A tear at every write position of a long run */
+    uint32_t rng = 99;
+    for (int round = 0; round < 600; round++) {
+        rng = rng * 1103515245u + 12345u;
+        int k = (rng >> 8) % NUM_KEYS;
+        int value = 10000 + round;
+        char key[IR_STORAGE_KEY_MAX];
+        key_name(k, key, sizeof(key));
+
+        flash_sim_fail_after = (rng >> 16) % 4;
+        esp_err_t err = set_state(key, value);
+        flash_sim_fail_after = -1;
+        if (err == ESP_OK) {
+            model[k] = value;
+        }
+
+        if (err != ESP_OK || round % 50 == 0) {
+            boot();
+            /* A failed write may or may not have landed, nothing else moves */
+            int got = get_state(key);
+            CHECK(got == model[k] || (err != ESP_OK && got == value));
+            model[k] = got;
+            check_model();
+            CHECK_EQ(get_counter(), 42);
+        }
+    }
+
+    CHECK_EQ(set_state("state", 1), ESP_OK);
+    model[0] = 1;
+    CHECK_EQ(erased_sectors(), 2);
+}
+
+static void test_compaction_crash(void)
+{
+    /* Head sector: the highest sequence number */
+    uint32_t max_seq = 0;
+    int head = -1;
+    for (int s = 0; s < NUM_SECTORS; s++) {
+        uint32_t header[2];
+        memcpy(header, flash_sim + s * FLASH_SIM_SECTOR_SIZE, sizeof(header));
+        if (header[0] == SECTOR_MAGIC && header[1] >= max_seq) {
+            max_seq = header[1];
+            head = s;
+        }
+    }
+    CHECK(head >= 0);
+    if (head < 0) {
+        return;
+    }
+
+    /* Reset right after the next sector was opened, mid-record */
+    int next = (head + 1) % NUM_SECTORS;
+    uint32_t header[2] = { SECTOR_MAGIC, max_seq + 1 };
+    memcpy(flash_sim + next * FLASH_SIM_SECTOR_SIZE, header, sizeof(header));
+    memset(flash_sim + next * FLASH_SIM_SECTOR_SIZE + sizeof(header), 0x12, 40);
+
+    boot();
+    check_model();
+    CHECK_EQ(get_counter(), 42);
+    for (int i = 0; i < 100; i++) {
+        CHECK_EQ(set_state("state3", 1000 + i), ESP_OK);
+    }
+    model[3] = 1099;
+    boot();
+    check_model();
+    CHECK_EQ(get_counter(), 42);
+    CHECK_EQ(erased_sectors(), 2);
+}
+
+static void test_copy_failure(void)
+{
+    /* Failures land on records and, when a sector fills, on compaction copies */
+    for (int i = 0; i < 400; i++) {
+        int value = 2000 + i;
+        flash_sim_fail_after = i % 2 == 0 ? 0 : 1 + (i / 2) % 6;
+        esp_err_t err = set_state("state", value);
+        flash_sim_fail_after = -1;
+        if (err == ESP_OK) {
+            model[0] = value;
+        }
+        CHECK_EQ(get_counter(), 42);
+    }
+
+    boot();
+    int got = get_state("state");
+    CHECK(got == model[0] || got == 2399);
+    model[0] = got;
+    check_model();
+    CHECK_EQ(get_counter(), 42);
+
+    for (int i = 0; i < 100; i++) {
+        CHECK_EQ(set_state("state", 3000 + i), ESP_OK);
+    }
+    model[0] = 3099;
+    boot();
+    check_model();
+    CHECK_EQ(get_counter(), 42);
+    CHECK_EQ(erased_sectors(), 2);
+}
+
+static void test_erase_all(void)
+{
+    CHECK_EQ(ir_storage_erase_all(ac_ns), ESP_OK);
+    boot();
+    for (int k = 0; k < NUM_KEYS; k++) {
+        model[k] = INT32_MIN;
+    }
+    check_model();
+    CHECK_EQ(get_counter(), 42);     // Only its own namespace
+}
+
+int main(void)
+{
+    test_no_partition();
+    test_replay();
+    test_torn_write();
+    test_compaction_crash();
+    test_copy_failure();
+    test_erase_all();
+    ir_storage_deinit();
+    ir_storage_mem_reset();
+    return HOST_TEST_RESULT();
+}